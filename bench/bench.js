@@ -0,0 +1,420 @@
+//
+// mg-dbx-bdb.node: Benchmark suite
+//
+// Creates a temporary LMDB, BDB or in-memory (MEM) database, runs a standard set of workloads through the public API
+// and writes the results as a JSON document (to stdout, or to the file given by --out).
+//
+// Usage: npm run bench -- [--type lmdb|bdb|mem] [--library <path>] [--keys <n>] [--value_size <n>]
+//                         [--threads <n>] [--window <n>] [--out <file>] [--dir <path>] [--keep]
+//
+// The database library may also be specified with the DBX_BENCH_LIBRARY environment variable.
+//
+
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var dbx = require(path.join(__dirname, '..'));
+var worker_threads = null;
+
+try {
+   worker_threads = require('worker_threads');
+}
+catch (error) {
+   worker_threads = null;
+}
+
+var GLOBAL_NAME = "bench";
+
+// Options: defaults, then the command line
+
+function getOptions(argv) {
+   var options = {type: "lmdb", library: process.env.DBX_BENCH_LIBRARY || "", keys: 100000, value_size: 32, threads: 4, window: 64, out: "", dir: "", keep: false};
+   var n, name;
+
+   for (n = 0; n < argv.length; n ++) {
+      if (argv[n].substring(0, 2) != "--") {
+         continue;
+      }
+      name = argv[n].substring(2).replace(/-/g, "_");
+      if (name == "keep") {
+         options.keep = true;
+      }
+      else if (name in options) {
+         options[name] = argv[++ n];
+      }
+      else {
+         throw new Error("Unknown option: " + argv[n]);
+      }
+   }
+   options.type = String(options.type).toLowerCase();
+   options.keys = parseInt(options.keys, 10);
+   options.value_size = parseInt(options.value_size, 10);
+   options.threads = parseInt(options.threads, 10);
+   options.window = parseInt(options.window, 10);
+   if (options.type != "lmdb" && options.type != "bdb" && options.type != "mem") {
+      throw new Error("Invalid type: " + options.type + " (lmdb, bdb or mem)");
+   }
+   if (!options.library && options.type != "mem") {
+      if (process.platform == 'win32')
+         options.library = (options.type == "lmdb") ? "c:/LMDBWindows/lib/LMDBWindowsDll64.dll" : "c:/c/bdb/libdb181.dll";
+      else
+         options.library = (options.type == "lmdb") ? "liblmdb.so" : "/usr/local/BerkeleyDB.18.1/lib/libdb.so";
+   }
+   return options;
+}
+
+// The open() parameters for the database held in 'dir'
+
+function openParameters(options, dir) {
+   if (options.type == "mem")
+      return {type: "MEM", key_type: "m", multithreaded: true};
+   else if (options.type == "lmdb")
+      return {type: "LMDB", db_library: options.library, env_dir: dir, key_type: "m", multithreaded: true};
+   else
+      return {type: "BDB", db_library: options.library, db_file: path.join(dir, "bench.db"), key_type: "m", multithreaded: true};
+}
+
+function openDatabase(params) {
+   var db = new dbx.dbxbdb();
+   var result = db.open(params);
+
+   if (result) {
+      throw new Error("Cannot open the database: " + result);
+   }
+   return db;
+}
+
+// A fixed sequence of pseudo-random keys so that runs are comparable (xorshift32)
+
+function randomKeys(count, keys, seed) {
+   var list = new Array(count);
+   var x = seed | 0 || 2463534242;
+   var n;
+
+   for (n = 0; n < count; n ++) {
+      x ^= x << 13;
+      x ^= x >>> 17;
+      x ^= x << 5;
+      list[n] = ((x >>> 0) % keys) + 1;
+   }
+   return list;
+}
+
+function now() {
+   var t = process.hrtime();
+   return (t[0] * 1e9) + t[1];
+}
+
+// Summarize a workload: latencies are in nanoseconds
+
+function result(name, api, op, mode, threads, operations, elapsed, latency) {
+   var res = {name: name, api: api, op: op, mode: mode, threads: threads, operations: operations, seconds: elapsed / 1e9, ops_per_sec: 0};
+
+   if (elapsed > 0) {
+      res.ops_per_sec = Math.round(operations / (elapsed / 1e9));
+   }
+   if (latency && latency.length) {
+      latency.sort(function(a, b) { return a - b; });
+      res.latency_us = {
+         p50: latency[Math.floor(latency.length * 0.5)] / 1000,
+         p99: latency[Math.min(latency.length - 1, Math.floor(latency.length * 0.99))] / 1000,
+         max: latency[latency.length - 1] / 1000
+      };
+   }
+   return res;
+}
+
+// Run fn(n) synchronously for each key, timing each call
+
+function runSync(keys, fn) {
+   var latency = new Array(keys.length);
+   var start = now();
+   var n, t;
+
+   for (n = 0; n < keys.length; n ++) {
+      t = now();
+      fn(keys[n]);
+      latency[n] = now() - t;
+   }
+   return {elapsed: now() - start, latency: latency};
+}
+
+// Run fn(key, callback) asynchronously for each key with no more than 'window' calls outstanding
+
+function runAsync(keys, window, fn, done) {
+   var latency = new Array(keys.length);
+   var start = now();
+   var issued = 0;
+   var completed = 0;
+   var failed = null;
+
+   function issue() {
+      var n = issued ++;
+      var t = now();
+
+      fn(keys[n], function(error, res) {
+         latency[n] = now() - t;
+         if (error && !failed) {
+            failed = new Error("Asynchronous call failed: " + res);
+         }
+         completed ++;
+         if (completed == keys.length) {
+            done(failed, {elapsed: now() - start, latency: latency});
+         }
+         else if (issued < keys.length) {
+            issue();
+         }
+      });
+   }
+
+   while (issued < keys.length && issued < window) {
+      issue();
+   }
+}
+
+// Worker thread: open the same database and read keys until told to stop
+
+function runWorker() {
+   var data = worker_threads.workerData;
+   var db = openDatabase(data.params);
+   var global = new dbx.mglobal(db, GLOBAL_NAME);
+   var keys = randomKeys(data.count, data.keys, data.seed);
+
+   worker_threads.parentPort.on('message', function(message) {
+      var run;
+
+      if (message != "go") {
+         return;
+      }
+      run = runSync(keys, function(key) { global.get(key); });
+      db.close();
+      worker_threads.parentPort.postMessage({operations: keys.length, elapsed: run.elapsed});
+      worker_threads.parentPort.close();
+   });
+   worker_threads.parentPort.postMessage("ready");
+}
+
+// Start 'threads' workers, let them run together and report the aggregate throughput
+
+function runWorkers(options, params, threads, done) {
+   var workers = [];
+   var ready = 0;
+   var finished = 0;
+   var operations = 0;
+   var count = Math.ceil(options.keys / threads);
+   var start = 0;
+   var n;
+
+   function onMessage(message) {
+      var i;
+
+      if (message == "ready") {
+         ready ++;
+         if (ready == threads) {
+            start = now();
+            for (i = 0; i < threads; i ++) {
+               workers[i].postMessage("go");
+            }
+         }
+         return;
+      }
+      operations += message.operations;
+      finished ++;
+      if (finished == threads) {
+         done(null, result("mglobal.get worker_threads x" + threads, "mglobal", "get", "worker", threads, operations, now() - start, null));
+      }
+   }
+
+   for (n = 0; n < threads; n ++) {
+      workers[n] = new worker_threads.Worker(__filename, {workerData: {params: params, keys: options.keys, count: count, seed: 1000 + n}});
+      workers[n].on('message', onMessage);
+      workers[n].on('error', function(error) { done(error); });
+   }
+}
+
+function removeDirectory(dir) {
+   var entries, n, entry;
+
+   if (!fs.existsSync(dir)) {
+      return;
+   }
+   entries = fs.readdirSync(dir);
+   for (n = 0; n < entries.length; n ++) {
+      entry = path.join(dir, entries[n]);
+      if (fs.statSync(entry).isDirectory())
+         removeDirectory(entry);
+      else
+         fs.unlinkSync(entry);
+   }
+   fs.rmdirSync(dir);
+}
+
+// The workloads: each one is given the open database and a callback for its results
+
+function workloads(options, db, params) {
+   var global = new dbx.mglobal(db, GLOBAL_NAME);
+   var value = "x".repeat(options.value_size);
+   var sequential = [];
+   var random = randomKeys(options.keys, options.keys, 1);
+   var list = [];
+   var n, threads;
+
+   for (n = 1; n <= options.keys; n ++) {
+      sequential.push(n);
+   }
+
+   list.push(function(done) {
+      var run = runSync(sequential, function(key) { db.set(GLOBAL_NAME, key, value); });
+      done(null, result("dbxbdb.set sequential", "dbxbdb", "set", "sync", 1, sequential.length, run.elapsed, run.latency));
+   });
+   list.push(function(done) {
+      var run = runSync(sequential, function(key) { global.set(key, value); });
+      done(null, result("mglobal.set sequential", "mglobal", "set", "sync", 1, sequential.length, run.elapsed, run.latency));
+   });
+   list.push(function(done) {
+      var run = runSync(random, function(key) { db.get(GLOBAL_NAME, key); });
+      done(null, result("dbxbdb.get random", "dbxbdb", "get", "sync", 1, random.length, run.elapsed, run.latency));
+   });
+   list.push(function(done) {
+      var run = runSync(random, function(key) { global.get(key); });
+      done(null, result("mglobal.get random", "mglobal", "get", "sync", 1, random.length, run.elapsed, run.latency));
+   });
+   list.push(function(done) {
+      runAsync(random, options.window, function(key, callback) { db.get(GLOBAL_NAME, key, callback); }, function(error, run) {
+         done(error, error ? null : result("dbxbdb.get random async", "dbxbdb", "get", "async", 1, random.length, run.elapsed, run.latency));
+      });
+   });
+   list.push(function(done) {
+      runAsync(random, options.window, function(key, callback) { global.get(key, callback); }, function(error, run) {
+         done(error, error ? null : result("mglobal.get random async", "mglobal", "get", "async", 1, random.length, run.elapsed, run.latency));
+      });
+   });
+   list.push(function(done) {
+      var key = "";
+      var count = 0;
+      var start = now();
+
+      while ((key = global.next(key)) != "") {
+         count ++;
+      }
+      done(null, result("mglobal.next scan", "mglobal", "next", "sync", 1, count, now() - start, null));
+   });
+   list.push(function(done) {
+      var query = new dbx.mcursor(db, {global: GLOBAL_NAME, key: [""]});
+      var count = 0;
+      var start = now();
+
+      while (query.next() !== null) {
+         count ++;
+      }
+      done(null, result("mcursor.next scan", "mcursor", "next", "sync", 1, count, now() - start, null));
+   });
+   list.push(function(done) {
+      var query = new dbx.mcursor(db, {global: GLOBAL_NAME, key: [""]}, {getdata: true});
+      var count = 0;
+      var start = now();
+
+      while (query.next() !== null) {
+         count ++;
+      }
+      done(null, result("mcursor.next scan (getdata)", "mcursor", "next", "sync", 1, count, now() - start, null));
+   });
+   list.push(function(done) {
+      var res = db.benchmark({op: "get", order: "random", keys: options.keys, global: GLOBAL_NAME});
+      done(null, {name: "native get random", api: "native", op: "get", mode: "native", threads: 1, operations: res.operations, seconds: res.seconds, ops_per_sec: Math.round(res.ops_per_sec), latency_us: {p50: res.latency_us.p50, p99: res.latency_us.p99, max: res.latency_us.max}});
+   });
+
+   if (worker_threads) {
+      for (threads = 1; threads <= options.threads; threads *= 2) {
+         list.push((function(threads) {
+            return function(done) { runWorkers(options, params, threads, done); };
+         })(threads));
+      }
+   }
+   return list;
+}
+
+function main() {
+   var options = getOptions(process.argv.slice(2));
+   var dir = (options.type == "mem") ? "" : (options.dir || fs.mkdtempSync(path.join(os.tmpdir(), "mg-dbx-bdb-bench-")));
+   var params, db, list, report, n;
+
+   if (dir && !fs.existsSync(dir)) {
+      fs.mkdirSync(dir);
+   }
+   params = openParameters(options, dir);
+   try {
+      db = openDatabase(params);
+   }
+   catch (error) {
+      if (dir && !options.keep && !options.dir) {
+         removeDirectory(dir);
+      }
+      throw error;
+   }
+
+   report = {
+      suite: "mg-dbx-bdb",
+      version: db.version(),
+      date: new Date().toISOString(),
+      node: process.version,
+      platform: process.platform,
+      arch: process.arch,
+      cpus: os.cpus().length,
+      type: options.type,
+      keys: options.keys,
+      value_size: options.value_size,
+      window: options.window,
+      results: []
+   };
+
+   list = workloads(options, db, params);
+   n = 0;
+
+   function finish(error) {
+      var json;
+
+      db.close();
+      if (dir && !options.keep && !options.dir) {
+         removeDirectory(dir);
+      }
+      if (error) {
+         console.error(error.message);
+         process.exitCode = 1;
+         return;
+      }
+      json = JSON.stringify(report, null, 2);
+      if (options.out)
+         fs.writeFileSync(options.out, json + "\n");
+      else
+         console.log(json);
+   }
+
+   function next(error, res) {
+      if (error) {
+         finish(error);
+         return;
+      }
+      if (res) {
+         report.results.push(res);
+         console.error(res.name + ": " + res.ops_per_sec + " ops/sec");
+      }
+      if (n == list.length) {
+         finish(null);
+         return;
+      }
+      try {
+         list[n ++](next);
+      }
+      catch (error) {
+         finish(error);
+      }
+   }
+
+   next(null, null);
+}
+
+if (worker_threads && !worker_threads.isMainThread)
+   runWorker();
+else
+   main();
@@ -5,7 +5,17 @@
       "sources": [
                     "src/mg-dbx-bdb.cpp",
                     "src/mg-global.cpp",
-                    "src/mg-cursor.cpp"
+                    "src/mg-cursor.cpp",
+                    "src/mg-lz4.cpp",
+                    "src/mg-memdb.cpp"
+                 ]
+    },
+    {
+      "target_name": "mg-lz4-test",
+      "type": "executable",
+      "sources": [
+                    "test/mg-lz4-test.cpp",
+                    "src/mg-lz4.cpp"
                  ]
     }
   ]
@@ -0,0 +1,90 @@
+//
+// mg-dbx-bdb.node: Streaming a large value to and from the database using the range functions
+//
+
+var bdb = require('mg-dbx-bdb').dbxbdb;
+var mglobal = require('mg-dbx-bdb').mglobal;
+var stream = require('stream');
+var db = new bdb();
+
+var lmdb = process.argv[2];
+
+// Modify the parameters in the open() method to suit your installation
+
+if (process.platform == 'win32') {
+   if (lmdb == 1)
+      var open = db.open({type: "LMDB", db_library: "c:/LMDBWindows/lib/LMDBWindowsDll64.dll", env_dir: "c:/bdb/m", key_type: "m"});
+   else
+      var open = db.open({type: "BDB", db_library: "c:/c/bdb/libdb181.dll", db_file: "c:/bdb/m.db", key_type: "m"});
+}
+else {
+   if (lmdb == 1)
+      var open = db.open({type: "LMDB", db_library: "liblmdb.so", env_dir: "/opt/bdb/m", key_type: "m"});
+   else
+      var open = db.open({type: "BDB", db_library: "/usr/local/BerkeleyDB.18.1/lib/libdb.so", db_file: "/opt/bdb/m.db", key_type: "m"});
+}
+
+console.log("Version: " + db.version());
+
+// A Readable stream over the value held at <global>(<keys>) - read_range() returns the data as a Buffer
+
+function createReadStream(global, keys, chunk_size) {
+   var offset = 0;
+   chunk_size = chunk_size || 65536;
+
+   return new stream.Readable({
+      read() {
+         var self = this;
+         global.read_range(...keys, offset, chunk_size, function(error, result) {
+            if (error) {
+               self.destroy(new Error(db.geterrormessage()));
+               return;
+            }
+            offset += result.length;
+            self.push(result.length > 0 ? result : null);
+         });
+      }
+   });
+}
+
+// A Writable stream that replaces the value held at <global>(<keys>) - each chunk is added with append()
+
+function createWriteStream(global, keys) {
+   global.set(...keys, "");
+
+   return new stream.Writable({
+      write(chunk, encoding, callback) {
+         global.append(...keys, chunk, function(error, result) {
+            callback(error ? new Error(db.geterrormessage()) : null);
+         });
+      }
+   });
+}
+
+var document = new mglobal(db, "document");
+var source = Buffer.alloc(1024 * 1024, "abcdefghijklmnopqrstuvwxyz");
+
+console.log("\nWriting a 1MB document in 64KB chunks ...");
+var ws = createWriteStream(document, [1]);
+stream.Readable.from([source.subarray(0, 65536), source.subarray(65536)]).pipe(ws);
+
+ws.on('finish', function() {
+   console.log("Document length: " + document.get_bx(1).length);
+
+   console.log("\nReading the document back in 100KB chunks ...");
+   var received = 0;
+   var rs = createReadStream(document, [1], 100 * 1024);
+   rs.on('data', function(chunk) {
+      received += chunk.length;
+   });
+   rs.on('end', function() {
+      console.log("Received " + received + " bytes");
+      console.log("Bytes 26 to 35: " + document.read_range(1, 26, 10).toString());
+
+      console.log("\nOverwriting bytes 0 to 4 ...");
+      console.log("Length: " + document.write_range(1, 0, "ABCDE"));
+      console.log("Bytes 0 to 9: " + document.read_range(1, 0, 10).toString());
+
+      db.close();
+   });
+});
@@ -30,7 +30,7 @@
 using namespace v8;
 using namespace node;
 
-Persistent<Function> mcursor::constructor;
+thread_local Persistent<Function> mcursor::constructor; /* v1.3.32 */
 
 mcursor::mcursor(int value) : dbx_count(value)
 {
@@ -435,7 +435,7 @@ void mcursor::Next(const FunctionCallbackInfo<Value>& args)
             dbx_escape_output(&(cx->data), (char *) "key=", 4, 0);
             dbx_escape_output(&(cx->data), cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.buf_addr, cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.len_used, 1);
             dbx_escape_output(&(cx->data), (char *) "&data=", 6, 0);
-            dbx_escape_output(&(cx->data), cx->pqr_prev->data.svalue.buf_addr, cx->pqr_prev->data.svalue.len_used, 1);
+            dbx_escape_value(pcon, &(cx->data), cx->pqr_prev->data.svalue.buf_addr, cx->pqr_prev->data.svalue.len_used); /* v1.3.24 */
             key = dbx_new_string8n(isolate, (char *) cx->data.buf_addr, cx->data.len_used, 0);
             args.GetReturnValue().Set(key);
          }
@@ -445,7 +445,7 @@ void mcursor::Next(const FunctionCallbackInfo<Value>& args)
             key = dbx_new_string8(isolate, (char *) "key", 0);
             DBX_SET(obj, key, dbx_new_string8n(isolate, cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.buf_addr, cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.len_used, pcon->utf8));
             key = dbx_new_string8(isolate, (char *) "data", 0);
-            DBX_SET(obj, key, dbx_new_string8n(isolate, cx->pqr_prev->data.svalue.buf_addr, cx->pqr_prev->data.svalue.len_used, 0));
+            DBX_SET(obj, key, dbx_new_data8n(isolate, pcon, &(cx->pqr_prev->data), 0)); /* v1.3.27 */
             args.GetReturnValue().Set(obj);
          }
       }
@@ -481,7 +481,7 @@ void mcursor::Next(const FunctionCallbackInfo<Value>& args)
          if (cx->getdata) {
             sprintf(buffer, (char *) "%sdata=", delim);
             dbx_escape_output(&(cx->data), buffer, (int) strlen(buffer), 0);
-            dbx_escape_output(&(cx->data), cx->pqr_next->data.svalue.buf_addr, cx->pqr_next->data.svalue.len_used, 1);
+            dbx_escape_value(pcon, &(cx->data), cx->pqr_next->data.svalue.buf_addr, cx->pqr_next->data.svalue.len_used); /* v1.3.24 */
          }
 
          key = dbx_new_string8n(isolate, (char *) cx->data.buf_addr, cx->data.len_used, 0);
@@ -512,7 +512,7 @@ void mcursor::Next(const FunctionCallbackInfo<Value>& args)
             }
             if (cx->getdata) {
                key = dbx_new_string8(isolate, (char *) "data", 0);
-               DBX_SET(obj, key, dbx_new_string8n(isolate, cx->pqr_next->data.svalue.buf_addr, cx->pqr_next->data.svalue.len_used, 0));
+               DBX_SET(obj, key, dbx_new_data8n(isolate, pcon, &(cx->pqr_next->data), 0)); /* v1.3.27 */
             }
          }
       }
@@ -704,7 +704,7 @@ void mcursor::Previous(const FunctionCallbackInfo<Value>& args)
             dbx_escape_output(&cx->data, (char *) "key=", 4, 0);
             dbx_escape_output(&cx->data, cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.buf_addr, cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.len_used, 1);
             dbx_escape_output(&cx->data, (char *) "&data=", 6, 0);
-            dbx_escape_output(&cx->data, cx->pqr_prev->data.svalue.buf_addr, cx->pqr_prev->data.svalue.len_used, 1);
+            dbx_escape_value(pcon, &(cx->data), cx->pqr_prev->data.svalue.buf_addr, cx->pqr_prev->data.svalue.len_used); /* v1.3.24 */
             key = dbx_new_string8n(isolate, (char *) cx->data.buf_addr, cx->data.len_used, 0);
             args.GetReturnValue().Set(key);
          }
@@ -714,7 +714,7 @@ void mcursor::Previous(const FunctionCallbackInfo<Value>& args)
             key = dbx_new_string8(isolate, (char *) "key", 0);
             DBX_SET(obj, key, dbx_new_string8n(isolate, cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.buf_addr, cx->pqr_prev->key.args[cx->pqr_prev->key.argc - 1].svalue.len_used, pcon->utf8));
             key = dbx_new_string8(isolate, (char *) "data", 0);
-            DBX_SET(obj, key, dbx_new_string8n(isolate, cx->pqr_prev->data.svalue.buf_addr, cx->pqr_prev->data.svalue.len_used, 0));
+            DBX_SET(obj, key, dbx_new_data8n(isolate, pcon, &(cx->pqr_prev->data), 0)); /* v1.3.27 */
             args.GetReturnValue().Set(obj);
          }
       }
@@ -750,7 +750,7 @@ void mcursor::Previous(const FunctionCallbackInfo<Value>& args)
          if (cx->getdata) {
             sprintf(buffer, (char *) "%sdata=", delim);
             dbx_escape_output(&(cx->data), buffer, (int) strlen(buffer), 0);
-            dbx_escape_output(&(cx->data), cx->pqr_next->data.svalue.buf_addr, cx->pqr_next->data.svalue.len_used, 1);
+            dbx_escape_value(pcon, &(cx->data), cx->pqr_next->data.svalue.buf_addr, cx->pqr_next->data.svalue.len_used); /* v1.3.24 */
          }
 
          key = dbx_new_string8n(isolate, (char *) cx->data.buf_addr, cx->data.len_used, 0);
@@ -784,7 +784,7 @@ void mcursor::Previous(const FunctionCallbackInfo<Value>& args)
             }
             if (cx->getdata) {
                key = dbx_new_string8(isolate, (char *) "data", 0);
-               DBX_SET(obj, key, dbx_new_string8n(isolate, cx->pqr_next->data.svalue.buf_addr, cx->pqr_next->data.svalue.len_used, 0));
+               DBX_SET(obj, key, dbx_new_data8n(isolate, pcon, &(cx->pqr_next->data), 0)); /* v1.3.27 */
             }
          }
       }
@@ -75,10 +75,11 @@ public:
 private:
 
    static void       New                     (const v8::FunctionCallbackInfo<v8::Value>& args);
-   static v8::Persistent<v8::Function>       constructor;
+   static thread_local v8::Persistent<v8::Function> constructor; /* v1.3.32 */
 };
 
 int dbx_escape_output(DBXSTR *pdata, char *item, int item_len, short context);
+int dbx_escape_value(DBXCON *pcon, DBXSTR *pdata, char *item, int item_len);
 
 #endif
 
@@ -102,6 +102,134 @@ Version 1.3.13 21 May 2024:
 Version 1.3.14 29 May 2025:
    Verify that mg-dbx-bdb will build and work with Node.js v24.x.x.
 
+Version 1.3.15 18 October 2026:
+   Introduce an option to hold each global in its own database (LMDB named database or BDB sub-database).
+	- Specify the 'global_dbs' property in the 'open()' method (default is 'false').
+	- The maximum number of databases can be set with the 'max_dbs' property in the 'open()' method.
+   Killing a whole global (or deleting the last node of a global) drops its database.
+	- mglobal objects cache the position of their global's database in the table (with the connection's generation) rather than a pointer into it, as the table is freed when the environment is closed.
+	- Reads of a global that has no database of its own return 'not found' instead of reading the main database.
+	- A global is entered in the table of databases only once its database has been opened, so reading globals that do not exist no longer uses up the table.
+	- Globals are found in the table through a hash index rather than by a linear search.
+	- Exceeding 'max_dbs' reports its own error message rather than an unknown database error.
+
+Version 1.3.16 18 October 2026:
+   Encode the global name and fixed subscripts of a mglobal object once (when the object is created or reset) rather than on every call.
+
+Version 1.3.17 18 October 2026:
+   Improve the performance of key traversal (next/previous and mcursor operations).
+	- Only the subscript at the level being traversed is located in each key read from the database: keys are no longer split into all of their subscripts on every step.
+
+Version 1.3.18 18 October 2026:
+   Improve the performance of key comparisons made while traversing the database.
+	- bdb_key_compare() and lmdb_key_compare() share a single memcmp based implementation with a prefix (subtree) test that exits early on length and on the final prefix byte.
+
+Version 1.3.19 18 October 2026:
+   Improve the performance of transferring strings between JavaScript and the database.
+	- Keys and data values are written to the input buffer in a single pass (previously the UTF-8 length was computed first).
+	- Strings returned to JavaScript that contain only ASCII characters are created without UTF-8 decoding.
+	- dbx_ibuffer_add() copies one-byte (Latin-1) strings with WriteOneByte() and keeps the copy if it is ASCII, so that UTF-8 encoding is only used for strings that need it.
+
+Version 1.3.20 18 October 2026:
+   Introduce db.get_view(): zero-copy reads from the LMDB memory map.
+	- The returned Buffer refers to the record in the map and holds a read snapshot open until it is garbage collected.
+	- Correct get_bx() so that it copies the result into the Buffer rather than passing ownership of the request buffer to Node.js.
+	- close() detaches the ArrayBuffers of the get_view() buffers still held by JavaScript before the snapshots are ended and the map is closed.
+
+Version 1.3.21 18 October 2026:
+   Introduce db.get_into() and mglobal::get_into() to read records into a Buffer supplied by the application.
+	- Berkeley DB writes the record directly into the target buffer (DB_DBT_USERMEM).
+	- The length of the record is returned, or minus the length required if the space available is too small.
+	- Correct get_bx() (mglobal and asynchronous calls) so that it copies the result into the Buffer returned.
+
+Version 1.3.22 18 October 2026:
+   Introduce functions for reading and writing part of a value: read_range(), write_range() and append().
+	- Berkeley DB uses partial record access (DB_DBT_PARTIAL) so that only the bytes requested are transferred.
+	- LMDB (M mode): values extended beyond 64KB by write_range() and append() are held in fixed-size chunks under the hidden global ^%dbxchunk, so that these functions read and write only the chunks concerned.
+	- Add samples/stream.js: an example of Node.js Readable and Writable streams built on these functions (the module itself provides no stream objects).
+
+Version 1.3.23 18 October 2026:
+   Introduce optional value compression (LZ4) for large values: the compression property for open() and mglobal::compression().
+	- Compressed values are decompressed transparently by get(), get_into(), get_view(), the range functions and cursors.
+
+Version 1.3.24 18 October 2026:
+   Introduce typed values: numbers and booleans are stored in binary form if the typed_values property is set in open().
+	- get(), increment() and cursors return typed values as JavaScript numbers and booleans.
+
+Version 1.3.25 18 October 2026:
+   Introduce mglobal::set_object() and mglobal::get_object() to save and load a JavaScript object as a subtree in a single call.
+	- The object is encoded (or the subtree read) in one pass and the records are written in a single LMDB transaction.
+	- mglobal::set_object() encodes the object before the connection is locked: the lock is held for the writes only.
+
+Version 1.3.26 18 October 2026:
+   Introduce secondary indexes: db.define_index() declares an index for a global and builds it for the existing records.
+	- Index entries are maintained by set(), delete() and mglobal::set_object() in the same operation as the update.
+
+Version 1.3.27 18 October 2026:
+   Introduce time to live for nodes: set(..., {ttl: <seconds>}) gives a node a deadline after which it reads as undefined.
+	- Expired nodes are removed in batches by a background sweeper (open() property ttl_sweep) or by db.sweep().
+	- Escape values that begin with the header bytes (0x00 0xDB) as they are written: they are stored behind a 'Z' header with algorithm 0 (DBX_COMPRESS_NONE) so that they are never read as a typed, compressed or expiring value.
+	- defined(), next() and previous() treat a node whose time to live has passed as undefined before it is swept.
+	- $query (multilevel) cursors skip expired nodes (dbx_global_query()) and global directory cursors skip globals whose nodes have all expired (dbx_global_live()).
+	- A reverse $query cursor ends at the first record before its range instead of returning the previous result again.
+	- With LMDB, a $query cursor keeps a copy of the key it returns: the next call seeks from it (previously lost when data was also requested).
+
+Version 1.3.28 18 October 2026:
+   Grow the LMDB map automatically when a write fails with MDB_MAP_FULL.
+	- Writes by set(), increment(), merge() and set_object() are repeated once the map has been grown (open() properties db_growth and db_size_max).
+	- Introduce db.map_size() to report the map size and number of resizes, and to grow the map in advance of a large load.
+	- lmdb_map_grow() refuses to resize the map while other connections share the environment, and holds the global mutex until the resize is complete.
+
+Version 1.3.29 18 October 2026:
+   Introduce open() properties for durability and mapping: sync ("full", "meta" or "none"), writemap and readahead.
+	- Introduce db.sync() and the sync_interval property to flush committed updates to disk on a background thread.
+
+Version 1.3.30 18 October 2026:
+   Introduce open() properties to configure BDB: cache_size, cache_regions, page_size, bt_minkey, mmap_size and concurrency ("cdb" or "txn").
+	- Introduce db.cache_stats() to report the size and hit ratio of the BDB cache.
+
+Version 1.3.31 18 October 2026:
+   Implement db.benchmark() to run get, set, next, $query and increment workloads natively and report the throughput and latency percentiles.
+
+Version 1.3.32 18 October 2026:
+   Introduce a benchmark suite (bench/bench.js, npm run bench) that reports the performance of the public API as JSON.
+	- Hold the class constructors per thread so that the module can be loaded by more than one Node.js worker thread.
+
+Version 1.3.33 18 October 2026:
+   Introduce db.stats() to report per-operation counts and latency histograms (sync, async and queue wait) collected without locks.
+	- Introduce the stats property for open() (default false).
+	- The operations run by db.benchmark() are not counted by db.stats().
+
+Version 1.3.34 18 October 2026:
+   Introduce db.engine_stats() to report the storage engine's own statistics: B-tree depth and page counts, LMDB map usage, last transaction id and readers, and the BDB cache hit, miss and page-in counts.
+	- The page counts are also reported for each global when global_dbs is set.
+
+Version 1.3.35 18 October 2026:
+   Write the Event Log asynchronously: records are queued in a lock-free ring and written in batches by a background thread that holds the log file open.
+	- Rotate the log file when it reaches a set size (max_size, default 64MB, keeping 4 files) and count records dropped when the ring is full.
+	- The original synchronous behaviour is available with the sync option of setloglevel().
+
+Version 1.3.36 18 October 2026:
+   Introduce db.trace() to record the phases of a sample of requests (argument marshalling, mutex wait, queue wait, engine call and result conversion) as a Chrome trace.
+	- Trace events are written by a second instance of the background log writer.
+
+Version 1.3.37 18 October 2026:
+   Introduce db.lock_stats() to report contention on the connection mutex and the thread pool mutexes: acquisitions, contended acquisitions, total and maximum wait and hold times.
+	- Collection is off by default and is process wide.
+
+Version 1.3.38 18 October 2026:
+   Introduce db.memory_stats() to account for the memory allocated by dbx_malloc(): live bytes, live blocks, allocations, frees and high water mark for each call site.
+	- Each block now carries its size and call site id.
+	- Fix a memory leak in db.logmessage(): the message and title buffers were not freed.
+
+Version 1.3.39 18 October 2026:
+   Introduce an in-memory storage engine (open() type "MEM"): a B+tree held in process memory and presented through the LMDB interface, so no database library is needed.
+	- The engine is in src/mg-memdb.cpp; connections opened with type "MEM" use the LMDB code paths.
+	- Free the (reset) read only LMDB transaction when the last connection is closed.
+	- Fix dbx_merge(), which did not release the connection mutex.
+	- Introduce a suite of smoke tests (test/test.js, npm test) run against the MEM storage engine.
+	- Introduce tests for the LZ4 codec (test/mg-lz4-test.cpp, built as mg-lz4-test): round trips and the decoder's bounds checks on corrupted input.
+
 */
 
 
@@ -118,12 +246,16 @@ Berkeley DB: recover database after a crash:
 #include "mg-dbx-bdb.h"
 #include "mg-global.h"
 #include "mg-cursor.h"
+#include "mg-lz4.h"
+#include "mg-memdb.h"
 
 
 #if defined(_WIN32)
 #define DBX_LOG_FILE    "c:/temp/mg-dbx-bdb.log"
+#define DBX_TRACE_FILE  "c:/temp/mg-dbx-bdb-trace.json"
 #else
 #define DBX_LOG_FILE    "/tmp/mg-dbx-bdb.log"
+#define DBX_TRACE_FILE  "/tmp/mg-dbx-bdb-trace.json"
 extern int errno;
 #endif
 
@@ -154,7 +286,28 @@ DBXCON * pcon_api = NULL;
 
 DBXBDBSO *  p_bdb_so_global = NULL;
 DBXLMDBSO * p_lmdb_so_global = NULL;
+DBXLMDBSO * p_memdb_so_global = NULL; /* v1.3.39 */
 DBXMUTEX    mutex_global;
+DBXLOG      dbx_log; /* v1.3.35 */
+DBXLOG      dbx_trace_log; /* v1.3.36 */
+static int  dbx_log_atexit = 0;
+
+/* v1.3.37 lock contention statistics (process wide: the connection mutex and the thread pool are shared by all connections) */
+int                  dbx_lock_stats_enabled  = 0;
+unsigned long long   dbx_lock_stats_since    = 0;
+DBXLOCKSTATS         dbx_task_queue_lstats;
+DBXLOCKSTATS         dbx_pool_lstats;
+DBXLOCKSTATS         dbx_result_lstats;
+
+/* v1.3.38 allocation accounting by call site (the last entry holds the totals) */
+int                  dbx_mem_enabled         = 0;
+volatile unsigned int dbx_mem_epoch          = 0;
+unsigned long long   dbx_mem_since           = 0;
+DBXMEMSTATS          dbx_mem_stats[DBX_MEMID_MAX + 1];
+static const char *  dbx_mem_names[DBX_MEMID_MAX] = {"other", "connection", "request", "query", "key", "buffer", "value", "global", "cursor", "index", "engine", "task", "log", "benchmark", "store"};
+
+/* v1.3.33 names of the commands for which statistics are collected (v1.3.36 and traced) */
+static const char *dbx_stats_cmnds[DBX_STATS_CMNDS] = {"set", "get", "next", "previous", "delete", "defined", "increment", "lock", "unlock", "merge", "query"};
 
 using namespace node;
 using namespace v8;
@@ -236,6 +389,11 @@ void DBX_DBNAME::Init(Handle<Object> exports)
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "close", Close);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get", Get);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get_bx", Get_bx);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get_view", Get_view);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get_into", Get_into);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "read_range", Read_range);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "write_range", Write_range);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "append", Append);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "set", Set);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "defined", Defined);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "delete", Delete);
@@ -244,6 +402,16 @@ void DBX_DBNAME::Init(Handle<Object> exports)
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "increment", Increment);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "lock", Lock);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "unlock", Unlock);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "define_index", Define_index);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "sweep", Sweep);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "map_size", Map_size);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "sync", Sync);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "cache_stats", Cache_stats);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "stats", Stats);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "engine_stats", Engine_stats);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "trace", Trace);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "lock_stats", Lock_stats);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "memory_stats", Memory_stats);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "mglobal", MGlobal);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "mglobal_close", MGlobal_Close);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "mglobalquery", MGlobalQuery);
@@ -309,7 +477,7 @@ void DBX_DBNAME::New(const FunctionCallbackInfo<Value>& args)
    c->isolate = NULL;
    c->got_icontext = 0;
 
-   c->pcon = (DBXCON *) dbx_malloc(sizeof(DBXCON), 0);
+   c->pcon = (DBXCON *) dbx_malloc(sizeof(DBXCON), DBX_MEMID_CON);
    memset((void *) c->pcon, 0, sizeof(DBXCON));
 
    c->pcon->p_mutex = &mutex_global;
@@ -321,16 +489,42 @@ void DBX_DBNAME::New(const FunctionCallbackInfo<Value>& args)
    c->pcon->db_library[0] = '\0';
    c->pcon->db_file[0] = '\0';
    c->pcon->db_size = 0;
+   c->pcon->db_growth = DBX_DB_GROWTH; /* v1.3.28 */
+   c->pcon->db_size_max = 0;
+   c->pcon->db_resizes = 0;
    c->pcon->env_dir[0] = '\0';
    c->pcon->key_type = 0;
    c->pcon->use_mutex = 1;
    c->pcon->p_bdb_so = NULL;
    c->pcon->p_lmdb_so = NULL;
 
+   /* v1.3.15 */
+   c->pcon->global_dbs = 0;
+   c->pcon->max_dbs = 0;
+   c->pcon->gdb_gen = 0; /* v1.3.15 */
+
+   /* v1.3.23 */
+   c->pcon->comp.algo = DBX_COMPRESS_NONE;
+   c->pcon->comp.min_size = DBX_COMPRESS_MIN_SIZE;
+
+   c->pcon->typed_values = 0; /* v1.3.24 */
+   c->pcon->pindex = NULL; /* v1.3.26 */
+   memset((void *) &(c->pcon->ttl), 0, sizeof(DBXTIMER)); /* v1.3.27 */
+   c->pcon->ttl.interval = DBX_TTL_SWEEP;
+   memset((void *) &(c->pcon->flush), 0, sizeof(DBXTIMER)); /* v1.3.29 */
+   c->pcon->sync_mode = DBX_SYNC_FULL;
+   c->pcon->writemap = 0;
+   c->pcon->readahead = 1;
+   memset((void *) &(c->pcon->bdb), 0, sizeof(DBXBDBCFG)); /* v1.3.30 */
+   c->pcon->bdb.cache_regions = 1;
+   c->pcon->stats = 0; /* v1.3.33 off unless requested */
+   c->pcon->pstats = NULL;
+
    c->pcon->tlevel = 0;
    c->pcon->tlevelro = 0;
    c->pcon->tstatus = 0;
    c->pcon->tstatusro = 0;
+   c->pcon->psnap = NULL; /* v1.3.20 */
 
    /* v1.3.10 */
    c->pcon->error[0] = '\0';
@@ -383,6 +577,10 @@ int DBX_DBNAME::dbx_queue_task(void * work_cb, void * after_work_cb, DBX_DBNAME:
    uv_work_t *_req = new uv_work_t;
    _req->data = baton;
 
+   if (baton->pmeth && baton->pmeth->pcon && (baton->pmeth->pcon->pstats || baton->pmeth->trace)) { /* v1.3.33 */
+      baton->pmeth->tqueue = dbx_clock_ns();
+   }
+
 #if DBX_NODE_VERSION >= 120000
    uv_queue_work(GetCurrentEventLoop(baton->isolate), _req, (uv_work_cb) work_cb, (uv_after_work_cb) after_work_cb);
 #else
@@ -397,6 +595,10 @@ async_rtn DBX_DBNAME::dbx_process_task(uv_work_t *req)
 {
    DBX_DBNAME::dbx_baton_t *baton = static_cast<DBX_DBNAME::dbx_baton_t *>(req->data);
 
+   if (baton->pmeth->trace && baton->pmeth->tqueue) { /* v1.3.36 */
+      dbx_trace_span(baton->pmeth, DBX_TRACE_QUEUE, baton->pmeth->tqueue, dbx_clock_ns());
+   }
+
    dbx_launch_thread(baton->pmeth);
 
    baton->c->dbx_count += 1;
@@ -424,6 +626,10 @@ async_rtn DBX_DBNAME::dbx_invoke_callback(uv_work_t *req)
 
    dbx_baton_t *baton = static_cast<dbx_baton_t *>(req->data);
 
+   if (baton->pmeth->trace) { /* v1.3.36 */
+      baton->pmeth->tresult = dbx_clock_ns();
+   }
+
    if (baton->gx)
       ((mglobal *) baton->gx)->async_callback((mglobal *) baton->gx);
    else if (baton->cx)
@@ -439,9 +645,18 @@ async_rtn DBX_DBNAME::dbx_invoke_callback(uv_work_t *req)
       argv[0] = DBX_INTEGER_NEW(false);
 
    if (baton->pmeth->binary) {
-      baton->result_obj = node::Buffer::New(isolate, (char *) baton->pmeth->output_val.svalue.buf_addr, (size_t) baton->pmeth->output_val.svalue.len_used).ToLocalChecked();
+      baton->result_obj = node::Buffer::Copy(isolate, (char *) baton->pmeth->output_val.svalue.buf_addr, (size_t) baton->pmeth->output_val.svalue.len_used).ToLocalChecked();
       argv[1] = baton->result_obj;
    }
+   else if (baton->pmeth->tvalue == DBX_TVALUE_OUT && baton->c->pcon->typed_values) { /* v1.3.24 */
+      argv[1] = dbx_new_value8n(isolate, baton->c->pcon, baton->pmeth->output_val.svalue.buf_addr, baton->pmeth->output_val.svalue.len_used, baton->c->pcon->utf8);
+   }
+#if DBX_NODE_VERSION >= 80000
+   else if (baton->pmeth->json && !baton->pmeth->pcon->error[0]) { /* v1.3.31 */
+      baton->result_str = dbx_new_string8n(isolate, baton->pmeth->output_val.svalue.buf_addr, baton->pmeth->output_val.svalue.len_used, 0);
+      argv[1] = v8::JSON::Parse(isolate->GetCurrentContext(), baton->result_str).ToLocalChecked();
+   }
+#endif
    else {
       baton->result_str = dbx_new_string8n(isolate, baton->pmeth->output_val.svalue.buf_addr, baton->pmeth->output_val.svalue.len_used, baton->c->pcon->utf8);
       argv[1] = baton->result_str;
@@ -453,6 +668,11 @@ async_rtn DBX_DBNAME::dbx_invoke_callback(uv_work_t *req)
 
    Local<Function> cb = Local<Function>::New(isolate, baton->cb);
 
+   if (baton->pmeth->trace) { /* v1.3.36 the time taken by the callback itself is not part of the result phase */
+      dbx_trace_span(baton->pmeth, DBX_TRACE_RESULT, baton->pmeth->tresult, dbx_clock_ns());
+      baton->pmeth->tresult = 0;
+   }
+
 #if DBX_NODE_VERSION >= 120000
    /* cb->Call(isolate->GetCurrentContext(), isolate->GetCurrentContext()->Global(), 2, argv); */
    cb->Call(isolate->GetCurrentContext(), Null(isolate), 2, argv).ToLocalChecked();
@@ -606,6 +826,8 @@ void DBX_DBNAME::SetLogLevel(const FunctionCallbackInfo<Value>& args)
    int js_narg;
    char buffer[256];
    DBXCON *pcon;
+   Local<Object> obj;
+   Local<String> key;
    Local<String> str;
    Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
@@ -656,6 +878,30 @@ void DBX_DBNAME::SetLogLevel(const FunctionCallbackInfo<Value>& args)
          strcat(pcon->log_filter, ",");
       }
    }
+   if (js_narg > 3 && args[3]->IsObject()) { /* v1.3.35 the writer is shared by all connections in the process */
+      obj = DBX_TO_OBJECT(args[3]);
+      dbx_log_config(&dbx_log);
+      key = dbx_new_string8(isolate, (char *) "sync", 1);
+      if (DBX_GET(obj, key)->IsBoolean()) {
+         dbx_log.sync = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+      }
+      key = dbx_new_string8(isolate, (char *) "max_size", 1);
+      if (DBX_GET(obj, key)->IsNumber()) {
+         dbx_log.max_size = (size_t) DBX_NUMBER_VALUE(DBX_GET(obj, key));
+      }
+      else if (DBX_GET(obj, key)->IsString()) {
+         str = DBX_TO_STRING(DBX_GET(obj, key));
+         DBX_WRITE_UTF8(str, buffer, sizeof(buffer));
+         dbx_log.max_size = dbx_parse_size(buffer);
+      }
+      key = dbx_new_string8(isolate, (char *) "files", 1);
+      if (DBX_GET(obj, key)->IsNumber()) {
+         dbx_log.files = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         if (dbx_log.files < 0) {
+            dbx_log.files = 0;
+         }
+      }
+   }
    result = dbx_new_string8(isolate, (char *) pcon->log_file, pcon->utf8);
    args.GetReturnValue().Set(result);
 
@@ -702,7 +948,7 @@ void DBX_DBNAME::LogMessage(const FunctionCallbackInfo<Value>& args)
       str = DBX_TO_STRING(args[0]);
       str_len = dbx_string8_length(isolate, str, 0);
 
-      message = (char *) dbx_malloc(str_len + 32, 0);
+      message = (char *) dbx_malloc(str_len + 32, DBX_MEMID_LOG);
       if (message) {
          DBX_WRITE_UTF8(str, message, str_len);
       }
@@ -712,7 +958,7 @@ void DBX_DBNAME::LogMessage(const FunctionCallbackInfo<Value>& args)
       str = DBX_TO_STRING(args[1]);
       str_len = dbx_string8_length(isolate, str, 0);
 
-      title = (char *) dbx_malloc(str_len + 32, 0);
+      title = (char *) dbx_malloc(str_len + 32, DBX_MEMID_LOG);
       if (title) {
          DBX_WRITE_UTF8(str, title, str_len);
       }
@@ -721,6 +967,12 @@ void DBX_DBNAME::LogMessage(const FunctionCallbackInfo<Value>& args)
    if (message && title) {
       dbx_log_event(pcon, message, title, 0);
    }
+   if (message) { /* v1.3.38 */
+      dbx_free((void *) message, DBX_MEMID_LOG);
+   }
+   if (title) {
+      dbx_free((void *) title, DBX_MEMID_LOG);
+   }
 
    result = dbx_new_string8(isolate, (char *) "", pcon->utf8);
    args.GetReturnValue().Set(result);
@@ -857,10 +1109,15 @@ void DBX_DBNAME::Open(const FunctionCallbackInfo<Value>& args)
          DBX_WRITE_UTF8(value, pcon->type, sizeof(pcon->type));
          dbx_lcase(pcon->type);
 
+         pcon->memdb = 0;
          if (!strcmp(pcon->type, "bdb"))
             pcon->dbtype = DBX_DBTYPE_BDB;
          else if (!strcmp(pcon->type, "lmdb"))
             pcon->dbtype = DBX_DBTYPE_LMDB;
+         else if (!strcmp(pcon->type, "mem")) { /* v1.3.39 */
+            pcon->dbtype = DBX_DBTYPE_LMDB;
+            pcon->memdb = 1;
+         }
       }
       else if (!strcmp(name, (char *) "db_library")) {
          value = DBX_TO_STRING(DBX_GET(obj, key));
@@ -873,20 +1130,22 @@ void DBX_DBNAME::Open(const FunctionCallbackInfo<Value>& args)
       else if (!strcmp(name, (char *) "db_size")) {
          value = DBX_TO_STRING(DBX_GET(obj, key));
          DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
-         dbx_lcase(buffer);
-         pcon->db_size = (size_t) strtol(buffer, NULL, 10);
-         if (pcon->db_size) {
-            if (strstr(buffer, "k"))
-               pcon->db_size *= 1000;
-            else if (strstr(buffer, "m"))
-               pcon->db_size *= (1000 * 1000);
-            else if (strstr(buffer, "g"))
-               pcon->db_size *= (1000 * 1000 * 1000);
-         }
-         else { /* invalid value */
+         pcon->db_size = dbx_parse_size(buffer);
+         if (!pcon->db_size) { /* invalid value */
             pcon->db_size = DBX_DB_SIZE;
          }
       }
+      else if (!strcmp(name, (char *) "db_size_max")) { /* v1.3.28 */
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+         pcon->db_size_max = dbx_parse_size(buffer);
+      }
+      else if (!strcmp(name, (char *) "db_growth")) { /* v1.3.28 */
+         pcon->db_growth = DBX_NUMBER_VALUE(DBX_GET(obj, key));
+         if (pcon->db_growth <= 1.0) {
+            pcon->db_growth = 0;
+         }
+      }
       else if (!strcmp(name, (char *) "env_dir")) {
          value = DBX_TO_STRING(DBX_GET(obj, key));
          DBX_WRITE_UTF8(value, pcon->env_dir, sizeof(pcon->env_dir));
@@ -945,6 +1204,111 @@ void DBX_DBNAME::Open(const FunctionCallbackInfo<Value>& args)
             }
          }
       }
+      else if (!strcmp(name, (char *) "global_dbs")) { /* v1.3.15 */
+        if (DBX_GET(obj, key)->IsBoolean()) {
+            if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
+               pcon->global_dbs = 1;
+            }
+         }
+      }
+      else if (!strcmp(name, (char *) "max_dbs")) { /* v1.3.15 */
+         pcon->max_dbs = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         if (pcon->max_dbs < 1) {
+            pcon->max_dbs = 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "typed_values")) { /* v1.3.24 */
+        if (DBX_GET(obj, key)->IsBoolean()) {
+            if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
+               pcon->typed_values = 1;
+            }
+         }
+      }
+      else if (!strcmp(name, (char *) "ttl_sweep")) { /* v1.3.27 */
+         pcon->ttl.interval = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         if (pcon->ttl.interval < 1) {
+            pcon->ttl.interval = 0;
+         }
+         pcon->ttl.autostart = 1;
+      }
+      else if (!strcmp(name, (char *) "sync")) { /* v1.3.29 */
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+         dbx_lcase(buffer);
+
+         if (!strcmp(buffer, "full"))
+            pcon->sync_mode = DBX_SYNC_FULL;
+         else if (!strcmp(buffer, "meta"))
+            pcon->sync_mode = DBX_SYNC_META;
+         else if (!strcmp(buffer, "none"))
+            pcon->sync_mode = DBX_SYNC_NONE;
+      }
+      else if (!strcmp(name, (char *) "sync_interval")) { /* v1.3.29 */
+         pcon->flush.interval = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         if (pcon->flush.interval < 1) {
+            pcon->flush.interval = 0;
+         }
+         pcon->flush.autostart = 1;
+      }
+      else if (!strcmp(name, (char *) "stats")) { /* v1.3.33 */
+        if (DBX_GET(obj, key)->IsBoolean()) {
+            pcon->stats = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "writemap")) { /* v1.3.29 */
+        if (DBX_GET(obj, key)->IsBoolean()) {
+            pcon->writemap = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "readahead")) { /* v1.3.29 */
+        if (DBX_GET(obj, key)->IsBoolean()) {
+            pcon->readahead = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "cache_size")) { /* v1.3.30 */
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+         pcon->bdb.cache_size = dbx_parse_size(buffer);
+      }
+      else if (!strcmp(name, (char *) "cache_regions")) { /* v1.3.30 */
+         pcon->bdb.cache_regions = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         if (pcon->bdb.cache_regions < 1) {
+            pcon->bdb.cache_regions = 1;
+         }
+      }
+      else if (!strcmp(name, (char *) "page_size")) { /* v1.3.30 */
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+         pcon->bdb.page_size = (unsigned int) dbx_parse_size(buffer);
+      }
+      else if (!strcmp(name, (char *) "bt_minkey")) { /* v1.3.30 */
+         pcon->bdb.minkey = (unsigned int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         if (pcon->bdb.minkey < 2 || pcon->bdb.minkey > 65535) {
+            pcon->bdb.minkey = 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "mmap_size")) { /* v1.3.30 */
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+         pcon->bdb.mmap_size = dbx_parse_size(buffer);
+      }
+      else if (!strcmp(name, (char *) "concurrency")) { /* v1.3.30 */
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+         dbx_lcase(buffer);
+
+         if (!strcmp(buffer, "txn"))
+            pcon->bdb.txn = 1;
+         else if (!strcmp(buffer, "cdb"))
+            pcon->bdb.txn = 0;
+      }
+      else if (!strcmp(name, (char *) "compression")) { /* v1.3.23 */
+         if (dbx_compression_options(isolate, icontext, DBX_GET(obj, key), &(pcon->comp)) < 0) {
+            isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Invalid compression options in the Open method", 1)));
+            dbx_request_memory_free(pcon, pmeth, 0);
+            return;
+         }
+      }
       else if (!strcmp(name, (char *) "debug")) {
          ; /* TODO */
       }
@@ -1069,6 +1433,10 @@ void DBX_DBNAME::Close(const FunctionCallbackInfo<Value>& args)
 
    c->open = 0;
 
+   if (pcon->psnap) { /* v1.3.20 views must not outlive the map */
+      lmdb_view_detach(isolate, pcon);
+   }
+
    DBX_CALLBACK_FUN(js_narg, cb, async);
 
    pcon->error[0] = '\0';
@@ -1159,7 +1527,7 @@ int DBX_DBNAME::LogFunction(DBX_DBNAME *c, const FunctionCallbackInfo<Value>& ar
       max += len[n];
    }
 
-   buffer = (char *) dbx_malloc(max + 128, 0);
+   buffer = (char *) dbx_malloc(max + 128, DBX_MEMID_LOG);
    if (!buffer)
       return -1;
 
@@ -1210,6 +1578,7 @@ Local<String> DBX_DBNAME::StringifyJSON(DBX_DBNAME *c, Local<Object> json)
 int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>& args, DBXMETH *pmeth, DBXGREF *pgref, short context)
 {
    int n, nx, rc, otype, len;
+   unsigned long long tmarshal;
    char *p;
    char buffer[64];
    DBXVAL *pval;
@@ -1220,18 +1589,32 @@ int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>
 
    pmeth->key.ibuffer.len_used = 0;
    pmeth->key.argc = 0;
+   pmeth->pgdb = NULL; /* v1.3.15 */
+   pmeth->pgdbref = (pgref ? pgref->pgdbref : NULL); /* v1.3.15 */
+   pmeth->pcomp = ((pgref && pgref->pcomp && pgref->pcomp->algo != DBX_COMPRESS_DEFAULT) ? pgref->pcomp : &(pcon->comp)); /* v1.3.23 */
    rc = 0;
 
    if (!context) {
-      DBX_DB_LOCK(0);
+      DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
    }
+   tmarshal = (pmeth->trace ? dbx_clock_ns() : 0);
 
    str = dbx_new_string8(isolate, (char *) "", pcon->utf8);
    pmeth->output_val.svalue.len_used = 0;
    nx = 0;
-   n = 0;
+   n = pmeth->jsarg0; /* v1.3.21 */
 
-   if (pcon->key_type == DBX_KEYTYPE_M) {
+   if (pcon->key_type == DBX_KEYTYPE_M && pgref && pgref->pkpfx && (pgref->pkpfx->len + 32) < pmeth->key.ibuffer.len_alloc) {
+      /* v1.3.16 copy the pre-encoded global name and fixed subscripts */
+      memcpy((void *) pmeth->key.ibuffer.buf_addr, (void *) pgref->pkpfx->buffer, (size_t) pgref->pkpfx->len);
+      pmeth->key.ibuffer.len_used = pgref->pkpfx->len;
+      for (nx = 0; nx < pgref->pkpfx->argc; nx ++) {
+         pmeth->key.args[nx] = pgref->pkpfx->args[nx];
+         pmeth->key.args[nx].svalue.buf_addr = pmeth->key.ibuffer.buf_addr + pgref->pkpfx->args[nx].offs;
+      }
+      pmeth->key.argc = nx;
+   }
+   else if (pcon->key_type == DBX_KEYTYPE_M) {
       pmeth->key.args[nx].cvalue.pstr = 0;
       if (pgref) {
          pmeth->key.args[nx].type = DBX_DTYPE_STR;
@@ -1269,7 +1652,13 @@ int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>
 
       pmeth->key.args[nx].cvalue.pstr = 0;
 
-      if (args[n]->IsInt32()) {
+      if (pmeth->tvalue == DBX_TVALUE_IN && pcon->typed_values && n == (pmeth->jsargc - 1) && (len = dbx_tvalue_encode(isolate, icontext, args[n], buffer)) > 0) {
+         /* v1.3.24 store numbers and booleans in binary form */
+         pmeth->typed = 1; /* v1.3.27 */
+         pmeth->key.args[nx].type = DBX_DTYPE_STR;
+         dbx_ibuffer_add(pmeth, &(pmeth->key), isolate, nx, str, buffer, len, 0);
+      }
+      else if (args[n]->IsInt32()) {
          pmeth->key.args[nx].type = DBX_DTYPE_INT;
          pmeth->key.args[nx].num.int32 = (int) DBX_INT32_VALUE(args[n]);
 
@@ -1306,6 +1695,10 @@ int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>
 
    pmeth->key.argc = nx;
 
+   if (tmarshal) {
+      dbx_trace_span(pmeth, DBX_TRACE_MARSHAL, tmarshal, dbx_clock_ns());
+   }
+
    return rc;
 }
 
@@ -1328,7 +1721,6 @@ void DBX_DBNAME::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    int rc;
    DBXCON *pcon;
    DBXMETH *pmeth;
-   Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ISOLATE;
    c->dbx_count ++;
@@ -1356,6 +1748,7 @@ void DBX_DBNAME::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    
    DBX_DBFUN_START(c, pcon, pmeth);
 
+   pmeth->tvalue = DBX_TVALUE_OUT; /* v1.3.24 */
    rc = GlobalReference(c, args, pmeth, NULL, async);
 
    if (pcon->log_transmissions) {
@@ -1404,12 +1797,14 @@ void DBX_DBNAME::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    }
 
    if (binary) {
-      Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+      Local<Object> bx = node::Buffer::Copy(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
       args.GetReturnValue().Set(bx);
    }
+   else if (pmeth->tvalue == DBX_TVALUE_OUT) {
+      args.GetReturnValue().Set(dbx_new_value8n(isolate, pcon, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8)); /* v1.3.24 */
+   }
    else {
-      result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
-      args.GetReturnValue().Set(result);
+      args.GetReturnValue().Set(dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8)); /* v1.3.27 */
    }
 
    dbx_request_memory_free(pcon, pmeth, 0);
@@ -1417,70 +1812,69 @@ void DBX_DBNAME::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
 }
 
 
-void DBX_DBNAME::Set(const FunctionCallbackInfo<Value>& args)
+/* v1.3.20 */
+void DBX_DBNAME::Get_view(const FunctionCallbackInfo<Value>& args)
 {
-   short async;
    int rc;
    DBXCON *pcon;
    DBXMETH *pmeth;
-   Local<String> result;
+   DBXSNAP *psnap;
+   DBXVIEW *pview;
+   MDB_val data;
+   MaybeLocal<Object> bx;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ISOLATE;
    c->dbx_count ++;
 
    pcon = c->pcon;
    if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::set");
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::get_view");
    }
    pmeth = dbx_request_memory(pcon, 0);
 
-   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+   pmeth->binary = 1;
+   pmeth->jsargc = args.Length();
 
    if (pmeth->jsargc >= DBX_MAXARGS) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Set", 1)));
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Get_view", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
    if (pmeth->jsargc == 0) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Set", 1)));
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Get_view", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
 
    DBX_DBFUN_START(c, pcon, pmeth);
 
-   rc = GlobalReference(c, args, pmeth, NULL, async);
+   rc = GlobalReference(c, args, pmeth, NULL, 0);
 
    if (pcon->log_transmissions) {
-      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::set");
-   }
-
-   if (async) {
-      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
-      baton->isolate = isolate;
-      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_set;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->jsargc]);
-      baton->cb.Reset(isolate, cb);
-      c->Ref();
-      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
-         char error[DBX_ERROR_SIZE];
-         T_STRCPY(error, _dbxso(error), pcon->error);
-         dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
-         dbx_request_memory_free(pcon, pmeth, 0);
-         return;
-      }
-      return;
+      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::get_view");
    }
 
-   rc = dbx_set(pmeth);
+   psnap = NULL;
+   data.mv_data = NULL;
+   data.mv_size = 0;
 
-   if (rc == CACHE_SUCCESS) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
+   /* Only LMDB can expose its pages directly, and not while this connection has uncommitted writes */
+   if (pcon->dbtype == DBX_DBTYPE_LMDB && pcon->tlevel == 0) {
+      rc = dbx_get_view(pmeth, &data, &psnap);
    }
    else {
-      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Set");
-      if (pcon->error_mode == 1) { /* v1.3.10 */
+      rc = dbx_get(pmeth);
+      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.mv_size = (size_t) pmeth->output_val.svalue.len_used;
+   }
+
+   if (rc == CACHE_ERUNDEF) {
+      data.mv_size = 0;
+   }
+   else if (rc != CACHE_SUCCESS) {
+      data.mv_size = 0;
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Get_view");
+      if (pcon->error_mode == 1) {
          isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
       }
    }
@@ -1488,79 +1882,95 @@ void DBX_DBNAME::Set(const FunctionCallbackInfo<Value>& args)
    DBX_DBFUN_END(c);
    DBX_DB_UNLOCK();
 
-   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
-   args.GetReturnValue().Set(result);
-
-   if (pcon->log_transmissions == 2) {
-      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::set");
+   pview = NULL;
+   if (psnap) {
+      pview = (DBXVIEW *) dbx_malloc(sizeof(DBXVIEW), DBX_MEMID_ENGINE); /* v1.3.20 */
+   }
+   if (pview) {
+      memset((void *) pview, 0, sizeof(DBXVIEW));
+      pview->psnap = psnap;
+      bx = node::Buffer::New(isolate, (char *) data.mv_data, (size_t) data.mv_size, lmdb_view_free, (void *) pview); /* v1.3.20 */
+      if (bx.IsEmpty()) { /* external buffers not permitted: fall back to a copy */
+         bx = node::Buffer::Copy(isolate, (char *) data.mv_data, (size_t) data.mv_size);
+         lmdb_view_free((char *) data.mv_data, (void *) pview);
+      }
+      else { /* v1.3.20 remembered so that close() can detach it */
+         pview->pab = new Global<ArrayBuffer>(isolate, bx.ToLocalChecked().As<Uint8Array>()->Buffer());
+         pview->pab->SetWeak();
+         pview->pnext = psnap->pview;
+         psnap->pview = pview;
+      }
+   }
+   else if (psnap) {
+      bx = node::Buffer::Copy(isolate, (char *) data.mv_data, (size_t) data.mv_size);
+      lmdb_view_release((char *) data.mv_data, (void *) psnap);
+   }
+   else {
+      bx = node::Buffer::Copy(isolate, (char *) data.mv_data, (size_t) data.mv_size);
    }
+   args.GetReturnValue().Set(bx.ToLocalChecked());
 
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::Defined(const FunctionCallbackInfo<Value>& args)
+/* v1.3.21 */
+void DBX_DBNAME::Get_into(const FunctionCallbackInfo<Value>& args)
 {
-   short async;
    int rc;
+   size_t offset, size, len;
+   char *buffer;
    DBXCON *pcon;
    DBXMETH *pmeth;
-   Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
-   DBX_GET_ISOLATE;
+   DBX_GET_ICONTEXT;
    c->dbx_count ++;
 
    pcon = c->pcon;
    if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::defined");
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::get_into");
    }
    pmeth = dbx_request_memory(pcon, 0);
 
-   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+   pmeth->binary = 1;
+   pmeth->jsargc = args.Length();
+   pmeth->jsarg0 = 2;
 
-   if (pmeth->jsargc >= DBX_MAXARGS) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Defined", 1)));
+   if (pmeth->jsargc >= (DBX_MAXARGS + pmeth->jsarg0)) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Get_into", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
-   if (pmeth->jsargc == 0) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Defined", 1)));
+   if (pmeth->jsargc < 3 || !args[0]->IsArrayBufferView()) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid target Buffer on Get_into", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
-   
+   if (!args[1]->IsNumber() || DBX_NUMBER_VALUE(args[1]) < 0 || DBX_NUMBER_VALUE(args[1]) > (double) node::Buffer::Length(args[0])) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Invalid offset on Get_into", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+
+   offset = (size_t) DBX_NUMBER_VALUE(args[1]);
+   size = node::Buffer::Length(args[0]) - offset;
+   buffer = node::Buffer::Data(args[0]) + offset;
+
    DBX_DBFUN_START(c, pcon, pmeth);
 
-   rc = GlobalReference(c, args, pmeth, NULL, async);
+   rc = GlobalReference(c, args, pmeth, NULL, 0);
 
    if (pcon->log_transmissions) {
-      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::defined");
-   }
-
-   if (async) {
-      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
-      baton->isolate = isolate;
-      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_defined;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->jsargc]);
-      baton->cb.Reset(isolate, cb);
-      c->Ref();
-      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
-         char error[DBX_ERROR_SIZE];
-         T_STRCPY(error, _dbxso(error), pcon->error);
-         dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
-         dbx_request_memory_free(pcon, pmeth, 0);
-         return;
-      }
-      return;
+      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::get_into");
    }
 
-   rc = dbx_defined(pmeth);
+   len = 0;
+   rc = dbx_get_into(pmeth, buffer, size, &len);
 
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Defined");
-      if (pcon->error_mode == 1) { /* v1.3.10 */
+   if (rc != CACHE_SUCCESS && rc != CACHE_ERUNDEF) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Get_into");
+      if (pcon->error_mode == 1) {
          isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
       }
    }
@@ -1568,64 +1978,102 @@ void DBX_DBNAME::Defined(const FunctionCallbackInfo<Value>& args)
    DBX_DBFUN_END(c);
    DBX_DB_UNLOCK();
 
-   if (pcon->log_transmissions == 2) {
-      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::defined");
+   /* the length of the record or, if the space available is too small, minus the length required */
+   if (len > size) {
+      args.GetReturnValue().Set(DBX_NUMBER_NEW(-((double) len)));
+   }
+   else {
+      args.GetReturnValue().Set(DBX_NUMBER_NEW((double) len));
    }
 
-   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
-   args.GetReturnValue().Set(result);
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::Delete(const FunctionCallbackInfo<Value>& args)
+/* v1.3.22 */
+void DBX_DBNAME::Read_range(const FunctionCallbackInfo<Value>& args)
+{
+   return RangeEx(args, DBX_RANGE_READ);
+}
+
+
+void DBX_DBNAME::Write_range(const FunctionCallbackInfo<Value>& args)
+{
+   return RangeEx(args, DBX_RANGE_WRITE);
+}
+
+
+void DBX_DBNAME::Append(const FunctionCallbackInfo<Value>& args)
+{
+   return RangeEx(args, DBX_RANGE_APPEND);
+}
+
+
+void DBX_DBNAME::RangeEx(const FunctionCallbackInfo<Value>& args, int mode)
 {
    short async;
-   int rc, n;
+   int rc;
    DBXCON *pcon;
    DBXMETH *pmeth;
    Local<String> result;
+   int (* p_dbxfun) (struct tagDBXMETH * pmeth);
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ISOLATE;
    c->dbx_count ++;
 
    pcon = c->pcon;
    if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::delete");
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::range");
    }
    pmeth = dbx_request_memory(pcon, 0);
 
+   pmeth->binary = (mode == DBX_RANGE_READ);
+
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
    if (pmeth->jsargc >= DBX_MAXARGS) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Delete", 1)));
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on RangeEx", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
-   if (pmeth->jsargc == 0) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Delete", 1)));
+   if (pmeth->jsargc < (3 - (mode == DBX_RANGE_APPEND))) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) (mode == DBX_RANGE_READ ? "Missing key, offset or length on Read_range" : (mode == DBX_RANGE_WRITE ? "Missing key, offset or data on Write_range" : "Missing key or data on Append")), 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
-   
+
    DBX_DBFUN_START(c, pcon, pmeth);
 
    rc = GlobalReference(c, args, pmeth, NULL, async);
 
    if (pcon->log_transmissions) {
-      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::delete");
+      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::range");
+   }
+
+   if (mode == DBX_RANGE_READ) {
+      p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_read_range;
+   }
+   else if (mode == DBX_RANGE_WRITE) {
+      p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_write_range;
+   }
+   else {
+      p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_append;
    }
 
    if (async) {
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
-      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_delete;
+      baton->pmeth->p_dbxfun = p_dbxfun;
       Local<Function> cb = Local<Function>::Cast(args[pmeth->jsargc]);
+
       baton->cb.Reset(isolate, cb);
+
       c->Ref();
+
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
+
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
          isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
@@ -1635,15 +2083,14 @@ void DBX_DBNAME::Delete(const FunctionCallbackInfo<Value>& args)
       return;
    }
 
-   rc = dbx_delete(pmeth);
+   rc = p_dbxfun(pmeth);
 
-   if (rc == CACHE_SUCCESS) {
-      n = 0;
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &n, DBX_DTYPE_INT);
+   if (rc == CACHE_ERUNDEF) {
+      pmeth->output_val.svalue.len_used = 0;
    }
-   else {
-      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Delete");
-      if (pcon->error_mode == 1) { /* v1.3.10 */
+   else if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::RangeEx");
+      if (pcon->error_mode == 1) {
          isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
       }
    }
@@ -1652,17 +2099,24 @@ void DBX_DBNAME::Delete(const FunctionCallbackInfo<Value>& args)
    DBX_DB_UNLOCK();
 
    if (pcon->log_transmissions == 2) {
-      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::delete");
+      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::range");
+   }
+
+   if (pmeth->binary) {
+      Local<Object> bx = node::Buffer::Copy(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+      args.GetReturnValue().Set(bx);
+   }
+   else {
+      result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+      args.GetReturnValue().Set(result);
    }
 
-   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
-   args.GetReturnValue().Set(result);
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::Next(const FunctionCallbackInfo<Value>& args)
+void DBX_DBNAME::Set(const FunctionCallbackInfo<Value>& args)
 {
    short async;
    int rc;
@@ -1670,24 +2124,273 @@ void DBX_DBNAME::Next(const FunctionCallbackInfo<Value>& args)
    DBXMETH *pmeth;
    Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
-   DBX_GET_ISOLATE;
+   DBX_GET_ICONTEXT;
    c->dbx_count ++;
 
    pcon = c->pcon;
    if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::next");
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::set");
    }
    pmeth = dbx_request_memory(pcon, 0);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
    if (pmeth->jsargc >= DBX_MAXARGS) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Next", 1)));
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Set", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
    if (pmeth->jsargc == 0) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Next", 1)));
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Set", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (pmeth->jsargc > 2 && dbx_set_options(isolate, icontext, pmeth, args[pmeth->jsargc - 1])) { /* v1.3.27 */
+      pmeth->jsargc --;
+   }
+
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   pmeth->tvalue = DBX_TVALUE_IN; /* v1.3.24 */
+   rc = GlobalReference(c, args, pmeth, NULL, async);
+
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::set");
+   }
+
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_set;
+      Local<Function> cb = Local<Function>::Cast(args[args.Length() - 1]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
+      return;
+   }
+
+   rc = dbx_set(pmeth);
+
+   if (rc == CACHE_SUCCESS) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
+   }
+   else {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Set");
+      if (pcon->error_mode == 1) { /* v1.3.10 */
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+   }
+
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+   args.GetReturnValue().Set(result);
+
+   if (pcon->log_transmissions == 2) {
+      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::set");
+   }
+
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
+void DBX_DBNAME::Defined(const FunctionCallbackInfo<Value>& args)
+{
+   short async;
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<String> result;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::defined");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+
+   if (pmeth->jsargc >= DBX_MAXARGS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Defined", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (pmeth->jsargc == 0) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Defined", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   rc = GlobalReference(c, args, pmeth, NULL, async);
+
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::defined");
+   }
+
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_defined;
+      Local<Function> cb = Local<Function>::Cast(args[pmeth->jsargc]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
+      return;
+   }
+
+   rc = dbx_defined(pmeth);
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Defined");
+      if (pcon->error_mode == 1) { /* v1.3.10 */
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+   }
+
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   if (pcon->log_transmissions == 2) {
+      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::defined");
+   }
+
+   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+   args.GetReturnValue().Set(result);
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
+void DBX_DBNAME::Delete(const FunctionCallbackInfo<Value>& args)
+{
+   short async;
+   int rc, n;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<String> result;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::delete");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+
+   if (pmeth->jsargc >= DBX_MAXARGS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Delete", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (pmeth->jsargc == 0) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Delete", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   rc = GlobalReference(c, args, pmeth, NULL, async);
+
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::delete");
+   }
+
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_delete;
+      Local<Function> cb = Local<Function>::Cast(args[pmeth->jsargc]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
+      return;
+   }
+
+   rc = dbx_delete(pmeth);
+
+   if (rc == CACHE_SUCCESS) {
+      n = 0;
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &n, DBX_DTYPE_INT);
+   }
+   else {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Delete");
+      if (pcon->error_mode == 1) { /* v1.3.10 */
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+   }
+
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   if (pcon->log_transmissions == 2) {
+      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::delete");
+   }
+
+   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+   args.GetReturnValue().Set(result);
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
+void DBX_DBNAME::Next(const FunctionCallbackInfo<Value>& args)
+{
+   short async;
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<String> result;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::next");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+
+   if (pmeth->jsargc >= DBX_MAXARGS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Next", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (pmeth->jsargc == 0) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid global name on Next", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
@@ -1827,7 +2530,6 @@ void DBX_DBNAME::Increment(const FunctionCallbackInfo<Value>& args)
    int rc;
    DBXCON *pcon;
    DBXMETH *pmeth;
-   Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ISOLATE;
    c->dbx_count ++;
@@ -1854,6 +2556,7 @@ void DBX_DBNAME::Increment(const FunctionCallbackInfo<Value>& args)
    DBX_DBFUN_START(c, pcon, pmeth);
 
    pmeth->increment = 1;
+   pmeth->tvalue = DBX_TVALUE_OUT; /* v1.3.24 */
    rc = GlobalReference(c, args, pmeth, NULL, async);
 
    if (pcon->log_transmissions) {
@@ -1894,8 +2597,7 @@ void DBX_DBNAME::Increment(const FunctionCallbackInfo<Value>& args)
       dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) DBX_DBNAME_STR "::increment");
    }
 
-   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
-   args.GetReturnValue().Set(result);
+   args.GetReturnValue().Set(dbx_new_value8n(isolate, pcon, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8)); /* v1.3.24 */
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
@@ -2061,2486 +2763,3965 @@ void DBX_DBNAME::Unlock(const FunctionCallbackInfo<Value>& args)
 }
 
 
-void DBX_DBNAME::MGlobal(const FunctionCallbackInfo<Value>& args)
+/* v1.3.26 Define a secondary index for a global and create the entries for the global's existing records */
+void DBX_DBNAME::Define_index(const FunctionCallbackInfo<Value>& args)
 {
+   short async;
    int rc;
    DBXCON *pcon;
    DBXMETH *pmeth;
+   DBXINDEX *pidx, *pidx_prev, *pidx_old;
+   Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
-   DBX_GET_ISOLATE;
+   DBX_GET_ICONTEXT;
    c->dbx_count ++;
 
    pcon = c->pcon;
    if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::mglobal");
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::define_index");
    }
-   pmeth = dbx_request_memory(pcon, 1);
+   pmeth = dbx_request_memory(pcon, 0);
 
-   pmeth->jsargc = args.Length();
-
-   /* 1.4.10 */
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
-   if (pmeth->jsargc < 1) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobal method takes at least one argument (the global name)", 1)));
+   if (pcon->key_type != DBX_KEYTYPE_M) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Secondary indexes are only available for databases with M-style keys", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (pmeth->jsargc < 2 || dbx_index_options(isolate, icontext, args[0], args[1], &pidx) < 0) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid index definition on Define_index", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
 
-   mglobal *gx = mglobal::NewInstance(args);
+   /* a new definition replaces any earlier one for the same global and index */
+   DBX_DB_LOCK(0);
+   pidx_prev = NULL;
+   for (pidx_old = pcon->pindex; pidx_old; pidx_prev = pidx_old, pidx_old = pidx_old->pnext) {
+      if (!strcmp(pidx_old->global, pidx->global) && !strcmp(pidx_old->index, pidx->index)) {
+         break;
+      }
+   }
+   if (pidx_old) {
+      pidx->pnext = pidx_old->pnext;
+      if (pidx_prev) {
+         pidx_prev->pnext = pidx;
+      }
+      else {
+         pcon->pindex = pidx;
+      }
+      pidx_old->pnext = NULL;
+      dbx_index_free(pidx_old);
+   }
+   else {
+      pidx->pnext = pcon->pindex;
+      pcon->pindex = pidx;
+   }
+   DBX_DB_UNLOCK();
 
-   gx->c = c;
-   gx->pkey = NULL;
+   DBX_DBFUN_START(c, pcon, pmeth);
 
-   /* 1.4.10 */
+   pmeth->jsargc = 1; /* the global name */
+   rc = GlobalReference(c, args, pmeth, NULL, async);
 
-   rc = dbx_global_reset(args, isolate, pcon, pmeth, (void *) gx, 0, 0);
-   if (rc < 0) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobal method takes at least one argument (the global name)", 1)));
-      dbx_request_memory_free(pcon, pmeth, 0);
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) DBX_DBNAME_STR "::define_index");
+   }
+
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_index_build;
+      Local<Function> cb = Local<Function>::Cast(args[args.Length() - 1]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
       return;
    }
 
-/*
-{
-   int n;
-   char buffer[256];
+   rc = dbx_index_build(pmeth);
 
-   printf("\r\n mglobal START");
-   n = 0;
-   pval = gx->pkey;
-   while (pval) {
-      strcpy(buffer, "");
-      if (pmeth->key.args[n].svalue.len_used > 0) {
-         strncpy(buffer,   pval->svalue.buf_addr,   pval->svalue.len_used);
-         buffer[ pval->svalue.len_used] = '\0';
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Define_index");
+      if (pcon->error_mode == 1) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
       }
-      printf("\r\n >>>>>>> n=%d; type=%d; int32=%d; str=%s", ++ n, pval->type, pval->num.int32, buffer);
-      pval = pval->pnext;
    }
-    printf("\r\n mglobal END");
-}
-*/
+
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+   args.GetReturnValue().Set(result);
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::MGlobal_Close(const FunctionCallbackInfo<Value>& args)
+/* v1.3.27 Remove the nodes whose time to live has passed now rather than waiting for the background sweeper */
+void DBX_DBNAME::Sweep(const FunctionCallbackInfo<Value>& args)
 {
-   int js_narg;
+   short async;
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ISOLATE;
    c->dbx_count ++;
 
-   js_narg = args.Length();
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::sweep");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
+   DBX_DBFUN_START(c, pcon, pmeth);
 
-   if (js_narg != 1) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The MGlobal_Close method takes one argument (the MGlobal reference)", 1)));
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_ttl_sweep;
+      Local<Function> cb = Local<Function>::Cast(args[args.Length() - 1]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
       return;
    }
 
-#if DBX_NODE_VERSION >= 100000
-   mglobal * cx = node::ObjectWrap::Unwrap<mglobal>(args[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked());
-#else
-   mglobal * cx = node::ObjectWrap::Unwrap<mglobal>(args[0]->ToObject());
-#endif
+   rc = dbx_ttl_sweep(pmeth);
 
-   cx->delete_mglobal_template(cx);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Sweep");
+      if (pcon->error_mode == 1) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+   }
+
+   DBX_DBFUN_END(c);
 
+   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+   args.GetReturnValue().Set(result);
+   dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::MGlobalQuery(const FunctionCallbackInfo<Value>& args)
+/* v1.3.28 Report the LMDB map size, optionally growing it first to hold an anticipated load */
+void DBX_DBNAME::Map_size(const FunctionCallbackInfo<Value>& args)
 {
    int rc;
+   size_t size;
+   char buffer[64];
    DBXCON *pcon;
    DBXMETH *pmeth;
+   MDB_envinfo info;
+   MDB_stat stat;
+   Local<Object> obj;
+   Local<String> key;
+   Local<String> value;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
-   DBX_GET_ISOLATE;
+   DBX_GET_ICONTEXT;
    c->dbx_count ++;
 
    pcon = c->pcon;
    if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::mglobalquery");
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::map_size");
    }
-   pmeth = dbx_request_memory(pcon, 1);
+   pmeth = dbx_request_memory(pcon, 0);
 
    pmeth->jsargc = args.Length();
 
-   if (pmeth->jsargc < 1) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobalquery method takes at least one argument (the global reference to start with)", 1)));
+   if (pcon->dbtype != DBX_DBTYPE_LMDB || !pcon->p_lmdb_so || !pcon->p_lmdb_so->penv) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The map size is only available for open LMDB databases", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
 
-   mcursor *cx = mcursor::NewInstance(args);
+   size = 0;
+   if (pmeth->jsargc > 0) {
+      if (args[0]->IsNumber()) {
+         size = (size_t) DBX_NUMBER_VALUE(args[0]);
+      }
+      else {
+         value = DBX_TO_STRING(args[0]);
+         DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+         size = dbx_parse_size(buffer);
+      }
+      if (!size) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Invalid size on Map_size", 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
+   }
 
-   dbx_cursor_init((void *) cx);
+   DBX_DBFUN_START(c, pcon, pmeth);
 
-   cx->c = c;
+   DBX_DB_LOCK(0);
+   pcon->error[0] = '\0';
+   rc = CACHE_SUCCESS;
+   if (size) {
+      rc = lmdb_map_grow(pmeth, 0, size);
+   }
+   if (rc == CACHE_SUCCESS) {
+      rc = pcon->p_lmdb_so->p_mdb_env_info(pcon->p_lmdb_so->penv, &info);
+   }
+   if (rc == CACHE_SUCCESS) {
+      rc = pcon->p_lmdb_so->p_mdb_env_stat(pcon->p_lmdb_so->penv, &stat);
+   }
+   if (rc != CACHE_SUCCESS && !pcon->error[0]) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Map_size");
+   }
+   DBX_DB_UNLOCK();
 
-   /* 1.4.10 */
-   rc = dbx_cursor_reset(args, isolate, pcon, pmeth, (void *) cx, 0, 0);
-   if (rc < 0) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobalquery method takes at least one argument (the global reference to start with)", 1)));
+   DBX_DBFUN_END(c);
+
+   if (rc != CACHE_SUCCESS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
 
+   obj = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "map_size", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) info.me_mapsize));
+   key = dbx_new_string8(isolate, (char *) "used", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) (info.me_last_pgno + 1) * (double) stat.ms_psize));
+   key = dbx_new_string8(isolate, (char *) "resizes", 0);
+   DBX_SET(obj, key, DBX_INTEGER_NEW(pcon->db_resizes));
+   args.GetReturnValue().Set(obj);
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::MGlobalQuery_Close(const FunctionCallbackInfo<Value>& args)
+/* v1.3.29 Flush committed updates to disk */
+void DBX_DBNAME::Sync(const FunctionCallbackInfo<Value>& args)
 {
-   int js_narg;
+   short async;
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<String> result;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ISOLATE;
    c->dbx_count ++;
 
-   js_narg = args.Length();
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::sync");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
 
-   if (js_narg != 1) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The MGlobalQuery_Close method takes one argument (the MGlobalQuery reference)", 1)));
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_sync;
+      Local<Function> cb = Local<Function>::Cast(args[args.Length() - 1]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
       return;
    }
 
-#if DBX_NODE_VERSION >= 100000
-   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked());
-#else
-   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject());
-#endif
+   rc = dbx_sync(pmeth);
 
-   cx->delete_mcursor_template(cx);
+   if (rc != CACHE_SUCCESS && pcon->error_mode == 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+   }
+
+   DBX_DBFUN_END(c);
 
+   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+   args.GetReturnValue().Set(result);
+   dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::SQL(const FunctionCallbackInfo<Value>& args)
+/* v1.3.30 Report the size and effectiveness of the BDB cache (memory pool) */
+void DBX_DBNAME::Cache_stats(const FunctionCallbackInfo<Value>& args)
 {
    int rc;
+   double hits, misses;
    DBXCON *pcon;
    DBXMETH *pmeth;
+   DB_ENV *penv;
+   DB_MPOOL_STAT *pstat;
+   Local<Object> obj;
+   Local<String> key;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
-   DBX_GET_ISOLATE;
+   DBX_GET_ICONTEXT;
    c->dbx_count ++;
 
    pcon = c->pcon;
    if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::sql");
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::cache_stats");
    }
-   pmeth = dbx_request_memory(pcon, 1);
+   pmeth = dbx_request_memory(pcon, 0);
 
    pmeth->jsargc = args.Length();
 
-   if (pmeth->jsargc < 1) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The sql method takes at least one argument (the sql script)", 1)));
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   if (pcon->dbtype != DBX_DBTYPE_BDB || !pcon->p_bdb_so) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The cache statistics are only available for BDB databases", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
 
-   mcursor *cx = mcursor::NewInstance(args);
-
-   dbx_cursor_init((void *) cx);
+   DBX_DB_LOCK(0);
+   pstat = NULL;
+   penv = pcon->p_bdb_so->penv;
+   if (!penv && pcon->p_bdb_so->pdb) { /* a database opened without an environment has a private cache */
+      penv = pcon->p_bdb_so->pdb->get_env(pcon->p_bdb_so->pdb);
+   }
+   else if (!penv && pcon->p_bdb_so->p_gdb && pcon->p_bdb_so->gdb_count > 0 && pcon->p_bdb_so->p_gdb[0].pdb) {
+      penv = pcon->p_bdb_so->p_gdb[0].pdb->get_env(pcon->p_bdb_so->p_gdb[0].pdb);
+   }
+   if (penv) {
+      rc = penv->memp_stat(penv, &pstat, NULL, 0);
+   }
+   else {
+      strcpy(pcon->error, "The cache statistics are not available until a database has been opened");
+      rc = CACHE_FAILURE;
+   }
+   if (rc != CACHE_SUCCESS && penv) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Cache_stats");
+   }
+   DBX_DB_UNLOCK();
 
-   cx->c = c;
+   DBX_DBFUN_END(c);
 
-   /* 1.4.10 */
-   rc = dbx_cursor_reset(args, isolate, pcon, pmeth, (void *) cx, 0, 0);
-   if (rc < 0) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The sql method takes at least one argument (the sql script)", 1)));
+   if (rc != CACHE_SUCCESS || !pstat) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
 
+   hits = (double) pstat->st_cache_hit;
+   misses = (double) pstat->st_cache_miss;
+
+   obj = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "cache_size", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW(((double) pstat->st_gbytes * 1073741824.0) + (double) pstat->st_bytes));
+   key = dbx_new_string8(isolate, (char *) "cache_regions", 0);
+   DBX_SET(obj, key, DBX_INTEGER_NEW((int) pstat->st_ncache));
+   key = dbx_new_string8(isolate, (char *) "page_size", 0);
+   DBX_SET(obj, key, DBX_INTEGER_NEW((int) pstat->st_pagesize));
+   key = dbx_new_string8(isolate, (char *) "hits", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW(hits));
+   key = dbx_new_string8(isolate, (char *) "misses", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW(misses));
+   key = dbx_new_string8(isolate, (char *) "hit_ratio", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((hits + misses) > 0 ? (hits / (hits + misses)) : 0));
+   key = dbx_new_string8(isolate, (char *) "pages_in", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) pstat->st_page_in));
+   key = dbx_new_string8(isolate, (char *) "pages_out", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) pstat->st_page_out));
+   key = dbx_new_string8(isolate, (char *) "evictions", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) pstat->st_ro_evict + (double) pstat->st_rw_evict));
+   key = dbx_new_string8(isolate, (char *) "dirty_pages", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) pstat->st_page_dirty));
+   free((void *) pstat); /* allocated by the BDB library */
+
+   args.GetReturnValue().Set(obj);
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
-
-void DBX_DBNAME::SQL_Close(const FunctionCallbackInfo<Value>& args)
+/* v1.3.33 Report (and optionally reset) the operation counters and latency histograms */
+void DBX_DBNAME::Stats(const FunctionCallbackInfo<Value>& args)
 {
-   int js_narg;
+   int cmnd, path, n, reset;
+   double seconds;
+   unsigned long long count, errors;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   DBXHIST hist;
+   Local<Object> obj, objc, objx, objp, objl;
+   Local<String> key;
+   static const char *paths[DBX_STATS_PATHS] = {"sync", "async", "queue"};
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
-   DBX_GET_ISOLATE;
+   DBX_GET_ICONTEXT;
    c->dbx_count ++;
 
-   js_narg = args.Length();
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::stats");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
 
-   if (js_narg != 1) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The SQL_Close method takes one argument (the SQL reference)", 1)));
+   pmeth->jsargc = args.Length();
+
+   reset = 0;
+   if (pmeth->jsargc > 0 && args[0]->IsObject()) {
+      obj = DBX_TO_OBJECT(args[0]);
+      key = dbx_new_string8(isolate, (char *) "reset", 1);
+      if (DBX_GET(obj, key)->IsBoolean()) {
+         reset = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+      }
+   }
+
+   obj = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "enabled", 0);
+   DBX_SET(obj, key, DBX_BOOLEAN_NEW(pcon->pstats ? true : false));
+
+   objl = DBX_OBJECT_NEW(); /* v1.3.35 event log writer (shared by all connections) */
+   key = dbx_new_string8(isolate, (char *) "buffered", 0);
+   DBX_SET(objl, key, DBX_BOOLEAN_NEW((dbx_log.state == DBX_LOG_RUNNING && !dbx_log.sync) ? true : false));
+   key = dbx_new_string8(isolate, (char *) "queued", 0);
+   DBX_SET(objl, key, DBX_NUMBER_NEW((double) dbx_log.queued));
+   key = dbx_new_string8(isolate, (char *) "written", 0);
+   DBX_SET(objl, key, DBX_NUMBER_NEW((double) dbx_log.written));
+   key = dbx_new_string8(isolate, (char *) "dropped", 0);
+   DBX_SET(objl, key, DBX_NUMBER_NEW((double) dbx_log.dropped));
+   key = dbx_new_string8(isolate, (char *) "rotations", 0);
+   DBX_SET(objl, key, DBX_NUMBER_NEW((double) dbx_log.rotations));
+   key = dbx_new_string8(isolate, (char *) "log", 0);
+   DBX_SET(obj, key, objl);
+
+   if (!pcon->pstats) {
+      args.GetReturnValue().Set(obj);
+      dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
 
-#if DBX_NODE_VERSION >= 100000
-   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked());
-#else
-   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject());
-#endif
+   seconds = (double) (dbx_clock_ms() - pcon->pstats->reset) / 1000.0;
+   key = dbx_new_string8(isolate, (char *) "since", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) pcon->pstats->reset));
+   key = dbx_new_string8(isolate, (char *) "seconds", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW(seconds));
 
-   cx->delete_mcursor_template(cx);
+   objc = DBX_OBJECT_NEW();
+   for (cmnd = 0; cmnd < DBX_STATS_CMNDS; cmnd ++) {
+      count = 0;
+      errors = 0;
+      for (n = 0; n < DBX_STATS_SHARDS; n ++) {
+         errors += pcon->pstats->shard[n].errors[cmnd];
+      }
+      objx = DBX_OBJECT_NEW();
+      for (path = 0; path < DBX_STATS_PATHS; path ++) {
+         if (!dbx_stats_merge(pcon->pstats, cmnd, path, &hist)) {
+            continue;
+         }
+         if (path != DBX_STATS_QUEUE) {
+            count += hist.count;
+         }
+         objp = DBX_OBJECT_NEW();
+         key = dbx_new_string8(isolate, (char *) "count", 0);
+         DBX_SET(objp, key, DBX_NUMBER_NEW((double) hist.count));
+         key = dbx_new_string8(isolate, (char *) "mean_us", 0);
+         DBX_SET(objp, key, DBX_NUMBER_NEW(((double) hist.total / (double) hist.count) / 1000.0));
+         key = dbx_new_string8(isolate, (char *) "p50_us", 0);
+         DBX_SET(objp, key, DBX_NUMBER_NEW((double) dbx_stats_percentile(&hist, 0.5) / 1000.0));
+         key = dbx_new_string8(isolate, (char *) "p90_us", 0);
+         DBX_SET(objp, key, DBX_NUMBER_NEW((double) dbx_stats_percentile(&hist, 0.9) / 1000.0));
+         key = dbx_new_string8(isolate, (char *) "p99_us", 0);
+         DBX_SET(objp, key, DBX_NUMBER_NEW((double) dbx_stats_percentile(&hist, 0.99) / 1000.0));
+         key = dbx_new_string8(isolate, (char *) "p999_us", 0);
+         DBX_SET(objp, key, DBX_NUMBER_NEW((double) dbx_stats_percentile(&hist, 0.999) / 1000.0));
+         key = dbx_new_string8(isolate, (char *) "max_us", 0);
+         DBX_SET(objp, key, DBX_NUMBER_NEW((double) hist.max / 1000.0));
+         key = dbx_new_string8(isolate, (char *) paths[path], 0);
+         DBX_SET(objx, key, objp);
+      }
+      if (!count) {
+         continue;
+      }
+      key = dbx_new_string8(isolate, (char *) "count", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) count));
+      key = dbx_new_string8(isolate, (char *) "errors", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) errors));
+      key = dbx_new_string8(isolate, (char *) "ops_per_sec", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW(seconds > 0 ? ((double) count / seconds) : 0));
+      key = dbx_new_string8(isolate, (char *) dbx_stats_cmnds[cmnd], 0);
+      DBX_SET(objc, key, objx);
+   }
+   key = dbx_new_string8(isolate, (char *) "commands", 0);
+   DBX_SET(obj, key, objc);
+
+   if (reset) { /* counts recorded while the statistics are cleared may be lost */
+      for (n = 0; n < DBX_STATS_SHARDS; n ++) {
+         memset((void *) &(pcon->pstats->shard[n]), 0, sizeof(DBXSTATSHARD));
+      }
+      pcon->pstats->reset = dbx_clock_ms();
+   }
 
+   args.GetReturnValue().Set(obj);
+   dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
 
 
-void DBX_DBNAME::Sleep(const FunctionCallbackInfo<Value>& args)
+/* v1.3.34 Report the storage engine's own statistics: B-tree shape, map usage, readers and cache effectiveness */
+void DBX_DBNAME::Engine_stats(const FunctionCallbackInfo<Value>& args)
 {
-   int timeout;
-   Local<Integer> result;
+   short async;
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<Object> obj;
+   Local<String> key, value;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ICONTEXT;
    c->dbx_count ++;
 
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::engine_stats");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
 
-   timeout = 0;
-   if (args[0]->IsInt32()) {
-      timeout = (int) DBX_INT32_VALUE(args[0]);
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+
+   if (pmeth->jsargc > 0 && args[0]->IsObject()) {
+      obj = DBX_TO_OBJECT(args[0]);
+      key = dbx_new_string8(isolate, (char *) "fast", 1);
+      if (DBX_GET(obj, key)->IsBoolean()) {
+         pmeth->fast = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+      }
    }
 
-   dbx_sleep((unsigned long) timeout);
- 
-   result = DBX_INTEGER_NEW(0);
-   args.GetReturnValue().Set(result);
-}
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_engine_stats;
+      Local<Function> cb = Local<Function>::Cast(args[args.Length() - 1]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
+      return;
+   }
 
+   rc = dbx_engine_stats(pmeth);
 
-void DBX_DBNAME::Dump(const FunctionCallbackInfo<Value>& args)
+   DBX_DBFUN_END(c);
+
+   if (rc != CACHE_SUCCESS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+
+   value = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, 0);
+#if DBX_NODE_VERSION >= 80000
+   args.GetReturnValue().Set(v8::JSON::Parse(icontext, value).ToLocalChecked());
+#else
+   args.GetReturnValue().Set(value);
+#endif
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+/* v1.3.36 Start (or stop) sampled tracing of requests: the phases of each sampled request are written as Chrome trace events */
+void DBX_DBNAME::Trace(const FunctionCallbackInfo<Value>& args)
 {
-   int rc, n, n1, num, rkey_size, rdata_size, js_narg, option;
-   unsigned char chr, chrp;
-   char *rkey, *rdata;
+   int start, stop;
+   double sample_rate;
+   char file[256];
    DBXCON *pcon;
-   DBXMETH *pmeth;
-   Local<String> result;
+   Local<Object> obj;
+   Local<String> key, str;
    DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
    DBX_GET_ICONTEXT;
    c->dbx_count ++;
-   DBT bdb_key, bdb_data;
-   DBC *bdb_pcursor;
-   MDB_val lmdb_key, lmdb_data;
-   MDB_cursor *lmdb_pcursor;
-   char val[256], hex[16];
-   DBXSTR buffer;
 
-   option = 0;
-   rkey_size = 0;
-   rdata_size = 0;
-   rkey = NULL;
-   rdata = NULL;
-   buffer.buf_addr = NULL;
-   buffer.len_alloc = 0;
-   buffer.len_used = 0;
-   bdb_pcursor = NULL;
-   lmdb_pcursor = NULL;
    pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::trace");
+   }
 
-   js_narg = args.Length();
-
-   if (js_narg > 0) {
-      result = DBX_TO_STRING(args[0]);
-      DBX_WRITE_UTF8(result, val, sizeof(val));
-      if (val[0]) {
-         option = (int) strtol(val, NULL, 10);
+   start = 0;
+   stop = 0;
+   sample_rate = 1.0;
+   strcpy(file, pcon->trace.file[0] ? pcon->trace.file : DBX_TRACE_FILE);
+   if (args.Length() > 0) {
+      if (args[0]->IsBoolean()) {
+         if (DBX_TO_BOOLEAN(args[0])->IsTrue())
+            start = 1;
+         else
+            stop = 1;
+      }
+      else if (args[0]->IsObject()) {
+         start = 1;
+         obj = DBX_TO_OBJECT(args[0]);
+         key = dbx_new_string8(isolate, (char *) "stop", 1);
+         if (DBX_GET(obj, key)->IsBoolean() && DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
+            start = 0;
+            stop = 1;
+         }
+         key = dbx_new_string8(isolate, (char *) "sample_rate", 1);
+         if (DBX_GET(obj, key)->IsNumber()) {
+            sample_rate = DBX_NUMBER_VALUE(DBX_GET(obj, key));
+         }
+         key = dbx_new_string8(isolate, (char *) "file", 1);
+         if (DBX_GET(obj, key)->IsString()) {
+            str = DBX_TO_STRING(DBX_GET(obj, key));
+            DBX_WRITE_UTF8(str, file, sizeof(file));
+         }
       }
    }
-
-   if (pcon->log_functions) {
-      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::dump");
+   if (start && (sample_rate <= 0 || sample_rate > 1 || !file[0])) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) (file[0] ? "Invalid sample_rate on Trace (greater than 0 and no more than 1)" : "Invalid file on Trace"), 1)));
+      return;
    }
-   pmeth = dbx_request_memory(pcon, 0);
-
-   DBX_CALLBACK_FUN(pmeth->jsargc, cb, rc);
 
-   if (pmeth->jsargc >= DBX_MAXARGS) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Dump", 1)));
-      dbx_request_memory_free(pcon, pmeth, 0);
-      return;
+   if (stop) {
+      dbx_trace_stop(pcon);
    }
-   
-   buffer.buf_addr = (char *) dbx_malloc(32000, 0);
-   if (!buffer.buf_addr) {
-      return;
+   else if (start) {
+      dbx_trace_start(pcon, file, sample_rate);
    }
-   buffer.len_alloc = 32000;
 
-   DBX_DBFUN_START(c, pcon, pmeth);
+   obj = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "active", 0);
+   DBX_SET(obj, key, DBX_BOOLEAN_NEW(pcon->trace.active ? true : false));
+   key = dbx_new_string8(isolate, (char *) "file", 0);
+   DBX_SET(obj, key, dbx_new_string8(isolate, (char *) (pcon->trace.file[0] ? pcon->trace.file : file), 1));
+   key = dbx_new_string8(isolate, (char *) "sample_rate", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW(pcon->trace.file[0] ? pcon->trace.sample_rate : sample_rate));
+   key = dbx_new_string8(isolate, (char *) "requests", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) pcon->trace.counter));
+   key = dbx_new_string8(isolate, (char *) "events", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) pcon->trace.events));
+   args.GetReturnValue().Set(obj);
+   return;
+}
 
-   pcon = pmeth->pcon;
+/* v1.3.37 Enable, disable, reset and report the contention statistics for the connection mutex and the thread pool's mutexes */
+void DBX_DBNAME::Lock_stats(const FunctionCallbackInfo<Value>& args)
+{
+   int n, enable, reset;
+   double seconds, elapsed;
+   DBXCON *pcon;
+   DBXLOCKSTATS *plstats;
+   Local<Object> obj, objk, objx;
+   Local<String> key;
+   static const char *locks[4] = {"connection", "task_queue", "pool", "result"};
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
 
-   DBX_DB_LOCK(0);
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::lock_stats");
+   }
 
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Dump");
-      DBX_DB_UNLOCK();
+   enable = -1;
+   reset = 0;
+   if (args.Length() > 0) {
+      if (args[0]->IsBoolean()) {
+         enable = DBX_TO_BOOLEAN(args[0])->IsTrue() ? 1 : 0;
+      }
+      else if (args[0]->IsObject()) {
+         obj = DBX_TO_OBJECT(args[0]);
+         key = dbx_new_string8(isolate, (char *) "enable", 1);
+         if (DBX_GET(obj, key)->IsBoolean()) {
+            enable = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+         key = dbx_new_string8(isolate, (char *) "reset", 1);
+         if (DBX_GET(obj, key)->IsBoolean()) {
+            reset = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+      }
+   }
+
+   if (enable == 1 && !dbx_lock_stats_enabled) {
+      reset = 1;
+   }
+   if (reset) { /* counts recorded while the statistics are cleared may be lost */
+      dbx_lock_stats_reset(&(mutex_global.stats));
+      dbx_lock_stats_reset(&dbx_task_queue_lstats);
+      dbx_lock_stats_reset(&dbx_pool_lstats);
+      dbx_lock_stats_reset(&dbx_result_lstats);
+      dbx_lock_stats_since = dbx_clock_ms();
+   }
+   if (enable != -1) {
+      dbx_lock_stats_enabled = enable;
+   }
+
+   obj = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "enabled", 0);
+   DBX_SET(obj, key, DBX_BOOLEAN_NEW(dbx_lock_stats_enabled ? true : false));
+   if (!dbx_lock_stats_since) {
+      args.GetReturnValue().Set(obj);
       return;
    }
 
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      memset(&bdb_key, 0, sizeof(DBT));
-      memset(&bdb_data, 0, sizeof(DBT));
-      bdb_key.flags = DB_DBT_USERMEM;
-      bdb_data.flags = DB_DBT_USERMEM;
+   seconds = (double) (dbx_clock_ms() - dbx_lock_stats_since) / 1000.0;
+   elapsed = seconds * 1000000.0;
+   key = dbx_new_string8(isolate, (char *) "since", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) dbx_lock_stats_since));
+   key = dbx_new_string8(isolate, (char *) "seconds", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW(seconds));
+
+   objk = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "locks", 0);
+   DBX_SET(obj, key, objk);
+
+   for (n = 0; n < 4; n ++) {
+      plstats = (n == 0) ? &(mutex_global.stats) : (n == 1) ? &dbx_task_queue_lstats : (n == 2) ? &dbx_pool_lstats : &dbx_result_lstats;
+
+      objx = DBX_OBJECT_NEW();
+      key = dbx_new_string8(isolate, (char *) "acquisitions", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) plstats->acquisitions));
+      key = dbx_new_string8(isolate, (char *) "contended", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) plstats->contended));
+      key = dbx_new_string8(isolate, (char *) "contended_ratio", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW(plstats->acquisitions ? ((double) plstats->contended / (double) plstats->acquisitions) : 0));
+      key = dbx_new_string8(isolate, (char *) "wait_us", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) plstats->wait / 1000.0));
+      key = dbx_new_string8(isolate, (char *) "wait_mean_us", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW(plstats->contended ? ((double) plstats->wait / (double) plstats->contended / 1000.0) : 0));
+      key = dbx_new_string8(isolate, (char *) "wait_max_us", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) plstats->wait_max / 1000.0));
+      key = dbx_new_string8(isolate, (char *) "hold_us", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) plstats->hold / 1000.0));
+      key = dbx_new_string8(isolate, (char *) "hold_mean_us", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW(plstats->acquisitions ? ((double) plstats->hold / (double) plstats->acquisitions / 1000.0) : 0));
+      key = dbx_new_string8(isolate, (char *) "hold_max_us", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) plstats->hold_max / 1000.0));
+      key = dbx_new_string8(isolate, (char *) "busy_ratio", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW(elapsed > 0 ? ((double) plstats->hold / 1000.0 / elapsed) : 0));
+      key = dbx_new_string8(isolate, (char *) locks[n], 0);
+      DBX_SET(objk, key, objx);
+   }
+
+   args.GetReturnValue().Set(obj);
+   return;
+}
 
-      rc = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &bdb_pcursor, 0);
+/* v1.3.38 Enable, disable, reset and report the accounting of memory allocated by dbx_malloc() for each call site */
+void DBX_DBNAME::Memory_stats(const FunctionCallbackInfo<Value>& args)
+{
+   int n, enable, reset;
+   DBXCON *pcon;
+   DBXMEMSTATS *pmstats;
+   Local<Object> obj, objs, objx;
+   Local<String> key;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
 
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         pmeth->output_val.num.int32 = pmeth->key.args[0].num.int32;
-         bdb_key.data = &(pmeth->output_val.num.int32);
-         bdb_key.size = sizeof(pmeth->output_val.num.int32);
-         bdb_key.ulen = sizeof(pmeth->output_val.num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         dbx_memcpy_exx(&(pmeth->output_val.svalue), (void *) pmeth->key.args[0].svalue.buf_addr, (size_t) pmeth->key.args[0].svalue.len_used);
-         pmeth->output_val.svalue.len_used = pmeth->key.args[0].svalue.len_used;
-         bdb_key.data = (void *) pmeth->output_val.svalue.buf_addr;
-         bdb_key.size = (u_int32_t) pmeth->output_val.svalue.len_used;
-         bdb_key.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::memory_stats");
+   }
+
+   enable = -1;
+   reset = 0;
+   if (args.Length() > 0) {
+      if (args[0]->IsBoolean()) {
+         enable = DBX_TO_BOOLEAN(args[0])->IsTrue() ? 1 : 0;
       }
-      else {
-         bdb_key.data = (void *) pmeth->output_val.svalue.buf_addr;
-         bdb_key.size = (u_int32_t) pmeth->output_val.svalue.len_used;
-         bdb_key.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+      else if (args[0]->IsObject()) {
+         obj = DBX_TO_OBJECT(args[0]);
+         key = dbx_new_string8(isolate, (char *) "enable", 1);
+         if (DBX_GET(obj, key)->IsBoolean()) {
+            enable = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+         key = dbx_new_string8(isolate, (char *) "reset", 1);
+         if (DBX_GET(obj, key)->IsBoolean()) {
+            reset = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
       }
+   }
 
-      bdb_data.data = (void *) pmeth->output_key.svalue.buf_addr;
-      bdb_data.ulen = (u_int32_t)  pmeth->output_key.svalue.len_alloc;
-      rc = bdb_cursor_get(bdb_pcursor, &bdb_key, &(pmeth->output_val.svalue), &bdb_data, &(pmeth->output_key.svalue), DB_FIRST); /* v1.3.9 */
-      if (rc != CACHE_SUCCESS) {
-         goto Dump_Exit;
+   if (enable == 1 && !dbx_mem_enabled) {
+      reset = 1;
+   }
+   if (reset) { /* blocks counted before the reset are no longer deducted when they are freed: counts made while the statistics are cleared may be lost */
+      dbx_mem_epoch ++;
+      if (dbx_mem_epoch == 0) {
+         dbx_mem_epoch = 1;
       }
+      DBX_MEMORY_BARRIER();
+      memset((void *) dbx_mem_stats, 0, sizeof(dbx_mem_stats));
+      dbx_mem_since = dbx_clock_ms();
+   }
+   if (enable != -1) {
+      dbx_mem_enabled = enable;
+   }
 
-      rkey = (char *) bdb_key.data;
-      rkey_size = (int) bdb_key.size;
-      rdata = (char *) bdb_data.data;
-      rdata_size = (int) bdb_data.size;
+   obj = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "enabled", 0);
+   DBX_SET(obj, key, DBX_BOOLEAN_NEW(dbx_mem_enabled ? true : false));
+   if (!dbx_mem_since) {
+      args.GetReturnValue().Set(obj);
+      return;
    }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      rc = lmdb_start_ro_transaction(pmeth, 0);
-      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &lmdb_pcursor);
 
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         pmeth->output_val.num.int32 = pmeth->key.args[0].num.int32;
-         lmdb_key.mv_data = &(pmeth->output_val.num.int32);
-         lmdb_key.mv_size = sizeof(pmeth->output_val.num.int32);
+   key = dbx_new_string8(isolate, (char *) "since", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) dbx_mem_since));
+   key = dbx_new_string8(isolate, (char *) "seconds", 0);
+   DBX_SET(obj, key, DBX_NUMBER_NEW((double) (dbx_clock_ms() - dbx_mem_since) / 1000.0));
+
+   objs = DBX_OBJECT_NEW();
+   key = dbx_new_string8(isolate, (char *) "sites", 0);
+   DBX_SET(obj, key, objs);
+
+   for (n = 0; n <= DBX_MEMID_MAX; n ++) {
+      pmstats = &dbx_mem_stats[n];
+      if (n < DBX_MEMID_MAX && !pmstats->allocations) {
+         continue;
       }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         dbx_memcpy_exx(&(pmeth->output_val.svalue), (void *) pmeth->key.args[0].svalue.buf_addr, (size_t) pmeth->key.args[0].svalue.len_used);
-         pmeth->output_val.svalue.len_used = pmeth->key.args[0].svalue.len_used;
-         lmdb_key.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
-         lmdb_key.mv_size = (size_t) pmeth->output_val.svalue.len_used;
+      objx = DBX_OBJECT_NEW();
+      if (n < DBX_MEMID_MAX) {
+         key = dbx_new_string8(isolate, (char *) "id", 0);
+         DBX_SET(objx, key, DBX_INTEGER_NEW(n));
+      }
+      key = dbx_new_string8(isolate, (char *) "live_bytes", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) pmstats->live));
+      key = dbx_new_string8(isolate, (char *) "live_blocks", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) pmstats->blocks));
+      key = dbx_new_string8(isolate, (char *) "allocations", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) pmstats->allocations));
+      key = dbx_new_string8(isolate, (char *) "frees", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) pmstats->frees));
+      key = dbx_new_string8(isolate, (char *) "high_water_bytes", 0);
+      DBX_SET(objx, key, DBX_NUMBER_NEW((double) pmstats->high_water));
+      if (n < DBX_MEMID_MAX) {
+         key = dbx_new_string8(isolate, (char *) dbx_mem_names[n], 0);
+         DBX_SET(objs, key, objx);
       }
       else {
-         lmdb_key.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
-         lmdb_key.mv_size = (size_t) pmeth->output_val.svalue.len_used;
+         key = dbx_new_string8(isolate, (char *) "total", 0);
+         DBX_SET(obj, key, objx);
       }
+   }
 
-      lmdb_data.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
-      lmdb_data.mv_size = (size_t)  pmeth->output_key.svalue.len_alloc;
+   args.GetReturnValue().Set(obj);
+   return;
+}
 
-      rc = pcon->p_lmdb_so->p_mdb_cursor_get(lmdb_pcursor, &lmdb_key, &lmdb_data, MDB_FIRST);
 
-      rkey = (char *) lmdb_key.mv_data;
-      rkey_size = (int) lmdb_key.mv_size;
-      rdata = (char *) lmdb_data.mv_data;
-      rdata_size = (int) lmdb_data.mv_size;
+
+
+
+
+void DBX_DBNAME::MGlobal(const FunctionCallbackInfo<Value>& args)
+{
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::mglobal");
    }
+   pmeth = dbx_request_memory(pcon, 1);
 
-   while (rc == CACHE_SUCCESS) {
-      chrp = 0;
-      num = 0;
-      n1 = 0;
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         sprintf(hex, "%d", (int) pmeth->output_val.num.int32);
-         for (n = 0; hex[n]; n ++) {
-            buffer.buf_addr[n1 ++] = hex[n];
-         }
-      }
-      else {
-         if (option == 1) {
-            sprintf((buffer.buf_addr + n1), "string[%d]", (int) rkey_size);
-            n1 += (int) strlen((char *) (buffer.buf_addr + n1));
-         }
-else {
-         for (n = 0; n < (int) rkey_size; n ++) {
-            if (buffer.len_alloc < ((unsigned int) n1 + 32)) {
-               if (!dbx_buffer_resize(&(buffer.buf_addr), (unsigned int) n1, buffer.len_alloc + 32000, &(buffer.len_alloc))) {
-                  rc = CACHE_FAILURE;
-                  break;
-               }
-            }
-            chr = (unsigned char) *(((char *) rkey) + n);
-            if (num == 0 && n > 0 && chrp == 0 && (chr == 1 || chr == 2)) {
-               num = n + 1;
-            }
-            if (chr < 32 || chr > 126 || (num && (n - num) < 8)) {
-               sprintf(hex, "%02x", chr);
-               buffer.buf_addr[n1 ++] = '\\';
-               buffer.buf_addr[n1 ++] = 'x';
-               buffer.buf_addr[n1 ++] = hex[0];
-               buffer.buf_addr[n1 ++] = hex[1];
-            }
-            else {
-               buffer.buf_addr[n1 ++] = *(((char *) rkey) + n);
-            }
-            if (num && (n - num) >= 7) {
-               num = 0;
-            }
-            chrp = chr;
-         }
-}
-         if (rc != CACHE_SUCCESS) {
-            break;
-         }
-      }
-      buffer.buf_addr[n1 ++] = ' ';
-      buffer.buf_addr[n1 ++] = '=';
-      buffer.buf_addr[n1 ++] = ' ';
-         if (option == 1) {
-rdata[rdata_size] = '\0';
-            sprintf((buffer.buf_addr + n1), "string[%d] %s", (int) rdata_size, rdata);
-            n1 += (int) strlen((char *) (buffer.buf_addr + n1));
-         }
-else {
-
-      for (n = 0; n < (int) rdata_size; n ++) {
-         if (buffer.len_alloc < ((unsigned int) n1 + 32)) {
-            if (!dbx_buffer_resize(&(buffer.buf_addr), (unsigned int) n1, buffer.len_alloc + 32000, &(buffer.len_alloc))) {
-               rc = CACHE_FAILURE;
-               break;
-            }
-         }
-         if ((int) *(((char *) rdata) + n) < 32 || (int) *(((char *) rdata) + n) > 126) {
-            sprintf(hex, "%02x", (unsigned char) *(((char *) rdata) + n));
-            buffer.buf_addr[n1 ++] = '\\';
-            buffer.buf_addr[n1 ++] = 'x';
-            buffer.buf_addr[n1 ++] = hex[0];
-            buffer.buf_addr[n1 ++] = hex[1];
-         }
-         else {
-            buffer.buf_addr[n1 ++] = *(((char *) rdata) + n);
-         }
-      }
-}
-      if (rc != CACHE_SUCCESS) {
-         break;
-      }
-      buffer.buf_addr[n1] = '\0';
+   pmeth->jsargc = args.Length();
 
-      printf("\r\n%s", buffer.buf_addr);
-      if (pcon->key_type == DBX_KEYTYPE_M) {
-         int n, keyn;
-         DBXVAL keys[DBX_MAXARGS];
-         keyn = dbx_split_key(&keys[0], (char *) rkey, (int) rkey_size);
+   /* 1.4.10 */
 
-         for (n = 0; n < keyn; n ++) {
-            num = keys[n].svalue.len_used;
-            if (keys[n].svalue.len_used > 240) {
-               num = 240;
-               strncpy(val, keys[n].svalue.buf_addr, num);
-               val[num] = '\0';
-               strcat(val, " ...");
-            }
-            else {
-               strncpy(val, keys[n].svalue.buf_addr, keys[n].svalue.len_used);
-               val[keys[n].svalue.len_used] = '\0';
-            }
-            if (option == 1) {
-               if (!n)
-                  printf("   %d:%d:%d", keys[n].csize, keys[n].type, keys[n].svalue.len_used);
-               else
-                  printf(", %d:%d:%d", keys[n].csize, keys[n].type, keys[n].svalue.len_used);
-            }
-            else {
-               if (!n)
-                  printf("   %d:%d:%d:%s", keys[n].csize, keys[n].type, keys[n].svalue.len_used, val);
-               else
-                  printf(", %d:%d:%d:%s", keys[n].csize, keys[n].type, keys[n].svalue.len_used, val);
-            }
-         }
-      }
+   if (pmeth->jsargc < 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobal method takes at least one argument (the global name)", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
 
-      if (pcon->dbtype == DBX_DBTYPE_BDB) {
-         rc = bdb_cursor_get(bdb_pcursor, &bdb_key, &(pmeth->output_val.svalue), &bdb_data, &(pmeth->output_key.svalue), DB_NEXT); /* v1.3.9 */
-         /* rc = bdb_pcursor->get(bdb_pcursor, &bdb_key, &bdb_data, DB_NEXT); */
+   mglobal *gx = mglobal::NewInstance(args);
 
-         rkey = (char *) bdb_key.data;
-         rkey_size = (int) bdb_key.size;
-         rdata = (char *) bdb_data.data;
-         rdata_size = (int) bdb_data.size;
-      }
-      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(lmdb_pcursor, &lmdb_key, &lmdb_data, MDB_NEXT);
-         rkey = (char *) lmdb_key.mv_data;
-         rkey_size = (int) lmdb_key.mv_size;
-         if (pcon->key_type == DBX_KEYTYPE_INT) {
-            pmeth->output_val.num.int32 = (int) dbx_get_size((unsigned char *) rkey, 0);
-         }
-         rdata = (char *) lmdb_data.mv_data;
-         rdata_size = (int) lmdb_data.mv_size;
-      }
-      pmeth->output_val.svalue.len_used = 0;
-   }
- 
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      bdb_pcursor->close(bdb_pcursor);
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      pcon->p_lmdb_so->p_mdb_cursor_close(lmdb_pcursor);
-      lmdb_commit_ro_transaction(pmeth, 0);
-   }
+   gx->c = c;
+   gx->pkey = NULL;
 
-Dump_Exit:
+   /* 1.4.10 */
 
-   rc = CACHE_SUCCESS;
-   if (buffer.buf_addr) {
-      dbx_free((void *) buffer.buf_addr, 0);
-      buffer.buf_addr = NULL;
-   }
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Dump");
+   rc = dbx_global_reset(args, isolate, pcon, pmeth, (void *) gx, 0, 0);
+   if (rc < 0) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobal method takes at least one argument (the global name)", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
 
-   DBX_DBFUN_END(c);
-   DBX_DB_UNLOCK();
+/*
+{
+   int n;
+   char buffer[256];
 
-   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
-   args.GetReturnValue().Set(result);
+   printf("\r\n mglobal START");
+   n = 0;
+   pval = gx->pkey;
+   while (pval) {
+      strcpy(buffer, "");
+      if (pmeth->key.args[n].svalue.len_used > 0) {
+         strncpy(buffer,   pval->svalue.buf_addr,   pval->svalue.len_used);
+         buffer[ pval->svalue.len_used] = '\0';
+      }
+      printf("\r\n >>>>>>> n=%d; type=%d; int32=%d; str=%s", ++ n, pval->type, pval->num.int32, buffer);
+      pval = pval->pnext;
+   }
+    printf("\r\n mglobal END");
+}
+*/
    dbx_request_memory_free(pcon, pmeth, 0);
-
    return;
 }
 
 
-void DBX_DBNAME::Benchmark(const FunctionCallbackInfo<Value>& args)
+void DBX_DBNAME::MGlobal_Close(const FunctionCallbackInfo<Value>& args)
 {
+   int js_narg;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
+
+   js_narg = args.Length();
+
+
+   if (js_narg != 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The MGlobal_Close method takes one argument (the MGlobal reference)", 1)));
+      return;
+   }
+
+#if DBX_NODE_VERSION >= 100000
+   mglobal * cx = node::ObjectWrap::Unwrap<mglobal>(args[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked());
+#else
+   mglobal * cx = node::ObjectWrap::Unwrap<mglobal>(args[0]->ToObject());
+#endif
+
+   cx->delete_mglobal_template(cx);
+
    return;
 }
 
 
-#if DBX_NODE_VERSION >= 120000
-class dbxAddonData
+void DBX_DBNAME::MGlobalQuery(const FunctionCallbackInfo<Value>& args)
 {
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
 
-public:
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::mglobalquery");
+   }
+   pmeth = dbx_request_memory(pcon, 1);
 
-   dbxAddonData(Isolate* isolate, Local<Object> exports):
-      call_count(0) {
-         /* Link the existence of this object instance to the existence of exports. */
-         exports_.Reset(isolate, exports);
-         exports_.SetWeak(this, DeleteMe, WeakCallbackType::kParameter);
-      }
+   pmeth->jsargc = args.Length();
 
-   ~dbxAddonData() {
-      if (!exports_.IsEmpty()) {
-         /* Reset the reference to avoid leaking data. */
-         exports_.ClearWeak();
-         exports_.Reset();
-      }
+   if (pmeth->jsargc < 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobalquery method takes at least one argument (the global reference to start with)", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
 
-   /* Per-addon data. */
-   int call_count;
+   mcursor *cx = mcursor::NewInstance(args);
 
-private:
+   dbx_cursor_init((void *) cx);
 
-   /* Method to call when "exports" is about to be garbage-collected. */
-   static void DeleteMe(const WeakCallbackInfo<dbxAddonData>& info) {
-      delete info.GetParameter();
+   cx->c = c;
+
+   /* 1.4.10 */
+   rc = dbx_cursor_reset(args, isolate, pcon, pmeth, (void *) cx, 0, 0);
+   if (rc < 0) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mglobalquery method takes at least one argument (the global reference to start with)", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
 
-   /*
-   Weak handle to the "exports" object. An instance of this class will be
-   destroyed along with the exports object to which it is weakly bound.
-   */
-   v8::Persistent<v8::Object> exports_;
-};
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
 
-#endif
 
+void DBX_DBNAME::MGlobalQuery_Close(const FunctionCallbackInfo<Value>& args)
+{
+   int js_narg;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
 
-/* End of dbx-node class methods */
+   js_narg = args.Length();
 
-Persistent<Function> DBX_DBNAME::constructor;
+   if (js_narg != 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The MGlobalQuery_Close method takes one argument (the MGlobalQuery reference)", 1)));
+      return;
+   }
 
-extern "C" {
-#if defined(_WIN32)
-#if DBX_NODE_VERSION >= 100000
-void __declspec(dllexport) init (Local<Object> exports)
-#else
-void __declspec(dllexport) init (Handle<Object> exports)
-#endif
-#else
 #if DBX_NODE_VERSION >= 100000
-static void init (Local<Object> exports)
+   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked());
 #else
-static void init (Handle<Object> exports)
-#endif
+   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject());
 #endif
-{
-   DBX_DBNAME::Init(exports);
-   mglobal::Init(exports);
-   mcursor::Init(exports);
-}
-
-#if DBX_NODE_VERSION >= 120000
-
-/* exports, module, context */
-extern "C" NODE_MODULE_EXPORT void
-NODE_MODULE_INITIALIZER(Local<Object> exports,
-                        Local<Value> module,
-                        Local<Context> context) {
-   Isolate* isolate = context->GetIsolate();
-
-   /* Create a new instance of dbxAddonData for this instance of the addon. */
-   dbxAddonData* data = new dbxAddonData(isolate, exports);
-   /* Wrap the data in a v8::External so we can pass it to the method we expose. */
-   /* Local<External> external = External::New(isolate, data); */
-   External::New(isolate, data);
-
-   init(exports);
-
-   /*
-   Expose the method "Method" to JavaScript, and make sure it receives the
-   per-addon-instance data we created above by passing `external` as the
-   third parameter to the FunctionTemplate constructor.
-   exports->Set(context, String::NewFromUtf8(isolate, "method", NewStringType::kNormal).ToLocalChecked(), FunctionTemplate::New(isolate, Method, external)->GetFunction(context).ToLocalChecked()).FromJust();
-   */
-
-}
 
-#else
-
-  NODE_MODULE(dbx, init)
+   cx->delete_mcursor_template(cx);
 
-#endif
+   return;
 }
 
 
-DBXMETH * dbx_request_memory(DBXCON *pcon, short context)
+void DBX_DBNAME::SQL(const FunctionCallbackInfo<Value>& args)
 {
-   int n;
+   int rc;
+   DBXCON *pcon;
    DBXMETH *pmeth;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
 
-   pmeth = NULL;
-   if (context) {
-      pmeth = (DBXMETH *) pcon->pmeth_base;
-   }
-   else {
-      if (pcon->use_mutex) {
-         pmeth = dbx_request_memory_alloc(pcon, 0);
-      }
-      else {
-         pmeth = (DBXMETH *) pcon->pmeth_base;
-      }
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::sql");
    }
+   pmeth = dbx_request_memory(pcon, 1);
 
-   pmeth->pcon = pcon;
-   pmeth->binary = 0;
-   pmeth->lock = 0;
-   pmeth->increment = 0;
-   pmeth->done = 0;
-   for (n = 0; n < DBX_MAXARGS; n ++) {
-      pmeth->key.args[n].cvalue.pstr = NULL;
+   pmeth->jsargc = args.Length();
+
+   if (pmeth->jsargc < 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The sql method takes at least one argument (the sql script)", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
 
-   return pmeth;
-}
+   mcursor *cx = mcursor::NewInstance(args);
 
+   dbx_cursor_init((void *) cx);
 
-DBXMETH * dbx_request_memory_alloc(DBXCON *pcon, short context)
-{
-   DBXMETH *pmeth;
+   cx->c = c;
 
-   pmeth = (DBXMETH *) dbx_malloc(sizeof(DBXMETH), 0);
-   if (!pmeth) {
-      return NULL;
+   /* 1.4.10 */
+   rc = dbx_cursor_reset(args, isolate, pcon, pmeth, (void *) cx, 0, 0);
+   if (rc < 0) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The sql method takes at least one argument (the sql script)", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
 
-   pmeth->output_val.svalue.buf_addr = (char *) dbx_malloc(32000, 0);
-   if (!pmeth->output_val.svalue.buf_addr) {
-      dbx_free((void *) pmeth, 0);
-      return NULL;
-   }
-   memset((void *) pmeth->output_val.svalue.buf_addr, 0, 32000);
-   pmeth->output_val.svalue.len_alloc = 32000;
-   pmeth->output_val.svalue.len_used = 0;
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
 
-   pmeth->output_key.svalue.buf_addr = (char *) dbx_malloc(32000, 0);
-   if (!pmeth->output_key.svalue.buf_addr) {
-      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
-      dbx_free((void *) pmeth, 0);
-      return NULL;
-   }
-   memset((void *) pmeth->output_key.svalue.buf_addr, 0, 32000);
-   pmeth->output_key.svalue.len_alloc = 32000;
-   pmeth->output_key.svalue.len_used = 0;
 
-   pmeth->key.ibuffer.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, 0);
-   if (!pmeth->key.ibuffer.buf_addr) {
-      dbx_free((void *) pmeth->output_key.svalue.buf_addr, 0);
-      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
-      dbx_free((void *) pmeth, 0);
-      return NULL;
-   }
+void DBX_DBNAME::SQL_Close(const FunctionCallbackInfo<Value>& args)
+{
+   int js_narg;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ISOLATE;
+   c->dbx_count ++;
 
-   pmeth->key.ibuffer.len_used = 0;
-   pmeth->key.ibuffer.len_alloc = CACHE_MAXSTRLEN;
+   js_narg = args.Length();
 
-   /* v1.3.11 */
-   pmeth->key.args[0].svalue.buf_addr = pmeth->key.ibuffer.buf_addr;
-   pmeth->key.args[0].svalue.len_alloc = pmeth->key.ibuffer.len_alloc;
-   pmeth->key.args[0].svalue.len_used = 0;
+   if (js_narg != 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The SQL_Close method takes one argument (the SQL reference)", 1)));
+      return;
+   }
 
-   pmeth->key.args[1].svalue.buf_addr = NULL;
-   pmeth->key.args[1].svalue.len_alloc = 0;
-   pmeth->key.args[1].svalue.len_used = 0;
+#if DBX_NODE_VERSION >= 100000
+   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked());
+#else
+   mcursor * cx = node::ObjectWrap::Unwrap<mcursor>(args[0]->ToObject());
+#endif
 
+   cx->delete_mcursor_template(cx);
 
-   return pmeth;
+   return;
 }
 
 
-int dbx_request_memory_free(DBXCON *pcon, DBXMETH *pmeth, short context)
+void DBX_DBNAME::Sleep(const FunctionCallbackInfo<Value>& args)
 {
-   if (!pmeth) {
-      return CACHE_SUCCESS;
-   }
-   if (pmeth != (DBXMETH *) pcon->pmeth_base) {
-      if (pmeth->key.ibuffer.buf_addr) {
-         dbx_free((void *) pmeth->key.ibuffer.buf_addr, 0);
-      }
-      if (pmeth->output_val.svalue.buf_addr) {
-         dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
-      }
-      if (pmeth->output_key.svalue.buf_addr) { /* v1.3.10 */
-         dbx_free((void *) pmeth->output_key.svalue.buf_addr, 0);
-      }
-      dbx_free((void *) pmeth, 0);
+   int timeout;
+   Local<Integer> result;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
+
+
+   timeout = 0;
+   if (args[0]->IsInt32()) {
+      timeout = (int) DBX_INT32_VALUE(args[0]);
    }
-   return CACHE_SUCCESS;
+
+   dbx_sleep((unsigned long) timeout);
+ 
+   result = DBX_INTEGER_NEW(0);
+   args.GetReturnValue().Set(result);
 }
 
 
-/* v1.3.9 */
-char * dbx_buffer_resize(char **ppbuffer, unsigned int data_size, unsigned int req_size, unsigned int *size)
+void DBX_DBNAME::Dump(const FunctionCallbackInfo<Value>& args)
 {
-   char *old_buffer;
+   int rc, n, n1, num, rkey_size, rdata_size, js_narg, option;
+   unsigned char chr, chrp;
+   char *rkey, *rdata;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<String> result;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
+   DBT bdb_key, bdb_data;
+   DBC *bdb_pcursor;
+   MDB_val lmdb_key, lmdb_data;
+   MDB_cursor *lmdb_pcursor;
+   char val[256], hex[16];
+   DBXSTR buffer;
 
-   old_buffer = NULL;
-   if (*ppbuffer) {
-      old_buffer = *ppbuffer;
+   option = 0;
+   rkey_size = 0;
+   rdata_size = 0;
+   rkey = NULL;
+   rdata = NULL;
+   buffer.buf_addr = NULL;
+   buffer.len_alloc = 0;
+   buffer.len_used = 0;
+   bdb_pcursor = NULL;
+   lmdb_pcursor = NULL;
+   pcon = c->pcon;
+
+   js_narg = args.Length();
+
+   if (js_narg > 0) {
+      result = DBX_TO_STRING(args[0]);
+      DBX_WRITE_UTF8(result, val, sizeof(val));
+      if (val[0]) {
+         option = (int) strtol(val, NULL, 10);
+      }
    }
 
-   *ppbuffer = (char *) dbx_malloc(req_size, 0);
-   if (!(*ppbuffer)) {
-      return NULL;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::dump");
    }
-   if (data_size) {
-      memcpy((void *) *ppbuffer, (void *) old_buffer, (size_t) data_size);
+   pmeth = dbx_request_memory(pcon, 0);
+
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, rc);
+
+   if (pmeth->jsargc >= DBX_MAXARGS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Dump", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
-   if (old_buffer) {
-      dbx_free((void *) old_buffer, 0);
+   
+   buffer.buf_addr = (char *) dbx_malloc(32000, DBX_MEMID_BUFFER);
+   if (!buffer.buf_addr) {
+      return;
    }
-   *size = req_size;
+   buffer.len_alloc = 32000;
 
-   return (*ppbuffer);
-}
+   DBX_DBFUN_START(c, pcon, pmeth);
 
+   pcon = pmeth->pcon;
 
-#if DBX_NODE_VERSION >= 100000
-void dbx_set_prototype_method(v8::Local<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name, const char* data)
-#else
-void dbx_set_prototype_method(v8::Handle<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name, const char* data)
-#endif
-{
-#if DBX_NODE_VERSION >= 100000
-
-   v8::Isolate* isolate = v8::Isolate::GetCurrent();
-   v8::HandleScope handle_scope(isolate);
-   v8::Local<v8::Signature> s = v8::Signature::New(isolate, t);
-
-#if DBX_NODE_VERSION >= 120000
-   v8::Local<v8::String> data_str = v8::String::NewFromUtf8(isolate, data, NewStringType::kNormal).ToLocalChecked();
-#else
-   v8::Local<v8::String> data_str = v8::String::NewFromUtf8(isolate, data);
-#endif
-
-#if 0
-   v8::Local<v8::FunctionTemplate> tx = v8::FunctionTemplate::New(isolate, callback, v8::Local<v8::Value>(), s);
-#else
-   v8::Local<v8::FunctionTemplate> tx = v8::FunctionTemplate::New(isolate, callback, data_str, s);
-#endif
-
-#if DBX_NODE_VERSION >= 120000
-   v8::Local<v8::String> fn_name = String::NewFromUtf8(isolate, name, NewStringType::kNormal).ToLocalChecked();;
-
-#else
-   v8::Local<v8::String> fn_name = String::NewFromUtf8(isolate, name);
-#endif
-
-   tx->SetClassName(fn_name);
-   t->PrototypeTemplate()->Set(fn_name, tx);
-#else
-   NODE_SET_PROTOTYPE_METHOD(t, name, callback);
-#endif
-
-   return;
-}
-
-
-v8::Local<v8::Object> dbx_is_object(v8::Local<v8::Value> value, int *otype)
-{
-#if DBX_NODE_VERSION >= 100000
-   v8::Isolate* isolate = v8::Isolate::GetCurrent();
-   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
-#endif
-   *otype = 0;
-
-   if (value->IsObject()) {
-      *otype = 1;
-      v8::Local<v8::Object> value_obj = DBX_TO_OBJECT(value);
-      if (node::Buffer::HasInstance(value_obj)) {
-         *otype = 2;
-      }
-      return value_obj;
-   }
-   else {
-      return v8::Local<v8::Object>::Cast(value);
-   }
-}
-
-
-int dbx_string8_length(v8::Isolate * isolate, v8::Local<v8::String> str, int utf8)
-{
-   if (utf8) {
-      return DBX_UTF8_LENGTH(str);
-   }
-   else {
-      return DBX_LENGTH(str);
-   }
-}
-
-v8::Local<v8::String> dbx_new_string8(v8::Isolate * isolate, char * buffer, int utf8)
-{
-   if (utf8) {
-#if DBX_NODE_VERSION >= 120000
-      return v8::String::NewFromUtf8(isolate, buffer, NewStringType::kNormal).ToLocalChecked();
-#else
-      return v8::String::NewFromUtf8(isolate, buffer);
-#endif
-   }
-   else {
-#if DBX_NODE_VERSION >= 100000
-      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, NewStringType::kInternalized).ToLocalChecked();
-#else
-      /* return String::NewFromOneByte(isolate, (uint8_t *) buffer, String::kNormalString); */
-      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, v8::NewStringType::kInternalized).ToLocalChecked();
-#endif
-   }
-}
-
-
-v8::Local<v8::String> dbx_new_string8n(v8::Isolate * isolate, char * buffer, unsigned long len, int utf8)
-{
-   if (utf8) {
-#if DBX_NODE_VERSION >= 120000
-      return v8::String::NewFromUtf8(isolate, buffer, NewStringType::kNormal, len).ToLocalChecked();
-#else
-      return v8::String::NewFromUtf8(isolate, buffer, String::kNormalString, len);
-#endif
-   }
-   else {
-#if DBX_NODE_VERSION >= 100000
-      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, NewStringType::kInternalized, len).ToLocalChecked();
-#else
-      /* return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, String::kNormalString, len); */
-      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, v8::NewStringType::kInternalized, len).ToLocalChecked();
-#endif
-
-   }
-}
-
+   DBX_DB_LOCK(0);
 
-int dbx_write_char8(v8::Isolate * isolate, v8::Local<v8::String> str, char * buffer, int buffer_size, int utf8)
-{
-   /* v1.3.14 */
-   if (utf8) {
-      return DBX_WRITE_UTF8(str, buffer, buffer_size);
-   }
-   else {
-#if DBX_NODE_VERSION >= 240000
-      DBX_WRITE_ONE_BYTE(str, (uint8_t *) buffer);
-      return 0;
-#else
-      return DBX_WRITE_ONE_BYTE(str, (uint8_t *) buffer);
-#endif
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Dump");
+      DBX_DB_UNLOCK();
+      return;
    }
-}
-
-
-int dbx_ibuffer_add(DBXMETH *pmeth, DBXKEY *pkey, v8::Isolate * isolate, int argn, v8::Local<v8::String> str, char * buffer, int buffer_len, short context)
-{
-   int len, n;
-   unsigned char *p;
-   char nstr[64];
-   DBXCON *pcon = pmeth->pcon;
-
-#ifdef _WIN32
-__try {
-#endif
-
-   if (buffer)
-      len = buffer_len;
-   else
-      len = dbx_string8_length(isolate, str, pcon->utf8);
 
-   /* 1.4.11 resize input buffer if necessary */
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      memset(&bdb_key, 0, sizeof(DBT));
+      memset(&bdb_data, 0, sizeof(DBT));
+      bdb_key.flags = DB_DBT_USERMEM;
+      bdb_data.flags = DB_DBT_USERMEM;
 
-   if ((pkey->ibuffer.len_used + len + 32) > pkey->ibuffer.len_alloc) {
+      if (!DBX_BDB_PDB(pmeth)) { /* v1.3.15 global does not exist */
+         goto Dump_Exit;
+      }
+      rc = DBX_BDB_PDB(pmeth)->cursor(DBX_BDB_PDB(pmeth), NULL, &bdb_pcursor, 0);
 
-      p = (unsigned char *) dbx_malloc(sizeof(char) * (pkey->ibuffer.len_used + len + CACHE_MAXSTRLEN), 301);
-      if (p) {
-         if (pkey->ibuffer.buf_addr && pkey->ibuffer.len_used > 0) { 
-            memcpy((void *) p, (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
-            dbx_free((void *) pkey->ibuffer.buf_addr, 301);
-         }
-         pkey->ibuffer.buf_addr = (char *) p;
-         pkey->ibuffer.len_alloc = (pkey->ibuffer.len_used + len + CACHE_MAXSTRLEN);
-         pkey->args[0].svalue.buf_addr = (char *) pkey->ibuffer.buf_addr;
-         for (n = 1; n < pkey->argc; n ++) {
-            pkey->args[n].svalue.buf_addr = (char *) (pkey->ibuffer.buf_addr + pkey->args[n - 1].csize);
-         }
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         pmeth->output_val.num.int32 = pmeth->key.args[0].num.int32;
+         bdb_key.data = &(pmeth->output_val.num.int32);
+         bdb_key.size = sizeof(pmeth->output_val.num.int32);
+         bdb_key.ulen = sizeof(pmeth->output_val.num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         dbx_memcpy_exx(&(pmeth->output_val.svalue), (void *) pmeth->key.args[0].svalue.buf_addr, (size_t) pmeth->key.args[0].svalue.len_used);
+         pmeth->output_val.svalue.len_used = pmeth->key.args[0].svalue.len_used;
+         bdb_key.data = (void *) pmeth->output_val.svalue.buf_addr;
+         bdb_key.size = (u_int32_t) pmeth->output_val.svalue.len_used;
+         bdb_key.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
       }
       else {
-         return 0;
+         bdb_key.data = (void *) pmeth->output_val.svalue.buf_addr;
+         bdb_key.size = (u_int32_t) pmeth->output_val.svalue.len_used;
+         bdb_key.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
       }
-   }
 
-   p = (unsigned char *) (pkey->ibuffer.buf_addr + pkey->ibuffer.len_used);
+      bdb_data.data = (void *) pmeth->output_key.svalue.buf_addr;
+      bdb_data.ulen = (u_int32_t)  pmeth->output_key.svalue.len_alloc;
+      rc = bdb_cursor_get(bdb_pcursor, &bdb_key, &(pmeth->output_val.svalue), &bdb_data, &(pmeth->output_key.svalue), DB_FIRST); /* v1.3.9 */
+      if (rc != CACHE_SUCCESS) {
+         goto Dump_Exit;
+      }
 
-   if (pmeth->pcon->key_type == DBX_KEYTYPE_M) {
-      if (pkey->args[argn].type == DBX_DTYPE_INT) {
-         dbx_set_number(&(pkey->args[argn]), p);
-         p += 10;
-         pkey->ibuffer.len_used += 10;
+      rkey = (char *) bdb_key.data;
+      rkey_size = (int) bdb_key.size;
+      rdata = (char *) bdb_data.data;
+      rdata_size = (int) bdb_data.size;
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      rc = lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &lmdb_pcursor);
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         pmeth->output_val.num.int32 = pmeth->key.args[0].num.int32;
+         lmdb_key.mv_data = &(pmeth->output_val.num.int32);
+         lmdb_key.mv_size = sizeof(pmeth->output_val.num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         dbx_memcpy_exx(&(pmeth->output_val.svalue), (void *) pmeth->key.args[0].svalue.buf_addr, (size_t) pmeth->key.args[0].svalue.len_used);
+         pmeth->output_val.svalue.len_used = pmeth->key.args[0].svalue.len_used;
+         lmdb_key.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+         lmdb_key.mv_size = (size_t) pmeth->output_val.svalue.len_used;
       }
       else {
-         *(p ++) = 0x00;
-         *(p ++) = 0x03;
-         pkey->ibuffer.len_used += 2;
+         lmdb_key.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+         lmdb_key.mv_size = (size_t) pmeth->output_val.svalue.len_used;
       }
-   }
 
-   if (buffer) {
-      T_MEMCPY((void *) p, (void *) buffer, (size_t) len);
-   }
-   else {
-      dbx_write_char8(isolate, str, (char *) p, pkey->ibuffer.len_alloc - pkey->ibuffer.len_used, pcon->utf8);
-   }
-   pkey->ibuffer.len_used += len;
+      lmdb_data.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
+      lmdb_data.mv_size = (size_t)  pmeth->output_key.svalue.len_alloc;
 
-   pkey->args[argn].svalue.buf_addr = (char *) p;
-   pkey->args[argn].svalue.len_alloc = len;
-   pkey->args[argn].svalue.len_used = len;
-   pkey->args[argn].csize = pkey->ibuffer.len_used;
-   pkey->argc = argn;
+      rc = pcon->p_lmdb_so->p_mdb_cursor_get(lmdb_pcursor, &lmdb_key, &lmdb_data, MDB_FIRST);
 
-   if (pmeth->pcon->key_type == DBX_KEYTYPE_M) {
-      if (pkey->args[argn].type == DBX_DTYPE_STR && dbx_is_number(&(pkey->args[argn]))) { /* See if we have a stringified number */
+      rkey = (char *) lmdb_key.mv_data;
+      rkey_size = (int) lmdb_key.mv_size;
+      rdata = (char *) lmdb_data.mv_data;
+      rdata_size = (int) lmdb_data.mv_size;
+   }
 
-         for (n = (len - 1); n >= 0; n --) {
-            p[n + 8] = p[n];
+   while (rc == CACHE_SUCCESS) {
+      chrp = 0;
+      num = 0;
+      n1 = 0;
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         sprintf(hex, "%d", (int) pmeth->output_val.num.int32);
+         for (n = 0; hex[n]; n ++) {
+            buffer.buf_addr[n1 ++] = hex[n];
+         }
+      }
+      else {
+         if (option == 1) {
+            sprintf((buffer.buf_addr + n1), "string[%d]", (int) rkey_size);
+            n1 += (int) strlen((char *) (buffer.buf_addr + n1));
+         }
+else {
+         for (n = 0; n < (int) rkey_size; n ++) {
+            if (buffer.len_alloc < ((unsigned int) n1 + 32)) {
+               if (!dbx_buffer_resize(&(buffer.buf_addr), (unsigned int) n1, buffer.len_alloc + 32000, &(buffer.len_alloc))) {
+                  rc = CACHE_FAILURE;
+                  break;
+               }
+            }
+            chr = (unsigned char) *(((char *) rkey) + n);
+            if (num == 0 && n > 0 && chrp == 0 && (chr == 1 || chr == 2)) {
+               num = n + 1;
+            }
+            if (chr < 32 || chr > 126 || (num && (n - num) < 8)) {
+               sprintf(hex, "%02x", chr);
+               buffer.buf_addr[n1 ++] = '\\';
+               buffer.buf_addr[n1 ++] = 'x';
+               buffer.buf_addr[n1 ++] = hex[0];
+               buffer.buf_addr[n1 ++] = hex[1];
+            }
+            else {
+               buffer.buf_addr[n1 ++] = *(((char *) rkey) + n);
+            }
+            if (num && (n - num) >= 7) {
+               num = 0;
+            }
+            chrp = chr;
+         }
+}
+         if (rc != CACHE_SUCCESS) {
+            break;
          }
-
-         dbx_set_number(&(pkey->args[argn]), p - 2);
-         p += 8;
-         pkey->ibuffer.len_used += 8;
-         pkey->args[argn].svalue.buf_addr = (char *) p;
-         pkey->args[argn].csize = pkey->ibuffer.len_used;
-         /* dbx_dump_key((char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used); */
       }
+      buffer.buf_addr[n1 ++] = ' ';
+      buffer.buf_addr[n1 ++] = '=';
+      buffer.buf_addr[n1 ++] = ' ';
+         if (option == 1) {
+rdata[rdata_size] = '\0';
+            sprintf((buffer.buf_addr + n1), "string[%d] %s", (int) rdata_size, rdata);
+            n1 += (int) strlen((char *) (buffer.buf_addr + n1));
+         }
+else {
 
-      if (argn == 0 && p[0] == '^') {
-         for (n = 1; n < len; n ++) {
-            p[n - 1] = p[n];
+      for (n = 0; n < (int) rdata_size; n ++) {
+         if (buffer.len_alloc < ((unsigned int) n1 + 32)) {
+            if (!dbx_buffer_resize(&(buffer.buf_addr), (unsigned int) n1, buffer.len_alloc + 32000, &(buffer.len_alloc))) {
+               rc = CACHE_FAILURE;
+               break;
+            }
+         }
+         if ((int) *(((char *) rdata) + n) < 32 || (int) *(((char *) rdata) + n) > 126) {
+            sprintf(hex, "%02x", (unsigned char) *(((char *) rdata) + n));
+            buffer.buf_addr[n1 ++] = '\\';
+            buffer.buf_addr[n1 ++] = 'x';
+            buffer.buf_addr[n1 ++] = hex[0];
+            buffer.buf_addr[n1 ++] = hex[1];
+         }
+         else {
+            buffer.buf_addr[n1 ++] = *(((char *) rdata) + n);
          }
-         len --;
-         p[len] = '\0';
-         pkey->args[argn].svalue.len_alloc = len;
-         pkey->args[argn].svalue.len_used = len;
-         pkey->ibuffer.len_used --;
-         pkey->args[argn].csize = pkey->ibuffer.len_used;
       }
-      if (pkey->args[argn].svalue.len_used == 0) { /* null - so introducing sequence must be \x00\x00 */
-         pkey->ibuffer.buf_addr[pkey->ibuffer.len_used - 1] = 0x00;
+}
+      if (rc != CACHE_SUCCESS) {
+         break;
       }
-   }
-   else { /* v1.0.2 */
-      if (pkey->args[argn].type == DBX_DTYPE_STR && dbx_is_number(&pkey->args[argn])) { /* See if we have a stringified number */
-         strncpy(nstr, pkey->args[argn].svalue.buf_addr, pkey->args[argn].svalue.len_used);
-         nstr[pkey->args[argn].svalue.len_used] = '\0';
-         pkey->args[argn].num.int32 = (int) strtol(nstr, NULL, 10);
+      buffer.buf_addr[n1] = '\0';
+
+      printf("\r\n%s", buffer.buf_addr);
+      if (pcon->key_type == DBX_KEYTYPE_M) {
+         int n, keyn;
+         DBXVAL keys[DBX_MAXARGS];
+         keyn = dbx_split_key(&keys[0], (char *) rkey, (int) rkey_size);
+
+         for (n = 0; n < keyn; n ++) {
+            num = keys[n].svalue.len_used;
+            if (keys[n].svalue.len_used > 240) {
+               num = 240;
+               strncpy(val, keys[n].svalue.buf_addr, num);
+               val[num] = '\0';
+               strcat(val, " ...");
+            }
+            else {
+               strncpy(val, keys[n].svalue.buf_addr, keys[n].svalue.len_used);
+               val[keys[n].svalue.len_used] = '\0';
+            }
+            if (option == 1) {
+               if (!n)
+                  printf("   %d:%d:%d", keys[n].csize, keys[n].type, keys[n].svalue.len_used);
+               else
+                  printf(", %d:%d:%d", keys[n].csize, keys[n].type, keys[n].svalue.len_used);
+            }
+            else {
+               if (!n)
+                  printf("   %d:%d:%d:%s", keys[n].csize, keys[n].type, keys[n].svalue.len_used, val);
+               else
+                  printf(", %d:%d:%d:%s", keys[n].csize, keys[n].type, keys[n].svalue.len_used, val);
+            }
+         }
       }
-   }
 
-   return len;
+      if (pcon->dbtype == DBX_DBTYPE_BDB) {
+         rc = bdb_cursor_get(bdb_pcursor, &bdb_key, &(pmeth->output_val.svalue), &bdb_data, &(pmeth->output_key.svalue), DB_NEXT); /* v1.3.9 */
+         /* rc = bdb_pcursor->get(bdb_pcursor, &bdb_key, &bdb_data, DB_NEXT); */
 
-#ifdef _WIN32
-}
-__except (EXCEPTION_EXECUTE_HANDLER) {
+         rkey = (char *) bdb_key.data;
+         rkey_size = (int) bdb_key.size;
+         rdata = (char *) bdb_data.data;
+         rdata_size = (int) bdb_data.size;
+      }
+      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(lmdb_pcursor, &lmdb_key, &lmdb_data, MDB_NEXT);
+         rkey = (char *) lmdb_key.mv_data;
+         rkey_size = (int) lmdb_key.mv_size;
+         if (pcon->key_type == DBX_KEYTYPE_INT) {
+            pmeth->output_val.num.int32 = (int) dbx_get_size((unsigned char *) rkey, 0);
+         }
+         rdata = (char *) lmdb_data.mv_data;
+         rdata_size = (int) lmdb_data.mv_size;
+      }
+      pmeth->output_val.svalue.len_used = 0;
+   }
+ 
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      bdb_pcursor->close(bdb_pcursor);
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      pcon->p_lmdb_so->p_mdb_cursor_close(lmdb_pcursor);
+      lmdb_commit_ro_transaction(pmeth, 0);
+   }
 
-   DWORD code;
-   char bufferx[256];
+Dump_Exit:
 
-   __try {
-      code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_ibuffer_add: %x", code);
-      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   rc = CACHE_SUCCESS;
+   if (buffer.buf_addr) {
+      dbx_free((void *) buffer.buf_addr, 0);
+      buffer.buf_addr = NULL;
    }
-   __except (EXCEPTION_EXECUTE_HANDLER) {
-      ;
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbxbdb::Dump");
    }
 
-   return 0;
-}
-#endif
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
+   args.GetReturnValue().Set(result);
+   dbx_request_memory_free(pcon, pmeth, 0);
+
+   return;
 }
 
 
-int dbx_is_number(DBXVAL *pval)
+/* v1.3.31 Run a native benchmark workload: db.benchmark({op: 'get', order: 'random', threads: 4, keys: 100000, ...}) */
+void DBX_DBNAME::Benchmark(const FunctionCallbackInfo<Value>& args)
 {
-   int neg, dp, num;
-   unsigned int n;
-   char buffer[64];
+   short async;
+   int rc, n, key_len;
+   char name[256], buffer[256];
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   DBXBENCH bench, *pbench;
+   Local<Object> obj;
+   Local<String> key;
+   Local<String> value;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
 
-   if (pval->svalue.len_used == 0 || pval->svalue.len_used > 32) {
-      return 0;
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      LogFunction(c, args, NULL, (char *) DBX_DBNAME_STR "::benchmark");
    }
+   pmeth = dbx_request_memory(pcon, 0);
 
-   neg = 0;
-   if (pval->svalue.buf_addr[0] == '-')
-      neg = 1;
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
-   dp = 0;
-   num = 1;
-   for (n = neg; n < pval->svalue.len_used; n ++) {
-      if (pval->svalue.buf_addr[n] == '.' && dp == 0) {
-         dp = 1;
-         continue;
-      }
-      if ((int) pval->svalue.buf_addr[n] < 48 || (int) pval->svalue.buf_addr[n] > 57) {
-         num = 0;
-         break;
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   memset((void *) &bench, 0, sizeof(DBXBENCH));
+   bench.op = DBX_BENCH_GET;
+   bench.random = 1;
+   bench.threads = 1;
+   bench.keys = 10000;
+   bench.count = 0;
+   bench.subscripts = 1;
+   bench.value_size = 32;
+   strcpy(bench.global, DBX_BENCH_GLOBAL);
+
+   *buffer = '\0';
+   if (pmeth->jsargc > 0 && args[0]->IsObject()) {
+      obj = DBX_TO_OBJECT(args[0]);
+#if DBX_NODE_VERSION >= 120000
+      Local<Array> a = obj->GetPropertyNames(icontext).ToLocalChecked();
+#else
+      Local<Array> a = obj->GetPropertyNames();
+#endif
+      for (n = 0; n < (int) a->Length(); n ++) {
+         key = DBX_TO_STRING(DBX_GET(a, n));
+         key_len = dbx_string8_length(isolate, key, 0);
+         if (key_len > 60) {
+            continue;
+         }
+         DBX_WRITE_UTF8(key, (char *) name, sizeof(name));
+
+         if (!strcmp(name, (char *) "op")) {
+            value = DBX_TO_STRING(DBX_GET(obj, key));
+            DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+            dbx_lcase(buffer);
+            if (!strcmp(buffer, (char *) "get"))
+               bench.op = DBX_BENCH_GET;
+            else if (!strcmp(buffer, (char *) "set"))
+               bench.op = DBX_BENCH_SET;
+            else if (!strcmp(buffer, (char *) "next"))
+               bench.op = DBX_BENCH_NEXT;
+            else if (!strcmp(buffer, (char *) "query"))
+               bench.op = DBX_BENCH_QUERY;
+            else if (!strcmp(buffer, (char *) "increment"))
+               bench.op = DBX_BENCH_INCREMENT;
+            else {
+               sprintf(buffer, "Invalid op on Benchmark (get, set, next, query or increment)");
+               break;
+            }
+            *buffer = '\0';
+         }
+         else if (!strcmp(name, (char *) "order")) {
+            value = DBX_TO_STRING(DBX_GET(obj, key));
+            DBX_WRITE_UTF8(value, buffer, sizeof(buffer));
+            dbx_lcase(buffer);
+            if (!strcmp(buffer, (char *) "random"))
+               bench.random = 1;
+            else if (!strcmp(buffer, (char *) "sequential"))
+               bench.random = 0;
+            else {
+               sprintf(buffer, "Invalid order on Benchmark (random or sequential)");
+               break;
+            }
+            *buffer = '\0';
+         }
+         else if (!strcmp(name, (char *) "threads")) {
+            bench.threads = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         }
+         else if (!strcmp(name, (char *) "keys")) {
+            bench.keys = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         }
+         else if (!strcmp(name, (char *) "count")) {
+            bench.count = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         }
+         else if (!strcmp(name, (char *) "subscripts")) {
+            bench.subscripts = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         }
+         else if (!strcmp(name, (char *) "value_size")) {
+            bench.value_size = (int) DBX_INT32_VALUE(DBX_GET(obj, key));
+         }
+         else if (!strcmp(name, (char *) "global")) {
+            value = DBX_TO_STRING(DBX_GET(obj, key));
+            DBX_WRITE_UTF8(value, bench.global, sizeof(bench.global));
+         }
       }
    }
 
-   if (num && !dp) { /* convert to integer if possible */
-      strncpy(buffer, pval->svalue.buf_addr, pval->svalue.len_used);
-      buffer[pval->svalue.len_used] = '\0';
-      pval->num.int32 = (int) strtol(buffer, NULL, 10);
-      pval->type = DBX_DTYPE_INT;
+   if (!(*buffer)) {
+      if (bench.threads < 1 || bench.threads > DBX_BENCH_MAX_THREADS)
+         sprintf(buffer, "Invalid threads on Benchmark (1 to %d)", DBX_BENCH_MAX_THREADS);
+      else if (bench.keys < 1)
+         strcpy(buffer, "Invalid keys on Benchmark");
+      else if (bench.count < 0 || (bench.count > 0 && bench.count > (0x7fffffff / bench.threads)))
+         strcpy(buffer, "Invalid count on Benchmark");
+      else if (bench.subscripts < 1 || bench.subscripts > (DBX_MAXARGS - 4))
+         strcpy(buffer, "Invalid subscripts on Benchmark");
+      else if (bench.value_size < 0 || bench.value_size > (CACHE_MAXSTRLEN / 2))
+         strcpy(buffer, "Invalid value_size on Benchmark");
+      else if (!bench.global[0])
+         strcpy(buffer, "Invalid global on Benchmark");
+   }
+   if (*buffer) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) buffer, 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
-   return num;
-}
-
-
 
-int dbx_set_number(DBXVAL *pval, unsigned char *px)
-{
-   int num, dec;
-   unsigned char *p;
-   char buffer[128], decstr[64];
+   if (!bench.count) {
+      bench.count = bench.keys;
+   }
+   if (!pcon->use_mutex) { /* the workload is only spread over threads if the connection is thread-safe */
+      bench.threads = 1;
+   }
 
-   dec = 0;
-   if (pval->type == DBX_DTYPE_INT) {
-      num = pval->num.int32;
+   pbench = (DBXBENCH *) dbx_malloc(sizeof(DBXBENCH), DBX_MEMID_BENCH);
+   if (!pbench) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "No Memory", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
-   else {
-      strncpy(buffer, pval->svalue.buf_addr, pval->svalue.len_used);
-      buffer[pval->svalue.len_used] = '\0';
-      p = (unsigned char *) strstr(buffer, ".");
-      if (p) {
-         *(p ++) = '\0';
-         sprintf(decstr, "%s", p);
-         strcat(decstr, "000000000");
-         decstr[9] = '\0';
-         dec = (int) strtol(decstr, NULL, 10);
+   memcpy((void *) pbench, (void *) &bench, sizeof(DBXBENCH));
+   pmeth->pbench = pbench;
+
+   if (async) {
+      dbx_baton_t *baton = dbx_make_baton(c, pmeth);
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_benchmark;
+      Local<Function> cb = Local<Function>::Cast(args[args.Length() - 1]);
+      baton->cb.Reset(isolate, cb);
+      c->Ref();
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         dbx_destroy_baton(baton, pmeth);
+         dbx_free((void *) pbench, 0);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
       }
-      num = (int) strtol(buffer, NULL, 10);
+      return;
    }
 
-   if (num < 0) {
-      num *= -1;
-      *(px ++) = 0x00;
-      *(px ++) = 0x01;
-      dbx_set_size((unsigned char *) px, 0xffffffff - (unsigned long) num, 1);
-      px += 4;
-      dbx_set_size((unsigned char *) px, 0xffffffff - (unsigned long) dec, 1);
-      px += 4;
-   }
-   else {
-      *(px ++) = 0x00;
-      *(px ++) = 0x02;
-      dbx_set_size((unsigned char *) px, (unsigned long) num, 1);
-      px += 4;
-      dbx_set_size((unsigned char *) px, (unsigned long) dec, 1);
-      px += 4;
+   pcon->error[0] = '\0';
+   rc = dbx_benchmark(pmeth);
+
+   DBX_DBFUN_END(c);
+
+   if (rc != CACHE_SUCCESS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
    }
-   return 0;
+
+   value = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, 0);
+#if DBX_NODE_VERSION >= 80000
+   args.GetReturnValue().Set(v8::JSON::Parse(icontext, value).ToLocalChecked());
+#else
+   args.GetReturnValue().Set(value);
+#endif
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
 }
 
 
-int dbx_split_key(DBXVAL *keys, char * key, int key_len)
+#if DBX_NODE_VERSION >= 120000
+class dbxAddonData
 {
-   int n, keyn, nstart, nend;
-   char *dp;
-   char numstr[256];
 
-   nstart = 0;
-   nend = 0;
-   keyn = 0;
-   n = 0;
-   while (n < key_len) {
-      if (key[n] == 0x00 && (key[n + 1] == 0x01 || key[n + 1] == 0x02)) { /* number */
-        nend = n;
-         if (keyn > 0) {
-            keys[keyn - 1].svalue.len_used = (nend - nstart);
-            keys[keyn - 1].svalue.len_alloc = keys[keyn - 1].svalue.len_used;
-            keys[keyn - 1].csize = nend;
-         }
-         nstart = n + 10;
-         keys[keyn].svalue.buf_addr = key + nstart;
-         keys[keyn].num.int32 = (int) strtol(keys[keyn].svalue.buf_addr, NULL, 10);
-         keys[keyn].type = DBX_DTYPE_INT;
-         keyn ++;
-         n += 10;
-      }
-      else if (key[n] == 0x00 && key[n + 1] == 0x03) { /* string */
-         nend = n;
-         if (keyn > 0) {
-            keys[keyn - 1].svalue.len_used = (nend - nstart);
-            keys[keyn - 1].svalue.len_alloc = keys[keyn - 1].svalue.len_used;
-            keys[keyn - 1].csize = nend;
-         }
-         nstart = n + 2;
-         keys[keyn].svalue.buf_addr = key + nstart;
-         keys[keyn].type = DBX_DTYPE_STR;
-         keyn ++;
-         n += 2;
+public:
+
+   dbxAddonData(Isolate* isolate, Local<Object> exports):
+      call_count(0) {
+         /* Link the existence of this object instance to the existence of exports. */
+         exports_.Reset(isolate, exports);
+         exports_.SetWeak(this, DeleteMe, WeakCallbackType::kParameter);
       }
-      n ++;
-   }
-   if (keyn > 0) {
-      keys[keyn - 1].svalue.len_used = (key_len - nstart);
-      keys[keyn - 1].svalue.len_alloc = keys[keyn - 1].svalue.len_used;
-      keys[keyn - 1].csize = key_len;
-   }
 
-   for (n = 0; n < keyn; n ++) {
-      if (keys[n].type == DBX_DTYPE_INT) {  /* v1.3.11 was keys[keyn].type == DBX_DTYPE_INT */
-         strncpy(numstr, keys[n].svalue.buf_addr, keys[n].svalue.len_used);
-         numstr[keys[n].svalue.len_used] = '\0';
-         dp = strstr(numstr, ".");
-         if (dp) {
-            keys[n].type = DBX_DTYPE_STR;
-         }
+   ~dbxAddonData() {
+      if (!exports_.IsEmpty()) {
+         /* Reset the reference to avoid leaking data. */
+         exports_.ClearWeak();
+         exports_.Reset();
       }
    }
 
-   return keyn;
-}
-
+   /* Per-addon data. */
+   int call_count;
 
-int dbx_dump_key(char * key, int key_len)
-{
-   int n, n1;
-   char buffer[4096], hex[16];
+private:
 
-   n1 = 0;
-   for (n = 0; n < key_len; n ++) {
-      if ((int) *(((char *) key) + n) < 32 || (int) *(((char *) key) + n) > 126) {
-         sprintf(hex, "%02x", (unsigned char) *(((char *) key) + n));
-         buffer[n1 ++] = '\\';
-         buffer[n1 ++] = 'x';
-         buffer[n1 ++] = hex[0];
-         buffer[n1 ++] = hex[1];
-      }
-      else {
-         buffer[n1 ++] = *(((char *) key) + n);
-      }
+   /* Method to call when "exports" is about to be garbage-collected. */
+   static void DeleteMe(const WeakCallbackInfo<dbxAddonData>& info) {
+      delete info.GetParameter();
    }
-   buffer[n1] = '\0';
-   printf("\r\n%s", buffer);
 
-   return 0;
-}
+   /*
+   Weak handle to the "exports" object. An instance of this class will be
+   destroyed along with the exports object to which it is weakly bound.
+   */
+   v8::Persistent<v8::Object> exports_;
+};
 
+#endif
 
-/* copy with possible overlap */
-int dbx_memcpy(void * to, void *from, size_t size)
-{
-   int n;
-   char *p1, *p2;
 
-   p1 = (char *) to;
-   p2 = (char *) from;
+/* End of dbx-node class methods */
 
-   for (n = 0; n < (int) size; n ++) {
-      *p1 ++ = *p2 ++;
-   }
-   return 0;
+/* v1.3.32 Each Node.js isolate (the main thread and each worker thread) runs on its own thread and needs its own constructors */
+thread_local Persistent<Function> DBX_DBNAME::constructor;
+
+extern "C" {
+#if defined(_WIN32)
+#if DBX_NODE_VERSION >= 100000
+void __declspec(dllexport) init (Local<Object> exports)
+#else
+void __declspec(dllexport) init (Handle<Object> exports)
+#endif
+#else
+#if DBX_NODE_VERSION >= 100000
+static void init (Local<Object> exports)
+#else
+static void init (Handle<Object> exports)
+#endif
+#endif
+{
+   DBX_DBNAME::Init(exports);
+   mglobal::Init(exports);
+   mcursor::Init(exports);
 }
 
+#if DBX_NODE_VERSION >= 120000
 
-/* extended copy with possible overlap */
-int dbx_memcpy_ex(DBXSTR * to, void *from, size_t size)
-{
-   char *p, *pold;
+/* exports, module, context */
+extern "C" NODE_MODULE_EXPORT void
+NODE_MODULE_INITIALIZER(Local<Object> exports,
+                        Local<Value> module,
+                        Local<Context> context) {
+   Isolate* isolate = context->GetIsolate();
 
-   p = NULL;
-   pold = NULL;
-   if (to->len_alloc < size) {
-      p = (char *) dbx_malloc((int) (size + 32), 0);
-      if (!p) {
-         return CACHE_FAILURE;
-      }
-      pold = to->buf_addr;
-      to->buf_addr = p;
-      to->len_alloc = (unsigned int) (size + 32);
-   }
+   /* Create a new instance of dbxAddonData for this instance of the addon. */
+   dbxAddonData* data = new dbxAddonData(isolate, exports);
+   /* Wrap the data in a v8::External so we can pass it to the method we expose. */
+   /* Local<External> external = External::New(isolate, data); */
+   External::New(isolate, data);
 
-   dbx_memcpy(to->buf_addr, from, size);
-   to->len_used = (unsigned int) size;
+   init(exports);
 
-   if (pold) {
-      dbx_free((void *) pold, 0);
-   }
+   /*
+   Expose the method "Method" to JavaScript, and make sure it receives the
+   per-addon-instance data we created above by passing `external` as the
+   third parameter to the FunctionTemplate constructor.
+   exports->Set(context, String::NewFromUtf8(isolate, "method", NewStringType::kNormal).ToLocalChecked(), FunctionTemplate::New(isolate, Method, external)->GetFunction(context).ToLocalChecked()).FromJust();
+   */
 
-   return CACHE_SUCCESS;
 }
 
+#else
 
-/* extended copy with no overlap */
-int dbx_memcpy_exx(DBXSTR * to, void *from, size_t size)
-{
-   if (to->len_alloc < size) {
-      if (!dbx_buffer_resize(&(to->buf_addr), 0, (unsigned int) size + 32, &(to->len_alloc))) {
-         return CACHE_FAILURE;
-      }
-   }
-   
-   memcpy((void *) to->buf_addr, from, size);
-   to->len_used = (unsigned int) size;
+  NODE_MODULE(dbx, init)
 
-   return CACHE_SUCCESS;
+#endif
 }
 
 
-int dbx_global_reset(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pgx, int argc_offset, short context)
+DBXMETH * dbx_request_memory(DBXCON *pcon, short context)
 {
-   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
-   int n, len, otype;
-   char global_name[256], *p;
-   DBXVAL *pval, *pvalp;
-   v8::Local<v8::Object> obj;
-   v8::Local<v8::String> str;
-   mglobal *gx = (mglobal *) pgx;
-
-#ifdef _WIN32
-__try {
-#endif
+   int n;
+   DBXMETH *pmeth;
 
-   if (pcon->log_functions && gx && gx->c) {
-      gx->c->LogFunction(gx->c, args, NULL, (char *) "dbx_global_reset");
+   pmeth = NULL;
+   if (context) {
+      pmeth = (DBXMETH *) pcon->pmeth_base;
    }
-
-   dbx_write_char8(isolate, DBX_TO_STRING(args[argc_offset]), global_name, sizeof(global_name), pcon->utf8);
-   if (global_name[0] == '\0') {
-      return -1;
-   }
-
-   pval = gx->pkey;
-   while (pval) {
-      pvalp = pval;
-      pval = pval->pnext;
-      dbx_free((void *) pvalp, 0);
-   }
-   gx->pkey = NULL;
-
-   if (pcon->key_type == DBX_KEYTYPE_M) {
-      if (global_name[0] == '^') {
-         T_STRCPY(gx->global_name, _dbxso(gx->global_name), global_name + 1);
+   else {
+      if (pcon->use_mutex) {
+         pmeth = dbx_request_memory_alloc(pcon, 0);
       }
       else {
-         T_STRCPY(gx->global_name, _dbxso(gx->global_name), global_name);
+         pmeth = (DBXMETH *) pcon->pmeth_base;
       }
    }
 
-   pvalp = NULL;
-   for (n = (argc_offset + 1); n < pmeth->jsargc; n ++) {
-      if (args[n]->IsInt32()) {
-         pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL), 0);
-         pval->type = DBX_DTYPE_INT;
-         pval->num.int32 = (int) DBX_INT32_VALUE(args[n]);
-      }
-      else {
-         obj = dbx_is_object(args[n], &otype);
-         if (otype == 2) {
-            p = node::Buffer::Data(obj);
-            len = (int) node::Buffer::Length(obj);
-            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, 0);
-            pval->type = DBX_DTYPE_STR;
-            pval->svalue.buf_addr = ((char *) pval) + sizeof(DBXVAL);
-            memcpy((void *) pval->svalue.buf_addr, (void *) p, (size_t) len);
-            pval->svalue.len_alloc = len + 32;
-            pval->svalue.len_used = len;
-         }
-         else {
-            str = DBX_TO_STRING(args[n]);
-            len = (int) dbx_string8_length(isolate, str, 0);
-            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, 0);
-            pval->type = DBX_DTYPE_STR;
-            pval->svalue.buf_addr = ((char *) pval) + sizeof(DBXVAL);
-            dbx_write_char8(isolate, str, pval->svalue.buf_addr, pval->svalue.len_alloc, 1);
-            pval->svalue.len_alloc = len + 32;
-            pval->svalue.len_used = len;
-         }
-      }
-      if (pvalp) {
-         pvalp->pnext = pval;
-      }
-      else {
-         gx->pkey = pval;
-      }
-      pvalp = pval;
-      pvalp->pnext = NULL;
+   pmeth->pcon = pcon;
+   pmeth->binary = 0;
+   pmeth->lock = 0;
+   pmeth->increment = 0;
+   pmeth->update = 0;
+   pmeth->done = 0;
+   pmeth->pgdb = NULL; /* v1.3.15 */
+   pmeth->pgdbref = NULL;
+   pmeth->jsarg0 = 0; /* v1.3.21 */
+   pmeth->pcomp = &(pcon->comp); /* v1.3.23 */
+   pmeth->tvalue = DBX_TVALUE_NONE; /* v1.3.24 */
+   pmeth->expiry = 0; /* v1.3.27 */
+   pmeth->typed = 0; /* v1.3.27 */
+   pmeth->json = 0; /* v1.3.31 */
+   pmeth->pbench = NULL;
+   pmeth->tqueue = 0; /* v1.3.33 */
+   pmeth->fast = 0; /* v1.3.34 */
+   pmeth->trace = 0; /* v1.3.36 */
+   pmeth->trace_cmnd = -1;
+   pmeth->tresult = 0;
+   if (pcon->trace.active) {
+      dbx_trace_sample(pmeth);
+   }
+   for (n = 0; n < DBX_MAXARGS; n ++) {
+      pmeth->key.args[n].cvalue.pstr = NULL;
    }
 
-   return 0;
-
-#ifdef _WIN32
+   return pmeth;
 }
-__except (EXCEPTION_EXECUTE_HANDLER) {
 
-   DWORD code;
-   char bufferx[256];
 
-   __try {
-      code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_global_reset: %x", code);
-      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+DBXMETH * dbx_request_memory_alloc(DBXCON *pcon, short context)
+{
+   DBXMETH *pmeth;
+
+   pmeth = (DBXMETH *) dbx_malloc(sizeof(DBXMETH), DBX_MEMID_METH);
+   if (!pmeth) {
+      return NULL;
    }
-   __except (EXCEPTION_EXECUTE_HANDLER) {
-      ;
+
+   pmeth->output_val.svalue.buf_addr = (char *) dbx_malloc(32000, DBX_MEMID_METH);
+   if (!pmeth->output_val.svalue.buf_addr) {
+      dbx_free((void *) pmeth, 0);
+      return NULL;
    }
+   memset((void *) pmeth->output_val.svalue.buf_addr, 0, 32000);
+   pmeth->output_val.svalue.len_alloc = 32000;
+   pmeth->output_val.svalue.len_used = 0;
 
-   return 0;
-}
-#endif
-}
+   pmeth->output_key.svalue.buf_addr = (char *) dbx_malloc(32000, DBX_MEMID_METH);
+   if (!pmeth->output_key.svalue.buf_addr) {
+      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
+      dbx_free((void *) pmeth, 0);
+      return NULL;
+   }
+   memset((void *) pmeth->output_key.svalue.buf_addr, 0, 32000);
+   pmeth->output_key.svalue.len_alloc = 32000;
+   pmeth->output_key.svalue.len_used = 0;
 
+   pmeth->key.ibuffer.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, DBX_MEMID_METH);
+   if (!pmeth->key.ibuffer.buf_addr) {
+      dbx_free((void *) pmeth->output_key.svalue.buf_addr, 0);
+      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
+      dbx_free((void *) pmeth, 0);
+      return NULL;
+   }
 
-int dbx_cursor_init(void *pcx)
-{
-   mcursor *cx = (mcursor *) pcx;
+   pmeth->key.ibuffer.len_used = 0;
+   pmeth->key.ibuffer.len_alloc = CACHE_MAXSTRLEN;
 
-   cx->context = 0;
-   cx->getdata = 0;
-   cx->format = 0;
-   cx->counter = 0;
-   cx->global_name[0] = '\0';
-   cx->pqr_prev = NULL;
-   cx->pqr_next = NULL;
-   cx->data.buf_addr = NULL;
-   cx->data.len_alloc = 0;
-   cx->data.len_used = 0;
-   cx->psql = NULL;
-   cx->c = NULL;
-   cx->pcursor = NULL;
+   /* v1.3.11 */
+   pmeth->key.args[0].svalue.buf_addr = pmeth->key.ibuffer.buf_addr;
+   pmeth->key.args[0].svalue.len_alloc = pmeth->key.ibuffer.len_alloc;
+   pmeth->key.args[0].svalue.len_used = 0;
 
-   return 0;
-}
+   pmeth->key.args[1].svalue.buf_addr = NULL;
+   pmeth->key.args[1].svalue.len_alloc = 0;
+   pmeth->key.args[1].svalue.len_used = 0;
 
 
-int dbx_cursor_reset(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pcx, int argc_offset, short context)
-{
-   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
-   int n, len, alen, nx, otype;
-   char *p;
-   char global_name[256], buffer[256];
-   DBXSQL *psql;
-   DBC *pbdbcursor;
-   MDB_cursor *plmdbcursor;
-   MDB_txn * plmdbtxnro;
-   v8::Local<v8::Object> obj;
-   v8::Local<v8::String> key;
-   v8::Local<v8::String> value;
-   mcursor *cx = (mcursor *) pcx;
+   return pmeth;
+}
 
-#ifdef _WIN32
-__try {
-#endif
 
-   if (pcon->log_functions && cx && cx->c) {
-      cx->c->LogFunction(cx->c, args, NULL, (char *) "dbx_cursor_reset");
-   }
+int dbx_request_memory_free(DBXCON *pcon, DBXMETH *pmeth, short context)
+{
+   unsigned long long tend;
 
-   if (pmeth->jsargc < 1) {
-      return -1;
+   if (!pmeth) {
+      return CACHE_SUCCESS;
    }
-
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      if (cx->pcursor) {
-         pbdbcursor = (DBC *) cx->pcursor;
-         pbdbcursor->close(pbdbcursor);
+   if (pmeth->trace) { /* v1.3.36 the request is complete */
+      tend = dbx_clock_ns();
+      if (pmeth->tresult) {
+         dbx_trace_span(pmeth, DBX_TRACE_RESULT, pmeth->tresult, tend);
       }
-      n = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pbdbcursor, 0);
-      cx->pcursor = (void *) pbdbcursor;
+      dbx_trace_span(pmeth, DBX_TRACE_REQUEST, pmeth->ttrace, tend);
+      pmeth->trace = 0;
    }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      if (cx->pcursor) {
-         plmdbcursor = (MDB_cursor *) cx->pcursor;
-         plmdbtxnro = (MDB_txn *) cx->ptxnro;
-         pcon->p_lmdb_so->p_mdb_cursor_close(plmdbcursor);
-         lmdb_commit_qro_transaction(pmeth, &(plmdbtxnro), 0);
+   if (pmeth != (DBXMETH *) pcon->pmeth_base) {
+      if (pmeth->key.ibuffer.buf_addr) {
+         dbx_free((void *) pmeth->key.ibuffer.buf_addr, 0);
       }
-      n = lmdb_start_qro_transaction(pmeth, &(plmdbtxnro), 0);
-      n = pcon->p_lmdb_so->p_mdb_cursor_open(plmdbtxnro, pcon->p_lmdb_so->db, &plmdbcursor);
-      cx->ptxnro = (void *) plmdbtxnro;
-      cx->pcursor = (void *) plmdbcursor;
-   }
-
-   obj = DBX_TO_OBJECT(args[argc_offset]);
-   key = dbx_new_string8(isolate, (char *) "sql", 1);
-   if (DBX_GET(obj, key)->IsString()) {
-      value = DBX_TO_STRING(DBX_GET(obj, key));
-      len = (int) dbx_string8_length(isolate, value, 0);
-      psql = (DBXSQL *) dbx_malloc(sizeof(DBXSQL) + (len + 4), 0);
-      for (n = 0; n < DBX_SQL_MAXCOL; n ++) {
-         psql->cols[n] = NULL;
+      if (pmeth->output_val.svalue.buf_addr) {
+         dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
       }
-      psql->no_cols = 0;
-      psql->sql_script = ((char *) psql) + sizeof(DBXSQL);
-      psql->sql_script_len = len;
-      dbx_write_char8(isolate, value, psql->sql_script, len + 2, pcon->utf8);
-
-      psql->sql_type = DBX_SQL_MGSQL;
-      key = dbx_new_string8(isolate, (char *) "type", 1);
-      if (DBX_GET(obj, key)->IsString()) {
-         value = DBX_TO_STRING(DBX_GET(obj, key));
-         dbx_write_char8(isolate, value, buffer, sizeof(buffer), pcon->utf8);
-         dbx_lcase(buffer);
-         psql->sql_type = DBX_SQL_MGSQL;
+      if (pmeth->output_key.svalue.buf_addr) { /* v1.3.10 */
+         dbx_free((void *) pmeth->output_key.svalue.buf_addr, 0);
       }
+      dbx_free((void *) pmeth, 0);
+   }
+   return CACHE_SUCCESS;
+}
 
-      cx->psql = psql;
-      DBX_DB_LOCK(0);
-      psql->sql_no = ++ dbx_sql_counter;
-      DBX_DB_UNLOCK();
-   
-      cx->context = 11;
-      cx->counter = 0;
-      cx->getdata = 0;
-      cx->format = 0;
 
-      if (pmeth->jsargc > (argc_offset + 1)) {
-         dbx_is_object(args[argc_offset + 1], &n);
-         if (n) {
-            obj = DBX_TO_OBJECT(args[argc_offset + 1]);
-            key = dbx_new_string8(isolate, (char *) "format", 1);
-            if (DBX_GET(obj, key)->IsString()) {
-               char buffer[64];
-               value = DBX_TO_STRING(DBX_GET(obj, key));
-               dbx_write_char8(isolate, value, buffer, sizeof(buffer), 1);
-               dbx_lcase(buffer);
-               if (!strcmp(buffer, "url")) {
-                  cx->format = 1;
-               }
-            }
-         }
-      }
-      return 0;
+/* v1.3.9 */
+char * dbx_buffer_resize(char **ppbuffer, unsigned int data_size, unsigned int req_size, unsigned int *size)
+{
+   char *old_buffer;
+
+   old_buffer = NULL;
+   if (*ppbuffer) {
+      old_buffer = *ppbuffer;
    }
 
-   if (!cx->pqr_prev) {
-      cx->pqr_prev = dbx_alloc_dbxqr(NULL, 0, 0);
+   *ppbuffer = (char *) dbx_malloc(req_size, DBX_MEMID_BUFFER);
+   if (!(*ppbuffer)) {
+      return NULL;
    }
-   if (!cx->pqr_next) {
-      cx->pqr_next = dbx_alloc_dbxqr(NULL, 0, 0);
+   if (data_size) {
+      memcpy((void *) *ppbuffer, (void *) old_buffer, (size_t) data_size);
    }
-   if (!cx->data.buf_addr) {
-      cx->data.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, 0);
-      cx->data.len_alloc = CACHE_MAXSTRLEN;
-      cx->data.len_used = 0;
+   if (old_buffer) {
+      dbx_free((void *) old_buffer, 0);
    }
+   *size = req_size;
 
-   cx->pqr_prev->key.ibuffer.len_used = 0;
-   nx = 0;
-   if (pcon->key_type == DBX_KEYTYPE_M) {
-      key = dbx_new_string8(isolate, (char *) "global", 1);
-      if (DBX_GET(obj, key)->IsString()) {
-         dbx_write_char8(isolate, DBX_TO_STRING(DBX_GET(obj, key)), global_name, sizeof(global_name), pcon->utf8);
-      }
-      else {
-         return -1;
-      }
+   return (*ppbuffer);
+}
 
-      if (global_name[0] == '^') {
-         T_STRCPY(cx->global_name, _dbxso(gx->global_name), global_name + 1);
-      }
-      else {
-         T_STRCPY(cx->global_name, _dbxso(gx->global_name), global_name);
-      }
-      dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, cx->global_name, (int) strlen(cx->global_name), 0);
-      nx ++;
 
-      strcpy(cx->pqr_next->global_name.buf_addr, cx->global_name);
-      strcpy(cx->pqr_prev->global_name.buf_addr, cx->global_name);
-      cx->pqr_prev->global_name.len_used = (int) strlen((char *) cx->pqr_prev->global_name.buf_addr);
-      cx->pqr_next->global_name.len_used =  cx->pqr_prev->global_name.len_used;
+#if DBX_NODE_VERSION >= 100000
+void dbx_set_prototype_method(v8::Local<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name, const char* data)
+#else
+void dbx_set_prototype_method(v8::Handle<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name, const char* data)
+#endif
+{
+#if DBX_NODE_VERSION >= 100000
+
+   v8::Isolate* isolate = v8::Isolate::GetCurrent();
+   v8::HandleScope handle_scope(isolate);
+   v8::Local<v8::Signature> s = v8::Signature::New(isolate, t);
+
+#if DBX_NODE_VERSION >= 120000
+   v8::Local<v8::String> data_str = v8::String::NewFromUtf8(isolate, data, NewStringType::kNormal).ToLocalChecked();
+#else
+   v8::Local<v8::String> data_str = v8::String::NewFromUtf8(isolate, data);
+#endif
+
+#if 0
+   v8::Local<v8::FunctionTemplate> tx = v8::FunctionTemplate::New(isolate, callback, v8::Local<v8::Value>(), s);
+#else
+   v8::Local<v8::FunctionTemplate> tx = v8::FunctionTemplate::New(isolate, callback, data_str, s);
+#endif
+
+#if DBX_NODE_VERSION >= 120000
+   v8::Local<v8::String> fn_name = String::NewFromUtf8(isolate, name, NewStringType::kNormal).ToLocalChecked();;
+
+#else
+   v8::Local<v8::String> fn_name = String::NewFromUtf8(isolate, name);
+#endif
+
+   tx->SetClassName(fn_name);
+   t->PrototypeTemplate()->Set(fn_name, tx);
+#else
+   NODE_SET_PROTOTYPE_METHOD(t, name, callback);
+#endif
+
+   return;
+}
+
+
+v8::Local<v8::Object> dbx_is_object(v8::Local<v8::Value> value, int *otype)
+{
+#if DBX_NODE_VERSION >= 100000
+   v8::Isolate* isolate = v8::Isolate::GetCurrent();
+   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
+#endif
+   *otype = 0;
+
+   if (value->IsObject()) {
+      *otype = 1;
+      v8::Local<v8::Object> value_obj = DBX_TO_OBJECT(value);
+      if (node::Buffer::HasInstance(value_obj)) {
+         *otype = 2;
+      }
+      return value_obj;
    }
    else {
-      cx->pqr_prev->global_name.len_used = 0;
-      cx->pqr_next->global_name.len_used = 0;
+      return v8::Local<v8::Object>::Cast(value);
    }
+}
 
-   cx->pqr_prev->key.argc = nx;
 
-   key = dbx_new_string8(isolate, (char *) "key", 1);
-   if (DBX_GET(obj, key)->IsArray()) {
-      Local<Array> a = Local<Array>::Cast(DBX_GET(obj, key));
-      alen = (int) a->Length();
+int dbx_string8_length(v8::Isolate * isolate, v8::Local<v8::String> str, int utf8)
+{
+   if (utf8) {
+      return DBX_UTF8_LENGTH(str);
+   }
+   else {
+      return DBX_LENGTH(str);
+   }
+}
 
-      for (n = 0; n < alen; n ++) {
-         if (DBX_GET(a, n)->IsInt32()) {
-            cx->pqr_prev->key.args[nx].type = DBX_DTYPE_INT;
-            cx->pqr_prev->key.args[nx].num.int32 = (int) DBX_INT32_VALUE(DBX_GET(a, n));
-            T_SPRINTF(buffer, _dbxso(buffer), "%d", pmeth->key.args[nx].num.int32);
-            dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, buffer, (int) strlen(buffer), 0);
-         }
-         else {
-            cx->pqr_prev->key.args[nx].type = DBX_DTYPE_STR;
-            obj = dbx_is_object(DBX_GET(a, n), &otype);
 
-            if (otype == 2) {
-               p = node::Buffer::Data(obj);
-               len = (int) node::Buffer::Length(obj);
-               dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, p, (int) len, 0);
-            }
-            else {
-               value = DBX_TO_STRING(DBX_GET(a, n));
-               dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, NULL, 0, 0);
-            }
-         }
-         nx ++;
-      }
+/* v1.3.19 space needed to write str without measuring it first: exact for the ASCII character set, an upper bound for UTF-8 */
+int dbx_string8_bound(v8::Isolate * isolate, v8::Local<v8::String> str, int utf8)
+{
+   int len;
+
+   len = DBX_LENGTH(str);
+   if (utf8) {
+      /* one-byte (Latin-1) strings need at most 2 bytes per character, others at most 3 per UTF-16 unit */
+      len *= (str->IsOneByte() ? 2 : 3);
    }
+   return len;
+}
 
-   cx->pqr_prev->key.argc = nx;
 
-   cx->fixed_key_len = cx->pqr_prev->key.ibuffer.len_used;
-   cx->context = 1;
-   cx->counter = 0;
-   cx->getdata = 0;
-   cx->format = 0;
+/* v1.3.19 */
+int dbx_is_ascii(char * buffer, unsigned long len)
+{
+   unsigned long n;
+   uint64_t w;
 
-   if (pmeth->jsargc > (argc_offset + 1)) {
-      obj = DBX_TO_OBJECT(args[argc_offset + 1]);
-      key = dbx_new_string8(isolate, (char *) "getdata", 1);
-      if (DBX_GET(obj, key)->IsBoolean()) {
-         if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
-            cx->getdata = 1;
-         }
-      }
-      key = dbx_new_string8(isolate, (char *) "multilevel", 1);
-      if (DBX_GET(obj, key)->IsBoolean()) {
-         if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
-            cx->context = 2;
-         }
-      }
-      key = dbx_new_string8(isolate, (char *) "globaldirectory", 1);
-      if (DBX_GET(obj, key)->IsBoolean()) {
-         if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
-            cx->context = 9;
-         }
+   n = 0;
+   for (; (n + 8) <= len; n += 8) {
+      memcpy((void *) &w, (void *) (buffer + n), 8);
+      if (w & 0x8080808080808080ULL) {
+         return 0;
       }
-      key = dbx_new_string8(isolate, (char *) "format", 1);
-      if (DBX_GET(obj, key)->IsString()) {
-         char buffer[64];
-         value = DBX_TO_STRING(DBX_GET(obj, key));
-         dbx_write_char8(isolate, value, buffer, sizeof(buffer), 1);
-         dbx_lcase(buffer);
-         if (!strcmp(buffer, "url")) {
-            cx->format = 1;
-         }
+   }
+   for (; n < len; n ++) {
+      if (((unsigned char) buffer[n]) & 0x80) {
+         return 0;
       }
    }
+   return 1;
+}
 
-   if (pcon->key_type == DBX_KEYTYPE_M) {
-      if (cx->context != 9 && cx->global_name[0] == '\0') { /* not a global directory so global name cannot be empty */
-         return -1;
-      }
+v8::Local<v8::String> dbx_new_string8(v8::Isolate * isolate, char * buffer, int utf8)
+{
+   if (utf8) {
+#if DBX_NODE_VERSION >= 120000
+      return v8::String::NewFromUtf8(isolate, buffer, NewStringType::kNormal).ToLocalChecked();
+#else
+      return v8::String::NewFromUtf8(isolate, buffer);
+#endif
    }
    else {
-      cx->context = 2; /* one key so set multilevel context */
+#if DBX_NODE_VERSION >= 100000
+      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, NewStringType::kInternalized).ToLocalChecked();
+#else
+      /* return String::NewFromOneByte(isolate, (uint8_t *) buffer, String::kNormalString); */
+      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, v8::NewStringType::kInternalized).ToLocalChecked();
+#endif
    }
+}
 
-   return 0;
 
-#ifdef _WIN32
+v8::Local<v8::String> dbx_new_string8n(v8::Isolate * isolate, char * buffer, unsigned long len, int utf8)
+{
+   if (utf8 && dbx_is_ascii(buffer, len)) { /* v1.3.19 ASCII is valid UTF-8 so no decoding is needed */
+#if DBX_NODE_VERSION >= 100000
+      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, NewStringType::kNormal, (int) len).ToLocalChecked();
+#else
+      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, v8::NewStringType::kNormal, (int) len).ToLocalChecked();
+#endif
+   }
+   if (utf8) {
+#if DBX_NODE_VERSION >= 120000
+      return v8::String::NewFromUtf8(isolate, buffer, NewStringType::kNormal, len).ToLocalChecked();
+#else
+      return v8::String::NewFromUtf8(isolate, buffer, String::kNormalString, len);
+#endif
+   }
+   else {
+#if DBX_NODE_VERSION >= 100000
+      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, NewStringType::kInternalized, len).ToLocalChecked();
+#else
+      /* return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, String::kNormalString, len); */
+      return v8::String::NewFromOneByte(isolate, (uint8_t *) buffer, v8::NewStringType::kInternalized, len).ToLocalChecked();
+#endif
+
+   }
 }
-__except (EXCEPTION_EXECUTE_HANDLER) {
 
-   DWORD code;
-   char bufferx[256];
 
-   __try {
-      code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_cursor_reset: %x", code);
-      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
-   }
-   __except (EXCEPTION_EXECUTE_HANDLER) {
-      ;
+/* v1.3.24 Return a stored value: typed values are returned as JavaScript numbers and booleans */
+v8::Local<v8::Value> dbx_new_value8n(v8::Isolate * isolate, DBXCON *pcon, char * buffer, unsigned long len, int utf8)
+{
+   DBXVAL val;
+
+   if (pcon->typed_values && len <= DBX_TVALUE_MAX_SIZE) {
+      switch (dbx_tvalue_decode(buffer, (size_t) len, &val)) {
+         case DBX_DTYPE_INT64:
+            return DBX_NUMBER_NEW((double) val.num.int64);
+         case DBX_DTYPE_DOUBLE:
+            return DBX_NUMBER_NEW(val.num.real);
+         case DBX_DTYPE_BOOL:
+            return DBX_BOOLEAN_NEW(val.num.int32 ? true : false);
+         default:
+            break;
+      }
    }
+   return dbx_new_string8n(isolate, buffer, len, utf8);
+}
 
-   return 0;
+
+/* v1.3.27 Return the data held by a cursor: a value that was escaped (DBX_DTYPE_STR8) is never read as a typed value */
+v8::Local<v8::Value> dbx_new_data8n(v8::Isolate * isolate, DBXCON *pcon, DBXVAL *pval, int utf8)
+{
+   if (pval->type == DBX_DTYPE_STR8) {
+      return dbx_new_string8n(isolate, pval->svalue.buf_addr, pval->svalue.len_used, utf8);
+   }
+   return dbx_new_value8n(isolate, pcon, pval->svalue.buf_addr, pval->svalue.len_used, utf8);
 }
+
+
+int dbx_write_char8(v8::Isolate * isolate, v8::Local<v8::String> str, char * buffer, int buffer_size, int utf8)
+{
+   /* v1.3.14 */
+   if (utf8) {
+      return DBX_WRITE_UTF8(str, buffer, buffer_size);
+   }
+   else {
+#if DBX_NODE_VERSION >= 240000
+      DBX_WRITE_ONE_BYTE(str, (uint8_t *) buffer);
+      return 0;
+#else
+      return DBX_WRITE_ONE_BYTE(str, (uint8_t *) buffer);
 #endif
+   }
 }
 
 
-int bdb_load_library(DBXCON *pcon)
+/* v1.3.19 make room for len more bytes in the input buffer */
+int dbx_ibuffer_resize(DBXKEY *pkey, int len)
 {
-   int result;
-   char primerr[DBX_ERROR_SIZE];
-   char fun[64];
+   int n;
+   unsigned char *p;
 
-   strcpy(pcon->p_bdb_so->libdir, pcon->db_library);
-   strcpy(pcon->p_bdb_so->funprfx, "db");
-   strcpy(pcon->p_bdb_so->dbname, "BDB");
+   /* 1.4.11 resize input buffer if necessary */
 
-   strcpy(pcon->p_bdb_so->libnam, pcon->p_bdb_so->libdir);
+   if ((pkey->ibuffer.len_used + len + 32) > pkey->ibuffer.len_alloc) {
 
-   pcon->p_bdb_so->p_library = dbx_dso_load(pcon->p_bdb_so->libnam);
-   if (!pcon->p_bdb_so->p_library) {
-      int len1, len2;
-      char *p;
-#if defined(_WIN32)
-      DWORD errorcode;
-      LPVOID lpMsgBuf;
-
-      lpMsgBuf = NULL;
-      errorcode = GetLastError();
-      sprintf(pcon->error, "Error loading %s Library: %s; Error Code : %ld",  pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, errorcode);
-      len2 = (int) strlen(pcon->error);
-      len1 = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-                     NULL,
-                     errorcode,
-                     /* MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), */
-                     MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
-                     (LPTSTR) &lpMsgBuf,
-                     0,
-                     NULL 
-                     );
-      if (lpMsgBuf && len1 > 0 && (DBX_ERROR_SIZE - len2) > 30) {
-         strncpy(primerr, (const char *) lpMsgBuf, DBX_ERROR_SIZE - 1);
-         p = strstr(primerr, "\r\n");
-         if (p)
-            *p = '\0';
-         len1 = (DBX_ERROR_SIZE - (len2 + 10));
-         if (len1 < 1)
-            len1 = 0;
-         primerr[len1] = '\0';
-         p = strstr(primerr, "%1");
-         if (p) {
-            *p = 'I';
-            *(p + 1) = 't';
+      p = (unsigned char *) dbx_malloc(sizeof(char) * (pkey->ibuffer.len_used + len + CACHE_MAXSTRLEN), DBX_MEMID_KEY);
+      if (p) {
+         if (pkey->ibuffer.buf_addr && pkey->ibuffer.len_used > 0) { 
+            memcpy((void *) p, (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
+            dbx_free((void *) pkey->ibuffer.buf_addr, DBX_MEMID_KEY);
+         }
+         pkey->ibuffer.buf_addr = (char *) p;
+         pkey->ibuffer.len_alloc = (pkey->ibuffer.len_used + len + CACHE_MAXSTRLEN);
+         pkey->args[0].svalue.buf_addr = (char *) pkey->ibuffer.buf_addr;
+         for (n = 1; n < pkey->argc; n ++) {
+            pkey->args[n].svalue.buf_addr = (char *) (pkey->ibuffer.buf_addr + pkey->args[n - 1].csize);
          }
-         strcat(pcon->error, " (");
-         strcat(pcon->error, primerr);
-         strcat(pcon->error, ")");
       }
-      if (lpMsgBuf)
-         LocalFree(lpMsgBuf);
-#else
-      p = (char *) dlerror();
-      sprintf(primerr, "Cannot load %s library: Error Code: %d", pcon->p_bdb_so->dbname, errno);
-      len2 = strlen(pcon->error);
-      if (p) {
-         strncpy(primerr, p, DBX_ERROR_SIZE - 1);
-         primerr[DBX_ERROR_SIZE - 1] = '\0';
-         len1 = (DBX_ERROR_SIZE - (len2 + 10));
-         if (len1 < 1)
-            len1 = 0;
-         primerr[len1] = '\0';
-         strcat(pcon->error, " (");
-         strcat(pcon->error, primerr);
-         strcat(pcon->error, ")");
+      else {
+         return 0;
       }
-#endif
-      goto bdb_load_library_exit;
-   }
-/*
-   int               (* p_db_create)                 (DB **pdb, DB_ENV *dbenv, u_int32_t flags);
-   char *            (* p_db_full_version)           (int *family, int *release, int *major, int *minor, int *patch);
-*/
-
-   sprintf(fun, "%s_create", pcon->p_bdb_so->funprfx);
-   pcon->p_bdb_so->p_db_create = (int (*) (DB **, DB_ENV *, u_int32_t)) dbx_dso_sym(pcon->p_bdb_so->p_library, (char *) fun);
-   if (!pcon->p_bdb_so->p_db_create) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, fun);
-      goto bdb_load_library_exit;
-   }
-   sprintf(fun, "%s_env_create", pcon->p_bdb_so->funprfx);
-   pcon->p_bdb_so->p_db_env_create = (int (*) (DB_ENV **, u_int32_t)) dbx_dso_sym(pcon->p_bdb_so->p_library, (char *) fun);
-   if (!pcon->p_bdb_so->p_db_env_create) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, fun);
-      goto bdb_load_library_exit;
-   }
-   sprintf(fun, "%s_full_version", pcon->p_bdb_so->funprfx);
-   pcon->p_bdb_so->p_db_full_version = (char * (*) (int *, int *, int *, int *, int *)) dbx_dso_sym(pcon->p_bdb_so->p_library, (char *) fun);
-   if (!pcon->p_bdb_so->p_db_full_version) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, fun);
-      goto bdb_load_library_exit;
-   }
-
-   pcon->p_bdb_so->loaded = 1;
-
-bdb_load_library_exit:
-
-   if (pcon->error[0]) {
-      pcon->p_bdb_so->loaded = 0;
-      pcon->error_code = 1009;
-      result = CACHE_NOCON;
-
-      return result;
    }
 
-   return CACHE_SUCCESS;
+   return 1;
 }
 
 
-int bdb_open(DBXMETH *pmeth)
+int dbx_ibuffer_add(DBXMETH *pmeth, DBXKEY *pkey, v8::Isolate * isolate, int argn, v8::Local<v8::String> str, char * buffer, int buffer_len, short context)
 {
-   int rc, result;
-   u_int32_t db_flags; /* database open flags */
-   u_int32_t env_flags; /* database environment flags */
-   char *pver;
+   int len, n, onebyte;
+   unsigned char *p;
+   char nstr[64];
    DBXCON *pcon = pmeth->pcon;
 
-   rc = 0;
-   if (!pcon->p_bdb_so) {
-      pcon->p_bdb_so = (DBXBDBSO *) dbx_malloc(sizeof(DBXBDBSO), 0);
-      if (!pcon->p_bdb_so) {
-         T_STRCPY(pcon->error, _dbxso(pcon->error), "No Memory");
-         pcon->error_code = 1009; 
-         result = CACHE_NOCON;
-         return result;
+#ifdef _WIN32
+__try {
+#endif
+
+   onebyte = 0;
+   if (buffer) {
+      len = buffer_len;
+   }
+   else { /* v1.3.19 size from the string's length and write it in a single pass */
+      len = dbx_string8_bound(isolate, str, pcon->utf8);
+      onebyte = (pcon->utf8 && str->IsOneByte()); /* v1.3.19 */
+      if (pcon->utf8 && (pkey->ibuffer.len_used + len + 32) > pkey->ibuffer.len_alloc) {
+         /* large value: measure it rather than over-allocate (a one-byte string is sized as ASCII and resized below if it is not) */
+         len = (onebyte ? DBX_LENGTH(str) : dbx_string8_length(isolate, str, pcon->utf8));
       }
-      memset((void *) pcon->p_bdb_so, 0, sizeof(DBXBDBSO));
-      pcon->p_bdb_so->pdb = NULL;
-      pcon->p_bdb_so->penv = NULL;
-      pcon->p_bdb_so->loaded = 0;
-      pcon->p_bdb_so->no_connections = 0;
-      pcon->p_bdb_so->multiple_connections = 0;
-      pcon->p_zv = &(pcon->p_bdb_so->zv);
    }
 
-   if (pcon->p_bdb_so->loaded == 2) {
-      /* Already connected */
-      strcpy((char *) pmeth->output_val.svalue.buf_addr, "0");
-      goto bdb_open_exit;
+   if (!dbx_ibuffer_resize(pkey, len)) {
+      return 0;
    }
 
-   if (!pcon->p_bdb_so->loaded) {
-      rc = bdb_load_library(pcon);
-      if (rc != CACHE_SUCCESS) {
-         goto bdb_open_exit;
+   p = (unsigned char *) (pkey->ibuffer.buf_addr + pkey->ibuffer.len_used);
+
+   if (pmeth->pcon->key_type == DBX_KEYTYPE_M) {
+      if (pkey->args[argn].type == DBX_DTYPE_INT) {
+         dbx_set_number(&(pkey->args[argn]), p);
+         p += 10;
+         pkey->ibuffer.len_used += 10;
+      }
+      else {
+         *(p ++) = 0x00;
+         *(p ++) = 0x03;
+         pkey->ibuffer.len_used += 2;
       }
    }
 
-   pver = pcon->p_bdb_so->p_db_full_version(&(pcon->p_zv->family), &(pcon->p_zv->release), &(pcon->p_zv->majorversion), &(pcon->p_zv->minorversion), &(pcon->p_zv->patch));
-
-   pcon->p_zv->dbtype = (unsigned char) pcon->dbtype;
-/*
-   printf("\r\n pver=%s; pcon->p_zv->release=%d; pcon->p_zv->majorversion=%d; pcon->p_zv->minorversion=%d;", pver, pcon->p_zv->release, pcon->p_zv->majorversion, pcon->p_zv->minorversion);
-*/
-   if (pver) {
-      rc = CACHE_SUCCESS;
-      strcpy(pcon->p_zv->db_version, pver);
-      bdb_parse_zv(pcon->p_zv->db_version, pcon->p_zv);
-      if (pcon->p_zv->dbx_build)
-         sprintf(pcon->p_zv->version, "%d.%d.b%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion, pcon->p_zv->dbx_build);
-      else
-         sprintf(pcon->p_zv->version, "%d.%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion);
+   if (buffer) {
+      T_MEMCPY((void *) p, (void *) buffer, (size_t) len);
    }
    else {
-      rc = CACHE_FAILURE;
+      if (onebyte) { /* v1.3.19 copy the characters as they are: an ASCII string is already UTF-8 so needs no encoding or length pass */
+         dbx_write_char8(isolate, str, (char *) p, pkey->ibuffer.len_alloc - pkey->ibuffer.len_used, 0);
+         if (dbx_is_ascii((char *) p, (unsigned long) DBX_LENGTH(str))) {
+            len = DBX_LENGTH(str);
+         }
+         else { /* Latin-1 characters above 0x7F take 2 bytes in UTF-8 */
+            onebyte = 0;
+            if (!dbx_ibuffer_resize(pkey, DBX_LENGTH(str) * 2)) {
+               return 0;
+            }
+            p = (unsigned char *) (pkey->ibuffer.buf_addr + pkey->ibuffer.len_used);
+         }
+      }
+      if (!onebyte) {
+         n = dbx_write_char8(isolate, str, (char *) p, pkey->ibuffer.len_alloc - pkey->ibuffer.len_used, pcon->utf8);
+         if (pcon->utf8) { /* v1.3.19 bytes written, including the null terminator */
+            len = (n > 0) ? (n - 1) : 0;
+         }
+      }
    }
+   pkey->ibuffer.len_used += len;
 
-   /* v1.1.4 */
-   pcon->p_bdb_so->penv = NULL;
-   if (pcon->env_dir[0]) {
-      rc = pcon->p_bdb_so->p_db_env_create(&(pcon->p_bdb_so->penv), 0);
+   pkey->args[argn].svalue.buf_addr = (char *) p;
+   pkey->args[argn].svalue.len_alloc = len;
+   pkey->args[argn].svalue.len_used = len;
+   pkey->args[argn].csize = pkey->ibuffer.len_used;
+   pkey->argc = argn;
 
-      if (rc != 0) {
-         /* Error handling goes here */
-         strcpy(pcon->error, "Cannot create a BDB environment object");
-         goto bdb_open_exit;
-      }
+   if (pmeth->pcon->key_type == DBX_KEYTYPE_M) {
+      if (pkey->args[argn].type == DBX_DTYPE_STR && dbx_is_number(&(pkey->args[argn]))) { /* See if we have a stringified number */
 
-      /* Open the environment. */
-      env_flags = DB_CREATE | DB_INIT_CDB| DB_INIT_MPOOL; /* Initialize the in-memory cache. */
+         for (n = (len - 1); n >= 0; n --) {
+            p[n + 8] = p[n];
+         }
 
-      rc = pcon->p_bdb_so->penv->open(pcon->p_bdb_so->penv, pcon->env_dir, env_flags, 0);
+         dbx_set_number(&(pkey->args[argn]), p - 2);
+         p += 8;
+         pkey->ibuffer.len_used += 8;
+         pkey->args[argn].svalue.buf_addr = (char *) p;
+         pkey->args[argn].csize = pkey->ibuffer.len_used;
+         /* dbx_dump_key((char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used); */
+      }
 
-      if (rc != 0) {
-         /* Error handling goes here */
-         strcpy(pcon->error, "Cannot create or open a BDB environment");
-         goto bdb_open_exit;
+      if (argn == 0 && p[0] == '^') {
+         for (n = 1; n < len; n ++) {
+            p[n - 1] = p[n];
+         }
+         len --;
+         p[len] = '\0';
+         pkey->args[argn].svalue.len_alloc = len;
+         pkey->args[argn].svalue.len_used = len;
+         pkey->ibuffer.len_used --;
+         pkey->args[argn].csize = pkey->ibuffer.len_used;
+      }
+      if (pkey->args[argn].svalue.len_used == 0) { /* null - so introducing sequence must be \x00\x00 */
+         pkey->ibuffer.buf_addr[pkey->ibuffer.len_used - 1] = 0x00;
       }
    }
-
-   rc = pcon->p_bdb_so->p_db_create(&(pcon->p_bdb_so->pdb), pcon->p_bdb_so->penv, 0);
-
-   if (rc != 0) {
-      /* Error handling goes here */
-      strcpy(pcon->error, "Cannot create a BDB object");
-      goto bdb_open_exit;
+   else { /* v1.0.2 */
+      if (pkey->args[argn].type == DBX_DTYPE_STR && dbx_is_number(&pkey->args[argn])) { /* See if we have a stringified number */
+         strncpy(nstr, pkey->args[argn].svalue.buf_addr, pkey->args[argn].svalue.len_used);
+         nstr[pkey->args[argn].svalue.len_used] = '\0';
+         pkey->args[argn].num.int32 = (int) strtol(nstr, NULL, 10);
+      }
    }
 
-   /* Database open flags */
-   db_flags = DB_CREATE; /* If the database does not exist, create it.*/
-   /* open the database */
-   rc = pcon->p_bdb_so->pdb->open(pcon->p_bdb_so->pdb, /* DB structure pointer */
-      NULL, /* Transaction pointer */
-      pcon->db_file, /* On-disk file that holds the database. */
-      NULL, /* Optional logical database name */
-      DB_BTREE, /* Database access method */
-      db_flags, /* Open flags */
-      0); /* File mode (using defaults) */
-
-   if (rc != 0) {
-      /* Error handling goes here */
-      strcpy(pcon->error, "Cannot create or open a BDB database");
-      goto bdb_open_exit;
-   }
+   return len;
 
-bdb_open_exit:
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
 
-   if (rc == CACHE_SUCCESS) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_ibuffer_add: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
-   else {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) pcon->error, DBX_DTYPE_STR8);
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
    }
 
-   return rc;
+   return 0;
+}
+#endif
 }
 
 
-int bdb_parse_zv(char *zv, DBXZV * p_bdb_sv)
+int dbx_is_number(DBXVAL *pval)
 {
-   char *p;
+   int neg, dp, num;
+   unsigned int n;
+   char buffer[64];
 
-   p_bdb_sv->dbx_build = p_bdb_sv->patch;
-   p_bdb_sv->vnumber = 0;
+   if (pval->svalue.len_used == 0 || pval->svalue.len_used > 32) {
+      return 0;
+   }
 
-   if (p_bdb_sv->majorversion == 0 || p_bdb_sv->minorversion == 0) {
-      p = strstr(zv, "version ");
-      if (!p) {
-         p = strstr(zv, "Release ");
+   neg = 0;
+   if (pval->svalue.buf_addr[0] == '-')
+      neg = 1;
+
+   dp = 0;
+   num = 1;
+   for (n = neg; n < pval->svalue.len_used; n ++) {
+      if (pval->svalue.buf_addr[n] == '.' && dp == 0) {
+         dp = 1;
+         continue;
       }
-      if (p) {
-         p += 8;
-         p_bdb_sv->majorversion = (int) strtol(p, NULL, 10);
-         p = strstr(p, ".");
-         if (p) {
-            p ++;
-            p_bdb_sv->minorversion = (int) strtol(p, NULL, 10);
-            p = strstr(p, ".");
-            if (p) {
-               p ++;
-               p_bdb_sv->dbx_build = (int) strtol(p, NULL, 10);
-            }
-         }
+      if ((int) pval->svalue.buf_addr[n] < 48 || (int) pval->svalue.buf_addr[n] > 57) {
+         num = 0;
+         break;
       }
    }
 
-   p_bdb_sv->vnumber = ((p_bdb_sv->majorversion * 100000) + (p_bdb_sv->minorversion * 10000) + p_bdb_sv->dbx_build);
-   
-   return CACHE_SUCCESS;
+   if (num && !dp) { /* convert to integer if possible */
+      strncpy(buffer, pval->svalue.buf_addr, pval->svalue.len_used);
+      buffer[pval->svalue.len_used] = '\0';
+      pval->num.int32 = (int) strtol(buffer, NULL, 10);
+      pval->type = DBX_DTYPE_INT;
+   }
+   return num;
 }
 
 
-int bdb_next(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
-{
-   int rc, n, mkeyn, fixed_comp;
-   DBXCON *pcon = pmeth->pcon;
-   DBT key, key0, data;
-   DBC *pcursor;
-   DBXVAL mkeys[DBX_MAXARGS];
 
-/*
-   printf("\r\n ******* bdb_next ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p;\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr);
-*/
-   memset(&key, 0, sizeof(DBT));
-   memset(&key0, 0, sizeof(DBT));
-   memset(&data, 0, sizeof(DBT));
-   key.flags = DB_DBT_USERMEM;
-   key0.flags = DB_DBT_USERMEM;
-   data.flags = DB_DBT_USERMEM;
+int dbx_set_number(DBXVAL *pval, unsigned char *px)
+{
+   int num, dec;
+   unsigned char *p;
+   char buffer[128], decstr[64];
 
-   if (context == 0) {
-      rc = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pcursor, 0);
+   dec = 0;
+   if (pval->type == DBX_DTYPE_INT) {
+      num = pval->num.int32;
    }
    else {
-     pcursor = pmeth->pbdbcursor;
-   }
-
-   if (pcon->key_type == DBX_KEYTYPE_INT) {
-      key0.data = &(pkey->args[0].num.int32);
-      key0.size = sizeof(pkey->args[0].num.int32);
-      key0.ulen = sizeof(pkey->args[0].num.int32);
-
-      pkeyval->num.int32 = pkey->args[0].num.int32;
-      key.data = &(pkeyval->num.int32);
-      key.size = sizeof(pkeyval->num.int32);
-      key.ulen = sizeof(pkeyval->num.int32);
-      if (pkey->args[0].svalue.len_used == 0) {
-         key.size = 0;
-         key0.size = 0;
+      strncpy(buffer, pval->svalue.buf_addr, pval->svalue.len_used);
+      buffer[pval->svalue.len_used] = '\0';
+      p = (unsigned char *) strstr(buffer, ".");
+      if (p) {
+         *(p ++) = '\0';
+         sprintf(decstr, "%s", p);
+         strcat(decstr, "000000000");
+         decstr[9] = '\0';
+         dec = (int) strtol(decstr, NULL, 10);
       }
+      num = (int) strtol(buffer, NULL, 10);
    }
-   else if (pcon->key_type == DBX_KEYTYPE_STR) {
-      key0.data = pkey->args[0].svalue.buf_addr;
-      key0.size = pkey->args[0].svalue.len_used;
-      key0.ulen = pkey->args[0].svalue.len_alloc;
 
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
-      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
-      key.data = (void *) pkeyval->svalue.buf_addr;
-      key.size = (u_int32_t) pkeyval->svalue.len_used;
-      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+   if (num < 0) {
+      num *= -1;
+      *(px ++) = 0x00;
+      *(px ++) = 0x01;
+      dbx_set_size((unsigned char *) px, 0xffffffff - (unsigned long) num, 1);
+      px += 4;
+      dbx_set_size((unsigned char *) px, 0xffffffff - (unsigned long) dec, 1);
+      px += 4;
    }
-   else { /* mumps */
-      key0.data = (void *) pkey->ibuffer.buf_addr;
-      key0.size = (u_int32_t) pkey->ibuffer.len_used;
-      key0.ulen = (u_int32_t) pkey->ibuffer.len_alloc;
-
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
-      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
-      key.data = (void *) pkeyval->svalue.buf_addr;
-      key.size = (u_int32_t) pkeyval->svalue.len_used;
-      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+   else {
+      *(px ++) = 0x00;
+      *(px ++) = 0x02;
+      dbx_set_size((unsigned char *) px, (unsigned long) num, 1);
+      px += 4;
+      dbx_set_size((unsigned char *) px, (unsigned long) dec, 1);
+      px += 4;
    }
+   return 0;
+}
 
-   data.data = (void *) pdataval->svalue.buf_addr;
-   data.ulen = (u_int32_t) pdataval->svalue.len_alloc;
 
-   rc = YDB_NODE_END;
-   if (pcon->key_type == DBX_KEYTYPE_M) {
-/*
-      printf("\r\nstarting from ...");
-      dbx_dump_key((char *) key0.data, (int) key0.size);
-*/
-      pkeyval->svalue.len_used = 0;
-      fixed_comp = 0;
+int dbx_split_key(DBXVAL *keys, char * key, int key_len)
+{
+   int n, keyn, nstart, nend;
 
-      for (n = 0; n < 10; n ++) {
-/*
-         printf("\r\nDB_SET_RANGE (seed): fixed_comp=%d; pkey->argc=%d; key.size=%d", fixed_comp, pkey->argc, key.size);
-         dbx_dump_key((char *) key.data, (int) key.size);
-*/
-         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
-         if (rc != CACHE_SUCCESS) {
-            rc = YDB_NODE_END;
-            break;
-         }
-/*
-         printf("\r\nDB_SET_RANGE: rc=%d; pkey->argc=%d; key.size=%d", rc, pkey->argc, key.size);
-         dbx_dump_key((char *) key.data, (int) key.size);
-*/
-         if (rc != CACHE_SUCCESS) {
-            rc = YDB_NODE_END;
-            break;
+   nstart = 0;
+   nend = 0;
+   keyn = 0;
+   n = 0;
+   while (n < key_len) {
+      if (key[n] == 0x00 && (key[n + 1] == 0x01 || key[n + 1] == 0x02)) { /* number */
+        nend = n;
+         if (keyn > 0) {
+            keys[keyn - 1].svalue.len_used = (nend - nstart);
+            keys[keyn - 1].svalue.len_alloc = keys[keyn - 1].svalue.len_used;
+            keys[keyn - 1].csize = nend;
          }
-         if (*((unsigned char *) key.data) != 0x00) {
-            rc = YDB_NODE_END;
-            break;
+         nstart = n + 10;
+         keys[keyn].svalue.buf_addr = key + nstart;
+         keys[keyn].num.int32 = (int) strtol(keys[keyn].svalue.buf_addr, NULL, 10);
+         keys[keyn].type = DBX_DTYPE_INT;
+         keyn ++;
+         n += 10;
+      }
+      else if (key[n] == 0x00 && key[n + 1] == 0x03) { /* string */
+         nend = n;
+         if (keyn > 0) {
+            keys[keyn - 1].svalue.len_used = (nend - nstart);
+            keys[keyn - 1].svalue.len_alloc = keys[keyn - 1].svalue.len_used;
+            keys[keyn - 1].csize = nend;
          }
+         nstart = n + 2;
+         keys[keyn].svalue.buf_addr = key + nstart;
+         keys[keyn].type = DBX_DTYPE_STR;
+         keyn ++;
+         n += 2;
+      }
+      n ++;
+   }
+   if (keyn > 0) {
+      keys[keyn - 1].svalue.len_used = (key_len - nstart);
+      keys[keyn - 1].svalue.len_alloc = keys[keyn - 1].svalue.len_used;
+      keys[keyn - 1].csize = key_len;
+   }
 
-         /* dbx_dump_key((char *) key.data, (int) key.size); */
+   for (n = 0; n < keyn; n ++) {
+      if (keys[n].type == DBX_DTYPE_INT) {  /* v1.3.11 was keys[keyn].type == DBX_DTYPE_INT */
+         /* v1.3.17 scan the value in place */
+         if (memchr((void *) keys[n].svalue.buf_addr, '.', (size_t) keys[n].svalue.len_used)) {
+            keys[n].type = DBX_DTYPE_STR;
+         }
+      }
+   }
 
-         if (pkey->argc < 2)
-            fixed_comp = 0;
-         else
-            fixed_comp = bdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+   return keyn;
+}
 
-         if (!fixed_comp) {
-            mkeyn = dbx_split_key(&mkeys[0], (char *) key.data, (int) key.size);
-/*
-            printf("\r\nNext Record: pkey->argc=%d mkeyn=%d csize=%d; lens=%d:%d %s", pkey->argc, mkeyn, pkey->args[pkey->argc - 1].csize, pkey->args[pkey->argc - 1].svalue.len_used, mkeys[pkey->argc - 1].svalue.len_used, mkeys[pkey->argc - 1].svalue.buf_addr);
-*/
 
-            if (mkeyn != pkey->argc) { /* can't use data as it's under lower subscripts */
-               data.size = 0;
-            }
+/* v1.3.17 locate (but do not decode) the subscript whose introducing sequence starts at offset */
+/* returns -1 if there is no subscript at offset, 0 if it is the last subscript, 1 if further subscripts follow */
+int dbx_key_subscript(DBXVAL *pval, char * key, int key_len, int offset)
+{
+   int n, nstart;
+   char *p;
 
-            if (mkeyn >= pkey->argc) {
-               if (pkey->args[pkey->argc - 1].svalue.len_used == mkeys[pkey->argc - 1].svalue.len_used && !strncmp(pkey->args[pkey->argc - 1].svalue.buf_addr, mkeys[pkey->argc - 1].svalue.buf_addr, pkey->args[pkey->argc - 1].svalue.len_used)) {
-                  /* current key returned - get next */
-                  *(((unsigned char *) key.data) + pkey->args[pkey->argc - 1].csize + 0) = 0x00;
-                  *(((unsigned char *) key.data) + pkey->args[pkey->argc - 1].csize + 1) = 0xff;
+   if (offset < 0 || (offset + 1) >= key_len || key[offset] != 0x00) {
+      return -1;
+   }
+   if (key[offset + 1] == 0x01 || key[offset + 1] == 0x02) { /* number */
+      pval->type = DBX_DTYPE_INT;
+      nstart = offset + 10;
+   }
+   else { /* string */
+      pval->type = DBX_DTYPE_STR;
+      nstart = offset + 2;
+   }
+   if (nstart > key_len) {
+      return -1;
+   }
 
-                  key.size = (pkey->args[pkey->argc - 1].csize + 2);
-/*
-                  printf("\r\nAdvance Cursor: pkey->argc=%d; key.size=%d", pkey->argc, key.size);
-                  dbx_dump_key((char *) key.data, (int) key.size);
-*/
-                  continue;
-               }
-               else {
-                  /* next key found */
-                  if (context == 0) {
-                     dbx_memcpy_ex(&(pkeyval->svalue), (void *) mkeys[pkey->argc - 1].svalue.buf_addr, (size_t) mkeys[pkey->argc - 1].svalue.len_used);
-                  }
-                  else {
-                     dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.data, (size_t) mkeys[pkey->argc - 1].csize);
-                     pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
-                     dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
-                  }
-                  pdataval->svalue.len_used = (unsigned int) data.size;
-                  break;
-               }
-            }
-         }
-         else {
-            rc = YDB_NODE_END;
-            break;
-         }
+   /* same boundary rules as dbx_split_key(): the first byte of a value cannot start a new subscript */
+   n = key_len;
+   for (p = key + nstart + 1; p < (key + key_len - 1); p ++) {
+      p = (char *) memchr((void *) p, 0x00, (size_t) ((key + key_len - 1) - p));
+      if (!p) {
+         break;
+      }
+      if (p[1] == 0x01 || p[1] == 0x02 || p[1] == 0x03) {
+         n = (int) (p - key);
+         break;
       }
    }
-   else { /* not mumps */
-/*
-      printf("\r\nstarting from ...");
-      dbx_dump_key((char *) key.data, (int) key.size);
-*/
 
-      if (key.size == 0) {
-         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_FIRST); /* v1.3.9 */
+   pval->svalue.buf_addr = key + nstart;
+   pval->svalue.len_used = (n - nstart);
+   pval->svalue.len_alloc = pval->svalue.len_used;
+   pval->csize = n;
 
-         if (rc == CACHE_SUCCESS)
-            pkeyval->svalue.len_used = key.size;
-         else {
-            pkeyval->svalue.len_used = 0;
-            rc = YDB_NODE_END;
-         }
-      }
-      else {
-         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
-/*
-         printf("\r\nAdvance Cursor (DB_SET_RANGE): rc=%d; key.size=%d", rc, key.size);
-         dbx_dump_key((char *) key.data, (int) key.size);
-*/
-         if (rc == CACHE_SUCCESS) {
-            pkeyval->svalue.len_used = key.size;
-            if (!bdb_key_compare(&key, &key0, 0, pcon->key_type)) {
-               rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_NEXT); /* v1.3.9 */
-/*
-               printf("\r\nAdvance Cursor (DB_NEXT): rc=%d; key.size=%d", rc, key.size);
-               dbx_dump_key((char *) key.data, (int) key.size);
-*/
-               if (rc == CACHE_SUCCESS)
-                  pkeyval->svalue.len_used = key.size;
-               else {
-                  pkeyval->svalue.len_used = 0;
-                  rc = YDB_NODE_END;
-               }
-            }
-            else {
-               pkeyval->svalue.len_used = key.size;
-            }
-         }
-         else {
-            pkeyval->svalue.len_used = 0;
-            rc = YDB_NODE_END;
-         }
+   return (n < key_len) ? 1 : 0;
+}
+
+
+/* v1.3.18 is key (of key_len bytes) in the subtree under prefix: the byte following the prefix must start a new subscript */
+int dbx_key_under(char * key, unsigned int key_len, char * prefix, unsigned int prefix_len)
+{
+   if (key_len < prefix_len) {
+      return -1;
+   }
+   if (key_len > prefix_len && key[prefix_len] != '\0') {
+      return -1;
+   }
+   if (prefix_len > 0 && (key[prefix_len - 1] != prefix[prefix_len - 1] || memcmp((void *) key, (void *) prefix, (size_t) prefix_len))) {
+      return -1;
+   }
+   return 0;
+}
+
+
+/* v1.3.18 shared by bdb_key_compare() and lmdb_key_compare() */
+int dbx_key_compare(char * key1, unsigned int key1_len, char * key2, unsigned int key2_len, int compare_max, short keytype)
+{
+   if (keytype == DBX_KEYTYPE_M && compare_max > 0) {
+      /* both keys must lie under the same compare_max byte prefix */
+      if (key2_len < (unsigned int) compare_max) {
+         return -1;
       }
-      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
-         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
-         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
-         pkeyval->type = DBX_DTYPE_INT;
+      if (key2_len > (unsigned int) compare_max && key2[compare_max] != '\0') {
+         return -1;
       }
+      return dbx_key_under(key1, key1_len, key2, (unsigned int) compare_max);
    }
 
-   if (context == 0) {
-      pcursor->close(pcursor); 
+   if (key1_len == 0 || key1_len != key2_len) {
+      return -1;
    }
+   return memcmp((void *) key1, (void *) key2, (size_t) key1_len) ? -1 : 0;
+}
 
-   if (rc != CACHE_SUCCESS) {
-      pkeyval->svalue.len_used = 0;
+
+/* v1.3.27 Extend the key held in dbx_key (key_len bytes) to the smallest key that follows it */
+int dbx_key_successor(DBXSTR *dbx_key, unsigned int key_len)
+{
+   if (dbx_key->len_alloc <= key_len) {
+      if (!dbx_buffer_resize(&(dbx_key->buf_addr), key_len, key_len + 32, &(dbx_key->len_alloc))) {
+         return CACHE_FAILURE;
+      }
    }
-   if (pkeyval->svalue.len_used == 0) {
-      rc = YDB_NODE_END;
+   dbx_key->buf_addr[key_len] = '\0';
+   dbx_key->len_used = key_len + 1;
+
+   return CACHE_SUCCESS;
+}
+
+
+int dbx_dump_key(char * key, int key_len)
+{
+   int n, n1;
+   char buffer[4096], hex[16];
+
+   n1 = 0;
+   for (n = 0; n < key_len; n ++) {
+      if ((int) *(((char *) key) + n) < 32 || (int) *(((char *) key) + n) > 126) {
+         sprintf(hex, "%02x", (unsigned char) *(((char *) key) + n));
+         buffer[n1 ++] = '\\';
+         buffer[n1 ++] = 'x';
+         buffer[n1 ++] = hex[0];
+         buffer[n1 ++] = hex[1];
+      }
+      else {
+         buffer[n1 ++] = *(((char *) key) + n);
+      }
    }
+   buffer[n1] = '\0';
+   printf("\r\n%s", buffer);
 
-   return rc;
+   return 0;
 }
 
 
-int bdb_previous(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
+/* copy with possible overlap */
+int dbx_memcpy(void * to, void *from, size_t size)
 {
-   int rc, mkeyn, fixed_comp;
-   DBXCON *pcon = pmeth->pcon;
-   DBT key, key0, data;
-   DBC *pcursor;
-   DBXVAL mkeys[DBX_MAXARGS];
-/*
-   printf("\r\n ******* bdb_previous ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p; seed_len%d\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr, pkey->args[pkey->argc - 1].svalue.len_used);
-*/
+   int n;
+   char *p1, *p2;
 
-   memset(&key, 0, sizeof(DBT));
-   memset(&key0, 0, sizeof(DBT));
-   memset(&data, 0, sizeof(DBT));
-   key.flags = DB_DBT_USERMEM;
-   key0.flags = DB_DBT_USERMEM;
-   data.flags = DB_DBT_USERMEM;
+   p1 = (char *) to;
+   p2 = (char *) from;
 
-   if (context == 0) {
-      rc = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pcursor, 0);
-   }
-   else {
-     pcursor = pmeth->pbdbcursor;
+   for (n = 0; n < (int) size; n ++) {
+      *p1 ++ = *p2 ++;
    }
+   return 0;
+}
 
-   if (pcon->key_type == DBX_KEYTYPE_INT) {
-      key0.data = &(pkey->args[0].num.int32);
-      key0.size = sizeof(pkey->args[0].num.int32);
-      key0.ulen = sizeof(pkey->args[0].num.int32);
 
-      pkeyval->num.int32 = pkey->args[0].num.int32;
-      key.data = &(pkeyval->num.int32);
-      key.size = sizeof(pkeyval->num.int32);
-      key.ulen = sizeof(pkeyval->num.int32);
-      if (pkey->args[0].svalue.len_used == 0) {
-         key.size = 0;
-         key0.size = 0;
+/* extended copy with possible overlap */
+int dbx_memcpy_ex(DBXSTR * to, void *from, size_t size)
+{
+   char *p, *pold;
+
+   p = NULL;
+   pold = NULL;
+   if (to->len_alloc < size) {
+      p = (char *) dbx_malloc((int) (size + 32), DBX_MEMID_BUFFER);
+      if (!p) {
+         return CACHE_FAILURE;
       }
+      pold = to->buf_addr;
+      to->buf_addr = p;
+      to->len_alloc = (unsigned int) (size + 32);
    }
-   else if (pcon->key_type == DBX_KEYTYPE_STR) {
-      key0.data = pkey->args[0].svalue.buf_addr;
-      key0.size = pkey->args[0].svalue.len_used;
-      key0.ulen = pkey->args[0].svalue.len_alloc;
 
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
-      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
-      key.data = (void *) pkeyval->svalue.buf_addr;
-      key.size = (u_int32_t) pkeyval->svalue.len_used;
-      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
-   }
-   else { /* mumps */
-      key0.data = (void *) pkey->ibuffer.buf_addr;
-      key0.size = (u_int32_t) pkey->ibuffer.len_used;
-      key0.ulen = (u_int32_t) pkey->ibuffer.len_alloc;
+   dbx_memcpy(to->buf_addr, from, size);
+   to->len_used = (unsigned int) size;
 
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
-      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
-      key.data = (void *) pkeyval->svalue.buf_addr;
-      key.size = (u_int32_t) pkeyval->svalue.len_used;
-      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+   if (pold) {
+      dbx_free((void *) pold, 0);
    }
 
-   data.data = (void *) pdataval->svalue.buf_addr;
-   data.ulen = (u_int32_t) pdataval->svalue.len_alloc;
-
-   fixed_comp = 0;
-   rc = YDB_NODE_END;
-   if (pcon->key_type == DBX_KEYTYPE_M) {
-/*
-      printf("\r\n seed ... pkey->ibuffer.len_used=%d", pkey->ibuffer.len_used);
-      dbx_dump_key((char *) key0.data, (int) key0.size);
-*/
-      pkeyval->svalue.len_used = 0;
-      if (pkey->argc < 2 && pkey->args[pkey->argc - 1].svalue.len_used == 0) { /* null seed - special case */
-
-         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
-         if (rc != CACHE_SUCCESS) {
-            rc = YDB_NODE_END;
-         }
+   return CACHE_SUCCESS;
+}
 
-/*
-         printf("\r\n DB_LAST rc=%d; argc=%d; key.size=%d", rc, pkey->argc, (int) key.size);
-         dbx_dump_key((char *) key.data, (int) key.size);
-*/
 
+/* extended copy with no overlap */
+int dbx_memcpy_exx(DBXSTR * to, void *from, size_t size)
+{
+   if (to->len_alloc < size) {
+      if (!dbx_buffer_resize(&(to->buf_addr), 0, (unsigned int) size + 32, &(to->len_alloc))) {
+         return CACHE_FAILURE;
       }
-      else {
-
-         if (pkey->args[pkey->argc - 1].svalue.len_used == 0) {
-            *(((unsigned char *) key.data) + pkey->args[pkey->argc - 1].csize - 1) = 0xff;
-         }
+   }
+   
+   memcpy((void *) to->buf_addr, from, size);
+   to->len_used = (unsigned int) size;
 
-         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
-         if (rc != CACHE_SUCCESS) {
-            rc = YDB_NODE_END;
-         }
+   return CACHE_SUCCESS;
+}
 
-/*
-         printf("\r\n DB_SET_RANGE rc=%d; argc=%d; key.size=%d", rc, pkey->argc, (int) key.size);
-         dbx_dump_key((char *) key.data, (int) key.size);
-*/
-         if (rc == CACHE_SUCCESS) {
-            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_PREV); /* v1.3.9 */
-            if (rc != CACHE_SUCCESS) {
-               rc = YDB_NODE_END;
-            }
 
-            if (rc == CACHE_SUCCESS) {
-               if (pkey->argc < 2)
-                  fixed_comp = 0;
-               else
-                  fixed_comp = bdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
-            }
-/*
-            printf("\r\n DB_PREV rc=%d; argc=%d; key.size=%d; fixed_comp=%d;", rc, pkey->argc, (int) key.size, fixed_comp);
-            dbx_dump_key((char *) key.data, (int) key.size);
-*/
-         }
-         else { /* v1.2.7 */
-            /* printf("\r\n probably the last global in the database ..."); */
-            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
-            if (rc != CACHE_SUCCESS) {
-               rc = YDB_NODE_END;
-            }
+int dbx_global_reset(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pgx, int argc_offset, short context)
+{
+   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
+   int n, len, otype;
+   char global_name[256], *p;
+   DBXVAL *pval, *pvalp;
+   v8::Local<v8::Object> obj;
+   v8::Local<v8::String> str;
+   mglobal *gx = (mglobal *) pgx;
 
-            if (rc == CACHE_SUCCESS) {
-               if (pkey->argc < 2)
-                  fixed_comp = 0;
-               else
-                  fixed_comp = bdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
-            }
-/*
-            printf("\r\n DB_LAST rc=%d; argc=%d; key.size=%d; fixed_comp=%d;", rc, pkey->argc, (int) key.size, fixed_comp);
-            dbx_dump_key((char *) key.data, (int) key.size);
-*/
-         }
-      }
-      if (rc == CACHE_SUCCESS && !fixed_comp) {
-         mkeyn = dbx_split_key(&mkeys[0], (char *) key.data, (int) key.size);
+#ifdef _WIN32
+__try {
+#endif
 
-         if (context == 0) {
-            dbx_memcpy_ex(&(pkeyval->svalue),  (void *) mkeys[pmeth->key.argc - 1].svalue.buf_addr,  (size_t) mkeys[pmeth->key.argc - 1].svalue.len_used);
-         }
-         else {
-            dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.data, (size_t) mkeys[pkey->argc - 1].csize);
-            pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
-            dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
-         }
-         pdataval->svalue.len_used = (unsigned int) data.size;
+   if (pcon->log_functions && gx && gx->c) {
+      gx->c->LogFunction(gx->c, args, NULL, (char *) "dbx_global_reset");
+   }
 
-         if (mkeyn != pkey->argc) { /* can't use data as it's under lower subscripts */
-            data.size = 0;
-            pdataval->svalue.len_used = (unsigned int) data.size;
-         }
+   dbx_write_char8(isolate, DBX_TO_STRING(args[argc_offset]), global_name, sizeof(global_name), pcon->utf8);
+   if (global_name[0] == '\0') {
+      return -1;
+   }
+
+   pval = gx->pkey;
+   while (pval) {
+      pvalp = pval;
+      pval = pval->pnext;
+      dbx_free((void *) pvalp, 0);
+   }
+   gx->pkey = NULL;
+   gx->gdbref.index = -1; /* v1.3.15 */
+   gx->gdbref.gen = 0;
+   if (gx->pkpfx) { /* v1.3.16 */
+      dbx_free((void *) gx->pkpfx, 0);
+      gx->pkpfx = NULL;
+   }
 
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+      if (global_name[0] == '^') {
+         T_STRCPY(gx->global_name, _dbxso(gx->global_name), global_name + 1);
       }
       else {
-         pkeyval->svalue.len_used = 0;
-         rc = YDB_NODE_END;
+         T_STRCPY(gx->global_name, _dbxso(gx->global_name), global_name);
       }
    }
-   else {
-      if (key.size == 0) {
-         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
-         if (rc != CACHE_SUCCESS) {
-            rc = YDB_NODE_END;
-         }
 
-         if (rc == CACHE_SUCCESS)
-            pkeyval->svalue.len_used = key.size;
-         else {
-            pkeyval->svalue.len_used = 0;
-            rc = YDB_NODE_END;
-         }
+   pvalp = NULL;
+   for (n = (argc_offset + 1); n < pmeth->jsargc; n ++) {
+      if (args[n]->IsInt32()) {
+         pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL), DBX_MEMID_GLOBAL);
+         pval->type = DBX_DTYPE_INT;
+         pval->num.int32 = (int) DBX_INT32_VALUE(args[n]);
       }
       else {
-         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
-         if (rc != CACHE_SUCCESS) {
-            rc = YDB_NODE_END;
-         }
-
-         if (rc == CACHE_SUCCESS) {
-            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_PREV); /* v1.3.9 */
-            if (rc == CACHE_SUCCESS)
-               pkeyval->svalue.len_used = key.size;
-            else {
-               pkeyval->svalue.len_used = 0;
-               rc = YDB_NODE_END;
-            }
+         obj = dbx_is_object(args[n], &otype);
+         if (otype == 2) {
+            p = node::Buffer::Data(obj);
+            len = (int) node::Buffer::Length(obj);
+            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, DBX_MEMID_GLOBAL);
+            pval->type = DBX_DTYPE_STR;
+            pval->svalue.buf_addr = ((char *) pval) + sizeof(DBXVAL);
+            memcpy((void *) pval->svalue.buf_addr, (void *) p, (size_t) len);
+            pval->svalue.len_alloc = len + 32;
+            pval->svalue.len_used = len;
          }
          else {
-            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
-            if (rc == CACHE_SUCCESS)
-               pkeyval->svalue.len_used = key.size;
-            else {
-               pkeyval->svalue.len_used = 0;
-               rc = YDB_NODE_END;
-            }
+            str = DBX_TO_STRING(args[n]);
+            len = (int) dbx_string8_length(isolate, str, 0);
+            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, DBX_MEMID_GLOBAL);
+            pval->type = DBX_DTYPE_STR;
+            pval->svalue.buf_addr = ((char *) pval) + sizeof(DBXVAL);
+            pval->svalue.len_alloc = len + 32; /* v1.3.16 set before use */
+            dbx_write_char8(isolate, str, pval->svalue.buf_addr, pval->svalue.len_alloc, 1);
+            pval->svalue.len_used = len;
          }
       }
-      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
-         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
-         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
-         pkeyval->type = DBX_DTYPE_INT;
+      if (pvalp) {
+         pvalp->pnext = pval;
+      }
+      else {
+         gx->pkey = pval;
       }
+      pvalp = pval;
+      pvalp->pnext = NULL;
    }
 
-   if (context == 0) {
-      pcursor->close(pcursor); 
+   if (pcon->key_type == DBX_KEYTYPE_M) { /* v1.3.16 */
+      gx->pkpfx = dbx_key_prefix(pmeth, gx->global_name, gx->pkey);
    }
 
-   if (rc != CACHE_SUCCESS) {
-      pkeyval->svalue.len_used = 0;
-   }
+   return 0;
 
-   return rc;
+#ifdef _WIN32
 }
+__except (EXCEPTION_EXECUTE_HANDLER) {
 
+   DWORD code;
+   char bufferx[256];
 
-int bdb_key_compare(DBT *key1, DBT *key2, int compare_max, short keytype)
-{
-   int n, n1, n2, rc;
-   char *c1, *c2;
-
-   c1 = (char *) key1->data;
-   c2 = (char *) key2->data;
-   if (keytype == DBX_KEYTYPE_M) {
-      if (compare_max > 0) {
-         if (key1->size < (u_int32_t) compare_max || key2->size < (u_int32_t) compare_max) {
-            return -1;
-         }
-         if ((int) key1->size > compare_max && c1[compare_max] != '\0') {
-            return -1;
-         }
-         if ((int) key2->size > compare_max && c2[compare_max] != '\0') {
-            return -1;
-         }
-      }
-      else {
-         if (key1->size == 0) {
-            return -1;
-         }
-         if (key1->size != key2->size) {
-            return -1;
-         }
-         compare_max = key1->size;
-      }
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_global_reset: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
-   else {
-      if (key1->size == 0) {
-         return -1;
-      }
-      if (key1->size != key2->size) {
-         return -1;
-      }
-
-      if (keytype == DBX_KEYTYPE_INT) {
-         n1 = *((int *) key1->data);
-         n2 = *((int *) key2->data);
-         if (n1 == n2)
-            return 0;
-         else
-            return -1;
-      }
-      compare_max = key1->size;
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
    }
 
-   rc = 0;
-   for (n = 0; n < (int) compare_max; n ++) {
-      if (c1[n] != c2[n]) {
-         rc = -1;
-         break;
-      }
-   }
-   return rc;
+   return 0;
+}
+#endif
 }
 
 
-int bdb_get(DBXCON *pcon, DBT *key, DBT *data, DBXSTR *dbx_data)
+/* v1.3.16 encode the global name and fixed subscripts once so that they can be copied into each request */
+DBXKPFX * dbx_key_prefix(DBXMETH *pmeth, char *global_name, DBXVAL *pkey)
 {
-   int rc;
+   int n, nx;
+   char buffer[64];
+   DBXKEY key;
+   DBXVAL *pval;
+   DBXKPFX *pkpfx;
+   v8::Local<v8::String> str;
 
-   rc = pcon->p_bdb_so->pdb->get(pcon->p_bdb_so->pdb, NULL, key, data, 0);
-   if (rc == DB_BUFFER_SMALL) { /* v1.3.9 */
-      rc = bdb_resize_buffer(NULL, NULL, data, dbx_data, 0);
-      if (rc == CACHE_SUCCESS) {
-         rc = pcon->p_bdb_so->pdb->get(pcon->p_bdb_so->pdb, NULL, key, data, 0);
+   key.ibuffer.buf_addr = NULL;
+   key.ibuffer.len_alloc = 0;
+   key.ibuffer.len_used = 0;
+   key.argc = 0;
+
+   nx = 0;
+   key.args[nx].cvalue.pstr = 0;
+   key.args[nx].type = DBX_DTYPE_STR;
+   key.args[nx].sort = DBX_DSORT_GLOBAL;
+   dbx_ibuffer_add(pmeth, &key, NULL, nx, str, global_name, (int) strlen(global_name), 0);
+   nx ++;
+   for (pval = pkey; pval && nx < (DBX_MAXARGS - 1); pval = pval->pnext, nx ++) {
+      key.args[nx].cvalue.pstr = 0;
+      key.args[nx].sort = DBX_DSORT_DATA;
+      if (pval->type == DBX_DTYPE_INT) {
+         key.args[nx].type = DBX_DTYPE_INT;
+         key.args[nx].num.int32 = (int) pval->num.int32;
+         T_SPRINTF(buffer, _dbxso(buffer), "%d", pval->num.int32);
+         dbx_ibuffer_add(pmeth, &key, NULL, nx, str, buffer, (int) strlen(buffer), 0);
       }
       else {
-         rc = CACHE_FAILURE;
+         key.args[nx].type = DBX_DTYPE_STR;
+         dbx_ibuffer_add(pmeth, &key, NULL, nx, str, pval->svalue.buf_addr, (int) pval->svalue.len_used, 0);
       }
    }
 
-   return rc;
-}
-
-
-int bdb_cursor_get(DBC *pcursor, DBT *key, DBXSTR *dbx_key, DBT *data, DBXSTR *dbx_data, int context)
-{
-   int rc;
-
-   rc = pcursor->get(pcursor, key, data, context);
-   if (rc == DB_BUFFER_SMALL) { /* v1.3.9 */
-      rc = bdb_resize_buffer(key, dbx_key, data, dbx_data, 0);
-      if (rc == CACHE_SUCCESS) {
-         rc = pcursor->get(pcursor, key, data, context);
-      }
-      else {
-         rc = YDB_NODE_END;
+   pkpfx = NULL;
+   if (key.ibuffer.buf_addr) {
+      pkpfx = (DBXKPFX *) dbx_malloc(sizeof(DBXKPFX) + (sizeof(DBXVAL) * nx) + key.ibuffer.len_used, DBX_MEMID_GLOBAL);
+   }
+   if (pkpfx) {
+      pkpfx->argc = nx;
+      pkpfx->len = key.ibuffer.len_used;
+      pkpfx->args = (DBXVAL *) (((char *) pkpfx) + sizeof(DBXKPFX));
+      pkpfx->buffer = ((char *) pkpfx->args) + (sizeof(DBXVAL) * nx);
+      memcpy((void *) pkpfx->buffer, (void *) key.ibuffer.buf_addr, (size_t) key.ibuffer.len_used);
+      for (n = 0; n < nx; n ++) {
+         pkpfx->args[n] = key.args[n];
+         pkpfx->args[n].offs = (unsigned long) (key.args[n].svalue.buf_addr - key.ibuffer.buf_addr); /* rebased on each copy */
+         pkpfx->args[n].svalue.buf_addr = NULL;
+         pkpfx->args[n].pnext = NULL;
       }
    }
+   if (key.ibuffer.buf_addr) {
+      dbx_free((void *) key.ibuffer.buf_addr, DBX_MEMID_KEY);
+   }
 
-   return rc;
+   return pkpfx;
 }
 
 
-/* v1.3.9 */
-int bdb_resize_buffer(DBT *key, DBXSTR *dbx_key, DBT *data, DBXSTR *dbx_data, int context)
+int dbx_cursor_init(void *pcx)
 {
-   if (key && (key->ulen < key->size)) {
-      if (!dbx_buffer_resize((char **) &(dbx_key->buf_addr), 0, (unsigned int) (key->size + 32), (unsigned int *) &(dbx_key->len_alloc))) {
-         return CACHE_FAILURE;
-      }
-      dbx_key->len_alloc = (unsigned int) (key->size + 32);
-      key->data = (void *) dbx_key->buf_addr;
-      key->ulen = (u_int32_t) dbx_key->len_alloc;
-   }
-   if (data && (data->ulen < data->size)) {
-      if (!dbx_buffer_resize((char **) &(dbx_data->buf_addr), 0, (unsigned int) (data->size + 32), (unsigned int *) &(dbx_data->len_alloc))) {
-         return CACHE_FAILURE;
-      }
-      dbx_data->len_alloc = (unsigned int) (data->size + 32);
-      data->data = (void *) dbx_data->buf_addr;
-      data->ulen = (u_int32_t) dbx_data->len_alloc;
-   }
+   mcursor *cx = (mcursor *) pcx;
 
-   return CACHE_SUCCESS;
+   cx->context = 0;
+   cx->getdata = 0;
+   cx->format = 0;
+   cx->counter = 0;
+   cx->global_name[0] = '\0';
+   cx->pqr_prev = NULL;
+   cx->pqr_next = NULL;
+   cx->data.buf_addr = NULL;
+   cx->data.len_alloc = 0;
+   cx->data.len_used = 0;
+   cx->psql = NULL;
+   cx->c = NULL;
+   cx->pcursor = NULL;
+
+   return 0;
 }
 
 
-/* v1.3.10 */
-int bdb_error_message(DBXCON *pcon, int error_code)
+int dbx_cursor_reset(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pcx, int argc_offset, short context)
 {
-   switch (error_code) {
-      case 0:
-         strcpy(pcon->error, "");
+   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
+   int n, len, alen, nx, otype;
+   char *p;
+   char global_name[256], buffer[256];
+   DBXSQL *psql;
+   DBC *pbdbcursor;
+   MDB_cursor *plmdbcursor;
+   MDB_txn * plmdbtxnro;
+   v8::Local<v8::Object> obj;
+   v8::Local<v8::String> key;
+   v8::Local<v8::String> value;
+   mcursor *cx = (mcursor *) pcx;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   if (pcon->log_functions && cx && cx->c) {
+      cx->c->LogFunction(cx->c, args, NULL, (char *) "dbx_cursor_reset");
+   }
+
+   if (pmeth->jsargc < 1) {
+      return -1;
+   }
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      if (cx->pcursor) {
+         pbdbcursor = (DBC *) cx->pcursor;
+         pbdbcursor->close(pbdbcursor);
+      }
+      pbdbcursor = NULL;
+      if (pcon->p_bdb_so->pdb) { /* v1.3.15 no master database where each global has its own */
+         n = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pbdbcursor, 0);
+      }
+      cx->pcursor = (void *) pbdbcursor;
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      if (cx->pcursor) {
+         plmdbcursor = (MDB_cursor *) cx->pcursor;
+         plmdbtxnro = (MDB_txn *) cx->ptxnro;
+         pcon->p_lmdb_so->p_mdb_cursor_close(plmdbcursor);
+         lmdb_commit_qro_transaction(pmeth, &(plmdbtxnro), 0);
+      }
+      n = lmdb_start_qro_transaction(pmeth, &(plmdbtxnro), 0);
+      n = pcon->p_lmdb_so->p_mdb_cursor_open(plmdbtxnro, pcon->p_lmdb_so->db, &plmdbcursor);
+      cx->ptxnro = (void *) plmdbtxnro;
+      cx->pcursor = (void *) plmdbcursor;
+   }
+
+   obj = DBX_TO_OBJECT(args[argc_offset]);
+   key = dbx_new_string8(isolate, (char *) "sql", 1);
+   if (DBX_GET(obj, key)->IsString()) {
+      value = DBX_TO_STRING(DBX_GET(obj, key));
+      len = (int) dbx_string8_length(isolate, value, 0);
+      psql = (DBXSQL *) dbx_malloc(sizeof(DBXSQL) + (len + 4), DBX_MEMID_CURSOR);
+      for (n = 0; n < DBX_SQL_MAXCOL; n ++) {
+         psql->cols[n] = NULL;
+      }
+      psql->no_cols = 0;
+      psql->sql_script = ((char *) psql) + sizeof(DBXSQL);
+      psql->sql_script_len = len;
+      dbx_write_char8(isolate, value, psql->sql_script, len + 2, pcon->utf8);
+
+      psql->sql_type = DBX_SQL_MGSQL;
+      key = dbx_new_string8(isolate, (char *) "type", 1);
+      if (DBX_GET(obj, key)->IsString()) {
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         dbx_write_char8(isolate, value, buffer, sizeof(buffer), pcon->utf8);
+         dbx_lcase(buffer);
+         psql->sql_type = DBX_SQL_MGSQL;
+      }
+
+      cx->psql = psql;
+      DBX_DB_LOCK(0);
+      psql->sql_no = ++ dbx_sql_counter;
+      DBX_DB_UNLOCK();
+   
+      cx->context = 11;
+      cx->counter = 0;
+      cx->getdata = 0;
+      cx->format = 0;
+
+      if (pmeth->jsargc > (argc_offset + 1)) {
+         dbx_is_object(args[argc_offset + 1], &n);
+         if (n) {
+            obj = DBX_TO_OBJECT(args[argc_offset + 1]);
+            key = dbx_new_string8(isolate, (char *) "format", 1);
+            if (DBX_GET(obj, key)->IsString()) {
+               char buffer[64];
+               value = DBX_TO_STRING(DBX_GET(obj, key));
+               dbx_write_char8(isolate, value, buffer, sizeof(buffer), 1);
+               dbx_lcase(buffer);
+               if (!strcmp(buffer, "url")) {
+                  cx->format = 1;
+               }
+            }
+         }
+      }
+      return 0;
+   }
+
+   if (!cx->pqr_prev) {
+      cx->pqr_prev = dbx_alloc_dbxqr(NULL, 0, 0);
+   }
+   if (!cx->pqr_next) {
+      cx->pqr_next = dbx_alloc_dbxqr(NULL, 0, 0);
+   }
+   if (!cx->data.buf_addr) {
+      cx->data.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, DBX_MEMID_CURSOR);
+      cx->data.len_alloc = CACHE_MAXSTRLEN;
+      cx->data.len_used = 0;
+   }
+
+   cx->pqr_prev->key.ibuffer.len_used = 0;
+   nx = 0;
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+      key = dbx_new_string8(isolate, (char *) "global", 1);
+      if (DBX_GET(obj, key)->IsString()) {
+         dbx_write_char8(isolate, DBX_TO_STRING(DBX_GET(obj, key)), global_name, sizeof(global_name), pcon->utf8);
+      }
+      else {
+         return -1;
+      }
+
+      if (global_name[0] == '^') {
+         T_STRCPY(cx->global_name, _dbxso(gx->global_name), global_name + 1);
+      }
+      else {
+         T_STRCPY(cx->global_name, _dbxso(gx->global_name), global_name);
+      }
+      cx->pqr_prev->key.args[nx].type = DBX_DTYPE_STR; /* v1.3.22 not left to whatever the (reused) memory held */
+      dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, cx->global_name, (int) strlen(cx->global_name), 0);
+      nx ++;
+
+      strcpy(cx->pqr_next->global_name.buf_addr, cx->global_name);
+      strcpy(cx->pqr_prev->global_name.buf_addr, cx->global_name);
+      cx->pqr_prev->global_name.len_used = (int) strlen((char *) cx->pqr_prev->global_name.buf_addr);
+      cx->pqr_next->global_name.len_used =  cx->pqr_prev->global_name.len_used;
+   }
+   else {
+      cx->pqr_prev->global_name.len_used = 0;
+      cx->pqr_next->global_name.len_used = 0;
+   }
+
+   cx->pqr_prev->key.argc = nx;
+
+   key = dbx_new_string8(isolate, (char *) "key", 1);
+   if (DBX_GET(obj, key)->IsArray()) {
+      Local<Array> a = Local<Array>::Cast(DBX_GET(obj, key));
+      alen = (int) a->Length();
+
+      for (n = 0; n < alen; n ++) {
+         if (DBX_GET(a, n)->IsInt32()) {
+            cx->pqr_prev->key.args[nx].type = DBX_DTYPE_INT;
+            cx->pqr_prev->key.args[nx].num.int32 = (int) DBX_INT32_VALUE(DBX_GET(a, n));
+            T_SPRINTF(buffer, _dbxso(buffer), "%d", pmeth->key.args[nx].num.int32);
+            dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, buffer, (int) strlen(buffer), 0);
+         }
+         else {
+            cx->pqr_prev->key.args[nx].type = DBX_DTYPE_STR;
+            obj = dbx_is_object(DBX_GET(a, n), &otype);
+
+            if (otype == 2) {
+               p = node::Buffer::Data(obj);
+               len = (int) node::Buffer::Length(obj);
+               dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, p, (int) len, 0);
+            }
+            else {
+               value = DBX_TO_STRING(DBX_GET(a, n));
+               dbx_ibuffer_add(pmeth, &(cx->pqr_prev->key), isolate, nx, value, NULL, 0, 0);
+            }
+         }
+         nx ++;
+      }
+   }
+
+   cx->pqr_prev->key.argc = nx;
+
+   cx->fixed_key_len = cx->pqr_prev->key.ibuffer.len_used;
+   cx->context = 1;
+   cx->counter = 0;
+   cx->getdata = 0;
+   cx->format = 0;
+
+   if (pmeth->jsargc > (argc_offset + 1)) {
+      obj = DBX_TO_OBJECT(args[argc_offset + 1]);
+      key = dbx_new_string8(isolate, (char *) "getdata", 1);
+      if (DBX_GET(obj, key)->IsBoolean()) {
+         if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
+            cx->getdata = 1;
+         }
+      }
+      key = dbx_new_string8(isolate, (char *) "multilevel", 1);
+      if (DBX_GET(obj, key)->IsBoolean()) {
+         if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
+            cx->context = 2;
+         }
+      }
+      key = dbx_new_string8(isolate, (char *) "globaldirectory", 1);
+      if (DBX_GET(obj, key)->IsBoolean()) {
+         if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue()) {
+            cx->context = 9;
+         }
+      }
+      key = dbx_new_string8(isolate, (char *) "format", 1);
+      if (DBX_GET(obj, key)->IsString()) {
+         char buffer[64];
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         dbx_write_char8(isolate, value, buffer, sizeof(buffer), 1);
+         dbx_lcase(buffer);
+         if (!strcmp(buffer, "url")) {
+            cx->format = 1;
+         }
+      }
+   }
+
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+      if (cx->context != 9 && cx->global_name[0] == '\0') { /* not a global directory so global name cannot be empty */
+         return -1;
+      }
+   }
+   else {
+      cx->context = 2; /* one key so set multilevel context */
+   }
+
+   if (pcon->global_dbs && cx->context != 9) { /* v1.3.15 re-open the cursor on the global's own database */
+      DBXGDB *pgdb;
+
+      pgdb = NULL;
+      dbx_global_db(pmeth, cx->global_name, (int) strlen(cx->global_name), 0, &pgdb);
+      if (pcon->dbtype == DBX_DBTYPE_BDB) {
+         if (cx->pcursor) {
+            pbdbcursor = (DBC *) cx->pcursor;
+            pbdbcursor->close(pbdbcursor);
+         }
+         pbdbcursor = NULL;
+         if (pgdb) {
+            n = pgdb->pdb->cursor(pgdb->pdb, NULL, &pbdbcursor, 0);
+         }
+         cx->pcursor = (void *) pbdbcursor;
+      }
+      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         /* a newly opened database handle is only visible to transactions started after it was opened */
+         plmdbcursor = (MDB_cursor *) cx->pcursor;
+         plmdbtxnro = (MDB_txn *) cx->ptxnro;
+         if (plmdbcursor) {
+            pcon->p_lmdb_so->p_mdb_cursor_close(plmdbcursor);
+            lmdb_commit_qro_transaction(pmeth, &(plmdbtxnro), 0);
+         }
+         plmdbcursor = NULL;
+         if (pgdb) { /* v1.3.15 otherwise the global does not exist: the cursor is not left on the main database */
+            n = lmdb_start_qro_transaction(pmeth, &(plmdbtxnro), 0);
+            n = pcon->p_lmdb_so->p_mdb_cursor_open(plmdbtxnro, pgdb->dbi, &plmdbcursor);
+         }
+         cx->ptxnro = (void *) plmdbtxnro;
+         cx->pcursor = (void *) plmdbcursor;
+      }
+   }
+
+   return 0;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_cursor_reset: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return 0;
+}
+#endif
+}
+
+
+int bdb_load_library(DBXCON *pcon)
+{
+   int result;
+   char primerr[DBX_ERROR_SIZE];
+   char fun[64];
+
+   strcpy(pcon->p_bdb_so->libdir, pcon->db_library);
+   strcpy(pcon->p_bdb_so->funprfx, "db");
+   strcpy(pcon->p_bdb_so->dbname, "BDB");
+
+   strcpy(pcon->p_bdb_so->libnam, pcon->p_bdb_so->libdir);
+
+   pcon->p_bdb_so->p_library = dbx_dso_load(pcon->p_bdb_so->libnam);
+   if (!pcon->p_bdb_so->p_library) {
+      int len1, len2;
+      char *p;
+#if defined(_WIN32)
+      DWORD errorcode;
+      LPVOID lpMsgBuf;
+
+      lpMsgBuf = NULL;
+      errorcode = GetLastError();
+      sprintf(pcon->error, "Error loading %s Library: %s; Error Code : %ld",  pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, errorcode);
+      len2 = (int) strlen(pcon->error);
+      len1 = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+                     NULL,
+                     errorcode,
+                     /* MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), */
+                     MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
+                     (LPTSTR) &lpMsgBuf,
+                     0,
+                     NULL 
+                     );
+      if (lpMsgBuf && len1 > 0 && (DBX_ERROR_SIZE - len2) > 30) {
+         strncpy(primerr, (const char *) lpMsgBuf, DBX_ERROR_SIZE - 1);
+         p = strstr(primerr, "\r\n");
+         if (p)
+            *p = '\0';
+         len1 = (DBX_ERROR_SIZE - (len2 + 10));
+         if (len1 < 1)
+            len1 = 0;
+         primerr[len1] = '\0';
+         p = strstr(primerr, "%1");
+         if (p) {
+            *p = 'I';
+            *(p + 1) = 't';
+         }
+         strcat(pcon->error, " (");
+         strcat(pcon->error, primerr);
+         strcat(pcon->error, ")");
+      }
+      if (lpMsgBuf)
+         LocalFree(lpMsgBuf);
+#else
+      p = (char *) dlerror();
+      sprintf(primerr, "Cannot load %s library: Error Code: %d", pcon->p_bdb_so->dbname, errno);
+      len2 = strlen(pcon->error);
+      if (p) {
+         strncpy(primerr, p, DBX_ERROR_SIZE - 1);
+         primerr[DBX_ERROR_SIZE - 1] = '\0';
+         len1 = (DBX_ERROR_SIZE - (len2 + 10));
+         if (len1 < 1)
+            len1 = 0;
+         primerr[len1] = '\0';
+         strcat(pcon->error, " (");
+         strcat(pcon->error, primerr);
+         strcat(pcon->error, ")");
+      }
+#endif
+      goto bdb_load_library_exit;
+   }
+/*
+   int               (* p_db_create)                 (DB **pdb, DB_ENV *dbenv, u_int32_t flags);
+   char *            (* p_db_full_version)           (int *family, int *release, int *major, int *minor, int *patch);
+*/
+
+   sprintf(fun, "%s_create", pcon->p_bdb_so->funprfx);
+   pcon->p_bdb_so->p_db_create = (int (*) (DB **, DB_ENV *, u_int32_t)) dbx_dso_sym(pcon->p_bdb_so->p_library, (char *) fun);
+   if (!pcon->p_bdb_so->p_db_create) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, fun);
+      goto bdb_load_library_exit;
+   }
+   sprintf(fun, "%s_env_create", pcon->p_bdb_so->funprfx);
+   pcon->p_bdb_so->p_db_env_create = (int (*) (DB_ENV **, u_int32_t)) dbx_dso_sym(pcon->p_bdb_so->p_library, (char *) fun);
+   if (!pcon->p_bdb_so->p_db_env_create) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, fun);
+      goto bdb_load_library_exit;
+   }
+   sprintf(fun, "%s_full_version", pcon->p_bdb_so->funprfx);
+   pcon->p_bdb_so->p_db_full_version = (char * (*) (int *, int *, int *, int *, int *)) dbx_dso_sym(pcon->p_bdb_so->p_library, (char *) fun);
+   if (!pcon->p_bdb_so->p_db_full_version) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_bdb_so->dbname, pcon->p_bdb_so->libnam, fun);
+      goto bdb_load_library_exit;
+   }
+
+   pcon->p_bdb_so->loaded = 1;
+
+bdb_load_library_exit:
+
+   if (pcon->error[0]) {
+      pcon->p_bdb_so->loaded = 0;
+      pcon->error_code = 1009;
+      result = CACHE_NOCON;
+
+      return result;
+   }
+
+   return CACHE_SUCCESS;
+}
+
+
+int bdb_open(DBXMETH *pmeth)
+{
+   int rc, result;
+   u_int32_t db_flags; /* database open flags */
+   u_int32_t env_flags; /* database environment flags */
+   char *pver;
+   DBXCON *pcon = pmeth->pcon;
+
+   rc = 0;
+   if (!pcon->p_bdb_so) {
+      pcon->p_bdb_so = (DBXBDBSO *) dbx_malloc(sizeof(DBXBDBSO), DBX_MEMID_ENGINE);
+      if (!pcon->p_bdb_so) {
+         T_STRCPY(pcon->error, _dbxso(pcon->error), "No Memory");
+         pcon->error_code = 1009; 
+         result = CACHE_NOCON;
+         return result;
+      }
+      memset((void *) pcon->p_bdb_so, 0, sizeof(DBXBDBSO));
+      pcon->p_bdb_so->pdb = NULL;
+      pcon->p_bdb_so->penv = NULL;
+      pcon->p_bdb_so->loaded = 0;
+      pcon->p_bdb_so->no_connections = 0;
+      pcon->p_bdb_so->multiple_connections = 0;
+      pcon->p_zv = &(pcon->p_bdb_so->zv);
+   }
+
+   if (pcon->p_bdb_so->loaded == 2) {
+      /* Already connected */
+      strcpy((char *) pmeth->output_val.svalue.buf_addr, "0");
+      goto bdb_open_exit;
+   }
+
+   if (!pcon->p_bdb_so->loaded) {
+      rc = bdb_load_library(pcon);
+      if (rc != CACHE_SUCCESS) {
+         goto bdb_open_exit;
+      }
+   }
+
+   pver = pcon->p_bdb_so->p_db_full_version(&(pcon->p_zv->family), &(pcon->p_zv->release), &(pcon->p_zv->majorversion), &(pcon->p_zv->minorversion), &(pcon->p_zv->patch));
+
+   pcon->p_zv->dbtype = (unsigned char) pcon->dbtype;
+/*
+   printf("\r\n pver=%s; pcon->p_zv->release=%d; pcon->p_zv->majorversion=%d; pcon->p_zv->minorversion=%d;", pver, pcon->p_zv->release, pcon->p_zv->majorversion, pcon->p_zv->minorversion);
+*/
+   if (pver) {
+      rc = CACHE_SUCCESS;
+      strcpy(pcon->p_zv->db_version, pver);
+      bdb_parse_zv(pcon->p_zv->db_version, pcon->p_zv);
+      if (pcon->p_zv->dbx_build)
+         sprintf(pcon->p_zv->version, "%d.%d.b%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion, pcon->p_zv->dbx_build);
+      else
+         sprintf(pcon->p_zv->version, "%d.%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion);
+   }
+   else {
+      rc = CACHE_FAILURE;
+   }
+
+   /* v1.1.4 */
+   pcon->p_bdb_so->penv = NULL;
+   if (pcon->bdb.txn && !pcon->env_dir[0]) { /* v1.3.30 */
+      strcpy(pcon->error, "A database environment (env_dir) must be specified for BDB transactions");
+      rc = CACHE_NOCON;
+      goto bdb_open_exit;
+   }
+   if (pcon->env_dir[0]) {
+      rc = pcon->p_bdb_so->p_db_env_create(&(pcon->p_bdb_so->penv), 0);
+
+      if (rc != 0) {
+         /* Error handling goes here */
+         strcpy(pcon->error, "Cannot create a BDB environment object");
+         goto bdb_open_exit;
+      }
+
+      /* v1.3.30 cache and memory map configuration: must be set before the environment is opened */
+      if (pcon->bdb.cache_size) {
+         rc = pcon->p_bdb_so->penv->set_cachesize(pcon->p_bdb_so->penv, (u_int32_t) (pcon->bdb.cache_size / 1073741824), (u_int32_t) (pcon->bdb.cache_size % 1073741824), pcon->bdb.cache_regions);
+         if (rc != 0) {
+            strcpy(pcon->error, "Cannot set the cache size for the BDB environment");
+            goto bdb_open_exit;
+         }
+      }
+      if (pcon->bdb.mmap_size) {
+         pcon->p_bdb_so->penv->set_mp_mmapsize(pcon->p_bdb_so->penv, pcon->bdb.mmap_size);
+      }
+
+      /* Open the environment. */
+      if (pcon->bdb.txn) { /* v1.3.30 page level locking allows concurrent writers */
+         pcon->p_bdb_so->penv->set_lk_detect(pcon->p_bdb_so->penv, DB_LOCK_DEFAULT);
+         env_flags = DB_CREATE | DB_INIT_TXN | DB_INIT_LOCK | DB_INIT_LOG | DB_INIT_MPOOL;
+      }
+      else {
+         env_flags = DB_CREATE | DB_INIT_CDB| DB_INIT_MPOOL; /* Initialize the in-memory cache. */
+      }
+
+      rc = pcon->p_bdb_so->penv->open(pcon->p_bdb_so->penv, pcon->env_dir, env_flags, 0);
+
+      if (rc != 0) {
+         /* Error handling goes here */
+         strcpy(pcon->error, "Cannot create or open a BDB environment");
+         goto bdb_open_exit;
+      }
+
+      /* v1.3.29 relaxed durability for transactions */
+      if (pcon->sync_mode != DBX_SYNC_FULL) {
+         pcon->p_bdb_so->penv->set_flags(pcon->p_bdb_so->penv, (pcon->sync_mode == DBX_SYNC_NONE) ? DB_TXN_NOSYNC : DB_TXN_WRITE_NOSYNC, 1);
+      }
+   }
+
+   /* v1.3.15 */
+   pcon->p_bdb_so->global_dbs = 0;
+   pcon->p_bdb_so->max_dbs = pcon->max_dbs;
+   pcon->p_bdb_so->gdb_count = 0;
+   if (pcon->global_dbs && pcon->key_type == DBX_KEYTYPE_M) {
+      pcon->p_bdb_so->global_dbs = 1;
+      if (pcon->p_bdb_so->max_dbs < 1) {
+         pcon->p_bdb_so->max_dbs = DBX_MAX_GLOBAL_DBS;
+      }
+      pcon->p_bdb_so->p_gdb = dbx_global_db_table(pcon->p_bdb_so->max_dbs, &(pcon->p_bdb_so->p_gdb_hash), &(pcon->p_bdb_so->gdb_hash_mask));
+      if (!pcon->p_bdb_so->p_gdb) {
+         strcpy(pcon->error, "No Memory");
+         rc = CACHE_NOCON;
+         goto bdb_open_exit;
+      }
+   }
+   pcon->global_dbs = pcon->p_bdb_so->global_dbs;
+
+   if (pcon->global_dbs) {
+      /* Each global is held in its own sub-database within db_file: these are opened on first use */
+      pcon->p_bdb_so->pdb = NULL;
+      if (!pcon->db_file[0]) {
+         strcpy(pcon->error, "A database file (db_file) must be specified for BDB global databases");
+         rc = CACHE_NOCON;
+         goto bdb_open_exit;
+      }
+      rc = CACHE_SUCCESS;
+      goto bdb_open_exit;
+   }
+
+   rc = pcon->p_bdb_so->p_db_create(&(pcon->p_bdb_so->pdb), pcon->p_bdb_so->penv, 0);
+
+   if (rc != 0) {
+      /* Error handling goes here */
+      strcpy(pcon->error, "Cannot create a BDB object");
+      goto bdb_open_exit;
+   }
+   bdb_db_config(pcon, pcon->p_bdb_so->pdb); /* v1.3.30 */
+
+   /* Database open flags */
+   db_flags = DB_CREATE; /* If the database does not exist, create it.*/
+   if (pcon->bdb.txn) { /* v1.3.30 updates made without an explicit transaction are committed individually */
+      db_flags |= DB_AUTO_COMMIT;
+   }
+   /* open the database */
+   rc = pcon->p_bdb_so->pdb->open(pcon->p_bdb_so->pdb, /* DB structure pointer */
+      NULL, /* Transaction pointer */
+      pcon->db_file, /* On-disk file that holds the database. */
+      NULL, /* Optional logical database name */
+      DB_BTREE, /* Database access method */
+      db_flags, /* Open flags */
+      0); /* File mode (using defaults) */
+
+   if (rc != 0) {
+      /* Error handling goes here */
+      strcpy(pcon->error, "Cannot create or open a BDB database");
+      goto bdb_open_exit;
+   }
+
+bdb_open_exit:
+
+   if (rc == CACHE_SUCCESS) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
+   }
+   else {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) pcon->error, DBX_DTYPE_STR8);
+   }
+
+   return rc;
+}
+
+
+/* v1.3.30 Apply the page size, minimum keys per page and (for a database without an environment) cache size before a database is opened */
+int bdb_db_config(DBXCON *pcon, DB *pdb)
+{
+   int rc;
+
+   rc = 0;
+   if (pcon->bdb.page_size) {
+      rc = pdb->set_pagesize(pdb, (u_int32_t) pcon->bdb.page_size);
+   }
+   if (rc == 0 && pcon->bdb.minkey) {
+      rc = pdb->set_bt_minkey(pdb, (u_int32_t) pcon->bdb.minkey);
+   }
+   if (rc == 0 && pcon->bdb.cache_size && !pcon->p_bdb_so->penv) {
+      rc = pdb->set_cachesize(pdb, (u_int32_t) (pcon->bdb.cache_size / 1073741824), (u_int32_t) (pcon->bdb.cache_size % 1073741824), pcon->bdb.cache_regions);
+   }
+
+   return rc;
+}
+
+
+int bdb_parse_zv(char *zv, DBXZV * p_bdb_sv)
+{
+   char *p;
+
+   p_bdb_sv->dbx_build = p_bdb_sv->patch;
+   p_bdb_sv->vnumber = 0;
+
+   if (p_bdb_sv->majorversion == 0 || p_bdb_sv->minorversion == 0) {
+      p = strstr(zv, "version ");
+      if (!p) {
+         p = strstr(zv, "Release ");
+      }
+      if (p) {
+         p += 8;
+         p_bdb_sv->majorversion = (int) strtol(p, NULL, 10);
+         p = strstr(p, ".");
+         if (p) {
+            p ++;
+            p_bdb_sv->minorversion = (int) strtol(p, NULL, 10);
+            p = strstr(p, ".");
+            if (p) {
+               p ++;
+               p_bdb_sv->dbx_build = (int) strtol(p, NULL, 10);
+            }
+         }
+      }
+   }
+
+   p_bdb_sv->vnumber = ((p_bdb_sv->majorversion * 100000) + (p_bdb_sv->minorversion * 10000) + p_bdb_sv->dbx_build);
+   
+   return CACHE_SUCCESS;
+}
+
+
+int bdb_next(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
+{
+   int rc, n, mkeyn, fixed_comp;
+   DBXCON *pcon = pmeth->pcon;
+   DBT key, key0, data;
+   DBC *pcursor;
+   DBXVAL mkey;
+
+/*
+   printf("\r\n ******* bdb_next ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p;\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr);
+*/
+   memset(&key, 0, sizeof(DBT));
+   memset(&key0, 0, sizeof(DBT));
+   memset(&data, 0, sizeof(DBT));
+   key.flags = DB_DBT_USERMEM;
+   key0.flags = DB_DBT_USERMEM;
+   data.flags = DB_DBT_USERMEM;
+
+   pcursor = NULL;
+   if (context == 0) {
+      if (DBX_BDB_PDB(pmeth) && !DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 */
+         rc = DBX_BDB_PDB(pmeth)->cursor(DBX_BDB_PDB(pmeth), NULL, &pcursor, 0);
+      }
+   }
+   else {
+     pcursor = pmeth->pbdbcursor;
+   }
+   if (!pcursor) { /* v1.3.15 global does not exist */
+      pkeyval->svalue.len_used = 0;
+      return YDB_NODE_END;
+   }
+
+   if (pcon->key_type == DBX_KEYTYPE_INT) {
+      key0.data = &(pkey->args[0].num.int32);
+      key0.size = sizeof(pkey->args[0].num.int32);
+      key0.ulen = sizeof(pkey->args[0].num.int32);
+
+      pkeyval->num.int32 = pkey->args[0].num.int32;
+      key.data = &(pkeyval->num.int32);
+      key.size = sizeof(pkeyval->num.int32);
+      key.ulen = sizeof(pkeyval->num.int32);
+      if (pkey->args[0].svalue.len_used == 0) {
+         key.size = 0;
+         key0.size = 0;
+      }
+   }
+   else if (pcon->key_type == DBX_KEYTYPE_STR) {
+      key0.data = pkey->args[0].svalue.buf_addr;
+      key0.size = pkey->args[0].svalue.len_used;
+      key0.ulen = pkey->args[0].svalue.len_alloc;
+
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
+      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
+      key.data = (void *) pkeyval->svalue.buf_addr;
+      key.size = (u_int32_t) pkeyval->svalue.len_used;
+      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+   }
+   else { /* mumps */
+      key0.data = (void *) pkey->ibuffer.buf_addr;
+      key0.size = (u_int32_t) pkey->ibuffer.len_used;
+      key0.ulen = (u_int32_t) pkey->ibuffer.len_alloc;
+
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
+      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
+      key.data = (void *) pkeyval->svalue.buf_addr;
+      key.size = (u_int32_t) pkeyval->svalue.len_used;
+      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+   }
+
+   data.data = (void *) pdataval->svalue.buf_addr;
+   data.ulen = (u_int32_t) pdataval->svalue.len_alloc;
+
+   rc = YDB_NODE_END;
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+/*
+      printf("\r\nstarting from ...");
+      dbx_dump_key((char *) key0.data, (int) key0.size);
+*/
+      pkeyval->svalue.len_used = 0;
+      fixed_comp = 0;
+
+      for (n = 0; n < 10; n ++) {
+/*
+         printf("\r\nDB_SET_RANGE (seed): fixed_comp=%d; pkey->argc=%d; key.size=%d", fixed_comp, pkey->argc, key.size);
+         dbx_dump_key((char *) key.data, (int) key.size);
+*/
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
+         if (rc != CACHE_SUCCESS) {
+            rc = YDB_NODE_END;
+            break;
+         }
+/*
+         printf("\r\nDB_SET_RANGE: rc=%d; pkey->argc=%d; key.size=%d", rc, pkey->argc, key.size);
+         dbx_dump_key((char *) key.data, (int) key.size);
+*/
+         if (rc != CACHE_SUCCESS) {
+            rc = YDB_NODE_END;
+            break;
+         }
+         if (*((unsigned char *) key.data) != 0x00) {
+            rc = YDB_NODE_END;
+            break;
+         }
+
+         /* dbx_dump_key((char *) key.data, (int) key.size); */
+
+         if (pkey->argc < 2)
+            fixed_comp = 0;
+         else
+            fixed_comp = bdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+
+         if (!fixed_comp) {
+            /* v1.3.17 locate the subscript at this level only: the fixed subscripts have already been matched */
+            mkeyn = dbx_key_subscript(&mkey, (char *) key.data, (int) key.size, (pkey->argc < 2) ? 0 : (int) pkey->args[pkey->argc - 2].csize);
+/*
+            printf("\r\nNext Record: pkey->argc=%d mkeyn=%d csize=%d; lens=%d:%d %s", pkey->argc, mkeyn, pkey->args[pkey->argc - 1].csize, pkey->args[pkey->argc - 1].svalue.len_used, mkey.svalue.len_used, mkey.svalue.buf_addr);
+*/
+
+            if (mkeyn != 0) { /* can't use data as it's under lower subscripts */
+               data.size = 0;
+            }
+
+            if (mkeyn >= 0) {
+               if (pkey->args[pkey->argc - 1].svalue.len_used == mkey.svalue.len_used && !memcmp((void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (void *) mkey.svalue.buf_addr, (size_t) mkey.svalue.len_used)) {
+                  /* current key returned - get next */
+                  *(((unsigned char *) key.data) + pkey->args[pkey->argc - 1].csize + 0) = 0x00;
+                  *(((unsigned char *) key.data) + pkey->args[pkey->argc - 1].csize + 1) = 0xff;
+
+                  key.size = (pkey->args[pkey->argc - 1].csize + 2);
+/*
+                  printf("\r\nAdvance Cursor: pkey->argc=%d; key.size=%d", pkey->argc, key.size);
+                  dbx_dump_key((char *) key.data, (int) key.size);
+*/
+                  continue;
+               }
+               else if (mkeyn == 0 && dbx_expired((char *) data.data, (size_t) data.size)) { /* v1.3.27 */
+                  /* expired but not yet swept: move on to the next record (a descendant keeps the subscript defined) */
+                  if (dbx_key_successor(&(pkeyval->svalue), (unsigned int) key.size) != CACHE_SUCCESS) {
+                     rc = YDB_NODE_END;
+                     break;
+                  }
+                  key.data = (void *) pkeyval->svalue.buf_addr;
+                  key.size = (u_int32_t) pkeyval->svalue.len_used;
+                  key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+                  n --;
+                  continue;
+               }
+               else {
+                  /* next key found */
+                  if (context == 0) {
+                     dbx_memcpy_ex(&(pkeyval->svalue), (void *) mkey.svalue.buf_addr, (size_t) mkey.svalue.len_used);
+                  }
+                  else {
+                     dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.data, (size_t) mkey.csize);
+                     pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
+                     dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
+                  }
+                  pdataval->svalue.len_used = (unsigned int) data.size;
+                  break;
+               }
+            }
+         }
+         else {
+            rc = YDB_NODE_END;
+            break;
+         }
+      }
+   }
+   else { /* not mumps */
+/*
+      printf("\r\nstarting from ...");
+      dbx_dump_key((char *) key.data, (int) key.size);
+*/
+
+      if (key.size == 0) {
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_FIRST); /* v1.3.9 */
+
+         if (rc == CACHE_SUCCESS)
+            pkeyval->svalue.len_used = key.size;
+         else {
+            pkeyval->svalue.len_used = 0;
+            rc = YDB_NODE_END;
+         }
+      }
+      else {
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
+/*
+         printf("\r\nAdvance Cursor (DB_SET_RANGE): rc=%d; key.size=%d", rc, key.size);
+         dbx_dump_key((char *) key.data, (int) key.size);
+*/
+         if (rc == CACHE_SUCCESS) {
+            pkeyval->svalue.len_used = key.size;
+            if (!bdb_key_compare(&key, &key0, 0, pcon->key_type)) {
+               rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_NEXT); /* v1.3.9 */
+/*
+               printf("\r\nAdvance Cursor (DB_NEXT): rc=%d; key.size=%d", rc, key.size);
+               dbx_dump_key((char *) key.data, (int) key.size);
+*/
+               if (rc == CACHE_SUCCESS)
+                  pkeyval->svalue.len_used = key.size;
+               else {
+                  pkeyval->svalue.len_used = 0;
+                  rc = YDB_NODE_END;
+               }
+            }
+            else {
+               pkeyval->svalue.len_used = key.size;
+            }
+         }
+         else {
+            pkeyval->svalue.len_used = 0;
+            rc = YDB_NODE_END;
+         }
+      }
+      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
+         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
+         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
+         pkeyval->type = DBX_DTYPE_INT;
+      }
+   }
+
+   if (context == 0) {
+      pcursor->close(pcursor); 
+   }
+
+   if (rc != CACHE_SUCCESS) {
+      pkeyval->svalue.len_used = 0;
+   }
+   if (pkeyval->svalue.len_used == 0) {
+      rc = YDB_NODE_END;
+   }
+
+   return rc;
+}
+
+
+int bdb_previous(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
+{
+   int rc, mkeyn, fixed_comp;
+   DBXCON *pcon = pmeth->pcon;
+   DBT key, key0, data;
+   DBC *pcursor;
+   DBXVAL mkey;
+/*
+   printf("\r\n ******* bdb_previous ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p; seed_len%d\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr, pkey->args[pkey->argc - 1].svalue.len_used);
+*/
+
+   memset(&key, 0, sizeof(DBT));
+   memset(&key0, 0, sizeof(DBT));
+   memset(&data, 0, sizeof(DBT));
+   key.flags = DB_DBT_USERMEM;
+   key0.flags = DB_DBT_USERMEM;
+   data.flags = DB_DBT_USERMEM;
+
+   pcursor = NULL;
+   if (context == 0) {
+      if (DBX_BDB_PDB(pmeth) && !DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 */
+         rc = DBX_BDB_PDB(pmeth)->cursor(DBX_BDB_PDB(pmeth), NULL, &pcursor, 0);
+      }
+   }
+   else {
+     pcursor = pmeth->pbdbcursor;
+   }
+   if (!pcursor) { /* v1.3.15 global does not exist */
+      pkeyval->svalue.len_used = 0;
+      return YDB_NODE_END;
+   }
+
+   if (pcon->key_type == DBX_KEYTYPE_INT) {
+      key0.data = &(pkey->args[0].num.int32);
+      key0.size = sizeof(pkey->args[0].num.int32);
+      key0.ulen = sizeof(pkey->args[0].num.int32);
+
+      pkeyval->num.int32 = pkey->args[0].num.int32;
+      key.data = &(pkeyval->num.int32);
+      key.size = sizeof(pkeyval->num.int32);
+      key.ulen = sizeof(pkeyval->num.int32);
+      if (pkey->args[0].svalue.len_used == 0) {
+         key.size = 0;
+         key0.size = 0;
+      }
+   }
+   else if (pcon->key_type == DBX_KEYTYPE_STR) {
+      key0.data = pkey->args[0].svalue.buf_addr;
+      key0.size = pkey->args[0].svalue.len_used;
+      key0.ulen = pkey->args[0].svalue.len_alloc;
+
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
+      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
+      key.data = (void *) pkeyval->svalue.buf_addr;
+      key.size = (u_int32_t) pkeyval->svalue.len_used;
+      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+   }
+   else { /* mumps */
+      key0.data = (void *) pkey->ibuffer.buf_addr;
+      key0.size = (u_int32_t) pkey->ibuffer.len_used;
+      key0.ulen = (u_int32_t) pkey->ibuffer.len_alloc;
+
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
+      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
+      key.data = (void *) pkeyval->svalue.buf_addr;
+      key.size = (u_int32_t) pkeyval->svalue.len_used;
+      key.ulen = (u_int32_t) pkeyval->svalue.len_alloc;
+   }
+
+   data.data = (void *) pdataval->svalue.buf_addr;
+   data.ulen = (u_int32_t) pdataval->svalue.len_alloc;
+
+   fixed_comp = 0;
+   rc = YDB_NODE_END;
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+/*
+      printf("\r\n seed ... pkey->ibuffer.len_used=%d", pkey->ibuffer.len_used);
+      dbx_dump_key((char *) key0.data, (int) key0.size);
+*/
+      pkeyval->svalue.len_used = 0;
+      if (pkey->argc < 2 && pkey->args[pkey->argc - 1].svalue.len_used == 0) { /* null seed - special case */
+
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
+         if (rc != CACHE_SUCCESS) {
+            rc = YDB_NODE_END;
+         }
+
+/*
+         printf("\r\n DB_LAST rc=%d; argc=%d; key.size=%d", rc, pkey->argc, (int) key.size);
+         dbx_dump_key((char *) key.data, (int) key.size);
+*/
+
+      }
+      else {
+
+         if (pkey->args[pkey->argc - 1].svalue.len_used == 0) {
+            *(((unsigned char *) key.data) + pkey->args[pkey->argc - 1].csize - 1) = 0xff;
+         }
+
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
+         if (rc != CACHE_SUCCESS) {
+            rc = YDB_NODE_END;
+         }
+
+/*
+         printf("\r\n DB_SET_RANGE rc=%d; argc=%d; key.size=%d", rc, pkey->argc, (int) key.size);
+         dbx_dump_key((char *) key.data, (int) key.size);
+*/
+         if (rc == CACHE_SUCCESS) {
+            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_PREV); /* v1.3.9 */
+            if (rc != CACHE_SUCCESS) {
+               rc = YDB_NODE_END;
+            }
+
+            if (rc == CACHE_SUCCESS) {
+               if (pkey->argc < 2)
+                  fixed_comp = 0;
+               else
+                  fixed_comp = bdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+            }
+/*
+            printf("\r\n DB_PREV rc=%d; argc=%d; key.size=%d; fixed_comp=%d;", rc, pkey->argc, (int) key.size, fixed_comp);
+            dbx_dump_key((char *) key.data, (int) key.size);
+*/
+         }
+         else { /* v1.2.7 */
+            /* printf("\r\n probably the last global in the database ..."); */
+            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
+            if (rc != CACHE_SUCCESS) {
+               rc = YDB_NODE_END;
+            }
+
+            if (rc == CACHE_SUCCESS) {
+               if (pkey->argc < 2)
+                  fixed_comp = 0;
+               else
+                  fixed_comp = bdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+            }
+/*
+            printf("\r\n DB_LAST rc=%d; argc=%d; key.size=%d; fixed_comp=%d;", rc, pkey->argc, (int) key.size, fixed_comp);
+            dbx_dump_key((char *) key.data, (int) key.size);
+*/
+         }
+      }
+      mkeyn = -1;
+      while (rc == CACHE_SUCCESS && !fixed_comp) {
+         /* v1.3.17 locate the subscript at this level only: the fixed subscripts have already been matched */
+         mkeyn = dbx_key_subscript(&mkey, (char *) key.data, (int) key.size, (pkey->argc < 2) ? 0 : (int) pkey->args[pkey->argc - 2].csize);
+         if (mkeyn != 0 || !dbx_expired((char *) data.data, (size_t) data.size)) {
+            break;
+         }
+         /* v1.3.27 expired but not yet swept (and with no descendants): move on to the previous record */
+         mkeyn = -1;
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_PREV);
+         if (rc != CACHE_SUCCESS) {
+            rc = YDB_NODE_END;
+         }
+         else if (pkey->argc >= 2) {
+            fixed_comp = bdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+         }
+      }
+      if (mkeyn >= 0) {
+
+         if (context == 0) {
+            dbx_memcpy_ex(&(pkeyval->svalue),  (void *) mkey.svalue.buf_addr,  (size_t) mkey.svalue.len_used);
+         }
+         else {
+            dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.data, (size_t) mkey.csize);
+            pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
+            dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
+         }
+         pdataval->svalue.len_used = (unsigned int) data.size;
+
+         if (mkeyn != 0) { /* can't use data as it's under lower subscripts */
+            data.size = 0;
+            pdataval->svalue.len_used = (unsigned int) data.size;
+         }
+
+      }
+      else {
+         pkeyval->svalue.len_used = 0;
+         rc = YDB_NODE_END;
+      }
+   }
+   else {
+      if (key.size == 0) {
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
+         if (rc != CACHE_SUCCESS) {
+            rc = YDB_NODE_END;
+         }
+
+         if (rc == CACHE_SUCCESS)
+            pkeyval->svalue.len_used = key.size;
+         else {
+            pkeyval->svalue.len_used = 0;
+            rc = YDB_NODE_END;
+         }
+      }
+      else {
+         rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_SET_RANGE); /* v1.3.9 */
+         if (rc != CACHE_SUCCESS) {
+            rc = YDB_NODE_END;
+         }
+
+         if (rc == CACHE_SUCCESS) {
+            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_PREV); /* v1.3.9 */
+            if (rc == CACHE_SUCCESS)
+               pkeyval->svalue.len_used = key.size;
+            else {
+               pkeyval->svalue.len_used = 0;
+               rc = YDB_NODE_END;
+            }
+         }
+         else {
+            rc = bdb_cursor_get(pcursor, &key, &(pkeyval->svalue), &data, &(pdataval->svalue), DB_LAST); /* v1.3.9 */
+            if (rc == CACHE_SUCCESS)
+               pkeyval->svalue.len_used = key.size;
+            else {
+               pkeyval->svalue.len_used = 0;
+               rc = YDB_NODE_END;
+            }
+         }
+      }
+      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
+         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
+         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
+         pkeyval->type = DBX_DTYPE_INT;
+      }
+   }
+
+   if (context == 0) {
+      pcursor->close(pcursor); 
+   }
+
+   if (rc != CACHE_SUCCESS) {
+      pkeyval->svalue.len_used = 0;
+   }
+
+   return rc;
+}
+
+
+int bdb_key_compare(DBT *key1, DBT *key2, int compare_max, short keytype)
+{
+   /* v1.3.18 */
+   return dbx_key_compare((char *) key1->data, (unsigned int) key1->size, (char *) key2->data, (unsigned int) key2->size, compare_max, keytype);
+}
+
+
+int bdb_get(DBXMETH *pmeth, DBT *key, DBT *data, DBXSTR *dbx_data)
+{
+   int rc;
+   DB *pdb;
+
+   pdb = DBX_BDB_PDB(pmeth); /* v1.3.15 */
+   if (!pdb) { /* global does not exist */
+      return DB_NOTFOUND;
+   }
+
+   rc = pdb->get(pdb, NULL, key, data, 0);
+   if (rc == DB_BUFFER_SMALL) { /* v1.3.9 */
+      rc = bdb_resize_buffer(NULL, NULL, data, dbx_data, 0);
+      if (rc == CACHE_SUCCESS) {
+         rc = pdb->get(pdb, NULL, key, data, 0);
+      }
+      else {
+         rc = CACHE_FAILURE;
+      }
+   }
+
+   return rc;
+}
+
+
+int bdb_cursor_get(DBC *pcursor, DBT *key, DBXSTR *dbx_key, DBT *data, DBXSTR *dbx_data, int context)
+{
+   int rc;
+
+   rc = pcursor->get(pcursor, key, data, context);
+   if (rc == DB_BUFFER_SMALL) { /* v1.3.9 */
+      rc = bdb_resize_buffer(key, dbx_key, data, dbx_data, 0);
+      if (rc == CACHE_SUCCESS) {
+         rc = pcursor->get(pcursor, key, data, context);
+      }
+      else {
+         rc = YDB_NODE_END;
+      }
+   }
+
+   return rc;
+}
+
+
+/* v1.3.9 */
+int bdb_resize_buffer(DBT *key, DBXSTR *dbx_key, DBT *data, DBXSTR *dbx_data, int context)
+{
+   if (key && (key->ulen < key->size)) {
+      if (!dbx_buffer_resize((char **) &(dbx_key->buf_addr), 0, (unsigned int) (key->size + 32), (unsigned int *) &(dbx_key->len_alloc))) {
+         return CACHE_FAILURE;
+      }
+      dbx_key->len_alloc = (unsigned int) (key->size + 32);
+      key->data = (void *) dbx_key->buf_addr;
+      key->ulen = (u_int32_t) dbx_key->len_alloc;
+   }
+   if (data && (data->ulen < data->size)) {
+      if (!dbx_buffer_resize((char **) &(dbx_data->buf_addr), 0, (unsigned int) (data->size + 32), (unsigned int *) &(dbx_data->len_alloc))) {
+         return CACHE_FAILURE;
+      }
+      dbx_data->len_alloc = (unsigned int) (data->size + 32);
+      data->data = (void *) dbx_data->buf_addr;
+      data->ulen = (u_int32_t) dbx_data->len_alloc;
+   }
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v1.3.10 */
+int bdb_error_message(DBXCON *pcon, int error_code)
+{
+   switch (error_code) {
+      case 0:
+         strcpy(pcon->error, "");
          break;
       case DB_BUFFER_SMALL:
          sprintf(pcon->error, "BDB error %d (DB_BUFFER_SMALL) User memory too small for return", error_code);
@@ -4602,1176 +6783,4957 @@ int bdb_error_message(DBXCON *pcon, int error_code)
       case DB_REP_INELECT:
          sprintf(pcon->error, "BDB error %d (DB_REP_INELECT) Replication is in an election", error_code);
          break;
-      case DB_REP_ISPERM:
-         sprintf(pcon->error, "BDB error %d (DB_REP_ISPERM) Cached not written; permanent written", error_code);
+      case DB_REP_ISPERM:
+         sprintf(pcon->error, "BDB error %d (DB_REP_ISPERM) Cached not written; permanent written", error_code);
+         break;
+      case DB_REP_JOIN_FAILURE:
+         sprintf(pcon->error, "BDB error %d (DB_REP_JOIN_FAILURE) Unable to join replication group", error_code);
+         break;
+      case DB_REP_LEASE_EXPIRED:
+         sprintf(pcon->error, "BDB error %d (DB_REP_LEASE_EXPIRED) Master lease has expired", error_code);
+         break;
+      case DB_REP_LOCKOUT:
+         sprintf(pcon->error, "BDB error %d (DB_REP_LOCKOUT) API/Replication lockout now", error_code);
+         break;
+      case DB_REP_NEWSITE:
+         sprintf(pcon->error, "BDB error %d (DB_REP_NEWSITE) New site entered system", error_code);
+         break;
+      case DB_REP_NOTPERM:
+         sprintf(pcon->error, "BDB error %d (DB_REP_NOTPERM) Permanent log record not written", error_code);
+         break;
+      case DB_REP_UNAVAIL:
+         sprintf(pcon->error, "BDB error %d (DB_REP_UNAVAIL) Site cannot currently be reached", error_code);
+         break;
+      case DB_REP_WOULDROLLBACK:
+         sprintf(pcon->error, "BDB error %d (DB_REP_WOULDROLLBACK) UNDOC: rollback inhibited by app", error_code);
+         break;
+      case DB_RUNRECOVERY:
+         sprintf(pcon->error, "BDB error %d (DB_RUNRECOVERY) Panic return", error_code);
+         break;
+      case DB_SECONDARY_BAD:
+         sprintf(pcon->error, "BDB error %d (DB_SECONDARY_BAD) Secondary index corrupt", error_code);
+         break;
+      case DB_SLICE_CORRUPT:
+         sprintf(pcon->error, "BDB error %d (DB_SLICE_CORRUPT) A part of a sliced ENV is corrupt", error_code);
+         break;
+      case DB_TIMEOUT:
+         sprintf(pcon->error, "BDB error %d (DB_TIMEOUT) Timed out on read consistency", error_code);
+         break;
+      case DB_VERIFY_BAD:
+         sprintf(pcon->error, "BDB error %d (DB_VERIFY_BAD) Verify failed; bad format", error_code);
+         break;
+      case DB_VERSION_MISMATCH:
+         sprintf(pcon->error, "BDB error %d (DB_VERSION_MISMATCH) Environment version mismatch", error_code);
+         break;
+      case DB_SYSTEM_MEM_MISSING:
+         sprintf(pcon->error, "BDB error %d (DB_SYSTEM_MEM_MISSING) Attach to shared memory failed", error_code);
+         break;
+      case DB_ALREADY_ABORTED:
+         sprintf(pcon->error, "BDB error %d (DB_ALREADY_ABORTED) Transaction aborted", error_code);
+         break;
+      case DB_DELETED:
+         sprintf(pcon->error, "BDB error %d (DB_DELETED) Recovery file marked deleted", error_code);
+         break;
+      case DB_EVENT_NOT_HANDLED:
+         sprintf(pcon->error, "BDB error %d (DB_EVENT_NOT_HANDLED) Forward event to application", error_code);
+         break;
+      case DB_NEEDSPLIT:
+         sprintf(pcon->error, "BDB error %d (DB_NEEDSPLIT) Page needs to be split", error_code);
+         break;
+      case DB_NOINTMP:
+         sprintf(pcon->error, "BDB error %d (DB_NOINTMP) Sequences not supported in temporary or in-memory databases", error_code);
+         break;
+      case DB_REP_BULKOVF:
+         sprintf(pcon->error, "BDB error %d (DB_REP_BULKOVF) Rep bulk buffer overflow", error_code);
+         break;
+      case DB_REP_LOGREADY:
+         sprintf(pcon->error, "BDB error %d (DB_REP_LOGREADY) Rep log ready for recovery", error_code);
+         break;
+      case DB_REP_NEWMASTER:
+         sprintf(pcon->error, "BDB error %d (DB_REP_NEWMASTER) We have learned of a new master", error_code);
+         break;
+      case DB_REP_PAGEDONE:
+         sprintf(pcon->error, "BDB error %d (DB_REP_PAGEDONE) This page was already done", error_code);
+         break;
+      case DB_SURPRISE_KID:
+         sprintf(pcon->error, "BDB error %d (DB_SURPRISE_KID) Child commit where parent didn't know it was a parent", error_code);
+         break;
+      case DB_SWAPBYTES:
+         sprintf(pcon->error, "BDB error %d (DB_SWAPBYTES) Database needs byte swapping", error_code);
+         break;
+      case DB_TXN_CKP:
+         sprintf(pcon->error, "BDB error %d (DB_TXN_CKP) Encountered ckp record in log.", error_code);
+         break;
+      case DB_VERIFY_FATAL:
+         sprintf(pcon->error, "BDB error %d (DB_VERIFY_FATAL) DB->verify cannot proceed", error_code);
+         break;
+      case CACHE_NOCON:
+         sprintf(pcon->error, "BDB error %d (DB_UNAVAILABLE) DB unavailable - check installation", error_code);
+         break;
+      case DBX_GDB_FULL: /* v1.3.15 the message was set by dbx_global_db() */
+         break;
+      default:
+         sprintf(pcon->error, "BDB error %d (DB_UNKNOWN) Unknown error condition", error_code);
+         break;
+   }
+
+   return 0;
+}
+
+
+int lmdb_load_library(DBXCON *pcon)
+{
+   int result;
+   char primerr[DBX_ERROR_SIZE];
+   char fun[64];
+
+   strcpy(pcon->p_lmdb_so->libdir, pcon->db_library);
+   strcpy(pcon->p_lmdb_so->funprfx, "mdb");
+   strcpy(pcon->p_lmdb_so->dbname, "LMDB");
+
+   strcpy(pcon->p_lmdb_so->libnam, pcon->p_lmdb_so->libdir);
+
+   pcon->p_lmdb_so->p_library = dbx_dso_load(pcon->p_lmdb_so->libnam);
+   if (!pcon->p_lmdb_so->p_library) {
+      int len1, len2;
+      char *p;
+#if defined(_WIN32)
+      DWORD errorcode;
+      LPVOID lpMsgBuf;
+
+      lpMsgBuf = NULL;
+      errorcode = GetLastError();
+      sprintf(pcon->error, "Error loading %s Library: %s; Error Code : %ld",  pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, errorcode);
+      len2 = (int) strlen(pcon->error);
+      len1 = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+                     NULL,
+                     errorcode,
+                     /* MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), */
+                     MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
+                     (LPTSTR) &lpMsgBuf,
+                     0,
+                     NULL 
+                     );
+      if (lpMsgBuf && len1 > 0 && (DBX_ERROR_SIZE - len2) > 30) {
+         strncpy(primerr, (const char *) lpMsgBuf, DBX_ERROR_SIZE - 1);
+         p = strstr(primerr, "\r\n");
+         if (p)
+            *p = '\0';
+         len1 = (DBX_ERROR_SIZE - (len2 + 10));
+         if (len1 < 1)
+            len1 = 0;
+         primerr[len1] = '\0';
+         p = strstr(primerr, "%1");
+         if (p) {
+            *p = 'I';
+            *(p + 1) = 't';
+         }
+         strcat(pcon->error, " (");
+         strcat(pcon->error, primerr);
+         strcat(pcon->error, ")");
+      }
+      if (lpMsgBuf)
+         LocalFree(lpMsgBuf);
+#else
+      p = (char *) dlerror();
+      sprintf(primerr, "Cannot load %s library: Error Code: %d", pcon->p_lmdb_so->dbname, errno);
+      len2 = strlen(pcon->error);
+      if (p) {
+         strncpy(primerr, p, DBX_ERROR_SIZE - 1);
+         primerr[DBX_ERROR_SIZE - 1] = '\0';
+         len1 = (DBX_ERROR_SIZE - (len2 + 10));
+         if (len1 < 1)
+            len1 = 0;
+         primerr[len1] = '\0';
+         strcat(pcon->error, " (");
+         strcat(pcon->error, primerr);
+         strcat(pcon->error, ")");
+      }
+#endif
+      goto lmdb_load_library_exit;
+   }
+
+   sprintf(fun, "%s_env_create", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_create = (int (*) (MDB_env **)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_create) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_env_open", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_open = (int (*) (MDB_env *, const char *, unsigned int, mdb_mode_t)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_open) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_env_close", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_close = (void (*) (MDB_env *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_close) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_env_set_maxdbs", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_set_maxdbs = (int (*) (MDB_env *, MDB_dbi)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_set_maxdbs) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+
+   sprintf(fun, "%s_env_set_mapsize", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_set_mapsize = (int (*) (MDB_env *, size_t)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_set_mapsize) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_env_stat", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_stat = (int (*) (MDB_env *, MDB_stat *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_stat) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_env_info", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_info = (int (*) (MDB_env *, MDB_envinfo *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_info) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_env_sync", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_env_sync = (int (*) (MDB_env *, int)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_env_sync) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   /* v1.3.34 only used for engine_stats(): the library can be used without them */
+   sprintf(fun, "%s_stat", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_stat = (int (*) (MDB_txn *, MDB_dbi, MDB_stat *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   sprintf(fun, "%s_reader_list", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_reader_list = (int (*) (MDB_env *, MDB_msg_func *, void *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+
+   sprintf(fun, "%s_txn_begin", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_txn_begin = (int (*) (MDB_env *, MDB_txn *, unsigned int, MDB_txn **)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_txn_begin) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_txn_commit", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_txn_commit = (int (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_txn_commit) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_txn_abort", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_txn_abort = (void (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_txn_abort) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_txn_reset", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_txn_reset = (void (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_txn_reset) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_txn_renew", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_txn_renew = (void (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_txn_renew) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+
+   sprintf(fun, "%s_dbi_open", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_dbi_open = (int (*) (MDB_txn *, const char *, unsigned int, MDB_dbi *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_dbi_open) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_dbi_close", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_dbi_close = (void (*) (MDB_env *, MDB_dbi)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_dbi_close) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+
+   /* v1.3.15 */
+   sprintf(fun, "%s_drop", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_drop = (int (*) (MDB_txn *, MDB_dbi, int)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_drop) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+
+   sprintf(fun, "%s_put", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_put = (int (*) (MDB_txn *, MDB_dbi, MDB_val *, MDB_val *, unsigned int)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_put) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_get", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_get = (int (*) (MDB_txn *, MDB_dbi, MDB_val *, MDB_val *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_get) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_del", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_del = (int (*) (MDB_txn *, MDB_dbi, MDB_val *, MDB_val *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_del) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+
+   sprintf(fun, "%s_cursor_open", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_cursor_open = (int (*) (MDB_txn *, MDB_dbi, MDB_cursor **)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_cursor_open) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_cursor_close", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_cursor_close = (void (*) (MDB_cursor *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_cursor_close) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_cursor_renew", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_cursor_renew = (int (*) (MDB_txn *, MDB_cursor *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_cursor_renew) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_cursor_get", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_cursor_get = (int (*) (MDB_cursor *, MDB_val *, MDB_val *, MDB_cursor_op)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_cursor_get) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+
+   sprintf(fun, "%s_strerror", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_strerror = (char * (*) (int)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_strerror) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+   sprintf(fun, "%s_version", pcon->p_lmdb_so->funprfx);
+   pcon->p_lmdb_so->p_mdb_version = (char * (*) (int *, int *, int *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
+   if (!pcon->p_lmdb_so->p_mdb_version) {
+      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
+      goto lmdb_load_library_exit;
+   }
+
+   pcon->p_lmdb_so->loaded = 1;
+
+lmdb_load_library_exit:
+
+   if (pcon->error[0]) {
+      pcon->p_lmdb_so->loaded = 0;
+      pcon->error_code = 1009;
+      result = CACHE_NOCON;
+
+      return result;
+   }
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v1.3.39 Bind the LMDB interface to the in-memory engine (mg-memdb.cpp) */
+int memdb_load_library(DBXCON *pcon)
+{
+   strcpy(pcon->p_lmdb_so->libdir, "");
+   strcpy(pcon->p_lmdb_so->funprfx, "memdb");
+   strcpy(pcon->p_lmdb_so->dbname, "MEM");
+   strcpy(pcon->p_lmdb_so->libnam, "");
+   pcon->p_lmdb_so->p_library = NULL;
+
+   pcon->p_lmdb_so->p_mdb_env_create = memdb_env_create;
+   pcon->p_lmdb_so->p_mdb_env_open = memdb_env_open;
+   pcon->p_lmdb_so->p_mdb_env_close = memdb_env_close;
+   pcon->p_lmdb_so->p_mdb_env_set_maxdbs = memdb_env_set_maxdbs;
+   pcon->p_lmdb_so->p_mdb_env_set_mapsize = memdb_env_set_mapsize;
+   pcon->p_lmdb_so->p_mdb_env_stat = memdb_env_stat;
+   pcon->p_lmdb_so->p_mdb_env_info = memdb_env_info;
+   pcon->p_lmdb_so->p_mdb_env_sync = memdb_env_sync;
+   pcon->p_lmdb_so->p_mdb_stat = memdb_stat;
+   pcon->p_lmdb_so->p_mdb_reader_list = memdb_reader_list;
+
+   pcon->p_lmdb_so->p_mdb_txn_begin = memdb_txn_begin;
+   pcon->p_lmdb_so->p_mdb_txn_commit = memdb_txn_commit;
+   pcon->p_lmdb_so->p_mdb_txn_abort = memdb_txn_abort;
+   pcon->p_lmdb_so->p_mdb_txn_reset = memdb_txn_reset;
+   pcon->p_lmdb_so->p_mdb_txn_renew = memdb_txn_renew;
+
+   pcon->p_lmdb_so->p_mdb_dbi_open = memdb_dbi_open;
+   pcon->p_lmdb_so->p_mdb_dbi_close = memdb_dbi_close;
+   pcon->p_lmdb_so->p_mdb_drop = memdb_drop;
+
+   pcon->p_lmdb_so->p_mdb_put = memdb_put;
+   pcon->p_lmdb_so->p_mdb_get = memdb_get;
+   pcon->p_lmdb_so->p_mdb_del = memdb_del;
+
+   pcon->p_lmdb_so->p_mdb_cursor_open = memdb_cursor_open;
+   pcon->p_lmdb_so->p_mdb_cursor_close = memdb_cursor_close;
+   pcon->p_lmdb_so->p_mdb_cursor_renew = memdb_cursor_renew;
+   pcon->p_lmdb_so->p_mdb_cursor_get = memdb_cursor_get;
+
+   pcon->p_lmdb_so->p_mdb_strerror = memdb_strerror;
+   pcon->p_lmdb_so->p_mdb_version = memdb_version;
+
+   pcon->p_lmdb_so->loaded = 1;
+
+   return CACHE_SUCCESS;
+}
+
+
+int lmdb_open(DBXMETH *pmeth)
+{
+   int rc, n, result;
+   unsigned int env_flags;
+   char *pver;
+   size_t db_size;
+   MDB_stat stat;
+   DBXCON *pcon = pmeth->pcon;
+
+   if (!pcon->p_lmdb_so) {
+      pcon->p_lmdb_so = (DBXLMDBSO *) dbx_malloc(sizeof(DBXLMDBSO), DBX_MEMID_ENGINE);
+      if (!pcon->p_lmdb_so) {
+         T_STRCPY(pcon->error, _dbxso(pcon->error), "No Memory");
+         pcon->error_code = 1009; 
+         result = CACHE_NOCON;
+         return result;
+      }
+      memset((void *) pcon->p_lmdb_so, 0, sizeof(DBXLMDBSO));
+      pcon->p_lmdb_so->pdb = NULL;
+      pcon->p_lmdb_so->penv = NULL;
+      pcon->p_lmdb_so->loaded = 0;
+      pcon->p_lmdb_so->no_connections = 0;
+      pcon->p_lmdb_so->multiple_connections = 0;
+      pcon->p_zv = &(pcon->p_lmdb_so->zv);
+   }
+
+   if (pcon->p_lmdb_so->loaded == 2) {
+      strcpy(pcon->error, "Cannot create multiple connections to the database");
+      pcon->error_code = 1009; 
+      strcpy((char *) pmeth->output_val.svalue.buf_addr, "0");
+      rc = CACHE_NOCON;
+      goto lmdb_open_exit;
+   }
+
+   if (!pcon->p_lmdb_so->loaded) {
+      if (pcon->memdb)
+         rc = memdb_load_library(pcon);
+      else
+         rc = lmdb_load_library(pcon);
+      if (rc != CACHE_SUCCESS) {
+         goto lmdb_open_exit;
+      }
+   }
+
+   pver = pcon->p_lmdb_so->p_mdb_version(&(pcon->p_zv->majorversion), &(pcon->p_zv->minorversion), &(pcon->p_zv->patch));
+
+   pcon->p_zv->dbtype = (unsigned char) pcon->dbtype;
+/*
+   printf("\r\n pver=%s; pcon->p_zv->majorversion=%d; pcon->p_zv->minorversion=%d; pcon->p_zv->patch=%d;", pver, pcon->p_zv->majorversion, pcon->p_zv->minorversion, pcon->p_zv->patch);
+*/
+   if (pver) {
+      rc = CACHE_SUCCESS;
+      strcpy(pcon->p_zv->db_version, pver);
+      lmdb_parse_zv(pcon->p_zv->db_version, pcon->p_zv);
+      if (pcon->p_zv->dbx_build)
+         sprintf(pcon->p_zv->version, "%d.%d.b%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion, pcon->p_zv->dbx_build);
+      else
+         sprintf(pcon->p_zv->version, "%d.%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion);
+   }
+   else {
+      rc = CACHE_FAILURE;
+   }
+
+   /* v1.1.4 */
+   pcon->p_lmdb_so->penv = NULL;
+   rc = pcon->p_lmdb_so->p_mdb_env_create(&(pcon->p_lmdb_so->penv));
+   if (rc != 0) {
+      /* Error handling goes here */
+      strcpy(pcon->error, "Cannot create a LMDB environment object");
+      goto lmdb_open_exit;
+   }
+
+   /* v1.3.15 */
+   pcon->p_lmdb_so->global_dbs = 0;
+   pcon->p_lmdb_so->max_dbs = pcon->max_dbs;
+   pcon->p_lmdb_so->gdb_count = 0;
+   if (pcon->global_dbs && pcon->key_type == DBX_KEYTYPE_M) {
+      pcon->p_lmdb_so->global_dbs = 1;
+      if (pcon->p_lmdb_so->max_dbs < 1) {
+         pcon->p_lmdb_so->max_dbs = DBX_MAX_GLOBAL_DBS;
+      }
+      pcon->p_lmdb_so->p_gdb = dbx_global_db_table(pcon->p_lmdb_so->max_dbs, &(pcon->p_lmdb_so->p_gdb_hash), &(pcon->p_lmdb_so->gdb_hash_mask));
+      if (!pcon->p_lmdb_so->p_gdb) {
+         strcpy(pcon->error, "No Memory");
+         rc = CACHE_NOCON;
+         goto lmdb_open_exit;
+      }
+   }
+   else if (pcon->db_file[0] && pcon->p_lmdb_so->max_dbs < 1) {
+      pcon->p_lmdb_so->max_dbs = DBX_MAX_DBS;
+   }
+   pcon->global_dbs = pcon->p_lmdb_so->global_dbs;
+
+   if (pcon->p_lmdb_so->max_dbs > 0) {
+      rc = pcon->p_lmdb_so->p_mdb_env_set_maxdbs(pcon->p_lmdb_so->penv, (MDB_dbi) pcon->p_lmdb_so->max_dbs);
+      if (rc != 0) {
+         /* Error handling goes here */
+         strcpy(pcon->error, "Cannot set the maximum number of databases in the LMDB environment");
+         goto lmdb_open_exit;
+      }
+   }
+
+   /* v1.3.29 durability and mapping flags */
+   env_flags = MDB_NOTLS;
+   if (pcon->sync_mode == DBX_SYNC_NONE) {
+      env_flags |= MDB_NOSYNC;
+   }
+   else if (pcon->sync_mode == DBX_SYNC_META) {
+      env_flags |= MDB_NOMETASYNC;
+   }
+   if (pcon->writemap) {
+      env_flags |= MDB_WRITEMAP;
+   }
+   if (!pcon->readahead) {
+      env_flags |= MDB_NORDAHEAD;
+   }
+
+   rc = pcon->p_lmdb_so->p_mdb_env_open(pcon->p_lmdb_so->penv, pcon->env_dir, env_flags, 0664);
+   if (rc != 0) {
+      /* Error handling goes here */
+      strcpy(pcon->error, "Cannot create or open a LMDB environment");
+      goto lmdb_open_exit;
+   }
+
+   rc = pcon->p_lmdb_so->p_mdb_env_stat(pcon->p_lmdb_so->penv, &stat);
+   if (rc != 0) {
+      /* Error handling goes here */
+      strcpy(pcon->error, "Cannot obtain the statistics for the LMDB environment");
+      goto lmdb_open_exit;
+   }
+
+   /* v1.3.9 */
+   if (pcon->db_size < 20000000) {
+      pcon->db_size = DBX_DB_SIZE;
+   }
+   if (stat.ms_psize < 1) {
+      stat.ms_psize = 4096;
+   }
+   for (n = (int) (pcon->db_size / stat.ms_psize); ; n ++) {
+      db_size = (size_t) (stat.ms_psize * n);
+      if (db_size > pcon->db_size) {
+         break;
+      }
+   }
+/*
+   printf("\r\n LMDB environment stats: rc=%d; psize=%d; db_size=%ld; n=%d; pcon->db_size=%ld;", rc, (int) stat.ms_psize, db_size, n, pcon->db_size);
+*/
+   rc = pcon->p_lmdb_so->p_mdb_env_set_mapsize(pcon->p_lmdb_so->penv, db_size);
+/*
+   printf("\r\n LMDB environment set size: rc=%d; psize=%ld\r\n", rc, db_size);
+*/
+
+   pcon->p_lmdb_so->ptxnro = NULL; /* read only transaction */
+   rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+   if (rc != 0) {
+      /* Error handling goes here */
+      strcpy(pcon->error, "Cannot create or open a LMDB transaction");
+      goto lmdb_open_exit;
+   }
+   pcon->tlevel ++;
+
+   pcon->p_lmdb_so->pdb = &(pcon->p_lmdb_so->db);
+   if (pcon->global_dbs) { /* v1.3.15 the main (unnamed) database holds the directory of globals */
+      rc = pcon->p_lmdb_so->p_mdb_dbi_open(pcon->p_lmdb_so->ptxn, NULL, 0, pcon->p_lmdb_so->pdb);
+   }
+   else if (pcon->db_file[0]) {
+      rc = pcon->p_lmdb_so->p_mdb_dbi_open(pcon->p_lmdb_so->ptxn, pcon->db_file, MDB_CREATE, pcon->p_lmdb_so->pdb);
+   }
+   else {
+      rc = pcon->p_lmdb_so->p_mdb_dbi_open(pcon->p_lmdb_so->ptxn, NULL, 0, pcon->p_lmdb_so->pdb);
+   }
+   if (rc != 0) {
+      /* Error handling goes here */
+      strcpy(pcon->error, "Cannot create or open a LMDB database");
+      goto lmdb_open_exit;
+   }
+   pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+   pcon->tlevel --;
+
+lmdb_open_exit:
+
+   if (rc == CACHE_SUCCESS) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
+   }
+   else {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) pcon->error, DBX_DTYPE_STR8);
+   }
+
+   return rc;
+}
+
+
+int lmdb_parse_zv(char *zv, DBXZV * p_lmdb_sv)
+{
+   char *p;
+
+   p_lmdb_sv->dbx_build = p_lmdb_sv->patch;
+   p_lmdb_sv->vnumber = 0;
+
+   if (p_lmdb_sv->majorversion == 0 || p_lmdb_sv->minorversion == 0) {
+      p = strstr(zv, "LMDB ");
+      if (p) {
+         p += 5;
+      }
+      else {
+         p = strstr(zv, "version ");
+         if (p) {
+            p += 8;
+         }
+      }
+      if (p) {
+         p_lmdb_sv->majorversion = (int) strtol(p, NULL, 10);
+         p = strstr(p, ".");
+         if (p) {
+            p ++;
+            p_lmdb_sv->minorversion = (int) strtol(p, NULL, 10);
+            p = strstr(p, ".");
+            if (p) {
+               p ++;
+               p_lmdb_sv->dbx_build = (int) strtol(p, NULL, 10);
+            }
+         }
+      }
+   }
+
+   p_lmdb_sv->vnumber = ((p_lmdb_sv->majorversion * 100000) + (p_lmdb_sv->minorversion * 10000) + p_lmdb_sv->dbx_build);
+   
+   return CACHE_SUCCESS;
+}
+
+
+int lmdb_start_ro_transaction(DBXMETH *pmeth, int context)
+{
+   int rc;
+
+   rc = 0;
+   if (pmeth->pcon->tlevelro) {
+      rc = 0;
+   }
+   else {
+      if (pmeth->pcon->tstatusro == 1) {
+         pmeth->pcon->p_lmdb_so->p_mdb_txn_renew(pmeth->pcon->p_lmdb_so->ptxnro);
+         pmeth->pcon->tstatusro = 0;
+      }
+      else {
+         rc = pmeth->pcon->p_lmdb_so->p_mdb_txn_begin(pmeth->pcon->p_lmdb_so->penv, NULL, MDB_RDONLY, &(pmeth->pcon->p_lmdb_so->ptxnro));
+      }
+   }
+   pmeth->pcon->tlevelro ++;
+
+   return rc;
+}
+
+
+int lmdb_commit_ro_transaction(DBXMETH *pmeth, int context)
+{
+   int rc;
+
+   rc = 0;
+
+   if (pmeth->pcon->tlevelro > 1) {
+      rc = 0;
+   }
+   else {
+      /* pmeth->pcon->p_lmdb_so->p_mdb_txn_abort(pmeth->pcon->p_lmdb_so->ptxnro); */
+      pmeth->pcon->p_lmdb_so->p_mdb_txn_reset(pmeth->pcon->p_lmdb_so->ptxnro);
+      pmeth->pcon->tstatusro = 1;
+   }
+   pmeth->pcon->tlevelro --;
+
+   return rc;
+}
+
+
+int lmdb_start_qro_transaction(DBXMETH *pmeth, MDB_txn **ptxn, int context)
+{
+   int rc;
+
+   rc = lmdb_start_ro_transaction(pmeth, context);
+   *ptxn = pmeth->pcon->p_lmdb_so->ptxnro;
+
+   return rc;
+}
+
+
+int lmdb_commit_qro_transaction(DBXMETH *pmeth, MDB_txn **ptxn, int context)
+{
+   int rc;
+
+   rc = lmdb_commit_ro_transaction(pmeth, context);
+
+   return rc;
+}
+
+
+/* v1.3.20 */
+int lmdb_view_snapshot(DBXMETH *pmeth, DBXSNAP **ppsnap)
+{
+   int rc;
+   DBXCON *pcon = pmeth->pcon;
+   DBXSNAP *psnap;
+   MDB_envinfo info;
+
+   *ppsnap = NULL;
+
+   /* The most recent snapshot is shared for as long as no write has been committed since it was taken */
+   rc = pcon->p_lmdb_so->p_mdb_env_info(pcon->p_lmdb_so->penv, &info);
+   if (rc != CACHE_SUCCESS) {
+      return rc;
+   }
+   psnap = pcon->psnap;
+   if (psnap && psnap->ptxn && psnap->txnid == info.me_last_txnid) {
+      *ppsnap = psnap;
+      return CACHE_SUCCESS;
+   }
+
+   psnap = (DBXSNAP *) dbx_malloc(sizeof(DBXSNAP), DBX_MEMID_ENGINE);
+   if (!psnap) {
+      return CACHE_NOCON;
+   }
+   memset((void *) psnap, 0, sizeof(DBXSNAP));
+
+   /* info is read before the transaction begins so the snapshot is never older than txnid */
+   rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, MDB_RDONLY, &(psnap->ptxn));
+   if (rc != CACHE_SUCCESS) {
+      dbx_free((void *) psnap, 0);
+      return rc;
+   }
+   psnap->txnid = info.me_last_txnid;
+   psnap->pcon = pcon;
+   psnap->pnext = pcon->psnap;
+   pcon->psnap = psnap;
+
+   *ppsnap = psnap;
+   return CACHE_SUCCESS;
+}
+
+
+/* v1.3.20 Buffer free callback: drop one reference and end the snapshot when it is no longer used */
+void lmdb_view_release(char *data, void *hint)
+{
+   DBXSNAP *psnap, *pprev;
+   DBXCON *pcon;
+
+   psnap = (DBXSNAP *) hint;
+   if (!psnap) {
+      return;
+   }
+
+   psnap->refs --;
+   if (psnap->refs > 0) {
+      return;
+   }
+
+   pcon = psnap->pcon;
+   if (pcon) {
+      if (pcon->psnap == psnap) {
+         pcon->psnap = psnap->pnext;
+      }
+      else {
+         for (pprev = pcon->psnap; pprev; pprev = pprev->pnext) {
+            if (pprev->pnext == psnap) {
+               pprev->pnext = psnap->pnext;
+               break;
+            }
+         }
+      }
+      if (psnap->ptxn && pcon->p_lmdb_so) {
+         pcon->p_lmdb_so->p_mdb_txn_abort(psnap->ptxn);
+      }
+   }
+   dbx_free((void *) psnap, 0);
+
+   return;
+}
+
+
+/* v1.3.20 Buffer free callback for get_view(): forget the buffer and drop its reference to the snapshot */
+void lmdb_view_free(char *data, void *hint)
+{
+   DBXVIEW *pview, *pprev;
+   DBXSNAP *psnap;
+
+   pview = (DBXVIEW *) hint;
+   if (!pview) {
+      return;
+   }
+
+   psnap = pview->psnap;
+   if (psnap->pview == pview) {
+      psnap->pview = pview->pnext;
+   }
+   else {
+      for (pprev = psnap->pview; pprev; pprev = pprev->pnext) {
+         if (pprev->pnext == pview) {
+            pprev->pnext = pview->pnext;
+            break;
+         }
+      }
+   }
+   if (pview->pab) {
+      pview->pab->Reset();
+      delete pview->pab;
+   }
+   dbx_free((void *) pview, 0);
+
+   lmdb_view_release(data, (void *) psnap);
+
+   return;
+}
+
+
+/* v1.3.20 Detach the buffers returned by get_view() that JavaScript still holds: they point into the map, which close() unmaps */
+int lmdb_view_detach(v8::Isolate * isolate, DBXCON *pcon)
+{
+   int n;
+   DBXSNAP *psnap;
+   DBXVIEW *pview;
+   v8::Local<v8::ArrayBuffer> ab;
+
+   n = 0;
+   for (psnap = pcon->psnap; psnap; psnap = psnap->pnext) {
+      for (pview = psnap->pview; pview; pview = pview->pnext) {
+         if (!pview->pab || pview->pab->IsEmpty()) {
+            continue; /* already collected */
+         }
+         ab = pview->pab->Get(isolate);
+         if (ab->IsDetachable() && !ab->WasDetached()) {
+#if DBX_NODE_VERSION >= 200000
+            if (ab->Detach(v8::Local<v8::Value>()).IsNothing()) {
+               continue;
+            }
+#else
+            ab->Detach();
+#endif
+            n ++;
+         }
+      }
+   }
+
+   return n;
+}
+
+
+/* v1.3.28 Grow the memory map after MDB_MAP_FULL (or adopt the size set by another process after MDB_MAP_RESIZED) */
+/* the map is remapped, so this is only possible while the connection has no transaction, cursor or view open */
+/* v1.3.28 and while no other connection shares the environment: their transactions and views cannot be seen from here */
+int lmdb_map_grow(DBXMETH *pmeth, int cause, size_t min_size)
+{
+   int rc;
+   size_t size;
+   MDB_envinfo info;
+   MDB_stat stat;
+   DBXCON *pcon = pmeth->pcon;
+
+   if (pcon->tlevel || pcon->tlevelro || pcon->psnap) {
+      strcpy(pcon->error, "The LMDB map cannot be resized while cursors or views are open");
+      return (cause ? cause : CACHE_FAILURE);
+   }
+
+   /* held until the map is resized so that no other connection can open the environment in the meantime */
+   dbx_enter_critical_section((void *) &dbx_async_mutex);
+
+   if (pcon->p_lmdb_so->no_connections > 1) {
+      strcpy(pcon->error, "The LMDB map cannot be resized while other connections share the environment");
+      rc = (cause ? cause : CACHE_FAILURE);
+      goto lmdb_map_grow_exit;
+   }
+   if (cause == MDB_MAP_RESIZED) {
+      rc = pcon->p_lmdb_so->p_mdb_env_set_mapsize(pcon->p_lmdb_so->penv, 0);
+      goto lmdb_map_grow_exit;
+   }
+
+   rc = pcon->p_lmdb_so->p_mdb_env_info(pcon->p_lmdb_so->penv, &info);
+   if (rc != CACHE_SUCCESS) {
+      goto lmdb_map_grow_exit;
+   }
+   size = (size_t) info.me_mapsize;
+   if (cause == MDB_MAP_FULL) {
+      if (pcon->db_growth <= 1.0) {
+         rc = cause;
+         goto lmdb_map_grow_exit;
+      }
+      size = (size_t) ((double) size * pcon->db_growth);
+   }
+   if (size < min_size) {
+      size = min_size;
+   }
+   if (pcon->db_size_max && size > pcon->db_size_max) {
+      size = pcon->db_size_max;
+   }
+   if (size <= (size_t) info.me_mapsize) {
+      rc = cause;
+      goto lmdb_map_grow_exit;
+   }
+
+   rc = pcon->p_lmdb_so->p_mdb_env_stat(pcon->p_lmdb_so->penv, &stat);
+   if (rc == CACHE_SUCCESS && stat.ms_psize > 0) {
+      size = ((size + stat.ms_psize - 1) / stat.ms_psize) * stat.ms_psize;
+   }
+   rc = pcon->p_lmdb_so->p_mdb_env_set_mapsize(pcon->p_lmdb_so->penv, size);
+   if (rc == CACHE_SUCCESS) {
+      pcon->db_size = size;
+      pcon->db_resizes ++;
+   }
+
+lmdb_map_grow_exit:
+
+   dbx_leave_critical_section((void *) &dbx_async_mutex);
+
+   return rc;
+}
+
+
+/* v1.3.20 End all snapshots before the environment closes: views still held by JavaScript must not be used after close() */
+int lmdb_view_close(DBXCON *pcon)
+{
+   DBXSNAP *psnap, *pnext;
+
+   psnap = pcon->psnap;
+   while (psnap) {
+      pnext = psnap->pnext;
+      if (psnap->ptxn) {
+         pcon->p_lmdb_so->p_mdb_txn_abort(psnap->ptxn);
+         psnap->ptxn = NULL;
+      }
+      psnap->pcon = NULL; /* freed by lmdb_view_release() when the last buffer is collected */
+      psnap->pnext = NULL;
+      psnap = pnext;
+   }
+   pcon->psnap = NULL;
+
+   return 0;
+}
+
+
+int lmdb_next(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
+{
+   int rc, n, mkeyn, fixed_comp;
+   DBXCON *pcon = pmeth->pcon;
+   MDB_val key, key0, data;
+   MDB_cursor *pcursor;
+   DBXVAL mkey;
+
+/*
+   printf("\r\n ******* lmdb_next ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p;\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr);
+*/
+
+   if (context == 0) {
+      if (DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 global does not exist */
+         pkeyval->svalue.len_used = 0;
+         return YDB_NODE_END;
+      }
+      rc = lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &pcursor);
+   }
+   else {
+     pcursor = pmeth->plmdbcursor;
+   }
+
+   if (pcon->key_type == DBX_KEYTYPE_INT) {
+      key0.mv_data = &(pkey->args[0].num.int32);
+      key0.mv_size = sizeof(pkey->args[0].num.int32);
+      pkeyval->num.int32 = pkey->args[0].num.int32;
+      key.mv_data = &(pkeyval->num.int32);
+      key.mv_size = sizeof(pkeyval->num.int32);
+      if (pkey->args[0].svalue.len_used == 0) {
+         key.mv_size = 0;
+         key0.mv_size = 0;
+      }
+   }
+   else if (pcon->key_type == DBX_KEYTYPE_STR) {
+      key0.mv_data = pkey->args[0].svalue.buf_addr;
+      key0.mv_size = pkey->args[0].svalue.len_used;
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
+      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
+      key.mv_data = (void *) pkeyval->svalue.buf_addr;
+      key.mv_size = (size_t) pkeyval->svalue.len_used;
+   }
+   else { /* mumps */
+      key0.mv_data = (void *) pkey->ibuffer.buf_addr;
+      key0.mv_size = (size_t) pkey->ibuffer.len_used;
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
+      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
+      key.mv_data = (void *) pkeyval->svalue.buf_addr;
+      key.mv_size = (size_t) pkeyval->svalue.len_used;
+   }
+
+   data.mv_data = (void *) pdataval->svalue.buf_addr;
+   data.mv_size = (size_t) pdataval->svalue.len_alloc;
+
+   rc = YDB_NODE_END;
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+/*
+      printf("\r\nstarting from ...");
+      dbx_dump_key((char *) key0.mv_data, (int) key0.mv_size);
+*/
+      pkeyval->svalue.len_used = 0;
+      fixed_comp = 0;
+
+      for (n = 0; n < 10; n ++) {
+/*
+         printf("\r\nDB_SET_RANGE (seed): fixed_comp=%d; pkey->argc=%d; key.mv_size=%d", fixed_comp, pkey->argc, (int) key.mv_size);
+         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+/*
+         printf("\r\nDB_SET_RANGE: rc=%d; pkey->argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
+         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+         if (rc == CACHE_SUCCESS) {
+            /* reset key.mv_data to memory owned by us */
+            rc = dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, (size_t) key.mv_size);
+            if (rc != CACHE_SUCCESS) {
+               rc = YDB_NODE_END;
+               break;
+            }
+            key.mv_data = (void *) pkeyval->svalue.buf_addr;
+            key.mv_size = (size_t) pkeyval->svalue.len_used;
+         }
+         else {
+            rc = YDB_NODE_END;
+            break;
+         }
+         if (*((unsigned char *) key.mv_data) != 0x00) {
+            rc = YDB_NODE_END;
+            break;
+         }
+
+         /* dbx_dump_key((char *) key.mv_data, (int) key.mv_size); */
+
+         if (pkey->argc < 2)
+            fixed_comp = 0;
+         else
+            fixed_comp = lmdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+
+         if (!fixed_comp) {
+            /* v1.3.17 locate the subscript at this level only: the fixed subscripts have already been matched */
+            mkeyn = dbx_key_subscript(&mkey, (char *) key.mv_data, (int) key.mv_size, (pkey->argc < 2) ? 0 : (int) pkey->args[pkey->argc - 2].csize);
+/*
+            printf("\r\nNext Record: pkey->argc=%d mkeyn=%d csize=%d; lens=%d:%d %s", pkey->argc, mkeyn, pkey->args[pkey->argc - 1].csize, pkey->args[pkey->argc - 1].svalue.len_used, mkey.svalue.len_used, mkey.svalue.buf_addr);
+*/
+
+            if (mkeyn != 0) { /* can't use data as it's under lower subscripts */
+               data.mv_size = 0;
+            }
+
+            if (mkeyn >= 0) {
+               if (pkey->args[pkey->argc - 1].svalue.len_used == mkey.svalue.len_used && !memcmp((void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (void *) mkey.svalue.buf_addr, (size_t) mkey.svalue.len_used)) {
+                  /* current key returned - get next */
+                  *(((unsigned char *) key.mv_data) + pkey->args[pkey->argc - 1].csize + 0) = 0x00;
+                  *(((unsigned char *) key.mv_data) + pkey->args[pkey->argc - 1].csize + 1) = 0xff;
+                  key.mv_size = (pkey->args[pkey->argc - 1].csize + 2);
+/*
+                  printf("\r\nAdvance Cursor: pkey->argc=%d; key.mv_size=%d", pkey->argc, key.mv_size);
+                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+                  continue;
+               }
+               else if (mkeyn == 0 && dbx_expired((char *) data.mv_data, data.mv_size)) { /* v1.3.27 */
+                  /* expired but not yet swept: move on to the next record (a descendant keeps the subscript defined) */
+                  if (dbx_key_successor(&(pkeyval->svalue), (unsigned int) key.mv_size) != CACHE_SUCCESS) {
+                     rc = YDB_NODE_END;
+                     break;
+                  }
+                  key.mv_data = (void *) pkeyval->svalue.buf_addr;
+                  key.mv_size = (size_t) pkeyval->svalue.len_used;
+                  n --;
+                  continue;
+               }
+               else {
+                  /* next key found */
+                  if (!lmdb_chunk_str(pmeth, NULL, 0, pcursor, &key, &data, &(pdataval->svalue))) { /* v1.3.22 read while key still holds the node's key */
+                     dbx_memcpy_exx(&(pdataval->svalue), (void *) data.mv_data, (unsigned int) data.mv_size);
+                  }
+                  if (context == 0) {
+                     rc = dbx_memcpy_ex(&(pkeyval->svalue), (void *) mkey.svalue.buf_addr, (size_t) mkey.svalue.len_used);
+                  }
+                  else {
+                     rc = dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.mv_data, (size_t) mkey.csize);
+                     pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
+                     rc = dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
+                  }
+                  break;
+               }
+            }
+         }
+         else {
+            rc = YDB_NODE_END;
+            break;
+         }
+      }
+   }
+   else { /* not mumps */
+/*
+      printf("\r\nstarting from ...");
+      dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+
+      if (key.mv_size == 0) {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_FIRST);
+
+         if (rc == CACHE_SUCCESS) {
+            pkeyval->svalue.len_used = (unsigned int) key.mv_size;
+            if (pcon->key_type == DBX_KEYTYPE_INT) {
+               pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
+            }
+            else {
+               rc = dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
+            }
+         }
+         else {
+            pkeyval->svalue.len_used = 0;
+            rc = YDB_NODE_END;
+         }
+      }
+      else {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+
+/*
+         printf("\r\nAdvance Cursor (DB_SET_RANGE): rc=%d; key.mv_size=%d", rc, key.mv_size);
+         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+         if (rc == CACHE_SUCCESS) {
+            pkeyval->svalue.len_used = (unsigned int) key.mv_size;
+            if (!lmdb_key_compare(&key, &key0, 0, pcon->key_type)) {
+               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+
+/*
+               printf("\r\nAdvance Cursor (DB_NEXT): rc=%d; key.mv_size=%d", rc, key.mv_size);
+               dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+               if (rc == CACHE_SUCCESS) {
+                  pkeyval->svalue.len_used = (unsigned int) key.mv_size;
+                  if (pcon->key_type == DBX_KEYTYPE_INT) {
+                     pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
+                  }
+                  else {
+                     dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
+                  }
+               }
+               else {
+                  pkeyval->svalue.len_used = 0;
+                  rc = YDB_NODE_END;
+               }
+            }
+            else {
+               pkeyval->svalue.len_used = (unsigned int) key.mv_size;
+               if (pcon->key_type == DBX_KEYTYPE_INT) {
+                  pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
+               }
+               else {
+                  dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
+               }
+            }
+         }
+         else {
+            pkeyval->svalue.len_used = 0;
+            rc = YDB_NODE_END;
+         }
+      }
+      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
+         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
+         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
+         pkeyval->type = DBX_DTYPE_INT;
+      }
+   }
+
+   if (context == 0) {
+      pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+      lmdb_commit_ro_transaction(pmeth, 0);
+   }
+
+   if (rc != CACHE_SUCCESS) {
+      pkeyval->svalue.len_used = 0;
+   }
+   if (pkeyval->svalue.len_used == 0) {
+      rc = YDB_NODE_END;
+   }
+
+   return rc;
+}
+
+
+int lmdb_previous(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
+{
+   int rc, mkeyn, fixed_comp;
+   DBXCON *pcon = pmeth->pcon;
+   MDB_val key, key0, data;
+   MDB_cursor *pcursor;
+   DBXVAL mkey;
+/*
+   printf("\r\n ******* lmdb_previous ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p; seed_len%d\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr, pkey->args[pkey->argc - 1].svalue.len_used);
+*/
+
+   if (context == 0) {
+      if (DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 global does not exist */
+         pkeyval->svalue.len_used = 0;
+         return YDB_NODE_END;
+      }
+      rc = lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &pcursor);
+   }
+   else {
+     pcursor = pmeth->plmdbcursor;
+   }
+
+   if (pcon->key_type == DBX_KEYTYPE_INT) {
+      key0.mv_data = &(pkey->args[0].num.int32);
+      key0.mv_size = sizeof(pkey->args[0].num.int32);
+      pkeyval->num.int32 = pkey->args[0].num.int32;
+      key.mv_data = &(pkeyval->num.int32);
+      key.mv_size = sizeof(pkeyval->num.int32);
+      if (pkey->args[0].svalue.len_used == 0) {
+         key.mv_size = 0;
+         key0.mv_size = 0;
+      }
+   }
+   else if (pcon->key_type == DBX_KEYTYPE_STR) {
+      key0.mv_data = pkey->args[0].svalue.buf_addr;
+      key0.mv_size = pkey->args[0].svalue.len_used;
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
+      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
+      key.mv_data = (void *) pkeyval->svalue.buf_addr;
+      key.mv_size = (size_t) pkeyval->svalue.len_used;
+   }
+   else { /* mumps */
+      key0.mv_data = (void *) pkey->ibuffer.buf_addr;
+      key0.mv_size = (size_t) pkey->ibuffer.len_used;
+      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
+      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
+      key.mv_data = (void *) pkeyval->svalue.buf_addr;
+      key.mv_size = (size_t) pkeyval->svalue.len_used;
+   }
+
+   data.mv_data = (void *) pdataval->svalue.buf_addr;
+   data.mv_size = (size_t) pdataval->svalue.len_alloc;
+
+   fixed_comp = 0;
+   rc = YDB_NODE_END;
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+/*
+      printf("\r\n seed ... pkey->ibuffer.len_used=%d", pkey->ibuffer.len_used);
+      dbx_dump_key((char *) key0.mv_data, (int) key0.mv_size);
+*/
+      pkeyval->svalue.len_used = 0;
+      if (pkey->argc < 2 && pkey->args[pkey->argc - 1].svalue.len_used == 0) { /* null seed - special case */
+
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
+/*
+         printf("\r\n DB_LAST rc=%d; argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
+         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+
+      }
+      else {
+
+         if (pkey->args[pkey->argc - 1].svalue.len_used == 0) {
+            *(((unsigned char *) key.mv_data) + pkey->args[pkey->argc - 1].csize - 1) = 0xff;
+         }
+
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+/*
+         printf("\r\n DB_SET_RANGE rc=%d; argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
+         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+         if (rc == MDB_NOTFOUND) {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
+/*
+            printf("\r\n DB_LAST rc=%d; argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
+            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+         }
+         else if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_PREV);
+         }
+
+         if (rc == CACHE_SUCCESS) {
+
+            if (pkey->argc < 2)
+               fixed_comp = 0;
+            else
+               fixed_comp = lmdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+/*
+            printf("\r\n DB_PREV rc=%d; argc=%d; key.mv_size=%d; fixed_comp=%d;", rc, pkey->argc, (int) key.mv_size, fixed_comp);
+            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+         }
+      }
+      mkeyn = -1;
+      while (rc == CACHE_SUCCESS && !fixed_comp) {
+         /* v1.3.17 locate the subscript at this level only: the fixed subscripts have already been matched */
+         mkeyn = dbx_key_subscript(&mkey, (char *) key.mv_data, (int) key.mv_size, (pkey->argc < 2) ? 0 : (int) pkey->args[pkey->argc - 2].csize);
+         if (mkeyn != 0 || !dbx_expired((char *) data.mv_data, data.mv_size)) {
+            break;
+         }
+         /* v1.3.27 expired but not yet swept (and with no descendants): move on to the previous record */
+         mkeyn = -1;
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_PREV);
+         if (rc == CACHE_SUCCESS && pkey->argc >= 2) {
+            fixed_comp = lmdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+         }
+      }
+      if (mkeyn >= 0) {
+
+         if (context == 0) {
+            dbx_memcpy_ex(&(pkeyval->svalue),  (void *) mkey.svalue.buf_addr,  (size_t) mkey.svalue.len_used);
+         }
+         else {
+            dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.mv_data, (size_t) mkey.csize);
+            pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
+            dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
+         }
+         if (mkeyn != 0 || !lmdb_chunk_str(pmeth, NULL, 0, pcursor, &key, &data, &(pdataval->svalue))) { /* v1.3.22 */
+            dbx_memcpy_exx(&(pdataval->svalue), (void *) data.mv_data, (unsigned int) data.mv_size);
+         }
+
+         if (mkeyn != 0) { /* can't use data as it's under lower subscripts */
+            data.mv_size = 0;
+            pdataval->svalue.len_used = (unsigned int) data.mv_size;
+         }
+
+      }
+      else {
+         pkeyval->svalue.len_used = 0;
+         rc = YDB_NODE_END;
+      }
+   }
+   else { /* not mumps */
+      if (key.mv_size == 0) {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
+         if (rc == CACHE_SUCCESS) {
+            pkeyval->svalue.len_used = (unsigned int) key.mv_size;
+            if (pcon->key_type == DBX_KEYTYPE_INT) {
+               pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
+            }
+            else {
+               dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
+            }
+         }
+         else {
+            pkeyval->svalue.len_used = 0;
+            rc = YDB_NODE_END;
+         }
+      }
+      else {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_PREV);
+
+            if (rc == CACHE_SUCCESS) {
+               pkeyval->svalue.len_used = (unsigned int) key.mv_size;
+               if (pcon->key_type == DBX_KEYTYPE_INT) {
+                  pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
+               }
+               else {
+                  dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
+               }
+            }
+            else {
+               pkeyval->svalue.len_used = 0;
+               rc = YDB_NODE_END;
+            }
+         }
+         else {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
+
+            if (rc == CACHE_SUCCESS) {
+               pkeyval->svalue.len_used = (unsigned int) key.mv_size;
+               if (pcon->key_type == DBX_KEYTYPE_INT) {
+                  pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
+               }
+               else {
+                  dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
+               }
+            }
+            else {
+               pkeyval->svalue.len_used = 0;
+               rc = YDB_NODE_END;
+            }
+         }
+      }
+      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
+         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
+         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
+         pkeyval->type = DBX_DTYPE_INT;
+      }
+   }
+
+   if (context == 0) {
+      pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+      lmdb_commit_ro_transaction(pmeth, 0);
+   }
+
+   if (rc != CACHE_SUCCESS) {
+      pkeyval->svalue.len_used = 0;
+   }
+
+   return rc;
+}
+
+
+int lmdb_key_compare(MDB_val *key1, MDB_val *key2, int compare_max, short keytype)
+{
+   /* v1.3.18 */
+   return dbx_key_compare((char *) key1->mv_data, (unsigned int) key1->mv_size, (char *) key2->mv_data, (unsigned int) key2->mv_size, compare_max, keytype);
+}
+
+
+/* v1.3.10 */
+int lmdb_error_message(DBXCON *pcon, int error_code)
+{
+   switch (error_code) {
+      case MDB_SUCCESS:
+         strcpy(pcon->error, "");
          break;
-      case DB_REP_JOIN_FAILURE:
-         sprintf(pcon->error, "BDB error %d (DB_REP_JOIN_FAILURE) Unable to join replication group", error_code);
+      case MDB_KEYEXIST:
+         sprintf(pcon->error, "LMDB error %d (MDB_KEYEXIST) Key/data pair already exists", error_code);
          break;
-      case DB_REP_LEASE_EXPIRED:
-         sprintf(pcon->error, "BDB error %d (DB_REP_LEASE_EXPIRED) Master lease has expired", error_code);
+      case MDB_NOTFOUND:
+         sprintf(pcon->error, "LMDB error %d (MDB_NOTFOUND) Key/data pair not found (EOF)", error_code);
          break;
-      case DB_REP_LOCKOUT:
-         sprintf(pcon->error, "BDB error %d (DB_REP_LOCKOUT) API/Replication lockout now", error_code);
+      case MDB_PAGE_NOTFOUND:
+         sprintf(pcon->error, "LMDB error %d (MDB_PAGE_NOTFOUND) Requested page not found - this usually indicates corruption", error_code);
          break;
-      case DB_REP_NEWSITE:
-         sprintf(pcon->error, "BDB error %d (DB_REP_NEWSITE) New site entered system", error_code);
+      case MDB_CORRUPTED:
+         sprintf(pcon->error, "LMDB error %d (MDB_CORRUPTED) Located page was wrong type", error_code);
          break;
-      case DB_REP_NOTPERM:
-         sprintf(pcon->error, "BDB error %d (DB_REP_NOTPERM) Permanent log record not written", error_code);
+      case MDB_PANIC:
+         sprintf(pcon->error, "LMDB error %d (MDB_PANIC) Update of meta page failed or environment had fatal error", error_code);
          break;
-      case DB_REP_UNAVAIL:
-         sprintf(pcon->error, "BDB error %d (DB_REP_UNAVAIL) Site cannot currently be reached", error_code);
+      case MDB_VERSION_MISMATCH:
+         sprintf(pcon->error, "LMDB error %d (MDB_VERSION_MISMATCH) Environment version mismatch", error_code);
          break;
-      case DB_REP_WOULDROLLBACK:
-         sprintf(pcon->error, "BDB error %d (DB_REP_WOULDROLLBACK) UNDOC: rollback inhibited by app", error_code);
+      case MDB_INVALID:
+         sprintf(pcon->error, "LMDB error %d (MDB_INVALID) File is not a valid LMDB file", error_code);
          break;
-      case DB_RUNRECOVERY:
-         sprintf(pcon->error, "BDB error %d (DB_RUNRECOVERY) Panic return", error_code);
+      case MDB_MAP_FULL:
+         sprintf(pcon->error, "LMDB error %d (MDB_MAP_FULL) Environment mapsize reached", error_code);
          break;
-      case DB_SECONDARY_BAD:
-         sprintf(pcon->error, "BDB error %d (DB_SECONDARY_BAD) Secondary index corrupt", error_code);
+      case MDB_DBS_FULL:
+         sprintf(pcon->error, "LMDB error %d (MDB_DBS_FULL) Environment maxdbs reached", error_code);
          break;
-      case DB_SLICE_CORRUPT:
-         sprintf(pcon->error, "BDB error %d (DB_SLICE_CORRUPT) A part of a sliced ENV is corrupt", error_code);
+      case MDB_READERS_FULL:
+         sprintf(pcon->error, "LMDB error %d (MDB_READERS_FULL) Environment maxreaders reached", error_code);
          break;
-      case DB_TIMEOUT:
-         sprintf(pcon->error, "BDB error %d (DB_TIMEOUT) Timed out on read consistency", error_code);
+      case MDB_TLS_FULL:
+         sprintf(pcon->error, "LMDB error %d (MDB_TLS_FULL) Too many TLS keys in use - Windows only", error_code);
          break;
-      case DB_VERIFY_BAD:
-         sprintf(pcon->error, "BDB error %d (DB_VERIFY_BAD) Verify failed; bad format", error_code);
+      case MDB_TXN_FULL:
+         sprintf(pcon->error, "LMDB error %d (MDB_TXN_FULL) Transaction has too many dirty pages", error_code);
          break;
-      case DB_VERSION_MISMATCH:
-         sprintf(pcon->error, "BDB error %d (DB_VERSION_MISMATCH) Environment version mismatch", error_code);
+      case MDB_CURSOR_FULL:
+         sprintf(pcon->error, "LMDB error %d (MDB_CURSOR_FULL) Cursor stack too deep - internal error", error_code);
          break;
-      case DB_SYSTEM_MEM_MISSING:
-         sprintf(pcon->error, "BDB error %d (DB_SYSTEM_MEM_MISSING) Attach to shared memory failed", error_code);
+      case MDB_PAGE_FULL:
+         sprintf(pcon->error, "LMDB error %d (MDB_PAGE_FULL) Page has not enough space - internal error", error_code);
          break;
-      case DB_ALREADY_ABORTED:
-         sprintf(pcon->error, "BDB error %d (DB_ALREADY_ABORTED) Transaction aborted", error_code);
+      case MDB_MAP_RESIZED:
+         sprintf(pcon->error, "LMDB error %d (MDB_MAP_RESIZED) Database contents grew beyond environment mapsize", error_code);
          break;
-      case DB_DELETED:
-         sprintf(pcon->error, "BDB error %d (DB_DELETED) Recovery file marked deleted", error_code);
+      case MDB_INCOMPATIBLE:
+         sprintf(pcon->error, "LMDB error %d (MDB_INCOMPATIBLE) Operation and DB incompatible, or DB type changed", error_code);
          break;
-      case DB_EVENT_NOT_HANDLED:
-         sprintf(pcon->error, "BDB error %d (DB_EVENT_NOT_HANDLED) Forward event to application", error_code);
+      case MDB_BAD_RSLOT:
+         sprintf(pcon->error, "LMDB error %d (MDB_BAD_RSLOT) Invalid reuse of reader locktable slot", error_code);
          break;
-      case DB_NEEDSPLIT:
-         sprintf(pcon->error, "BDB error %d (DB_NEEDSPLIT) Page needs to be split", error_code);
+      case MDB_BAD_TXN:
+         sprintf(pcon->error, "LMDB error %d (MDB_BAD_TXN) Transaction must abort, has a child, or is invalid", error_code);
          break;
-      case DB_NOINTMP:
-         sprintf(pcon->error, "BDB error %d (DB_NOINTMP) Sequences not supported in temporary or in-memory databases", error_code);
+      case MDB_BAD_VALSIZE:
+         sprintf(pcon->error, "LMDB error %d (MDB_BAD_VALSIZE) Unsupported size of key/DB name/data, or wrong DUPFIXED size", error_code);
          break;
-      case DB_REP_BULKOVF:
-         sprintf(pcon->error, "BDB error %d (DB_REP_BULKOVF) Rep bulk buffer overflow", error_code);
+      case MDB_BAD_DBI:
+         sprintf(pcon->error, "LMDB error %d (MDB_BAD_DBI) The specified DBI was changed unexpectedly", error_code);
          break;
-      case DB_REP_LOGREADY:
-         sprintf(pcon->error, "BDB error %d (DB_REP_LOGREADY) Rep log ready for recovery", error_code);
+#if defined(MDB_PROBLEM)
+      case MDB_PROBLEM:
+         sprintf(pcon->error, "LMDB error %d (MDB_PROBLEM) General problem", error_code);
          break;
-      case DB_REP_NEWMASTER:
-         sprintf(pcon->error, "BDB error %d (DB_REP_NEWMASTER) We have learned of a new master", error_code);
+#endif
+      case CACHE_NOCON:
+         sprintf(pcon->error, "LMDB error %d (DB_UNAVAILABLE) DB unavailable - check installation", error_code);
          break;
-      case DB_REP_PAGEDONE:
-         sprintf(pcon->error, "BDB error %d (DB_REP_PAGEDONE) This page was already done", error_code);
+      case DBX_GDB_FULL: /* v1.3.15 the message was set by dbx_global_db() */
          break;
-      case DB_SURPRISE_KID:
-         sprintf(pcon->error, "BDB error %d (DB_SURPRISE_KID) Child commit where parent didn't know it was a parent", error_code);
+      default:
+         sprintf(pcon->error, "LMDB error %d (MDB_UNKNOWN) Unknown error condition", error_code);
          break;
-      case DB_SWAPBYTES:
-         sprintf(pcon->error, "BDB error %d (DB_SWAPBYTES) Database needs byte swapping", error_code);
+   }
+
+   return 0;
+}
+
+
+int dbx_version(DBXMETH *pmeth)
+{
+   char buffer[256];
+   DBXCON *pcon = pmeth->pcon;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   T_SPRINTF((char *) buffer, _dbxso(buffer), "mg-dbx-bdb: version: %s; ABI: %d", DBX_VERSION, NODE_MODULE_VERSION);
+
+   if (pcon->p_zv && pcon->p_zv->version[0]) {
+      if (pcon->p_zv->dbtype == DBX_DBTYPE_BDB)
+         T_STRCAT((char *) buffer, _dbxso(buffer), "; BerkeleyDB version: ");
+      else if (pcon->p_zv->dbtype == DBX_DBTYPE_LMDB && pcon->memdb) /* v1.3.39 */
+         T_STRCAT((char *) buffer, _dbxso(buffer), "; MEM version: ");
+      else if (pcon->p_zv->dbtype == DBX_DBTYPE_LMDB)
+         T_STRCAT((char *) buffer, _dbxso(buffer), "; LMDB version: ");
+      T_STRCAT((char *) buffer, _dbxso(buffer), pcon->p_zv->version);
+   }
+
+   dbx_create_string(&(pmeth->output_val.svalue), (void *) buffer, DBX_DTYPE_STR8);
+
+   return 0;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_version: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return 0;
+}
+#endif
+}
+
+int dbx_open(DBXMETH *pmeth)
+{
+   int rc;
+   DBXCON *pcon = pmeth->pcon;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   rc = 0;
+   pcon->gdb_gen ++; /* v1.3.15 positions cached in the p_gdb table before this point are no longer valid */
+   if (!pcon->dbtype) {
+      strcpy(pcon->error, "Unable to determine the database type");
+      rc = CACHE_NOCON;
+      goto dbx_open_exit;
+   }
+
+   if (!pcon->db_library[0] && !pcon->memdb) {
+      strcpy(pcon->error, "Unable to determine the path to the database installation");
+      rc = CACHE_NOCON;
+      goto dbx_open_exit;
+   }
+
+   if (pcon->stats && !pcon->pstats) { /* v1.3.33 held for the life of the connection object */
+      pcon->pstats = (DBXSTATS *) dbx_malloc(sizeof(DBXSTATS), DBX_MEMID_CON);
+      if (pcon->pstats) {
+         memset((void *) pcon->pstats, 0, sizeof(DBXSTATS));
+         pcon->pstats->reset = dbx_clock_ms();
+      }
+   }
+
+   dbx_enter_critical_section((void *) &dbx_async_mutex);
+   if (pcon->dbtype == DBX_DBTYPE_BDB && p_bdb_so_global) {
+      rc = CACHE_SUCCESS;
+      pcon->p_bdb_so = p_bdb_so_global;
+      pcon->global_dbs = pcon->p_bdb_so->global_dbs; /* v1.3.15 */
+      pcon->p_bdb_so->no_connections ++;
+      pcon->p_bdb_so->multiple_connections ++;
+      pcon->p_zv = &(p_bdb_so_global->zv);
+      dbx_leave_critical_section((void *) &dbx_async_mutex);
+      return rc;
+   }
+   else if (pcon->memdb && p_memdb_so_global) { /* v1.3.39 the in-memory environment is shared until the last connection closes */
+      pcon->p_lmdb_so = p_memdb_so_global;
+      if (p_memdb_so_global->loaded) {
+         rc = CACHE_SUCCESS;
+         pcon->global_dbs = pcon->p_lmdb_so->global_dbs;
+         pcon->p_lmdb_so->no_connections ++;
+         pcon->p_lmdb_so->multiple_connections ++;
+         pcon->p_zv = &(p_memdb_so_global->zv);
+         dbx_leave_critical_section((void *) &dbx_async_mutex);
+         return rc;
+      }
+      pcon->p_zv = &(p_memdb_so_global->zv);
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB && !pcon->memdb && p_lmdb_so_global) {
+      rc = CACHE_SUCCESS;
+      pcon->p_lmdb_so = p_lmdb_so_global;
+      pcon->global_dbs = pcon->p_lmdb_so->global_dbs; /* v1.3.15 */
+      pcon->p_lmdb_so->no_connections ++;
+      pcon->p_lmdb_so->multiple_connections ++;
+      pcon->p_zv = &(p_lmdb_so_global->zv);
+      dbx_leave_critical_section((void *) &dbx_async_mutex);
+      return rc;
+   }
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      rc = bdb_open(pmeth);
+      pcon->p_bdb_so->no_connections ++;
+      p_bdb_so_global = pcon->p_bdb_so;
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      rc = lmdb_open(pmeth);
+      pcon->p_lmdb_so->no_connections ++;
+      if (pcon->memdb)
+         p_memdb_so_global = pcon->p_lmdb_so;
+      else
+         p_lmdb_so_global = pcon->p_lmdb_so;
+   }
+
+   dbx_pool_thread_init(pcon, 1);
+
+   dbx_leave_critical_section((void *) &dbx_async_mutex);
+
+   if (rc == CACHE_SUCCESS && pcon->ttl.autostart && pcon->key_type == DBX_KEYTYPE_M) { /* v1.3.27 */
+      dbx_timer_start(pcon, &(pcon->ttl), dbx_ttl_thread);
+   }
+   if (rc == CACHE_SUCCESS && pcon->flush.autostart) { /* v1.3.29 */
+      dbx_timer_start(pcon, &(pcon->flush), dbx_sync_thread);
+   }
+
+dbx_open_exit:
+
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_open: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+int dbx_do_nothing(DBXMETH *pmeth)
+{
+
+   /* Function called asynchronously */
+
+   return 0;
+}
+
+
+int dbx_close(DBXMETH *pmeth)
+{
+   int no_connections;
+   DBXCON *pcon = pmeth->pcon;
+
+#ifdef _WIN32
+__try {
+#endif
+
+/*
+   printf("\r\n******* Graceful Close *******\r\n");
+*/
+   dbx_timer_stop(&(pcon->ttl)); /* v1.3.27 */
+   dbx_timer_stop(&(pcon->flush)); /* v1.3.29 */
+
+   no_connections = 0;
+
+   dbx_enter_critical_section((void *) &dbx_async_mutex);
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      if (pcon->p_bdb_so) {
+         pcon->p_bdb_so->no_connections --;
+         no_connections =  pcon->p_bdb_so->no_connections;
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      if (pcon->p_lmdb_so) {
+         pcon->p_lmdb_so->no_connections --;
+         no_connections =  pcon->p_lmdb_so->no_connections;
+      }
+   }
+   dbx_leave_critical_section((void *) &dbx_async_mutex);
+/*
+   printf("\r\ndbx_close: no_connections=%d\r\n", no_connections);
+*/
+   dbx_index_free(pcon->pindex); /* v1.3.26 */
+   pcon->pindex = NULL;
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+
+      /* printf("\r\ndbx_close: no_connections=%d; pcon->p_bdb_so->multiple_connections=%d;\r\n", no_connections, pcon->p_bdb_so->multiple_connections); */
+
+      if (pcon->p_bdb_so && no_connections == 0 && pcon->p_bdb_so->multiple_connections == 0) {
+         if (pcon->p_bdb_so->loaded) {
+
+            dbx_global_db_close(pcon); /* v1.3.15 */
+
+            if (pcon->p_bdb_so->pdb != NULL) {
+               pcon->p_bdb_so->pdb->close(pcon->p_bdb_so->pdb, 0);
+            }
+
+/*
+            printf("\r\np_bdb_exit=%d\r\n", rc);
+            dbx_dso_unload(pcon->p_bdb_so->p_library); 
+*/
+            pcon->p_bdb_so->p_library = NULL;
+            pcon->p_bdb_so->loaded = 0;
+         }
+
+         strcpy(pcon->error, "");
+         dbx_create_string(&(pmeth->output_val.svalue), (void *) "1", DBX_DTYPE_STR);
+
+         strcpy(pcon->p_bdb_so->libdir, "");
+         strcpy(pcon->p_bdb_so->libnam, "");
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+
+      /* printf("\r\ndbx_close: no_connections=%d; pcon->p_lmdb_so->multiple_connections=%d;\r\n", no_connections, pcon->p_lmdb_so->multiple_connections); */
+
+      if (pcon->p_lmdb_so) {
+         if (pcon->tlevel > 0) {
+            pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+            pcon->tlevel = 0;
+         }
+         if (pcon->tlevelro > 0) {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxnro);
+            pcon->p_lmdb_so->ptxnro = NULL;
+            pcon->tlevelro = 0;
+            pcon->tstatusro = 0;
+         }
+         lmdb_view_close(pcon); /* v1.3.20 */
+      }
+
+      if (pcon->p_lmdb_so && no_connections == 0 && pcon->p_lmdb_so->multiple_connections == 0) {
+         if (pcon->p_lmdb_so->loaded) {
+
+            dbx_global_db_close(pcon); /* v1.3.15 */
+
+            if (pcon->p_lmdb_so->ptxnro != NULL) { /* v1.3.39 the read only transaction is kept (reset) between requests */
+               pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxnro);
+               pcon->p_lmdb_so->ptxnro = NULL;
+               pcon->tstatusro = 0;
+            }
+            if (pcon->p_lmdb_so->pdb != NULL) {
+               pcon->p_lmdb_so->p_mdb_dbi_close(pcon->p_lmdb_so->penv, pcon->p_lmdb_so->db);
+            }
+            if (pcon->p_lmdb_so->penv != NULL) {
+               pcon->p_lmdb_so->p_mdb_env_close(pcon->p_lmdb_so->penv);
+            }
+
+
+/*
+            printf("\r\np_lmdb_exit=%d\r\n", rc);
+            dbx_dso_unload(pcon->p_lmdb_so->p_library); 
+*/
+            pcon->p_lmdb_so->p_library = NULL;
+            pcon->p_lmdb_so->loaded = 0;
+         }
+
+         strcpy(pcon->error, "");
+         dbx_create_string(&(pmeth->output_val.svalue), (void *) "1", DBX_DTYPE_STR);
+
+         strcpy(pcon->p_lmdb_so->libdir, "");
+         strcpy(pcon->p_lmdb_so->libnam, "");
+      }
+   }
+
+
+   T_STRCPY(pcon->p_zv->version, _dbxso(pcon->p_zv->version), "");
+
+   T_STRCPY(pcon->db_library, _dbxso(pcon->db_library), "");
+   T_STRCPY(pcon->db_file, _dbxso(pcon->db_file), "");
+
+   return 0;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_close: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+int dbx_global_reference(DBXMETH *pmeth)
+{
+   int rc;
+   DBXCON *pcon = pmeth->pcon;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   rc = CACHE_SUCCESS;
+
+   /* v1.3.15 resolve the database holding this global (cached on the mglobal object where there is one) */
+   /* v1.3.15 the position in the p_gdb table is cached rather than a pointer: the table is freed when the environment is closed */
+   pmeth->pgdb = NULL;
+   if (pcon->global_dbs && pmeth->key.argc > 0) {
+      DBXGDBREF *pgdbref = pmeth->pgdbref;
+      DBXGDB *p_gdb = (pcon->dbtype == DBX_DBTYPE_BDB ? pcon->p_bdb_so->p_gdb : pcon->p_lmdb_so->p_gdb);
+
+      if (pgdbref && pgdbref->gen == pcon->gdb_gen && pgdbref->index >= 0 && p_gdb && p_gdb[pgdbref->index].open) {
+         pmeth->pgdb = &(p_gdb[pgdbref->index]);
+      }
+      else {
+         rc = dbx_global_db(pmeth, pmeth->key.args[0].svalue.buf_addr, (int) pmeth->key.args[0].svalue.len_used, pmeth->update, &(pmeth->pgdb));
+         if (rc == CACHE_SUCCESS && pgdbref && pmeth->pgdb && p_gdb) {
+            pgdbref->index = (int) (pmeth->pgdb - p_gdb);
+            pgdbref->gen = pcon->gdb_gen;
+         }
+      }
+   }
+
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_global_reference: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+/* v1.3.15 allocate the table of global databases together with its hash index */
+DBXGDB * dbx_global_db_table(int max_dbs, int **pp_hash, unsigned int *phash_mask)
+{
+   unsigned int size;
+   DBXGDB *p_gdb;
+
+   /* at least twice as many slots as entries, so that a probe always ends at a free slot */
+   for (size = 16; size < (unsigned int) max_dbs * 2; size <<= 1)
+      ;
+   p_gdb = (DBXGDB *) dbx_malloc((int) ((sizeof(DBXGDB) * max_dbs) + (sizeof(int) * size)), DBX_MEMID_ENGINE);
+   if (!p_gdb) {
+      return NULL;
+   }
+   *pp_hash = (int *) (p_gdb + max_dbs);
+   memset((void *) *pp_hash, 0, sizeof(int) * size);
+   *phash_mask = size - 1;
+
+   return p_gdb;
+}
+
+
+/* v1.3.15 FNV-1a */
+unsigned int dbx_global_db_hash(char *name, int name_len)
+{
+   int n;
+   unsigned int h;
+
+   h = 2166136261U;
+   for (n = 0; n < name_len; n ++) {
+      h ^= (unsigned char) name[n];
+      h *= 16777619U;
+   }
+   return h;
+}
+
+
+/* v1.3.15 */
+int dbx_global_db(DBXMETH *pmeth, char *name, int name_len, short create, DBXGDB **ppgdb)
+{
+   int rc, n, max_dbs;
+   int *p_gdb_count, *p_gdb_hash;
+   unsigned int h, hash_mask;
+   char gname[256];
+   MDB_dbi dbi;
+   DB *pdb;
+   DBXGDB *p_gdb, *pgdb;
+   DBXCON *pcon = pmeth->pcon;
+
+   *ppgdb = NULL;
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      p_gdb = pcon->p_bdb_so->p_gdb;
+      p_gdb_count = &(pcon->p_bdb_so->gdb_count);
+      p_gdb_hash = pcon->p_bdb_so->p_gdb_hash;
+      hash_mask = pcon->p_bdb_so->gdb_hash_mask;
+      max_dbs = pcon->p_bdb_so->max_dbs;
+   }
+   else {
+      p_gdb = pcon->p_lmdb_so->p_gdb;
+      p_gdb_count = &(pcon->p_lmdb_so->gdb_count);
+      p_gdb_hash = pcon->p_lmdb_so->p_gdb_hash;
+      hash_mask = pcon->p_lmdb_so->gdb_hash_mask;
+      max_dbs = pcon->p_lmdb_so->max_dbs;
+   }
+
+   if (!p_gdb || name_len < 1 || name_len > 250) {
+      strcpy(pcon->error, "Invalid global name");
+      return CACHE_FAILURE;
+   }
+
+   /* the search ends at the global's entry or at the free slot that it would occupy */
+   pgdb = NULL;
+   for (h = dbx_global_db_hash(name, name_len) & hash_mask; (n = p_gdb_hash[h]) > 0; h = (h + 1) & hash_mask) {
+      if (p_gdb[n - 1].name_len == name_len && !memcmp((void *) p_gdb[n - 1].name, (void *) name, (size_t) name_len)) {
+         pgdb = &(p_gdb[n - 1]);
          break;
-      case DB_TXN_CKP:
-         sprintf(pcon->error, "BDB error %d (DB_TXN_CKP) Encountered ckp record in log.", error_code);
+      }
+   }
+   if (pgdb && pgdb->open) {
+      *ppgdb = pgdb;
+      return CACHE_SUCCESS;
+   }
+   if (!pgdb && *p_gdb_count >= max_dbs) {
+      sprintf(pcon->error, "The maximum number of global databases (%d) has been reached: increase max_dbs in the open() method", max_dbs);
+      return DBX_GDB_FULL;
+   }
+   memcpy((void *) gname, (void *) name, (size_t) name_len);
+   gname[name_len] = '\0';
+
+   /* a global is only entered in the table once its database has been opened: looking up globals that do not exist takes no slots */
+   dbi = 0;
+   pdb = NULL;
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      rc = pcon->p_bdb_so->p_db_create(&pdb, pcon->p_bdb_so->penv, 0);
+      if (rc != 0) {
+         strcpy(pcon->error, "Cannot create a BDB object");
+         return rc;
+      }
+      bdb_db_config(pcon, pdb); /* v1.3.30 */
+      rc = pdb->open(pdb, NULL, pcon->db_file, gname, DB_BTREE, (create ? DB_CREATE : 0) | (pcon->bdb.txn ? DB_AUTO_COMMIT : 0), 0);
+      if (rc != 0) {
+         pdb->close(pdb, 0);
+         if (rc == ENOENT && !create) { /* global does not exist yet */
+            rc = CACHE_SUCCESS;
+         }
+         return rc;
+      }
+   }
+   else {
+      MDB_txn *ptxn;
+
+      /* named databases are visible to transactions started after the one that opened them commits */
+      rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, create ? 0 : MDB_RDONLY, &ptxn);
+      if (rc != 0) {
+         strcpy(pcon->error, "Cannot create or open a LMDB transaction for a global database");
+         return rc;
+      }
+      rc = pcon->p_lmdb_so->p_mdb_dbi_open(ptxn, gname, create ? MDB_CREATE : 0, &dbi);
+      if (rc != 0) {
+         pcon->p_lmdb_so->p_mdb_txn_abort(ptxn);
+         if (rc == MDB_NOTFOUND && !create) { /* global does not exist yet */
+            rc = CACHE_SUCCESS;
+         }
+         return rc;
+      }
+      rc = pcon->p_lmdb_so->p_mdb_txn_commit(ptxn);
+      if (rc != 0) {
+         return rc;
+      }
+   }
+
+   if (!pgdb) {
+      pgdb = &(p_gdb[*p_gdb_count]);
+      memcpy((void *) pgdb->name, (void *) gname, (size_t) name_len + 1);
+      pgdb->name_len = name_len;
+      (*p_gdb_count) ++;
+      p_gdb_hash[h] = *p_gdb_count;
+   }
+   pgdb->dbi = dbi;
+   pgdb->pdb = pdb;
+   pgdb->open = 1;
+   *ppgdb = pgdb;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v1.3.15 remove a global's database in its entirety (BDB) */
+int dbx_global_db_drop(DBXMETH *pmeth, DBXGDB *pgdb)
+{
+   int rc;
+   DB *pdb;
+   DBXCON *pcon = pmeth->pcon;
+
+   rc = CACHE_SUCCESS;
+   if (!pgdb || !pgdb->open) {
+      return rc;
+   }
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      pgdb->pdb->close(pgdb->pdb, 0);
+      pgdb->pdb = NULL;
+      pgdb->open = 0;
+      if (pcon->bdb.txn) { /* v1.3.30 */
+         rc = pcon->p_bdb_so->penv->dbremove(pcon->p_bdb_so->penv, NULL, pcon->db_file, pgdb->name, DB_AUTO_COMMIT);
+      }
+      else {
+         rc = pcon->p_bdb_so->p_db_create(&pdb, pcon->p_bdb_so->penv, 0);
+         if (rc == 0) {
+            rc = pdb->remove(pdb, pcon->db_file, pgdb->name, 0); /* handle is discarded by remove */
+         }
+      }
+   }
+
+   return rc;
+}
+
+
+/* v1.3.15 walk the directory of global databases */
+int dbx_global_db_order(DBXMETH *pmeth, DBXQR *pqr_prev, short dir)
+{
+   int rc, len;
+   char *name;
+   DBXCON *pcon = pmeth->pcon;
+
+   /* seed is the last global name returned, as held in the query object */
+   name = pqr_prev->global_name.buf_addr;
+   len = (int) pqr_prev->global_name.len_used;
+   if (len > 0 && name[0] == '^') {
+      name ++;
+      len --;
+   }
+   pmeth->output_val.svalue.len_used = 0;
+
+   rc = YDB_NODE_END;
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DB *pdb;
+      DBC *pcursor;
+      DBT key, data;
+
+      rc = pcon->p_bdb_so->p_db_create(&pdb, pcon->p_bdb_so->penv, 0);
+      if (rc != 0) {
+         return rc;
+      }
+      /* the master database of a file holding sub-databases lists their names */
+      rc = pdb->open(pdb, NULL, pcon->db_file, NULL, DB_UNKNOWN, DB_RDONLY, 0);
+      if (rc != 0) {
+         pdb->close(pdb, 0);
+         return YDB_NODE_END;
+      }
+      rc = pdb->cursor(pdb, NULL, &pcursor, 0);
+      if (rc == 0) {
+         memset(&key, 0, sizeof(DBT));
+         memset(&data, 0, sizeof(DBT));
+         key.data = (void *) name;
+         key.size = (u_int32_t) len;
+         if (len == 0) {
+            rc = pcursor->get(pcursor, &key, &data, dir == 1 ? DB_FIRST : DB_LAST);
+         }
+         else {
+            rc = pcursor->get(pcursor, &key, &data, DB_SET_RANGE);
+            if (dir == 1) {
+               if (rc == 0 && key.size == (u_int32_t) len && !memcmp(key.data, (void *) name, (size_t) len)) {
+                  rc = pcursor->get(pcursor, &key, &data, DB_NEXT);
+               }
+            }
+            else {
+               rc = pcursor->get(pcursor, &key, &data, rc == 0 ? DB_PREV : DB_LAST);
+            }
+         }
+         if (rc == 0) {
+            dbx_memcpy_exx(&(pmeth->output_val.svalue), key.data, (size_t) key.size);
+         }
+         pcursor->close(pcursor);
+      }
+      pdb->close(pdb, 0);
+   }
+   else {
+      MDB_cursor *pcursor;
+      MDB_val key, data;
+
+      lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &pcursor);
+      if (rc == 0) {
+         key.mv_data = (void *) name;
+         key.mv_size = (size_t) len;
+         if (len == 0) {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, dir == 1 ? MDB_FIRST : MDB_LAST);
+         }
+         else {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+            if (dir == 1) {
+               if (rc == 0 && key.mv_size == (size_t) len && !memcmp(key.mv_data, (void *) name, (size_t) len)) {
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+               }
+            }
+            else {
+               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, rc == 0 ? MDB_PREV : MDB_LAST);
+            }
+         }
+         if (rc == 0) {
+            dbx_memcpy_exx(&(pmeth->output_val.svalue), key.mv_data, key.mv_size);
+         }
+         pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+      }
+      lmdb_commit_ro_transaction(pmeth, 0);
+   }
+
+   if (rc != 0 || pmeth->output_val.svalue.len_used == 0) {
+      pmeth->output_val.svalue.len_used = 0;
+      return YDB_NODE_END;
+   }
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v1.3.15 */
+int dbx_global_db_close(DBXCON *pcon)
+{
+   int n;
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      if (pcon->p_bdb_so->p_gdb) {
+         for (n = 0; n < pcon->p_bdb_so->gdb_count; n ++) {
+            if (pcon->p_bdb_so->p_gdb[n].open && pcon->p_bdb_so->p_gdb[n].pdb) {
+               pcon->p_bdb_so->p_gdb[n].pdb->close(pcon->p_bdb_so->p_gdb[n].pdb, 0);
+            }
+         }
+         dbx_free((void *) pcon->p_bdb_so->p_gdb, 0);
+         pcon->p_bdb_so->p_gdb = NULL;
+         pcon->p_bdb_so->p_gdb_hash = NULL; /* v1.3.15 freed with the table */
+         pcon->p_bdb_so->gdb_count = 0;
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      if (pcon->p_lmdb_so->p_gdb) {
+         for (n = 0; n < pcon->p_lmdb_so->gdb_count; n ++) {
+            if (pcon->p_lmdb_so->p_gdb[n].open) {
+               pcon->p_lmdb_so->p_mdb_dbi_close(pcon->p_lmdb_so->penv, pcon->p_lmdb_so->p_gdb[n].dbi);
+            }
+         }
+         dbx_free((void *) pcon->p_lmdb_so->p_gdb, 0);
+         pcon->p_lmdb_so->p_gdb = NULL;
+         pcon->p_lmdb_so->p_gdb_hash = NULL; /* v1.3.15 freed with the table */
+         pcon->p_lmdb_so->gdb_count = 0;
+      }
+   }
+
+   return 0;
+}
+
+
+int dbx_get(DBXMETH *pmeth)
+{
+   int rc, chunked;
+   DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
+
+#ifdef _WIN32
+__try {
+#endif
+
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
+
+   rc = dbx_global_reference(pmeth);
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_get");
+      goto dbx_get_exit;
+   }
+
+   if (DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 not the main database */
+      rc = CACHE_ERUNDEF;
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT key, data;
+
+      memset(&key, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+      data.flags = DB_DBT_USERMEM;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+      }
+
+      data.data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
+
+/* v1.1.4
+      {
+         int rc1;
+         rc1 = pcon->p_bdb_so->pdb->sync(pcon->p_bdb_so->pdb, 0);
+      }
+*/
+      rc = bdb_get(pmeth, &key, &data, &(pmeth->output_val.svalue));
+      if (rc == CACHE_FAILURE) {
+         dbx_error_message(pmeth, rc, (char *) "dbx_get");
+         goto dbx_get_exit;
+      }
+
+      /* v1.3.9 */
+      pmeth->output_val.svalue.len_used = data.size;
+
+      if (rc == CACHE_SUCCESS && dbx_expired(pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used)) { /* v1.3.27 */
+         rc = DB_NOTFOUND;
+      }
+      if (rc == CACHE_SUCCESS && dbx_zunpack_inplace(&(pmeth->output_val.svalue)) == DBX_ZUNPACK_VERBATIM) { /* v1.3.23 */
+         pmeth->tvalue = DBX_TVALUE_NONE; /* v1.3.27 not a typed value */
+      }
+
+      /* v1.3.11 */
+/*
+      if (pmeth->output_val.svalue.len_used == 0 && rc != DB_NOTFOUND) {
+         if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
+            dbx_dump_mref(pcon, pmeth, (char *) "get", &(pmeth->output_val), rc);
+         }
+      }
+*/
+
+      if (rc == DB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
+         key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;;
+      }
+
+      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.mv_size = (size_t) pmeth->output_val.svalue.len_alloc;
+
+      rc = lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &key, &data);
+      chunked = 0;
+      if (rc == CACHE_SUCCESS) { /* v1.3.22 a value held in chunks is read before the transaction ends */
+         chunked = lmdb_chunk_str(pmeth, pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), NULL, &key, &data, &(pmeth->output_val.svalue));
+         if (chunked < 0) {
+            rc = CACHE_FAILURE;
+         }
+      }
+      lmdb_commit_ro_transaction(pmeth, 0);
+
+      /* v1.3.11 */
+/*
+      if (pmeth->output_val.svalue.len_used == 0 && rc != MDB_NOTFOUND) {
+         if (pmeth->key.argc > 3) {
+            if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
+               dbx_dump_mref(pcon, pmeth, (char *) "get", &(pmeth->output_val), rc);
+            }
+         }
+      }
+*/
+
+      if (rc == CACHE_SUCCESS && dbx_expired((char *) data.mv_data, data.mv_size)) { /* v1.3.27 */
+         rc = MDB_NOTFOUND;
+      }
+      if (rc == CACHE_SUCCESS && chunked) {
+         pmeth->tvalue = DBX_TVALUE_NONE; /* v1.3.22 written by the range functions: not a typed value */
+      }
+      else if (rc == CACHE_SUCCESS) {
+         if (dbx_zunpack_str(&(pmeth->output_val.svalue), (char *) data.mv_data, data.mv_size) == DBX_ZUNPACK_VERBATIM) { /* v1.3.23 */
+            pmeth->tvalue = DBX_TVALUE_NONE; /* v1.3.27 not a typed value */
+         }
+      }
+      else {
+         pmeth->output_val.svalue.len_used = 0;
+         if (rc == MDB_NOTFOUND) {
+            rc = CACHE_ERUNDEF;
+         }
+      }
+   }
+
+   if (rc == CACHE_ERUNDEF) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) "", DBX_DTYPE_STR8);
+   }
+   else if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_get");
+   }
+
+dbx_get_exit:
+
+   DBX_DB_UNLOCK();
+
+   DBX_STATS_END(pmeth, DBX_STATS_GET, tstats, rc);
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_get: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+/* v1.3.21 Get a record into a caller supplied buffer: *plen is set to the length of the record, which is only copied if it fits */
+int dbx_get_into(DBXMETH *pmeth, char *buffer, size_t size, size_t *plen)
+{
+   int rc;
+   unsigned int chunk_size;
+   DBXCON *pcon = pmeth->pcon;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   *plen = 0;
+
+   DBX_DB_LOCK(0);
+
+   rc = dbx_global_reference(pmeth);
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_get_into");
+      goto dbx_get_into_exit;
+   }
+
+   if (DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 not the main database */
+      *plen = 0;
+      rc = CACHE_ERUNDEF;
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DB *pdb;
+      DBT key, data;
+
+      memset(&key, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+      data.flags = DB_DBT_USERMEM;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+      }
+
+      /* BDB writes the record straight into the target, or reports the size needed */
+      data.data = (void *) buffer;
+      data.ulen = (u_int32_t) (size > 0xffffffff ? 0xffffffff : size);
+
+      pdb = DBX_BDB_PDB(pmeth);
+      if (pdb) {
+         rc = pdb->get(pdb, NULL, &key, &data, 0);
+      }
+      else {
+         rc = DB_NOTFOUND;
+      }
+
+      if (rc == CACHE_SUCCESS || rc == DB_BUFFER_SMALL) {
+         *plen = (size_t) data.size;
+         rc = CACHE_SUCCESS;
+
+         /* v1.3.23 compressed values are decompressed into the target */
+         if (data.size > DBX_ZHEADER_SIZE) {
+            char *zdata;
+            size_t zlen, olen;
+
+            zdata = NULL;
+            zlen = (size_t) data.size;
+            if (zlen <= size) {
+               if (dbx_zpacked(buffer, zlen) && (zdata = (char *) dbx_malloc((int) zlen, DBX_MEMID_VALUE))) {
+                  memcpy((void *) zdata, (void *) buffer, zlen);
+               }
+            }
+            else {
+               char zhead[DBX_ZHEADER_SIZE];
+
+               memset(&data, 0, sizeof(DBT));
+               data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+               data.data = (void *) zhead;
+               data.ulen = DBX_ZHEADER_SIZE;
+               data.doff = 0;
+               data.dlen = DBX_ZHEADER_SIZE;
+               if (pdb->get(pdb, NULL, &key, &data, 0) == CACHE_SUCCESS && dbx_zpacked(zhead, zlen) && (zdata = (char *) dbx_malloc((int) zlen, DBX_MEMID_VALUE))) {
+                  memset(&data, 0, sizeof(DBT));
+                  data.flags = DB_DBT_USERMEM;
+                  data.data = (void *) zdata;
+                  data.ulen = (u_int32_t) zlen;
+                  if (pdb->get(pdb, NULL, &key, &data, 0) != CACHE_SUCCESS || data.size != zlen) {
+                     dbx_free((void *) zdata, 0);
+                     zdata = NULL;
+                  }
+               }
+            }
+            if (zdata && dbx_expired(zdata, zlen)) { /* v1.3.27 */
+               *plen = 0;
+               rc = CACHE_ERUNDEF;
+            }
+            else if (zdata) {
+               olen = dbx_zlength(zdata, zlen);
+               if (olen > size) {
+                  *plen = olen;
+               }
+               else if (dbx_zunpack(zdata, zlen, buffer, size) == CACHE_SUCCESS) {
+                  *plen = olen;
+               }
+               else if (zlen <= size) { /* not a valid compressed value */
+                  memcpy((void *) buffer, (void *) zdata, zlen);
+               }
+               dbx_free((void *) zdata, 0);
+            }
+         }
+      }
+      else if (rc == DB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
+         key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+      }
+
+      rc = lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &key, &data);
+      if (rc == CACHE_SUCCESS && dbx_expired((char *) data.mv_data, data.mv_size)) { /* v1.3.27 */
+         *plen = 0;
+         rc = CACHE_ERUNDEF;
+      }
+      else if (rc == CACHE_SUCCESS && dbx_chunked((char *) data.mv_data, data.mv_size, plen, &chunk_size)) { /* v1.3.22 */
+         if (*plen <= size) {
+            rc = lmdb_chunk_get(pmeth, pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), NULL, &key, chunk_size, 0, *plen, buffer);
+         }
+      }
+      else if (rc == CACHE_SUCCESS) {
+         *plen = data.mv_size;
+         if (dbx_zpacked((char *) data.mv_data, data.mv_size)) { /* v1.3.23 */
+            *plen = dbx_zlength((char *) data.mv_data, data.mv_size);
+            if (*plen <= size && dbx_zunpack((char *) data.mv_data, data.mv_size, buffer, size) != CACHE_SUCCESS) {
+               *plen = data.mv_size; /* not a valid compressed value */
+               if (data.mv_size <= size) {
+                  memcpy((void *) buffer, (void *) data.mv_data, data.mv_size);
+               }
+            }
+         }
+         else if (data.mv_size <= size) {
+            memcpy((void *) buffer, (void *) data.mv_data, data.mv_size);
+         }
+      }
+      else if (rc == MDB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+      }
+      lmdb_commit_ro_transaction(pmeth, 0);
+   }
+
+   if (rc != CACHE_SUCCESS && rc != CACHE_ERUNDEF) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_get_into");
+   }
+
+dbx_get_into_exit:
+
+   DBX_DB_UNLOCK();
+
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_get_into: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+/* v1.3.20 Get a record without copying it: on success *pdata points into the LMDB map and *ppsnap holds a reference to the read snapshot that keeps it valid */
+int dbx_get_view(DBXMETH *pmeth, MDB_val *pdata, DBXSNAP **ppsnap)
+{
+   int rc;
+   DBXCON *pcon = pmeth->pcon;
+   DBXSNAP *psnap;
+   MDB_val key;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   *ppsnap = NULL;
+   pdata->mv_data = NULL;
+   pdata->mv_size = 0;
+
+   DBX_DB_LOCK(0);
+
+   rc = dbx_global_reference(pmeth);
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_get_view");
+      goto dbx_get_view_exit;
+   }
+   if (DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 not the main database */
+      rc = CACHE_ERUNDEF;
+      goto dbx_get_view_exit;
+   }
+
+   if (pcon->key_type == DBX_KEYTYPE_INT) {
+      key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
+      key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
+   }
+   else if (pcon->key_type == DBX_KEYTYPE_STR) {
+      key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+      key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+   }
+   else { /* mumps */
+      key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+      key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+   }
+
+   rc = lmdb_view_snapshot(pmeth, &psnap);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_get_view");
+      goto dbx_get_view_exit;
+   }
+
+   rc = pcon->p_lmdb_so->p_mdb_get(psnap->ptxn, DBX_LMDB_DBI(pmeth), &key, pdata);
+
+   psnap->refs ++;
+   if (rc == CACHE_SUCCESS && dbx_expired((char *) pdata->mv_data, pdata->mv_size)) { /* v1.3.27 */
+      rc = MDB_NOTFOUND;
+   }
+   if (rc == CACHE_SUCCESS && lmdb_chunk_str(pmeth, psnap->ptxn, DBX_LMDB_DBI(pmeth), NULL, &key, pdata, &(pmeth->output_val.svalue))) {
+      /* v1.3.22 nor can a value held in chunks: it is returned in the output buffer */
+      lmdb_view_release(NULL, (void *) psnap);
+      pdata->mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+      pdata->mv_size = (size_t) pmeth->output_val.svalue.len_used;
+   }
+   else if (rc == CACHE_SUCCESS && dbx_zpacked((char *) pdata->mv_data, pdata->mv_size)) {
+      /* v1.3.23 a compressed value cannot be viewed in place: return it decompressed in the output buffer */
+      dbx_zunpack_str(&(pmeth->output_val.svalue), (char *) pdata->mv_data, pdata->mv_size);
+      lmdb_view_release(NULL, (void *) psnap);
+      pdata->mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+      pdata->mv_size = (size_t) pmeth->output_val.svalue.len_used;
+   }
+   else if (rc == CACHE_SUCCESS) {
+      *ppsnap = psnap;
+   }
+   else {
+      lmdb_view_release(NULL, (void *) psnap);
+      pdata->mv_data = NULL;
+      pdata->mv_size = 0;
+      if (rc == MDB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+      }
+      else {
+         dbx_error_message(pmeth, rc, (char *) "dbx_get_view");
+      }
+   }
+
+dbx_get_view_exit:
+
+   DBX_DB_UNLOCK();
+
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_get_view: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+/* v1.3.23 Compression options: true/false, an algorithm name or {algo: <name>, min_size: <bytes>} */
+int dbx_compression_options(v8::Isolate * isolate, v8::Local<v8::Context> icontext, v8::Local<v8::Value> value, DBXCOMP *pcomp)
+{
+   int otype;
+   char buffer[32];
+   v8::Local<v8::Object> obj;
+   v8::Local<v8::Value> algo, min_size;
+
+   pcomp->min_size = DBX_COMPRESS_MIN_SIZE;
+
+   if (value->IsBoolean()) {
+      pcomp->algo = (value->IsTrue() ? DBX_COMPRESS_LZ4 : DBX_COMPRESS_NONE);
+      return 0;
+   }
+
+   algo = value;
+   obj = dbx_is_object(value, &otype);
+   if (otype == 1) {
+      algo = DBX_GET(obj, dbx_new_string8(isolate, (char *) "algo", 1));
+      min_size = DBX_GET(obj, dbx_new_string8(isolate, (char *) "min_size", 1));
+      if (min_size->IsNumber()) {
+         pcomp->min_size = (unsigned int) (DBX_NUMBER_VALUE(min_size) > 0 ? DBX_NUMBER_VALUE(min_size) : 0);
+      }
+      if (algo->IsUndefined()) {
+         pcomp->algo = DBX_COMPRESS_LZ4;
+         return 0;
+      }
+   }
+
+   if (!algo->IsString()) {
+      return -1;
+   }
+   DBX_WRITE_UTF8(DBX_TO_STRING(algo), buffer, sizeof(buffer));
+   dbx_lcase(buffer);
+   if (!strcmp(buffer, "lz4")) {
+      pcomp->algo = DBX_COMPRESS_LZ4;
+   }
+   else if (!strcmp(buffer, "none")) {
+      pcomp->algo = DBX_COMPRESS_NONE;
+   }
+   else {
+      return -1;
+   }
+
+   return 0;
+}
+
+
+/* v1.3.26 Parse a secondary index definition: {key_path: [...], value_path: [...], index_global: <name>} */
+int dbx_index_options(v8::Isolate * isolate, v8::Local<v8::Context> icontext, v8::Local<v8::Value> global, v8::Local<v8::Value> value, DBXINDEX **ppidx)
+{
+   int n, otype, len, size;
+   char *p;
+   char buffer[256];
+   DBXINDEX *pidx;
+   v8::Local<v8::Object> obj;
+   v8::Local<v8::Value> key_path, value_path, index_global, item;
+
+   *ppidx = NULL;
+   obj = dbx_is_object(value, &otype);
+   if (otype != 1 || !global->IsString()) {
+      return -1;
+   }
+   key_path = DBX_GET(obj, dbx_new_string8(isolate, (char *) "key_path", 1));
+   value_path = DBX_GET(obj, dbx_new_string8(isolate, (char *) "value_path", 1));
+   index_global = DBX_GET(obj, dbx_new_string8(isolate, (char *) "index_global", 1));
+   if (!key_path->IsArray() || !index_global->IsString()) {
+      return -1;
+   }
+   v8::Local<v8::Array> akey = v8::Local<v8::Array>::Cast(key_path);
+   if (akey->Length() < 1 || akey->Length() >= (DBX_MAXARGS - 2)) {
+      return -1;
+   }
+
+   pidx = (DBXINDEX *) dbx_malloc(sizeof(DBXINDEX), DBX_MEMID_INDEX);
+   if (!pidx) {
+      return -1;
+   }
+   memset((void *) pidx, 0, sizeof(DBXINDEX));
+   pidx->pikey = (DBXKEY *) dbx_malloc(sizeof(DBXKEY), DBX_MEMID_INDEX);
+   if (pidx->pikey) {
+      memset((void *) pidx->pikey, 0, sizeof(DBXKEY));
+   }
+   pidx->kpath = (char *) dbx_malloc(256 * akey->Length(), DBX_MEMID_INDEX);
+   if (!pidx->pikey || !pidx->kpath) {
+      goto dbx_index_options_error;
+   }
+
+   DBX_WRITE_UTF8(DBX_TO_STRING(global), buffer, sizeof(buffer));
+   p = (buffer[0] == '^') ? buffer + 1 : buffer;
+   strcpy(pidx->global, p);
+   pidx->global_len = (int) strlen(pidx->global);
+   DBX_WRITE_UTF8(DBX_TO_STRING(index_global), buffer, sizeof(buffer));
+   p = (buffer[0] == '^') ? buffer + 1 : buffer;
+   strcpy(pidx->index, p);
+   pidx->index_len = (int) strlen(pidx->index);
+   if (pidx->global_len < 1 || pidx->index_len < 1 || (pidx->global_len == pidx->index_len && !strcmp(pidx->global, pidx->index))) {
+      goto dbx_index_options_error;
+   }
+
+   /* subscripts to be matched: '*' (or null) matches any subscript */
+   size = 0;
+   pidx->keyn = (int) akey->Length();
+   for (n = 0; n < pidx->keyn; n ++) {
+      item = DBX_GET(akey, n);
+      pidx->kpath_offs[n] = size;
+      pidx->kpath_len[n] = -1;
+      if (item->IsNull() || item->IsUndefined()) {
+         continue;
+      }
+      DBX_WRITE_UTF8(DBX_TO_STRING(item), buffer, sizeof(buffer));
+      if (!strcmp(buffer, "*")) {
+         continue;
+      }
+      len = (int) strlen(buffer);
+      memcpy((void *) (pidx->kpath + size), (void *) buffer, (size_t) len);
+      pidx->kpath_len[n] = len;
+      size += len;
+   }
+
+   /* subscripts that follow the value in the index: by default, those matched by '*' */
+   pidx->vpathn = 0;
+   if (value_path->IsArray()) {
+      v8::Local<v8::Array> avalue = v8::Local<v8::Array>::Cast(value_path);
+      for (n = 0; n < (int) avalue->Length() && n < (DBX_MAXARGS - 2); n ++) {
+         item = DBX_GET(avalue, n);
+         if (!item->IsNumber() || DBX_INT32_VALUE(item) < 1 || DBX_INT32_VALUE(item) > pidx->keyn) {
+            goto dbx_index_options_error;
+         }
+         pidx->vpath[pidx->vpathn ++] = DBX_INT32_VALUE(item);
+      }
+   }
+   else if (!value_path->IsUndefined()) {
+      goto dbx_index_options_error;
+   }
+   else {
+      for (n = 0; n < pidx->keyn; n ++) {
+         if (pidx->kpath_len[n] < 0) {
+            pidx->vpath[pidx->vpathn ++] = n + 1;
+         }
+      }
+   }
+
+   *ppidx = pidx;
+   return 0;
+
+dbx_index_options_error:
+
+   dbx_index_free(pidx);
+   return -1;
+}
+
+
+/* v1.3.23 Compressed values are stored with an 8 byte header: 0x00 0xDB 'Z' <algorithm> <original length: 4 bytes, little endian> */
+/* v1.3.27 Values that begin with 0x00 0xDB are stored with this header and algorithm DBX_COMPRESS_NONE (escaped) */
+int dbx_zpacked(char *data, size_t len)
+{
+   unsigned char *p = (unsigned char *) data;
+
+   if (len > DBX_ZHEADER_SIZE && p[0] == 0x00 && p[1] == 0xDB && p[2] == 'Z' && (p[3] == DBX_COMPRESS_LZ4 || p[3] == DBX_COMPRESS_NONE)) {
+      return 1;
+   }
+   if (len > DBX_ZHEADER_SIZE && p[0] == 0x00 && p[1] == 0xDB && p[2] == 'E' && p[3] == 0x00) { /* v1.3.27 the value has a time to live */
+      return 1;
+   }
+   return 0;
+}
+
+
+/* Length of the value held in a packed record */
+size_t dbx_zlength(char *data, size_t len)
+{
+   unsigned char *p = (unsigned char *) data;
+
+   if (p[2] == 'E') { /* v1.3.27 */
+      if (len < DBX_EHEADER_SIZE) {
+         return 0;
+      }
+      p += DBX_EHEADER_SIZE;
+      len -= DBX_EHEADER_SIZE;
+      if (!(len > DBX_ZHEADER_SIZE && p[0] == 0x00 && p[1] == 0xDB && p[2] == 'Z' && (p[3] == DBX_COMPRESS_LZ4 || p[3] == DBX_COMPRESS_NONE))) {
+         return len;
+      }
+   }
+   return (size_t) p[4] | ((size_t) p[5] << 8) | ((size_t) p[6] << 16) | ((size_t) p[7] << 24);
+}
+
+
+/* Returns 1 with *ppacked allocated (to be released with dbx_free) if the value is to be stored compressed */
+int dbx_zpack(DBXMETH *pmeth, char *data, size_t len, char **ppacked, size_t *ppacked_len)
+{
+   int clen;
+   unsigned char *p;
+
+   *ppacked = NULL;
+   *ppacked_len = 0;
+
+   if (!pmeth->pcomp || pmeth->pcomp->algo != DBX_COMPRESS_LZ4 || len < pmeth->pcomp->min_size || len < 32 || len > 0x7fffff00) {
+      return dbx_vpack(pmeth, data, len, ppacked, ppacked_len); /* v1.3.27 */
+   }
+
+   p = (unsigned char *) dbx_malloc((int) (DBX_ZHEADER_SIZE + DBX_LZ4_BOUND(len)), DBX_MEMID_VALUE);
+   if (!p) {
+      return 0;
+   }
+
+   /* only worth keeping if it saves space */
+   clen = dbx_lz4_compress((unsigned char *) data, (int) len, p + DBX_ZHEADER_SIZE, (int) (len - DBX_ZHEADER_SIZE - 1));
+   if (clen <= 0) {
+      dbx_free((void *) p, 0);
+      return dbx_vpack(pmeth, data, len, ppacked, ppacked_len); /* v1.3.27 */
+   }
+
+   p[0] = 0x00;
+   p[1] = 0xDB;
+   p[2] = 'Z';
+   p[3] = DBX_COMPRESS_LZ4;
+   p[4] = (unsigned char) (len & 0xff);
+   p[5] = (unsigned char) ((len >> 8) & 0xff);
+   p[6] = (unsigned char) ((len >> 16) & 0xff);
+   p[7] = (unsigned char) ((len >> 24) & 0xff);
+
+   *ppacked = (char *) p;
+   *ppacked_len = (size_t) clen + DBX_ZHEADER_SIZE;
+
+   if (pmeth->expiry) { /* v1.3.27 */
+      char *zdata;
+      size_t zlen;
+
+      zdata = *ppacked;
+      zlen = *ppacked_len;
+      if (!dbx_epack(pmeth, zdata, zlen, ppacked, ppacked_len)) {
+         *ppacked = zdata;
+         *ppacked_len = zlen;
+      }
+      else {
+         dbx_free((void *) zdata, 0);
+      }
+   }
+   return 1;
+}
+
+
+int dbx_zunpack(char *data, size_t len, char *out, size_t out_size)
+{
+   int n;
+   size_t olen;
+
+   olen = dbx_zlength(data, len);
+   if (olen > out_size) {
+      return CACHE_FAILURE;
+   }
+   if (((unsigned char *) data)[2] == 'E') { /* v1.3.27 */
+      data += DBX_EHEADER_SIZE;
+      len -= DBX_EHEADER_SIZE;
+      if (((unsigned char *) data)[2] != 'Z' || len <= DBX_ZHEADER_SIZE) {
+         memcpy((void *) out, (void *) data, len);
+         return CACHE_SUCCESS;
+      }
+   }
+   if (((unsigned char *) data)[3] == DBX_COMPRESS_NONE) { /* v1.3.27 */
+      memcpy((void *) out, (void *) (data + DBX_ZHEADER_SIZE), olen);
+      return CACHE_SUCCESS;
+   }
+   n = dbx_lz4_decompress((unsigned char *) data + DBX_ZHEADER_SIZE, (int) (len - DBX_ZHEADER_SIZE), (unsigned char *) out, (int) olen);
+   if (n < 0 || (size_t) n != olen) {
+      return CACHE_FAILURE;
+   }
+   return CACHE_SUCCESS;
+}
+
+
+/* Copy a stored value into pstr, decompressing it if necessary: data must not be in pstr's buffer */
+/* v1.3.27 returns DBX_ZUNPACK_VERBATIM if the value was escaped: it must not be read as a typed value */
+int dbx_zunpack_str(DBXSTR *pstr, char *data, size_t len)
+{
+   size_t olen;
+
+   if (dbx_zpacked(data, len)) {
+      olen = dbx_zlength(data, len);
+      if (pstr->len_alloc < olen) {
+         dbx_buffer_resize(&(pstr->buf_addr), 0, (unsigned int) olen + 32, &(pstr->len_alloc));
+      }
+      if (pstr->len_alloc >= olen && dbx_zunpack(data, len, pstr->buf_addr, (size_t) pstr->len_alloc) == CACHE_SUCCESS) {
+         pstr->len_used = (unsigned int) olen;
+         return dbx_zverbatim(data, len) ? DBX_ZUNPACK_VERBATIM : 1;
+      }
+   }
+   dbx_memcpy_exx(pstr, (void *) data, len); /* not compressed (or not a valid compressed value) */
+   return 0;
+}
+
+
+int dbx_zunpack_inplace(DBXSTR *pstr)
+{
+   int rc;
+   char *p;
+
+   if (!dbx_zpacked(pstr->buf_addr, (size_t) pstr->len_used)) {
+      return 0;
+   }
+   p = (char *) dbx_malloc((int) pstr->len_used, DBX_MEMID_VALUE);
+   if (!p) {
+      return 0;
+   }
+   memcpy((void *) p, (void *) pstr->buf_addr, (size_t) pstr->len_used);
+   rc = dbx_zunpack_str(pstr, p, (size_t) pstr->len_used);
+   dbx_free((void *) p, 0);
+
+   return rc;
+}
+
+
+/* v1.3.27 Returns 1 if a stored value holds data that was escaped because it begins with the header bytes */
+int dbx_zverbatim(char *data, size_t len)
+{
+   unsigned char *p = (unsigned char *) data;
+
+   if (dbx_expiry(data, len)) {
+      p += DBX_EHEADER_SIZE;
+      len -= DBX_EHEADER_SIZE;
+   }
+   if (len > DBX_ZHEADER_SIZE && p[0] == 0x00 && p[1] == 0xDB && p[2] == 'Z' && p[3] == DBX_COMPRESS_NONE) {
+      return 1;
+   }
+   return 0;
+}
+
+
+/* v1.3.27 Returns 1 with *ppacked allocated (to be released with dbx_free) if the value is to be stored with a header */
+/* Data that begins with 0x00 0xDB (other than a typed value) is escaped so that it cannot be mistaken for a compressed, typed or time limited value */
+int dbx_vpack(DBXMETH *pmeth, char *data, size_t len, char **ppacked, size_t *ppacked_len)
+{
+   unsigned char *p;
+
+   if (len < 2 || ((unsigned char *) data)[0] != 0x00 || ((unsigned char *) data)[1] != 0xDB || pmeth->typed || len > 0x7fffff00) {
+      return dbx_epack(pmeth, data, len, ppacked, ppacked_len);
+   }
+
+   p = (unsigned char *) dbx_malloc((int) (DBX_ZHEADER_SIZE + len + 1), DBX_MEMID_VALUE);
+   if (!p) {
+      *ppacked = NULL;
+      *ppacked_len = 0;
+      return 0;
+   }
+   p[0] = 0x00;
+   p[1] = 0xDB;
+   p[2] = 'Z';
+   p[3] = DBX_COMPRESS_NONE;
+   p[4] = (unsigned char) (len & 0xff);
+   p[5] = (unsigned char) ((len >> 8) & 0xff);
+   p[6] = (unsigned char) ((len >> 16) & 0xff);
+   p[7] = (unsigned char) ((len >> 24) & 0xff);
+   memcpy((void *) (p + DBX_ZHEADER_SIZE), (void *) data, len);
+
+   *ppacked = (char *) p;
+   *ppacked_len = len + DBX_ZHEADER_SIZE;
+
+   if (pmeth->expiry) {
+      char *zdata;
+      size_t zlen;
+
+      zdata = *ppacked;
+      zlen = *ppacked_len;
+      if (!dbx_epack(pmeth, zdata, zlen, ppacked, ppacked_len)) {
+         *ppacked = zdata;
+         *ppacked_len = zlen;
+      }
+      else {
+         dbx_free((void *) zdata, 0);
+      }
+   }
+   return 1;
+}
+
+
+/* v1.3.27 Time to live */
+
+unsigned long long dbx_clock_ms(void)
+{
+#if defined(_WIN32)
+   FILETIME ft;
+   ULARGE_INTEGER t;
+
+   GetSystemTimeAsFileTime(&ft);
+   t.LowPart = ft.dwLowDateTime;
+   t.HighPart = ft.dwHighDateTime;
+   return (unsigned long long) ((t.QuadPart - 116444736000000000ULL) / 10000);
+#else
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+   return ((unsigned long long) tv.tv_sec * 1000) + (unsigned long long) (tv.tv_usec / 1000);
+#endif
+}
+
+
+/* v1.3.31 A monotonic clock (nanoseconds) for timing operations */
+unsigned long long dbx_clock_ns(void)
+{
+#if defined(_WIN32)
+   LARGE_INTEGER freq, count;
+
+   QueryPerformanceFrequency(&freq);
+   QueryPerformanceCounter(&count);
+   return (unsigned long long) ((double) count.QuadPart * (1000000000.0 / (double) freq.QuadPart));
+#else
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ((unsigned long long) ts.tv_sec * 1000000000ULL) + (unsigned long long) ts.tv_nsec;
+#endif
+}
+
+
+/* The deadline of a stored value: 0 if it does not expire */
+unsigned long long dbx_expiry(char *data, size_t len)
+{
+   int n;
+   unsigned long long deadline;
+   unsigned char *p = (unsigned char *) data;
+
+   if (len < DBX_EHEADER_SIZE || p[0] != 0x00 || p[1] != 0xDB || p[2] != 'E' || p[3] != 0x00) {
+      return 0;
+   }
+   deadline = 0;
+   for (n = 7; n >= 0; n --) {
+      deadline = (deadline << 8) | (unsigned long long) p[4 + n];
+   }
+   return deadline;
+}
+
+
+int dbx_expired(char *data, size_t len)
+{
+   unsigned long long deadline;
+
+   deadline = dbx_expiry(data, len);
+   if (deadline && deadline <= dbx_clock_ms()) {
+      return 1;
+   }
+   return 0;
+}
+
+
+/* Returns 1 with *ppacked allocated (to be released with dbx_free) if the value is to be stored with a deadline */
+int dbx_epack(DBXMETH *pmeth, char *data, size_t len, char **ppacked, size_t *ppacked_len)
+{
+   int n;
+   unsigned char *p;
+
+   *ppacked = NULL;
+   *ppacked_len = 0;
+
+   if (!pmeth->expiry) {
+      return 0;
+   }
+
+   p = (unsigned char *) dbx_malloc((int) (DBX_EHEADER_SIZE + len + 1), DBX_MEMID_VALUE);
+   if (!p) {
+      return 0;
+   }
+   p[0] = 0x00;
+   p[1] = 0xDB;
+   p[2] = 'E';
+   p[3] = 0x00;
+   for (n = 0; n < 8; n ++) {
+      p[4 + n] = (unsigned char) ((pmeth->expiry >> (n * 8)) & 0xff);
+   }
+   if (len) {
+      memcpy((void *) (p + DBX_EHEADER_SIZE), (void *) data, len);
+   }
+
+   *ppacked = (char *) p;
+   *ppacked_len = len + DBX_EHEADER_SIZE;
+   return 1;
+}
+
+
+/* A trailing options object for set(): {ttl: <seconds>} */
+int dbx_set_options(v8::Isolate * isolate, v8::Local<v8::Context> icontext, DBXMETH *pmeth, v8::Local<v8::Value> value)
+{
+   int otype;
+   double ttl;
+   Local<Object> obj;
+   Local<Value> option;
+
+   obj = dbx_is_object(value, &otype);
+   if (otype != 1 || value->IsArray()) {
+      return 0;
+   }
+   option = DBX_GET(obj, dbx_new_string8(isolate, (char *) "ttl", 1));
+   if (option->IsNumber()) {
+      ttl = DBX_NUMBER_VALUE(option);
+      if (ttl > 0) {
+         pmeth->expiry = dbx_clock_ms() + (unsigned long long) (ttl * 1000);
+      }
+   }
+   return 1;
+}
+
+
+/* v1.3.24 Typed values: 0x00 0xDB <tag> followed by an 8 byte little endian integer or IEEE double ('I' or 'D') or a single byte boolean ('B') */
+int dbx_tvalue_encode(v8::Isolate * isolate, v8::Local<v8::Context> icontext, v8::Local<v8::Value> value, char *buffer)
+{
+   if (value->IsBoolean()) {
+      buffer[0] = (char) 0x00;
+      buffer[1] = (char) 0xDB;
+      buffer[2] = DBX_TVALUE_BOOL;
+      buffer[3] = (char) (value->IsTrue() ? 1 : 0);
+      return DBX_TVALUE_HEADER_SIZE + 1;
+   }
+   if (value->IsNumber()) {
+      return dbx_tvalue_number(buffer, (double) DBX_NUMBER_VALUE(value));
+   }
+   return 0;
+}
+
+
+/* Integral values within the range that a double holds exactly are stored as integers */
+int dbx_tvalue_number(char *buffer, double value)
+{
+   int n;
+   unsigned long long u;
+   long long i64;
+
+   buffer[0] = (char) 0x00;
+   buffer[1] = (char) 0xDB;
+   if (value >= -9007199254740992.0 && value <= 9007199254740992.0 && (double) (i64 = (long long) value) == value) {
+      buffer[2] = DBX_TVALUE_INT64;
+      u = (unsigned long long) i64;
+   }
+   else {
+      buffer[2] = DBX_TVALUE_DOUBLE;
+      memcpy((void *) &u, (void *) &value, sizeof(u));
+   }
+   for (n = 0; n < 8; n ++) {
+      buffer[DBX_TVALUE_HEADER_SIZE + n] = (char) ((u >> (n * 8)) & 0xff);
+   }
+   return DBX_TVALUE_HEADER_SIZE + 8;
+}
+
+
+/* Returns the type of a typed value (DBX_DTYPE_INT64, DBX_DTYPE_DOUBLE or DBX_DTYPE_BOOL), or zero for a string */
+int dbx_tvalue_decode(char *data, size_t len, DBXVAL *pval)
+{
+   int n;
+   unsigned long long u;
+   unsigned char *p = (unsigned char *) data;
+
+   if (len <= DBX_TVALUE_HEADER_SIZE || p[0] != 0x00 || p[1] != 0xDB) {
+      return 0;
+   }
+   if ((p[2] == DBX_TVALUE_INT64 || p[2] == DBX_TVALUE_DOUBLE) && len == (DBX_TVALUE_HEADER_SIZE + 8)) {
+      u = 0;
+      for (n = 7; n >= 0; n --) {
+         u = (u << 8) | (unsigned long long) p[DBX_TVALUE_HEADER_SIZE + n];
+      }
+      if (p[2] == DBX_TVALUE_INT64) {
+         pval->type = DBX_DTYPE_INT64;
+         pval->num.int64 = (long long) u;
+      }
+      else {
+         pval->type = DBX_DTYPE_DOUBLE;
+         memcpy((void *) &(pval->num.real), (void *) &u, sizeof(u));
+      }
+      return pval->type;
+   }
+   if (p[2] == DBX_TVALUE_BOOL && len == (DBX_TVALUE_HEADER_SIZE + 1)) {
+      pval->type = DBX_DTYPE_BOOL;
+      pval->num.int32 = (p[3] ? 1 : 0);
+      return pval->type;
+   }
+   return 0;
+}
+
+
+/* Text form of a typed value (buffer must hold at least 32 bytes): returns its length or -1 for a string */
+int dbx_tvalue_format(char *data, size_t len, char *buffer)
+{
+   DBXVAL val;
+
+   switch (dbx_tvalue_decode(data, len, &val)) {
+      case DBX_DTYPE_INT64:
+         T_SPRINTF(buffer, 32, "%lld", val.num.int64);
          break;
-      case DB_VERIFY_FATAL:
-         sprintf(pcon->error, "BDB error %d (DB_VERIFY_FATAL) DB->verify cannot proceed", error_code);
+      case DBX_DTYPE_DOUBLE:
+         T_SPRINTF(buffer, 32, "%.15g", val.num.real);
+         if (strtod(buffer, NULL) != val.num.real) {
+            T_SPRINTF(buffer, 32, "%.17g", val.num.real);
+         }
          break;
-      case CACHE_NOCON:
-         sprintf(pcon->error, "BDB error %d (DB_UNAVAILABLE) DB unavailable - check installation", error_code);
+      case DBX_DTYPE_BOOL:
+         T_STRCPY(buffer, 32, val.num.int32 ? "true" : "false");
          break;
       default:
-         sprintf(pcon->error, "BDB error %d (DB_UNKNOWN) Unknown error condition", error_code);
+         return -1;
+   }
+   return (int) strlen(buffer);
+}
+
+
+/* v1.3.22 Offset and length arguments to the range functions */
+size_t dbx_range_number(DBXVAL *pval)
+{
+   unsigned int len;
+   double num;
+   char buffer[32];
+
+   len = pval->svalue.len_used;
+   if (len > 31) {
+      len = 31;
+   }
+   memcpy((void *) buffer, (void *) pval->svalue.buf_addr, (size_t) len);
+   buffer[len] = '\0';
+   num = strtod(buffer, NULL);
+
+   return (num > 0 ? (size_t) num : 0);
+}
+
+
+/* v1.3.22 Returns 1 if a stored value is the header of a value held in chunks */
+int dbx_chunked(char *data, size_t len, size_t *psize, unsigned int *pchunk_size)
+{
+   int n;
+   unsigned char *p = (unsigned char *) data;
+
+   if (len != DBX_CHEADER_SIZE || p[0] != 0x00 || p[1] != 0xDB || p[2] != 'C' || p[3] != 0x00) {
+      return 0;
+   }
+   *psize = 0;
+   for (n = 7; n >= 0; n --) {
+      *psize = (*psize << 8) | (size_t) p[4 + n];
+   }
+   *pchunk_size = (unsigned int) p[12] | ((unsigned int) p[13] << 8) | ((unsigned int) p[14] << 16) | ((unsigned int) p[15] << 24);
+
+   return (*pchunk_size > 0);
+}
+
+
+/* v1.3.22 Key of a chunk: ^%dbxchunk(<key of the node>,<chunk>) where the node's key has 0x00 and 0x01 escaped as 0x01 0x01 and 0x01 0x02 */
+/* a chunk of -1 gives the prefix shared by the node's chunks and those of its descendants: returns 0 if the key would be too long */
+int dbx_chunk_key(char *ckey, char *key, unsigned int key_len, int chunk)
+{
+   unsigned int n, len;
+   unsigned char *p;
+
+   len = (unsigned int) strlen(DBX_CHUNK_GLOBAL) + 4 + key_len + (chunk < 0 ? 0 : 10);
+   for (n = 0; n < key_len; n ++) {
+      if (key[n] == 0x00 || key[n] == 0x01) {
+         len ++;
+      }
+   }
+   if (len > DBX_CHUNK_KEY_MAX) {
+      return 0;
+   }
+
+   p = (unsigned char *) ckey;
+   *(p ++) = 0x00;
+   *(p ++) = 0x03;
+   memcpy((void *) p, (void *) DBX_CHUNK_GLOBAL, strlen(DBX_CHUNK_GLOBAL));
+   p += strlen(DBX_CHUNK_GLOBAL);
+   *(p ++) = 0x00;
+   *(p ++) = 0x03;
+   for (n = 0; n < key_len; n ++) {
+      if (key[n] == 0x00 || key[n] == 0x01) {
+         *(p ++) = 0x01;
+         *(p ++) = (unsigned char) (key[n] + 1);
+      }
+      else {
+         *(p ++) = (unsigned char) key[n];
+      }
+   }
+   if (chunk >= 0) {
+      *(p ++) = 0x00;
+      *(p ++) = 0x02;
+      dbx_set_size(p, (unsigned long) chunk, 1);
+      p += 4;
+      dbx_set_size(p, 0, 1);
+      p += 4;
+   }
+
+   return (int) len;
+}
+
+
+/* v1.3.22 Read part of a value held in chunks: chunks (or parts of chunks) that were never written read as nul bytes */
+/* if a cursor is supplied it is used to read the chunks and then returned to the node */
+int lmdb_chunk_get(DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, MDB_cursor *pcursor, MDB_val *pkey, unsigned int chunk_size, size_t offset, size_t length, char *out)
+{
+   int rc, len;
+   unsigned int n;
+   size_t from, to, got;
+   char ckey[DBX_CHUNK_KEY_MAX + 1];
+   MDB_val key, data;
+   DBXCON *pcon = pmeth->pcon;
+
+   rc = CACHE_SUCCESS;
+   for (n = (unsigned int) (offset / chunk_size); length > 0; n ++) {
+      from = offset - ((size_t) n * chunk_size);
+      to = (length < (chunk_size - from)) ? (from + length) : chunk_size;
+      len = dbx_chunk_key(ckey, (char *) pkey->mv_data, (unsigned int) pkey->mv_size, (int) n);
+      if (len < 1) {
+         rc = MDB_BAD_VALSIZE;
+         break;
+      }
+      key.mv_data = (void *) ckey;
+      key.mv_size = (size_t) len;
+      if (pcursor) {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_KEY);
+      }
+      else {
+         rc = pcon->p_lmdb_so->p_mdb_get(ptxn, dbi, &key, &data);
+      }
+      if (rc != CACHE_SUCCESS && rc != MDB_NOTFOUND) {
          break;
+      }
+      got = 0;
+      if (rc == CACHE_SUCCESS && data.mv_size > from) {
+         got = ((data.mv_size < to) ? data.mv_size : to) - from;
+         memcpy((void *) out, (void *) ((char *) data.mv_data + from), got);
+      }
+      if (got < (to - from)) {
+         memset((void *) (out + got), 0, (to - from) - got);
+      }
+      rc = CACHE_SUCCESS;
+      out += (to - from);
+      offset += (to - from);
+      length -= (to - from);
    }
 
-   return 0;
+   if (pcursor) {
+      key = *pkey;
+      pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_KEY);
+   }
+
+   return rc;
 }
 
 
-int lmdb_load_library(DBXCON *pcon)
+/* v1.3.22 Read a whole value into pstr if the stored record (*pdata) is the header of a value held in chunks */
+/* returns 0 if it is not, 1 if the value was read and -1 if it could not be read (pstr is then empty) */
+int lmdb_chunk_str(DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, MDB_cursor *pcursor, MDB_val *pkey, MDB_val *pdata, DBXSTR *pstr)
 {
-   int result;
-   char primerr[DBX_ERROR_SIZE];
-   char fun[64];
+   unsigned int chunk_size;
+   size_t size;
 
-   strcpy(pcon->p_lmdb_so->libdir, pcon->db_library);
-   strcpy(pcon->p_lmdb_so->funprfx, "mdb");
-   strcpy(pcon->p_lmdb_so->dbname, "LMDB");
+   if (!dbx_chunked((char *) pdata->mv_data, pdata->mv_size, &size, &chunk_size)) {
+      return 0;
+   }
+   pstr->len_used = 0;
+   if ((size + 32) > (size_t) pstr->len_alloc && !dbx_buffer_resize(&(pstr->buf_addr), 0, (unsigned int) (size + 32), &(pstr->len_alloc))) {
+      strcpy(pmeth->pcon->error, "No Memory");
+      return -1;
+   }
+   if (lmdb_chunk_get(pmeth, ptxn, dbi, pcursor, pkey, chunk_size, 0, size, pstr->buf_addr) != CACHE_SUCCESS) {
+      return -1;
+   }
+   pstr->len_used = (unsigned int) size;
 
-   strcpy(pcon->p_lmdb_so->libnam, pcon->p_lmdb_so->libdir);
+   return 1;
+}
 
-   pcon->p_lmdb_so->p_library = dbx_dso_load(pcon->p_lmdb_so->libnam);
-   if (!pcon->p_lmdb_so->p_library) {
-      int len1, len2;
-      char *p;
-#if defined(_WIN32)
-      DWORD errorcode;
-      LPVOID lpMsgBuf;
 
-      lpMsgBuf = NULL;
-      errorcode = GetLastError();
-      sprintf(pcon->error, "Error loading %s Library: %s; Error Code : %ld",  pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, errorcode);
-      len2 = (int) strlen(pcon->error);
-      len1 = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-                     NULL,
-                     errorcode,
-                     /* MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), */
-                     MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
-                     (LPTSTR) &lpMsgBuf,
-                     0,
-                     NULL 
-                     );
-      if (lpMsgBuf && len1 > 0 && (DBX_ERROR_SIZE - len2) > 30) {
-         strncpy(primerr, (const char *) lpMsgBuf, DBX_ERROR_SIZE - 1);
-         p = strstr(primerr, "\r\n");
-         if (p)
-            *p = '\0';
-         len1 = (DBX_ERROR_SIZE - (len2 + 10));
-         if (len1 < 1)
-            len1 = 0;
-         primerr[len1] = '\0';
-         p = strstr(primerr, "%1");
-         if (p) {
-            *p = 'I';
-            *(p + 1) = 't';
+/* v1.3.22 Write dlen bytes at offset into a value of size bytes held in chunks, then its header: only the chunks that hold the range are written */
+int lmdb_chunk_put(DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, MDB_val *pkey, size_t size, unsigned int chunk_size, size_t offset, char *pdata, size_t dlen)
+{
+   int rc, len;
+   unsigned int n;
+   size_t vlen, start, from, to, clen, got;
+   char *pchunk;
+   unsigned char header[DBX_CHEADER_SIZE];
+   char ckey[DBX_CHUNK_KEY_MAX + 1];
+   MDB_val key, data;
+   DBXCON *pcon = pmeth->pcon;
+
+   vlen = (offset + dlen) > size ? (offset + dlen) : size;
+   pchunk = NULL;
+   rc = CACHE_SUCCESS;
+
+   for (n = (unsigned int) (offset / chunk_size); dlen > 0; n ++) {
+      start = (size_t) n * chunk_size;
+      from = offset - start;
+      to = (dlen < (chunk_size - from)) ? (from + dlen) : chunk_size;
+      clen = ((vlen - start) < chunk_size) ? (vlen - start) : chunk_size;
+      len = dbx_chunk_key(ckey, (char *) pkey->mv_data, (unsigned int) pkey->mv_size, (int) n);
+      if (len < 1) {
+         rc = MDB_BAD_VALSIZE;
+         break;
+      }
+      key.mv_data = (void *) ckey;
+      key.mv_size = (size_t) len;
+
+      if (from == 0 && to == clen) { /* the chunk is replaced */
+         data.mv_data = (void *) pdata;
+         data.mv_size = clen;
+      }
+      else { /* the chunk is updated */
+         if (!pchunk && !(pchunk = (char *) dbx_malloc((int) chunk_size, DBX_MEMID_VALUE))) {
+            strcpy(pcon->error, "No Memory");
+            rc = CACHE_NOCON;
+            break;
+         }
+         got = 0;
+         if (start < size) {
+            rc = pcon->p_lmdb_so->p_mdb_get(ptxn, dbi, &key, &data);
+            if (rc == CACHE_SUCCESS) {
+               got = (data.mv_size < clen) ? data.mv_size : clen;
+               memcpy((void *) pchunk, (void *) data.mv_data, got);
+            }
+            else if (rc != MDB_NOTFOUND) {
+               break;
+            }
          }
-         strcat(pcon->error, " (");
-         strcat(pcon->error, primerr);
-         strcat(pcon->error, ")");
+         if (got < clen) {
+            memset((void *) (pchunk + got), 0, clen - got);
+         }
+         memcpy((void *) (pchunk + from), (void *) pdata, to - from);
+         data.mv_data = (void *) pchunk;
+         data.mv_size = clen;
       }
-      if (lpMsgBuf)
-         LocalFree(lpMsgBuf);
-#else
-      p = (char *) dlerror();
-      sprintf(primerr, "Cannot load %s library: Error Code: %d", pcon->p_lmdb_so->dbname, errno);
-      len2 = strlen(pcon->error);
-      if (p) {
-         strncpy(primerr, p, DBX_ERROR_SIZE - 1);
-         primerr[DBX_ERROR_SIZE - 1] = '\0';
-         len1 = (DBX_ERROR_SIZE - (len2 + 10));
-         if (len1 < 1)
-            len1 = 0;
-         primerr[len1] = '\0';
-         strcat(pcon->error, " (");
-         strcat(pcon->error, primerr);
-         strcat(pcon->error, ")");
+      rc = pcon->p_lmdb_so->p_mdb_put(ptxn, dbi, &key, &data, 0);
+      if (rc != CACHE_SUCCESS) {
+         break;
       }
-#endif
-      goto lmdb_load_library_exit;
+      pdata += (to - from);
+      offset += (to - from);
+      dlen -= (to - from);
    }
 
-   sprintf(fun, "%s_env_create", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_env_create = (int (*) (MDB_env **)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_env_create) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
-   }
-   sprintf(fun, "%s_env_open", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_env_open = (int (*) (MDB_env *, const char *, unsigned int, mdb_mode_t)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_env_open) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
-   }
-   sprintf(fun, "%s_env_close", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_env_close = (void (*) (MDB_env *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_env_close) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
-   }
-   sprintf(fun, "%s_env_set_maxdbs", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_env_set_maxdbs = (int (*) (MDB_env *, MDB_dbi)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_env_set_maxdbs) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   if (rc == CACHE_SUCCESS) {
+      header[0] = 0x00;
+      header[1] = 0xDB;
+      header[2] = 'C';
+      header[3] = 0x00;
+      for (n = 0; n < 8; n ++) {
+         header[4 + n] = (unsigned char) ((vlen >> (n * 8)) & 0xff);
+      }
+      for (n = 0; n < 4; n ++) {
+         header[12 + n] = (unsigned char) ((chunk_size >> (n * 8)) & 0xff);
+      }
+      data.mv_data = (void *) header;
+      data.mv_size = DBX_CHEADER_SIZE;
+      rc = pcon->p_lmdb_so->p_mdb_put(ptxn, dbi, pkey, &data, 0);
    }
 
-   sprintf(fun, "%s_env_set_mapsize", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_env_set_mapsize = (int (*) (MDB_env *, size_t)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_env_set_mapsize) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   if (pchunk) {
+      dbx_free((void *) pchunk, 0);
    }
-   sprintf(fun, "%s_env_stat", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_env_stat = (int (*) (MDB_env *, MDB_stat *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_env_stat) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+
+   return rc;
+}
+
+
+/* v1.3.22 Copy the chunks of a value to another node (merge) */
+int lmdb_chunk_copy(DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi sdbi, char *skey, unsigned int skey_len, MDB_dbi ddbi, char *dkey, unsigned int dkey_len, size_t size, unsigned int chunk_size)
+{
+   int rc, len;
+   unsigned int n;
+   char *pchunk;
+   char ckey[DBX_CHUNK_KEY_MAX + 1];
+   MDB_val key, data;
+   DBXCON *pcon = pmeth->pcon;
+
+   /* each chunk is staged in a buffer: a put can move the records that the source data points into */
+   pchunk = (char *) dbx_malloc((int) chunk_size, DBX_MEMID_VALUE);
+   if (!pchunk) {
+      strcpy(pcon->error, "No Memory");
+      return CACHE_NOCON;
    }
 
-   sprintf(fun, "%s_txn_begin", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_txn_begin = (int (*) (MDB_env *, MDB_txn *, unsigned int, MDB_txn **)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_txn_begin) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   rc = lmdb_chunk_drop(pmeth, ptxn, ddbi, dkey, dkey_len, 0);
+
+   for (n = 0; rc == CACHE_SUCCESS && ((size_t) n * chunk_size) < size; n ++) {
+      len = dbx_chunk_key(ckey, skey, skey_len, (int) n);
+      key.mv_data = (void *) ckey;
+      key.mv_size = (size_t) len;
+      rc = pcon->p_lmdb_so->p_mdb_get(ptxn, sdbi, &key, &data);
+      if (rc == MDB_NOTFOUND) { /* never written */
+         rc = CACHE_SUCCESS;
+         continue;
+      }
+      if (rc != CACHE_SUCCESS) {
+         break;
+      }
+      len = dbx_chunk_key(ckey, dkey, dkey_len, (int) n);
+      if (len < 1) {
+         rc = MDB_BAD_VALSIZE;
+         break;
+      }
+      key.mv_size = (size_t) len;
+      if (data.mv_size > chunk_size) {
+         data.mv_size = chunk_size;
+      }
+      memcpy((void *) pchunk, (void *) data.mv_data, data.mv_size);
+      data.mv_data = (void *) pchunk;
+      rc = pcon->p_lmdb_so->p_mdb_put(ptxn, ddbi, &key, &data, 0);
    }
-   sprintf(fun, "%s_txn_commit", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_txn_commit = (int (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_txn_commit) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+
+   dbx_free((void *) pchunk, 0);
+
+   return rc;
+}
+
+
+/* v1.3.22 Remove the chunks held for a node (and, for a subtree, those held for its descendants) */
+int lmdb_chunk_drop(DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, char *key, unsigned int key_len, short subtree)
+{
+   int rc, len;
+   unsigned char *p;
+   char ckey[DBX_CHUNK_KEY_MAX + 1];
+   MDB_val key0, data;
+   MDB_cursor *pcursor;
+   DBXCON *pcon = pmeth->pcon;
+
+   len = dbx_chunk_key(ckey, key, key_len, -1);
+   if (len < 1) { /* no chunks are held for a key this long */
+      return CACHE_SUCCESS;
    }
-   sprintf(fun, "%s_txn_abort", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_txn_abort = (void (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_txn_abort) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+
+   rc = pcon->p_lmdb_so->p_mdb_cursor_open(ptxn, dbi, &pcursor);
+   if (rc != CACHE_SUCCESS) {
+      return rc;
    }
-   sprintf(fun, "%s_txn_reset", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_txn_reset = (void (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_txn_reset) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   key0.mv_data = (void *) ckey;
+   key0.mv_size = (size_t) len;
+   rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key0, &data, MDB_SET_RANGE);
+   while (rc == CACHE_SUCCESS && key0.mv_size > (size_t) len && !memcmp((void *) key0.mv_data, (void *) ckey, (size_t) len)) {
+      /* the node's chunks follow its key directly and a descendant's key continues with an (escaped) 0x00 */
+      p = (unsigned char *) key0.mv_data + len;
+      if (!(p[0] == 0x00 || (subtree && p[0] == 0x01 && key0.mv_size > (size_t) (len + 1) && p[1] == 0x01))) {
+         break;
+      }
+      rc = pcon->p_lmdb_so->p_mdb_del(ptxn, dbi, &key0, NULL);
+      if (rc != CACHE_SUCCESS) {
+         break;
+      }
+      rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key0, &data, MDB_NEXT);
    }
-   sprintf(fun, "%s_txn_renew", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_txn_renew = (void (*) (MDB_txn *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_txn_renew) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+   if (rc == MDB_NOTFOUND) {
+      rc = CACHE_SUCCESS;
    }
 
-   sprintf(fun, "%s_dbi_open", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_dbi_open = (int (*) (MDB_txn *, const char *, unsigned int, MDB_dbi *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_dbi_open) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
-   }
-   sprintf(fun, "%s_dbi_close", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_dbi_close = (void (*) (MDB_env *, MDB_dbi)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_dbi_close) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
-   }
+   return rc;
+}
 
-   sprintf(fun, "%s_put", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_put = (int (*) (MDB_txn *, MDB_dbi, MDB_val *, MDB_val *, unsigned int)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_put) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
-   }
-   sprintf(fun, "%s_get", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_get = (int (*) (MDB_txn *, MDB_dbi, MDB_val *, MDB_val *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_get) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+
+/* v1.3.22 Read part of a record: the trailing two arguments are the offset and length of the range */
+int dbx_read_range(DBXMETH *pmeth)
+{
+   int rc, kn;
+   unsigned int chunk_size;
+   size_t offset, length, size;
+   DBXCON *pcon = pmeth->pcon;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   DBX_DB_LOCK(0);
+
+   rc = dbx_global_reference(pmeth);
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_read_range");
+      goto dbx_read_range_exit;
    }
-   sprintf(fun, "%s_del", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_del = (int (*) (MDB_txn *, MDB_dbi, MDB_val *, MDB_val *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_del) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+
+   kn = pmeth->key.argc - 3;
+   offset = dbx_range_number(&(pmeth->key.args[kn + 1]));
+   length = dbx_range_number(&(pmeth->key.args[kn + 2]));
+   pmeth->output_val.svalue.len_used = 0;
+   if (DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 not the main database */
+      rc = CACHE_ERUNDEF;
+      goto dbx_read_range_exit;
    }
 
-   sprintf(fun, "%s_cursor_open", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_cursor_open = (int (*) (MDB_txn *, MDB_dbi, MDB_cursor **)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_cursor_open) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   if (length > (size_t) pmeth->output_val.svalue.len_alloc) {
+      if (!dbx_buffer_resize((char **) &(pmeth->output_val.svalue.buf_addr), 0, (unsigned int) (length + 32), (unsigned int *) &(pmeth->output_val.svalue.len_alloc))) {
+         rc = CACHE_FAILURE;
+         dbx_error_message(pmeth, rc, (char *) "dbx_read_range");
+         goto dbx_read_range_exit;
+      }
    }
-   sprintf(fun, "%s_cursor_close", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_cursor_close = (void (*) (MDB_cursor *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_cursor_close) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DB *pdb;
+      DBT key, data;
+
+      memset(&key, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[kn].csize;
+      }
+
+      pdb = DBX_BDB_PDB(pmeth);
+      if (!pdb) {
+         rc = DB_NOTFOUND;
+      }
+      else {
+         char zhead[DBX_ZHEADER_SIZE];
+
+         /* v1.3.23 check for a compressed value */
+         data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+         data.data = (void *) zhead;
+         data.ulen = DBX_ZHEADER_SIZE;
+         data.doff = 0;
+         data.dlen = DBX_ZHEADER_SIZE;
+         rc = pdb->get(pdb, NULL, &key, &data, 0);
+
+         if (rc == CACHE_SUCCESS && data.size == DBX_ZHEADER_SIZE && dbx_zpacked(zhead, DBX_ZHEADER_SIZE + 1)) {
+            /* compressed values are read and decompressed whole and the range taken from the result */
+            memset(&data, 0, sizeof(DBT));
+            data.flags = DB_DBT_USERMEM;
+            data.data = (void *) pmeth->output_val.svalue.buf_addr;
+            data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+            rc = bdb_get(pmeth, &key, &data, &(pmeth->output_val.svalue));
+            if (rc == CACHE_SUCCESS) {
+               pmeth->output_val.svalue.len_used = (unsigned int) data.size;
+               dbx_zunpack_inplace(&(pmeth->output_val.svalue));
+               size = (size_t) pmeth->output_val.svalue.len_used;
+               pmeth->output_val.svalue.len_used = 0;
+               if (offset < size) {
+                  if (length > (size - offset)) {
+                     length = size - offset;
+                  }
+                  memmove((void *) pmeth->output_val.svalue.buf_addr, (void *) (pmeth->output_val.svalue.buf_addr + offset), length);
+                  pmeth->output_val.svalue.len_used = (unsigned int) length;
+               }
+            }
+         }
+         else if (rc == CACHE_SUCCESS) {
+            /* only the requested range is read from the database */
+            memset(&data, 0, sizeof(DBT));
+            data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+            data.data = (void *) pmeth->output_val.svalue.buf_addr;
+            data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+            data.doff = (u_int32_t) offset;
+            data.dlen = (u_int32_t) length;
+            rc = pdb->get(pdb, NULL, &key, &data, 0);
+            if (rc == CACHE_SUCCESS) {
+               pmeth->output_val.svalue.len_used = (unsigned int) data.size;
+            }
+         }
+      }
+
+      if (rc == DB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+      }
    }
-   sprintf(fun, "%s_cursor_renew", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_cursor_renew = (int (*) (MDB_txn *, MDB_cursor *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_cursor_renew) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
+         key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[kn].csize;
+      }
+
+      /* the record is in the memory map: copy just the range */
+      rc = lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &key, &data);
+      if (rc == CACHE_SUCCESS && dbx_chunked((char *) data.mv_data, data.mv_size, &size, &chunk_size)) {
+         /* v1.3.22 only the chunks that hold the range are read */
+         if (offset < size) {
+            if (length > (size - offset)) {
+               length = size - offset;
+            }
+            rc = lmdb_chunk_get(pmeth, pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), NULL, &key, chunk_size, offset, length, pmeth->output_val.svalue.buf_addr);
+            if (rc == CACHE_SUCCESS) {
+               pmeth->output_val.svalue.len_used = (unsigned int) length;
+            }
+         }
+      }
+      else if (rc == CACHE_SUCCESS && dbx_zpacked((char *) data.mv_data, data.mv_size)) {
+         /* v1.3.23 compressed values are decompressed whole and the range taken from the result */
+         dbx_zunpack_str(&(pmeth->output_val.svalue), (char *) data.mv_data, data.mv_size);
+         size = (size_t) pmeth->output_val.svalue.len_used;
+         pmeth->output_val.svalue.len_used = 0;
+         if (offset < size) {
+            if (length > (size - offset)) {
+               length = size - offset;
+            }
+            memmove((void *) pmeth->output_val.svalue.buf_addr, (void *) (pmeth->output_val.svalue.buf_addr + offset), length);
+            pmeth->output_val.svalue.len_used = (unsigned int) length;
+         }
+      }
+      else if (rc == CACHE_SUCCESS) {
+         if (offset < data.mv_size) {
+            if (length > (data.mv_size - offset)) {
+               length = data.mv_size - offset;
+            }
+            memcpy((void *) pmeth->output_val.svalue.buf_addr, (void *) ((char *) data.mv_data + offset), length);
+            pmeth->output_val.svalue.len_used = (unsigned int) length;
+         }
+      }
+      else if (rc == MDB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+      }
+      lmdb_commit_ro_transaction(pmeth, 0);
    }
-   sprintf(fun, "%s_cursor_get", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_cursor_get = (int (*) (MDB_cursor *, MDB_val *, MDB_val *, MDB_cursor_op)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_cursor_get) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+
+   if (rc != CACHE_SUCCESS && rc != CACHE_ERUNDEF) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_read_range");
    }
 
-   sprintf(fun, "%s_strerror", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_strerror = (char * (*) (int)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_strerror) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+dbx_read_range_exit:
+
+   DBX_DB_UNLOCK();
+
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_read_range: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
-   sprintf(fun, "%s_version", pcon->p_lmdb_so->funprfx);
-   pcon->p_lmdb_so->p_mdb_version = (char * (*) (int *, int *, int *)) dbx_dso_sym(pcon->p_lmdb_so->p_library, (char *) fun);
-   if (!pcon->p_lmdb_so->p_mdb_version) {
-      sprintf(pcon->error, "Error loading %s library: %s; Cannot locate the following function : %s", pcon->p_lmdb_so->dbname, pcon->p_lmdb_so->libnam, fun);
-      goto lmdb_load_library_exit;
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
    }
 
-   pcon->p_lmdb_so->loaded = 1;
+   return CACHE_FAILURE;
+}
+#endif
+}
 
-lmdb_load_library_exit:
 
-   if (pcon->error[0]) {
-      pcon->p_lmdb_so->loaded = 0;
-      pcon->error_code = 1009;
-      result = CACHE_NOCON;
+int dbx_write_range(DBXMETH *pmeth)
+{
+   return dbx_write_range_ex(pmeth, 0);
+}
 
-      return result;
+
+int dbx_append(DBXMETH *pmeth)
+{
+   return dbx_write_range_ex(pmeth, 1);
+}
+
+
+/* v1.3.23 Apply a range update to the (decompressed) record held in output_val */
+int dbx_write_range_build(DBXMETH *pmeth, size_t size, size_t offset, char *pdata, size_t dlen)
+{
+   size_t len;
+
+   len = (offset + dlen) > size ? (offset + dlen) : size;
+   if ((len + 32) > (size_t) pmeth->output_val.svalue.len_alloc) {
+      if (!dbx_buffer_resize(&(pmeth->output_val.svalue.buf_addr), (unsigned int) size, (unsigned int) (len + 32), &(pmeth->output_val.svalue.len_alloc))) {
+         strcpy(pmeth->pcon->error, "No Memory");
+         return CACHE_NOCON;
+      }
    }
+   if (offset > size) {
+      memset((void *) (pmeth->output_val.svalue.buf_addr + size), 0, offset - size);
+   }
+   memcpy((void *) (pmeth->output_val.svalue.buf_addr + offset), (void *) pdata, dlen);
+   pmeth->output_val.svalue.len_used = (unsigned int) len;
 
    return CACHE_SUCCESS;
 }
 
 
-int lmdb_open(DBXMETH *pmeth)
+/* v1.3.22 Overwrite part of a record (the trailing arguments are the offset and the data) or append to it (the trailing argument is the data) */
+int dbx_write_range_ex(DBXMETH *pmeth, short append)
 {
-   int rc, n, result;
-   char *pver;
-   size_t db_size;
-   MDB_stat stat;
+   int rc, kn, ndata, packed, chunked;
+   unsigned int chunk_size;
+   size_t offset, size, dlen, len, zlen;
+   char *pdata, *zdata;
+   char buffer[32];
    DBXCON *pcon = pmeth->pcon;
 
-   if (!pcon->p_lmdb_so) {
-      pcon->p_lmdb_so = (DBXLMDBSO *) dbx_malloc(sizeof(DBXLMDBSO), 0);
-      if (!pcon->p_lmdb_so) {
-         T_STRCPY(pcon->error, _dbxso(pcon->error), "No Memory");
-         pcon->error_code = 1009; 
-         result = CACHE_NOCON;
-         return result;
-      }
-      memset((void *) pcon->p_lmdb_so, 0, sizeof(DBXLMDBSO));
-      pcon->p_lmdb_so->pdb = NULL;
-      pcon->p_lmdb_so->penv = NULL;
-      pcon->p_lmdb_so->loaded = 0;
-      pcon->p_lmdb_so->no_connections = 0;
-      pcon->p_lmdb_so->multiple_connections = 0;
-      pcon->p_zv = &(pcon->p_lmdb_so->zv);
-   }
+#ifdef _WIN32
+__try {
+#endif
 
-   if (pcon->p_lmdb_so->loaded == 2) {
-      strcpy(pcon->error, "Cannot create multiple connections to the database");
-      pcon->error_code = 1009; 
-      strcpy((char *) pmeth->output_val.svalue.buf_addr, "0");
-      rc = CACHE_NOCON;
-      goto lmdb_open_exit;
-   }
+   DBX_DB_LOCK(0);
 
-   if (!pcon->p_lmdb_so->loaded) {
-      rc = lmdb_load_library(pcon);
-      if (rc != CACHE_SUCCESS) {
-         goto lmdb_open_exit;
-      }
-   }
+   zdata = NULL;
+   packed = 0;
+   chunked = 0;
+   chunk_size = 0;
 
-   pver = pcon->p_lmdb_so->p_mdb_version(&(pcon->p_zv->majorversion), &(pcon->p_zv->minorversion), &(pcon->p_zv->patch));
+   pmeth->update = 1;
+   rc = dbx_global_reference(pmeth);
 
-   pcon->p_zv->dbtype = (unsigned char) pcon->dbtype;
-/*
-   printf("\r\n pver=%s; pcon->p_zv->majorversion=%d; pcon->p_zv->minorversion=%d; pcon->p_zv->patch=%d;", pver, pcon->p_zv->majorversion, pcon->p_zv->minorversion, pcon->p_zv->patch);
-*/
-   if (pver) {
-      rc = CACHE_SUCCESS;
-      strcpy(pcon->p_zv->db_version, pver);
-      lmdb_parse_zv(pcon->p_zv->db_version, pcon->p_zv);
-      if (pcon->p_zv->dbx_build)
-         sprintf(pcon->p_zv->version, "%d.%d.b%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion, pcon->p_zv->dbx_build);
-      else
-         sprintf(pcon->p_zv->version, "%d.%d", pcon->p_zv->majorversion, pcon->p_zv->minorversion);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_write_range");
+      goto dbx_write_range_exit;
+   }
+
+   ndata = pmeth->key.argc - 1;
+   if (append) {
+      kn = ndata - 1;
+      offset = 0;
    }
    else {
-      rc = CACHE_FAILURE;
+      kn = ndata - 2;
+      offset = dbx_range_number(&(pmeth->key.args[ndata - 1]));
    }
+   pdata = pmeth->key.args[ndata].svalue.buf_addr;
+   dlen = (size_t) pmeth->key.args[ndata].svalue.len_used;
+   size = 0;
 
-   /* v1.1.4 */
-   pcon->p_lmdb_so->penv = NULL;
-   rc = pcon->p_lmdb_so->p_mdb_env_create(&(pcon->p_lmdb_so->penv));
-   if (rc != 0) {
-      /* Error handling goes here */
-      strcpy(pcon->error, "Cannot create a LMDB environment object");
-      goto lmdb_open_exit;
-   }
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DB *pdb;
+      DBT key, data;
 
-   if (pcon->db_file[0]) {
-      rc = pcon->p_lmdb_so->p_mdb_env_set_maxdbs(pcon->p_lmdb_so->penv, (MDB_dbi) 16);
-      if (rc != 0) {
-         /* Error handling goes here */
-         strcpy(pcon->error, "Cannot set the maximum number of databases in the LMDB environment");
-         goto lmdb_open_exit;
+      memset(&key, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[kn].csize;
       }
-   }
 
-   rc = pcon->p_lmdb_so->p_mdb_env_open(pcon->p_lmdb_so->penv, pcon->env_dir, MDB_NOTLS, 0664);
-   if (rc != 0) {
-      /* Error handling goes here */
-      strcpy(pcon->error, "Cannot create or open a LMDB environment");
-      goto lmdb_open_exit;
-   }
+      pdb = DBX_BDB_PDB(pmeth);
 
-   rc = pcon->p_lmdb_so->p_mdb_env_stat(pcon->p_lmdb_so->penv, &stat);
-   if (rc != 0) {
-      /* Error handling goes here */
-      strcpy(pcon->error, "Cannot obtain the statistics for the LMDB environment");
-      goto lmdb_open_exit;
-   }
+      /* the current length of the record: no user memory so nothing is read */
+      data.flags = DB_DBT_USERMEM;
+      data.ulen = 0;
+      rc = pdb->get(pdb, NULL, &key, &data, 0);
+      if (rc == CACHE_SUCCESS || rc == DB_BUFFER_SMALL) {
+         size = (size_t) data.size;
+         rc = CACHE_SUCCESS;
+      }
+      else if (rc != DB_NOTFOUND) {
+         dbx_error_message(pmeth, rc, (char *) "dbx_write_range");
+         goto dbx_write_range_exit;
+      }
+
+      if (size > DBX_ZHEADER_SIZE) { /* v1.3.23 a compressed value must be read whole */
+         memset(&data, 0, sizeof(DBT));
+         data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+         data.data = (void *) buffer;
+         data.ulen = DBX_ZHEADER_SIZE;
+         data.doff = 0;
+         data.dlen = DBX_ZHEADER_SIZE;
+         if (pdb->get(pdb, NULL, &key, &data, 0) == CACHE_SUCCESS && dbx_zpacked(buffer, size)) {
+            memset(&data, 0, sizeof(DBT));
+            data.flags = DB_DBT_USERMEM;
+            data.data = (void *) pmeth->output_val.svalue.buf_addr;
+            data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+            rc = bdb_get(pmeth, &key, &data, &(pmeth->output_val.svalue));
+            if (rc != CACHE_SUCCESS) {
+               dbx_error_message(pmeth, rc, (char *) "dbx_write_range");
+               goto dbx_write_range_exit;
+            }
+            pmeth->output_val.svalue.len_used = (unsigned int) data.size;
+            packed = dbx_zunpack_inplace(&(pmeth->output_val.svalue));
+            size = (size_t) pmeth->output_val.svalue.len_used;
+         }
+      }
+      if (append) {
+         offset = size;
+      }
 
-   /* v1.3.9 */
-   if (pcon->db_size < 20000000) {
-      pcon->db_size = DBX_DB_SIZE;
-   }
-   if (stat.ms_psize < 1) {
-      stat.ms_psize = 4096;
-   }
-   for (n = (int) (pcon->db_size / stat.ms_psize); ; n ++) {
-      db_size = (size_t) (stat.ms_psize * n);
-      if (db_size > pcon->db_size) {
-         break;
+      if (packed) {
+         /* v1.3.23 update the decompressed value and store it whole */
+         rc = dbx_write_range_build(pmeth, size, offset, pdata, dlen);
+         if (rc == CACHE_SUCCESS) {
+            memset(&data, 0, sizeof(DBT));
+            data.flags = DB_DBT_USERMEM;
+            data.data = (void *) pmeth->output_val.svalue.buf_addr;
+            data.size = (u_int32_t) pmeth->output_val.svalue.len_used;
+            if (dbx_zpack(pmeth, (char *) data.data, (size_t) data.size, &zdata, &zlen)) {
+               data.data = (void *) zdata;
+               data.size = (u_int32_t) zlen;
+            }
+            rc = pdb->put(pdb, NULL, &key, &data, 0);
+         }
       }
-   }
-/*
-   printf("\r\n LMDB environment stats: rc=%d; psize=%d; db_size=%ld; n=%d; pcon->db_size=%ld;", rc, (int) stat.ms_psize, db_size, n, pcon->db_size);
-*/
-   rc = pcon->p_lmdb_so->p_mdb_env_set_mapsize(pcon->p_lmdb_so->penv, db_size);
-/*
-   printf("\r\n LMDB environment set size: rc=%d; psize=%ld\r\n", rc, db_size);
-*/
+      else {
+         /* replace dlen bytes at offset: BDB extends the record (padding with nul bytes) as required */
+         memset(&data, 0, sizeof(DBT));
+         data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+         data.data = (void *) pdata;
+         data.size = (u_int32_t) dlen;
+         data.doff = (u_int32_t) offset;
+         data.dlen = (u_int32_t) dlen;
 
-   pcon->p_lmdb_so->ptxnro = NULL; /* read only transaction */
-   rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
-   if (rc != 0) {
-      /* Error handling goes here */
-      strcpy(pcon->error, "Cannot create or open a LMDB transaction");
-      goto lmdb_open_exit;
+         rc = pdb->put(pdb, NULL, &key, &data, 0);
+      }
    }
-   pcon->tlevel ++;
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
+      char buffer_key[DBX_CHUNK_KEY_MAX + 1];
 
-   pcon->p_lmdb_so->pdb = &(pcon->p_lmdb_so->db);
-   if (pcon->db_file[0]) {
-      rc = pcon->p_lmdb_so->p_mdb_dbi_open(pcon->p_lmdb_so->ptxn, pcon->db_file, MDB_CREATE, pcon->p_lmdb_so->pdb);
-   }
-   else {
-      rc = pcon->p_lmdb_so->p_mdb_dbi_open(pcon->p_lmdb_so->ptxn, NULL, 0, pcon->p_lmdb_so->pdb);
-   }
-   if (rc != 0) {
-      /* Error handling goes here */
-      strcpy(pcon->error, "Cannot create or open a LMDB database");
-      goto lmdb_open_exit;
-   }
-   pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
-   pcon->tlevel --;
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
+         key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[kn].csize;
+      }
 
-lmdb_open_exit:
+      rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+      if (rc != 0) {
+         strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
+         dbx_error_message(pmeth, rc, (char *) "dbx_write_range");
+         goto dbx_write_range_exit;
+      }
+      pcon->tlevel ++;
+
+      /* LMDB has no partial put: a record is rewritten in place of the original within one transaction */
+      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, &data);
+      if (rc == CACHE_SUCCESS && dbx_chunked((char *) data.mv_data, data.mv_size, &size, &chunk_size)) {
+         chunked = 1;
+      }
+      else if (rc == CACHE_SUCCESS) {
+         packed = dbx_zunpack_str(&(pmeth->output_val.svalue), (char *) data.mv_data, data.mv_size); /* v1.3.23 */
+         size = (size_t) pmeth->output_val.svalue.len_used;
+      }
+      else if (rc == MDB_NOTFOUND) {
+         rc = CACHE_SUCCESS;
+      }
+      if (append) {
+         offset = size;
+      }
+
+      if (rc == CACHE_SUCCESS && !chunked && !packed && pcon->key_type == DBX_KEYTYPE_M && (offset + dlen) > DBX_CHUNK_SIZE && dbx_chunk_key(buffer_key, (char *) key.mv_data, (unsigned int) key.mv_size, 0) > 0) {
+         /* v1.3.22 a value that outgrows DBX_CHUNK_SIZE is moved into chunks (any left by an earlier value are removed first) */
+         chunk_size = DBX_CHUNK_SIZE;
+         rc = lmdb_chunk_drop(pmeth, pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), (char *) key.mv_data, (unsigned int) key.mv_size, 0);
+         if (rc == CACHE_SUCCESS && size) {
+            rc = lmdb_chunk_put(pmeth, pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, 0, chunk_size, 0, pmeth->output_val.svalue.buf_addr, size);
+         }
+         chunked = 1;
+      }
+
+      if (rc == CACHE_SUCCESS && chunked) {
+         /* v1.3.22 only the chunks that hold the range are rewritten */
+         rc = lmdb_chunk_put(pmeth, pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, size, chunk_size, offset, pdata, dlen);
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+         }
+         else {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+         }
+      }
+      else if (rc == CACHE_SUCCESS && packed) {
+         /* v1.3.23 update the decompressed value and store it whole */
+         rc = dbx_write_range_build(pmeth, size, offset, pdata, dlen);
+         if (rc == CACHE_SUCCESS) {
+            data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+            data.mv_size = (size_t) pmeth->output_val.svalue.len_used;
+            if (dbx_zpack(pmeth, (char *) data.mv_data, data.mv_size, &zdata, &zlen)) {
+               data.mv_data = (void *) zdata;
+               data.mv_size = zlen;
+            }
+            rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, &data, 0);
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+         }
+         else {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+         }
+      }
+      else {
+         if (rc == CACHE_SUCCESS) {
+            len = (offset + dlen) > size ? (offset + dlen) : size;
+            data.mv_data = NULL;
+            data.mv_size = len;
+            rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, &data, MDB_RESERVE);
+         }
+         if (rc == CACHE_SUCCESS) {
+            if (size) {
+               memcpy(data.mv_data, (void *) pmeth->output_val.svalue.buf_addr, size);
+            }
+            if (offset > size) {
+               memset((void *) ((char *) data.mv_data + size), 0, offset - size);
+            }
+            memcpy((void *) ((char *) data.mv_data + offset), (void *) pdata, dlen);
+            rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+         }
+         else {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+         }
+      }
+      pcon->tlevel --;
+   }
 
    if (rc == CACHE_SUCCESS) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
+      len = (offset + dlen) > size ? (offset + dlen) : size;
+      T_SPRINTF(buffer, _dbxso(buffer), "%lu", (unsigned long) len);
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) buffer, DBX_DTYPE_STR8);
    }
    else {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) pcon->error, DBX_DTYPE_STR8);
+      dbx_error_message(pmeth, rc, (char *) "dbx_write_range");
    }
 
+dbx_write_range_exit:
+
+   if (zdata) {
+      dbx_free((void *) zdata, 0);
+   }
+
+   DBX_DB_UNLOCK();
+
    return rc;
+
+#ifdef _WIN32
 }
+__except (EXCEPTION_EXECUTE_HANDLER) {
 
+   DWORD code;
+   char bufferx[256];
 
-int lmdb_parse_zv(char *zv, DBXZV * p_lmdb_sv)
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_write_range_ex: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+int dbx_set(DBXMETH *pmeth)
 {
-   char *p;
+   int rc, ndata, nindex;
+   size_t zlen;
+   char *zdata;
+   DBXGDB *pttlgdb;
+   DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
-   p_lmdb_sv->dbx_build = p_lmdb_sv->patch;
-   p_lmdb_sv->vnumber = 0;
+#ifdef _WIN32
+__try {
+#endif
 
-   if (p_lmdb_sv->majorversion == 0 || p_lmdb_sv->minorversion == 0) {
-      p = strstr(zv, "LMDB ");
-      if (p) {
-         p += 5;
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
+
+   zdata = NULL;
+   pmeth->update = 1; /* v1.3.15 */
+   rc = dbx_global_reference(pmeth);
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_set");
+      goto dbx_set_exit;
+   }
+
+   nindex = 0;
+   if (pcon->pindex && pcon->key_type == DBX_KEYTYPE_M) { /* v1.3.26 */
+      nindex = dbx_index_open(pmeth);
+      if (nindex < 0) {
+         rc = CACHE_FAILURE;
+         dbx_error_message(pmeth, rc, (char *) "dbx_set");
+         goto dbx_set_exit;
       }
-      else {
-         p = strstr(zv, "version ");
-         if (p) {
-            p += 8;
-         }
+   }
+
+   pttlgdb = NULL;
+   if (pmeth->expiry && pcon->key_type == DBX_KEYTYPE_M && pcon->global_dbs) { /* v1.3.27 */
+      rc = dbx_global_db(pmeth, (char *) DBX_TTL_GLOBAL, (int) strlen(DBX_TTL_GLOBAL), 1, &pttlgdb);
+      if (rc != CACHE_SUCCESS) {
+         dbx_error_message(pmeth, rc, (char *) "dbx_set");
+         goto dbx_set_exit;
       }
-      if (p) {
-         p_lmdb_sv->majorversion = (int) strtol(p, NULL, 10);
-         p = strstr(p, ".");
-         if (p) {
-            p ++;
-            p_lmdb_sv->minorversion = (int) strtol(p, NULL, 10);
-            p = strstr(p, ".");
-            if (p) {
-               p ++;
-               p_lmdb_sv->dbx_build = (int) strtol(p, NULL, 10);
-            }
+   }
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT key, data;
+
+      memset(&key, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+      data.flags = DB_DBT_USERMEM;
+      ndata = 1;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 2].csize;
+         ndata = pmeth->key.argc - 1;
+      }
+
+      data.data = (void *) pmeth->key.args[ndata].svalue.buf_addr;
+      data.size = (u_int32_t) pmeth->key.args[ndata].svalue.len_used;
+
+      if (dbx_zpack(pmeth, (char *) data.data, (size_t) data.size, &zdata, &zlen)) { /* v1.3.23 */
+         data.data = (void *) zdata;
+         data.size = (u_int32_t) zlen;
+      }
+
+      /* v1.3.11 */
+/*
+      if (pmeth->key.args[ndata].svalue.len_used == 0) {
+         if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
+            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
          }
       }
-   }
+*/
+      if (nindex) { /* v1.3.26 */
+         rc = dbx_index_update(pmeth, (char *) key.data, (unsigned int) key.size, pmeth->key.args[ndata].svalue.buf_addr, pmeth->key.args[ndata].svalue.len_used);
+      }
+      if (rc == CACHE_SUCCESS) {
+         rc = DBX_BDB_PDB(pmeth)->put(DBX_BDB_PDB(pmeth), NULL, &key, &data, 0);
+      }
+      if (rc == CACHE_SUCCESS && pmeth->expiry && pcon->key_type == DBX_KEYTYPE_M) { /* v1.3.27 */
+         rc = dbx_ttl_put(pmeth, pttlgdb, &(pmeth->output_key.svalue), (char *) key.data, (unsigned int) key.size);
+      }
 
-   p_lmdb_sv->vnumber = ((p_lmdb_sv->majorversion * 100000) + (p_lmdb_sv->minorversion * 10000) + p_lmdb_sv->dbx_build);
-   
-   return CACHE_SUCCESS;
-}
+      /* v1.3.12 */
+      /* pcon->p_bdb_so->pdb->sync(pcon->p_bdb_so->pdb, 0); */
 
+      /* v1.3.11 - a test to read back data to confirm that update worked */
+/*
+      {
+         int rc2, n;
+         DBT datar;
+         char *buffer, *p, *pr;
 
-int lmdb_start_ro_transaction(DBXMETH *pmeth, int context)
-{
-   int rc;
+         buffer = (char *) dbx_malloc((int) (data.size + 32), DBX_MEMID_VALUE);
+         memset(&datar, 0, sizeof(DBT));
+         datar.flags = DB_DBT_USERMEM;
+         datar.data = (void *) buffer;
+         datar.ulen = data.size + 32;
+         rc2 = DBX_BDB_PDB(pmeth)->get(DBX_BDB_PDB(pmeth), NULL, &key, &datar, 0);
+         if (rc2 != CACHE_SUCCESS) {
+            printf("\r\n set - bad return - rc=%d", rc);
+            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
+         }
+         if (data.size != datar.size) {
+            printf("\r\n set - bad value - wrong length (%d %d)", (int) data.size, (int) datar.size);
+            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
+         }
+         p = (char *) data.data;
+         pr = (char *) datar.data;
+         for (n = 0; n < (int) data.size; n ++) {
+            if (p[n] != pr[n]) {
+               printf("\r\n set - bad value - wrong value (%d %d)", (int) data.size, (int) datar.size);
+               dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
+               break;
+            }
+         }
+         dbx_free((void *) buffer, 0);
+      }
+*/
+
+/*
+      if (rc == DB_KEYEXIST) {
+         printf("\r\nPut failed because key %d already exists", rc);
+      }
+*/
 
-   rc = 0;
-   if (pmeth->pcon->tlevelro) {
-      rc = 0;
    }
-   else {
-      if (pmeth->pcon->tstatusro == 1) {
-         pmeth->pcon->p_lmdb_so->p_mdb_txn_renew(pmeth->pcon->p_lmdb_so->ptxnro);
-         pmeth->pcon->tstatusro = 0;
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
+
+      ndata = 1;
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
+         key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
       }
-      else {
-         rc = pmeth->pcon->p_lmdb_so->p_mdb_txn_begin(pmeth->pcon->p_lmdb_so->penv, NULL, MDB_RDONLY, &(pmeth->pcon->p_lmdb_so->ptxnro));
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 2].csize;
+         ndata = pmeth->key.argc - 1;
       }
-   }
-   pmeth->pcon->tlevelro ++;
 
-   return rc;
-}
+      data.mv_data = (void *) pmeth->key.args[ndata].svalue.buf_addr;
+      data.mv_size = (size_t) pmeth->key.args[ndata].svalue.len_used;
 
+      if (dbx_zpack(pmeth, (char *) data.mv_data, data.mv_size, &zdata, &zlen)) { /* v1.3.23 */
+         data.mv_data = (void *) zdata;
+         data.mv_size = zlen;
+      }
 
-int lmdb_commit_ro_transaction(DBXMETH *pmeth, int context)
-{
-   int rc;
+      for (;;) { /* v1.3.28 the update is repeated once a full map has been grown */
+         rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+         if (rc == MDB_MAP_RESIZED && lmdb_map_grow(pmeth, rc, 0) == CACHE_SUCCESS) {
+            continue;
+         }
+         if (rc != 0) {
+            strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
+            dbx_error_message(pmeth, rc, (char *) "dbx_set");
+            goto dbx_set_exit;
+         }
 
-   rc = 0;
+         pcon->tlevel ++;
+         if (nindex) { /* v1.3.26 the index entries are updated in the same transaction */
+            rc = dbx_index_update(pmeth, (char *) key.mv_data, (unsigned int) key.mv_size, pmeth->key.args[ndata].svalue.buf_addr, pmeth->key.args[ndata].svalue.len_used);
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, &data, 0);
+         }
+         if (rc == CACHE_SUCCESS && pmeth->expiry && pcon->key_type == DBX_KEYTYPE_M) { /* v1.3.27 the expiry index is updated in the same transaction */
+            rc = dbx_ttl_put(pmeth, pttlgdb, &(pmeth->output_key.svalue), (char *) key.mv_data, (unsigned int) key.mv_size);
+         }
 
-   if (pmeth->pcon->tlevelro > 1) {
-      rc = 0;
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+         }
+         else {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+         }
+         pcon->tlevel --;
+
+         if (rc == MDB_MAP_FULL && lmdb_map_grow(pmeth, rc, 0) == CACHE_SUCCESS) {
+            continue;
+         }
+         break;
+      }
+
+      /* v1.3.11 */
+/*
+      if (pmeth->key.args[ndata].svalue.len_used == 0) {
+         if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
+            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
+         }
+      }
+*/
+   }
+
+   if (rc == CACHE_SUCCESS) {
+      if (pmeth->expiry && pcon->key_type == DBX_KEYTYPE_M && !pcon->ttl.running) { /* v1.3.27 */
+         dbx_timer_start(pcon, &(pcon->ttl), dbx_ttl_thread);
+      }
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
    }
    else {
-      /* pmeth->pcon->p_lmdb_so->p_mdb_txn_abort(pmeth->pcon->p_lmdb_so->ptxnro); */
-      pmeth->pcon->p_lmdb_so->p_mdb_txn_reset(pmeth->pcon->p_lmdb_so->ptxnro);
-      pmeth->pcon->tstatusro = 1;
+      dbx_error_message(pmeth, rc, (char *) "dbx_set");
    }
-   pmeth->pcon->tlevelro --;
 
+dbx_set_exit:
+
+   if (zdata) {
+      dbx_free((void *) zdata, 0);
+   }
+
+   DBX_DB_UNLOCK();
+
+   DBX_STATS_END(pmeth, DBX_STATS_SET, tstats, rc);
    return rc;
-}
 
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
 
-int lmdb_start_qro_transaction(DBXMETH *pmeth, MDB_txn **ptxn, int context)
-{
-   int rc;
+   DWORD code;
+   char bufferx[256];
 
-   rc = lmdb_start_ro_transaction(pmeth, context);
-   *ptxn = pmeth->pcon->p_lmdb_so->ptxnro;
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_set: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
 
-   return rc;
+   return CACHE_FAILURE;
 }
-
-
-int lmdb_commit_qro_transaction(DBXMETH *pmeth, MDB_txn **ptxn, int context)
-{
-   int rc;
-
-   rc = lmdb_commit_ro_transaction(pmeth, context);
-
-   return rc;
+#endif
 }
 
 
-int lmdb_next(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
+int dbx_defined(DBXMETH *pmeth)
 {
-   int rc, n, mkeyn, fixed_comp;
+   int rc, n, found;
    DBXCON *pcon = pmeth->pcon;
-   MDB_val key, key0, data;
-   MDB_cursor *pcursor;
-   DBXVAL mkeys[DBX_MAXARGS];
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
-/*
-   printf("\r\n ******* lmdb_next ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p;\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr);
-*/
+#ifdef _WIN32
+__try {
+#endif
 
-   if (context == 0) {
-      rc = lmdb_start_ro_transaction(pmeth, 0);
-      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &pcursor);
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
+
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_defined");
+      goto dbx_defined_exit;
    }
-   else {
-     pcursor = pmeth->plmdbcursor;
+
+   n = 0;
+   found = 0;
+   if (DBX_GLOBAL_UNDEFINED(pmeth)) { /* v1.3.15 not the main database */
+      rc = CACHE_SUCCESS;
    }
+   else if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT key, key0, data;
+      DBC *pcursor;
 
-   if (pcon->key_type == DBX_KEYTYPE_INT) {
-      key0.mv_data = &(pkey->args[0].num.int32);
-      key0.mv_size = sizeof(pkey->args[0].num.int32);
-      pkeyval->num.int32 = pkey->args[0].num.int32;
-      key.mv_data = &(pkeyval->num.int32);
-      key.mv_size = sizeof(pkeyval->num.int32);
-      if (pkey->args[0].svalue.len_used == 0) {
-         key.mv_size = 0;
-         key0.mv_size = 0;
+      memset(&key, 0, sizeof(DBT));
+      memset(&key0, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+      key0.flags = DB_DBT_USERMEM;
+      data.flags = DB_DBT_USERMEM;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
       }
-   }
-   else if (pcon->key_type == DBX_KEYTYPE_STR) {
-      key0.mv_data = pkey->args[0].svalue.buf_addr;
-      key0.mv_size = pkey->args[0].svalue.len_used;
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
-      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
-      key.mv_data = (void *) pkeyval->svalue.buf_addr;
-      key.mv_size = (size_t) pkeyval->svalue.len_used;
-   }
-   else { /* mumps */
-      key0.mv_data = (void *) pkey->ibuffer.buf_addr;
-      key0.mv_size = (size_t) pkey->ibuffer.len_used;
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
-      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
-      key.mv_data = (void *) pkeyval->svalue.buf_addr;
-      key.mv_size = (size_t) pkeyval->svalue.len_used;
-   }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+         key.ulen = (u_int32_t) pmeth->key.ibuffer.len_alloc;
 
-   data.mv_data = (void *) pdataval->svalue.buf_addr;
-   data.mv_size = (size_t) pdataval->svalue.len_alloc;
+         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
+         key0.data = (void *) pmeth->output_key.svalue.buf_addr;
+         key0.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+         key0.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
+      }
 
-   rc = YDB_NODE_END;
-   if (pcon->key_type == DBX_KEYTYPE_M) {
-/*
-      printf("\r\nstarting from ...");
-      dbx_dump_key((char *) key0.mv_data, (int) key0.mv_size);
-*/
-      pkeyval->svalue.len_used = 0;
-      fixed_comp = 0;
+      data.data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
 
-      for (n = 0; n < 10; n ++) {
-/*
-         printf("\r\nDB_SET_RANGE (seed): fixed_comp=%d; pkey->argc=%d; key.mv_size=%d", fixed_comp, pkey->argc, (int) key.mv_size);
-         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+      rc = bdb_get(pmeth, &key, &data, &(pmeth->output_val.svalue));
+      if (rc == CACHE_FAILURE) {
+         dbx_error_message(pmeth, rc, (char *) "dbx_defined");
+         goto dbx_defined_exit;
+      }
+
+      pmeth->output_val.svalue.len_used = data.size;
+
+      if (rc == DB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+         n = 0;
+      }
+      else {
+         n = 1;
+      }
+      found = n;
+      if (n && dbx_expired((char *) data.data, (size_t) data.size)) { /* v1.3.27 expired but not yet swept */
+         n = 0;
+      }
+
+      /* v1.3.11 */
 /*
-         printf("\r\nDB_SET_RANGE: rc=%d; pkey->argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
-         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-         if (rc == CACHE_SUCCESS) {
-            /* reset key.mv_data to memory owned by us */
-            rc = dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, (size_t) key.mv_size);
-            if (rc != CACHE_SUCCESS) {
-               rc = YDB_NODE_END;
-               break;
+      if (pmeth->key.argc > 2) {
+         if (!strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9) && n == 0) {
+            if (n == 1 && data.size == 0) {
+               n = 0;
+               printf("\r\n *** must be undefined - no data !!!");
             }
-            key.mv_data = (void *) pkeyval->svalue.buf_addr;
-            key.mv_size = (size_t) pkeyval->svalue.len_used;
-         }
-         else {
-            rc = YDB_NODE_END;
-            break;
-         }
-         if (*((unsigned char *) key.mv_data) != 0x00) {
-            rc = YDB_NODE_END;
-            break;
+            dbx_dump_mref(pcon, pmeth, (char *) "defined", NULL, n);
          }
+      }
+*/
 
-         /* dbx_dump_key((char *) key.mv_data, (int) key.mv_size); */
+      if (pcon->key_type == DBX_KEYTYPE_M && DBX_BDB_PDB(pmeth)) { /* v1.3.15 */
+         rc = DBX_BDB_PDB(pmeth)->cursor(DBX_BDB_PDB(pmeth), NULL, &pcursor, 0);
+         if (rc == CACHE_SUCCESS) {
+/*
+            printf("\r\ndbx_defined: n=%d; key.ulen=%d; key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, (int) key.ulen, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+*/
 
-         if (pkey->argc < 2)
-            fixed_comp = 0;
-         else
-            fixed_comp = lmdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_SET_RANGE); /* v1.3.9 */
 
-         if (!fixed_comp) {
-            mkeyn = dbx_split_key(&mkeys[0], (char *) key.mv_data, (int) key.mv_size);
 /*
-            printf("\r\nNext Record: pkey->argc=%d mkeyn=%d csize=%d; lens=%d:%d %s", pkey->argc, mkeyn, pkey->args[pkey->argc - 1].csize, pkey->args[pkey->argc - 1].svalue.len_used, mkeys[pkey->argc - 1].svalue.len_used, mkeys[pkey->argc - 1].svalue.buf_addr);
+            printf("\r\ndbx_defined: DB_SET_RANGE: n=%d; rc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+            dbx_dump_key((char *) key.data, (int) key.size);
 */
+            if (rc == CACHE_SUCCESS) {
+               if (found && key.size == pmeth->key.args[pmeth->key.argc - 1].csize && !bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) { /* current record defined, get next */
+                  rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_NEXT); /* v1.3.9 */
 
-            if (mkeyn != pkey->argc) { /* can't use data as it's under lower subscripts */
-               data.mv_size = 0;
-            }
-
-            if (mkeyn >= pkey->argc) {
-               if (pkey->args[pkey->argc - 1].svalue.len_used == mkeys[pkey->argc - 1].svalue.len_used && !strncmp(pkey->args[pkey->argc - 1].svalue.buf_addr, mkeys[pkey->argc - 1].svalue.buf_addr, pkey->args[pkey->argc - 1].svalue.len_used)) {
-                  /* current key returned - get next */
-                  *(((unsigned char *) key.mv_data) + pkey->args[pkey->argc - 1].csize + 0) = 0x00;
-                  *(((unsigned char *) key.mv_data) + pkey->args[pkey->argc - 1].csize + 1) = 0xff;
-                  key.mv_size = (pkey->args[pkey->argc - 1].csize + 2);
 /*
-                  printf("\r\nAdvance Cursor: pkey->argc=%d; key.mv_size=%d", pkey->argc, key.mv_size);
-                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+                  printf("\r\ndbx_defined: DB_NEXT: n=%d; rc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+                  dbx_dump_key((char *) key.data, (int) key.size);
 */
-                  continue;
                }
-               else {
-                  /* next key found */
-                  if (context == 0) {
-                     rc = dbx_memcpy_ex(&(pkeyval->svalue), (void *) mkeys[pkey->argc - 1].svalue.buf_addr, (size_t) mkeys[pkey->argc - 1].svalue.len_used);
-                  }
-                  else {
-                     rc = dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.mv_data, (size_t) mkeys[pkey->argc - 1].csize);
-                     pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
-                     rc = dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
-                  }
-                  dbx_memcpy_exx(&(pdataval->svalue), (void *) data.mv_data, (unsigned int) data.mv_size);
-                  break;
+               if (rc == CACHE_SUCCESS && key.size > pmeth->key.args[pmeth->key.argc - 1].csize && !bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
+                  n += 10;
                }
             }
-         }
-         else {
-            rc = YDB_NODE_END;
-            break;
+            pcursor->close(pcursor);
          }
       }
+      rc = CACHE_SUCCESS;
    }
-   else { /* not mumps */
-/*
-      printf("\r\nstarting from ...");
-      dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, key0, data;
+      MDB_cursor *pcursor;
 
-      if (key.mv_size == 0) {
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_FIRST);
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = &(pmeth->key.args[0].num.int32);
+         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
 
-         if (rc == CACHE_SUCCESS) {
-            pkeyval->svalue.len_used = (unsigned int) key.mv_size;
-            if (pcon->key_type == DBX_KEYTYPE_INT) {
-               pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
-            }
-            else {
-               rc = dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
-            }
-         }
-         else {
-            pkeyval->svalue.len_used = 0;
-            rc = YDB_NODE_END;
-         }
+         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
+         key0.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
+         key0.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+      }
+
+      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+
+      rc = lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &key, &data);
+      pmeth->output_val.svalue.len_used = (unsigned int) data.mv_size;
+
+      if (rc == MDB_NOTFOUND) {
+         rc = CACHE_ERUNDEF;
+         n = 0;
       }
       else {
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+         n = 1;
+      }
+      found = n;
+      if (n && dbx_expired((char *) data.mv_data, data.mv_size)) { /* v1.3.27 expired but not yet swept */
+         n = 0;
+      }
 
+      if (pcon->key_type == DBX_KEYTYPE_M) {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &pcursor);
+         if (rc == CACHE_SUCCESS) {
 /*
-         printf("\r\nAdvance Cursor (DB_SET_RANGE): rc=%d; key.mv_size=%d", rc, key.mv_size);
-         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+            printf("\r\ndbx_defined: n=%d; key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
 */
-         if (rc == CACHE_SUCCESS) {
-            pkeyval->svalue.len_used = (unsigned int) key.mv_size;
-            if (!lmdb_key_compare(&key, &key0, 0, pcon->key_type)) {
-               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+            rc =  pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
 
 /*
-               printf("\r\nAdvance Cursor (DB_NEXT): rc=%d; key.mv_size=%d", rc, key.mv_size);
-               dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+            printf("\r\ndbx_defined: DB_SET_RANGE: n=%d; rc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+            if (rc == CACHE_SUCCESS) {
+               if (found && key.mv_size == pmeth->key.args[pmeth->key.argc - 1].csize && !lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) { /* current record defined, get next */
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+/*
+                  printf("\r\ndbx_defined: DB_NEXT: n=%d; rc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
 */
-               if (rc == CACHE_SUCCESS) {
-                  pkeyval->svalue.len_used = (unsigned int) key.mv_size;
-                  if (pcon->key_type == DBX_KEYTYPE_INT) {
-                     pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
-                  }
-                  else {
-                     dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
-                  }
-               }
-               else {
-                  pkeyval->svalue.len_used = 0;
-                  rc = YDB_NODE_END;
-               }
-            }
-            else {
-               pkeyval->svalue.len_used = (unsigned int) key.mv_size;
-               if (pcon->key_type == DBX_KEYTYPE_INT) {
-                  pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
                }
-               else {
-                  dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
+               if (rc == CACHE_SUCCESS && key.mv_size > pmeth->key.args[pmeth->key.argc - 1].csize && !lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
+                  n += 10;
                }
             }
+            pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
          }
-         else {
-            pkeyval->svalue.len_used = 0;
-            rc = YDB_NODE_END;
-         }
-      }
-      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
-         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
-         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
-         pkeyval->type = DBX_DTYPE_INT;
       }
+      rc = lmdb_commit_ro_transaction(pmeth, 0);
+      rc = CACHE_SUCCESS;
    }
 
-   if (context == 0) {
-      pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
-      lmdb_commit_ro_transaction(pmeth, 0);
-   }
+   strcpy(pmeth->output_val.svalue.buf_addr, "0");
+   pmeth->output_val.svalue.len_used = 0;
 
-   if (rc != CACHE_SUCCESS) {
-      pkeyval->svalue.len_used = 0;
+   if (rc == CACHE_SUCCESS || rc == CACHE_ERUNDEF) {
+      pmeth->output_val.num.int32 = n; /* v1.3.11 */
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &n, DBX_DTYPE_INT);
+      rc = CACHE_SUCCESS;
    }
-   if (pkeyval->svalue.len_used == 0) {
-      rc = YDB_NODE_END;
+   else {
+      dbx_error_message(pmeth, rc, (char *) "dbx_defined");
+   }
+
+   /* v1.3.11 */
+/*
+   if (pmeth->key.argc > 2) {
+      if (!strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
+         dbx_dump_mref(pcon, pmeth, (char *) "defined", &(pmeth->output_val), rc);
+      }
    }
+*/
+
+dbx_defined_exit:
+
+   DBX_DB_UNLOCK();
 
+   DBX_STATS_END(pmeth, DBX_STATS_DEFINED, tstats, rc);
    return rc;
+
+#ifdef _WIN32
 }
+__except (EXCEPTION_EXECUTE_HANDLER) {
 
+   DWORD code;
+   char bufferx[256];
 
-int lmdb_previous(DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context)
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_defined: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+
+int dbx_delete(DBXMETH *pmeth)
 {
-   int rc, mkeyn, fixed_comp;
+   int rc, n, dropped, nindex;
    DBXCON *pcon = pmeth->pcon;
-   MDB_val key, key0, data;
-   MDB_cursor *pcursor;
-   DBXVAL mkeys[DBX_MAXARGS];
-/*
-   printf("\r\n ******* lmdb_previous ******* argn=%d; pkeyval->svalue.buf_addr=%p; pkey->ibuffer.buf_addr=%p; seed_len%d\r\n", pkey->argc, pkeyval->svalue.buf_addr, pkey->ibuffer.buf_addr, pkey->args[pkey->argc - 1].svalue.len_used);
-*/
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
+   DBT key, key0, data;
+   DBC *pcursor;
 
-   if (context == 0) {
-      rc = lmdb_start_ro_transaction(pmeth, 0);
-      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &pcursor);
-   }
-   else {
-     pcursor = pmeth->plmdbcursor;
+#ifdef _WIN32
+__try {
+#endif
+
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
+
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+      goto dbx_delete_exit;
    }
 
-   if (pcon->key_type == DBX_KEYTYPE_INT) {
-      key0.mv_data = &(pkey->args[0].num.int32);
-      key0.mv_size = sizeof(pkey->args[0].num.int32);
-      pkeyval->num.int32 = pkey->args[0].num.int32;
-      key.mv_data = &(pkeyval->num.int32);
-      key.mv_size = sizeof(pkeyval->num.int32);
-      if (pkey->args[0].svalue.len_used == 0) {
-         key.mv_size = 0;
-         key0.mv_size = 0;
+   nindex = 0;
+   if (pcon->pindex && pcon->key_type == DBX_KEYTYPE_M && (!pcon->global_dbs || pmeth->pgdb)) { /* v1.3.26 */
+      nindex = dbx_index_open(pmeth);
+      if (nindex < 0) {
+         rc = CACHE_FAILURE;
+         dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+         goto dbx_delete_exit;
+      }
+      if (nindex && pcon->dbtype == DBX_DBTYPE_BDB) { /* remove the index entries for the records to be deleted */
+         rc = dbx_index_apply(pmeth, pmeth->key.ibuffer.buf_addr, pmeth->key.args[pmeth->key.argc - 1].csize, 1, NULL);
+         if (rc != CACHE_SUCCESS) {
+            dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+            goto dbx_delete_exit;
+         }
       }
-   }
-   else if (pcon->key_type == DBX_KEYTYPE_STR) {
-      key0.mv_data = pkey->args[0].svalue.buf_addr;
-      key0.mv_size = pkey->args[0].svalue.len_used;
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->args[0].svalue.buf_addr, (size_t) pkey->args[0].svalue.len_used);
-      pkeyval->svalue.len_used = pkey->args[0].svalue.len_used;
-      key.mv_data = (void *) pkeyval->svalue.buf_addr;
-      key.mv_size = (size_t) pkeyval->svalue.len_used;
-   }
-   else { /* mumps */
-      key0.mv_data = (void *) pkey->ibuffer.buf_addr;
-      key0.mv_size = (size_t) pkey->ibuffer.len_used;
-      dbx_memcpy_exx(&(pkeyval->svalue), (void *) pkey->ibuffer.buf_addr, (size_t) pkey->ibuffer.len_used);
-      pkeyval->svalue.len_used = pkey->ibuffer.len_used;
-      key.mv_data = (void *) pkeyval->svalue.buf_addr;
-      key.mv_size = (size_t) pkeyval->svalue.len_used;
    }
 
-   data.mv_data = (void *) pdataval->svalue.buf_addr;
-   data.mv_size = (size_t) pdataval->svalue.len_alloc;
+   n = 0;
+   dropped = 0;
+   if (pcon->global_dbs && (!pmeth->pgdb || (pmeth->key.argc == 1 && pcon->dbtype == DBX_DBTYPE_BDB))) { /* v1.3.15 */
+      /* global does not exist, or the whole global is to be killed: remove its sub-database */
+      rc = CACHE_SUCCESS;
+      if (pmeth->pgdb) {
+         rc = dbx_global_db_drop(pmeth, pmeth->pgdb);
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      memset(&key, 0, sizeof(DBT));
+      memset(&key0, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+      key0.flags = DB_DBT_USERMEM;
+      data.flags = DB_DBT_USERMEM;
 
-   fixed_comp = 0;
-   rc = YDB_NODE_END;
-   if (pcon->key_type == DBX_KEYTYPE_M) {
-/*
-      printf("\r\n seed ... pkey->ibuffer.len_used=%d", pkey->ibuffer.len_used);
-      dbx_dump_key((char *) key0.mv_data, (int) key0.mv_size);
-*/
-      pkeyval->svalue.len_used = 0;
-      if (pkey->argc < 2 && pkey->args[pkey->argc - 1].svalue.len_used == 0) { /* null seed - special case */
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
 
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
-/*
-         printf("\r\n DB_LAST rc=%d; argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
-         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+         key.ulen = (u_int32_t) pmeth->key.ibuffer.len_alloc;
 
+         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
+         key0.data = (void *) pmeth->output_key.svalue.buf_addr;
+         key0.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+         key0.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
       }
-      else {
 
-         if (pkey->args[pkey->argc - 1].svalue.len_used == 0) {
-            *(((unsigned char *) key.mv_data) + pkey->args[pkey->argc - 1].csize - 1) = 0xff;
-         }
+      data.data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
 
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+      rc = DBX_BDB_PDB(pmeth)->del(DBX_BDB_PDB(pmeth), NULL, &key, 0);
+      n = rc;
+
+      /* v1.3.11 */
 /*
-         printf("\r\n DB_SET_RANGE rc=%d; argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
-         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+      if (pmeth->key.argc > 1) {
+         dbx_dump_mref(pcon, pmeth, (char *) "kill", NULL, rc);
+      }
 */
-         if (rc == MDB_NOTFOUND) {
-            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
+
+      if (pcon->key_type == DBX_KEYTYPE_M) {
+         rc = DBX_BDB_PDB(pmeth)->cursor(DBX_BDB_PDB(pmeth), NULL, &pcursor, 0);
+
+         if (rc == CACHE_SUCCESS) {
 /*
-            printf("\r\n DB_LAST rc=%d; argc=%d; key.mv_size=%d", rc, pkey->argc, (int) key.mv_size);
-            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+            printf("\r\nkey.ulen=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", (int) key.ulen, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
 */
-         }
-         else if (rc == CACHE_SUCCESS) {
-            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_PREV);
-         }
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_SET_RANGE); /* v1.3.9 */
 
-         if (rc == CACHE_SUCCESS) {
+            if (rc == DB_NOTFOUND) { /* v1.3.11 */
+               rc = CACHE_SUCCESS;
+               goto dbx_delete_exit;
+            }
+
+            if (rc != CACHE_SUCCESS) {
+               dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+               goto dbx_delete_exit;
+            }
 
-            if (pkey->argc < 2)
-               fixed_comp = 0;
-            else
-               fixed_comp = lmdb_key_compare(&key, &key0, pkey->args[pkey->argc - 2].csize, pcon->key_type);
 /*
-            printf("\r\n DB_PREV rc=%d; argc=%d; key.mv_size=%d; fixed_comp=%d;", rc, pkey->argc, (int) key.mv_size, fixed_comp);
-            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+            printf("\r\nrc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+            dbx_dump_key((char *) key.data, (int) key.size);
 */
+            if (rc == CACHE_SUCCESS && !bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
+               for (;;) {
+                  /* dbx_dump_key((char *) key.data, (int) key.size); */
+                  /* v1.3.11  v1.3.12 */
+                  rc = DBX_BDB_PDB(pmeth)->del(DBX_BDB_PDB(pmeth), NULL, &key, 0);
+                  /* rc = pcursor->del(pcursor, 0); */
+                  rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_NEXT); /* v1.3.9 */
+                  if (rc == DB_NOTFOUND) { /* v1.3.11 */
+                     rc = CACHE_SUCCESS;
+                     break;
+                  }
+                  if (rc != CACHE_SUCCESS) {
+                     dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+                  }
+                  if (rc != CACHE_SUCCESS || bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
+                     break;
+                  }
+               }
+            }
+            pcursor->close(pcursor);
          }
+         rc = CACHE_SUCCESS;
       }
-      if (rc == CACHE_SUCCESS && !fixed_comp) {
-         mkeyn = dbx_split_key(&mkeys[0], (char *) key.mv_data, (int) key.mv_size);
 
-         if (context == 0) {
-            dbx_memcpy_ex(&(pkeyval->svalue),  (void *) mkeys[pmeth->key.argc - 1].svalue.buf_addr,  (size_t) mkeys[pmeth->key.argc - 1].svalue.len_used);
-         }
-         else {
-            dbx_memcpy_ex(&(pkey->ibuffer), (void *) key.mv_data, (size_t) mkeys[pkey->argc - 1].csize);
-            pkey->argc = dbx_split_key(&(pkey->args[0]), (char *) pkey->ibuffer.buf_addr, (int) pkey->ibuffer.len_used);
-            dbx_memcpy_ex(&(pkeyval->svalue), (void *) pkey->args[pkey->argc - 1].svalue.buf_addr, (size_t) pkey->args[pkey->argc - 1].svalue.len_used);
+      if (pmeth->pgdb) { /* v1.3.15 remove the global's sub-database once it is empty */
+         rc = pmeth->pgdb->pdb->cursor(pmeth->pgdb->pdb, NULL, &pcursor, 0);
+         if (rc == CACHE_SUCCESS) {
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_FIRST);
+            pcursor->close(pcursor);
+            if (rc == DB_NOTFOUND) {
+               dbx_global_db_drop(pmeth, pmeth->pgdb);
+            }
          }
-         dbx_memcpy_exx(&(pdataval->svalue), (void *) data.mv_data, (unsigned int) data.mv_size);
+         rc = CACHE_SUCCESS;
+      }
 
-         if (mkeyn != pkey->argc) { /* can't use data as it's under lower subscripts */
-            data.mv_size = 0;
-            pdataval->svalue.len_used = (unsigned int) data.mv_size;
-         }
+      /* v1.3.12 */
+      /* pcon->p_bdb_so->pdb->sync(pcon->p_bdb_so->pdb, 0); */
+
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, key0, data;
+      MDB_cursor *pcursor;
 
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = &(pmeth->key.args[0].num.int32);
+         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
       }
-      else {
-         pkeyval->svalue.len_used = 0;
-         rc = YDB_NODE_END;
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
       }
-   }
-   else { /* not mumps */
-      if (key.mv_size == 0) {
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
-         if (rc == CACHE_SUCCESS) {
-            pkeyval->svalue.len_used = (unsigned int) key.mv_size;
-            if (pcon->key_type == DBX_KEYTYPE_INT) {
-               pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
-            }
-            else {
-               dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
-            }
-         }
-         else {
-            pkeyval->svalue.len_used = 0;
-            rc = YDB_NODE_END;
-         }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+
+         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
+         key0.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
+         key0.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
       }
-      else {
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
 
-         if (rc == CACHE_SUCCESS) {
-            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_PREV);
+      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
 
-            if (rc == CACHE_SUCCESS) {
-               pkeyval->svalue.len_used = (unsigned int) key.mv_size;
-               if (pcon->key_type == DBX_KEYTYPE_INT) {
-                  pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
-               }
-               else {
-                  dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
-               }
-            }
-            else {
-               pkeyval->svalue.len_used = 0;
-               rc = YDB_NODE_END;
-            }
-         }
-         else {
-            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_LAST);
+      rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+      if (rc != 0) {
+         strcpy(pcon->error, "Cannot create or open a LMDB transaction for a delete operation");
+         dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+         goto dbx_delete_exit;
+      }
+      pcon->tlevel ++;
 
-            if (rc == CACHE_SUCCESS) {
-               pkeyval->svalue.len_used = (unsigned int) key.mv_size;
-               if (pcon->key_type == DBX_KEYTYPE_INT) {
-                  pkeyval->num.int32 = dbx_get_size((unsigned char *) key.mv_data, 0);
-               }
-               else {
-                  dbx_memcpy_exx(&(pkeyval->svalue), (void *) key.mv_data, pkeyval->svalue.len_used);
-               }
-            }
-            else {
-               pkeyval->svalue.len_used = 0;
-               rc = YDB_NODE_END;
-            }
+      if (nindex) { /* v1.3.26 the index entries are removed in the same transaction */
+         rc = dbx_index_apply(pmeth, pmeth->key.ibuffer.buf_addr, pmeth->key.args[pmeth->key.argc - 1].csize, 1, NULL);
+         if (rc != CACHE_SUCCESS) {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+            pcon->tlevel --;
+            dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+            goto dbx_delete_exit;
          }
       }
-      if (rc == CACHE_SUCCESS && pcon->key_type == DBX_KEYTYPE_INT) {
-         sprintf(pkeyval->svalue.buf_addr, "%d", pkeyval->num.int32);
-         pkeyval->svalue.len_used = (unsigned int) strlen(pkeyval->svalue.buf_addr);
-         pkeyval->type = DBX_DTYPE_INT;
+
+      if (pmeth->pgdb && pmeth->key.argc == 1) { /* v1.3.15 kill the whole global: drop its named database */
+         rc = pcon->p_lmdb_so->p_mdb_drop(pcon->p_lmdb_so->ptxn, pmeth->pgdb->dbi, 1);
+         n = 0;
+         if (rc == CACHE_SUCCESS) {
+            dropped = 1;
+         }
+         goto dbx_delete_commit;
       }
-   }
 
-   if (context == 0) {
-      pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
-      lmdb_commit_ro_transaction(pmeth, 0);
-   }
+      rc = pcon->p_lmdb_so->p_mdb_del(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, NULL);
+      n = rc;
 
-   if (rc != CACHE_SUCCESS) {
-      pkeyval->svalue.len_used = 0;
-   }
+      if (pcon->key_type == DBX_KEYTYPE_M) {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &pcursor);
 
-   return rc;
-}
+         if (rc == CACHE_SUCCESS) {
+/*
+            printf("\r\npmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+*/
+            rc =  pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
 
+/*
+            printf("\r\nrc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+            if (rc == CACHE_SUCCESS && !lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
+               for (;;) {
+                  /* dbx_dump_key((char *) key.data, (int) key.size); */
+                  rc = pcon->p_lmdb_so->p_mdb_del(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, NULL);
 
-int lmdb_key_compare(MDB_val *key1, MDB_val *key2, int compare_max, short keytype)
-{
-   int n, n1, n2, rc;
-   char *c1, *c2;
+                  rc =  pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
 
-   c1 = (char *) key1->mv_data;
-   c2 = (char *) key2->mv_data;
-   if (keytype == DBX_KEYTYPE_M) {
-      if (compare_max > 0) {
-         if (key1->mv_size < (u_int32_t) compare_max || key2->mv_size < (u_int32_t) compare_max) {
-            return -1;
-         }
-         if ((int) key1->mv_size > compare_max && c1[compare_max] != '\0') {
-            return -1;
-         }
-         if ((int) key2->mv_size > compare_max && c2[compare_max] != '\0') {
-            return -1;
+                  if (rc != CACHE_SUCCESS || lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
+                     break;
+                  }
+               }
+            }
+            pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
          }
+         /* v1.3.22 the chunks held for the node and its descendants go with them */
+         lmdb_chunk_drop(pmeth, pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), pmeth->key.ibuffer.buf_addr, (unsigned int) pmeth->key.args[pmeth->key.argc - 1].csize, 1);
+         rc = CACHE_SUCCESS;
       }
-      else {
-         if (key1->mv_size == 0) {
-            return -1;
-         }
-         if (key1->mv_size != key2->mv_size) {
-            return -1;
+
+      if (pmeth->pgdb) { /* v1.3.15 drop the global's named database once it is empty */
+         rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, pmeth->pgdb->dbi, &pcursor);
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_FIRST);
+            pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+            if (rc == MDB_NOTFOUND && pcon->p_lmdb_so->p_mdb_drop(pcon->p_lmdb_so->ptxn, pmeth->pgdb->dbi, 1) == CACHE_SUCCESS) {
+               dropped = 1;
+            }
          }
-         compare_max = (int) key1->mv_size;
-      }
-   }
-   else {
-      if (key1->mv_size == 0) {
-         return -1;
-      }
-      if (key1->mv_size != key2->mv_size) {
-         return -1;
+         rc = CACHE_SUCCESS;
       }
 
-      if (keytype == DBX_KEYTYPE_INT) {
-         n1 = *((int *) key1->mv_data);
-         n2 = *((int *) key2->mv_data);
-         if (n1 == n2)
-            return 0;
-         else
-            return -1;
-      }
-      compare_max = (int) key1->mv_size;
-   }
+dbx_delete_commit:
 
-   rc = 0;
-   for (n = 0; n < (int) compare_max; n ++) {
-      if (c1[n] != c2[n]) {
-         rc = -1;
-         break;
+      rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+      pcon->tlevel --;
+      if (rc == CACHE_SUCCESS && dropped) {
+         pmeth->pgdb->open = 0; /* handle was closed by mdb_drop() */
       }
    }
-   return rc;
-}
 
+   if (rc == CACHE_SUCCESS) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &n, DBX_DTYPE_INT);
+   }
+   else {
+      dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+   }
 
-/* v1.3.10 */
-int lmdb_error_message(DBXCON *pcon, int error_code)
-{
-   switch (error_code) {
-      case MDB_SUCCESS:
-         strcpy(pcon->error, "");
-         break;
-      case MDB_KEYEXIST:
-         sprintf(pcon->error, "LMDB error %d (MDB_KEYEXIST) Key/data pair already exists", error_code);
-         break;
-      case MDB_NOTFOUND:
-         sprintf(pcon->error, "LMDB error %d (MDB_NOTFOUND) Key/data pair not found (EOF)", error_code);
-         break;
-      case MDB_PAGE_NOTFOUND:
-         sprintf(pcon->error, "LMDB error %d (MDB_PAGE_NOTFOUND) Requested page not found - this usually indicates corruption", error_code);
-         break;
-      case MDB_CORRUPTED:
-         sprintf(pcon->error, "LMDB error %d (MDB_CORRUPTED) Located page was wrong type", error_code);
-         break;
-      case MDB_PANIC:
-         sprintf(pcon->error, "LMDB error %d (MDB_PANIC) Update of meta page failed or environment had fatal error", error_code);
-         break;
-      case MDB_VERSION_MISMATCH:
-         sprintf(pcon->error, "LMDB error %d (MDB_VERSION_MISMATCH) Environment version mismatch", error_code);
-         break;
-      case MDB_INVALID:
-         sprintf(pcon->error, "LMDB error %d (MDB_INVALID) File is not a valid LMDB file", error_code);
-         break;
-      case MDB_MAP_FULL:
-         sprintf(pcon->error, "LMDB error %d (MDB_MAP_FULL) Environment mapsize reached", error_code);
-         break;
-      case MDB_DBS_FULL:
-         sprintf(pcon->error, "LMDB error %d (MDB_DBS_FULL) Environment maxdbs reached", error_code);
-         break;
-      case MDB_READERS_FULL:
-         sprintf(pcon->error, "LMDB error %d (MDB_READERS_FULL) Environment maxreaders reached", error_code);
-         break;
-      case MDB_TLS_FULL:
-         sprintf(pcon->error, "LMDB error %d (MDB_TLS_FULL) Too many TLS keys in use - Windows only", error_code);
-         break;
-      case MDB_TXN_FULL:
-         sprintf(pcon->error, "LMDB error %d (MDB_TXN_FULL) Transaction has too many dirty pages", error_code);
-         break;
-      case MDB_CURSOR_FULL:
-         sprintf(pcon->error, "LMDB error %d (MDB_CURSOR_FULL) Cursor stack too deep - internal error", error_code);
-         break;
-      case MDB_PAGE_FULL:
-         sprintf(pcon->error, "LMDB error %d (MDB_PAGE_FULL) Page has not enough space - internal error", error_code);
-         break;
-      case MDB_MAP_RESIZED:
-         sprintf(pcon->error, "LMDB error %d (MDB_MAP_RESIZED) Database contents grew beyond environment mapsize", error_code);
-         break;
-      case MDB_INCOMPATIBLE:
-         sprintf(pcon->error, "LMDB error %d (MDB_INCOMPATIBLE) Operation and DB incompatible, or DB type changed", error_code);
-         break;
-      case MDB_BAD_RSLOT:
-         sprintf(pcon->error, "LMDB error %d (MDB_BAD_RSLOT) Invalid reuse of reader locktable slot", error_code);
-         break;
-      case MDB_BAD_TXN:
-         sprintf(pcon->error, "LMDB error %d (MDB_BAD_TXN) Transaction must abort, has a child, or is invalid", error_code);
-         break;
-      case MDB_BAD_VALSIZE:
-         sprintf(pcon->error, "LMDB error %d (MDB_BAD_VALSIZE) Unsupported size of key/DB name/data, or wrong DUPFIXED size", error_code);
-         break;
-      case MDB_BAD_DBI:
-         sprintf(pcon->error, "LMDB error %d (MDB_BAD_DBI) The specified DBI was changed unexpectedly", error_code);
-         break;
-#if defined(MDB_PROBLEM)
-      case MDB_PROBLEM:
-         sprintf(pcon->error, "LMDB error %d (MDB_PROBLEM) General problem", error_code);
-         break;
-#endif
-      case CACHE_NOCON:
-         sprintf(pcon->error, "LMDB error %d (DB_UNAVAILABLE) DB unavailable - check installation", error_code);
-         break;
-      default:
-         sprintf(pcon->error, "LMDB error %d (MDB_UNKNOWN) Unknown error condition", error_code);
-         break;
+dbx_delete_exit:
+
+   DBX_DB_UNLOCK();
+
+   DBX_STATS_END(pmeth, DBX_STATS_DELETE, tstats, rc);
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_delete: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
    }
 
-   return 0;
+   return CACHE_FAILURE;
+}
+#endif
 }
 
 
-int dbx_version(DBXMETH *pmeth)
+int dbx_next(DBXMETH *pmeth)
 {
-   char buffer[256];
+   int rc;
    DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
 #ifdef _WIN32
 __try {
 #endif
 
-   T_SPRINTF((char *) buffer, _dbxso(buffer), "mg-dbx-bdb: version: %s; ABI: %d", DBX_VERSION, NODE_MODULE_VERSION);
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
 
-   if (pcon->p_zv && pcon->p_zv->version[0]) {
-      if (pcon->p_zv->dbtype == DBX_DBTYPE_BDB)
-         T_STRCAT((char *) buffer, _dbxso(buffer), "; BerkeleyDB version: ");
-      else if (pcon->p_zv->dbtype == DBX_DBTYPE_LMDB)
-         T_STRCAT((char *) buffer, _dbxso(buffer), "; LMDB version: ");
-      T_STRCAT((char *) buffer, _dbxso(buffer), pcon->p_zv->version);
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_next");
+      goto dbx_next_exit;
    }
 
-   dbx_create_string(&(pmeth->output_val.svalue), (void *) buffer, DBX_DTYPE_STR8);
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      rc = bdb_next(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      rc = lmdb_next(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
+   }
 
-   return 0;
+   if (rc == YDB_NODE_END) {
+      rc = CACHE_SUCCESS;
+   }
+   else if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_next");
+   }
+
+dbx_next_exit:
+
+   DBX_DB_UNLOCK();
+
+   DBX_STATS_END(pmeth, DBX_STATS_NEXT, tstats, rc);
+   return rc;
 
 #ifdef _WIN32
 }
@@ -5782,77 +11744,56 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_version: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_next: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
       ;
    }
 
-   return 0;
+   return CACHE_FAILURE;
 }
 #endif
 }
 
-int dbx_open(DBXMETH *pmeth)
+
+int dbx_previous(DBXMETH *pmeth)
 {
    int rc;
    DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
 #ifdef _WIN32
 __try {
 #endif
 
-   rc = 0;
-   if (!pcon->dbtype) {
-      strcpy(pcon->error, "Unable to determine the database type");
-      rc = CACHE_NOCON;
-      goto dbx_open_exit;
-   }
-
-   if (!pcon->db_library[0]) {
-      strcpy(pcon->error, "Unable to determine the path to the database installation");
-      rc = CACHE_NOCON;
-      goto dbx_open_exit;
-   }
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
 
-   dbx_enter_critical_section((void *) &dbx_async_mutex);
-   if (pcon->dbtype == DBX_DBTYPE_BDB && p_bdb_so_global) {
-      rc = CACHE_SUCCESS;
-      pcon->p_bdb_so = p_bdb_so_global;
-      pcon->p_bdb_so->no_connections ++;
-      pcon->p_bdb_so->multiple_connections ++;
-      pcon->p_zv = &(p_bdb_so_global->zv);
-      dbx_leave_critical_section((void *) &dbx_async_mutex);
-      return rc;
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB && p_lmdb_so_global) {
-      rc = CACHE_SUCCESS;
-      pcon->p_lmdb_so = p_lmdb_so_global;
-      pcon->p_lmdb_so->no_connections ++;
-      pcon->p_lmdb_so->multiple_connections ++;
-      pcon->p_zv = &(p_lmdb_so_global->zv);
-      dbx_leave_critical_section((void *) &dbx_async_mutex);
-      return rc;
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_previous");
+      goto dbx_previous_exit;
    }
 
    if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      rc = bdb_open(pmeth);
-      pcon->p_bdb_so->no_connections ++;
-      p_bdb_so_global = pcon->p_bdb_so;
+      rc = bdb_previous(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
    }
    else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      rc = lmdb_open(pmeth);
-      pcon->p_lmdb_so->no_connections ++;
-      p_lmdb_so_global = pcon->p_lmdb_so;
+      rc = lmdb_previous(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
    }
 
-   dbx_pool_thread_init(pcon, 1);
+   if (rc == YDB_NODE_END) {
+      rc = CACHE_SUCCESS;
+   }
+   else if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_previous");
+   }
 
-   dbx_leave_critical_section((void *) &dbx_async_mutex);
+dbx_previous_exit:
 
-dbx_open_exit:
+   DBX_DB_UNLOCK();
 
+   DBX_STATS_END(pmeth, DBX_STATS_PREVIOUS, tstats, rc);
    return rc;
 
 #ifdef _WIN32
@@ -5864,7 +11805,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_open: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_previous: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -5877,121 +11818,151 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_do_nothing(DBXMETH *pmeth)
-{
-
-   /* Function called asynchronously */
-
-   return 0;
-}
-
-
-int dbx_close(DBXMETH *pmeth)
+int dbx_increment(DBXMETH *pmeth)
 {
-   int no_connections;
+   int rc;
    DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
 #ifdef _WIN32
 __try {
 #endif
 
-/*
-   printf("\r\n******* Graceful Close *******\r\n");
-*/
-   no_connections = 0;
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
 
-   dbx_enter_critical_section((void *) &dbx_async_mutex);
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      if (pcon->p_bdb_so) {
-         pcon->p_bdb_so->no_connections --;
-         no_connections =  pcon->p_bdb_so->no_connections;
-      }
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      if (pcon->p_lmdb_so) {
-         pcon->p_lmdb_so->no_connections --;
-         no_connections =  pcon->p_lmdb_so->no_connections;
-      }
+   pmeth->increment = 1;
+   pmeth->update = 1; /* v1.3.15 */
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_increment");
+      goto dbx_increment_exit;
    }
-   dbx_leave_critical_section((void *) &dbx_async_mutex);
-/*
-   printf("\r\ndbx_close: no_connections=%d\r\n", no_connections);
-*/
+
    if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT key, data;
 
-      /* printf("\r\ndbx_close: no_connections=%d; pcon->p_bdb_so->multiple_connections=%d;\r\n", no_connections, pcon->p_bdb_so->multiple_connections); */
+      memset(&key, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.flags = DB_DBT_USERMEM;
+      data.flags = DB_DBT_USERMEM;
 
-      if (pcon->p_bdb_so && no_connections == 0 && pcon->p_bdb_so->multiple_connections == 0) {
-         if (pcon->p_bdb_so->loaded) {
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.data = &(pmeth->key.args[0].num.int32);
+         key.size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 2].csize;
+      }
 
-            if (pcon->p_bdb_so->pdb != NULL) {
-               pcon->p_bdb_so->pdb->close(pcon->p_bdb_so->pdb, 0);
-            }
+      data.data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
+      data.size = 0;
 
-/*
-            printf("\r\np_bdb_exit=%d\r\n", rc);
-            dbx_dso_unload(pcon->p_bdb_so->p_library); 
-*/
-            pcon->p_bdb_so->p_library = NULL;
-            pcon->p_bdb_so->loaded = 0;
-         }
+      rc = bdb_get(pmeth, &key, &data, &(pmeth->output_val.svalue));
+      if (rc == CACHE_FAILURE) {
+         dbx_error_message(pmeth, rc, (char *) "dbx_increment");
+         goto dbx_increment_exit;
+      }
 
-         strcpy(pcon->error, "");
-         dbx_create_string(&(pmeth->output_val.svalue), (void *) "1", DBX_DTYPE_STR);
+      pmeth->output_val.svalue.len_used = data.size;
+      pmeth->output_val.svalue.buf_addr[data.size] = '\0';
 
-         strcpy(pcon->p_bdb_so->libdir, "");
-         strcpy(pcon->p_bdb_so->libnam, "");
-      }
+      dbx_increment_value(pmeth); /* v1.3.24 */
+
+      data.data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.size = (u_int32_t) pmeth->output_val.svalue.len_used;
+      data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+      rc = DBX_BDB_PDB(pmeth)->put(DBX_BDB_PDB(pmeth), NULL, &key, &data, 0);
    }
    else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
 
-      /* printf("\r\ndbx_close: no_connections=%d; pcon->p_lmdb_so->multiple_connections=%d;\r\n", no_connections, pcon->p_lmdb_so->multiple_connections); */
-
-      if (pcon->p_lmdb_so) {
-         if (pcon->tlevel > 0) {
-            pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
-            pcon->tlevel = 0;
-         }
-         if (pcon->tlevelro > 0) {
-            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxnro);
-            pcon->tlevelro = 0;
-         }
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = &(pmeth->key.args[0].num.int32);
+         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      }
+      else { /* mumps */
+         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 2].csize;
       }
 
-      if (pcon->p_lmdb_so && no_connections == 0 && pcon->p_lmdb_so->multiple_connections == 0) {
-         if (pcon->p_lmdb_so->loaded) {
+      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.mv_size = (size_t)  pmeth->output_val.svalue.len_alloc;
 
-            if (pcon->p_lmdb_so->pdb != NULL) {
-               pcon->p_lmdb_so->p_mdb_dbi_close(pcon->p_lmdb_so->penv, pcon->p_lmdb_so->db);
-            }
-            if (pcon->p_lmdb_so->penv != NULL) {
-               pcon->p_lmdb_so->p_mdb_env_close(pcon->p_lmdb_so->penv);
+      strcpy(pmeth->output_val.svalue.buf_addr, "");
+      pmeth->output_val.svalue.len_alloc = 0;
+      pmeth->output_val.svalue.len_used = 0;
+
+      rc = lmdb_start_ro_transaction(pmeth, 0); /* v1.2.8 */
+      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, DBX_LMDB_DBI(pmeth), &key, &data);
+      lmdb_commit_ro_transaction(pmeth, 0); /* v1.2.8 */
+
+      if (rc == CACHE_SUCCESS) { /* v1.2.8 */
+         if (pmeth->output_val.svalue.len_alloc < data.mv_size) { /* v1.3.9 */
+            if (!dbx_buffer_resize(&(pmeth->output_val.svalue.buf_addr), 0, (unsigned int) data.mv_size + 32, &(pmeth->output_val.svalue.len_alloc))) {
+               rc = CACHE_FAILURE;
+               dbx_error_message(pmeth, rc, (char *) "dbx_increment");
+               goto dbx_increment_exit;
             }
+         }
+         dbx_memcpy_exx(&(pmeth->output_val.svalue), (void *) data.mv_data, data.mv_size);
+         pmeth->output_val.svalue.len_used = (unsigned int) data.mv_size;
+         pmeth->output_val.svalue.buf_addr[data.mv_size] = '\0';
+      }
 
+      dbx_increment_value(pmeth); /* v1.3.24 */
+
+      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.mv_size = (size_t) pmeth->output_val.svalue.len_used;
 
-/*
-            printf("\r\np_lmdb_exit=%d\r\n", rc);
-            dbx_dso_unload(pcon->p_lmdb_so->p_library); 
-*/
-            pcon->p_lmdb_so->p_library = NULL;
-            pcon->p_lmdb_so->loaded = 0;
+      /* v1.2.8 */
+      for (;;) { /* v1.3.28 */
+         rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+         if (rc == MDB_MAP_RESIZED && lmdb_map_grow(pmeth, rc, 0) == CACHE_SUCCESS) {
+            continue;
+         }
+         if (rc != 0) {
+            strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
+            dbx_error_message(pmeth, rc, (char *) "dbx_increment");
+            goto dbx_increment_exit;
          }
+         rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, &data, 0);
+         pcon->tlevel ++;
 
-         strcpy(pcon->error, "");
-         dbx_create_string(&(pmeth->output_val.svalue), (void *) "1", DBX_DTYPE_STR);
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+         }
+         else {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+         }
+         pcon->tlevel --;
 
-         strcpy(pcon->p_lmdb_so->libdir, "");
-         strcpy(pcon->p_lmdb_so->libnam, "");
+         if (rc == MDB_MAP_FULL && lmdb_map_grow(pmeth, rc, 0) == CACHE_SUCCESS) {
+            continue;
+         }
+         break;
       }
    }
 
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_increment");
+   }
 
-   T_STRCPY(pcon->p_zv->version, _dbxso(pcon->p_zv->version), "");
+dbx_increment_exit:
 
-   T_STRCPY(pcon->db_library, _dbxso(pcon->db_library), "");
-   T_STRCPY(pcon->db_file, _dbxso(pcon->db_file), "");
+   DBX_DB_UNLOCK();
 
-   return 0;
+   DBX_STATS_END(pmeth, DBX_STATS_INCREMENT, tstats, rc);
+   return rc;
 
 #ifdef _WIN32
 }
@@ -6002,7 +11973,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_close: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_increment: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -6015,25 +11986,158 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_global_reference(DBXMETH *pmeth)
+/* v1.3.24 Add the increment to the current value held in output_val: typed values are incremented in binary form */
+int dbx_increment_value(DBXMETH *pmeth)
 {
-   int rc;
+   int type, n;
+   double value;
+   unsigned long long deadline;
+   DBXVAL val;
+   DBXCON *pcon = pmeth->pcon;
+
+   /* v1.3.27 a node keeps its time to live when it is incremented: an expired node counts from zero */
+   deadline = dbx_expiry(pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used);
+   if (deadline) {
+      pmeth->output_val.svalue.len_used -= DBX_EHEADER_SIZE;
+      memmove((void *) pmeth->output_val.svalue.buf_addr, (void *) (pmeth->output_val.svalue.buf_addr + DBX_EHEADER_SIZE), (size_t) pmeth->output_val.svalue.len_used);
+      if (deadline <= dbx_clock_ms()) {
+         pmeth->output_val.svalue.len_used = 0;
+         deadline = 0;
+      }
+      pmeth->output_val.svalue.buf_addr[pmeth->output_val.svalue.len_used] = '\0';
+   }
+
+   type = 0;
+   if (pcon->typed_values) {
+      type = dbx_tvalue_decode(pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used, &val);
+   }
+   if (type == DBX_DTYPE_INT64) {
+      value = (double) val.num.int64;
+   }
+   else if (type == DBX_DTYPE_DOUBLE) {
+      value = val.num.real;
+   }
+   else if (type == DBX_DTYPE_BOOL) {
+      value = (double) val.num.int32;
+   }
+   else {
+      value = (double) strtod(pmeth->output_val.svalue.buf_addr, NULL);
+   }
+   value += pmeth->key.args[pmeth->key.argc - 1].num.real;
+
+   if (pcon->typed_values) {
+      pmeth->output_val.svalue.len_used = (unsigned int) dbx_tvalue_number(pmeth->output_val.svalue.buf_addr, value);
+   }
+   else {
+      sprintf(pmeth->output_val.svalue.buf_addr, "%g", value);
+      pmeth->output_val.svalue.len_used = (unsigned int) strlen(pmeth->output_val.svalue.buf_addr);
+   }
+
+   if (deadline) { /* v1.3.27 */
+      memmove((void *) (pmeth->output_val.svalue.buf_addr + DBX_EHEADER_SIZE), (void *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used);
+      pmeth->output_val.svalue.buf_addr[0] = (char) 0x00;
+      pmeth->output_val.svalue.buf_addr[1] = (char) 0xDB;
+      pmeth->output_val.svalue.buf_addr[2] = 'E';
+      pmeth->output_val.svalue.buf_addr[3] = (char) 0x00;
+      for (n = 0; n < 8; n ++) {
+         pmeth->output_val.svalue.buf_addr[4 + n] = (char) ((deadline >> (n * 8)) & 0xff);
+      }
+      pmeth->output_val.svalue.len_used += DBX_EHEADER_SIZE;
+   }
+
+   return CACHE_SUCCESS;
+}
+
+
+int dbx_lock(DBXMETH *pmeth)
+{
+   int rc, retval, timeout;
+   unsigned long long timeout_nsec;
+   char buffer[32];
    DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
 #ifdef _WIN32
 __try {
 #endif
 
-   rc = CACHE_SUCCESS;
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
+
+   pmeth->lock = 1;
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_lock");
+      goto dbx_lock_exit;
+   }
+
    if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      rc = CACHE_SUCCESS;
-      return rc;
+      timeout = -1;
+      if (pmeth->key.args[pmeth->key.argc - 1].svalue.len_used < 16) {
+         strncpy(buffer, pmeth->key.args[pmeth->key.argc - 1].svalue.buf_addr, pmeth->key.args[pmeth->key.argc - 1].svalue.len_used);
+         buffer[pmeth->key.args[pmeth->key.argc - 1].svalue.len_used] = '\0';
+         timeout = (int) strtol(buffer, NULL, 10);
+      }
+      timeout_nsec = 1000000000;
+
+      if (timeout < 0)
+         timeout_nsec *= 3600;
+      else
+         timeout_nsec *= timeout;
+      rc = YDB_OK;
+      if (rc == YDB_OK) {
+         retval = 1;
+         rc = YDB_OK;
+      }
+      else if (rc == YDB_LOCK_TIMEOUT) {
+         retval = 0;
+         rc = YDB_OK;
+      }
+      else {
+         retval = 0;
+         rc = CACHE_FAILURE;
+      }
    }
    else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      rc = CACHE_SUCCESS;
-      return rc;
+      timeout = -1;
+      if (pmeth->key.args[pmeth->key.argc - 1].svalue.len_used < 16) {
+         strncpy(buffer, pmeth->key.args[pmeth->key.argc - 1].svalue.buf_addr, pmeth->key.args[pmeth->key.argc - 1].svalue.len_used);
+         buffer[pmeth->key.args[pmeth->key.argc - 1].svalue.len_used] = '\0';
+         timeout = (int) strtol(buffer, NULL, 10);
+      }
+      timeout_nsec = 1000000000;
+
+      if (timeout < 0)
+         timeout_nsec *= 3600;
+      else
+         timeout_nsec *= timeout;
+      rc = YDB_OK;
+      if (rc == YDB_OK) {
+         retval = 1;
+         rc = YDB_OK;
+      }
+      else if (rc == YDB_LOCK_TIMEOUT) {
+         retval = 0;
+         rc = YDB_OK;
+      }
+      else {
+         retval = 0;
+         rc = CACHE_FAILURE;
+      }
+   }
+
+
+   if (rc == CACHE_SUCCESS) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &retval, DBX_DTYPE_INT);
    }
+   else {
+      dbx_error_message(pmeth, rc, (char *) "dbx_lock");
+   }
+
+dbx_lock_exit:
+
+   DBX_DB_UNLOCK();
 
+   DBX_STATS_END(pmeth, DBX_STATS_LOCK, tstats, rc);
    return rc;
 
 #ifdef _WIN32
@@ -6045,7 +12149,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_global_reference: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_lock: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -6058,132 +12162,53 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_get(DBXMETH *pmeth)
+int dbx_unlock(DBXMETH *pmeth)
 {
-   int rc;
+   int rc, retval;
    DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
 #ifdef _WIN32
 __try {
 #endif
 
-   DBX_DB_LOCK(0);
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
 
+   pmeth->lock = 2;
    rc = dbx_global_reference(pmeth);
-
    if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_get");
-      goto dbx_get_exit;
+      dbx_error_message(pmeth, rc, (char *) "dbx_unlock");
+      goto dbx_unlock_exit;
    }
 
    if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      DBT key, data;
-
-      memset(&key, 0, sizeof(DBT));
-      memset(&data, 0, sizeof(DBT));
-      key.flags = DB_DBT_USERMEM;
-      data.flags = DB_DBT_USERMEM;
-
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.data = &(pmeth->key.args[0].num.int32);
-         key.size = sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         key.data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
-      }
-
-      data.data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
-
-/* v1.1.4
-      {
-         int rc1;
-         rc1 = pcon->p_bdb_so->pdb->sync(pcon->p_bdb_so->pdb, 0);
-      }
-*/
-      rc = bdb_get(pcon, &key, &data, &(pmeth->output_val.svalue));
-      if (rc == CACHE_FAILURE) {
-         dbx_error_message(pmeth, rc, (char *) "dbx_get");
-         goto dbx_get_exit;
-      }
-
-      /* v1.3.9 */
-      pmeth->output_val.svalue.len_used = data.size;
-
-      /* v1.3.11 */
-/*
-      if (pmeth->output_val.svalue.len_used == 0 && rc != DB_NOTFOUND) {
-         if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
-            dbx_dump_mref(pcon, pmeth, (char *) "get", &(pmeth->output_val), rc);
-         }
-      }
-*/
-
-      if (rc == DB_NOTFOUND) {
-         rc = CACHE_ERUNDEF;
-      }
+      rc = YDB_OK;
+      if (rc == YDB_OK)
+         retval = 1;
+      else
+         retval = 0;
    }
    else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      MDB_val key, data;
-
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
-         key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;;
-      }
-
-      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.mv_size = (size_t) pmeth->output_val.svalue.len_alloc;
-
-      rc = lmdb_start_ro_transaction(pmeth, 0);
-      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &key, &data);
-      lmdb_commit_ro_transaction(pmeth, 0);
-
-      /* v1.3.11 */
-/*
-      if (pmeth->output_val.svalue.len_used == 0 && rc != MDB_NOTFOUND) {
-         if (pmeth->key.argc > 3) {
-            if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
-               dbx_dump_mref(pcon, pmeth, (char *) "get", &(pmeth->output_val), rc);
-            }
-         }
-      }
-*/
-
-      if (rc == CACHE_SUCCESS) {
-         dbx_memcpy_exx(&(pmeth->output_val.svalue), (void *) data.mv_data, data.mv_size);
-      }
-      else {
-         pmeth->output_val.svalue.len_used = 0;
-         if (rc == MDB_NOTFOUND) {
-            rc = CACHE_ERUNDEF;
-         }
-      }
+      rc = YDB_OK;
+      if (rc == YDB_OK)
+         retval = 1;
+      else
+         retval = 0;
    }
 
-   if (rc == CACHE_ERUNDEF) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) "", DBX_DTYPE_STR8);
+
+   if (rc == CACHE_SUCCESS) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &retval, DBX_DTYPE_INT);
    }
-   else if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_get");
+   else {
+      dbx_error_message(pmeth, rc, (char *) "dbx_unlock");
    }
 
-dbx_get_exit:
+dbx_unlock_exit:
 
    DBX_DB_UNLOCK();
 
+   DBX_STATS_END(pmeth, DBX_STATS_UNLOCK, tstats, rc);
    return rc;
 
 #ifdef _WIN32
@@ -6195,7 +12220,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_get: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_unlock: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -6208,32 +12233,49 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_set(DBXMETH *pmeth)
+int dbx_merge(DBXMETH *pmeth)
 {
-   int rc, ndata;
+   int rc, n, ref1, ref1_csize, ref2_csize;
+   unsigned char ref2_fixed[1024];
+   DBXGDB *psgdb;
    DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
 #ifdef _WIN32
 __try {
 #endif
+/*
+   printf("\r\nlen=%d\r\n", pmeth->key.ibuffer.len_used);
+   dbx_dump_key((char *) pmeth->key.ibuffer.buf_addr, (int) pmeth->key.ibuffer.len_used);
+*/
 
-   DBX_DB_LOCK(0);
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.36 */
 
-   rc = dbx_global_reference(pmeth);
+   ref1_csize = 0;
+   ref2_csize = 0;
 
+   pmeth->update = 1; /* v1.3.15 */
+   rc = dbx_global_reference(pmeth);
    if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_set");
-      goto dbx_set_exit;
+      dbx_error_message(pmeth, rc, (char *) "dbx_merge");
+      goto dbx_merge_exit;
    }
 
+   ref1 = 0;
+   n = 0;
+   psgdb = NULL;
    if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      DBT key, data;
+      DBT key, key0, key2, data;
+      DBC *pcursor;
 
       memset(&key, 0, sizeof(DBT));
+      memset(&key0, 0, sizeof(DBT));
+      memset(&key2, 0, sizeof(DBT));
       memset(&data, 0, sizeof(DBT));
       key.flags = DB_DBT_USERMEM;
+      key0.flags = DB_DBT_USERMEM;
+      key2.flags = DB_DBT_USERMEM;
       data.flags = DB_DBT_USERMEM;
-      ndata = 1;
 
       if (pcon->key_type == DBX_KEYTYPE_INT) {
          key.data = &(pmeth->key.args[0].num.int32);
@@ -6244,120 +12286,431 @@ __try {
          key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
       }
       else { /* mumps */
-         key.data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 2].csize;
-         ndata = pmeth->key.argc - 1;
+         for (n = 1; n < pmeth->jsargc; n ++) {
+            if (pmeth->key.args[n].sort == DBX_DSORT_GLOBAL) {
+               ref1 = n;
+               break;
+            }
+         }
+         if (pcon->global_dbs) { /* v1.3.15 source global is held in its own database */
+            rc = dbx_global_db(pmeth, pmeth->key.args[ref1].svalue.buf_addr, (int) pmeth->key.args[ref1].svalue.len_used, 0, &psgdb);
+         }
+         ref1_csize = pmeth->key.args[pmeth->jsargc - 1].csize - pmeth->key.args[ref1 - 1].csize;
+         ref2_csize = pmeth->key.args[ref1 - 1].csize;
+
+         key.data = (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize);
+         key.size = (u_int32_t) ref1_csize;
+         key.ulen = (u_int32_t) pmeth->key.ibuffer.len_alloc;
+/*
+         printf("\r\nref2=%d; ref1=%d; key.size=%d; ref1_csize=%d; ref2_csize=%d", ref2, ref1, (int) key.size, ref1_csize, ref2_csize);
+         dbx_dump_key((char *) key.data, (int) key.size);
+*/
+         dbx_memcpy(&(pmeth->output_key.svalue), (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize), (size_t) ref1_csize);
+         key0.data = (void *) pmeth->output_key.svalue.buf_addr;
+         key0.size = (u_int32_t) ref1_csize;
+         key0.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
+
+         memcpy((void *) ref2_fixed, (void *) pmeth->key.ibuffer.buf_addr, (size_t) ref2_csize);
       }
 
-      data.data = (void *) pmeth->key.args[ndata].svalue.buf_addr;
-      data.size = (u_int32_t) pmeth->key.args[ndata].svalue.len_used;
+      data.data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
 
-      /* v1.3.11 */
+      if (pcon->key_type == DBX_KEYTYPE_M && (!pcon->global_dbs || psgdb)) {
+         if (psgdb) { /* v1.3.15 */
+            rc = psgdb->pdb->cursor(psgdb->pdb, NULL, &pcursor, 0);
+         }
+         else {
+            rc = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pcursor, 0);
+         }
+         if (rc == CACHE_SUCCESS) {
 /*
-      if (pmeth->key.args[ndata].svalue.len_used == 0) {
-         if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
-            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
+            printf("\r\nkey.ulen=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", (int) key.ulen, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+*/
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_SET_RANGE); /* v1.3.9 */
+/*
+            printf("\r\nrc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d; key0.size=%d;", rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize, (int) key0.size);
+            dbx_dump_key((char *) key.data, (int) key.size);
+*/
+            if (rc == CACHE_SUCCESS && !bdb_key_compare(&key, &key0, (int) key0.size, pcon->key_type)) {
+/*
+            printf("\r\nrc=%d; key0.size=%d; comp=%d", rc, key0.size, bdb_key_compare(&key, &key0, (int) key0.size, pcon->key_type));
+*/
+               for (;;) {
+/*
+                  dbx_dump_key((char *) key.data, (int) key.size);
+*/
+                  memcpy((void *) (ref2_fixed + ref2_csize), (void *) ((char *) key.data + ref1_csize), (size_t) (key.size - ref1_csize));
+/*
+                  dbx_dump_key((char *) ref2_fixed, (int) (ref2_csize + (key.size - ref1_csize)));
+*/
+                  key2.data = (void *) ref2_fixed;
+                  key2.size = (u_int32_t) (ref2_csize + (key.size - ref1_csize));
+                  key2.ulen = 1024;
+                  rc = DBX_BDB_PDB(pmeth)->put(DBX_BDB_PDB(pmeth), NULL, &key2, &data, 0);
+
+                  rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_NEXT); /* v1.3.9 */
+
+                  if (rc != CACHE_SUCCESS || bdb_key_compare(&key, &key0, (int) key0.size, pcon->key_type)) {
+                     break;
+                  }
+               }
+            }
+            pcursor->close(pcursor);
          }
+         rc = CACHE_SUCCESS;
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      int prc, chunked;
+      unsigned int skey_len, chunk_size;
+      size_t size;
+      char skey[DBX_CHUNK_KEY_MAX + 1];
+      MDB_val key, keyx, key0, key2, data;
+      MDB_cursor *pcursor;
+
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key.mv_data = &(pmeth->key.args[0].num.int32);
+         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
+         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
       }
+      else { /* mumps */
+         for (n = 1; n < pmeth->jsargc; n ++) {
+            if (pmeth->key.args[n].sort == DBX_DSORT_GLOBAL) {
+               ref1 = n;
+               break;
+            }
+         }
+         if (pcon->global_dbs) { /* v1.3.15 source global is held in its own database */
+            rc = dbx_global_db(pmeth, pmeth->key.args[ref1].svalue.buf_addr, (int) pmeth->key.args[ref1].svalue.len_used, 0, &psgdb);
+         }
+         ref1_csize = pmeth->key.args[pmeth->jsargc - 1].csize - pmeth->key.args[ref1 - 1].csize;
+         ref2_csize = pmeth->key.args[ref1 - 1].csize;
+
+         key.mv_data = (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize);
+         key.mv_size = (size_t) ref1_csize;
+/*
+         printf("\r\nref2=%d; ref1=%d; key.mv_size=%d; ref1_csize=%d; ref2_csize=%d", ref2, ref1, (int) key.mv_size, ref1_csize, ref2_csize);
+         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
 */
-      rc = pcon->p_bdb_so->pdb->put(pcon->p_bdb_so->pdb, NULL, &key, &data, 0);
+         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize), (size_t) ref1_csize);
+         key0.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
+         key0.mv_size = (size_t) ref1_csize;
 
-      /* v1.3.12 */
-      /* pcon->p_bdb_so->pdb->sync(pcon->p_bdb_so->pdb, 0); */
+         memcpy((void *) ref2_fixed, (void *) pmeth->key.ibuffer.buf_addr, (size_t) ref2_csize);
+      }
 
-      /* v1.3.11 - a test to read back data to confirm that update worked */
+      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+      data.mv_size = (size_t)  pmeth->output_val.svalue.len_alloc;
 /*
-      {
-         int rc2, n;
-         DBT datar;
-         char *buffer, *p, *pr;
+     rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &pcursor);
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+      rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &key, &data, 0);
+*/
 
-         buffer = (char *) dbx_malloc((int) (data.size + 32), 0);
-         memset(&datar, 0, sizeof(DBT));
-         datar.flags = DB_DBT_USERMEM;
-         datar.data = (void *) buffer;
-         datar.ulen = data.size + 32;
-         rc2 = pcon->p_bdb_so->pdb->get(pcon->p_bdb_so->pdb, NULL, &key, &datar, 0);
-         if (rc2 != CACHE_SUCCESS) {
-            printf("\r\n set - bad return - rc=%d", rc);
-            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
-         }
-         if (data.size != datar.size) {
-            printf("\r\n set - bad value - wrong length (%d %d)", (int) data.size, (int) datar.size);
-            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
-         }
-         p = (char *) data.data;
-         pr = (char *) datar.data;
-         for (n = 0; n < (int) data.size; n ++) {
-            if (p[n] != pr[n]) {
-               printf("\r\n set - bad value - wrong value (%d %d)", (int) data.size, (int) datar.size);
-               dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
+      if (pcon->key_type == DBX_KEYTYPE_M) {
+         keyx = key;
+         for (;;) { /* v1.3.28 the copy is made again once a full map has been grown */
+            key = keyx;
+            data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+            data.mv_size = (size_t)  pmeth->output_val.svalue.len_alloc;
+            prc = CACHE_SUCCESS;
+            rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+            if (rc == MDB_MAP_RESIZED && lmdb_map_grow(pmeth, rc, 0) == CACHE_SUCCESS) {
+               continue;
+            }
+            if (rc != CACHE_SUCCESS) {
+               prc = rc;
                break;
             }
+            pcon->tlevel ++;
+            rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, psgdb ? psgdb->dbi : pcon->p_lmdb_so->db, &pcursor); /* v1.3.15 */
+            if (rc == CACHE_SUCCESS) {
+/*
+               printf("\r\npmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
+*/
+               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+/*
+               printf("\r\nrc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d; key0.size=%d;", rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize, (int) key0.mv_size);
+               dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+               if (rc == CACHE_SUCCESS && !lmdb_key_compare(&key, &key0, (int) key0.mv_size, pcon->key_type)) {
+/*
+               printf("\r\nrc=%d; key0.mv_size=%d; comp=%d", rc, key0.mv_size, lmdb_key_compare(&key, &key0, (int) key0.mv_size, pcon->key_type));
+*/
+                  for (;;) {
+/*
+                     dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+*/
+                     memcpy((void *) (ref2_fixed + ref2_csize), (void *) ((char *) key.mv_data + ref1_csize), (size_t) (key.mv_size - ref1_csize));
+/*
+                     dbx_dump_key((char *) ref2_fixed, (int) (ref2_csize + (key.mv_size - ref1_csize)));
+*/
+                     key2.mv_data = (void *) ref2_fixed;
+                     key2.mv_size = (size_t) (ref2_csize + (key.mv_size - ref1_csize));
+                     chunked = dbx_chunked((char *) data.mv_data, data.mv_size, &size, &chunk_size); /* v1.3.22 */
+                     if (chunked && key.mv_size > DBX_CHUNK_KEY_MAX) { /* no chunks are held for a key this long */
+                        chunked = 0;
+                     }
+                     skey_len = 0;
+                     if (chunked) {
+                        skey_len = (unsigned int) key.mv_size;
+                        memcpy((void *) skey, (void *) key.mv_data, (size_t) skey_len);
+                     }
+                     prc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key2, &data, 0);
+                     if (prc == CACHE_SUCCESS && chunked) { /* v1.3.22 the chunks go with the node */
+                        prc = lmdb_chunk_copy(pmeth, pcon->p_lmdb_so->ptxn, psgdb ? psgdb->dbi : pcon->p_lmdb_so->db, skey, skey_len, DBX_LMDB_DBI(pmeth), (char *) ref2_fixed, (unsigned int) key2.mv_size, size, chunk_size);
+                     }
+                     if (prc != CACHE_SUCCESS) {
+                        break;
+                     }
+
+                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+
+                     if (rc != CACHE_SUCCESS || lmdb_key_compare(&key, &key0, (int) key0.mv_size, pcon->key_type)) {
+                        break;
+                     }
+                  }
+               }
+               pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+            }
+            else {
+               prc = rc;
+            }
+            if (prc == CACHE_SUCCESS) {
+               prc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+            }
+            else {
+               pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+            }
+            pcon->tlevel --;
+
+            if (prc == MDB_MAP_FULL && lmdb_map_grow(pmeth, prc, 0) == CACHE_SUCCESS) {
+               continue;
+            }
+            break;
+         }
+         rc = prc;
+         if (rc != CACHE_SUCCESS) {
+            dbx_error_message(pmeth, rc, (char *) "dbx_merge");
          }
-         dbx_free((void *) buffer, 0);
       }
-*/
+   }
+
+dbx_merge_exit:
+
+   DBX_DB_UNLOCK(); /* v1.3.39 */
+
+   DBX_STATS_END(pmeth, DBX_STATS_MERGE, tstats, rc);
+   return rc;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_merge: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+
+}
+
+
+/* v1.3.25 Append a key/data pair to a list of records: <flags><key length><key><data length><data> */
+int dbx_record_add(DBXSTR *precs, char *key, unsigned int key_len, char *data, unsigned int data_len, int flags)
+{
+   unsigned int len;
+   char *p;
+
+   len = key_len + data_len + (2 * sizeof(unsigned int)) + sizeof(int); /* v1.3.27 flags */
+   if ((precs->len_used + len) > precs->len_alloc) {
+      if (!dbx_buffer_resize(&(precs->buf_addr), precs->len_used, (precs->len_alloc * 2) + len + 256, &(precs->len_alloc))) {
+         return CACHE_FAILURE;
+      }
+   }
+
+   p = precs->buf_addr + precs->len_used;
+   memcpy((void *) p, (void *) &flags, sizeof(int));
+   p += sizeof(int);
+   memcpy((void *) p, (void *) &key_len, sizeof(unsigned int));
+   p += sizeof(unsigned int);
+   memcpy((void *) p, (void *) key, (size_t) key_len);
+   p += key_len;
+   memcpy((void *) p, (void *) &data_len, sizeof(unsigned int));
+   p += sizeof(unsigned int);
+   memcpy((void *) p, (void *) data, (size_t) data_len);
+   precs->len_used += len;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v1.3.25 Read the record at *poffset in a list of records: returns 0 at the end of the list */
+int dbx_record_get(DBXSTR *precs, unsigned int *poffset, char **pkey, unsigned int *pkey_len, char **pdata, unsigned int *pdata_len, int *pflags)
+{
+   int flags;
+   char *p;
+
+   if ((*poffset + (2 * sizeof(unsigned int)) + sizeof(int)) > precs->len_used) {
+      return 0;
+   }
+
+   p = precs->buf_addr + *poffset;
+   memcpy((void *) &flags, (void *) p, sizeof(int));
+   p += sizeof(int);
+   if (pflags) {
+      *pflags = flags;
+   }
+   memcpy((void *) pkey_len, (void *) p, sizeof(unsigned int));
+   p += sizeof(unsigned int);
+   *pkey = p;
+   p += *pkey_len;
+   memcpy((void *) pdata_len, (void *) p, sizeof(unsigned int));
+   p += sizeof(unsigned int);
+   *pdata = p;
+   p += *pdata_len;
+   *poffset = (unsigned int) (p - precs->buf_addr);
+
+   return 1;
+}
 
-/*
-      if (rc == DB_KEYEXIST) {
-         printf("\r\nPut failed because key %d already exists", rc);
-      }
-*/
 
+/* v1.3.25 Write a list of records (the leaves of an object) in a single operation */
+int dbx_set_object(DBXMETH *pmeth, DBXSTR *precs)
+{
+   int rc, nindex, flags;
+   unsigned int offset, key_len, data_len;
+   size_t zlen;
+   char *pkey, *pdata, *zdata;
+   DBXCON *pcon = pmeth->pcon;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   DBX_DB_LOCK_TRACE(pmeth, 0); /* v1.3.25 the only lock taken by mglobal::set_object() */
+
+   zdata = NULL;
+   pmeth->update = 1;
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_set_object");
+      goto dbx_set_object_exit;
    }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      MDB_val key, data;
 
-      ndata = 1;
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.mv_data = (void *) &(pmeth->key.args[0].num.int32);
-         key.mv_size = (size_t) sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 2].csize;
-         ndata = pmeth->key.argc - 1;
+   nindex = 0;
+   if (pcon->pindex) { /* v1.3.26 */
+      nindex = dbx_index_open(pmeth);
+      if (nindex < 0) {
+         rc = CACHE_FAILURE;
+         dbx_error_message(pmeth, rc, (char *) "dbx_set_object");
+         goto dbx_set_object_exit;
       }
+   }
 
-      data.mv_data = (void *) pmeth->key.args[ndata].svalue.buf_addr;
-      data.mv_size = (size_t) pmeth->key.args[ndata].svalue.len_used;
+   offset = 0;
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT key, data;
 
-      rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
-      if (rc != 0) {
-         strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
-         dbx_error_message(pmeth, rc, (char *) "dbx_set");
-         goto dbx_set_exit;
+      /* the environment is not transactional (concurrent data store): the records are written under the connection lock */
+      while (rc == CACHE_SUCCESS && dbx_record_get(precs, &offset, &pkey, &key_len, &pdata, &data_len, &flags)) {
+         pmeth->typed = (flags & DBX_RECORD_TYPED) ? 1 : 0; /* v1.3.27 */
+         memset(&key, 0, sizeof(DBT));
+         memset(&data, 0, sizeof(DBT));
+         key.flags = DB_DBT_USERMEM;
+         data.flags = DB_DBT_USERMEM;
+         key.data = (void *) pkey;
+         key.size = (u_int32_t) key_len;
+         data.data = (void *) pdata;
+         data.size = (u_int32_t) data_len;
+         if (dbx_zpack(pmeth, pdata, (size_t) data_len, &zdata, &zlen)) {
+            data.data = (void *) zdata;
+            data.size = (u_int32_t) zlen;
+         }
+         if (nindex) { /* v1.3.26 */
+            rc = dbx_index_update(pmeth, pkey, key_len, pdata, data_len);
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = DBX_BDB_PDB(pmeth)->put(DBX_BDB_PDB(pmeth), NULL, &key, &data, 0);
+         }
+         if (zdata) {
+            dbx_free((void *) zdata, 0);
+            zdata = NULL;
+         }
       }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
 
-      rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &key, &data, 0);
-      pcon->tlevel ++;
+      for (;;) { /* v1.3.28 the whole subtree is written again once a full map has been grown */
+         rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+         if (rc == MDB_MAP_RESIZED && lmdb_map_grow(pmeth, rc, 0) == CACHE_SUCCESS) {
+            continue;
+         }
+         if (rc != 0) {
+            strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
+            dbx_error_message(pmeth, rc, (char *) "dbx_set_object");
+            goto dbx_set_object_exit;
+         }
+         pcon->tlevel ++;
 
-      pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
-      pcon->tlevel --;
+         offset = 0;
+         while (rc == CACHE_SUCCESS && dbx_record_get(precs, &offset, &pkey, &key_len, &pdata, &data_len, &flags)) {
+            pmeth->typed = (flags & DBX_RECORD_TYPED) ? 1 : 0; /* v1.3.27 */
+            key.mv_data = (void *) pkey;
+            key.mv_size = (size_t) key_len;
+            data.mv_data = (void *) pdata;
+            data.mv_size = (size_t) data_len;
+            if (dbx_zpack(pmeth, pdata, (size_t) data_len, &zdata, &zlen)) {
+               data.mv_data = (void *) zdata;
+               data.mv_size = zlen;
+            }
+            if (nindex) { /* v1.3.26 */
+               rc = dbx_index_update(pmeth, pkey, key_len, pdata, data_len);
+            }
+            if (rc == CACHE_SUCCESS) {
+               rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, &data, 0);
+            }
+            if (zdata) {
+               dbx_free((void *) zdata, 0);
+               zdata = NULL;
+            }
+         }
 
-      /* v1.3.11 */
-/*
-      if (pmeth->key.args[ndata].svalue.len_used == 0) {
-         if (!strncmp((char *) pmeth->key.args[1].svalue.buf_addr, (char *) "node", 4) || !strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
-            dbx_dump_mref(pcon, pmeth, (char *) "set", NULL, rc);
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+         }
+         else {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
          }
+         pcon->tlevel --;
+
+         if (rc == MDB_MAP_FULL && lmdb_map_grow(pmeth, rc, 0) == CACHE_SUCCESS) {
+            continue;
+         }
+         break;
       }
-*/
    }
 
-   if (rc == CACHE_SUCCESS) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
-   }
-   else {
-      dbx_error_message(pmeth, rc, (char *) "dbx_set");
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_set_object");
    }
 
-dbx_set_exit:
+dbx_set_object_exit:
 
    DBX_DB_UNLOCK();
 
@@ -6372,7 +12725,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_set: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_set_object: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -6385,9 +12738,12 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_defined(DBXMETH *pmeth)
+/* v1.3.25 Read the subtree under the node addressed as a list of records: the keys are returned relative to the node */
+int dbx_get_object(DBXMETH *pmeth, DBXSTR *precs, int *pcount)
 {
-   int rc, n;
+   int rc, flags;
+   unsigned int prefix_len;
+   char *prefix;
    DBXCON *pcon = pmeth->pcon;
 
 #ifdef _WIN32
@@ -6396,194 +12752,105 @@ __try {
 
    DBX_DB_LOCK(0);
 
+   *pcount = 0;
+   precs->len_used = 0;
    rc = dbx_global_reference(pmeth);
    if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_defined");
-      goto dbx_defined_exit;
+      dbx_error_message(pmeth, rc, (char *) "dbx_get_object");
+      goto dbx_get_object_exit;
+   }
+   if (pcon->global_dbs && !pmeth->pgdb) { /* global does not exist */
+      goto dbx_get_object_exit;
    }
 
-   n = 0;
+   prefix = pmeth->key.ibuffer.buf_addr;
+   prefix_len = pmeth->key.args[pmeth->key.argc - 1].csize;
+
    if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      DBT key, key0, data;
+      DBT key, data;
       DBC *pcursor;
 
+      dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) prefix, (size_t) prefix_len);
       memset(&key, 0, sizeof(DBT));
-      memset(&key0, 0, sizeof(DBT));
       memset(&data, 0, sizeof(DBT));
       key.flags = DB_DBT_USERMEM;
-      key0.flags = DB_DBT_USERMEM;
       data.flags = DB_DBT_USERMEM;
-
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.data = &(pmeth->key.args[0].num.int32);
-         key.size = sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         key.data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
-         key.ulen = (u_int32_t) pmeth->key.ibuffer.len_alloc;
-
-         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
-         key0.data = (void *) pmeth->output_key.svalue.buf_addr;
-         key0.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
-         key0.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
-      }
-
+      key.data = (void *) pmeth->output_key.svalue.buf_addr;
+      key.size = (u_int32_t) prefix_len;
+      key.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
       data.data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
-
-      rc = bdb_get(pcon, &key, &data, &(pmeth->output_val.svalue));
-      if (rc == CACHE_FAILURE) {
-         dbx_error_message(pmeth, rc, (char *) "dbx_defined");
-         goto dbx_defined_exit;
-      }
-
-      pmeth->output_val.svalue.len_used = data.size;
-
-      if (rc == DB_NOTFOUND) {
-         rc = CACHE_ERUNDEF;
-         n = 0;
-      }
-      else {
-         n = 1;
-      }
-
-      /* v1.3.11 */
-/*
-      if (pmeth->key.argc > 2) {
-         if (!strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9) && n == 0) {
-            if (n == 1 && data.size == 0) {
-               n = 0;
-               printf("\r\n *** must be undefined - no data !!!");
-            }
-            dbx_dump_mref(pcon, pmeth, (char *) "defined", NULL, n);
-         }
-      }
-*/
-
-      if (pcon->key_type == DBX_KEYTYPE_M) {
-         rc = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pcursor, 0);
-         if (rc == CACHE_SUCCESS) {
-/*
-            printf("\r\ndbx_defined: n=%d; key.ulen=%d; key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, (int) key.ulen, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-*/
-
-            rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_SET_RANGE); /* v1.3.9 */
-
-/*
-            printf("\r\ndbx_defined: DB_SET_RANGE: n=%d; rc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-            dbx_dump_key((char *) key.data, (int) key.size);
-*/
-            if (rc == CACHE_SUCCESS) {
-               if (n && key.size == pmeth->key.args[pmeth->key.argc - 1].csize && !bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) { /* current record defined, get next */
-                  rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_NEXT); /* v1.3.9 */
+      data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
 
-/*
-                  printf("\r\ndbx_defined: DB_NEXT: n=%d; rc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-                  dbx_dump_key((char *) key.data, (int) key.size);
-*/
-               }
-               if (rc == CACHE_SUCCESS && key.size > pmeth->key.args[pmeth->key.argc - 1].csize && !bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
-                  n += 10;
+      rc = DBX_BDB_PDB(pmeth)->cursor(DBX_BDB_PDB(pmeth), NULL, &pcursor, 0);
+      if (rc == CACHE_SUCCESS) {
+         rc = bdb_cursor_get(pcursor, &key, &(pmeth->output_key.svalue), &data, &(pmeth->output_val.svalue), DB_SET_RANGE);
+         while (rc == CACHE_SUCCESS && !dbx_key_under((char *) key.data, (unsigned int) key.size, prefix, prefix_len)) {
+            if (key.size > prefix_len) { /* a value held at the node itself is not part of the object */
+               pmeth->output_val.svalue.len_used = (unsigned int) data.size;
+               flags = (dbx_zunpack_inplace(&(pmeth->output_val.svalue)) == DBX_ZUNPACK_VERBATIM) ? 0 : DBX_RECORD_TYPED; /* v1.3.27 */
+               rc = dbx_record_add(precs, (char *) key.data + prefix_len, (unsigned int) key.size - prefix_len, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, flags);
+               if (rc != CACHE_SUCCESS) {
+                  break;
                }
+               (*pcount) ++;
+               data.data = (void *) pmeth->output_val.svalue.buf_addr;
+               data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
             }
-            pcursor->close(pcursor);
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->output_key.svalue), &data, &(pmeth->output_val.svalue), DB_NEXT);
+         }
+         pcursor->close(pcursor);
+         if (rc == DB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
          }
       }
-      rc = CACHE_SUCCESS;
    }
    else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      MDB_val key, key0, data;
+      MDB_val key, data;
+      MDB_txn *ptxn;
       MDB_cursor *pcursor;
 
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.mv_data = &(pmeth->key.args[0].num.int32);
-         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
-
-         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
-         key0.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
-         key0.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
-      }
-
-      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
-
-      rc = lmdb_start_ro_transaction(pmeth, 0);
-      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &key, &data);
-      pmeth->output_val.svalue.len_used = (unsigned int) data.mv_size;
-
-      if (rc == MDB_NOTFOUND) {
-         rc = CACHE_ERUNDEF;
-         n = 0;
-      }
-      else {
-         n = 1;
-      }
-
-      if (pcon->key_type == DBX_KEYTYPE_M) {
-         rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &pcursor);
-         if (rc == CACHE_SUCCESS) {
-/*
-            printf("\r\ndbx_defined: n=%d; key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-*/
-            rc =  pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+      key.mv_data = (void *) prefix;
+      key.mv_size = (size_t) prefix_len;
 
-/*
-            printf("\r\ndbx_defined: DB_SET_RANGE: n=%d; rc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-            if (rc == CACHE_SUCCESS) {
-               if (n && key.mv_size == pmeth->key.args[pmeth->key.argc - 1].csize && !lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) { /* current record defined, get next */
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
-/*
-                  printf("\r\ndbx_defined: DB_NEXT: n=%d; rc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", n, rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
+      lmdb_start_qro_transaction(pmeth, &ptxn, 0);
+      rc = pcon->p_lmdb_so->p_mdb_cursor_open(ptxn, DBX_LMDB_DBI(pmeth), &pcursor);
+      if (rc == CACHE_SUCCESS) {
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+         while (rc == CACHE_SUCCESS && !dbx_key_under((char *) key.mv_data, (unsigned int) key.mv_size, prefix, prefix_len)) {
+            if (key.mv_size > prefix_len) { /* a value held at the node itself is not part of the object */
+               if (lmdb_chunk_str(pmeth, ptxn, DBX_LMDB_DBI(pmeth), NULL, &key, &data, &(pmeth->output_val.svalue))) { /* v1.3.22 */
+                  rc = dbx_record_add(precs, (char *) key.mv_data + prefix_len, (unsigned int) key.mv_size - prefix_len, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, 0);
                }
-               if (rc == CACHE_SUCCESS && key.mv_size > pmeth->key.args[pmeth->key.argc - 1].csize && !lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
-                  n += 10;
+               else if (dbx_zpacked((char *) data.mv_data, data.mv_size)) {
+                  flags = (dbx_zunpack_str(&(pmeth->output_val.svalue), (char *) data.mv_data, data.mv_size) == DBX_ZUNPACK_VERBATIM) ? 0 : DBX_RECORD_TYPED; /* v1.3.27 */
+                  rc = dbx_record_add(precs, (char *) key.mv_data + prefix_len, (unsigned int) key.mv_size - prefix_len, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, flags);
+               }
+               else {
+                  rc = dbx_record_add(precs, (char *) key.mv_data + prefix_len, (unsigned int) key.mv_size - prefix_len, (char *) data.mv_data, (unsigned int) data.mv_size, DBX_RECORD_TYPED);
+               }
+               if (rc != CACHE_SUCCESS) {
+                  break;
                }
+               (*pcount) ++;
             }
-            pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+         }
+         pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+         if (rc == MDB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
          }
       }
-      rc = lmdb_commit_ro_transaction(pmeth, 0);
-      rc = CACHE_SUCCESS;
-   }
-
-   strcpy(pmeth->output_val.svalue.buf_addr, "0");
-   pmeth->output_val.svalue.len_used = 0;
-
-   if (rc == CACHE_SUCCESS || rc == CACHE_ERUNDEF) {
-      pmeth->output_val.num.int32 = n; /* v1.3.11 */
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &n, DBX_DTYPE_INT);
-      rc = CACHE_SUCCESS;
-   }
-   else {
-      dbx_error_message(pmeth, rc, (char *) "dbx_defined");
+      lmdb_commit_qro_transaction(pmeth, &ptxn, 0);
    }
 
-   /* v1.3.11 */
-/*
-   if (pmeth->key.argc > 2) {
-      if (!strncmp((char *) pmeth->key.args[3].svalue.buf_addr, (char *) "lastChild", 9)) {
-         dbx_dump_mref(pcon, pmeth, (char *) "defined", &(pmeth->output_val), rc);
+   if (rc != CACHE_SUCCESS) {
+      if (rc == CACHE_FAILURE) {
+         strcpy(pcon->error, "No Memory");
       }
+      dbx_error_message(pmeth, rc, (char *) "dbx_get_object");
    }
-*/
 
-dbx_defined_exit:
+dbx_get_object_exit:
 
    DBX_DB_UNLOCK();
 
@@ -6598,7 +12865,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_defined: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_get_object: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -6611,195 +12878,416 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
+/* v1.3.26 Secondary indexes: mark (and open the databases for) the indexes defined for the global addressed */
+/* returns the number of indexes to be maintained, or -1 on error: must be called outside a LMDB write transaction */
+int dbx_index_open(DBXMETH *pmeth)
+{
+   return dbx_index_open_ex(pmeth, pmeth->key.args[0].svalue.buf_addr, (int) pmeth->key.args[0].svalue.len_used);
+}
 
-int dbx_delete(DBXMETH *pmeth)
+
+int dbx_index_open_ex(DBXMETH *pmeth, char *global, int global_len)
 {
-   int rc, n;
+   int rc, nindex;
+   DBXINDEX *pidx;
    DBXCON *pcon = pmeth->pcon;
-   DBT key, key0, data;
-   DBC *pcursor;
 
-#ifdef _WIN32
-__try {
-#endif
+   nindex = 0;
+   for (pidx = pcon->pindex; pidx; pidx = pidx->pnext) {
+      pidx->active = 0;
+      if (pidx->global_len != global_len || memcmp((void *) pidx->global, (void *) global, (size_t) pidx->global_len)) {
+         continue;
+      }
+      pidx->pgdb = NULL;
+      if (pcon->global_dbs) {
+         rc = dbx_global_db(pmeth, pidx->index, pidx->index_len, 1, &(pidx->pgdb));
+         if (rc != CACHE_SUCCESS || !pidx->pgdb) {
+            return -1;
+         }
+      }
+      pidx->active = 1;
+      nindex ++;
+   }
 
-   DBX_DB_LOCK(0);
+   return nindex;
+}
 
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_delete");
-      goto dbx_delete_exit;
+
+/* v1.3.26 Compose the index key for a record in pidx->pikey: returns 0 if the record is not covered by the index */
+int dbx_index_key(DBXMETH *pmeth, DBXINDEX *pidx, char *key, unsigned int key_len, char *data, unsigned int data_len)
+{
+   int n, keyn, len;
+   char buffer[32];
+   DBXVAL keys[DBX_MAXARGS];
+   DBXKEY *pkey = pidx->pikey;
+   v8::Local<v8::String> str;
+   DBXCON *pcon = pmeth->pcon;
+
+   if (data_len == 0) { /* nodes without data are not indexed */
+      return 0;
    }
 
-   n = 0;
+   keyn = dbx_split_key(&keys[0], key, (int) key_len);
+   if ((keyn - 1) != pidx->keyn) {
+      return 0;
+   }
+   for (n = 0; n < pidx->keyn; n ++) {
+      if (pidx->kpath_len[n] < 0) {
+         continue;
+      }
+      if ((int) keys[n + 1].svalue.len_used != pidx->kpath_len[n] || memcmp((void *) keys[n + 1].svalue.buf_addr, (void *) (pidx->kpath + pidx->kpath_offs[n]), (size_t) pidx->kpath_len[n])) {
+         return 0;
+      }
+   }
+
+   /* typed values are indexed in text form so that numbers collate as numbers */
+   if (pcon->typed_values && pmeth->typed && (len = dbx_tvalue_format(data, (size_t) data_len, buffer)) >= 0) {
+      data = buffer;
+      data_len = (unsigned int) len;
+   }
+
+   pkey->ibuffer.len_used = 0;
+   pkey->argc = 0;
+   pkey->args[0].cvalue.pstr = 0;
+   pkey->args[0].type = DBX_DTYPE_STR;
+   dbx_ibuffer_add(pmeth, pkey, NULL, 0, str, pidx->index, pidx->index_len, 0);
+   pkey->args[1].cvalue.pstr = 0;
+   pkey->args[1].type = DBX_DTYPE_STR;
+   dbx_ibuffer_add(pmeth, pkey, NULL, 1, str, data, (int) data_len, 0);
+   for (n = 0; n < pidx->vpathn; n ++) {
+      pkey->args[n + 2].cvalue.pstr = 0;
+      pkey->args[n + 2].type = DBX_DTYPE_STR;
+      dbx_ibuffer_add(pmeth, pkey, NULL, n + 2, str, keys[pidx->vpath[n]].svalue.buf_addr, (int) keys[pidx->vpath[n]].svalue.len_used, 0);
+   }
+
+   return 1;
+}
+
+
+/* v1.3.26 Write (or remove) the index entry held in pidx->pikey: LMDB updates are made in the current write transaction */
+int dbx_index_put(DBXMETH *pmeth, DBXINDEX *pidx, short del)
+{
+   int rc;
+   DBXCON *pcon = pmeth->pcon;
+
+   rc = CACHE_SUCCESS;
    if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT key, data;
+      DB *pdb;
+
+      pdb = (pidx->pgdb ? pidx->pgdb->pdb : pcon->p_bdb_so->pdb);
       memset(&key, 0, sizeof(DBT));
-      memset(&key0, 0, sizeof(DBT));
       memset(&data, 0, sizeof(DBT));
       key.flags = DB_DBT_USERMEM;
-      key0.flags = DB_DBT_USERMEM;
       data.flags = DB_DBT_USERMEM;
-
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.data = &(pmeth->key.args[0].num.int32);
-         key.size = sizeof(pmeth->key.args[0].num.int32);
+      key.data = (void *) pidx->pikey->ibuffer.buf_addr;
+      key.size = (u_int32_t) pidx->pikey->ibuffer.len_used;
+      data.data = (void *) "";
+      data.size = 0;
+      if (del) {
+         rc = pdb->del(pdb, NULL, &key, 0);
+         if (rc == DB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
+         }
       }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
+      else {
+         rc = pdb->put(pdb, NULL, &key, &data, 0);
       }
-      else { /* mumps */
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, data;
+      MDB_dbi dbi;
+
+      dbi = (pidx->pgdb ? pidx->pgdb->dbi : pcon->p_lmdb_so->db);
+      key.mv_data = (void *) pidx->pikey->ibuffer.buf_addr;
+      key.mv_size = (size_t) pidx->pikey->ibuffer.len_used;
+      data.mv_data = (void *) "";
+      data.mv_size = 0;
+      if (del) {
+         rc = pcon->p_lmdb_so->p_mdb_del(pcon->p_lmdb_so->ptxn, dbi, &key, NULL);
+         if (rc == MDB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
+         }
+      }
+      else {
+         rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, dbi, &key, &data, 0);
+      }
+   }
 
-         key.data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
-         key.ulen = (u_int32_t) pmeth->key.ibuffer.len_alloc;
+   return rc;
+}
 
-         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
-         key0.data = (void *) pmeth->output_key.svalue.buf_addr;
-         key0.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 1].csize;
-         key0.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
+
+/* v1.3.26 Add (or remove) the entries for a record in each of the active indexes */
+int dbx_index_write(DBXMETH *pmeth, char *key, unsigned int key_len, char *data, unsigned int data_len, short del, int *pcount)
+{
+   int rc;
+   DBXINDEX *pidx;
+   DBXCON *pcon = pmeth->pcon;
+
+   rc = CACHE_SUCCESS;
+   for (pidx = pcon->pindex; pidx && rc == CACHE_SUCCESS; pidx = pidx->pnext) {
+      if (pidx->active && dbx_index_key(pmeth, pidx, key, key_len, data, data_len)) {
+         rc = dbx_index_put(pmeth, pidx, del);
+         if (pcount && rc == CACHE_SUCCESS) {
+            (*pcount) ++;
+         }
       }
+   }
 
-      data.data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
+   return rc;
+}
 
-      rc = pcon->p_bdb_so->pdb->del(pcon->p_bdb_so->pdb, NULL, &key, 0);
-      n = rc;
 
-      /* v1.3.11 */
-/*
-      if (pmeth->key.argc > 1) {
-         dbx_dump_mref(pcon, pmeth, (char *) "kill", NULL, rc);
+/* v1.3.26 Bring the indexes into step with a new value for a record: the entries for the current value are removed first */
+int dbx_index_update(DBXMETH *pmeth, char *key, unsigned int key_len, char *data, unsigned int data_len)
+{
+   int rc, exists;
+   short typed;
+   DBXSTR *pold = &(pmeth->output_key.svalue);
+   DBXCON *pcon = pmeth->pcon;
+
+   exists = 0;
+   rc = CACHE_SUCCESS;
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT dkey, ddata;
+
+      memset(&dkey, 0, sizeof(DBT));
+      memset(&ddata, 0, sizeof(DBT));
+      dkey.flags = DB_DBT_USERMEM;
+      ddata.flags = DB_DBT_USERMEM;
+      dkey.data = (void *) key;
+      dkey.size = (u_int32_t) key_len;
+      ddata.data = (void *) pold->buf_addr;
+      ddata.ulen = (u_int32_t) pold->len_alloc;
+      rc = DBX_BDB_PDB(pmeth)->get(DBX_BDB_PDB(pmeth), NULL, &dkey, &ddata, 0);
+      if (rc == DB_BUFFER_SMALL && dbx_buffer_resize(&(pold->buf_addr), 0, (unsigned int) ddata.size + 32, &(pold->len_alloc))) {
+         ddata.data = (void *) pold->buf_addr;
+         ddata.ulen = (u_int32_t) pold->len_alloc;
+         rc = DBX_BDB_PDB(pmeth)->get(DBX_BDB_PDB(pmeth), NULL, &dkey, &ddata, 0);
       }
-*/
+      if (rc == CACHE_SUCCESS) {
+         pold->len_used = (unsigned int) ddata.size;
+         exists = 1;
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val dkey, ddata;
 
-      if (pcon->key_type == DBX_KEYTYPE_M) {
-         rc = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pcursor, 0);
+      dkey.mv_data = (void *) key;
+      dkey.mv_size = (size_t) key_len;
+      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &dkey, &ddata);
+      if (rc == CACHE_SUCCESS) {
+         dbx_memcpy_exx(pold, (void *) ddata.mv_data, ddata.mv_size);
+         exists = 1;
+      }
+   }
 
-         if (rc == CACHE_SUCCESS) {
-/*
-            printf("\r\nkey.ulen=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", (int) key.ulen, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-*/
-            rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_SET_RANGE); /* v1.3.9 */
+   rc = CACHE_SUCCESS;
+   if (exists) {
+      typed = pmeth->typed; /* v1.3.27 the current value is a typed value unless it was escaped */
+      pmeth->typed = (dbx_zunpack_inplace(pold) == DBX_ZUNPACK_VERBATIM) ? 0 : 1;
+      if (pmeth->typed == typed && pold->len_used == data_len && !memcmp((void *) pold->buf_addr, (void *) data, (size_t) data_len)) {
+         return rc; /* unchanged */
+      }
+      rc = dbx_index_write(pmeth, key, key_len, pold->buf_addr, pold->len_used, 1, NULL);
+      pmeth->typed = typed;
+   }
+   if (rc == CACHE_SUCCESS) {
+      rc = dbx_index_write(pmeth, key, key_len, data, data_len, 0, NULL);
+   }
 
-            if (rc == DB_NOTFOUND) { /* v1.3.11 */
-               rc = CACHE_SUCCESS;
-               goto dbx_delete_exit;
-            }
+   return rc;
+}
 
-            if (rc != CACHE_SUCCESS) {
-               dbx_error_message(pmeth, rc, (char *) "dbx_delete");
-               goto dbx_delete_exit;
-            }
 
-/*
-            printf("\r\nrc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-            dbx_dump_key((char *) key.data, (int) key.size);
-*/
-            if (rc == CACHE_SUCCESS && !bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
-               for (;;) {
-                  /* dbx_dump_key((char *) key.data, (int) key.size); */
-                  /* v1.3.11  v1.3.12 */
-                  rc = pcon->p_bdb_so->pdb->del(pcon->p_bdb_so->pdb, NULL, &key, 0);
-                  /* rc = pcursor->del(pcursor, 0); */
-                  rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_NEXT); /* v1.3.9 */
-                  if (rc == DB_NOTFOUND) { /* v1.3.11 */
-                     rc = CACHE_SUCCESS;
-                     break;
-                  }
-                  if (rc != CACHE_SUCCESS) {
-                     dbx_error_message(pmeth, rc, (char *) "dbx_delete");
-                  }
-                  if (rc != CACHE_SUCCESS || bdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
-                     break;
-                  }
-               }
-            }
-            pcursor->close(pcursor);
-         }
-         rc = CACHE_SUCCESS;
-      }
+/* v1.3.26 Add (or remove) the index entries for all records under a prefix */
+/* records are read in batches so that no cursor is held open while the indexes are written */
+int dbx_index_apply(DBXMETH *pmeth, char *prefix, unsigned int prefix_len, short del, int *pcount)
+{
+   int rc, more, resume, flags;
+   short typed;
+   unsigned int offset, key_len, data_len;
+   char *pkey, *pdata;
+   DBXSTR recs, from;
+   DBXCON *pcon = pmeth->pcon;
 
-      /* v1.3.12 */
-      /* pcon->p_bdb_so->pdb->sync(pcon->p_bdb_so->pdb, 0); */
+   typed = pmeth->typed;
+   recs.buf_addr = NULL;
+   recs.len_alloc = 0;
+   recs.len_used = 0;
+   from.buf_addr = NULL;
+   from.len_alloc = 0;
+   from.len_used = 0;
+   rc = CACHE_SUCCESS;
 
+   if (!dbx_buffer_resize(&(from.buf_addr), 0, prefix_len + CACHE_MAXSTRLEN, &(from.len_alloc))) {
+      strcpy(pcon->error, "No Memory");
+      return CACHE_FAILURE;
    }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      MDB_val key, key0, data;
-      MDB_cursor *pcursor;
+   memcpy((void *) from.buf_addr, (void *) prefix, (size_t) prefix_len);
+   from.len_used = prefix_len;
 
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.mv_data = &(pmeth->key.args[0].num.int32);
-         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
+   more = 1;
+   resume = 0;
+   while (more && rc == CACHE_SUCCESS) {
+      more = 0;
+      recs.len_used = 0;
+
+      if (pcon->dbtype == DBX_DBTYPE_BDB) {
+         DBT key, data;
+         DBC *pcursor;
+
+         memset(&key, 0, sizeof(DBT));
+         memset(&data, 0, sizeof(DBT));
+         key.flags = DB_DBT_USERMEM;
+         data.flags = DB_DBT_USERMEM;
+         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) from.buf_addr, (size_t) from.len_used);
+         key.data = (void *) pmeth->output_key.svalue.buf_addr;
+         key.size = (u_int32_t) from.len_used;
+         key.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
+         data.data = (void *) pmeth->output_val.svalue.buf_addr;
+         data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+
+         rc = DBX_BDB_PDB(pmeth)->cursor(DBX_BDB_PDB(pmeth), NULL, &pcursor, 0);
+         if (rc != CACHE_SUCCESS) {
+            break;
+         }
+         rc = bdb_cursor_get(pcursor, &key, &(pmeth->output_key.svalue), &data, &(pmeth->output_val.svalue), DB_SET_RANGE);
+         if (rc == CACHE_SUCCESS && resume && key.size == from.len_used && !memcmp((void *) key.data, (void *) from.buf_addr, (size_t) from.len_used)) {
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->output_key.svalue), &data, &(pmeth->output_val.svalue), DB_NEXT); /* last record of the previous batch */
+         }
+         while (rc == CACHE_SUCCESS && !dbx_key_under((char *) key.data, (unsigned int) key.size, prefix, prefix_len)) {
+            pmeth->output_val.svalue.len_used = (unsigned int) data.size;
+            flags = (dbx_zunpack_inplace(&(pmeth->output_val.svalue)) == DBX_ZUNPACK_VERBATIM) ? 0 : DBX_RECORD_TYPED; /* v1.3.27 */
+            rc = dbx_record_add(&recs, (char *) key.data, (unsigned int) key.size, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, flags);
+            if (rc != CACHE_SUCCESS) {
+               strcpy(pcon->error, "No Memory");
+               break;
+            }
+            data.data = (void *) pmeth->output_val.svalue.buf_addr;
+            data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+            if (recs.len_used >= DBX_INDEX_BATCH) {
+               dbx_memcpy_ex(&from, (void *) key.data, (size_t) key.size);
+               more = 1;
+               resume = 1;
+               break;
+            }
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->output_key.svalue), &data, &(pmeth->output_val.svalue), DB_NEXT);
+         }
+         pcursor->close(pcursor);
+         if (rc == DB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
+         }
       }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         MDB_val key, data;
+         MDB_cursor *pcursor;
+
+         /* the current write transaction sees its own updates, so the whole range is read in one pass */
+         key.mv_data = (void *) from.buf_addr;
+         key.mv_size = (size_t) from.len_used;
+         rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &pcursor);
+         if (rc != CACHE_SUCCESS) {
+            break;
+         }
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+         while (rc == CACHE_SUCCESS && !dbx_key_under((char *) key.mv_data, (unsigned int) key.mv_size, prefix, prefix_len)) {
+            if (dbx_zpacked((char *) data.mv_data, data.mv_size)) {
+               flags = (dbx_zunpack_str(&(pmeth->output_val.svalue), (char *) data.mv_data, data.mv_size) == DBX_ZUNPACK_VERBATIM) ? 0 : DBX_RECORD_TYPED; /* v1.3.27 */
+               rc = dbx_record_add(&recs, (char *) key.mv_data, (unsigned int) key.mv_size, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, flags);
+            }
+            else {
+               rc = dbx_record_add(&recs, (char *) key.mv_data, (unsigned int) key.mv_size, (char *) data.mv_data, (unsigned int) data.mv_size, DBX_RECORD_TYPED);
+            }
+            if (rc != CACHE_SUCCESS) {
+               strcpy(pcon->error, "No Memory");
+               break;
+            }
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+         }
+         pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+         if (rc == MDB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
+         }
       }
-      else { /* mumps */
-         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
 
-         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) pmeth->key.ibuffer.buf_addr, (size_t) pmeth->key.args[pmeth->key.argc - 1].csize);
-         key0.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
-         key0.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 1].csize;
+      offset = 0;
+      while (rc == CACHE_SUCCESS && dbx_record_get(&recs, &offset, &pkey, &key_len, &pdata, &data_len, &flags)) {
+         pmeth->typed = (flags & DBX_RECORD_TYPED) ? 1 : 0; /* v1.3.27 */
+         rc = dbx_index_write(pmeth, pkey, key_len, pdata, data_len, del, pcount);
       }
+      pmeth->typed = typed;
+   }
 
-      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
+   if (recs.buf_addr) {
+      dbx_free((void *) recs.buf_addr, 0);
+   }
+   if (from.buf_addr) {
+      dbx_free((void *) from.buf_addr, 0);
+   }
 
-      rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
-      if (rc != 0) {
-         strcpy(pcon->error, "Cannot create or open a LMDB transaction for a delete operation");
-         dbx_error_message(pmeth, rc, (char *) "dbx_delete");
-         goto dbx_delete_exit;
-      }
-      pcon->tlevel ++;
+   return rc;
+}
 
-      rc = pcon->p_lmdb_so->p_mdb_del(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &key, NULL);
-      n = rc;
 
-      if (pcon->key_type == DBX_KEYTYPE_M) {
-         rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &pcursor);
+/* v1.3.26 Create the entries for the existing records of a global in each of its indexes */
+int dbx_index_build(DBXMETH *pmeth)
+{
+   int rc, nindex, count;
+   DBXCON *pcon = pmeth->pcon;
 
-         if (rc == CACHE_SUCCESS) {
-/*
-            printf("\r\npmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-*/
-            rc =  pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+#ifdef _WIN32
+__try {
+#endif
 
-/*
-            printf("\r\nrc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-            if (rc == CACHE_SUCCESS && !lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
-               for (;;) {
-                  /* dbx_dump_key((char *) key.data, (int) key.size); */
-                  rc = pcon->p_lmdb_so->p_mdb_del(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &key, NULL);
+   DBX_DB_LOCK(0);
 
-                  rc =  pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+   count = 0;
+   rc = dbx_global_reference(pmeth);
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_index_build");
+      goto dbx_index_build_exit;
+   }
+   if (pcon->global_dbs && !pmeth->pgdb) { /* global does not exist */
+      goto dbx_index_build_exit;
+   }
 
-                  if (rc != CACHE_SUCCESS || lmdb_key_compare(&key, &key0, (int) pmeth->key.args[pmeth->key.argc - 1].csize, pcon->key_type)) {
-                     break;
-                  }
-               }
-            }
-            pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
-         }
-         rc = CACHE_SUCCESS;
+   nindex = dbx_index_open(pmeth);
+   if (nindex < 0) {
+      rc = CACHE_FAILURE;
+      goto dbx_index_build_exit;
+   }
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      rc = dbx_index_apply(pmeth, pmeth->key.ibuffer.buf_addr, pmeth->key.args[0].csize, 0, &count);
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+      if (rc != 0) {
+         strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
+         goto dbx_index_build_exit;
+      }
+      pcon->tlevel ++;
+      rc = dbx_index_apply(pmeth, pmeth->key.ibuffer.buf_addr, pmeth->key.args[0].csize, 0, &count);
+      if (rc == CACHE_SUCCESS) {
+         rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+      }
+      else {
+         pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
       }
-      rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
       pcon->tlevel --;
    }
 
+dbx_index_build_exit:
+
    if (rc == CACHE_SUCCESS) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &n, DBX_DTYPE_INT);
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &count, DBX_DTYPE_INT);
    }
    else {
-      dbx_error_message(pmeth, rc, (char *) "dbx_delete");
+      dbx_error_message(pmeth, rc, (char *) "dbx_index_build");
    }
 
-dbx_delete_exit:
-
    DBX_DB_UNLOCK();
 
    return rc;
@@ -6813,7 +13301,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_delete: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_index_build: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -6826,38 +13314,440 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_next(DBXMETH *pmeth)
+/* v1.3.26 release a list of index definitions */
+int dbx_index_free(DBXINDEX *pidx)
+{
+   DBXINDEX *pidx_next;
+
+   while (pidx) {
+      pidx_next = pidx->pnext;
+      if (pidx->pikey) {
+         if (pidx->pikey->ibuffer.buf_addr) {
+            dbx_free((void *) pidx->pikey->ibuffer.buf_addr, DBX_MEMID_KEY);
+         }
+         dbx_free((void *) pidx->pikey, 0);
+      }
+      if (pidx->kpath) {
+         dbx_free((void *) pidx->kpath, 0);
+      }
+      dbx_free((void *) pidx, 0);
+      pidx = pidx_next;
+   }
+
+   return 0;
+}
+
+
+/* v1.3.27 Expiry index: ^%dbxttl(<deadline: 16 hex digits>,<key of the node>)="" */
+/* the node's key is the last subscript with 0x00 and 0x01 escaped as 0x01 0x01 and 0x01 0x02 */
+int dbx_ttl_key(DBXSTR *pkey, unsigned long long deadline, char *key, unsigned int key_len)
+{
+   unsigned int n, len;
+   unsigned char *p;
+
+   len = (unsigned int) strlen(DBX_TTL_GLOBAL) + 24 + (key_len * 2);
+   if (pkey->len_alloc < len && !dbx_buffer_resize(&(pkey->buf_addr), 0, len + 32, &(pkey->len_alloc))) {
+      return CACHE_FAILURE;
+   }
+
+   p = (unsigned char *) pkey->buf_addr;
+   *(p ++) = 0x00;
+   *(p ++) = 0x03;
+   memcpy((void *) p, (void *) DBX_TTL_GLOBAL, strlen(DBX_TTL_GLOBAL));
+   p += strlen(DBX_TTL_GLOBAL);
+   *(p ++) = 0x00;
+   *(p ++) = 0x03;
+   sprintf((char *) p, "%08X%08X", (unsigned int) (deadline >> 32), (unsigned int) (deadline & 0xffffffff));
+   p += 16;
+   *(p ++) = 0x00;
+   *(p ++) = 0x03;
+   for (n = 0; n < key_len; n ++) {
+      if (key[n] == 0x00 || key[n] == 0x01) {
+         *(p ++) = 0x01;
+         *(p ++) = (unsigned char) (key[n] + 1);
+      }
+      else {
+         *(p ++) = (unsigned char) key[n];
+      }
+   }
+   pkey->len_used = (unsigned int) (p - (unsigned char *) pkey->buf_addr);
+
+   return CACHE_SUCCESS;
+}
+
+
+/* Decode an entry in the expiry index: returns 0 if tkey is not an expiry index key */
+int dbx_ttl_node(char *tkey, unsigned int tkey_len, DBXSTR *pnode, unsigned long long *pdeadline)
+{
+   unsigned int n, offset;
+   char buffer[32];
+   unsigned char *p;
+
+   offset = (unsigned int) strlen(DBX_TTL_GLOBAL) + 4;
+   if (tkey_len < (offset + 18) || tkey[offset + 16] != 0x00 || tkey[offset + 17] != 0x03) {
+      return 0;
+   }
+   memcpy((void *) buffer, (void *) (tkey + offset), 16);
+   buffer[16] = '\0';
+   *pdeadline = (unsigned long long) strtoull(buffer, NULL, 16);
+
+   offset += 18;
+   if (pnode->len_alloc < (tkey_len - offset) && !dbx_buffer_resize(&(pnode->buf_addr), 0, (tkey_len - offset) + 32, &(pnode->len_alloc))) {
+      return 0;
+   }
+   p = (unsigned char *) pnode->buf_addr;
+   for (n = offset; n < tkey_len; n ++) {
+      if (tkey[n] == 0x01 && (n + 1) < tkey_len) {
+         n ++;
+         *(p ++) = (unsigned char) (tkey[n] - 1);
+      }
+      else {
+         *(p ++) = (unsigned char) tkey[n];
+      }
+   }
+   pnode->len_used = (unsigned int) (p - (unsigned char *) pnode->buf_addr);
+
+   return 1;
+}
+
+
+/* Add the expiry index entry for a node given a time to live: LMDB updates are made in the current write transaction */
+int dbx_ttl_put(DBXMETH *pmeth, DBXGDB *pgdb, DBXSTR *pwork, char *key, unsigned int key_len)
 {
    int rc;
    DBXCON *pcon = pmeth->pcon;
 
+   rc = dbx_ttl_key(pwork, pmeth->expiry, key, key_len);
+   if (rc != CACHE_SUCCESS) {
+      strcpy(pcon->error, "No Memory");
+      return rc;
+   }
+
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DBT tkey, tdata;
+      DB *pdb;
+
+      pdb = (pgdb ? pgdb->pdb : pcon->p_bdb_so->pdb);
+      memset(&tkey, 0, sizeof(DBT));
+      memset(&tdata, 0, sizeof(DBT));
+      tkey.flags = DB_DBT_USERMEM;
+      tdata.flags = DB_DBT_USERMEM;
+      tkey.data = (void *) pwork->buf_addr;
+      tkey.size = (u_int32_t) pwork->len_used;
+      tdata.data = (void *) "";
+      tdata.size = 0;
+      rc = pdb->put(pdb, NULL, &tkey, &tdata, 0);
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val tkey, tdata;
+
+      tkey.mv_data = (void *) pwork->buf_addr;
+      tkey.mv_size = (size_t) pwork->len_used;
+      tdata.mv_data = (void *) "";
+      tdata.mv_size = 0;
+      rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, (pgdb ? pgdb->dbi : pcon->p_lmdb_so->db), &tkey, &tdata, 0);
+   }
+
+   return rc;
+}
+
+
+/* Remove the nodes whose time to live has passed: the number removed is returned in output_val */
+/* due entries are read from the expiry index in batches and each batch is removed in a single transaction (LMDB) */
+int dbx_ttl_sweep(DBXMETH *pmeth)
+{
+   int rc, n, more, count, keyn, nindex, expired;
+   unsigned int offset, key_len, data_len, prefix_len;
+   unsigned long long now, deadline;
+   char *pkey, *pdata;
+   char prefix[32];
+   DBXSTR recs, node, value;
+   DBXGDB *pttlgdb;
+   DBXVAL keys[DBX_MAXARGS];
+   DBXCON *pcon = pmeth->pcon;
+
 #ifdef _WIN32
 __try {
 #endif
 
    DBX_DB_LOCK(0);
 
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_next");
-      goto dbx_next_exit;
+   count = 0;
+   rc = CACHE_SUCCESS;
+   memset((void *) &recs, 0, sizeof(DBXSTR));
+   memset((void *) &node, 0, sizeof(DBXSTR));
+   memset((void *) &value, 0, sizeof(DBXSTR));
+
+   if (pcon->key_type != DBX_KEYTYPE_M) {
+      goto dbx_ttl_sweep_exit;
    }
 
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      rc = bdb_next(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
+   pttlgdb = NULL;
+   if (pcon->global_dbs) {
+      rc = dbx_global_db(pmeth, (char *) DBX_TTL_GLOBAL, (int) strlen(DBX_TTL_GLOBAL), 0, &pttlgdb);
+      if (rc != CACHE_SUCCESS || !pttlgdb) { /* no node has been given a time to live */
+         goto dbx_ttl_sweep_exit;
+      }
    }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      rc = lmdb_next(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
+
+   /* the expiry index is ^%dbxttl(deadline, node): the prefix ends at a subscript boundary, as required by dbx_key_under() */
+   prefix[0] = 0x00;
+   prefix[1] = 0x03;
+   memcpy((void *) (prefix + 2), (void *) DBX_TTL_GLOBAL, strlen(DBX_TTL_GLOBAL));
+   prefix_len = (unsigned int) strlen(DBX_TTL_GLOBAL) + 2;
+
+   now = dbx_clock_ms();
+   more = 1;
+   while (more && rc == CACHE_SUCCESS) {
+      more = 0;
+      n = 0;
+      recs.len_used = 0;
+
+      /* the expiry index is ordered by deadline: collect the entries that are due */
+      if (pcon->dbtype == DBX_DBTYPE_BDB) {
+         DBT key, data;
+         DBC *pcursor;
+         DB *pdb;
+
+         pdb = (pttlgdb ? pttlgdb->pdb : pcon->p_bdb_so->pdb);
+         memset(&key, 0, sizeof(DBT));
+         memset(&data, 0, sizeof(DBT));
+         key.flags = DB_DBT_USERMEM;
+         data.flags = DB_DBT_USERMEM;
+         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) prefix, (size_t) prefix_len);
+         key.data = (void *) pmeth->output_key.svalue.buf_addr;
+         key.size = (u_int32_t) prefix_len;
+         key.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
+         data.data = (void *) pmeth->output_val.svalue.buf_addr;
+         data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
+
+         rc = pdb->cursor(pdb, NULL, &pcursor, 0);
+         if (rc != CACHE_SUCCESS) {
+            break;
+         }
+         rc = bdb_cursor_get(pcursor, &key, &(pmeth->output_key.svalue), &data, &(pmeth->output_val.svalue), DB_SET_RANGE);
+         while (rc == CACHE_SUCCESS && !dbx_key_under((char *) key.data, (unsigned int) key.size, prefix, prefix_len)) {
+            if (dbx_ttl_node((char *) key.data, (unsigned int) key.size, &node, &deadline) && deadline > now) {
+               break;
+            }
+            rc = dbx_record_add(&recs, (char *) key.data, (unsigned int) key.size, (char *) "", 0, 0);
+            if (rc != CACHE_SUCCESS) {
+               strcpy(pcon->error, "No Memory");
+               break;
+            }
+            if (++ n >= DBX_TTL_BATCH) {
+               more = 1;
+               break;
+            }
+            rc = bdb_cursor_get(pcursor, &key, &(pmeth->output_key.svalue), &data, &(pmeth->output_val.svalue), DB_NEXT);
+         }
+         pcursor->close(pcursor);
+         if (rc == DB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
+         }
+      }
+      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         MDB_val key, data;
+         MDB_txn *ptxn;
+         MDB_cursor *pcursor;
+
+         key.mv_data = (void *) prefix;
+         key.mv_size = (size_t) prefix_len;
+         rc = lmdb_start_qro_transaction(pmeth, &ptxn, 0);
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_open(ptxn, (pttlgdb ? pttlgdb->dbi : pcon->p_lmdb_so->db), &pcursor);
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+            while (rc == CACHE_SUCCESS && !dbx_key_under((char *) key.mv_data, (unsigned int) key.mv_size, prefix, prefix_len)) {
+               if (dbx_ttl_node((char *) key.mv_data, (unsigned int) key.mv_size, &node, &deadline) && deadline > now) {
+                  break;
+               }
+               rc = dbx_record_add(&recs, (char *) key.mv_data, (unsigned int) key.mv_size, (char *) "", 0, 0);
+               if (rc != CACHE_SUCCESS) {
+                  strcpy(pcon->error, "No Memory");
+                  break;
+               }
+               if (++ n >= DBX_TTL_BATCH) {
+                  more = 1;
+                  break;
+               }
+               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+            }
+            pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+         }
+         lmdb_commit_qro_transaction(pmeth, &ptxn, 0);
+         if (rc == MDB_NOTFOUND) {
+            rc = CACHE_SUCCESS;
+         }
+      }
+      if (rc != CACHE_SUCCESS || n == 0) {
+         break;
+      }
+
+      /* the databases for the nodes' globals (and their indexes) are opened before the write transaction starts */
+      offset = 0;
+      while (rc == CACHE_SUCCESS && dbx_record_get(&recs, &offset, &pkey, &key_len, &pdata, &data_len, NULL)) {
+         if (!dbx_ttl_node(pkey, key_len, &node, &deadline) || (keyn = dbx_split_key(&keys[0], node.buf_addr, (int) node.len_used)) < 1) {
+            continue;
+         }
+         if (pcon->global_dbs) {
+            rc = dbx_global_db(pmeth, keys[0].svalue.buf_addr, (int) keys[0].svalue.len_used, 0, &(pmeth->pgdb));
+         }
+         if (rc == CACHE_SUCCESS && pcon->pindex && dbx_index_open_ex(pmeth, keys[0].svalue.buf_addr, (int) keys[0].svalue.len_used) < 0) {
+            rc = CACHE_FAILURE;
+         }
+      }
+      if (rc != CACHE_SUCCESS) {
+         break;
+      }
+
+      if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
+         if (rc != 0) {
+            strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
+            break;
+         }
+         pcon->tlevel ++;
+      }
+
+      offset = 0;
+      while (rc == CACHE_SUCCESS && dbx_record_get(&recs, &offset, &pkey, &key_len, &pdata, &data_len, NULL)) {
+         keyn = 0;
+         nindex = 0;
+         expired = 0;
+         pmeth->pgdb = NULL;
+         if (dbx_ttl_node(pkey, key_len, &node, &deadline)) {
+            keyn = dbx_split_key(&keys[0], node.buf_addr, (int) node.len_used);
+         }
+         if (keyn > 0) {
+            if (pcon->global_dbs) {
+               dbx_global_db(pmeth, keys[0].svalue.buf_addr, (int) keys[0].svalue.len_used, 0, &(pmeth->pgdb));
+            }
+            if (pcon->pindex) {
+               nindex = dbx_index_open_ex(pmeth, keys[0].svalue.buf_addr, (int) keys[0].svalue.len_used);
+            }
+         }
+
+         /* the node is only removed if it has not been given a new value (or deadline) since the entry was made */
+         if (pcon->dbtype == DBX_DBTYPE_BDB) {
+            DBT key, data;
+            DB *pdb;
+
+            memset(&key, 0, sizeof(DBT));
+            memset(&data, 0, sizeof(DBT));
+            key.flags = DB_DBT_USERMEM;
+            data.flags = DB_DBT_USERMEM;
+            if (keyn > 0 && (pmeth->pgdb || !pcon->global_dbs)) {
+               if (!value.buf_addr && !dbx_buffer_resize(&(value.buf_addr), 0, CACHE_MAXSTRLEN, &(value.len_alloc))) {
+                  rc = CACHE_FAILURE;
+                  strcpy(pcon->error, "No Memory");
+                  break;
+               }
+               key.data = (void *) node.buf_addr;
+               key.size = (u_int32_t) node.len_used;
+               data.data = (void *) value.buf_addr;
+               data.ulen = (u_int32_t) value.len_alloc;
+               if (bdb_get(pmeth, &key, &data, &value) == CACHE_SUCCESS) {
+                  value.len_used = (unsigned int) data.size;
+                  expired = dbx_expired(value.buf_addr, (size_t) value.len_used);
+               }
+            }
+            if (expired) {
+               if (nindex > 0) {
+                  pmeth->typed = (dbx_zunpack_inplace(&value) == DBX_ZUNPACK_VERBATIM) ? 0 : 1; /* v1.3.27 */
+                  rc = dbx_index_write(pmeth, node.buf_addr, node.len_used, value.buf_addr, value.len_used, 1, NULL);
+               }
+               if (rc == CACHE_SUCCESS) {
+                  rc = DBX_BDB_PDB(pmeth)->del(DBX_BDB_PDB(pmeth), NULL, &key, 0);
+                  if (rc == CACHE_SUCCESS) {
+                     count ++;
+                  }
+                  else if (rc == DB_NOTFOUND) {
+                     rc = CACHE_SUCCESS;
+                  }
+               }
+            }
+            if (rc == CACHE_SUCCESS) {
+               pdb = (pttlgdb ? pttlgdb->pdb : pcon->p_bdb_so->pdb);
+               key.data = (void *) pkey;
+               key.size = (u_int32_t) key_len;
+               rc = pdb->del(pdb, NULL, &key, 0);
+               if (rc == DB_NOTFOUND) {
+                  rc = CACHE_SUCCESS;
+               }
+            }
+         }
+         else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+            MDB_val key, data;
+
+            key.mv_data = (void *) node.buf_addr;
+            key.mv_size = (size_t) node.len_used;
+            if (keyn > 0 && (pmeth->pgdb || !pcon->global_dbs)) {
+               if (pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, &data) == CACHE_SUCCESS) {
+                  expired = dbx_expired((char *) data.mv_data, data.mv_size);
+                  if (expired && nindex > 0) {
+                     pmeth->typed = (dbx_zunpack_str(&value, (char *) data.mv_data, data.mv_size) == DBX_ZUNPACK_VERBATIM) ? 0 : 1; /* v1.3.27 */
+                  }
+               }
+            }
+            if (expired) {
+               if (nindex > 0) {
+                  rc = dbx_index_write(pmeth, node.buf_addr, node.len_used, value.buf_addr, value.len_used, 1, NULL);
+               }
+               if (rc == CACHE_SUCCESS) {
+                  rc = pcon->p_lmdb_so->p_mdb_del(pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), &key, NULL);
+                  if (rc == CACHE_SUCCESS) {
+                     count ++;
+                     rc = lmdb_chunk_drop(pmeth, pcon->p_lmdb_so->ptxn, DBX_LMDB_DBI(pmeth), node.buf_addr, node.len_used, 0); /* v1.3.22 chunks left by a set() */
+                  }
+                  else if (rc == MDB_NOTFOUND) {
+                     rc = CACHE_SUCCESS;
+                  }
+               }
+            }
+            if (rc == CACHE_SUCCESS) {
+               key.mv_data = (void *) pkey;
+               key.mv_size = (size_t) key_len;
+               rc = pcon->p_lmdb_so->p_mdb_del(pcon->p_lmdb_so->ptxn, (pttlgdb ? pttlgdb->dbi : pcon->p_lmdb_so->db), &key, NULL);
+               if (rc == MDB_NOTFOUND) {
+                  rc = CACHE_SUCCESS;
+               }
+            }
+         }
+      }
+      pmeth->pgdb = NULL;
+
+      if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
+         }
+         else {
+            pcon->p_lmdb_so->p_mdb_txn_abort(pcon->p_lmdb_so->ptxn);
+         }
+         pcon->tlevel --;
+      }
    }
 
-   if (rc == YDB_NODE_END) {
-      rc = CACHE_SUCCESS;
+dbx_ttl_sweep_exit:
+
+   pmeth->pgdb = NULL;
+   if (recs.buf_addr) {
+      dbx_free((void *) recs.buf_addr, 0);
    }
-   else if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_next");
+   if (node.buf_addr) {
+      dbx_free((void *) node.buf_addr, 0);
+   }
+   if (value.buf_addr) {
+      dbx_free((void *) value.buf_addr, 0);
    }
 
-dbx_next_exit:
+   if (rc == CACHE_SUCCESS) {
+      dbx_create_string(&(pmeth->output_val.svalue), (void *) &count, DBX_DTYPE_INT);
+   }
+   else {
+      dbx_error_message(pmeth, rc, (char *) "dbx_ttl_sweep");
+   }
 
    DBX_DB_UNLOCK();
 
@@ -6872,7 +13762,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_next: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_ttl_sweep: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -6885,69 +13775,99 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_previous(DBXMETH *pmeth)
+/* Start a background thread for a connection: the database lock must be held (or the connection not yet shared) */
+int dbx_timer_start(DBXCON *pcon, DBXTIMER *ptimer, DBXTHREADFUN p_thread)
 {
    int rc;
-   DBXCON *pcon = pmeth->pcon;
 
-#ifdef _WIN32
-__try {
-#endif
+   if (ptimer->running || ptimer->interval < 1 || !pcon->use_mutex) {
+      return 0;
+   }
+   ptimer->stop = 0;
 
-   DBX_DB_LOCK(0);
+#if defined(_WIN32)
+   ptimer->hthread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) p_thread, (LPVOID) pcon, 0, NULL);
+   rc = (ptimer->hthread ? 0 : -1);
+#else
+   {
+      pthread_attr_t attr;
 
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_previous");
-      goto dbx_previous_exit;
+      pthread_attr_init(&attr);
+      pthread_attr_setstacksize(&attr, DBX_THREAD_STACK_SIZE);
+      rc = pthread_create(&(ptimer->thread), &attr, p_thread, (void *) pcon);
+      pthread_attr_destroy(&attr);
    }
+#endif
 
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      rc = bdb_previous(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      rc = lmdb_previous(pmeth, &(pmeth->key), &(pmeth->output_val), &(pmeth->output_key), 0);
+   if (rc) {
+      return 0;
    }
+   ptimer->running = 1;
 
-   if (rc == YDB_NODE_END) {
-      rc = CACHE_SUCCESS;
-   }
-   else if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_previous");
-   }
+   return 1;
+}
 
-dbx_previous_exit:
 
-   DBX_DB_UNLOCK();
+/* Stop a background thread: the database lock must not be held */
+int dbx_timer_stop(DBXTIMER *ptimer)
+{
+   if (!ptimer->running) {
+      return 0;
+   }
+   ptimer->stop = 1;
 
-   return rc;
+#if defined(_WIN32)
+   WaitForSingleObject(ptimer->hthread, INFINITE);
+   CloseHandle(ptimer->hthread);
+   ptimer->hthread = NULL;
+#else
+   pthread_join(ptimer->thread, NULL);
+#endif
 
-#ifdef _WIN32
+   ptimer->running = 0;
+
+   return 1;
 }
-__except (EXCEPTION_EXECUTE_HANDLER) {
 
-   DWORD code;
-   char bufferx[256];
 
-   __try {
-      code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_previous: %x", code);
-      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE dbx_ttl_thread(LPVOID pargs)
+#else
+void * dbx_ttl_thread(void *pargs)
+#endif
+{
+   unsigned long elapsed;
+   DBXMETH *pmeth;
+   DBXCON *pcon;
+
+   pcon = (DBXCON *) pargs;
+   pmeth = dbx_request_memory(pcon, 0);
+
+   elapsed = 0;
+   while (pmeth && !pcon->ttl.stop) {
+      dbx_sleep(DBX_TTL_TICK);
+      elapsed += DBX_TTL_TICK;
+      if (elapsed >= ((unsigned long) pcon->ttl.interval * 1000)) {
+         elapsed = 0;
+         dbx_ttl_sweep(pmeth);
+      }
    }
-   __except (EXCEPTION_EXECUTE_HANDLER) {
-      ;
+   if (pmeth) {
+      dbx_request_memory_free(pcon, pmeth, 0);
    }
 
-   return CACHE_FAILURE;
-}
+#if defined(_WIN32)
+   return 0;
+#else
+   return NULL;
 #endif
 }
 
 
-int dbx_increment(DBXMETH *pmeth)
+/* v1.3.29 Flush committed updates to disk: for databases opened with relaxed durability (sync property) */
+int dbx_sync(DBXMETH *pmeth)
 {
-   int rc;
-   double value;
+   int rc, n;
    DBXCON *pcon = pmeth->pcon;
 
 #ifdef _WIN32
@@ -6956,126 +13876,32 @@ __try {
 
    DBX_DB_LOCK(0);
 
-   pmeth->increment = 1;
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_increment");
-      goto dbx_increment_exit;
-   }
-
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      DBT key, data;
-
-      memset(&key, 0, sizeof(DBT));
-      memset(&data, 0, sizeof(DBT));
-      key.flags = DB_DBT_USERMEM;
-      data.flags = DB_DBT_USERMEM;
-
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.data = &(pmeth->key.args[0].num.int32);
-         key.size = sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         key.data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[pmeth->key.argc - 2].csize;
-      }
-
-      data.data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
-      data.size = 0;
-
-      rc = bdb_get(pcon, &key, &data, &(pmeth->output_val.svalue));
-      if (rc == CACHE_FAILURE) {
-         dbx_error_message(pmeth, rc, (char *) "dbx_increment");
-         goto dbx_increment_exit;
-      }
-
-      pmeth->output_val.svalue.len_used = data.size;
-      pmeth->output_val.svalue.buf_addr[data.size] = '\0';
-
-      value = (double) strtod(pmeth->output_val.svalue.buf_addr, NULL);
-      value += pmeth->key.args[pmeth->key.argc - 1].num.real;
-      sprintf(pmeth->output_val.svalue.buf_addr, "%g", value);
-      pmeth->output_val.svalue.len_used = (unsigned int) strlen(pmeth->output_val.svalue.buf_addr);
-
-      data.data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.size = (u_int32_t) pmeth->output_val.svalue.len_used;
-      data.ulen = (u_int32_t) pmeth->output_val.svalue.len_alloc;
-      rc = pcon->p_bdb_so->pdb->put(pcon->p_bdb_so->pdb, NULL, &key, &data, 0);
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      MDB_val key, data;
-
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.mv_data = &(pmeth->key.args[0].num.int32);
-         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         key.mv_data = (void *) pmeth->key.ibuffer.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[pmeth->key.argc - 2].csize;
+   rc = CACHE_SUCCESS;
+   if (pcon->dbtype == DBX_DBTYPE_BDB && pcon->p_bdb_so) {
+      if (pcon->p_bdb_so->pdb) {
+         rc = pcon->p_bdb_so->pdb->sync(pcon->p_bdb_so->pdb, 0);
       }
-
-      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.mv_size = (size_t)  pmeth->output_val.svalue.len_alloc;
-
-      strcpy(pmeth->output_val.svalue.buf_addr, "");
-      pmeth->output_val.svalue.len_alloc = 0;
-
-      rc = lmdb_start_ro_transaction(pmeth, 0); /* v1.2.8 */
-      rc = pcon->p_lmdb_so->p_mdb_get(pcon->p_lmdb_so->ptxnro, pcon->p_lmdb_so->db, &key, &data);
-      lmdb_commit_ro_transaction(pmeth, 0); /* v1.2.8 */
-
-      if (rc == CACHE_SUCCESS) { /* v1.2.8 */
-         if (pmeth->output_val.svalue.len_alloc < data.mv_size) { /* v1.3.9 */
-            if (!dbx_buffer_resize(&(pmeth->output_val.svalue.buf_addr), 0, (unsigned int) data.mv_size + 32, &(pmeth->output_val.svalue.len_alloc))) {
-               rc = CACHE_FAILURE;
-               dbx_error_message(pmeth, rc, (char *) "dbx_increment");
-               goto dbx_increment_exit;
-            }
+      for (n = 0; rc == CACHE_SUCCESS && pcon->p_bdb_so->p_gdb && n < pcon->p_bdb_so->gdb_count; n ++) {
+         if (pcon->p_bdb_so->p_gdb[n].open && pcon->p_bdb_so->p_gdb[n].pdb) {
+            rc = pcon->p_bdb_so->p_gdb[n].pdb->sync(pcon->p_bdb_so->p_gdb[n].pdb, 0);
          }
-         dbx_memcpy_exx(&(pmeth->output_val.svalue), (void *) data.mv_data, data.mv_size);
-         pmeth->output_val.svalue.len_used = (unsigned int) data.mv_size;
-         pmeth->output_val.svalue.buf_addr[data.mv_size] = '\0';
       }
-
-      value = (double) strtod(pmeth->output_val.svalue.buf_addr, NULL);
-      value += pmeth->key.args[pmeth->key.argc - 1].num.real;
-      sprintf(pmeth->output_val.svalue.buf_addr, "%g", value);
-      pmeth->output_val.svalue.len_used = (unsigned int) strlen(pmeth->output_val.svalue.buf_addr);
-
-      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.mv_size = (size_t) pmeth->output_val.svalue.len_used;
-
-      /* v1.2.8 */
-      rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
-      if (rc != 0) {
-         strcpy(pcon->error, "Cannot create or open a LMDB transaction for an update operation");
-         dbx_error_message(pmeth, rc, (char *) "dbx_increment");
-         goto dbx_increment_exit;
+      if (rc == CACHE_SUCCESS && pcon->bdb.txn && pcon->p_bdb_so->penv) { /* v1.3.30 */
+         rc = pcon->p_bdb_so->penv->txn_checkpoint(pcon->p_bdb_so->penv, 0, 0, 0);
       }
-      rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &key, &data, 0);
-      pcon->tlevel ++;
-
-      pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
-      pcon->tlevel --;
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB && pcon->p_lmdb_so && pcon->p_lmdb_so->penv) {
+      rc = pcon->p_lmdb_so->p_mdb_env_sync(pcon->p_lmdb_so->penv, 1);
    }
 
    if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_increment");
+      dbx_error_message(pmeth, rc, (char *) "dbx_sync");
    }
 
-dbx_increment_exit:
-
    DBX_DB_UNLOCK();
 
+   dbx_create_string(&(pmeth->output_val.svalue), (void *) &rc, DBX_DTYPE_INT);
+
    return rc;
 
 #ifdef _WIN32
@@ -7087,7 +13913,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_increment: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_sync: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -7100,390 +13926,608 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_lock(DBXMETH *pmeth)
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE dbx_sync_thread(LPVOID pargs)
+#else
+void * dbx_sync_thread(void *pargs)
+#endif
 {
-   int rc, retval, timeout;
-   unsigned long long timeout_nsec;
-   char buffer[32];
-   DBXCON *pcon = pmeth->pcon;
+   unsigned long elapsed;
+   DBXMETH *pmeth;
+   DBXCON *pcon;
 
-#ifdef _WIN32
-__try {
+   pcon = (DBXCON *) pargs;
+   pmeth = dbx_request_memory(pcon, 0);
+
+   elapsed = 0;
+   while (pmeth && !pcon->flush.stop) {
+      dbx_sleep(DBX_TTL_TICK);
+      elapsed += DBX_TTL_TICK;
+      if (elapsed >= ((unsigned long) pcon->flush.interval * 1000)) {
+         elapsed = 0;
+         dbx_sync(pmeth);
+      }
+   }
+   if (pmeth) {
+      dbx_request_memory_free(pcon, pmeth, 0);
+   }
+
+#if defined(_WIN32)
+   return 0;
+#else
+   return NULL;
 #endif
+}
 
-   DBX_DB_LOCK(0);
 
-   pmeth->lock = 1;
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_lock");
-      goto dbx_lock_exit;
+/* v1.3.31 Run a benchmark workload natively (db.benchmark()): the result is returned as a JSON document */
+int dbx_benchmark(DBXMETH *pmeth)
+{
+   int rc, n, total, errors, not_found;
+   unsigned long long start, elapsed;
+   double seconds, sum;
+   char *op;
+   DBXBENCH *pbench;
+   DBXBENCHTHR *pthr;
+   DBXCON *pcon = pmeth->pcon;
+
+   pbench = pmeth->pbench;
+   pmeth->pbench = NULL;
+   if (!pbench) {
+      strcpy(pcon->error, "No benchmark has been specified");
+      return CACHE_FAILURE;
    }
 
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      timeout = -1;
-      if (pmeth->key.args[pmeth->key.argc - 1].svalue.len_used < 16) {
-         strncpy(buffer, pmeth->key.args[pmeth->key.argc - 1].svalue.buf_addr, pmeth->key.args[pmeth->key.argc - 1].svalue.len_used);
-         buffer[pmeth->key.args[pmeth->key.argc - 1].svalue.len_used] = '\0';
-         timeout = (int) strtol(buffer, NULL, 10);
-      }
-      timeout_nsec = 1000000000;
+   rc = CACHE_SUCCESS;
+   pthr = NULL;
+   pbench->pcon = pcon;
+   total = pbench->threads * pbench->count;
+   pbench->latency = (unsigned int *) dbx_malloc(sizeof(unsigned int) * (total + 1), DBX_MEMID_BENCH);
+   pbench->value = (char *) dbx_malloc(sizeof(char) * (pbench->value_size + 1), DBX_MEMID_BENCH);
+   pthr = (DBXBENCHTHR *) dbx_malloc(sizeof(DBXBENCHTHR) * pbench->threads, DBX_MEMID_BENCH);
+   if (!pbench->latency || !pbench->value || !pthr) {
+      strcpy(pcon->error, "No Memory");
+      rc = CACHE_NOCON;
+      goto dbx_benchmark_exit;
+   }
+   memset((void *) pbench->value, 'x', (size_t) pbench->value_size);
+   pbench->value[pbench->value_size] = '\0';
 
-      if (timeout < 0)
-         timeout_nsec *= 3600;
-      else
-         timeout_nsec *= timeout;
-      rc = YDB_OK;
-      if (rc == YDB_OK) {
-         retval = 1;
-         rc = YDB_OK;
+   for (n = 0; n < pbench->threads; n ++) {
+      pthr[n].tn = n;
+      pthr[n].errors = 0;
+      pthr[n].not_found = 0;
+      pthr[n].created = 0;
+      pthr[n].pbench = pbench;
+   }
+
+   start = dbx_clock_ns();
+
+   /* the first part of the workload runs in this thread */
+   for (n = 1; n < pbench->threads; n ++) {
+#if defined(_WIN32)
+      pthr[n].hthread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) dbx_bench_thread, (LPVOID) &(pthr[n]), 0, NULL);
+      pthr[n].created = (pthr[n].hthread ? 1 : 0);
+#else
+      {
+         pthread_attr_t attr;
+
+         pthread_attr_init(&attr);
+         pthread_attr_setstacksize(&attr, DBX_THREAD_STACK_SIZE);
+         pthr[n].created = (pthread_create(&(pthr[n].thread), &attr, dbx_bench_thread, (void *) &(pthr[n])) ? 0 : 1);
+         pthread_attr_destroy(&attr);
       }
-      else if (rc == YDB_LOCK_TIMEOUT) {
-         retval = 0;
-         rc = YDB_OK;
+#endif
+   }
+   dbx_bench_thread((void *) &(pthr[0]));
+   for (n = 1; n < pbench->threads; n ++) {
+      if (pthr[n].created) {
+#if defined(_WIN32)
+         WaitForSingleObject(pthr[n].hthread, INFINITE);
+         CloseHandle(pthr[n].hthread);
+#else
+         pthread_join(pthr[n].thread, NULL);
+#endif
       }
-      else {
-         retval = 0;
-         rc = CACHE_FAILURE;
+      else { /* the thread could not be started */
+         dbx_bench_thread((void *) &(pthr[n]));
       }
    }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      timeout = -1;
-      if (pmeth->key.args[pmeth->key.argc - 1].svalue.len_used < 16) {
-         strncpy(buffer, pmeth->key.args[pmeth->key.argc - 1].svalue.buf_addr, pmeth->key.args[pmeth->key.argc - 1].svalue.len_used);
-         buffer[pmeth->key.args[pmeth->key.argc - 1].svalue.len_used] = '\0';
-         timeout = (int) strtol(buffer, NULL, 10);
-      }
-      timeout_nsec = 1000000000;
 
-      if (timeout < 0)
-         timeout_nsec *= 3600;
-      else
-         timeout_nsec *= timeout;
-      rc = YDB_OK;
-      if (rc == YDB_OK) {
-         retval = 1;
-         rc = YDB_OK;
-      }
-      else if (rc == YDB_LOCK_TIMEOUT) {
-         retval = 0;
-         rc = YDB_OK;
-      }
-      else {
-         retval = 0;
-         rc = CACHE_FAILURE;
+   elapsed = dbx_clock_ns() - start;
+
+   errors = 0;
+   not_found = 0;
+   for (n = 0; n < pbench->threads; n ++) {
+      errors += pthr[n].errors;
+      not_found += pthr[n].not_found;
+   }
+
+   qsort((void *) pbench->latency, (size_t) total, sizeof(unsigned int), dbx_bench_compare);
+   sum = 0;
+   for (n = 0; n < total; n ++) {
+      sum += (double) pbench->latency[n];
+   }
+   seconds = (double) elapsed / 1000000000.0;
+
+   switch (pbench->op) {
+      case DBX_BENCH_SET:
+         op = (char *) "set";
+         break;
+      case DBX_BENCH_NEXT:
+         op = (char *) "next";
+         break;
+      case DBX_BENCH_QUERY:
+         op = (char *) "query";
+         break;
+      case DBX_BENCH_INCREMENT:
+         op = (char *) "increment";
+         break;
+      default:
+         op = (char *) "get";
+         break;
+   }
+
+   /* latency percentiles (us) are taken from the sorted latencies of all threads */
+   sprintf((char *) pmeth->output_val.svalue.buf_addr,
+      "{\"op\":\"%s\",\"order\":\"%s\",\"key_type\":\"%s\",\"subscripts\":%d,\"value_size\":%d,\"keys\":%d,\"threads\":%d,\"operations\":%d,\"errors\":%d,\"not_found\":%d,\"seconds\":%.6f,\"ops_per_sec\":%.1f,"
+      "\"latency_us\":{\"min\":%.3f,\"mean\":%.3f,\"p50\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f}}",
+      op, pbench->random ? "random" : "sequential", pcon->key_type == DBX_KEYTYPE_M ? "m" : (pcon->key_type == DBX_KEYTYPE_INT ? "int" : "str"),
+      pcon->key_type == DBX_KEYTYPE_M ? pbench->subscripts : 1, pbench->value_size, pbench->keys, pbench->threads, total, errors, not_found,
+      seconds, seconds > 0 ? ((double) total / seconds) : 0,
+      (double) pbench->latency[0] / 1000.0, (sum / (double) total) / 1000.0,
+      (double) pbench->latency[(int) ((double) total * 0.5)] / 1000.0,
+      (double) pbench->latency[(int) ((double) total * 0.99)] / 1000.0,
+      (double) pbench->latency[(int) ((double) total * 0.999)] / 1000.0,
+      (double) pbench->latency[total - 1] / 1000.0);
+   pmeth->output_val.svalue.len_used = (unsigned int) strlen((char *) pmeth->output_val.svalue.buf_addr);
+   pmeth->json = 1;
+
+dbx_benchmark_exit:
+
+   if (pthr) {
+      dbx_free((void *) pthr, 0);
+   }
+   if (pbench->latency) {
+      dbx_free((void *) pbench->latency, 0);
+   }
+   if (pbench->value) {
+      dbx_free((void *) pbench->value, 0);
+   }
+   dbx_free((void *) pbench, 0);
+
+   return rc;
+}
+
+
+/* v1.3.31 The key for record number 'index' of a benchmark: ^global("k1",...,index) for M keys */
+int dbx_bench_key(DBXMETH *pmeth, DBXKEY *pkey, DBXBENCH *pbench, int index)
+{
+   int n, nx;
+   char buffer[64];
+   v8::Local<v8::String> str;
+   DBXCON *pcon = pmeth->pcon;
+
+   pkey->ibuffer.len_used = 0;
+   nx = 0;
+   if (pcon->key_type == DBX_KEYTYPE_M) {
+      pkey->args[nx].cvalue.pstr = 0;
+      pkey->args[nx].type = DBX_DTYPE_STR;
+      dbx_ibuffer_add(pmeth, pkey, NULL, nx, str, pbench->global, (int) strlen(pbench->global), 0);
+      nx ++;
+      for (n = 1; n < pbench->subscripts; n ++) {
+         sprintf(buffer, "k%d", n);
+         pkey->args[nx].cvalue.pstr = 0;
+         pkey->args[nx].type = DBX_DTYPE_STR;
+         dbx_ibuffer_add(pmeth, pkey, NULL, nx, str, buffer, (int) strlen(buffer), 0);
+         nx ++;
       }
    }
-
-
-   if (rc == CACHE_SUCCESS) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &retval, DBX_DTYPE_INT);
+   pkey->args[nx].cvalue.pstr = 0;
+   if (pcon->key_type == DBX_KEYTYPE_STR) {
+      sprintf(buffer, "key%010d", index);
+      pkey->args[nx].type = DBX_DTYPE_STR;
    }
    else {
-      dbx_error_message(pmeth, rc, (char *) "dbx_lock");
+      sprintf(buffer, "%d", index);
+      pkey->args[nx].type = DBX_DTYPE_INT;
+      pkey->args[nx].num.int32 = index;
    }
+   dbx_ibuffer_add(pmeth, pkey, NULL, nx, str, buffer, (int) strlen(buffer), 0);
+   nx ++;
 
-dbx_lock_exit:
+   pkey->argc = nx;
 
-   DBX_DB_UNLOCK();
+   return nx;
+}
 
-   return rc;
 
-#ifdef _WIN32
-}
-__except (EXCEPTION_EXECUTE_HANDLER) {
+/* v1.3.31 One benchmark operation: the query workload walks forward from its current position (counter < 0: start again from 'index') */
+int dbx_bench_op(DBXMETH *pmeth, DBXBENCH *pbench, DBXQR **pqr, int index, int *counter)
+{
+   int rc, nx, eod, fixed_key_len;
+   v8::Local<v8::String> str;
+   DBXQR *pqrx;
+   DBXCON *pcon = pmeth->pcon;
 
-   DWORD code;
-   char bufferx[256];
+   pmeth->increment = 0;
+   pmeth->pgdb = NULL;
+   pmeth->pgdbref = NULL;
+   pmeth->expiry = 0;
 
-   __try {
-      code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_lock: %x", code);
-      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   if (pbench->op == DBX_BENCH_QUERY) {
+      if (pbench->random || *counter < 0) {
+         dbx_bench_key(pmeth, &(pqr[0]->key), pbench, index);
+         if (pcon->key_type == DBX_KEYTYPE_M) {
+            strcpy((char *) pqr[0]->global_name.buf_addr, pbench->global);
+            strcpy((char *) pqr[1]->global_name.buf_addr, pbench->global);
+            pqr[0]->global_name.len_used = (unsigned int) strlen(pbench->global);
+            pqr[1]->global_name.len_used = pqr[0]->global_name.len_used;
+         }
+         *counter = 0;
+      }
+      fixed_key_len = (pcon->key_type == DBX_KEYTYPE_M) ? pqr[0]->key.args[0].csize : 0;
+
+      DBX_DB_LOCK(0);
+      pcon->error_code = 0;
+      eod = dbx_global_query(pmeth, pqr[1], pqr[0], 1, 0, &fixed_key_len, counter);
+      rc = pcon->error_code;
+      DBX_DB_UNLOCK();
+
+      if (eod == CACHE_SUCCESS) {
+         pqrx = pqr[1];
+         pqr[1] = pqr[0];
+         pqr[0] = pqrx;
+      }
+      else {
+         *counter = -1;
+         rc = (rc == CACHE_SUCCESS) ? CACHE_ERUNDEF : rc;
+      }
+      return rc;
    }
-   __except (EXCEPTION_EXECUTE_HANDLER) {
-      ;
+
+   nx = dbx_bench_key(pmeth, &(pmeth->key), pbench, index);
+
+   switch (pbench->op) {
+      case DBX_BENCH_SET:
+         pmeth->key.args[nx].cvalue.pstr = 0;
+         pmeth->key.args[nx].type = DBX_DTYPE_STR;
+         dbx_ibuffer_add(pmeth, &(pmeth->key), NULL, nx, str, pbench->value, pbench->value_size, 0);
+         pmeth->key.argc = nx + 1;
+         rc = dbx_set(pmeth);
+         break;
+      case DBX_BENCH_INCREMENT:
+         pmeth->key.args[nx].cvalue.pstr = 0;
+         pmeth->key.args[nx].type = DBX_DTYPE_INT;
+         pmeth->key.args[nx].num.int32 = 1;
+         dbx_ibuffer_add(pmeth, &(pmeth->key), NULL, nx, str, (char *) "1", 1, 0);
+         pmeth->key.args[nx].type = DBX_DTYPE_DOUBLE;
+         pmeth->key.args[nx].num.real = 1;
+         pmeth->key.argc = nx + 1;
+         pmeth->increment = 1;
+         rc = dbx_increment(pmeth);
+         break;
+      case DBX_BENCH_NEXT:
+         rc = dbx_next(pmeth);
+         if (rc == CACHE_SUCCESS && pmeth->output_val.svalue.len_used == 0) {
+            rc = CACHE_ERUNDEF;
+         }
+         break;
+      default:
+         rc = dbx_get(pmeth);
+         break;
    }
 
-   return CACHE_FAILURE;
-}
-#endif
+   return rc;
 }
 
 
-int dbx_unlock(DBXMETH *pmeth)
+int dbx_bench_compare(const void *p1, const void *p2)
 {
-   int rc, retval;
-   DBXCON *pcon = pmeth->pcon;
-
-#ifdef _WIN32
-__try {
-#endif
-
-   DBX_DB_LOCK(0);
+   unsigned int l1 = *((unsigned int *) p1);
+   unsigned int l2 = *((unsigned int *) p2);
 
-   pmeth->lock = 2;
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_unlock");
-      goto dbx_unlock_exit;
-   }
+   return (l1 < l2) ? -1 : ((l1 > l2) ? 1 : 0);
+}
 
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      rc = YDB_OK;
-      if (rc == YDB_OK)
-         retval = 1;
-      else
-         retval = 0;
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      rc = YDB_OK;
-      if (rc == YDB_OK)
-         retval = 1;
-      else
-         retval = 0;
-   }
 
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE dbx_bench_thread(LPVOID pargs)
+#else
+void * dbx_bench_thread(void *pargs)
+#endif
+{
+   int n, rc, index, counter;
+   unsigned long long seed, t0, t1;
+   unsigned int *platency;
+   void *pcursor;
+   MDB_txn *ptxnro;
+   DBXQR *pqr[2];
+   DBXMETH *pmeth;
+   DBXBENCHTHR *pthr = (DBXBENCHTHR *) pargs;
+   DBXBENCH *pbench = pthr->pbench;
+   DBXCON *pcon = pbench->pcon;
 
-   if (rc == CACHE_SUCCESS) {
-      dbx_create_string(&(pmeth->output_val.svalue), (void *) &retval, DBX_DTYPE_INT);
+   pmeth = dbx_request_memory(pcon, 0);
+   if (pmeth) {
+      pmeth->pbench = pbench; /* v1.3.33 the benchmark's own operations are not counted by db.stats() */
+   }
+   pqr[0] = NULL;
+   pqr[1] = NULL;
+   pcursor = NULL;
+   ptxnro = NULL;
+   if (pmeth && pbench->op == DBX_BENCH_QUERY) {
+      pqr[0] = dbx_alloc_dbxqr(NULL, 0, 0);
+      pqr[1] = dbx_alloc_dbxqr(NULL, 0, 0);
+
+      /* the query workload walks the database with its own cursor (as an mcursor does) */
+      DBX_DB_LOCK(0);
+      if (pcon->dbtype == DBX_DBTYPE_BDB) {
+         DBC *pbdbcursor = NULL;
+         if (pcon->p_bdb_so->pdb) {
+            pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pbdbcursor, 0);
+         }
+         pcursor = (void *) pbdbcursor;
+      }
+      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         MDB_cursor *plmdbcursor = NULL;
+         lmdb_start_qro_transaction(pmeth, &ptxnro, 0);
+         if (pcon->p_lmdb_so->p_mdb_cursor_open(ptxnro, pcon->p_lmdb_so->db, &plmdbcursor) != 0) {
+            plmdbcursor = NULL;
+         }
+         pcursor = (void *) plmdbcursor;
+      }
+      DBX_DB_UNLOCK();
+      pmeth->pbdbcursor = (DBC *) pcursor;
+      pmeth->plmdbcursor = (MDB_cursor *) pcursor;
    }
-   else {
-      dbx_error_message(pmeth, rc, (char *) "dbx_unlock");
+   if (!pmeth || (pbench->op == DBX_BENCH_QUERY && (!pqr[0] || !pqr[1] || !pcursor))) {
+      pthr->errors = pbench->count;
+      memset((void *) (pbench->latency + (pthr->tn * pbench->count)), 0, sizeof(unsigned int) * pbench->count);
+      goto dbx_bench_thread_exit;
    }
 
-dbx_unlock_exit:
+   /* each thread has its own sequence of keys: a xorshift generator for random access or a starting point spread across the key range */
+   seed = 0x9E3779B97F4A7C15ULL ^ ((unsigned long long) (pthr->tn + 1) * 0xBF58476D1CE4E5B9ULL);
+   platency = pbench->latency + (pthr->tn * pbench->count);
+   counter = -1;
 
-   DBX_DB_UNLOCK();
+   for (n = 0; n < pbench->count; n ++) {
+      if (pbench->random) {
+         seed ^= seed << 13;
+         seed ^= seed >> 7;
+         seed ^= seed << 17;
+         index = (int) (seed % (unsigned long long) pbench->keys);
+      }
+      else {
+         index = (int) ((((long long) pthr->tn * pbench->keys) / pbench->threads + n) % pbench->keys);
+      }
 
-   return rc;
+      t0 = dbx_clock_ns();
+      rc = dbx_bench_op(pmeth, pbench, pqr, index, &counter);
+      t1 = dbx_clock_ns();
 
-#ifdef _WIN32
-}
-__except (EXCEPTION_EXECUTE_HANDLER) {
+      platency[n] = ((t1 - t0) > 0xffffffff) ? 0xffffffff : (unsigned int) (t1 - t0);
+      if (rc == CACHE_ERUNDEF) {
+         pthr->not_found ++;
+      }
+      else if (rc != CACHE_SUCCESS) {
+         pthr->errors ++;
+      }
+   }
 
-   DWORD code;
-   char bufferx[256];
+dbx_bench_thread_exit:
 
-   __try {
-      code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_unlock: %x", code);
-      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   if (pcursor || ptxnro) {
+      DBX_DB_LOCK(0);
+      if (pcon->dbtype == DBX_DBTYPE_BDB) {
+         ((DBC *) pcursor)->close((DBC *) pcursor);
+      }
+      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+         if (pcursor) {
+            pcon->p_lmdb_so->p_mdb_cursor_close((MDB_cursor *) pcursor);
+         }
+         lmdb_commit_qro_transaction(pmeth, &ptxnro, 0);
+      }
+      DBX_DB_UNLOCK();
    }
-   __except (EXCEPTION_EXECUTE_HANDLER) {
-      ;
+   if (pqr[0]) {
+      dbx_free_dbxqr(pqr[0]);
+   }
+   if (pqr[1]) {
+      dbx_free_dbxqr(pqr[1]);
+   }
+   if (pmeth) {
+      dbx_request_memory_free(pcon, pmeth, 0);
    }
 
-   return CACHE_FAILURE;
-}
+#if defined(_WIN32)
+   return 0;
+#else
+   return NULL;
 #endif
 }
 
 
-int dbx_merge(DBXMETH *pmeth)
+/* v1.3.33 Record the time taken by an engine function: asynchronous requests also record the time spent waiting for a worker thread */
+int dbx_stats_record(DBXMETH *pmeth, int cmnd, unsigned long long tstart, int rc)
 {
-   int rc, n, ref1, ref1_csize, ref2_csize;
-   unsigned char ref2_fixed[1024];
+   unsigned long long tend, tid;
+   DBXSTATSHARD *pshard;
    DBXCON *pcon = pmeth->pcon;
 
-#ifdef _WIN32
-__try {
-#endif
-/*
-   printf("\r\nlen=%d\r\n", pmeth->key.ibuffer.len_used);
-   dbx_dump_key((char *) pmeth->key.ibuffer.buf_addr, (int) pmeth->key.ibuffer.len_used);
-*/
-
-   DBX_DB_LOCK(0);
+   if (cmnd < 0 || cmnd >= DBX_STATS_CMNDS) {
+      return 0;
+   }
 
-   ref1_csize = 0;
-   ref2_csize = 0;
+   tend = dbx_clock_ns();
+   if (pmeth->trace) { /* v1.3.36 */
+      pmeth->trace_cmnd = (short) cmnd;
+      dbx_trace_span(pmeth, DBX_TRACE_ENGINE, tstart, tend);
+      pmeth->tresult = tend;
+   }
+   if (!pcon->pstats || pmeth->pbench) { /* v1.3.33 */
+      return 0;
+   }
+   tid = (unsigned long long) dbx_current_thread_id();
+   pshard = &(pcon->pstats->shard[(tid ^ (tid >> 12) ^ (tid >> 24)) % DBX_STATS_SHARDS]);
 
-   rc = dbx_global_reference(pmeth);
-   if (rc != CACHE_SUCCESS) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_merge");
-      goto dbx_merge_exit;
+   if (pmeth->tqueue) {
+      if (tstart > pmeth->tqueue) {
+         dbx_stats_add(&(pshard->hist[cmnd][DBX_STATS_QUEUE]), tstart - pmeth->tqueue);
+      }
+      dbx_stats_add(&(pshard->hist[cmnd][DBX_STATS_ASYNC]), tend - tstart);
+      pmeth->tqueue = 0;
+   }
+   else {
+      dbx_stats_add(&(pshard->hist[cmnd][DBX_STATS_SYNC]), tend - tstart);
+   }
+   if (rc != CACHE_SUCCESS && rc != CACHE_ERUNDEF) {
+      DBX_ATOMIC_ADD64(&(pshard->errors[cmnd]), 1);
    }
 
-   ref1 = 0;
-   n = 0;
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-      DBT key, key0, key2, data;
-      DBC *pcursor;
+   return 1;
+}
 
-      memset(&key, 0, sizeof(DBT));
-      memset(&key0, 0, sizeof(DBT));
-      memset(&key2, 0, sizeof(DBT));
-      memset(&data, 0, sizeof(DBT));
-      key.flags = DB_DBT_USERMEM;
-      key0.flags = DB_DBT_USERMEM;
-      key2.flags = DB_DBT_USERMEM;
-      data.flags = DB_DBT_USERMEM;
 
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.data = &(pmeth->key.args[0].num.int32);
-         key.size = sizeof(pmeth->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.size = (u_int32_t) pmeth->key.args[0].svalue.len_used;
-      }
-      else { /* mumps */
-         for (n = 1; n < pmeth->jsargc; n ++) {
-            if (pmeth->key.args[n].sort == DBX_DSORT_GLOBAL) {
-               ref1 = n;
-               break;
-            }
-         }
-         ref1_csize = pmeth->key.args[pmeth->jsargc - 1].csize - pmeth->key.args[ref1 - 1].csize;
-         ref2_csize = pmeth->key.args[ref1 - 1].csize;
+int dbx_stats_add(DBXHIST *phist, unsigned long long ns)
+{
+   unsigned long long max;
 
-         key.data = (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize);
-         key.size = (u_int32_t) ref1_csize;
-         key.ulen = (u_int32_t) pmeth->key.ibuffer.len_alloc;
-/*
-         printf("\r\nref2=%d; ref1=%d; key.size=%d; ref1_csize=%d; ref2_csize=%d", ref2, ref1, (int) key.size, ref1_csize, ref2_csize);
-         dbx_dump_key((char *) key.data, (int) key.size);
-*/
-         dbx_memcpy(&(pmeth->output_key.svalue), (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize), (size_t) ref1_csize);
-         key0.data = (void *) pmeth->output_key.svalue.buf_addr;
-         key0.size = (u_int32_t) ref1_csize;
-         key0.ulen = (u_int32_t) pmeth->output_key.svalue.len_alloc;
+   DBX_ATOMIC_ADD64(&(phist->count), 1);
+   DBX_ATOMIC_ADD64(&(phist->total), ns);
+   DBX_ATOMIC_INC32(&(phist->bucket[dbx_stats_bucket(ns)]));
+   while ((max = phist->max) < ns && !DBX_ATOMIC_CAS64(&(phist->max), max, ns)) {
+      ;
+   }
 
-         memcpy((void *) ref2_fixed, (void *) pmeth->key.ibuffer.buf_addr, (size_t) ref2_csize);
-      }
+   return 1;
+}
 
-      data.data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.ulen = (u_int32_t)  pmeth->output_val.svalue.len_alloc;
 
-      if (pcon->key_type == DBX_KEYTYPE_M) {
-         rc = pcon->p_bdb_so->pdb->cursor(pcon->p_bdb_so->pdb, NULL, &pcursor, 0);
-         if (rc == CACHE_SUCCESS) {
-/*
-            printf("\r\nkey.ulen=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", (int) key.ulen, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-*/
-            rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_SET_RANGE); /* v1.3.9 */
-/*
-            printf("\r\nrc=%d key.size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d; key0.size=%d;", rc, (int) key.size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize, (int) key0.size);
-            dbx_dump_key((char *) key.data, (int) key.size);
-*/
-            if (rc == CACHE_SUCCESS && !bdb_key_compare(&key, &key0, (int) key0.size, pcon->key_type)) {
-/*
-            printf("\r\nrc=%d; key0.size=%d; comp=%d", rc, key0.size, bdb_key_compare(&key, &key0, (int) key0.size, pcon->key_type));
-*/
-               for (;;) {
-/*
-                  dbx_dump_key((char *) key.data, (int) key.size);
-*/
-                  memcpy((void *) (ref2_fixed + ref2_csize), (void *) ((char *) key.data + ref1_csize), (size_t) (key.size - ref1_csize));
-/*
-                  dbx_dump_key((char *) ref2_fixed, (int) (ref2_csize + (key.size - ref1_csize)));
-*/
-                  key2.data = (void *) ref2_fixed;
-                  key2.size = (u_int32_t) (ref2_csize + (key.size - ref1_csize));
-                  key2.ulen = 1024;
-                  rc = pcon->p_bdb_so->pdb->put(pcon->p_bdb_so->pdb, NULL, &key2, &data, 0);
+/* Values below 2^DBX_STATS_SUB_BITS have a bucket each; above that each power of two is split into 2^DBX_STATS_SUB_BITS buckets */
+int dbx_stats_bucket(unsigned long long ns)
+{
+   int msb;
+   unsigned long long v;
 
-                  rc = bdb_cursor_get(pcursor, &key, &(pmeth->key.ibuffer), &data, &(pmeth->output_val.svalue), DB_NEXT); /* v1.3.9 */
+   if (ns < (1ULL << DBX_STATS_SUB_BITS)) {
+      return (int) ns;
+   }
+   if (ns >= (1ULL << (DBX_STATS_MAX_BITS + 1))) {
+      return DBX_STATS_BUCKETS - 1;
+   }
+   msb = 0;
+   for (v = ns; v > 1; v >>= 1) {
+      msb ++;
+   }
+   return ((msb - DBX_STATS_SUB_BITS + 1) << DBX_STATS_SUB_BITS) + (int) ((ns >> (msb - DBX_STATS_SUB_BITS)) & ((1ULL << DBX_STATS_SUB_BITS) - 1));
+}
 
-                  if (rc != CACHE_SUCCESS || bdb_key_compare(&key, &key0, (int) key0.size, pcon->key_type)) {
-                     break;
-                  }
-               }
-            }
-            pcursor->close(pcursor);
-         }
-         rc = CACHE_SUCCESS;
-      }
+
+/* The highest value held in a bucket */
+unsigned long long dbx_stats_bucket_value(int bucket)
+{
+   int msb, sub;
+
+   if (bucket < (1 << DBX_STATS_SUB_BITS)) {
+      return (unsigned long long) bucket;
    }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      MDB_val key, key0, key2, data;
-      MDB_cursor *pcursor;
+   msb = (bucket >> DBX_STATS_SUB_BITS) + DBX_STATS_SUB_BITS - 1;
+   sub = bucket & ((1 << DBX_STATS_SUB_BITS) - 1);
+   return (1ULL << msb) + ((unsigned long long) (sub + 1) << (msb - DBX_STATS_SUB_BITS)) - 1;
+}
 
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key.mv_data = &(pmeth->key.args[0].num.int32);
-         key.mv_size = sizeof(pmeth->key.args[0].num.int32);
+
+/* Sum the shards for a command and path */
+int dbx_stats_merge(DBXSTATS *pstats, int cmnd, int path, DBXHIST *phist)
+{
+   int n, b;
+   DBXHIST *pshard;
+
+   memset((void *) phist, 0, sizeof(DBXHIST));
+   for (n = 0; n < DBX_STATS_SHARDS; n ++) {
+      pshard = &(pstats->shard[n].hist[cmnd][path]);
+      phist->count += pshard->count;
+      phist->total += pshard->total;
+      if (pshard->max > phist->max) {
+         phist->max = pshard->max;
       }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         key.mv_data = (void *) pmeth->key.args[0].svalue.buf_addr;
-         key.mv_size = (size_t) pmeth->key.args[0].svalue.len_used;
+      for (b = 0; b < DBX_STATS_BUCKETS; b ++) {
+         phist->bucket[b] += pshard->bucket[b];
       }
-      else { /* mumps */
-         for (n = 1; n < pmeth->jsargc; n ++) {
-            if (pmeth->key.args[n].sort == DBX_DSORT_GLOBAL) {
-               ref1 = n;
-               break;
-            }
-         }
-         ref1_csize = pmeth->key.args[pmeth->jsargc - 1].csize - pmeth->key.args[ref1 - 1].csize;
-         ref2_csize = pmeth->key.args[ref1 - 1].csize;
+   }
 
-         key.mv_data = (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize);
-         key.mv_size = (size_t) ref1_csize;
-/*
-         printf("\r\nref2=%d; ref1=%d; key.mv_size=%d; ref1_csize=%d; ref2_csize=%d", ref2, ref1, (int) key.mv_size, ref1_csize, ref2_csize);
-         dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-         dbx_memcpy_exx(&(pmeth->output_key.svalue), (void *) (pmeth->key.ibuffer.buf_addr + ref2_csize), (size_t) ref1_csize);
-         key0.mv_data = (void *) pmeth->output_key.svalue.buf_addr;
-         key0.mv_size = (size_t) ref1_csize;
+   return (int) (phist->count ? 1 : 0);
+}
 
-         memcpy((void *) ref2_fixed, (void *) pmeth->key.ibuffer.buf_addr, (size_t) ref2_csize);
+
+unsigned long long dbx_stats_percentile(DBXHIST *phist, double q)
+{
+   int b;
+   unsigned long long total, rank, value;
+
+   total = 0;
+   for (b = 0; b < DBX_STATS_BUCKETS; b ++) {
+      total += phist->bucket[b];
+   }
+   if (!total) {
+      return 0;
+   }
+   rank = (unsigned long long) ((double) total * q);
+   if (rank >= total) {
+      rank = total - 1;
+   }
+   value = 0;
+   total = 0;
+   for (b = 0; b < DBX_STATS_BUCKETS; b ++) {
+      total += phist->bucket[b];
+      if (total > rank) {
+         value = dbx_stats_bucket_value(b);
+         break;
       }
+   }
 
-      data.mv_data = (void *) pmeth->output_val.svalue.buf_addr;
-      data.mv_size = (size_t)  pmeth->output_val.svalue.len_alloc;
-/*
-     rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &pcursor);
-         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
-      rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &key, &data, 0);
-*/
+   return (value > phist->max) ? phist->max : value;
+}
 
-      if (pcon->key_type == DBX_KEYTYPE_M) {
-         rc = pcon->p_lmdb_so->p_mdb_txn_begin(pcon->p_lmdb_so->penv, NULL, 0, &(pcon->p_lmdb_so->ptxn));
-         pcon->tlevel ++;
-         rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &pcursor);
-         if (rc == CACHE_SUCCESS) {
-/*
-            printf("\r\npmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d", pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize);
-*/
-            rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
-/*
-            printf("\r\nrc=%d key.mv_size=%d; pmeth->key.argc=%d; pmeth->key.args[pmeth->key.argc - 1].csize=%d; key0.size=%d;", rc, (int) key.mv_size, pmeth->key.argc, pmeth->key.args[pmeth->key.argc - 1].csize, (int) key0.mv_size);
-            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-            if (rc == CACHE_SUCCESS && !lmdb_key_compare(&key, &key0, (int) key0.mv_size, pcon->key_type)) {
-/*
-            printf("\r\nrc=%d; key0.mv_size=%d; comp=%d", rc, key0.mv_size, lmdb_key_compare(&key, &key0, (int) key0.mv_size, pcon->key_type));
-*/
-               for (;;) {
-/*
-                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-                  memcpy((void *) (ref2_fixed + ref2_csize), (void *) ((char *) key.mv_data + ref1_csize), (size_t) (key.mv_size - ref1_csize));
-/*
-                  dbx_dump_key((char *) ref2_fixed, (int) (ref2_csize + (key.mv_size - ref1_csize)));
-*/
-                  key2.mv_data = (void *) ref2_fixed;
-                  key2.mv_size = (size_t) (ref2_csize + (key.mv_size - ref1_csize));
-                  rc = pcon->p_lmdb_so->p_mdb_put(pcon->p_lmdb_so->ptxn, pcon->p_lmdb_so->db, &key2, &data, 0);
 
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+/* v1.3.34 Report the storage engine's own statistics (db.engine_stats()): the result is returned as a JSON document */
+int dbx_engine_stats(DBXMETH *pmeth)
+{
+   int rc;
+   DBXCON *pcon = pmeth->pcon;
 
-                  if (rc != CACHE_SUCCESS || lmdb_key_compare(&key, &key0, (int) key0.mv_size, pcon->key_type)) {
-                     break;
-                  }
-               }
-            }
-            pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
-            pcon->p_lmdb_so->p_mdb_txn_commit(pcon->p_lmdb_so->ptxn);
-            pcon->tlevel --;
-         }
-         rc = CACHE_SUCCESS;
-      }
+#ifdef _WIN32
+__try {
+#endif
+
+   DBX_DB_LOCK(0);
+
+   pcon->error[0] = '\0';
+   pmeth->output_val.svalue.len_used = 0;
+   if (pcon->dbtype == DBX_DBTYPE_BDB && pcon->p_bdb_so) {
+      rc = bdb_engine_stats(pmeth);
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB && pcon->p_lmdb_so && pcon->p_lmdb_so->penv) {
+      rc = lmdb_engine_stats(pmeth);
+   }
+   else {
+      strcpy(pcon->error, "The engine statistics are not available until a database has been opened");
+      rc = CACHE_FAILURE;
+   }
+   if (rc != CACHE_SUCCESS && !pcon->error[0]) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_engine_stats");
    }
 
-dbx_merge_exit:
+   DBX_DB_UNLOCK();
+
+   if (rc == CACHE_SUCCESS) {
+      pmeth->json = 1;
+   }
+   else {
+      pmeth->output_val.svalue.len_used = 0;
+   }
 
    return rc;
 
@@ -7496,7 +14540,7 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 
    __try {
       code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_merge: %x", code);
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_engine_stats: %x", code);
       dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
    }
    __except (EXCEPTION_EXECUTE_HANDLER) {
@@ -7506,7 +14550,269 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
    return CACHE_FAILURE;
 }
 #endif
+}
+
+
+/* v1.3.34 Append to the JSON document being built in output_val: global names are escaped as JSON strings */
+int dbx_engine_stats_append(DBXMETH *pmeth, char *item, int escape)
+{
+   unsigned int len, req;
+   unsigned char *p;
+   char *pbuf;
+   DBXSTR *pstr;
+
+   pstr = &(pmeth->output_val.svalue);
+   len = (unsigned int) strlen(item);
+   req = pstr->len_used + (escape ? (len * 6) : len) + 1; /* worst case: every character escaped as \u00XX */
+   if (req > pstr->len_alloc) {
+      if (!dbx_buffer_resize(&(pstr->buf_addr), pstr->len_used, req + 4096, &(pstr->len_alloc))) {
+         strcpy(pmeth->pcon->error, "No Memory");
+         return CACHE_NOCON;
+      }
+   }
+
+   pbuf = (char *) pstr->buf_addr + pstr->len_used;
+   if (!escape) {
+      memcpy((void *) pbuf, (void *) item, (size_t) len);
+      pbuf += len;
+   }
+   else {
+      for (p = (unsigned char *) item; *p; p ++) {
+         if (*p == '"' || *p == '\\') {
+            *pbuf ++ = '\\';
+            *pbuf ++ = (char) *p;
+         }
+         else if (*p < 0x20) {
+            sprintf(pbuf, "\\u%04x", (unsigned int) *p);
+            pbuf += 6;
+         }
+         else {
+            *pbuf ++ = (char) *p;
+         }
+      }
+   }
+   *pbuf = '\0';
+   pstr->len_used = (unsigned int) (pbuf - (char *) pstr->buf_addr);
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v1.3.34 LMDB: environment information, B-tree shape and reader table */
+int lmdb_engine_stats(DBXMETH *pmeth)
+{
+   int rc, n, active_readers, depth;
+   double map_used, branch_pages, leaf_pages, overflow_pages, entries;
+   char item[512];
+   MDB_txn *ptxn;
+   MDB_envinfo info;
+   MDB_stat stat, gstat;
+   DBXCON *pcon = pmeth->pcon;
+
+   rc = pcon->p_lmdb_so->p_mdb_env_info(pcon->p_lmdb_so->penv, &info);
+   if (rc == CACHE_SUCCESS) {
+      rc = pcon->p_lmdb_so->p_mdb_env_stat(pcon->p_lmdb_so->penv, &stat);
+   }
+   if (rc != CACHE_SUCCESS) {
+      return rc;
+   }
+
+   /* a reader slot stays allocated to a thread after its read transaction has ended: only count those reading now */
+   active_readers = -1;
+   if (pcon->p_lmdb_so->p_mdb_reader_list && !pmeth->fast) {
+      active_readers = 0;
+      pcon->p_lmdb_so->p_mdb_reader_list(pcon->p_lmdb_so->penv, lmdb_reader_count, (void *) &active_readers);
+   }
+
+   map_used = (double) (info.me_last_pgno + 1) * (double) stat.ms_psize;
+   sprintf(item, "{\"engine\":\"%s\",\"map_size\":%.0f,\"map_used\":%.0f,\"map_used_ratio\":%.4f,\"resizes\":%d,\"page_size\":%u,\"last_pgno\":%.0f,\"last_txnid\":%.0f,\"max_readers\":%u,\"readers\":%u,\"active_readers\":%d",
+      pcon->p_lmdb_so->dbname, (double) info.me_mapsize, map_used, info.me_mapsize ? (map_used / (double) info.me_mapsize) : 0,
+      pcon->db_resizes, stat.ms_psize, (double) info.me_last_pgno, (double) info.me_last_txnid, info.me_maxreaders, info.me_numreaders, active_readers);
+   rc = dbx_engine_stats_append(pmeth, item, 0);
+
+   /* the totals cover the main database and, with global_dbs, every named database opened so far */
+   depth = (int) stat.ms_depth;
+   branch_pages = (double) stat.ms_branch_pages;
+   leaf_pages = (double) stat.ms_leaf_pages;
+   overflow_pages = (double) stat.ms_overflow_pages;
+   entries = (double) stat.ms_entries;
+
+   if (rc == CACHE_SUCCESS && pcon->p_lmdb_so->global_dbs && pcon->p_lmdb_so->p_gdb && pcon->p_lmdb_so->p_mdb_stat && !pmeth->fast) {
+      ptxn = NULL;
+      rc = lmdb_start_qro_transaction(pmeth, &ptxn, 0);
+      if (rc == CACHE_SUCCESS) {
+         rc = dbx_engine_stats_append(pmeth, (char *) ",\"globals\":{", 0);
+         for (n = 0; rc == CACHE_SUCCESS && n < pcon->p_lmdb_so->gdb_count; n ++) {
+            if (!pcon->p_lmdb_so->p_gdb[n].open || pcon->p_lmdb_so->p_mdb_stat(ptxn, pcon->p_lmdb_so->p_gdb[n].dbi, &gstat) != CACHE_SUCCESS) {
+               continue;
+            }
+            if (depth < (int) gstat.ms_depth) {
+               depth = (int) gstat.ms_depth;
+            }
+            branch_pages += (double) gstat.ms_branch_pages;
+            leaf_pages += (double) gstat.ms_leaf_pages;
+            overflow_pages += (double) gstat.ms_overflow_pages;
+            entries += (double) gstat.ms_entries;
+
+            rc = dbx_engine_stats_append(pmeth, (char *) (pmeth->output_val.svalue.buf_addr[pmeth->output_val.svalue.len_used - 1] == '{' ? "\"" : ",\""), 0);
+            if (rc == CACHE_SUCCESS) {
+               rc = dbx_engine_stats_append(pmeth, pcon->p_lmdb_so->p_gdb[n].name, 1);
+            }
+            if (rc == CACHE_SUCCESS) {
+               sprintf(item, "\":{\"depth\":%u,\"branch_pages\":%.0f,\"leaf_pages\":%.0f,\"overflow_pages\":%.0f,\"entries\":%.0f}",
+                  gstat.ms_depth, (double) gstat.ms_branch_pages, (double) gstat.ms_leaf_pages, (double) gstat.ms_overflow_pages, (double) gstat.ms_entries);
+               rc = dbx_engine_stats_append(pmeth, item, 0);
+            }
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = dbx_engine_stats_append(pmeth, (char *) "}", 0);
+         }
+         lmdb_commit_qro_transaction(pmeth, &ptxn, 0);
+      }
+   }
+
+   if (rc == CACHE_SUCCESS) {
+      sprintf(item, ",\"depth\":%d,\"branch_pages\":%.0f,\"leaf_pages\":%.0f,\"overflow_pages\":%.0f,\"entries\":%.0f}",
+         depth, branch_pages, leaf_pages, overflow_pages, entries);
+      rc = dbx_engine_stats_append(pmeth, item, 0);
+   }
+
+   return rc;
+}
+
+
+/* v1.3.34 mdb_reader_list() callback: one line of output per reader slot in use; an idle slot has no transaction id ('-') */
+int lmdb_reader_count(const char *msg, void *ctx)
+{
+   int *pcount;
+
+   pcount = (int *) ctx;
+   if (!strncmp(msg, "    pid", 7) || !strncmp(msg, "(no active readers)", 19)) {
+      return 0;
+   }
+   if (!strstr(msg, " -\n")) {
+      (*pcount) ++;
+   }
+
+   return 0;
+}
+
+
+/* v1.3.34 BDB: B-tree shape for each database and the effectiveness of the cache (memory pool) */
+int bdb_engine_stats(DBXMETH *pmeth)
+{
+   int rc, n;
+   double hits, misses;
+   char item[512];
+   DB_ENV *penv;
+   DB_MPOOL_STAT *pstat;
+   DB_BTREE_STAT total;
+   DBXCON *pcon = pmeth->pcon;
+
+   memset((void *) &total, 0, sizeof(DB_BTREE_STAT));
+
+   sprintf(item, "{\"engine\":\"%s\",\"transactions\":%s", pcon->p_bdb_so->dbname, pcon->bdb.txn ? "true" : "false");
+   rc = dbx_engine_stats_append(pmeth, item, 0);
+
+   if (rc == CACHE_SUCCESS && pcon->p_bdb_so->pdb) {
+      rc = bdb_tree_stats(pmeth, pcon->p_bdb_so->pdb, &total, item);
+   }
+
+   if (rc == CACHE_SUCCESS && pcon->p_bdb_so->global_dbs && pcon->p_bdb_so->p_gdb) {
+      rc = dbx_engine_stats_append(pmeth, (char *) ",\"globals\":{", 0);
+      for (n = 0; rc == CACHE_SUCCESS && n < pcon->p_bdb_so->gdb_count; n ++) {
+         if (!pcon->p_bdb_so->p_gdb[n].open || !pcon->p_bdb_so->p_gdb[n].pdb) {
+            continue;
+         }
+         rc = bdb_tree_stats(pmeth, pcon->p_bdb_so->p_gdb[n].pdb, &total, item);
+         if (rc != CACHE_SUCCESS) {
+            break;
+         }
+         rc = dbx_engine_stats_append(pmeth, (char *) (pmeth->output_val.svalue.buf_addr[pmeth->output_val.svalue.len_used - 1] == '{' ? "\"" : ",\""), 0);
+         if (rc == CACHE_SUCCESS) {
+            rc = dbx_engine_stats_append(pmeth, pcon->p_bdb_so->p_gdb[n].name, 1);
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = dbx_engine_stats_append(pmeth, (char *) "\":", 0);
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = dbx_engine_stats_append(pmeth, item, 0);
+         }
+      }
+      if (rc == CACHE_SUCCESS) {
+         rc = dbx_engine_stats_append(pmeth, (char *) "}", 0);
+      }
+   }
+   if (rc != CACHE_SUCCESS) {
+      return rc;
+   }
+
+   /* the totals cover the main database and every per-global database opened so far */
+   sprintf(item, ",\"page_size\":%u,\"depth\":%u,\"branch_pages\":%u,\"leaf_pages\":%u,\"overflow_pages\":%u,\"empty_pages\":%u,\"free_pages\":%u,\"keys\":%u,\"entries\":%u",
+      total.bt_pagesize, total.bt_levels, total.bt_int_pg, total.bt_leaf_pg, total.bt_over_pg, total.bt_empty_pg, total.bt_free, total.bt_nkeys, total.bt_ndata);
+   rc = dbx_engine_stats_append(pmeth, item, 0);
+   if (rc != CACHE_SUCCESS) {
+      return rc;
+   }
+
+   pstat = NULL;
+   penv = pcon->p_bdb_so->penv;
+   if (!penv && pcon->p_bdb_so->pdb) { /* a database opened without an environment has a private cache */
+      penv = pcon->p_bdb_so->pdb->get_env(pcon->p_bdb_so->pdb);
+   }
+   else if (!penv && pcon->p_bdb_so->p_gdb && pcon->p_bdb_so->gdb_count > 0 && pcon->p_bdb_so->p_gdb[0].pdb) {
+      penv = pcon->p_bdb_so->p_gdb[0].pdb->get_env(pcon->p_bdb_so->p_gdb[0].pdb);
+   }
+   if (penv) {
+      rc = penv->memp_stat(penv, &pstat, NULL, 0);
+   }
+   if (rc == CACHE_SUCCESS && pstat) {
+      hits = (double) pstat->st_cache_hit;
+      misses = (double) pstat->st_cache_miss;
+      sprintf(item, ",\"cache\":{\"cache_size\":%.0f,\"hits\":%.0f,\"misses\":%.0f,\"hit_ratio\":%.4f,\"pages_in\":%.0f,\"pages_out\":%.0f,\"evictions\":%.0f,\"dirty_pages\":%.0f}",
+         ((double) pstat->st_gbytes * 1073741824.0) + (double) pstat->st_bytes, hits, misses, (hits + misses) > 0 ? (hits / (hits + misses)) : 0,
+         (double) pstat->st_page_in, (double) pstat->st_page_out, (double) pstat->st_ro_evict + (double) pstat->st_rw_evict, (double) pstat->st_page_dirty);
+      free((void *) pstat); /* allocated by the BDB library */
+      rc = dbx_engine_stats_append(pmeth, item, 0);
+   }
+   if (rc == CACHE_SUCCESS) {
+      rc = dbx_engine_stats_append(pmeth, (char *) "}", 0);
+   }
 
+   return rc;
+}
+
+
+/* v1.3.34 B-tree statistics for one BDB database: written to 'item' as a JSON object and added to the totals */
+int bdb_tree_stats(DBXMETH *pmeth, DB *pdb, DB_BTREE_STAT *ptotal, char *item)
+{
+   int rc;
+   DB_BTREE_STAT *psp;
+
+   psp = NULL;
+   /* DB_FAST_STAT avoids a traversal of the tree but leaves the page counts at zero */
+   rc = pdb->stat(pdb, NULL, (void *) &psp, pmeth->fast ? DB_FAST_STAT : 0);
+   if (rc != CACHE_SUCCESS || !psp) {
+      return rc;
+   }
+
+   sprintf(item, "{\"depth\":%u,\"branch_pages\":%u,\"leaf_pages\":%u,\"overflow_pages\":%u,\"empty_pages\":%u,\"free_pages\":%u,\"keys\":%u,\"entries\":%u}",
+      psp->bt_levels, psp->bt_int_pg, psp->bt_leaf_pg, psp->bt_over_pg, psp->bt_empty_pg, psp->bt_free, psp->bt_nkeys, psp->bt_ndata);
+
+   ptotal->bt_pagesize = psp->bt_pagesize;
+   if (ptotal->bt_levels < psp->bt_levels) {
+      ptotal->bt_levels = psp->bt_levels;
+   }
+   ptotal->bt_int_pg += psp->bt_int_pg;
+   ptotal->bt_leaf_pg += psp->bt_leaf_pg;
+   ptotal->bt_over_pg += psp->bt_over_pg;
+   ptotal->bt_empty_pg += psp->bt_empty_pg;
+   ptotal->bt_free += psp->bt_free;
+   ptotal->bt_nkeys += psp->bt_nkeys;
+   ptotal->bt_ndata += psp->bt_ndata;
+   free((void *) psp); /* allocated by the BDB library */
+
+   return CACHE_SUCCESS;
 }
 
 
@@ -7528,6 +14834,83 @@ int dbx_sql_cleanup(DBXMETH *pmeth)
 }
 
 
+/* v1.3.27 Returns 1 if the global holds at least one node that has not expired: usually the first record read answers this */
+int dbx_global_live(DBXMETH *pmeth, char *name, int name_len)
+{
+   int rc, live, plen;
+   unsigned char prefix[256];
+   DBXGDB *pgdb;
+   DBXCON *pcon = pmeth->pcon;
+
+   if (name_len < 1 || name_len > 250) {
+      return 1;
+   }
+   prefix[0] = 0x00;
+   prefix[1] = 0x03;
+   memcpy((void *) (prefix + 2), (void *) name, (size_t) name_len);
+   plen = name_len + 2;
+
+   pgdb = NULL;
+   if (pcon->global_dbs) {
+      dbx_global_db(pmeth, name, name_len, 0, &pgdb);
+      if (!pgdb) {
+         return 0;
+      }
+   }
+
+   live = 0;
+   if (pcon->dbtype == DBX_DBTYPE_BDB) {
+      DB *pdb;
+      DBC *pcursor;
+      DBT key, data;
+
+      pdb = (pgdb ? pgdb->pdb : pcon->p_bdb_so->pdb);
+      if (!pdb || pdb->cursor(pdb, NULL, &pcursor, 0) != 0) {
+         return 1;
+      }
+      memset(&key, 0, sizeof(DBT));
+      memset(&data, 0, sizeof(DBT));
+      key.data = (void *) prefix;
+      key.size = (u_int32_t) plen;
+      rc = pcursor->get(pcursor, &key, &data, DB_SET_RANGE);
+      /* the global's own records are those whose key is the prefix or continues with a subscript */
+      while (rc == 0 && key.size >= (u_int32_t) plen && !memcmp(key.data, (void *) prefix, (size_t) plen) && (key.size == (u_int32_t) plen || ((unsigned char *) key.data)[plen] == 0x00)) {
+         if (!dbx_expired((char *) data.data, (size_t) data.size)) {
+            live = 1;
+            break;
+         }
+         rc = pcursor->get(pcursor, &key, &data, DB_NEXT);
+      }
+      pcursor->close(pcursor);
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_cursor *pcursor;
+      MDB_val key, data;
+
+      lmdb_start_ro_transaction(pmeth, 0);
+      rc = pcon->p_lmdb_so->p_mdb_cursor_open(pcon->p_lmdb_so->ptxnro, pgdb ? pgdb->dbi : pcon->p_lmdb_so->db, &pcursor);
+      if (rc != CACHE_SUCCESS) {
+         lmdb_commit_ro_transaction(pmeth, 0);
+         return 1;
+      }
+      key.mv_data = (void *) prefix;
+      key.mv_size = (size_t) plen;
+      rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_SET_RANGE);
+      while (rc == CACHE_SUCCESS && key.mv_size >= (size_t) plen && !memcmp(key.mv_data, (void *) prefix, (size_t) plen) && (key.mv_size == (size_t) plen || ((unsigned char *) key.mv_data)[plen] == 0x00)) {
+         if (!dbx_expired((char *) data.mv_data, data.mv_size)) {
+            live = 1;
+            break;
+         }
+         rc = pcon->p_lmdb_so->p_mdb_cursor_get(pcursor, &key, &data, MDB_NEXT);
+      }
+      pcon->p_lmdb_so->p_mdb_cursor_close(pcursor);
+      lmdb_commit_ro_transaction(pmeth, 0);
+   }
+
+   return live;
+}
+
+
 int dbx_global_directory(DBXMETH *pmeth, DBXQR *pqr_prev, short dir, int *counter)
 {
    int rc, eod;
@@ -7566,20 +14949,33 @@ __try {
       }
    }
 
-   if (pcon->dbtype == DBX_DBTYPE_BDB) {
-     if (dir == 1) {
-         rc = bdb_next(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+   for (;;) { /* v1.3.27 a global whose nodes have all expired (but not yet been swept) is passed over */
+      if (pcon->global_dbs) { /* v1.3.15 */
+         rc = dbx_global_db_order(pmeth, pqr_prev, dir);
       }
-      else {
-         rc = bdb_previous(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+      else if (pcon->dbtype == DBX_DBTYPE_BDB) {
+        if (dir == 1) {
+            rc = bdb_next(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+         }
+         else {
+            rc = bdb_previous(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+         }
       }
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-     if (dir == 1) {
-         rc = lmdb_next(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+      else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+        if (dir == 1) {
+            rc = lmdb_next(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+         }
+         else {
+            rc = lmdb_previous(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+         }
       }
-      else {
-         rc = lmdb_previous(pmeth, &(pqr_prev->key), &(pmeth->output_val), &(pqr_prev->data), 1);
+      if (rc != CACHE_SUCCESS || dbx_global_live(pmeth, pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used)) {
+         break;
+      }
+      if (pcon->global_dbs) { /* the next call continues from this global's name (the other modes continue from the key) */
+         memcpy((void *) pqr_prev->global_name.buf_addr, (void *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used);
+         pqr_prev->global_name.len_used = pmeth->output_val.svalue.len_used;
+         pqr_prev->global_name.buf_addr[pqr_prev->global_name.len_used] = '\0';
       }
    }
 
@@ -7678,6 +15074,10 @@ __try {
    if (rc == YDB_NODE_END || pmeth->output_val.svalue.len_used == 0) {
       eod = 1;
    }
+   if (getdata && !eod) {
+      /* v1.3.27 an escaped value is returned as it is (DBX_DTYPE_STR8), never as a typed value */
+      pqr_prev->data.type = (dbx_zunpack_inplace(&(pqr_prev->data.svalue)) == DBX_ZUNPACK_VERBATIM) ? DBX_DTYPE_STR8 : DBX_DTYPE_STR; /* v1.3.23 */
+   }
 
    if (pcon->log_transmissions == 2) {
       if (pmeth->output_val.svalue.len_used == 0)
@@ -7717,6 +15117,7 @@ int dbx_global_query(DBXMETH *pmeth, DBXQR *pqr_next, DBXQR *pqr_prev, short dir
 {
    int rc, n, eod;
    DBXCON *pcon = pmeth->pcon;
+   unsigned long long tstats = DBX_STATS_START(pcon, pmeth); /* v1.3.33 */
 
 #ifdef _WIN32
 __try {
@@ -7780,51 +15181,300 @@ __try {
          key.ulen = (u_int32_t) pqr_next->key.ibuffer.len_alloc;
       }
       else { /* mumps */
-         key0.data = (void *) pqr_prev->key.ibuffer.buf_addr;
-         key0.size = (u_int32_t) pqr_prev->key.ibuffer.len_used;
-         key0.ulen = (u_int32_t) pqr_prev->key.ibuffer.len_alloc;
+         key0.data = (void *) pqr_prev->key.ibuffer.buf_addr;
+         key0.size = (u_int32_t) pqr_prev->key.ibuffer.len_used;
+         key0.ulen = (u_int32_t) pqr_prev->key.ibuffer.len_alloc;
+         dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) pqr_prev->key.ibuffer.buf_addr, (size_t) pqr_prev->key.ibuffer.len_used);
+
+         pqr_next->key.ibuffer.len_used = pqr_prev->key.ibuffer.len_used;
+         key.data = (void *) pqr_next->key.ibuffer.buf_addr;
+         key.size = (u_int32_t) pqr_next->key.ibuffer.len_used;
+         key.ulen = (u_int32_t) pqr_next->key.ibuffer.len_alloc;
+      }
+
+      data.data = (void *) pqr_next->data.svalue.buf_addr;
+      data.ulen = (u_int32_t) pqr_next->data.svalue.len_alloc;
+
+      if (dir == 1) { /* get next */
+
+         if (pcon->key_type == DBX_KEYTYPE_M) {
+            /* dbx_dump_key((char *) key0.data, (int) key0.size); */
+            pqr_next->data.svalue.len_used = 0;
+            for (n = (*counter); n < ((*counter) + 5); n ++) {
+
+               if (n == 0) {
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
+               }
+               else {
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_NEXT); /* v1.3.9 */
+               }
+
+               if (rc != CACHE_SUCCESS) {
+                  pqr_next->key.args[0].svalue.len_used = 0;
+                  break;
+               }
+/*
+               printf("\r\ndbx_global_query (forward): n=%d; rc=%d; counter=%d; key.size=%d; pqr_prev->key.argc=%d", n, rc, *counter, (int) key.size, pqr_prev->key.argc);
+               dbx_dump_key((char *) key.data, (int) key.size);
+*/
+               if (!bdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
+
+                  if (!bdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get next */
+                     continue;
+                  }
+                  if (dbx_expired((char *) data.data, (size_t) data.size)) { /* v1.3.27 expired but not yet swept: move on (the seek, n == 0, is not repeated) */
+                     if (n > 0) {
+                        n --;
+                     }
+                     continue;
+                  }
+                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) key.data, (int) key.size);
+
+                  pqr_next->key.ibuffer.len_used = key.size;
+                  pqr_next->data.svalue.len_used = data.size;
+                  break;
+               }
+               else {
+                  pqr_next->key.args[0].svalue.len_used = 0;
+                  break;
+               }
+            }
+         }
+         else { /* not mumps */
+/*
+            printf("\r\ndbx_global_query (forward): counter=%d; key.size=%d; pqr_prev->key.argc=%d", *counter, (int) key.size, pqr_prev->key.argc);
+            dbx_dump_key((char *) key.data, (int) key.size);
+*/
+            if ((*counter) == 0) {
+               if (key.size == 0) {
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_FIRST); /* v1.3.9 */
+               }
+               else {
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
+                  if (rc == CACHE_SUCCESS && !bdb_key_compare(&key, &key0, 0, pcon->key_type)) {
+                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_NEXT); /* v1.3.9 */
+                  }
+               }
+            }
+            else {
+               rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_NEXT); /* v1.3.9 */
+            }
+/*
+            printf("\r\ndbx_global_query (forward): counter=%d; key.size=%d; pqr_prev->key.argc=%d; pqr_next->key.args[0].num.int32=%d", *counter, (int) key.size, pqr_prev->key.argc, pqr_next->key.args[0].num.int32);
+            dbx_dump_key((char *) key.data, (int) key.size);
+*/
+            if (rc == CACHE_SUCCESS) {
+               if (pcon->key_type == DBX_KEYTYPE_STR) {
+                  pqr_next->key.ibuffer.len_used = (unsigned int) key.size;
+                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.size;
+                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
+               }
+               else {
+                  sprintf((char *) pqr_next->key.ibuffer.buf_addr, "%d", pqr_next->key.args[0].num.int32);
+                  pqr_next->key.args[0].svalue.len_used = (unsigned int) strlen((char *) pqr_next->key.ibuffer.buf_addr);
+                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
+               }
+               pqr_next->key.argc = 1;
+               pqr_next->data.svalue.len_used = (unsigned int) data.size;
+            }
+            else {
+               pqr_next->key.args[0].svalue.len_used = 0;
+            }
+         }
+      }
+      else { /* get previous */
+         if (pcon->key_type == DBX_KEYTYPE_M) {
+/*
+            dbx_dump_key((char *) key0.data, (int) key0.size);
+*/
+            pqr_next->data.svalue.len_used = 0;
+            for (n = (*counter); n < ((*counter) + 5); n ++) {
+               if (n == 0) {
+                  *(((unsigned char *) key.data) + (key.size + 0)) = 0x00;
+                  *(((unsigned char *) key.data) + (key.size + 1)) = 0xff;
+                  key.size += 2;
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
+/*
+                  printf("\r\ndbx_global_query (reverse) DB_SET_RANGE: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.size, pqr_prev->key.argc);
+                  dbx_dump_key((char *) key.data, (int) key.size);
+*/
+                  if (rc != CACHE_SUCCESS) {
+                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_LAST); /* v1.3.9 */
+/*
+                     printf("\r\ndbx_global_query (reverse) DB_LAST: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.size, pqr_prev->key.argc);
+                     dbx_dump_key((char *) key.data, (int) key.size);
+*/
+                  }
+               }
+               else {
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_PREV); /* v1.3.9 */
+/*
+                  printf("\r\ndbx_global_query (reverse) DB_PREV: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.size, pqr_prev->key.argc);
+                  dbx_dump_key((char *) key.data, (int) key.size);
+*/
+               }
+
+               if (rc != CACHE_SUCCESS) {
+                  pqr_next->key.args[0].svalue.len_used = 0;
+                  break;
+               }
+
+               /* dbx_dump_key((char *) key.data, (int) key.size); */
+
+               if (!bdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
+                  if (!bdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get previous */
+                     continue;
+                  }
+                  if (dbx_expired((char *) data.data, (size_t) data.size)) { /* v1.3.27 expired but not yet swept: move on (the seek, n == 0, is not repeated) */
+                     if (n > 0) {
+                        n --;
+                     }
+                     continue;
+                  }
+                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) key.data, (int) key.size);
+                  pqr_next->key.ibuffer.len_used = key.size;
+                  pqr_next->data.svalue.len_used = data.size;
+                  break;
+               }
+               else {
+                  /* printf("\r\nPossibly next global/subscript in the chain"); */
+                  if (n > 0) { /* v1.3.27 only the seek can land beyond the range: a record before it ends the query */
+                     pqr_next->key.args[0].svalue.len_used = 0;
+                     break;
+                  }
+                  continue;
+               }
+            }
+         }
+         else {
+/*
+            printf("\r\ndbx_global_query (reverse): counter=%d; key.size=%d; pqr_prev->key.argc=%d", *counter, (int) key.size, pqr_prev->key.argc);
+            dbx_dump_key((char *) key.data, (int) key.size);
+*/
+            if ((*counter) == 0) {
+               if (key.size == 0) {
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_LAST); /* v1.3.9 */
+               }
+               else {
+                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
+                  if (rc == CACHE_SUCCESS) {
+                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_PREV); /* v1.3.9 */
+                  }
+                  else {
+                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_LAST); /* v1.3.9 */
+                  }
+               }
+            }
+            else {
+               rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_PREV); /* v1.3.9 */
+            }
+            if (rc == CACHE_SUCCESS) {
+              if (pcon->key_type == DBX_KEYTYPE_STR) {
+                  pqr_next->key.ibuffer.len_used = (unsigned int) key.size;
+                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.size;
+                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
+               }
+               else {
+                  sprintf((char *) pqr_next->key.ibuffer.buf_addr, "%d", pqr_next->key.args[0].num.int32);
+                  pqr_next->key.args[0].svalue.len_used = (unsigned int) strlen((char *) pqr_next->key.ibuffer.buf_addr);
+                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
+               }
+               pqr_next->key.argc = 1;
+               pqr_next->data.svalue.len_used = (unsigned int) data.size;
+            }
+            else {
+               pqr_next->key.args[0].svalue.len_used = 0;
+            }
+         }
+      }
+
+      if (pqr_next->key.args[0].svalue.len_used == 0) {
+         rc = YDB_NODE_END;
+      }
+      else {
+         (*counter) ++;
+      }
+
+      if (rc == YDB_NODE_END || rc != YDB_OK) {
+         eod = 1;
+         pqr_next->data.svalue.buf_addr[0] = '\0';
+         pqr_next->data.svalue.len_used = 0;
+         pqr_next->key.argc = 0;
+      }
+   }
+   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
+      MDB_val key, key0, data;
+
+      rc = CACHE_SUCCESS;
+      if (pcon->key_type == DBX_KEYTYPE_INT) {
+         key0.mv_data = &(pqr_prev->key.args[0].num.int32);
+         if (pqr_prev->key.args[0].svalue.len_used == 0)
+            key0.mv_size = 0;
+         else
+            key0.mv_size = sizeof(pqr_prev->key.args[0].num.int32);
+
+         pqr_next->key.args[0].num.int32 = pqr_prev->key.args[0].num.int32;
+         key.mv_data = &(pqr_next->key.args[0].num.int32);
+         if (pqr_prev->key.args[0].svalue.len_used == 0)
+            key.mv_size = 0;
+         else
+            key.mv_size = sizeof(pqr_prev->key.args[0].num.int32);
+      }
+      else if (pcon->key_type == DBX_KEYTYPE_STR) {
+         if ((*counter) == 0) {
+            key0.mv_data = (void *) pqr_prev->key.ibuffer.buf_addr;
+            key0.mv_size = (size_t) pqr_prev->key.ibuffer.len_used;
+            dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) pqr_prev->key.ibuffer.buf_addr, (size_t) pqr_prev->key.ibuffer.len_used);
+            pqr_next->key.ibuffer.len_used = pqr_prev->key.ibuffer.len_used;
+         }
+         key.mv_data = (void *) pqr_next->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pqr_next->key.ibuffer.len_used;
+      }
+      else { /* mumps */
+         key0.mv_data = (void *) pqr_prev->key.ibuffer.buf_addr;
+         key0.mv_size = (size_t) pqr_prev->key.ibuffer.len_used;
          dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) pqr_prev->key.ibuffer.buf_addr, (size_t) pqr_prev->key.ibuffer.len_used);
-
          pqr_next->key.ibuffer.len_used = pqr_prev->key.ibuffer.len_used;
-         key.data = (void *) pqr_next->key.ibuffer.buf_addr;
-         key.size = (u_int32_t) pqr_next->key.ibuffer.len_used;
-         key.ulen = (u_int32_t) pqr_next->key.ibuffer.len_alloc;
+         key.mv_data = (void *) pqr_next->key.ibuffer.buf_addr;
+         key.mv_size = (size_t) pqr_next->key.ibuffer.len_used;
       }
 
-      data.data = (void *) pqr_next->data.svalue.buf_addr;
-      data.ulen = (u_int32_t) pqr_next->data.svalue.len_alloc;
+      data.mv_data = (void *) pqr_next->data.svalue.buf_addr;
+      data.mv_size = (size_t) pqr_next->data.svalue.len_alloc;
 
       if (dir == 1) { /* get next */
 
          if (pcon->key_type == DBX_KEYTYPE_M) {
-            /* dbx_dump_key((char *) key0.data, (int) key0.size); */
+            /* dbx_dump_key((char *) key0.mv_data, (int) key0.mv_size); */
             pqr_next->data.svalue.len_used = 0;
             for (n = (*counter); n < ((*counter) + 5); n ++) {
-
-               if (n == 0) {
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
-               }
-               else {
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_NEXT); /* v1.3.9 */
-               }
+               if (n == 0)
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
+               else
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_NEXT);
 
                if (rc != CACHE_SUCCESS) {
                   pqr_next->key.args[0].svalue.len_used = 0;
                   break;
                }
-/*
-               printf("\r\ndbx_global_query (forward): n=%d; rc=%d; counter=%d; key.size=%d; pqr_prev->key.argc=%d", n, rc, *counter, (int) key.size, pqr_prev->key.argc);
-               dbx_dump_key((char *) key.data, (int) key.size);
-*/
-               if (!bdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
 
-                  if (!bdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get next */
+               if (!lmdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
+                  if (!lmdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get next */
                      continue;
                   }
-                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) key.data, (int) key.size);
-
-                  pqr_next->key.ibuffer.len_used = key.size;
-                  pqr_next->data.svalue.len_used = data.size;
+                  if (dbx_expired((char *) data.mv_data, data.mv_size)) { /* v1.3.27 expired but not yet swept: move on (the seek, n == 0, is not repeated) */
+                     if (n > 0) {
+                        n --;
+                     }
+                     continue;
+                  }
+                  dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) key.mv_data, (size_t) key.mv_size); /* v1.3.27 the next call seeks from this key */
+                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
+                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) pqr_next->key.ibuffer.buf_addr, (int) key.mv_size);
+                  if (!getdata || !lmdb_chunk_str(pmeth, NULL, 0, pmeth->plmdbcursor, &key, &data, &(pqr_next->data.svalue))) { /* v1.3.22 */
+                     pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
+                     dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
+                  }
                   break;
                }
                else {
@@ -7835,40 +15485,40 @@ __try {
          }
          else { /* not mumps */
 /*
-            printf("\r\ndbx_global_query (forward): counter=%d; key.size=%d; pqr_prev->key.argc=%d", *counter, (int) key.size, pqr_prev->key.argc);
-            dbx_dump_key((char *) key.data, (int) key.size);
+            printf("\r\ndbx_global_query (forward): counter=%d; key.mv_size=%d; pqr_prev->key.argc=%d", *counter, (int) key.mv_size, pqr_prev->key.argc);
+            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
 */
             if ((*counter) == 0) {
-               if (key.size == 0) {
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_FIRST); /* v1.3.9 */
+               if (key.mv_size == 0) {
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_FIRST);
                }
                else {
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
-                  if (rc == CACHE_SUCCESS && !bdb_key_compare(&key, &key0, 0, pcon->key_type)) {
-                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_NEXT); /* v1.3.9 */
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
+                  if (rc == CACHE_SUCCESS && !lmdb_key_compare(&key, &key0, 0, pcon->key_type)) {
+                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_NEXT);
                   }
                }
             }
             else {
-               rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_NEXT); /* v1.3.9 */
+               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_NEXT);
             }
-/*
-            printf("\r\ndbx_global_query (forward): counter=%d; key.size=%d; pqr_prev->key.argc=%d; pqr_next->key.args[0].num.int32=%d", *counter, (int) key.size, pqr_prev->key.argc, pqr_next->key.args[0].num.int32);
-            dbx_dump_key((char *) key.data, (int) key.size);
-*/
+
             if (rc == CACHE_SUCCESS) {
                if (pcon->key_type == DBX_KEYTYPE_STR) {
-                  pqr_next->key.ibuffer.len_used = (unsigned int) key.size;
-                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.size;
+                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
+                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.mv_size;
+                  dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) key.mv_data, (size_t) key.mv_size);
                   pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
                }
                else {
+                  pqr_next->key.args[0].num.int32 = (int) dbx_get_size((unsigned char *) key.mv_data, 0);
                   sprintf((char *) pqr_next->key.ibuffer.buf_addr, "%d", pqr_next->key.args[0].num.int32);
                   pqr_next->key.args[0].svalue.len_used = (unsigned int) strlen((char *) pqr_next->key.ibuffer.buf_addr);
                   pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
                }
                pqr_next->key.argc = 1;
-               pqr_next->data.svalue.len_used = (unsigned int) data.size;
+               pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
+               dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
             }
             else {
                pqr_next->key.args[0].svalue.len_used = 0;
@@ -7883,27 +15533,28 @@ __try {
             pqr_next->data.svalue.len_used = 0;
             for (n = (*counter); n < ((*counter) + 5); n ++) {
                if (n == 0) {
-                  *(((unsigned char *) key.data) + (key.size + 0)) = 0x00;
-                  *(((unsigned char *) key.data) + (key.size + 1)) = 0xff;
-                  key.size += 2;
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
+                  *(((unsigned char *) key.mv_data) + (key.mv_size + 0)) = 0x00;
+                  *(((unsigned char *) key.mv_data) + (key.mv_size + 1)) = 0xff;
+                  key.mv_size += 2;
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
+
 /*
-                  printf("\r\ndbx_global_query (reverse) DB_SET_RANGE: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.size, pqr_prev->key.argc);
-                  dbx_dump_key((char *) key.data, (int) key.size);
+                  printf("\r\ndbx_global_query (reverse) DB_SET_RANGE: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.mv_size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.mv_size, pqr_prev->key.argc);
+                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
 */
                   if (rc != CACHE_SUCCESS) {
-                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_LAST); /* v1.3.9 */
+                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_LAST);
 /*
-                     printf("\r\ndbx_global_query (reverse) DB_LAST: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.size, pqr_prev->key.argc);
-                     dbx_dump_key((char *) key.data, (int) key.size);
+                     printf("\r\ndbx_global_query (reverse) DB_LAST: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.mv_size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.mv_size, pqr_prev->key.argc);
+                     dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
 */
                   }
                }
                else {
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_PREV); /* v1.3.9 */
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_PREV);
 /*
-                  printf("\r\ndbx_global_query (reverse) DB_PREV: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.size, pqr_prev->key.argc);
-                  dbx_dump_key((char *) key.data, (int) key.size);
+                  printf("\r\ndbx_global_query (reverse) DB_PREV: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.mv_size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.mv_size, pqr_prev->key.argc);
+                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
 */
                }
 
@@ -7914,56 +15565,73 @@ __try {
 
                /* dbx_dump_key((char *) key.data, (int) key.size); */
 
-               if (!bdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
-                  if (!bdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get previous */
+               if (!lmdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
+                  if (!lmdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get previous */
                      continue;
                   }
-                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) key.data, (int) key.size);
-                  pqr_next->key.ibuffer.len_used = key.size;
-                  pqr_next->data.svalue.len_used = data.size;
+                  if (dbx_expired((char *) data.mv_data, data.mv_size)) { /* v1.3.27 expired but not yet swept: move on (the seek, n == 0, is not repeated) */
+                     if (n > 0) {
+                        n --;
+                     }
+                     continue;
+                  }
+                  dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) key.mv_data, (size_t) key.mv_size); /* v1.3.27 the next call seeks from this key */
+                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
+                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) pqr_next->key.ibuffer.buf_addr, (int) key.mv_size);
+                  if (!getdata || !lmdb_chunk_str(pmeth, NULL, 0, pmeth->plmdbcursor, &key, &data, &(pqr_next->data.svalue))) { /* v1.3.22 */
+                     pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
+                     dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
+                  }
                   break;
                }
                else {
                   /* printf("\r\nPossibly next global/subscript in the chain"); */
+                  if (n > 0) { /* v1.3.27 only the seek can land beyond the range: a record before it ends the query */
+                     pqr_next->key.args[0].svalue.len_used = 0;
+                     break;
+                  }
                   continue;
                }
             }
          }
-         else {
+         else { /* not mumps */
 /*
-            printf("\r\ndbx_global_query (reverse): counter=%d; key.size=%d; pqr_prev->key.argc=%d", *counter, (int) key.size, pqr_prev->key.argc);
-            dbx_dump_key((char *) key.data, (int) key.size);
+            printf("\r\ndbx_global_query (reverse): counter=%d; key.mv_size=%d; pqr_prev->key.argc=%d", *counter, (int) key.mv_size, pqr_prev->key.argc);
+            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
 */
             if ((*counter) == 0) {
-               if (key.size == 0) {
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_LAST); /* v1.3.9 */
+               if (key.mv_size == 0) {
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_LAST);
                }
                else {
-                  rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_SET_RANGE); /* v1.3.9 */
+                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
                   if (rc == CACHE_SUCCESS) {
-                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_PREV); /* v1.3.9 */
+                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_PREV);
                   }
                   else {
-                     rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_LAST); /* v1.3.9 */
+                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_LAST);
                   }
                }
             }
             else {
-               rc = bdb_cursor_get(pmeth->pbdbcursor, &key, &(pqr_next->key.ibuffer), &data, &(pqr_next->data.svalue), DB_PREV); /* v1.3.9 */
+               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_PREV);
             }
             if (rc == CACHE_SUCCESS) {
               if (pcon->key_type == DBX_KEYTYPE_STR) {
-                  pqr_next->key.ibuffer.len_used = (unsigned int) key.size;
-                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.size;
+                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
+                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.mv_size;
+                  dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) key.mv_data, (size_t) key.mv_size);
                   pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
                }
                else {
+                  pqr_next->key.args[0].num.int32 = (int) dbx_get_size((unsigned char *) key.mv_data, 0);
                   sprintf((char *) pqr_next->key.ibuffer.buf_addr, "%d", pqr_next->key.args[0].num.int32);
                   pqr_next->key.args[0].svalue.len_used = (unsigned int) strlen((char *) pqr_next->key.ibuffer.buf_addr);
                   pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
                }
                pqr_next->key.argc = 1;
-               pqr_next->data.svalue.len_used = (unsigned int) data.size;
+               pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
+               dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
             }
             else {
                pqr_next->key.args[0].svalue.len_used = 0;
@@ -7971,1105 +15639,1524 @@ __try {
          }
       }
 
-      if (pqr_next->key.args[0].svalue.len_used == 0) {
-         rc = YDB_NODE_END;
+      if (pqr_next->key.args[0].svalue.len_used == 0) {
+         rc = YDB_NODE_END;
+      }
+      else {
+         (*counter) ++;
+      }
+
+      if (rc == YDB_NODE_END || rc != YDB_OK) {
+         eod = 1;
+         pqr_next->data.svalue.buf_addr[0] = '\0';
+         pqr_next->data.svalue.len_used = 0;
+         pqr_next->key.argc = 0;
+      }
+   }
+   else {
+      rc = YDB_NODE_END;
+   }
+
+   if (rc != CACHE_SUCCESS && rc != YDB_NODE_END) {
+      dbx_error_message(pmeth, rc, (char *) "dbx_global_query");
+   }
+   if (getdata && !eod) {
+      /* v1.3.27 an escaped value is returned as it is (DBX_DTYPE_STR8), never as a typed value */
+      pqr_next->data.type = (dbx_zunpack_inplace(&(pqr_next->data.svalue)) == DBX_ZUNPACK_VERBATIM) ? DBX_DTYPE_STR8 : DBX_DTYPE_STR; /* v1.3.23 */
+   }
+
+   if (pcon->log_transmissions == 2) {
+      if (eod)
+         dbx_log_response(pcon, (char *) "[END]", (int) 5, (char *) (dir == 1 ? "mcursor::next (query)" : "mcursor::previous (query)"));
+      else {
+         int nx;
+         v8::Local<v8::String> str;
+
+         pmeth->key.ibuffer.len_used = 0;
+         nx = 0;
+         dbx_ibuffer_add(pmeth, &(pmeth->key), NULL, nx ++, str, pqr_next->global_name.buf_addr, pqr_next->global_name.len_used, 0);
+         for (n = 0; n < pqr_next->key.argc; n ++) {
+            dbx_ibuffer_add(pmeth, &(pmeth->key), NULL, nx ++, str, (char *) pqr_next->key.args[n].svalue.buf_addr, (int) pqr_next->key.args[n].svalue.len_used, 0);
+         }
+         dbx_log_response(pcon, (char *) pmeth->key.ibuffer.buf_addr, (int) pmeth->key.ibuffer.len_used, (char *) (dir == 1 ? "mcursor::next (query)" : "mcursor::previous (query)"));
+         pmeth->key.ibuffer.len_used = 0;
+      }
+   }
+
+   if (rc != CACHE_SUCCESS && rc != YDB_NODE_END) {
+      pcon->error_code = rc;
+   }
+   DBX_STATS_END(pmeth, DBX_STATS_QUERY, tstats, (rc == YDB_NODE_END) ? CACHE_SUCCESS : rc);
+   return eod;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_global_query: %x", code);
+      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return CACHE_FAILURE;
+}
+#endif
+}
+
+
+int dbx_display_key(char *key, int key_size, char *buffer)
+{
+   int n, n1;
+   char hex[16];
+
+   n1 = 0;
+   for (n = 0; n < key_size; n ++) {
+      if ((int) *(((char *) key) + n) < 32 || (int) *(((char *) key) + n) > 126) {
+         sprintf(hex, "%02x", (unsigned char) *(((char *) key) + n));
+         buffer[n1 ++] = '\\';
+         buffer[n1 ++] = 'x';
+         buffer[n1 ++] = hex[0];
+         buffer[n1 ++] = hex[1];
+      }
+      else {
+         buffer[n1 ++] = *(((char *) key) + n);
+      }
+   }
+   buffer[n1] = '\0';
+
+   return 0;
+}
+
+
+int cache_report_failure(DBXCON *pcon)
+{
+
+   if (pcon->error_code == 0) {
+      pcon->error_code = 10001;
+      T_STRCPY(pcon->error, _dbxso(pcon->error), DBX_TEXT_E_ASYNC);
+   }
+
+   return 0;
+}
+
+
+/* ASYNC THREAD : Do the Cache task */
+int dbx_launch_thread(DBXMETH *pmeth)
+{
+#if !defined(_WIN32)
+
+   dbx_pool_submit_task(pmeth);
+
+   return 1;
+
+#else
+
+   {
+      int rc = 0;
+#if defined(_WIN32)
+      HANDLE hthread;
+      SIZE_T stack_size;
+      DWORD thread_id, cre_flags, result;
+      LPSECURITY_ATTRIBUTES pattr;
+
+      stack_size = 0;
+      cre_flags = 0;
+      pattr = NULL;
+
+      hthread = CreateThread(pattr, stack_size, (LPTHREAD_START_ROUTINE) dbx_thread_main, (LPVOID) pmeth, cre_flags, &thread_id);
+/*
+      printf("\r\n*** %lu Primary Thread : CreateThread (%d) ...", (unsigned long) dbx_current_thread_id(), dbx_queue_size);
+*/
+      if (!hthread) {
+         printf("failed to create thread, errno = %d\n",errno);
       }
       else {
-         (*counter) ++;
+         result = WaitForSingleObject(hthread, INFINITE);
       }
+#else
+      pthread_attr_t attr;
+      pthread_t child_thread;
 
-      if (rc == YDB_NODE_END || rc != YDB_OK) {
-         eod = 1;
-         pqr_next->data.svalue.buf_addr[0] = '\0';
-         pqr_next->data.svalue.len_used = 0;
-         pqr_next->key.argc = 0;
-      }
-   }
-   else if (pcon->dbtype == DBX_DBTYPE_LMDB) {
-      MDB_val key, key0, data;
+      size_t stacksize, newstacksize;
 
-      rc = CACHE_SUCCESS;
-      if (pcon->key_type == DBX_KEYTYPE_INT) {
-         key0.mv_data = &(pqr_prev->key.args[0].num.int32);
-         if (pqr_prev->key.args[0].svalue.len_used == 0)
-            key0.mv_size = 0;
-         else
-            key0.mv_size = sizeof(pqr_prev->key.args[0].num.int32);
+      pthread_attr_init(&attr);
 
-         pqr_next->key.args[0].num.int32 = pqr_prev->key.args[0].num.int32;
-         key.mv_data = &(pqr_next->key.args[0].num.int32);
-         if (pqr_prev->key.args[0].svalue.len_used == 0)
-            key.mv_size = 0;
-         else
-            key.mv_size = sizeof(pqr_prev->key.args[0].num.int32);
-      }
-      else if (pcon->key_type == DBX_KEYTYPE_STR) {
-         if ((*counter) == 0) {
-            key0.mv_data = (void *) pqr_prev->key.ibuffer.buf_addr;
-            key0.mv_size = (size_t) pqr_prev->key.ibuffer.len_used;
-            dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) pqr_prev->key.ibuffer.buf_addr, (size_t) pqr_prev->key.ibuffer.len_used);
-            pqr_next->key.ibuffer.len_used = pqr_prev->key.ibuffer.len_used;
-         }
-         key.mv_data = (void *) pqr_next->key.ibuffer.buf_addr;
-         key.mv_size = (size_t) pqr_next->key.ibuffer.len_used;
+      stacksize = 0;
+      pthread_attr_getstacksize(&attr, &stacksize);
+
+      newstacksize = DBX_THREAD_STACK_SIZE;
+
+      pthread_attr_setstacksize(&attr, newstacksize);
+/*
+      printf("Thread: default stack=%lu; new stack=%lu;\n", (unsigned long) stacksize, (unsigned long) newstacksize);
+*/
+      rc = pthread_create(&child_thread, &attr, dbx_thread_main, (void *) pmeth);
+      if (rc) {
+         printf("failed to create thread, errno = %d\n",errno);
       }
-      else { /* mumps */
-         key0.mv_data = (void *) pqr_prev->key.ibuffer.buf_addr;
-         key0.mv_size = (size_t) pqr_prev->key.ibuffer.len_used;
-         dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) pqr_prev->key.ibuffer.buf_addr, (size_t) pqr_prev->key.ibuffer.len_used);
-         pqr_next->key.ibuffer.len_used = pqr_prev->key.ibuffer.len_used;
-         key.mv_data = (void *) pqr_next->key.ibuffer.buf_addr;
-         key.mv_size = (size_t) pqr_next->key.ibuffer.len_used;
+      else {
+         rc = pthread_join(child_thread,NULL);
       }
+#endif
+   }
 
-      data.mv_data = (void *) pqr_next->data.svalue.buf_addr;
-      data.mv_size = (size_t) pqr_next->data.svalue.len_alloc;
-
-      if (dir == 1) { /* get next */
+#endif
 
-         if (pcon->key_type == DBX_KEYTYPE_M) {
-            /* dbx_dump_key((char *) key0.mv_data, (int) key0.mv_size); */
-            pqr_next->data.svalue.len_used = 0;
-            for (n = (*counter); n < ((*counter) + 5); n ++) {
-               if (n == 0)
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
-               else
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_NEXT);
+   return 1;
+}
 
-               if (rc != CACHE_SUCCESS) {
-                  pqr_next->key.args[0].svalue.len_used = 0;
-                  break;
-               }
 
-               if (!lmdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
-                  if (!lmdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get next */
-                     continue;
-                  }
-                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) key.mv_data, (int) key.mv_size);
-                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
-                  pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
-                  dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
-                  break;
-               }
-               else {
-                  pqr_next->key.args[0].svalue.len_used = 0;
-                  break;
-               }
-            }
-         }
-         else { /* not mumps */
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE dbx_thread_main(LPVOID pargs)
+#else
+void * dbx_thread_main(void *pargs)
+#endif
+{
+   DBXMETH *pmeth;
 /*
-            printf("\r\ndbx_global_query (forward): counter=%d; key.mv_size=%d; pqr_prev->key.argc=%d", *counter, (int) key.mv_size, pqr_prev->key.argc);
-            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+   printf("\r\n*** %lu Worker Thread : Thread (%d) ...", (unsigned long) dbx_current_thread_id(), dbx_queue_size);
 */
-            if ((*counter) == 0) {
-               if (key.mv_size == 0) {
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_FIRST);
-               }
-               else {
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
-                  if (rc == CACHE_SUCCESS && !lmdb_key_compare(&key, &key0, 0, pcon->key_type)) {
-                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_NEXT);
-                  }
-               }
-            }
-            else {
-               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_NEXT);
-            }
+   pmeth = (DBXMETH *) pargs;
 
-            if (rc == CACHE_SUCCESS) {
-               if (pcon->key_type == DBX_KEYTYPE_STR) {
-                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
-                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.mv_size;
-                  dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) key.mv_data, (size_t) key.mv_size);
-                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
-               }
-               else {
-                  pqr_next->key.args[0].num.int32 = (int) dbx_get_size((unsigned char *) key.mv_data, 0);
-                  sprintf((char *) pqr_next->key.ibuffer.buf_addr, "%d", pqr_next->key.args[0].num.int32);
-                  pqr_next->key.args[0].svalue.len_used = (unsigned int) strlen((char *) pqr_next->key.ibuffer.buf_addr);
-                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
-               }
-               pqr_next->key.argc = 1;
-               pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
-               dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
-            }
-            else {
-               pqr_next->key.args[0].svalue.len_used = 0;
-            }
-         }
+   pmeth->p_dbxfun(pmeth);
+
+#if defined(_WIN32)
+   return 0;
+#else
+   return NULL;
+#endif
+}
+
+
+struct dbx_pool_task* dbx_pool_add_task(DBXMETH *pmeth)
+{
+   struct dbx_pool_task* enqueue_task;
+
+   enqueue_task = (struct dbx_pool_task*) dbx_malloc(sizeof(struct dbx_pool_task), DBX_MEMID_TASK);
+
+   if (!enqueue_task) {
+      dbx_request_errors ++;
+      return NULL;
+   }
+
+   enqueue_task->task_id = 6;
+   enqueue_task->pmeth = pmeth;
+   enqueue_task->next = NULL;
+
+#if !defined(_WIN32)
+   enqueue_task->parent_tid = pthread_self();
+
+   dbx_pool_mutex_lock(&dbx_task_queue_mutex, &dbx_task_queue_lstats);
+
+   if (dbx_total_tasks == 0) {
+      tasks = enqueue_task;
+      bottom_task = enqueue_task;
+   }
+   else {
+      bottom_task->next = enqueue_task;
+      bottom_task = enqueue_task;
+   }
+
+   dbx_total_tasks ++;
+
+   dbx_pool_mutex_unlock(&dbx_task_queue_mutex, &dbx_task_queue_lstats);
+   pthread_cond_signal(&dbx_pool_cond);
+#endif
+
+   return enqueue_task;
+}
+
+
+struct dbx_pool_task * dbx_pool_get_task(void)
+{
+   struct dbx_pool_task* task;
+
+#if !defined(_WIN32)
+   dbx_pool_mutex_lock(&dbx_task_queue_mutex, &dbx_task_queue_lstats);
+#endif
+
+   if (dbx_total_tasks > 0) {
+      task = tasks;
+      tasks = task->next;
+
+      if (tasks == NULL) {
+         bottom_task = NULL;
       }
-      else { /* get previous */
-         if (pcon->key_type == DBX_KEYTYPE_M) {
-/*
-            dbx_dump_key((char *) key0.data, (int) key0.size);
-*/
-            pqr_next->data.svalue.len_used = 0;
-            for (n = (*counter); n < ((*counter) + 5); n ++) {
-               if (n == 0) {
-                  *(((unsigned char *) key.mv_data) + (key.mv_size + 0)) = 0x00;
-                  *(((unsigned char *) key.mv_data) + (key.mv_size + 1)) = 0xff;
-                  key.mv_size += 2;
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
+      dbx_total_tasks --;
+   }
+   else {
+      task = NULL;
+   }
+
+#if !defined(_WIN32)
+   dbx_pool_mutex_unlock(&dbx_task_queue_mutex, &dbx_task_queue_lstats);
+#endif
+
+   return task;
+}
+
+
+void dbx_pool_execute_task(struct dbx_pool_task *task, int thread_id)
+{
+   if (task) {
+
+      task->pmeth->p_dbxfun(task->pmeth);
+
+      task->pmeth->done = 1;
+
+#if !defined(_WIN32)
+      pthread_cond_broadcast(&dbx_result_cond);
+#endif
+   }
+}
 
-/*
-                  printf("\r\ndbx_global_query (reverse) DB_SET_RANGE: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.mv_size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.mv_size, pqr_prev->key.argc);
-                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-                  if (rc != CACHE_SUCCESS) {
-                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_LAST);
-/*
-                     printf("\r\ndbx_global_query (reverse) DB_LAST: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.mv_size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.mv_size, pqr_prev->key.argc);
-                     dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-                  }
-               }
-               else {
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_PREV);
-/*
-                  printf("\r\ndbx_global_query (reverse) DB_PREV: n=%d; counter=%d; fixed_key_len=%d; rc=%d; key.mv_size=%d; pqr_prev->key.argc=%d", n, *counter, *fixed_key_len, rc, (int) key.mv_size, pqr_prev->key.argc);
-                  dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
-*/
-               }
 
-               if (rc != CACHE_SUCCESS) {
-                  pqr_next->key.args[0].svalue.len_used = 0;
-                  break;
-               }
+void * dbx_pool_requests_loop(void *data)
+{
+   int thread_id;
+   DBXTID *ptid;
+   struct dbx_pool_task *task = NULL;
 
-               /* dbx_dump_key((char *) key.data, (int) key.size); */
+   ptid = (DBXTID *) data;
+   if (!ptid) {
+      return NULL;
+   }
+
+   thread_id = ptid->thread_id;
 
-               if (!lmdb_key_compare(&key, &key0, *(fixed_key_len), pcon->key_type)) {
-                  if (!lmdb_key_compare(&key, &key0, 0, pcon->key_type)) { /* current key returned - get previous */
-                     continue;
-                  }
-                  pqr_next->key.argc = dbx_split_key(&(pqr_next->key.args[0]), (char *) key.mv_data, (int) key.mv_size);
-                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
-                  pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
-                  dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
-                  break;
-               }
-               else {
-                  /* printf("\r\nPossibly next global/subscript in the chain"); */
-                  continue;
-               }
-            }
-         }
-         else { /* not mumps */
 /*
-            printf("\r\ndbx_global_query (reverse): counter=%d; key.mv_size=%d; pqr_prev->key.argc=%d", *counter, (int) key.mv_size, pqr_prev->key.argc);
-            dbx_dump_key((char *) key.mv_data, (int) key.mv_size);
+#if !defined(_WIN32)
+{
+   int ret;
+   pthread_attr_t tattr;
+   size_t size;
+   ret = pthread_getattr_np(pthread_self(), &tattr);
+   ret = pthread_attr_getstacksize(&tattr, &size);
+   printf("\r\n*** pthread_attr_getstacksize (pool) %x *** ret=%d; size=%u\r\n", (unsigned long) pthread_self(), ret, size);
+}
+#endif
 */
-            if ((*counter) == 0) {
-               if (key.mv_size == 0) {
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_LAST);
-               }
-               else {
-                  rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_SET_RANGE);
-                  if (rc == CACHE_SUCCESS) {
-                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_PREV);
-                  }
-                  else {
-                     rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_LAST);
-                  }
-               }
-            }
-            else {
-               rc = pcon->p_lmdb_so->p_mdb_cursor_get(pmeth->plmdbcursor, &key, &data, MDB_PREV);
-            }
-            if (rc == CACHE_SUCCESS) {
-              if (pcon->key_type == DBX_KEYTYPE_STR) {
-                  pqr_next->key.ibuffer.len_used = (unsigned int) key.mv_size;
-                  pqr_next->key.args[0].svalue.len_used = (unsigned int) key.mv_size;
-                  dbx_memcpy_exx(&(pqr_next->key.ibuffer), (void *) key.mv_data, (size_t) key.mv_size);
-                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
-               }
-               else {
-                  pqr_next->key.args[0].num.int32 = (int) dbx_get_size((unsigned char *) key.mv_data, 0);
-                  sprintf((char *) pqr_next->key.ibuffer.buf_addr, "%d", pqr_next->key.args[0].num.int32);
-                  pqr_next->key.args[0].svalue.len_used = (unsigned int) strlen((char *) pqr_next->key.ibuffer.buf_addr);
-                  pqr_next->key.args[0].svalue.buf_addr = (char *) pqr_next->key.ibuffer.buf_addr;
-               }
-               pqr_next->key.argc = 1;
-               pqr_next->data.svalue.len_used = (unsigned int) data.mv_size;
-               dbx_memcpy_exx(&(pqr_next->data.svalue), (void *) data.mv_data, (size_t) pqr_next->data.svalue.len_used);
-            }
-            else {
-               pqr_next->key.args[0].svalue.len_used = 0;
-            }
-         }
-      }
 
-      if (pqr_next->key.args[0].svalue.len_used == 0) {
-         rc = YDB_NODE_END;
+#if !defined(_WIN32)
+   dbx_pool_mutex_lock(&dbx_pool_mutex, &dbx_pool_lstats);
+
+   while (1) {
+      if (dbx_total_tasks > 0) {
+         task = dbx_pool_get_task();
+         if (task) {
+            dbx_pool_mutex_unlock(&dbx_pool_mutex, &dbx_pool_lstats);
+            dbx_pool_execute_task(task, thread_id);
+            dbx_free(task, DBX_MEMID_TASK);
+            dbx_pool_mutex_lock(&dbx_pool_mutex, &dbx_pool_lstats);
+         }
       }
       else {
-         (*counter) ++;
+         /* v1.3.37 the mutex is not held while waiting for work */
+         dbx_lock_stats_released(&dbx_pool_lstats);
+         pthread_cond_wait(&dbx_pool_cond, &dbx_pool_mutex);
+         if (dbx_lock_stats_enabled) {
+            dbx_pool_lstats.tacquired = dbx_clock_ns();
+         }
       }
+   }
+#endif
 
-      if (rc == YDB_NODE_END || rc != YDB_OK) {
-         eod = 1;
-         pqr_next->data.svalue.buf_addr[0] = '\0';
-         pqr_next->data.svalue.len_used = 0;
-         pqr_next->key.argc = 0;
+   return NULL;
+}
+
+
+int dbx_pool_thread_init(DBXCON *pcon, int num_threads)
+{
+#if !defined(_WIN32)
+   int iterator;
+   pthread_attr_t attr[DBX_THREADPOOL_MAX];
+   size_t stacksize, newstacksize;
+
+   for (iterator = 0; iterator < num_threads; iterator ++) {
+
+      pthread_attr_init(&attr[iterator]);
+
+      stacksize = 0;
+      pthread_attr_getstacksize(&attr[iterator], &stacksize);
+
+      newstacksize = DBX_THREAD_STACK_SIZE;
+/*
+      printf("Thread Pool: default stack=%lu; new stack=%lu;\n", (unsigned long) stacksize, (unsigned long) newstacksize);
+*/
+      pthread_attr_setstacksize(&attr[iterator], newstacksize);
+
+      dbx_thr_id[iterator].thread_id = iterator;
+      dbx_thr_id[iterator].p_mutex = pcon->p_mutex;
+      dbx_thr_id[iterator].p_zv = pcon->p_zv;
+      
+      pthread_create(&dbx_p_threads[iterator], &attr[iterator], dbx_pool_requests_loop, (void *) &dbx_thr_id[iterator]);
+
+   }
+#endif
+   return 0;
+}
+
+
+int dbx_pool_submit_task(DBXMETH *pmeth)
+{
+#if !defined(_WIN32)
+   struct timespec   ts;
+   struct timeval    tp;
+
+   pmeth->done = 0;
+
+   dbx_pool_add_task(pmeth);
+
+   dbx_pool_mutex_lock(&dbx_result_mutex, &dbx_result_lstats);
+
+   while (!pmeth->done) {
+
+      gettimeofday(&tp, NULL);
+      ts.tv_sec  = tp.tv_sec;
+      ts.tv_nsec = tp.tv_usec * 1000;
+      ts.tv_sec += 3;
+
+      /* v1.3.37 the mutex is not held while waiting for the result */
+      dbx_lock_stats_released(&dbx_result_lstats);
+      pthread_cond_timedwait(&dbx_result_cond, &dbx_result_mutex, &ts);
+      if (dbx_lock_stats_enabled) {
+         dbx_result_lstats.tacquired = dbx_clock_ns();
       }
    }
-   else {
-      rc = YDB_NODE_END;
+
+   dbx_pool_mutex_unlock(&dbx_result_mutex, &dbx_result_lstats);
+#endif
+   return 1;
+}
+
+
+int dbx_add_block_size(unsigned char *block, unsigned long offset, unsigned long data_len, int dsort, int dtype)
+{
+   dbx_set_size((unsigned char *) block + offset, data_len, 0);
+   block[offset + 4] = (unsigned char) ((dsort * 20) + dtype);
+
+   return 1;
+}
+
+
+unsigned long dbx_get_block_size(unsigned char *block, unsigned long offset, int *dsort, int *dtype)
+{
+   unsigned long data_len;
+   unsigned char uc;
+
+   data_len = 0;
+   uc = (unsigned char) block[offset + 4];
+
+   *dtype = uc % 20;
+   *dsort = uc / 20;
+
+   if (*dsort != DBX_DSORT_STATUS) {
+      data_len = dbx_get_size((unsigned char *) block + offset, 0);
    }
 
-   if (rc != CACHE_SUCCESS && rc != YDB_NODE_END) {
-      dbx_error_message(pmeth, rc, (char *) "dbx_global_query");
+   if (!DBX_DSORT_ISVALID(*dsort)) {
+      *dsort = DBX_DSORT_INVALID;
    }
 
-   if (pcon->log_transmissions == 2) {
-      if (eod)
-         dbx_log_response(pcon, (char *) "[END]", (int) 5, (char *) (dir == 1 ? "mcursor::next (query)" : "mcursor::previous (query)"));
-      else {
-         int nx;
-         v8::Local<v8::String> str;
+   return data_len;
+}
 
-         pmeth->key.ibuffer.len_used = 0;
-         nx = 0;
-         dbx_ibuffer_add(pmeth, &(pmeth->key), NULL, nx ++, str, pqr_next->global_name.buf_addr, pqr_next->global_name.len_used, 0);
-         for (n = 0; n < pqr_next->key.argc; n ++) {
-            dbx_ibuffer_add(pmeth, &(pmeth->key), NULL, nx ++, str, (char *) pqr_next->key.args[n].svalue.buf_addr, (int) pqr_next->key.args[n].svalue.len_used, 0);
-         }
-         dbx_log_response(pcon, (char *) pmeth->key.ibuffer.buf_addr, (int) pmeth->key.ibuffer.len_used, (char *) (dir == 1 ? "mcursor::next (query)" : "mcursor::previous (query)"));
-         pmeth->key.ibuffer.len_used = 0;
-      }
-   }
 
-   if (rc != CACHE_SUCCESS && rc != YDB_NODE_END) {
-      pcon->error_code = rc;
+int dbx_set_size(unsigned char *str, unsigned long data_len, short big_endian)
+{
+   if (big_endian) {
+      str[3] = (unsigned char) (data_len >> 0);
+      str[2] = (unsigned char) (data_len >> 8);
+      str[1] = (unsigned char) (data_len >> 16);
+      str[0] = (unsigned char) (data_len >> 24);
+   }
+   else {
+      str[0] = (unsigned char) (data_len >> 0);
+      str[1] = (unsigned char) (data_len >> 8);
+      str[2] = (unsigned char) (data_len >> 16);
+      str[3] = (unsigned char) (data_len >> 24);
    }
-   return eod;
 
-#ifdef _WIN32
+   return 0;
 }
-__except (EXCEPTION_EXECUTE_HANDLER) {
 
-   DWORD code;
-   char bufferx[256];
 
-   __try {
-      code = GetExceptionCode();
-      sprintf_s(bufferx, 255, "Exception caught in f:dbx_global_query: %x", code);
-      dbx_log_event(pcon, bufferx, (char *) "Error Condition", 0);
+unsigned long dbx_get_size(unsigned char *str, short big_endian)
+{
+   unsigned long size;
+
+   if (big_endian) {
+      size = ((unsigned char) str[3]) | (((unsigned char) str[2]) << 8) | (((unsigned char) str[1]) << 16) | (((unsigned char) str[0]) << 24);
    }
-   __except (EXCEPTION_EXECUTE_HANDLER) {
-      ;
+   else {
+      size = ((unsigned char) str[0]) | (((unsigned char) str[1]) << 8) | (((unsigned char) str[2]) << 16) | (((unsigned char) str[3]) << 24);
    }
 
-   return CACHE_FAILURE;
-}
-#endif
+   return size;
 }
 
 
-int dbx_display_key(char *key, int key_size, char *buffer)
+void * dbx_realloc(void *p, int curr_size, int new_size, short id)
 {
-   int n, n1;
-   char hex[16];
-
-   n1 = 0;
-   for (n = 0; n < key_size; n ++) {
-      if ((int) *(((char *) key) + n) < 32 || (int) *(((char *) key) + n) > 126) {
-         sprintf(hex, "%02x", (unsigned char) *(((char *) key) + n));
-         buffer[n1 ++] = '\\';
-         buffer[n1 ++] = 'x';
-         buffer[n1 ++] = hex[0];
-         buffer[n1 ++] = hex[1];
+   if (new_size >= curr_size) {
+      if (p) {
+         dbx_free((void *) p, 0);
       }
-      else {
-         buffer[n1 ++] = *(((char *) key) + n);
+      p = (void *) dbx_malloc(new_size, id);
+      if (!p) {
+         return NULL;
       }
    }
-   buffer[n1] = '\0';
-
-   return 0;
+   return p;
 }
 
 
-int cache_report_failure(DBXCON *pcon)
+void * dbx_malloc(int size, short id)
 {
+   void *p;
+   DBXMEMHDR *phdr;
 
-   if (pcon->error_code == 0) {
-      pcon->error_code = 10001;
-      T_STRCPY(pcon->error, _dbxso(pcon->error), DBX_TEXT_E_ASYNC);
+#if defined(_WIN32)
+      p = (void *) HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, size + sizeof(DBXMEMHDR) + 32);
+#else
+   p = (void *) malloc(size + sizeof(DBXMEMHDR));
+#endif
+
+   if (!p) {
+      return NULL;
    }
 
-   return 0;
+   /* v1.3.38 the block is prefixed with its size and id */
+   phdr = (DBXMEMHDR *) p;
+   phdr->size = (unsigned int) size;
+   phdr->epoch = 0;
+   phdr->id = (id > 0 && id < DBX_MEMID_MAX) ? (int) id : DBX_MEMID_OTHER;
+   if (dbx_mem_enabled) {
+      dbx_mem_alloc(phdr);
+   }
+
+   return (void *) (((char *) p) + sizeof(DBXMEMHDR));
 }
 
 
-/* ASYNC THREAD : Do the Cache task */
-int dbx_launch_thread(DBXMETH *pmeth)
+int dbx_free(void *p, short id)
 {
-#if !defined(_WIN32)
-
-   dbx_pool_submit_task(pmeth);
+   DBXMEMHDR *phdr;
 
-   return 1;
+   /* printf("\ndbx_free: id=%d; p=%p;", id, p); */
 
-#else
+   if (!p) {
+      return 0;
+   }
+   phdr = (DBXMEMHDR *) (((char *) p) - sizeof(DBXMEMHDR));
+   if (phdr->epoch) {
+      dbx_mem_release(phdr);
+   }
 
-   {
-      int rc = 0;
 #if defined(_WIN32)
-      HANDLE hthread;
-      SIZE_T stack_size;
-      DWORD thread_id, cre_flags, result;
-      LPSECURITY_ATTRIBUTES pattr;
-
-      stack_size = 0;
-      cre_flags = 0;
-      pattr = NULL;
-
-      hthread = CreateThread(pattr, stack_size, (LPTHREAD_START_ROUTINE) dbx_thread_main, (LPVOID) pmeth, cre_flags, &thread_id);
-/*
-      printf("\r\n*** %lu Primary Thread : CreateThread (%d) ...", (unsigned long) dbx_current_thread_id(), dbx_queue_size);
-*/
-      if (!hthread) {
-         printf("failed to create thread, errno = %d\n",errno);
-      }
-      else {
-         result = WaitForSingleObject(hthread, INFINITE);
-      }
+      HeapFree(GetProcessHeap(), 0, (void *) phdr);
 #else
-      pthread_attr_t attr;
-      pthread_t child_thread;
+   free((void *) phdr);
+#endif
 
-      size_t stacksize, newstacksize;
+   return 0;
+}
 
-      pthread_attr_init(&attr);
 
-      stacksize = 0;
-      pthread_attr_getstacksize(&attr, &stacksize);
+/* v1.3.38 Count a new block against its call site (and the totals) */
+int dbx_mem_alloc(DBXMEMHDR *phdr)
+{
+   int n;
+   long long live, high_water;
+   DBXMEMSTATS *pmstats;
 
-      newstacksize = DBX_THREAD_STACK_SIZE;
+   phdr->epoch = dbx_mem_epoch;
 
-      pthread_attr_setstacksize(&attr, newstacksize);
-/*
-      printf("Thread: default stack=%lu; new stack=%lu;\n", (unsigned long) stacksize, (unsigned long) newstacksize);
-*/
-      rc = pthread_create(&child_thread, &attr, dbx_thread_main, (void *) pmeth);
-      if (rc) {
-         printf("failed to create thread, errno = %d\n",errno);
-      }
-      else {
-         rc = pthread_join(child_thread,NULL);
+   for (n = 0; n < 2; n ++) {
+      pmstats = &dbx_mem_stats[n ? DBX_MEMID_MAX : phdr->id];
+      DBX_ATOMIC_ADD64(&(pmstats->allocations), 1);
+      DBX_ATOMIC_ADD64(&(pmstats->blocks), 1);
+      live = DBX_ATOMIC_ADD64(&(pmstats->live), (long long) phdr->size) + (long long) phdr->size;
+      high_water = pmstats->high_water;
+      while (live > high_water && !DBX_ATOMIC_CAS64(&(pmstats->high_water), high_water, live)) {
+         high_water = pmstats->high_water;
       }
-#endif
    }
 
-#endif
-
    return 1;
 }
 
 
-#if defined(_WIN32)
-LPTHREAD_START_ROUTINE dbx_thread_main(LPVOID pargs)
-#else
-void * dbx_thread_main(void *pargs)
-#endif
+/* v1.3.38 Deduct a block from its call site (and the totals) unless it was counted before the statistics were last reset */
+int dbx_mem_release(DBXMEMHDR *phdr)
 {
-   DBXMETH *pmeth;
-/*
-   printf("\r\n*** %lu Worker Thread : Thread (%d) ...", (unsigned long) dbx_current_thread_id(), dbx_queue_size);
-*/
-   pmeth = (DBXMETH *) pargs;
+   int n;
+   DBXMEMSTATS *pmstats;
 
-   pmeth->p_dbxfun(pmeth);
+   if (phdr->epoch != dbx_mem_epoch) {
+      return 0;
+   }
 
-#if defined(_WIN32)
-   return 0;
-#else
-   return NULL;
-#endif
-}
+   for (n = 0; n < 2; n ++) {
+      pmstats = &dbx_mem_stats[n ? DBX_MEMID_MAX : phdr->id];
+      DBX_ATOMIC_ADD64(&(pmstats->frees), 1);
+      DBX_ATOMIC_ADD64(&(pmstats->blocks), -1);
+      DBX_ATOMIC_ADD64(&(pmstats->live), -((long long) phdr->size));
+   }
 
+   return 1;
+}
 
-struct dbx_pool_task* dbx_pool_add_task(DBXMETH *pmeth)
+DBXQR * dbx_alloc_dbxqr(DBXQR *pqr, int dsize, short context)
 {
-   struct dbx_pool_task* enqueue_task;
-
-   enqueue_task = (struct dbx_pool_task*) dbx_malloc(sizeof(struct dbx_pool_task), 601);
+   int n;
+   char *p;
 
-   if (!enqueue_task) {
-      dbx_request_errors ++;
-      return NULL;
+   pqr = (DBXQR *) dbx_malloc(sizeof(DBXQR) + 128, DBX_MEMID_QR);
+   if (!pqr) {
+      return pqr;
    }
+   pqr->key.ibuffer.len_alloc = 0;
+   p = (char *) ((char *) pqr) + sizeof(DBXQR);
+   pqr->global_name.buf_addr = p;
+   pqr->global_name.len_alloc = 128;
+   pqr->global_name.len_used = 0;
 
-   enqueue_task->task_id = 6;
-   enqueue_task->pmeth = pmeth;
-   enqueue_task->next = NULL;
-
-#if !defined(_WIN32)
-   enqueue_task->parent_tid = pthread_self();
-
-   pthread_mutex_lock(&dbx_task_queue_mutex);
-
-   if (dbx_total_tasks == 0) {
-      tasks = enqueue_task;
-      bottom_task = enqueue_task;
+   pqr->key.ibuffer.len_alloc = 0;
+   pqr->key.ibuffer.len_used = 0;
+   pqr->key.ibuffer.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, DBX_MEMID_QR);
+   if (pqr->key.ibuffer.buf_addr) {
+      pqr->key.ibuffer.len_alloc = CACHE_MAXSTRLEN;
+      pqr->key.ibuffer.len_used = 0;
    }
-   else {
-      bottom_task->next = enqueue_task;
-      bottom_task = enqueue_task;
+
+   for (n = 0; n < DBX_MAXARGS; n ++) {
+      pqr->key.args[n].svalue.buf_addr = NULL;
+      pqr->key.args[n].svalue.len_alloc = 0;
+      pqr->key.args[n].svalue.len_used = 0;
    }
+   pqr->key.args[0].svalue.buf_addr = (char *) pqr->key.ibuffer.buf_addr;
+   pqr->key.args[0].svalue.len_alloc = pqr->key.ibuffer.len_alloc;
+   pqr->key.args[0].svalue.len_used = 0;
 
-   dbx_total_tasks ++;
+   pqr->data.svalue.len_alloc = 0;
+   pqr->data.svalue.len_used = 0;
+   pqr->data.svalue.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, DBX_MEMID_QR);
+   if (pqr->data.svalue.buf_addr) {
+      pqr->data.svalue.len_alloc = CACHE_MAXSTRLEN;
+      pqr->data.svalue.len_used = 0;
+   }
+   return pqr;
+}
 
-   pthread_mutex_unlock(&dbx_task_queue_mutex);
-   pthread_cond_signal(&dbx_pool_cond);
-#endif
 
-   return enqueue_task;
+int dbx_free_dbxqr(DBXQR *pqr)
+{
+   if (pqr->data.svalue.buf_addr) {
+      dbx_free((void *) pqr->data.svalue.buf_addr, 0); 
+   }
+   dbx_free((void *) pqr, 0); 
+   return 0;
 }
 
 
-struct dbx_pool_task * dbx_pool_get_task(void)
+int dbx_ucase(char *string)
 {
-   struct dbx_pool_task* task;
+#ifdef _UNICODE
 
-#if !defined(_WIN32)
-   pthread_mutex_lock(&dbx_task_queue_mutex);
-#endif
+   CharUpperA(string);
+   return 1;
 
-   if (dbx_total_tasks > 0) {
-      task = tasks;
-      tasks = task->next;
+#else
 
-      if (tasks == NULL) {
-         bottom_task = NULL;
-      }
-      dbx_total_tasks --;
-   }
-   else {
-      task = NULL;
+   int n, chr;
+
+   n = 0;
+   while (string[n] != '\0') {
+      chr = (int) string[n];
+      if (chr >= 97 && chr <= 122)
+         string[n] = (char) (chr - 32);
+      n ++;
    }
+   return 1;
 
-#if !defined(_WIN32)
-   pthread_mutex_unlock(&dbx_task_queue_mutex);
 #endif
-
-   return task;
 }
 
 
-void dbx_pool_execute_task(struct dbx_pool_task *task, int thread_id)
+int dbx_lcase(char *string)
 {
-   if (task) {
+#ifdef _UNICODE
 
-      task->pmeth->p_dbxfun(task->pmeth);
+   CharLowerA(string);
+   return 1;
 
-      task->pmeth->done = 1;
+#else
+
+   int n, chr;
+
+   n = 0;
+   while (string[n] != '\0') {
+      chr = (int) string[n];
+      if (chr >= 65 && chr <= 90)
+         string[n] = (char) (chr + 32);
+      n ++;
+   }
+   return 1;
 
-#if !defined(_WIN32)
-      pthread_cond_broadcast(&dbx_result_cond);
 #endif
+}
+
+
+/* v1.3.28 A size in bytes with an optional multiplier: e.g. 500k, 100m or 2g (0 if not valid) */
+size_t dbx_parse_size(char *buffer)
+{
+   size_t size;
+
+   dbx_lcase(buffer);
+   size = (size_t) strtoull(buffer, NULL, 10);
+   if (size) {
+      if (strstr(buffer, "k"))
+         size *= 1000;
+      else if (strstr(buffer, "m"))
+         size *= (1000 * 1000);
+      else if (strstr(buffer, "g"))
+         size *= (1000 * 1000 * 1000);
    }
+   return size;
 }
 
 
-void * dbx_pool_requests_loop(void *data)
+int dbx_create_string(DBXSTR *pstr, void *data, short type)
 {
-   int thread_id;
-   DBXTID *ptid;
-   struct dbx_pool_task *task = NULL;
+   DBXSTR *pstrobj_in;
 
-   ptid = (DBXTID *) data;
-   if (!ptid) {
-      return NULL;
+   if (!data) {
+      return -1;
    }
 
-   thread_id = ptid->thread_id;
+   pstr->len_used = 0;
 
-/*
-#if !defined(_WIN32)
-{
-   int ret;
-   pthread_attr_t tattr;
-   size_t size;
-   ret = pthread_getattr_np(pthread_self(), &tattr);
-   ret = pthread_attr_getstacksize(&tattr, &size);
-   printf("\r\n*** pthread_attr_getstacksize (pool) %x *** ret=%d; size=%u\r\n", (unsigned long) pthread_self(), ret, size);
-}
-#endif
-*/
+   if (type == DBX_DTYPE_STROBJ) {
+      pstrobj_in = (DBXSTR *) data;
 
-#if !defined(_WIN32)
-   pthread_mutex_lock(&dbx_pool_mutex);
+      type = DBX_DTYPE_STR8;
+      data = (void *) pstrobj_in->buf_addr;
+   }
 
-   while (1) {
-      if (dbx_total_tasks > 0) {
-         task = dbx_pool_get_task();
-         if (task) {
-            pthread_mutex_unlock(&dbx_pool_mutex);
-            dbx_pool_execute_task(task, thread_id);
-            dbx_free(task, 3001);
-            pthread_mutex_lock(&dbx_pool_mutex);
-         }
-      }
-      else {
-         pthread_cond_wait(&dbx_pool_cond, &dbx_pool_mutex);
-      }
+   if (type == DBX_DTYPE_STR8) {
+      T_STRCPY((char *) pstr->buf_addr, pstr->len_alloc, (char *) data);
    }
-#endif
+   else if (type == DBX_DTYPE_INT) {
+      T_SPRINTF((char *) pstr->buf_addr, pstr->len_alloc, "%d", (int) *((int *) data));
+   }
+   else {
+      pstr->buf_addr[0] = '\0';
+   }
+   pstr->len_used = (unsigned long) strlen((char *) pstr->buf_addr);
 
-   return NULL;
+   return (int) pstr->len_used;
 }
 
 
-int dbx_pool_thread_init(DBXCON *pcon, int num_threads)
+/* v1.3.11 */
+int dbx_dump_mref(DBXCON *pcon, DBXMETH *pmeth, char *cmnd, DBXVAL *presult, int rc)
 {
-#if !defined(_WIN32)
-   int iterator;
-   pthread_attr_t attr[DBX_THREADPOOL_MAX];
-   size_t stacksize, newstacksize;
-
-   for (iterator = 0; iterator < num_threads; iterator ++) {
+   int n;
+   char buffer[8192], val[256];
 
-      pthread_attr_init(&attr[iterator]);
+   sprintf(buffer, "%s ", cmnd);
 
-      stacksize = 0;
-      pthread_attr_getstacksize(&attr[iterator], &stacksize);
+   for (n = 0; n < pmeth->key.argc; n ++) {
+      val[0] = '\0';
+      strncpy(val, pmeth->key.args[n].svalue.buf_addr, pmeth->key.args[n].svalue.len_used);
+      val[pmeth->key.args[n].svalue.len_used] = '\0';
+      if (n == 0) {
+         strcat(buffer, val);
+         strcat(buffer, "(");
+      }
+      else if (strstr(cmnd, "set") && n == (pmeth->key.argc - 1)) {
+         strcat(buffer, ")=");
+         strcat(buffer, val);
+         sprintf(val, " (len=%d)", pmeth->key.args[n].svalue.len_used);
+         strcat(buffer, val);
+      }
+      else {
+         if (n > 1) {
+            strcat(buffer, ",");
+         }
+         strcat(buffer, val);
+         if (n == (pmeth->key.argc - 1)) {
+            strcat(buffer, ")");
+         }
+      }
+   }
 
-      newstacksize = DBX_THREAD_STACK_SIZE;
-/*
-      printf("Thread Pool: default stack=%lu; new stack=%lu;\n", (unsigned long) stacksize, (unsigned long) newstacksize);
-*/
-      pthread_attr_setstacksize(&attr[iterator], newstacksize);
+   sprintf(val, " (rc=%d)", rc);
+   strcat(buffer, val);
+   if (presult) {
+      strcpy(val, "");
+      if (presult->svalue.len_used > 0) {
+         strncpy(val, presult->svalue.buf_addr, presult->svalue.len_used);
+         val[presult->svalue.len_used] = '\0';
+      }
+      strcat(buffer, "result=");
+      strcat(buffer, val);
+   }
 
-      dbx_thr_id[iterator].thread_id = iterator;
-      dbx_thr_id[iterator].p_mutex = pcon->p_mutex;
-      dbx_thr_id[iterator].p_zv = pcon->p_zv;
-      
-      pthread_create(&dbx_p_threads[iterator], &attr[iterator], dbx_pool_requests_loop, (void *) &dbx_thr_id[iterator]);
+   printf("\r\n%s", buffer);
 
-   }
-#endif
    return 0;
 }
 
 
-int dbx_pool_submit_task(DBXMETH *pmeth)
+int dbx_log_transmission(DBXCON *pcon, DBXMETH *pmeth, char *name)
 {
-#if !defined(_WIN32)
-   struct timespec   ts;
-   struct timeval    tp;
+   char namex[64];
+   char buffer[256];
 
-   pmeth->done = 0;
+   if (pcon->log_filter[0]) {
+      strcpy(namex, ",");
+      strcat(namex, name);
+      strcat(namex, ",");
+      if (!strstr(pcon->log_filter, namex)) {
+         return 0;
+      }
+   }
+   sprintf(buffer, (char *) "mg-dbx-bdb: transmission: %s", name);
 
-   dbx_pool_add_task(pmeth);
+   dbx_log_buffer(pcon, (char *) pmeth->key.ibuffer.buf_addr, pmeth->key.ibuffer.len_used, buffer, 0);
 
-   pthread_mutex_lock(&dbx_result_mutex);
+   return 0;
+}
 
-   while (!pmeth->done) {
 
-      gettimeofday(&tp, NULL);
-      ts.tv_sec  = tp.tv_sec;
-      ts.tv_nsec = tp.tv_usec * 1000;
-      ts.tv_sec += 3;
+int dbx_log_response(DBXCON *pcon, char *ibuffer, int ibuffer_len, char *name)
+{
+   char namex[64];
+   char buffer[256];
 
-      pthread_cond_timedwait(&dbx_result_cond, &dbx_result_mutex, &ts);
+   if (pcon->log_filter[0]) {
+      strcpy(namex, ",");
+      strcat(namex, name);
+      strcat(namex, ",");
+      if (!strstr(pcon->log_filter, namex)) {
+         return 0;
+      }
    }
+   sprintf(buffer, (char *) "mg-dbx-bdb: response: %s", name);
 
-   pthread_mutex_unlock(&dbx_result_mutex);
-#endif
-   return 1;
-}
-
-
-int dbx_add_block_size(unsigned char *block, unsigned long offset, unsigned long data_len, int dsort, int dtype)
-{
-   dbx_set_size((unsigned char *) block + offset, data_len, 0);
-   block[offset + 4] = (unsigned char) ((dsort * 20) + dtype);
+   dbx_log_buffer(pcon, (char *) ibuffer, ibuffer_len, buffer, 0);
 
-   return 1;
+   return 0;
 }
 
 
-unsigned long dbx_get_block_size(unsigned char *block, unsigned long offset, int *dsort, int *dtype)
+int dbx_buffer_dump(DBXCON *pcon, void *buffer, unsigned int len, char *title, unsigned char csize, short mode)
 {
-   unsigned long data_len;
-   unsigned char uc;
-
-   data_len = 0;
-   uc = (unsigned char) block[offset + 4];
+   unsigned int n;
+   unsigned char *p8;
+   unsigned short *p16;
+   unsigned short c;
 
-   *dtype = uc % 20;
-   *dsort = uc / 20;
+   p8 = NULL;
+   p16 = NULL;
 
-   if (*dsort != DBX_DSORT_STATUS) {
-      data_len = dbx_get_size((unsigned char *) block + offset, 0);
+   if (csize == 16) {
+      p16 = (unsigned short *) buffer;
+   }
+   else {
+      p8 = (unsigned char *) buffer;
    }
+   printf("\nbuffer dump (title=%s; size=%d; charsize=%u; mode=%d)...\n", title, len, csize, mode);
 
-   if (!DBX_DSORT_ISVALID(*dsort)) {
-      *dsort = DBX_DSORT_INVALID;
+   for (n = 0; n < len; n ++) {
+      if (csize == 16) {
+         c = p16[n];
+      }
+      else {
+         c = p8[n];
+      }
+
+      if (mode == 1) {
+         printf("\\x%04x ", c);
+         if (!((n + 1) % 8)) {
+            printf("\r\n");
+         }
+      }
+      else {
+         if ((c < 32) || (c > 126)) {
+            if (csize == 16) {
+               printf("\\x%04x", c);
+            }
+            else {
+               printf("\\x%02x", c);
+            }
+         }
+         else {
+            printf("%c", (char) c);
+         }
+      }
    }
 
-   return data_len;
+   return 0;
 }
 
 
-int dbx_set_size(unsigned char *str, unsigned long data_len, short big_endian)
+/* v1.3.35 The record is queued for the background writer unless the log is synchronous (or the writer is not running) */
+int dbx_log_event(DBXCON *pcon, char *message, char *title, int level)
 {
-   if (big_endian) {
-      str[3] = (unsigned char) (data_len >> 0);
-      str[2] = (unsigned char) (data_len >> 8);
-      str[1] = (unsigned char) (data_len >> 16);
-      str[0] = (unsigned char) (data_len >> 24);
-   }
-   else {
-      str[0] = (unsigned char) (data_len >> 0);
-      str[1] = (unsigned char) (data_len >> 8);
-      str[2] = (unsigned char) (data_len >> 16);
-      str[3] = (unsigned char) (data_len >> 24);
+   int len, flen, n;
+   char timestr[64], heading[256];
+   char *p_buffer, *p_text, *file;
+   time_t now = 0;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   p_buffer = NULL;
+
+   now = time(NULL);
+   sprintf(timestr, "%s", ctime(&now));
+   for (n = 0; timestr[n] != '\0'; n ++) {
+      if ((unsigned int) timestr[n] < 32) {
+         timestr[n] = '\0';
+         break;
+      }
    }
+/*
+   sprintf(heading, ">>> Time: %s; Build: %s pid=%lu;tid=%lu;req_no=%lu;fun_no=%lu", timestr, (char *) DBX_VERSION, (unsigned long) dbx_current_process_id(), (unsigned long) dbx_current_thread_id(), p_log->req_no, p_log->fun_no);
+*/
+
+   sprintf(heading, ">>> Time: %s; Build: %s pid=%lu;tid=%lu;", timestr, (char *) DBX_VERSION, (unsigned long) dbx_current_process_id(), (unsigned long) dbx_current_thread_id());
 
-   return 0;
-}
+   file = (pcon ? pcon->log_file : (char *) DBX_LOG_FILE);
+   flen = (int) strlen(file) + 2;
+   len = flen + (int) strlen(heading) + (int) strlen(title) + (int) strlen(message) + 20;
 
+   p_buffer = (char *) dbx_malloc(sizeof(char) * len, DBX_MEMID_LOG);
 
-unsigned long dbx_get_size(unsigned char *str, short big_endian)
-{
-   unsigned long size;
+   if (p_buffer == NULL) {
+      return 0;
+   }
 
-   if (big_endian) {
-      size = ((unsigned char) str[3]) | (((unsigned char) str[2]) << 8) | (((unsigned char) str[1]) << 16) | (((unsigned char) str[0]) << 24);
+   p_buffer[0] = 'a';
+   strcpy(p_buffer + 1, file);
+   p_text = p_buffer + flen;
+   strcpy(p_text, heading);
+   strcat(p_text, "\r\n    ");
+   strcat(p_text, title);
+   strcat(p_text, "\r\n    ");
+   strcat(p_text, message);
+#if defined(_WIN32)
+   strcat(p_text, "\r\n");
+#else
+   strcat(p_text, "\n");
+#endif
+   len = (int) strlen(p_text) * sizeof(char);
+
+   if (dbx_log_queue(&dbx_log, p_buffer)) {
+      return 1; /* the buffer now belongs to the writer */
    }
-   else {
-      size = ((unsigned char) str[0]) | (((unsigned char) str[1]) << 8) | (((unsigned char) str[2]) << 16) | (((unsigned char) str[3]) << 24);
+
+   dbx_log_write(file, p_text, len, 'a');
+
+   if (p_buffer) {
+      dbx_free((void *) p_buffer, 0);
    }
 
-   return size;
+   return 1;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+      return 0;
 }
 
+#endif
 
-void * dbx_realloc(void *p, int curr_size, int new_size, short id)
-{
-   if (new_size >= curr_size) {
-      if (p) {
-         dbx_free((void *) p, 0);
-      }
-      p = (void *) dbx_malloc(new_size, id);
-      if (!p) {
-         return NULL;
-      }
-   }
-   return p;
 }
 
 
-void * dbx_malloc(int size, short id)
+/* v1.3.35 Write a record directly to the log file (the original per-message path): mode 'w' starts a new file */
+int dbx_log_write(char *file, char *text, int len, char mode)
 {
-   void *p;
-
+   int n;
 #if defined(_WIN32)
-      p = (void *) HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, size + 32);
+   HANDLE hLogfile = 0;
+   DWORD dwPos = 0, dwBytesWritten = 0;
 #else
-   p = (void *) malloc(size);
+   FILE *fp = NULL;
+   struct flock lock;
 #endif
 
-   return p;
-}
+   n = 0;
 
+#if defined(_WIN32)
 
-int dbx_free(void *p, short id)
-{
-   /* printf("\ndbx_free: id=%d; p=%p;", id, p); */
+   hLogfile = CreateFileA(file, GENERIC_WRITE, FILE_SHARE_WRITE,
+                         (LPSECURITY_ATTRIBUTES) NULL, (mode == 'w' ? CREATE_ALWAYS : OPEN_ALWAYS),
+                         FILE_ATTRIBUTE_NORMAL, (HANDLE) NULL);
+   dwPos = SetFilePointer(hLogfile, 0, (LPLONG) NULL, FILE_END);
+   LockFile(hLogfile, dwPos, 0, dwPos + len, 0);
+   WriteFile(hLogfile, (LPTSTR) text, len, &dwBytesWritten, NULL);
+   UnlockFile(hLogfile, dwPos, 0, dwPos + len, 0);
+   CloseHandle(hLogfile);
 
-#if defined(_WIN32)
-      HeapFree(GetProcessHeap(), 0, p);
-#else
-   free((void *) p);
-#endif
+#else /* UNIX or VMS */
 
-   return 0;
-}
+   fp = fopen(file, (mode == 'w' ? "w" : "a"));
+   if (fp) {
 
-DBXQR * dbx_alloc_dbxqr(DBXQR *pqr, int dsize, short context)
-{
-   int n;
-   char *p;
+      lock.l_type = F_WRLCK;
+      lock.l_start = 0;
+      lock.l_whence = SEEK_SET;
+      lock.l_len = 0;
+      n = fcntl(fileno(fp), F_SETLKW, &lock);
 
-   pqr = (DBXQR *) dbx_malloc(sizeof(DBXQR) + 128, 0);
-   if (!pqr) {
-      return pqr;
-   }
-   pqr->key.ibuffer.len_alloc = 0;
-   p = (char *) ((char *) pqr) + sizeof(DBXQR);
-   pqr->global_name.buf_addr = p;
-   pqr->global_name.len_alloc = 128;
-   pqr->global_name.len_used = 0;
+      fputs(text, fp);
+      /* fclose(fp); */
 
-   pqr->key.ibuffer.len_alloc = 0;
-   pqr->key.ibuffer.len_used = 0;
-   pqr->key.ibuffer.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, 0);
-   if (pqr->key.ibuffer.buf_addr) {
-      pqr->key.ibuffer.len_alloc = CACHE_MAXSTRLEN;
-      pqr->key.ibuffer.len_used = 0;
+      lock.l_type = F_UNLCK;
+      lock.l_start = 0;
+      lock.l_whence = SEEK_SET;
+      lock.l_len = 0;
+      n = fcntl(fileno(fp), F_SETLK, &lock);
+      fclose(fp); /* v1.3.14 */
    }
 
-   for (n = 0; n < DBX_MAXARGS; n ++) {
-      pqr->key.args[n].svalue.buf_addr = NULL;
-      pqr->key.args[n].svalue.len_alloc = 0;
-      pqr->key.args[n].svalue.len_used = 0;
-   }
-   pqr->key.args[0].svalue.buf_addr = (char *) pqr->key.ibuffer.buf_addr;
-   pqr->key.args[0].svalue.len_alloc = pqr->key.ibuffer.len_alloc;
-   pqr->key.args[0].svalue.len_used = 0;
+#endif
 
-   pqr->data.svalue.len_alloc = 0;
-   pqr->data.svalue.len_used = 0;
-   pqr->data.svalue.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, 0);
-   if (pqr->data.svalue.buf_addr) {
-      pqr->data.svalue.len_alloc = CACHE_MAXSTRLEN;
-      pqr->data.svalue.len_used = 0;
-   }
-   return pqr;
+   return n;
 }
 
 
-int dbx_free_dbxqr(DBXQR *pqr)
+/* v1.3.35 Apply the default log settings */
+int dbx_log_config(DBXLOG *plog)
 {
-   if (pqr->data.svalue.buf_addr) {
-      dbx_free((void *) pqr->data.svalue.buf_addr, 0); 
+   if (plog->configured) {
+      return 0;
    }
-   dbx_free((void *) pqr, 0); 
-   return 0;
+   plog->sync = 0;
+   plog->notes = 1;
+   plog->max_size = DBX_LOG_MAX_SIZE;
+   plog->files = DBX_LOG_FILES;
+   plog->configured = 1;
+
+   return 1;
 }
 
 
-int dbx_ucase(char *string)
+/* v1.3.35 Start the log writer on first use: the log is written synchronously while it is starting (or if it cannot be started) */
+int dbx_log_start(DBXLOG *plog)
 {
-#ifdef _UNICODE
+   int n, rc;
 
-   CharUpperA(string);
-   return 1;
+   if (!DBX_ATOMIC_CAS32(&(plog->state), DBX_LOG_IDLE, DBX_LOG_STARTING)) {
+      return 0;
+   }
+   dbx_log_config(plog);
+
+   for (n = 0; n < DBX_LOG_SLOTS; n ++) {
+      plog->ring[n].seq = (unsigned int) n;
+      plog->ring[n].record = NULL;
+   }
+   plog->head = 0;
+   plog->tail = 0;
+   plog->stop = 0;
+   plog->file[0] = '\0';
+   plog->size = 0;
+   plog->batch_len = 0;
+   plog->batch = (char *) dbx_malloc(sizeof(char) * DBX_LOG_BATCH, DBX_MEMID_LOG);
+   if (!plog->batch) {
+      plog->state = DBX_LOG_STOPPED;
+      return 0;
+   }
 
+#if defined(_WIN32)
+   plog->hfile = NULL;
+   plog->hthread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) dbx_log_thread, (LPVOID) plog, 0, NULL);
+   rc = (plog->hthread ? 0 : -1);
+   if (plog->hthread) {
+      CloseHandle(plog->hthread); /* the writer is never joined: see dbx_log_exit() */
+   }
 #else
+   plog->fp = NULL;
+   {
+      pthread_attr_t attr;
 
-   int n, chr;
+      pthread_attr_init(&attr);
+      pthread_attr_setstacksize(&attr, DBX_THREAD_STACK_SIZE);
+      pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED); /* the writer is never joined: see dbx_log_exit() */
+      rc = pthread_create(&(plog->thread), &attr, dbx_log_thread, (void *) plog);
+      pthread_attr_destroy(&attr);
+   }
+#endif
 
-   n = 0;
-   while (string[n] != '\0') {
-      chr = (int) string[n];
-      if (chr >= 97 && chr <= 122)
-         string[n] = (char) (chr - 32);
-      n ++;
+   if (rc) {
+      plog->state = DBX_LOG_STOPPED;
+      return 0;
+   }
+   if (!dbx_log_atexit) {
+      dbx_log_atexit = 1;
+      atexit(dbx_log_exit);
    }
-   return 1;
 
-#endif
+   DBX_MEMORY_BARRIER();
+   plog->state = DBX_LOG_RUNNING;
+
+   return 1;
 }
 
 
-int dbx_lcase(char *string)
+/* v1.3.35 Queue a record for the writer without taking a lock: a record that does not fit is dropped (and counted) rather than blocking the caller */
+int dbx_log_queue(DBXLOG *plog, char *record)
 {
-#ifdef _UNICODE
+   int diff;
+   unsigned int pos, seq;
+   DBXLOGREC *prec;
+
+   if (plog->sync) {
+      return 0;
+   }
+   if (plog->state != DBX_LOG_RUNNING) {
+      if (plog->state != DBX_LOG_IDLE || !dbx_log_start(plog)) {
+         return 0;
+      }
+   }
+
+   pos = plog->head;
+   for (;;) {
+      prec = &(plog->ring[pos & (DBX_LOG_SLOTS - 1)]);
+      seq = prec->seq;
+      diff = (int) (seq - pos);
+      if (diff == 0) {
+         if (DBX_ATOMIC_CAS32(&(plog->head), pos, pos + 1)) {
+            break;
+         }
+      }
+      else if (diff < 0) { /* the writer has not yet emptied this slot: the ring is full */
+         DBX_ATOMIC_ADD64(&(plog->dropped), 1);
+         dbx_free((void *) record, 0);
+         return 1;
+      }
+      pos = plog->head;
+   }
+
+   prec->record = record;
+   DBX_MEMORY_BARRIER();
+   prec->seq = pos + 1;
+   DBX_ATOMIC_ADD64(&(plog->queued), 1);
 
-   CharLowerA(string);
    return 1;
+}
 
-#else
 
-   int n, chr;
+/* v1.3.35 Write everything queued so far: returns the number of records taken from the ring */
+int dbx_log_drain(DBXLOG *plog)
+{
+   int n, i;
+   char *record, *p_text;
+   char timestr[64], buffer[512];
+   DBXLOGREC *prec;
+   unsigned long long dropped;
+   time_t now = 0;
 
    n = 0;
-   while (string[n] != '\0') {
-      chr = (int) string[n];
-      if (chr >= 65 && chr <= 90)
-         string[n] = (char) (chr + 32);
+   for (;;) {
+      prec = &(plog->ring[plog->tail & (DBX_LOG_SLOTS - 1)]);
+      if (prec->seq != (plog->tail + 1)) {
+         break;
+      }
+      DBX_MEMORY_BARRIER();
+      record = prec->record;
+      prec->record = NULL;
+      DBX_MEMORY_BARRIER();
+      prec->seq = plog->tail + DBX_LOG_SLOTS; /* the slot can be reused on the next pass around the ring */
+      plog->tail ++;
       n ++;
+
+      if (record) {
+         p_text = record + strlen(record) + 1;
+         dbx_log_record(plog, record + 1, p_text, (unsigned int) strlen(p_text), record[0]);
+         dbx_free((void *) record, 0);
+      }
    }
-   return 1;
 
+   dropped = plog->dropped;
+   if (dropped != plog->dropped_reported && plog->file[0] && plog->notes) {
+      now = time(NULL);
+      sprintf(timestr, "%s", ctime(&now));
+      for (i = 0; timestr[i] != '\0'; i ++) {
+         if ((unsigned int) timestr[i] < 32) {
+            timestr[i] = '\0';
+            break;
+         }
+      }
+      sprintf(buffer, ">>> Time: %s; Build: %s pid=%lu;\r\n    mg-dbx-bdb: Event Log\r\n    %llu records were dropped because the log buffer was full (%llu in total)%s",
+         timestr, (char *) DBX_VERSION, (unsigned long) dbx_current_process_id(), dropped - plog->dropped_reported, dropped,
+#if defined(_WIN32)
+         "\r\n");
+#else
+         "\n");
 #endif
-}
-
-
-int dbx_create_string(DBXSTR *pstr, void *data, short type)
-{
-   DBXSTR *pstrobj_in;
+      plog->dropped_reported = dropped;
+      dbx_log_record(plog, plog->file, buffer, (unsigned int) strlen(buffer), 'a');
+   }
 
-   if (!data) {
-      return -1;
+   if (plog->batch_len) {
+      dbx_log_flush(plog);
    }
 
-   pstr->len_used = 0;
+   return n;
+}
 
-   if (type == DBX_DTYPE_STROBJ) {
-      pstrobj_in = (DBXSTR *) data;
 
-      type = DBX_DTYPE_STR8;
-      data = (void *) pstrobj_in->buf_addr;
+/* v1.3.35 Add a record to the batch written in one operation: records for a different file (v1.3.36 or a new file) flush the batch first */
+int dbx_log_record(DBXLOG *plog, char *file, char *text, unsigned int len, char mode)
+{
+   if (mode == 'w' || strcmp(plog->file, file)) {
+      dbx_log_flush(plog);
+      dbx_log_file_close(plog);
+      strncpy(plog->file, file, sizeof(plog->file) - 1);
+      plog->file[sizeof(plog->file) - 1] = '\0';
+      if (mode == 'w') {
+         remove(plog->file);
+      }
    }
-
-   if (type == DBX_DTYPE_STR8) {
-      T_STRCPY((char *) pstr->buf_addr, pstr->len_alloc, (char *) data);
+   if ((plog->batch_len + len) > DBX_LOG_BATCH) {
+      dbx_log_flush(plog);
    }
-   else if (type == DBX_DTYPE_INT) {
-      T_SPRINTF((char *) pstr->buf_addr, pstr->len_alloc, "%d", (int) *((int *) data));
+   if (len > DBX_LOG_BATCH) {
+      dbx_log_file_write(plog, text, len);
    }
    else {
-      pstr->buf_addr[0] = '\0';
+      memcpy((void *) (plog->batch + plog->batch_len), (void *) text, (size_t) len);
+      plog->batch_len += len;
    }
-   pstr->len_used = (unsigned long) strlen((char *) pstr->buf_addr);
+   plog->written ++;
 
-   return (int) pstr->len_used;
+   return 0;
 }
 
 
-/* v1.3.11 */
-int dbx_dump_mref(DBXCON *pcon, DBXMETH *pmeth, char *cmnd, DBXVAL *presult, int rc)
+int dbx_log_flush(DBXLOG *plog)
 {
-   int n;
-   char buffer[8192], val[256];
+   if (plog->batch_len) {
+      dbx_log_file_write(plog, plog->batch, plog->batch_len);
+      plog->batch_len = 0;
+   }
 
-   sprintf(buffer, "%s ", cmnd);
+   return 0;
+}
 
-   for (n = 0; n < pmeth->key.argc; n ++) {
-      val[0] = '\0';
-      strncpy(val, pmeth->key.args[n].svalue.buf_addr, pmeth->key.args[n].svalue.len_used);
-      val[pmeth->key.args[n].svalue.len_used] = '\0';
-      if (n == 0) {
-         strcat(buffer, val);
-         strcat(buffer, "(");
-      }
-      else if (strstr(cmnd, "set") && n == (pmeth->key.argc - 1)) {
-         strcat(buffer, ")=");
-         strcat(buffer, val);
-         sprintf(val, " (len=%d)", pmeth->key.args[n].svalue.len_used);
-         strcat(buffer, val);
-      }
-      else {
-         if (n > 1) {
-            strcat(buffer, ",");
-         }
-         strcat(buffer, val);
-         if (n == (pmeth->key.argc - 1)) {
-            strcat(buffer, ")");
-         }
+
+/* v1.3.35 Append to the log file, which is held open by the writer: whole records are written under the same lock as dbx_log_write() */
+int dbx_log_file_write(DBXLOG *plog, char *text, unsigned int len)
+{
+#if defined(_WIN32)
+   DWORD dwPos = 0, dwBytesWritten = 0;
+#else
+   struct flock lock;
+#endif
+
+   if (plog->max_size && plog->size && (plog->size + len) > plog->max_size) {
+      dbx_log_rotate(plog);
+   }
+
+#if defined(_WIN32)
+
+   if (!plog->hfile) {
+      plog->hfile = CreateFileA(plog->file, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              (LPSECURITY_ATTRIBUTES) NULL, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, (HANDLE) NULL);
+      if (plog->hfile == INVALID_HANDLE_VALUE) {
+         plog->hfile = NULL;
+         return 0;
       }
+      plog->size = (size_t) GetFileSize(plog->hfile, NULL);
    }
+   dwPos = SetFilePointer(plog->hfile, 0, (LPLONG) NULL, FILE_END);
+   LockFile(plog->hfile, dwPos, 0, dwPos + len, 0);
+   WriteFile(plog->hfile, (LPTSTR) text, len, &dwBytesWritten, NULL);
+   UnlockFile(plog->hfile, dwPos, 0, dwPos + len, 0);
+
+#else /* UNIX or VMS */
 
-   sprintf(val, " (rc=%d)", rc);
-   strcat(buffer, val);
-   if (presult) {
-      strcpy(val, "");
-      if (presult->svalue.len_used > 0) {
-         strncpy(val, presult->svalue.buf_addr, presult->svalue.len_used);
-         val[presult->svalue.len_used] = '\0';
+   if (!plog->fp) {
+      plog->fp = fopen(plog->file, "a");
+      if (!plog->fp) {
+         return 0;
       }
-      strcat(buffer, "result=");
-      strcat(buffer, val);
+      fseek(plog->fp, 0, SEEK_END);
+      plog->size = (size_t) ftell(plog->fp);
    }
 
-   printf("\r\n%s", buffer);
+   lock.l_type = F_WRLCK;
+   lock.l_start = 0;
+   lock.l_whence = SEEK_SET;
+   lock.l_len = 0;
+   fcntl(fileno(plog->fp), F_SETLKW, &lock);
+
+   fwrite((void *) text, sizeof(char), (size_t) len, plog->fp);
+   fflush(plog->fp);
+
+   lock.l_type = F_UNLCK;
+   lock.l_start = 0;
+   lock.l_whence = SEEK_SET;
+   lock.l_len = 0;
+   fcntl(fileno(plog->fp), F_SETLK, &lock);
+
+#endif
+
+   plog->size += len;
+
+   return 1;
+}
+
+
+int dbx_log_file_close(DBXLOG *plog)
+{
+#if defined(_WIN32)
+   if (plog->hfile) {
+      CloseHandle(plog->hfile);
+      plog->hfile = NULL;
+   }
+#else
+   if (plog->fp) {
+      fclose(plog->fp);
+      plog->fp = NULL;
+   }
+#endif
+   plog->size = 0;
 
    return 0;
 }
 
 
-int dbx_log_transmission(DBXCON *pcon, DBXMETH *pmeth, char *name)
+/* v1.3.35 Rotate the log: file -> file.1 -> file.2 ... and the oldest is removed */
+int dbx_log_rotate(DBXLOG *plog)
 {
-   char namex[64];
-   char buffer[256];
+   int n;
+   char from[280], to[280];
 
-   if (pcon->log_filter[0]) {
-      strcpy(namex, ",");
-      strcat(namex, name);
-      strcat(namex, ",");
-      if (!strstr(pcon->log_filter, namex)) {
-         return 0;
+   dbx_log_file_close(plog);
+
+   if (plog->files > 0) {
+      sprintf(to, "%s.%d", plog->file, plog->files);
+      remove(to);
+      for (n = plog->files - 1; n > 0; n --) {
+         sprintf(from, "%s.%d", plog->file, n);
+         sprintf(to, "%s.%d", plog->file, n + 1);
+         rename(from, to);
       }
+      sprintf(to, "%s.1", plog->file);
+      rename(plog->file, to);
    }
-   sprintf(buffer, (char *) "mg-dbx-bdb: transmission: %s", name);
-
-   dbx_log_buffer(pcon, (char *) pmeth->key.ibuffer.buf_addr, pmeth->key.ibuffer.len_used, buffer, 0);
+   else {
+      remove(plog->file);
+   }
+   plog->rotations ++;
 
    return 0;
 }
 
 
-int dbx_log_response(DBXCON *pcon, char *ibuffer, int ibuffer_len, char *name)
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE dbx_log_thread(LPVOID pargs)
+#else
+void * dbx_log_thread(void *pargs)
+#endif
 {
-   char namex[64];
-   char buffer[256];
+   DBXLOG *plog;
 
-   if (pcon->log_filter[0]) {
-      strcpy(namex, ",");
-      strcat(namex, name);
-      strcat(namex, ",");
-      if (!strstr(pcon->log_filter, namex)) {
-         return 0;
+   plog = (DBXLOG *) pargs;
+
+   while (!plog->stop) {
+      if (!dbx_log_drain(plog)) {
+         dbx_sleep(DBX_LOG_TICK);
       }
    }
-   sprintf(buffer, (char *) "mg-dbx-bdb: response: %s", name);
-
-   dbx_log_buffer(pcon, (char *) ibuffer, ibuffer_len, buffer, 0);
+   dbx_log_drain(plog);
+   DBX_MEMORY_BARRIER();
+   plog->state = DBX_LOG_STOPPED;
 
+#if defined(_WIN32)
    return 0;
+#else
+   return NULL;
+#endif
 }
 
 
-int dbx_buffer_dump(DBXCON *pcon, void *buffer, unsigned int len, char *title, unsigned char csize, short mode)
+/* v1.3.35 Registered with atexit(): write out what is still queued */
+void dbx_log_exit(void)
 {
-   unsigned int n;
-   unsigned char *p8;
-   unsigned short *p16;
-   unsigned short c;
+   dbx_log_stop(&dbx_log);
+   dbx_log_stop(&dbx_trace_log); /* v1.3.36 */
 
-   p8 = NULL;
-   p16 = NULL;
+   return;
+}
 
-   if (csize == 16) {
-      p16 = (unsigned short *) buffer;
-   }
-   else {
-      p8 = (unsigned char *) buffer;
-   }
-   printf("\nbuffer dump (title=%s; size=%d; charsize=%u; mode=%d)...\n", title, len, csize, mode);
 
-   for (n = 0; n < len; n ++) {
-      if (csize == 16) {
-         c = p16[n];
-      }
-      else {
-         c = p8[n];
-      }
+/* v1.3.36 Stop a log writer.  The writer is not joined (which is unsafe while a DLL is being unloaded) but given a second to finish */
+int dbx_log_stop(DBXLOG *plog)
+{
+   int n;
 
-      if (mode == 1) {
-         printf("\\x%04x ", c);
-         if (!((n + 1) % 8)) {
-            printf("\r\n");
-         }
-      }
-      else {
-         if ((c < 32) || (c > 126)) {
-            if (csize == 16) {
-               printf("\\x%04x", c);
-            }
-            else {
-               printf("\\x%02x", c);
-            }
-         }
-         else {
-            printf("%c", (char) c);
-         }
-      }
+   if (plog->state != DBX_LOG_RUNNING) {
+      return 0;
+   }
+   plog->stop = 1;
+   for (n = 0; plog->state != DBX_LOG_STOPPED && n < 100; n ++) {
+      dbx_sleep(10);
+   }
+   if (plog->state == DBX_LOG_STOPPED) {
+      dbx_log_drain(plog);
+      dbx_log_flush(plog);
+      dbx_log_file_close(plog);
    }
 
-   return 0;
+   return 1;
 }
 
 
-int dbx_log_event(DBXCON *pcon, char *message, char *title, int level)
+/* v1.3.36 Start tracing: one request in every (1 / sample_rate) is traced and its phases written as Chrome trace events */
+int dbx_trace_start(DBXCON *pcon, char *file, double sample_rate)
 {
-   int len, n;
-   char timestr[64], heading[256];
-   char *p_buffer;
-   time_t now = 0;
-#if defined(_WIN32)
-   HANDLE hLogfile = 0;
-   DWORD dwPos = 0, dwBytesWritten = 0;
-#else
-   FILE *fp = NULL;
-   struct flock lock;
-#endif
-
-#ifdef _WIN32
-__try {
-#endif
+   char event[256];
 
-   p_buffer = NULL;
+   if (pcon->trace.active) {
+      dbx_trace_stop(pcon);
+   }
+   if (!dbx_trace_log.configured) {
+      dbx_trace_log.configured = 1;
+      dbx_trace_log.sync = 0;
+      dbx_trace_log.notes = 0; /* the file must remain valid JSON */
+      dbx_trace_log.max_size = 0;
+      dbx_trace_log.files = 0;
+   }
 
-   now = time(NULL);
-   sprintf(timestr, "%s", ctime(&now));
-   for (n = 0; timestr[n] != '\0'; n ++) {
-      if ((unsigned int) timestr[n] < 32) {
-         timestr[n] = '\0';
-         break;
-      }
+   strncpy(pcon->trace.file, file, sizeof(pcon->trace.file) - 1);
+   pcon->trace.file[sizeof(pcon->trace.file) - 1] = '\0';
+   pcon->trace.sample_rate = sample_rate;
+   pcon->trace.interval = (unsigned int) ((1.0 / sample_rate) + 0.5);
+   if (pcon->trace.interval < 1) {
+      pcon->trace.interval = 1;
    }
-/*
-   sprintf(heading, ">>> Time: %s; Build: %s pid=%lu;tid=%lu;req_no=%lu;fun_no=%lu", timestr, (char *) DBX_VERSION, (unsigned long) dbx_current_process_id(), (unsigned long) dbx_current_thread_id(), p_log->req_no, p_log->fun_no);
-*/
+   pcon->trace.counter = 0;
+   pcon->trace.events = 0;
 
-   sprintf(heading, ">>> Time: %s; Build: %s pid=%lu;tid=%lu;", timestr, (char *) DBX_VERSION, (unsigned long) dbx_current_process_id(), (unsigned long) dbx_current_thread_id());
+   /* JSON Array Format: the closing bracket is written by dbx_trace_stop() but is optional for the viewers */
+   sprintf(event, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,\"args\":{\"name\":\"mg-dbx-bdb %s\"}}",
+      (unsigned long) dbx_current_process_id(), (char *) DBX_VERSION);
+   dbx_trace_event(pcon, event, 'w');
 
-   len = (int) strlen(heading) + (int) strlen(title) + (int) strlen(message) + 20;
+   DBX_MEMORY_BARRIER();
+   pcon->trace.active = 1;
 
-   p_buffer = (char *) dbx_malloc(sizeof(char) * len, 0);
+   return 1;
+}
 
-   if (p_buffer == NULL) {
+
+int dbx_trace_stop(DBXCON *pcon)
+{
+   char event[256];
+
+   if (!pcon->trace.active) {
       return 0;
    }
+   pcon->trace.active = 0;
+   DBX_MEMORY_BARRIER();
 
-   p_buffer[0] = '\0';
-   strcpy(p_buffer, heading);
-   strcat(p_buffer, "\r\n    ");
-   strcat(p_buffer, title);
-   strcat(p_buffer, "\r\n    ");
-   strcat(p_buffer, message);
-   len = (int) strlen(p_buffer) * sizeof(char);
+   sprintf(event, "{\"name\":\"trace_stop\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu}\n]",
+      (double) dbx_clock_ns() / 1000.0, (unsigned long) dbx_current_process_id(), (unsigned long) dbx_current_thread_id());
+   dbx_trace_event(pcon, event, 'a');
 
-#if defined(_WIN32)
+   return 1;
+}
 
-   strcat(p_buffer, "\r\n");
-   len = len + (2 * sizeof(char));
-   hLogfile = CreateFileA(pcon->log_file, GENERIC_WRITE, FILE_SHARE_WRITE,
-                         (LPSECURITY_ATTRIBUTES) NULL, OPEN_ALWAYS,
-                         FILE_ATTRIBUTE_NORMAL, (HANDLE) NULL);
-   dwPos = SetFilePointer(hLogfile, 0, (LPLONG) NULL, FILE_END);
-   LockFile(hLogfile, dwPos, 0, dwPos + len, 0);
-   WriteFile(hLogfile, (LPTSTR) p_buffer, len, &dwBytesWritten, NULL);
-   UnlockFile(hLogfile, dwPos, 0, dwPos + len, 0);
-   CloseHandle(hLogfile);
 
-#else /* UNIX or VMS */
+/* v1.3.36 Called for each new request while tracing is active: decide whether it is one of the sampled requests */
+int dbx_trace_sample(DBXMETH *pmeth)
+{
+   unsigned int n, interval;
+   DBXCON *pcon = pmeth->pcon;
 
-   strcat(p_buffer, "\n");
-   fp = fopen(pcon->log_file, "a");
-   if (fp) {
+   interval = pcon->trace.interval;
+   n = (unsigned int) DBX_ATOMIC_INC32(&(pcon->trace.counter));
+   if (interval > 1 && (n % interval)) {
+      return 0;
+   }
+   pmeth->trace = (n / interval) + 1;
+   pmeth->ttrace = dbx_clock_ns();
 
-      lock.l_type = F_WRLCK;
-      lock.l_start = 0;
-      lock.l_whence = SEEK_SET;
-      lock.l_len = 0;
-      n = fcntl(fileno(fp), F_SETLKW, &lock);
+   return 1;
+}
 
-      fputs(p_buffer, fp);
-      /* fclose(fp); */
 
-      lock.l_type = F_UNLCK;
-      lock.l_start = 0;
-      lock.l_whence = SEEK_SET;
-      lock.l_len = 0;
-      n = fcntl(fileno(fp), F_SETLK, &lock);
-      fclose(fp); /* v1.3.14 */
-   }
+/* v1.3.36 Record a phase of a traced request as a complete ('X') event on the thread that ran it */
+int dbx_trace_span(DBXMETH *pmeth, int phase, unsigned long long tstart, unsigned long long tend)
+{
+   char *name, *cmnd;
+   char event[384];
+   DBXCON *pcon = pmeth->pcon;
+   static const char *phases[] = {"request", "marshal", "lock", "queue", "engine", "result"};
 
-#endif
+   if (!pmeth->trace || !pcon->trace.active) {
+      return 0;
+   }
 
-   if (p_buffer) {
-      dbx_free((void *) p_buffer, 0);
+   cmnd = (char *) ((pmeth->trace_cmnd >= 0 && pmeth->trace_cmnd < DBX_STATS_CMNDS) ? dbx_stats_cmnds[pmeth->trace_cmnd] : "request");
+   name = (char *) (phase == DBX_TRACE_REQUEST ? cmnd : phases[phase]);
+   if (tend < tstart) {
+      tend = tstart;
    }
 
-   return 1;
+   sprintf(event, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu,\"args\":{\"request\":%u,\"cmnd\":\"%s\"}}",
+      name, phases[phase], (double) tstart / 1000.0, (double) (tend - tstart) / 1000.0,
+      (unsigned long) dbx_current_process_id(), (unsigned long) dbx_current_thread_id(), pmeth->trace, cmnd);
+   DBX_ATOMIC_ADD64(&(pcon->trace.events), 1);
 
-#ifdef _WIN32
+   return dbx_trace_event(pcon, event, 'a');
 }
-__except (EXCEPTION_EXECUTE_HANDLER) {
+
+
+/* v1.3.36 Queue a trace event for the trace writer: events are separated by commas as they are written */
+int dbx_trace_event(DBXCON *pcon, char *event, char mode)
+{
+   int len, flen;
+   char *p_buffer, *p_text;
+
+   flen = (int) strlen(pcon->trace.file) + 2;
+   len = flen + (int) strlen(event) + 4;
+   p_buffer = (char *) dbx_malloc(sizeof(char) * len, DBX_MEMID_LOG);
+   if (!p_buffer) {
       return 0;
-}
+   }
 
-#endif
+   p_buffer[0] = mode;
+   strcpy(p_buffer + 1, pcon->trace.file);
+   p_text = p_buffer + flen;
+   strcpy(p_text, event);
+   strcat(p_text, (event[strlen(event) - 1] == ']' ? "\n" : ",\n"));
+
+   if (dbx_log_queue(&dbx_trace_log, p_buffer)) {
+      return 1;
+   }
+
+   dbx_log_write(pcon->trace.file, p_text, (int) strlen(p_text), mode);
+   dbx_free((void *) p_buffer, 0);
 
+   return 1;
 }
 
 
@@ -9284,12 +17371,14 @@ int dbx_mutex_create(DBXMUTEX *p_mutex)
 int dbx_mutex_lock(DBXMUTEX *p_mutex, int timeout)
 {
    int result;
+   unsigned long long twait;
    DBXTHID tid;
 #ifdef _WIN32
    DWORD result_wait;
 #endif
 
    result = 0;
+   twait = 0;
 
    if (!p_mutex->created) {
       return -1;
@@ -9303,11 +17392,20 @@ int dbx_mutex_lock(DBXMUTEX *p_mutex, int timeout)
    }
 
 #if defined(_WIN32)
-   if (timeout == 0) {
-      result_wait = WaitForSingleObject(p_mutex->h_mutex, INFINITE);
+   result_wait = WAIT_TIMEOUT;
+   if (dbx_lock_stats_enabled) { /* v1.3.37 try the lock first to detect contention */
+      result_wait = WaitForSingleObject(p_mutex->h_mutex, 0);
+      if (result_wait == WAIT_TIMEOUT) {
+         twait = dbx_clock_ns();
+      }
    }
-   else {
-      result_wait = WaitForSingleObject(p_mutex->h_mutex, (timeout * 1000));
+   if (result_wait == WAIT_TIMEOUT) {
+      if (timeout == 0) {
+         result_wait = WaitForSingleObject(p_mutex->h_mutex, INFINITE);
+      }
+      else {
+         result_wait = WaitForSingleObject(p_mutex->h_mutex, (timeout * 1000));
+      }
    }
 
    if (result_wait == WAIT_OBJECT_0) { /* success */
@@ -9330,12 +17428,25 @@ int dbx_mutex_lock(DBXMUTEX *p_mutex, int timeout)
       result = -1;
    }
 #else
-   result = pthread_mutex_lock(&(p_mutex->h_mutex));
+   if (dbx_lock_stats_enabled) { /* v1.3.37 try the lock first to detect contention */
+      result = pthread_mutex_trylock(&(p_mutex->h_mutex));
+      if (result == EBUSY) {
+         twait = dbx_clock_ns();
+         result = pthread_mutex_lock(&(p_mutex->h_mutex));
+      }
+   }
+   else {
+      result = pthread_mutex_lock(&(p_mutex->h_mutex));
+   }
 #endif
 
    p_mutex->thid = tid;
    p_mutex->stack = 0;
 
+   if (dbx_lock_stats_enabled && result == 0) {
+      dbx_lock_stats_acquired(&(p_mutex->stats), twait);
+   }
+
    return result;
 }
 
@@ -9360,6 +17471,10 @@ int dbx_mutex_unlock(DBXMUTEX *p_mutex)
    p_mutex->thid = 0;
    p_mutex->stack = 0;
 
+   if (p_mutex->stats.tacquired) {
+      dbx_lock_stats_released(&(p_mutex->stats));
+   }
+
 #if defined(_WIN32)
    ReleaseMutex(p_mutex->h_mutex);
    result = 0;
@@ -9420,6 +17535,96 @@ int dbx_leave_critical_section(void *p_crit)
 }
 
 
+/* v1.3.37 Record an acquisition of a lock (called by the thread now holding it): twait is when a contended wait started */
+int dbx_lock_stats_acquired(DBXLOCKSTATS *plstats, unsigned long long twait)
+{
+   unsigned long long tnow, wait;
+
+   tnow = dbx_clock_ns();
+   plstats->acquisitions ++;
+   if (twait) {
+      wait = (tnow > twait) ? (tnow - twait) : 0;
+      plstats->contended ++;
+      plstats->wait += wait;
+      if (wait > plstats->wait_max) {
+         plstats->wait_max = wait;
+      }
+   }
+   plstats->tacquired = tnow;
+
+   return 1;
+}
+
+
+/* v1.3.37 Record the time for which a lock was held (called by the thread holding it, just before it is released) */
+int dbx_lock_stats_released(DBXLOCKSTATS *plstats)
+{
+   unsigned long long tnow, hold;
+
+   if (!plstats->tacquired) {
+      return 0;
+   }
+   tnow = dbx_clock_ns();
+   hold = (tnow > plstats->tacquired) ? (tnow - plstats->tacquired) : 0;
+   plstats->tacquired = 0;
+   plstats->hold += hold;
+   if (hold > plstats->hold_max) {
+      plstats->hold_max = hold;
+   }
+
+   return 1;
+}
+
+
+/* v1.3.37 Clear the statistics for a lock: the lock may be held, so the time at which it was acquired is kept */
+int dbx_lock_stats_reset(DBXLOCKSTATS *plstats)
+{
+   unsigned long long tacquired;
+
+   tacquired = plstats->tacquired;
+   memset((void *) plstats, 0, sizeof(DBXLOCKSTATS));
+   plstats->tacquired = tacquired;
+
+   return 1;
+}
+
+
+#if !defined(_WIN32)
+/* v1.3.37 Lock one of the thread pool's mutexes, recording contention if lock statistics are enabled */
+int dbx_pool_mutex_lock(pthread_mutex_t *p_mutex, DBXLOCKSTATS *plstats)
+{
+   int result;
+   unsigned long long twait;
+
+   if (!dbx_lock_stats_enabled) {
+      return pthread_mutex_lock(p_mutex);
+   }
+
+   twait = 0;
+   result = pthread_mutex_trylock(p_mutex);
+   if (result == EBUSY) {
+      twait = dbx_clock_ns();
+      result = pthread_mutex_lock(p_mutex);
+   }
+   if (result == 0) {
+      dbx_lock_stats_acquired(plstats, twait);
+   }
+
+   return result;
+}
+
+
+int dbx_pool_mutex_unlock(pthread_mutex_t *p_mutex, DBXLOCKSTATS *plstats)
+{
+   if (plstats->tacquired) {
+      dbx_lock_stats_released(plstats);
+   }
+
+   return pthread_mutex_unlock(p_mutex);
+}
+#endif
+
+
 int dbx_sleep(unsigned long msecs)
 {
 #if defined(_WIN32)
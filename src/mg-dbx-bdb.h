@@ -33,7 +33,7 @@
 
 #define DBX_VERSION_MAJOR        "1"
 #define DBX_VERSION_MINOR        "3"
-#define DBX_VERSION_BUILD        "14"
+#define DBX_VERSION_BUILD      "39"
 
 #define DBX_VERSION              DBX_VERSION_MAJOR "." DBX_VERSION_MINOR "." DBX_VERSION_BUILD
 
@@ -210,6 +210,7 @@ DISABLE_WCAST_FUNCTION_TYPE
 #define DBX_DTYPE_OREF           7
 #define DBX_DTYPE_NULL           10
 #define DBX_DTYPE_STROBJ         11
+#define DBX_DTYPE_BOOL           12
 
 #define DBX_CMND_OPEN            1
 #define DBX_CMND_CLOSE           2
@@ -238,6 +239,9 @@ DISABLE_WCAST_FUNCTION_TYPE
 #define DBX_CMND_GNAMEPREVIOUS   52
 
 #define DBX_DB_SIZE              50000000
+#define DBX_DB_GROWTH            2.0
+#define DBX_MAX_DBS              16
+#define DBX_MAX_GLOBAL_DBS       256
 
 #if defined(MAX_PATH) && (MAX_PATH>511)
 #define DBX_MAX_PATH             MAX_PATH
@@ -498,6 +502,112 @@ DISABLE_WCAST_FUNCTION_TYPE
 
 #define DBX_DBFUN_END(C)
 
+/* v1.3.23 */
+#define DBX_COMPRESS_DEFAULT        -1
+#define DBX_COMPRESS_NONE           0
+#define DBX_COMPRESS_LZ4            1
+#define DBX_COMPRESS_MIN_SIZE       512
+#define DBX_ZHEADER_SIZE            8
+/* v1.3.27 values that begin with the header bytes (0x00 0xDB) are escaped: stored as a packed value with algorithm DBX_COMPRESS_NONE */
+#define DBX_ZUNPACK_VERBATIM        2
+#define DBX_RECORD_TYPED            0x0001
+
+/* v1.3.24 typed values are stored as 0x00 0xDB <tag> <payload> */
+#define DBX_TVALUE_NONE             0
+#define DBX_TVALUE_IN               1
+#define DBX_TVALUE_OUT              2
+#define DBX_TVALUE_INT64            'I'
+#define DBX_TVALUE_DOUBLE           'D'
+#define DBX_TVALUE_BOOL             'B'
+#define DBX_TVALUE_HEADER_SIZE      3
+#define DBX_TVALUE_MAX_SIZE         11
+
+/* v1.3.26 size of the batches of records read when secondary indexes are built or purged */
+#define DBX_INDEX_BATCH             1048576
+
+/* v1.3.27 nodes with a time to live are stored with a 12 byte header: 0x00 0xDB 'E' 0x00 <deadline (ms): 8 bytes, little endian> */
+#define DBX_EHEADER_SIZE            12
+#define DBX_TTL_GLOBAL              "%dbxttl"
+#define DBX_TTL_SWEEP               60
+#define DBX_TTL_BATCH               1000
+#define DBX_TTL_TICK                250
+
+/* v1.3.31 native benchmark workloads */
+#define DBX_BENCH_GET               1
+#define DBX_BENCH_SET               2
+#define DBX_BENCH_NEXT              3
+#define DBX_BENCH_QUERY             4
+#define DBX_BENCH_INCREMENT         5
+#define DBX_BENCH_MAX_THREADS       64
+#define DBX_BENCH_GLOBAL            "dbxbench"
+
+/* v1.3.33 operation statistics: log-linear latency histograms (2^DBX_STATS_SUB_BITS buckets per power of two nanoseconds) */
+#define DBX_STATS_SET               0
+#define DBX_STATS_GET               1
+#define DBX_STATS_NEXT              2
+#define DBX_STATS_PREVIOUS          3
+#define DBX_STATS_DELETE            4
+#define DBX_STATS_DEFINED           5
+#define DBX_STATS_INCREMENT         6
+#define DBX_STATS_LOCK              7
+#define DBX_STATS_UNLOCK            8
+#define DBX_STATS_MERGE             9
+#define DBX_STATS_QUERY             10
+#define DBX_STATS_CMNDS             11
+
+#define DBX_STATS_SYNC              0
+#define DBX_STATS_ASYNC             1
+#define DBX_STATS_QUEUE             2
+#define DBX_STATS_PATHS             3
+
+#define DBX_STATS_SHARDS            4
+#define DBX_STATS_SUB_BITS          3
+#define DBX_STATS_MAX_BITS          40
+#define DBX_STATS_BUCKETS           ((DBX_STATS_MAX_BITS + 2 - DBX_STATS_SUB_BITS) << DBX_STATS_SUB_BITS)
+
+/* v1.3.35 buffered event log: records are queued in a ring and written by a background thread */
+#define DBX_LOG_SLOTS               8192 /* must be a power of 2 */
+#define DBX_LOG_BATCH               65536
+#define DBX_LOG_TICK                20
+#define DBX_LOG_MAX_SIZE            67108864
+#define DBX_LOG_FILES               4
+
+/* v1.3.36 phases of a traced request */
+#define DBX_TRACE_REQUEST           0
+#define DBX_TRACE_MARSHAL           1
+#define DBX_TRACE_LOCK              2
+#define DBX_TRACE_QUEUE             3
+#define DBX_TRACE_ENGINE            4
+#define DBX_TRACE_RESULT            5
+
+#define DBX_LOG_IDLE                0
+#define DBX_LOG_STARTING            1
+#define DBX_LOG_RUNNING             2
+#define DBX_LOG_STOPPED             3
+
+/* v1.3.29 durability of LMDB commits (and BDB transactions) */
+#define DBX_SYNC_FULL               0
+#define DBX_SYNC_META               1
+#define DBX_SYNC_NONE               2
+
+/* v1.3.22 */
+#define DBX_RANGE_READ              0
+#define DBX_RANGE_WRITE             1
+#define DBX_RANGE_APPEND            2
+
+/* v1.3.22 LMDB values extended beyond DBX_CHUNK_SIZE by the range functions are held in chunks: ^%dbxchunk(<key of the node>,<chunk number>) */
+/* the node's own record is a 16 byte header: 0x00 0xDB 'C' 0x00 <length: 8 bytes, little endian> <chunk size: 4 bytes, little endian> */
+#define DBX_CHEADER_SIZE            16
+#define DBX_CHUNK_GLOBAL            "%dbxchunk"
+#define DBX_CHUNK_SIZE              65536
+#define DBX_CHUNK_KEY_MAX           511
+
+/* v1.3.15 */
+#define DBX_LMDB_DBI(PMETH)         (PMETH->pgdb ? PMETH->pgdb->dbi : PMETH->pcon->p_lmdb_so->db)
+#define DBX_BDB_PDB(PMETH)          (PMETH->pgdb ? PMETH->pgdb->pdb : PMETH->pcon->p_bdb_so->pdb)
+/* v1.3.15 with global_dbs the main database holds the directory of globals: a global with no database of its own is undefined */
+#define DBX_GLOBAL_UNDEFINED(PMETH) (PMETH->pcon->global_dbs && !PMETH->pgdb)
+
 #define DBX_DB_LOCK(TIMEOUT) \
    if (pcon->use_mutex) { \
       dbx_mutex_lock(pcon->p_mutex, TIMEOUT); \
@@ -518,6 +628,44 @@ DISABLE_WCAST_FUNCTION_TYPE
       RC = dbx_mutex_unlock(pcon->p_mutex); \
    } \
 
+/* v1.3.33 lock-free counters */
+#if defined(_WIN32)
+#define DBX_ATOMIC_INC32(P)         InterlockedIncrement((volatile LONG *) (P))
+#define DBX_ATOMIC_ADD64(P, N)      InterlockedExchangeAdd64((volatile LONGLONG *) (P), (LONGLONG) (N))
+#define DBX_ATOMIC_CAS64(P, O, N)   (InterlockedCompareExchange64((volatile LONGLONG *) (P), (LONGLONG) (N), (LONGLONG) (O)) == (LONGLONG) (O))
+#define DBX_ATOMIC_CAS32(P, O, N)   (InterlockedCompareExchange((volatile LONG *) (P), (LONG) (N), (LONG) (O)) == (LONG) (O))
+#define DBX_MEMORY_BARRIER()        MemoryBarrier()
+#else
+#define DBX_ATOMIC_INC32(P)         __sync_fetch_and_add((P), 1)
+#define DBX_ATOMIC_ADD64(P, N)      __sync_fetch_and_add((P), (N))
+#define DBX_ATOMIC_CAS64(P, O, N)   __sync_bool_compare_and_swap((P), (O), (N))
+#define DBX_ATOMIC_CAS32(P, O, N)   __sync_bool_compare_and_swap((P), (O), (N))
+#define DBX_MEMORY_BARRIER()        __sync_synchronize()
+#endif
+
+/* v1.3.33 time an engine function: the start time is zero if statistics are not being collected */
+/* v1.3.33 requests made by db.benchmark() threads (pmeth->pbench set) are not counted */
+#define DBX_STATS_START(PCON, PMETH) \
+   (((PCON->pstats && !PMETH->pbench) || PCON->trace.active) ? dbx_clock_ns() : 0)
+
+/* v1.3.36 take the database lock: for a traced request the time spent waiting for it is recorded */
+#define DBX_DB_LOCK_TRACE(PMETH, TIMEOUT) \
+   if (pcon->use_mutex) { \
+      if (PMETH->trace && pcon->p_mutex->thid != dbx_current_thread_id()) { \
+         unsigned long long tlock = dbx_clock_ns(); \
+         dbx_mutex_lock(pcon->p_mutex, TIMEOUT); \
+         dbx_trace_span(PMETH, DBX_TRACE_LOCK, tlock, dbx_clock_ns()); \
+      } \
+      else { \
+         dbx_mutex_lock(pcon->p_mutex, TIMEOUT); \
+      } \
+   } \
+
+#define DBX_STATS_END(PMETH, CMND, TSTART, RC) \
+   if (TSTART) { \
+      dbx_stats_record(PMETH, CMND, TSTART, RC); \
+   } \
+
 
 typedef void      async_rtn;
 
@@ -556,6 +704,51 @@ typedef struct tagDBXZV {
 } DBXZV, *PDBXZV;
 
 
+/* v1.3.38 allocation accounting: the call site (or purpose) of each block is identified by the id passed to dbx_malloc() */
+#define DBX_MEMID_OTHER          0
+#define DBX_MEMID_CON            1
+#define DBX_MEMID_METH           2
+#define DBX_MEMID_QR             3
+#define DBX_MEMID_KEY            4
+#define DBX_MEMID_BUFFER         5
+#define DBX_MEMID_VALUE          6
+#define DBX_MEMID_GLOBAL         7
+#define DBX_MEMID_CURSOR         8
+#define DBX_MEMID_INDEX          9
+#define DBX_MEMID_ENGINE         10
+#define DBX_MEMID_TASK           11
+#define DBX_MEMID_LOG            12
+#define DBX_MEMID_BENCH          13
+#define DBX_MEMID_STORE          14
+#define DBX_MEMID_MAX            15
+
+/* v1.3.38 every block carries its size and id so that it can be accounted for when it is freed (16 bytes to preserve alignment) */
+typedef struct tagDBXMEMHDR {
+   unsigned int      size;
+   unsigned int      epoch; /* non-zero if counted: blocks allocated before the last reset are not deducted */
+   int               id;
+   int               spare;
+} DBXMEMHDR, *PDBXMEMHDR;
+
+typedef struct tagDBXMEMSTATS {
+   volatile long long   live;
+   volatile long long   blocks;
+   volatile long long   allocations;
+   volatile long long   frees;
+   volatile long long   high_water;
+} DBXMEMSTATS, *PDBXMEMSTATS;
+
+/* v1.3.37 contention statistics for a lock: only updated by the thread holding the lock */
+typedef struct tagDBXLOCKSTATS {
+   unsigned long long   acquisitions;
+   unsigned long long   contended;
+   unsigned long long   wait;
+   unsigned long long   wait_max;
+   unsigned long long   hold;
+   unsigned long long   hold_max;
+   unsigned long long   tacquired;
+} DBXLOCKSTATS, *PDBXLOCKSTATS;
+
 typedef struct tagDBXMUTEX {
    unsigned char     created;
    int               stack;
@@ -565,6 +758,7 @@ typedef struct tagDBXMUTEX {
    pthread_mutex_t   h_mutex;
 #endif /* #if defined(_WIN32) */
    DBXTHID           thid;
+   DBXLOCKSTATS      stats; /* v1.3.37 */
 } DBXMUTEX, *PDBXMUTEX;
 
 typedef struct tagDBXTID {
@@ -643,6 +837,7 @@ typedef struct {
 #define CACHE_STRTOOLONG      -3
 #define CACHE_ALREADYCON      -2
 #define CACHE_FAILURE	      -1
+#define DBX_GDB_FULL          -17 /* v1.3.15 the table of global databases is full (max_dbs) */
 #define CACHE_SUCCESS 	      0
 
 #define CACHE_ERMXSTR         5
@@ -731,9 +926,137 @@ typedef struct tagDBXVAL {
 } DBXVAL, *PDBXVAL;
 
 
+/* v1.3.16 global name and fixed subscripts of a mglobal object, encoded once */
+typedef struct tagDBXKPFX {
+   int            argc;
+   unsigned int   len;
+   char *         buffer;
+   DBXVAL *       args;
+} DBXKPFX, *PDBXKPFX;
+
+/* v1.3.23 value compression policy */
+typedef struct tagDBXCOMP {
+   short          algo;
+   unsigned int   min_size;
+} DBXCOMP, *PDBXCOMP;
+
+/* v1.3.30 BDB environment and database configuration */
+typedef struct tagDBXBDBCFG {
+   size_t         cache_size; /* 0: library default */
+   int            cache_regions;
+   unsigned int   page_size;
+   unsigned int   minkey;
+   size_t         mmap_size;
+   short          txn; /* DB_INIT_TXN | DB_INIT_LOCK | DB_INIT_LOG rather than DB_INIT_CDB */
+} DBXBDBCFG, *PDBXBDBCFG;
+
+/* v1.3.33 latency histogram (nanoseconds) */
+typedef struct tagDBXHIST {
+   unsigned long long count;
+   unsigned long long total;
+   unsigned long long max;
+   unsigned int   bucket[DBX_STATS_BUCKETS];
+} DBXHIST, *PDBXHIST;
+
+/* v1.3.33 statistics for a connection: each thread updates the shard selected by its thread id */
+typedef struct tagDBXSTATSHARD {
+   DBXHIST        hist[DBX_STATS_CMNDS][DBX_STATS_PATHS];
+   unsigned long long errors[DBX_STATS_CMNDS];
+} DBXSTATSHARD, *PDBXSTATSHARD;
+
+typedef struct tagDBXSTATS {
+   unsigned long long reset; /* time (ms) at which collection started */
+   DBXSTATSHARD   shard[DBX_STATS_SHARDS];
+} DBXSTATS, *PDBXSTATS;
+
+/* v1.3.35 event log ring: a slot may be filled when seq equals the producer's position and read when it equals position + 1 */
+typedef struct tagDBXLOGREC {
+   volatile unsigned int seq;
+   char *         record; /* mode ('a' to append, 'w' to start a new file), log file name, '\0', text of the record */
+} DBXLOGREC, *PDBXLOGREC;
+
+typedef struct tagDBXLOG {
+   volatile int   state;
+   short          configured;
+   short          sync; /* write each record as it is logged (the original behaviour) */
+   short          stop;
+   short          notes; /* write notes (such as the number of records dropped) into the file */
+   size_t         max_size; /* rotate the file when it reaches this size: 0 to disable */
+   int            files; /* number of rotated files kept */
+   volatile unsigned int head; /* next slot to be claimed by a producer */
+   unsigned int   tail; /* next slot to be written: only used by the writer */
+   volatile unsigned long long queued;
+   volatile unsigned long long dropped;
+   unsigned long long dropped_reported;
+   unsigned long long written;
+   unsigned long long rotations;
+   char           file[256]; /* the file currently open */
+   size_t         size;
+   char *         batch;
+   unsigned int   batch_len;
+#if defined(_WIN32)
+   HANDLE         hfile;
+   HANDLE         hthread;
+#else
+   FILE *         fp;
+   pthread_t      thread;
+#endif
+   DBXLOGREC      ring[DBX_LOG_SLOTS];
+} DBXLOG, *PDBXLOG;
+
+/* v1.3.26 secondary index maintained for a global: ^global(<key path>)=value is indexed as ^index(value,<value path>)="" */
+typedef struct tagDBXINDEX {
+   short          active;
+   char           global[256];
+   int            global_len;
+   char           index[256];
+   int            index_len;
+   int            keyn;
+   int            kpath_offs[DBX_MAXARGS];
+   int            kpath_len[DBX_MAXARGS]; /* -1: any subscript */
+   char *         kpath;
+   int            vpathn;
+   int            vpath[DBX_MAXARGS]; /* positions (from 1) of the subscripts that follow the value in the index */
+   struct tagDBXGDB * pgdb;
+   struct tagDBXKEY * pikey; /* work area for index keys */
+   struct tagDBXINDEX *pnext;
+} DBXINDEX, *PDBXINDEX;
+
+/* v1.3.36 sampled tracing of requests (db.trace()) */
+typedef struct tagDBXTRACE {
+   short          active;
+   double         sample_rate;
+   unsigned int   interval; /* one request in every 'interval' is traced */
+   volatile unsigned int counter;
+   volatile unsigned long long events;
+   char           file[256];
+} DBXTRACE, *PDBXTRACE;
+
+/* v1.3.27 background thread that removes expired nodes (v1.3.29 or flushes the database to disk) at a set interval */
+typedef struct tagDBXTIMER {
+   int            interval; /* seconds between runs: 0 disables the thread */
+   short          autostart;
+   short          running;
+   short          stop;
+#if defined(_WIN32)
+   HANDLE         hthread;
+#else
+   pthread_t      thread;
+#endif
+} DBXTIMER, *PDBXTIMER;
+
+#if defined(_WIN32)
+typedef LPTHREAD_START_ROUTINE (* DBXTHREADFUN) (LPVOID pargs);
+#else
+typedef void * (* DBXTHREADFUN) (void *pargs);
+#endif
+
 typedef struct tagDBXGREF {
    char *         global;
    DBXVAL *       pkey;
+   struct tagDBXGDBREF * pgdbref; /* v1.3.15 */
+   DBXKPFX *      pkpfx; /* v1.3.16 */
+   DBXCOMP *      pcomp; /* v1.3.23 */
 } DBXGREF, *PDBXGREF;
 
 typedef struct tagDBXFREF {
@@ -777,6 +1100,42 @@ typedef struct tagDBXSQL {
 #define DBX_KEYTYPE_M         3
 
 
+/* v1.3.15 */
+typedef struct tagDBXGDB {
+   short          open;
+   int            name_len;
+   char           name[256];
+   MDB_dbi        dbi; /* LMDB named database for this global */
+   DB *           pdb; /* BDB sub-database for this global */
+} DBXGDB, *PDBXGDB;
+
+
+/* v1.3.15 position of a global's database in the p_gdb table, as cached by an mglobal object */
+typedef struct tagDBXGDBREF {
+   int            index;
+   unsigned int   gen; /* pcon->gdb_gen when the position was recorded: the table is rebuilt when the environment is reopened */
+} DBXGDBREF, *PDBXGDBREF;
+
+
+/* v1.3.20 read snapshot pinned by get_view() buffers */
+typedef struct tagDBXSNAP {
+   MDB_txn *         ptxn;
+   mdb_size_t        txnid; /* last committed transaction when the snapshot was taken */
+   int               refs; /* number of live buffers referencing the snapshot */
+   struct tagDBXCON *pcon;
+   struct tagDBXSNAP *pnext;
+   struct tagDBXVIEW *pview; /* v1.3.20 */
+} DBXSNAP, *PDBXSNAP;
+
+
+/* v1.3.20 get_view() buffer: its ArrayBuffer is detached when the connection is closed */
+typedef struct tagDBXVIEW {
+   v8::Global<v8::ArrayBuffer> * pab; /* weak */
+   struct tagDBXSNAP *psnap;
+   struct tagDBXVIEW *pnext;
+} DBXVIEW, *PDBXVIEW;
+
+
 typedef struct tagDBXBDBSO {
    short             loaded;
    int               no_connections;
@@ -789,6 +1148,12 @@ typedef struct tagDBXBDBSO {
    DBXZV             zv;
    DB *              pdb; /* DB structure handle */
    DB_ENV *          penv; /* DB environment handle */
+   short             global_dbs; /* v1.3.15 one sub-database per global */
+   int               max_dbs;
+   int               gdb_count;
+   DBXGDB *          p_gdb;
+   int *             p_gdb_hash; /* v1.3.15 hash index of p_gdb (entry number + 1, zero if the slot is free) */
+   unsigned int      gdb_hash_mask;
 
    int               (* p_db_env_create)        (DB_ENV **penv, u_int32_t flags);
    int               (* p_db_create)            (DB **pdb, DB_ENV *dbenv, u_int32_t flags);
@@ -812,6 +1177,12 @@ typedef struct tagDBXLMDBSO {
    MDB_env *         penv; /* DB environment handle */
    MDB_txn *         ptxn; /* DB transaction handle */
    MDB_txn *         ptxnro; /* DB transaction handle - read only */
+   short             global_dbs; /* v1.3.15 one named database per global */
+   int               max_dbs;
+   int               gdb_count;
+   DBXGDB *          p_gdb;
+   int *             p_gdb_hash; /* v1.3.15 hash index of p_gdb (entry number + 1, zero if the slot is free) */
+   unsigned int      gdb_hash_mask;
 
    int               (* p_mdb_env_create)       (MDB_env **env);
    int               (* p_mdb_env_open)         (MDB_env *env, const char *path, unsigned int flags, mdb_mode_t mode);
@@ -819,6 +1190,10 @@ typedef struct tagDBXLMDBSO {
    int               (* p_mdb_env_set_maxdbs)   (MDB_env *env, MDB_dbi dbs);
    int               (* p_mdb_env_set_mapsize)  (MDB_env *env, size_t size);
    int               (* p_mdb_env_stat)         (MDB_env *env, MDB_stat *stat);
+   int               (* p_mdb_env_info)         (MDB_env *env, MDB_envinfo *stat);
+   int               (* p_mdb_env_sync)         (MDB_env *env, int force);
+   int               (* p_mdb_stat)             (MDB_txn *txn, MDB_dbi dbi, MDB_stat *stat); /* v1.3.34 optional */
+   int               (* p_mdb_reader_list)      (MDB_env *env, MDB_msg_func *func, void *ctx); /* v1.3.34 optional */
 
    int               (* p_mdb_txn_begin)        (MDB_env *env, MDB_txn *parent, unsigned int flags, MDB_txn **txn);
    int               (* p_mdb_txn_commit)       (MDB_txn *txn);
@@ -828,6 +1203,7 @@ typedef struct tagDBXLMDBSO {
 
    int               (* p_mdb_dbi_open)         (MDB_txn *txn, const char *name, unsigned int flags, MDB_dbi *dbi);
    void              (* p_mdb_dbi_close)        (MDB_env *env, MDB_dbi dbi);
+   int               (* p_mdb_drop)             (MDB_txn *txn, MDB_dbi dbi, int del);
 
    int               (* p_mdb_put)              (MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data, unsigned int flags);
    int               (* p_mdb_get)              (MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data);
@@ -846,6 +1222,7 @@ typedef struct tagDBXLMDBSO {
 
 typedef struct tagDBXCON {
    short          dbtype;
+   short          memdb; /* v1.3.39 in-memory engine (type "MEM") served through the LMDB interface */
    short          key_type;
    short          utf8;
    short          use_mutex;
@@ -854,7 +1231,25 @@ typedef struct tagDBXCON {
    char           db_library[256];
    char           db_file[256];
    size_t         db_size;
+   double         db_growth; /* v1.3.28 factor by which a full LMDB map is grown: 0 to disable */
+   size_t         db_size_max;
+   int            db_resizes;
    char           env_dir[256];
+   short          global_dbs; /* v1.3.15 */
+   int            max_dbs;
+   unsigned int   gdb_gen; /* v1.3.15 incremented whenever the connection is opened */
+   DBXCOMP        comp; /* v1.3.23 */
+   short          typed_values; /* v1.3.24 */
+   DBXINDEX       *pindex; /* v1.3.26 */
+   DBXTIMER       ttl; /* v1.3.27 */
+   DBXTIMER       flush; /* v1.3.29 */
+   DBXTRACE       trace; /* v1.3.36 */
+   short          sync_mode;
+   short          writemap;
+   short          readahead;
+   DBXBDBCFG      bdb; /* v1.3.30 */
+   short          stats; /* v1.3.33 */
+   DBXSTATS *     pstats;
    char           username[64];
    char           password[64];
    char           nspace[64];
@@ -873,6 +1268,7 @@ typedef struct tagDBXCON {
    int            tlevelro;
    int            tstatus;
    int            tstatusro;
+   DBXSNAP        *psnap; /* v1.3.20 */
 
    int            (* p_dbxfun) (struct tagDBXMETH * pmeth);
 
@@ -894,12 +1290,44 @@ typedef struct tagDBXKEY {
 } DBXKEY, *PDBXKEY;
 
 
+/* v1.3.31 benchmark run by db.benchmark(): each thread records the latency (ns) of its operations in its own part of the latency array */
+typedef struct tagDBXBENCH {
+   short          op;
+   short          random;
+   int            threads;
+   int            keys;
+   int            count; /* operations per thread */
+   int            subscripts;
+   int            value_size;
+   char           global[64];
+   char *         value;
+   unsigned int * latency;
+   int            errors;
+   struct tagDBXCON *pcon;
+} DBXBENCH, *PDBXBENCH;
+
+typedef struct tagDBXBENCHTHR {
+   int            tn;
+   int            errors;
+   int            not_found;
+   short          created;
+   DBXBENCH *     pbench;
+#if defined(_WIN32)
+   HANDLE         hthread;
+#else
+   pthread_t      thread;
+#endif
+} DBXBENCHTHR, *PDBXBENCHTHR;
+
+
 typedef struct tagDBXMETH {
    short          done;
    short          lock;
    short          increment;
+   short          update; /* v1.3.15 */
    int            binary;
    int            jsargc;
+   int            jsarg0; /* v1.3.21 first key argument */
    DBXKEY         key;
    DBXVAL         output_val;
    DBXVAL         output_key;
@@ -910,6 +1338,20 @@ typedef struct tagDBXMETH {
    char           error[DBX_ERROR_SIZE];
    DBC            *pbdbcursor;
    MDB_cursor     *plmdbcursor;
+   DBXGDB         *pgdb; /* v1.3.15 */
+   DBXGDBREF      *pgdbref; /* v1.3.15 */
+   DBXCOMP        *pcomp; /* v1.3.23 */
+   short          tvalue; /* v1.3.24 DBX_TVALUE_IN: the last argument is a value to be stored, DBX_TVALUE_OUT: the result is a stored value */
+   unsigned long long expiry; /* v1.3.27 deadline (ms) for the value to be stored: 0 if it does not expire */
+   short          typed; /* v1.3.27 the value to be stored (or indexed) is a typed value: it is not escaped */
+   short          json; /* v1.3.31 the result is a JSON document to be returned as an object */
+   DBXBENCH *     pbench; /* v1.3.31 */
+   unsigned long long tqueue; /* v1.3.33 time (ns) at which an asynchronous request was queued */
+   short          fast; /* v1.3.34 engine statistics: only report the values that are cheap to collect */
+   unsigned int   trace; /* v1.3.36 number of a sampled (traced) request: 0 if the request is not being traced */
+   short          trace_cmnd;
+   unsigned long long ttrace; /* time (ns) at which a traced request started */
+   unsigned long long tresult; /* time (ns) at which the conversion of the result started */
 } DBXMETH, *PDBXMETH;
 
 
@@ -949,7 +1391,7 @@ public:
    v8::Local<v8::Context>  icontext;
    short                   got_icontext;
 
-   static v8::Persistent<v8::Function> constructor;
+   static thread_local v8::Persistent<v8::Function> constructor; /* v1.3.32 one per isolate (worker thread) */
 
    struct dbx_baton_t {
       DBX_DBNAME *                  c;
@@ -998,6 +1440,12 @@ public:
    static void                   Get                              (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   Get_bx                           (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   GetEx                            (const v8::FunctionCallbackInfo<v8::Value>& args, int binary);
+   static void                   Get_view                         (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Get_into                         (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Read_range                       (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Write_range                      (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Append                           (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   RangeEx                          (const v8::FunctionCallbackInfo<v8::Value>& args, int mode);
    static void                   Set                              (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   Defined                          (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   Delete                           (const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -1006,6 +1454,16 @@ public:
    static void                   Increment                        (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   Lock                             (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   Unlock                           (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Define_index                     (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Sweep                            (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Map_size                         (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Sync                             (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Cache_stats                      (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Stats                            (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Engine_stats                     (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Trace                            (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Lock_stats                       (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Memory_stats                     (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   Sleep                            (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   MGlobal                          (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void                   MGlobal_Close                    (const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -1036,34 +1494,46 @@ void                       dbx_set_prototype_method   (v8::Handle<v8::FunctionTe
 
 v8::Local<v8::Object>      dbx_is_object              (v8::Local<v8::Value> value, int *otype);
 int                        dbx_string8_length         (v8::Isolate * isolate, v8::Local<v8::String> str, int utf8);
+int                        dbx_string8_bound          (v8::Isolate * isolate, v8::Local<v8::String> str, int utf8);
+int                        dbx_is_ascii               (char * buffer, unsigned long len);
 v8::Local<v8::String>      dbx_new_string8            (v8::Isolate * isolate, char * buffer, int utf8);
 v8::Local<v8::String>      dbx_new_string8n           (v8::Isolate * isolate, char * buffer, unsigned long len, int utf8);
+v8::Local<v8::Value>       dbx_new_value8n            (v8::Isolate * isolate, DBXCON *pcon, char * buffer, unsigned long len, int utf8);
+v8::Local<v8::Value>       dbx_new_data8n             (v8::Isolate * isolate, DBXCON *pcon, DBXVAL *pval, int utf8);
 int                        dbx_write_char8            (v8::Isolate * isolate, v8::Local<v8::String> str, char * buffer, int buffer_size, int utf8);
 
+int                        dbx_ibuffer_resize         (DBXKEY *pkey, int len);
 int                        dbx_ibuffer_add            (DBXMETH *pmeth, DBXKEY *pkey, v8::Isolate * isolate, int argn, v8::Local<v8::String> str, char * buffer, int buffer_len, short context);
 int                        dbx_is_number              (DBXVAL *pval);
 int                        dbx_set_number             (DBXVAL *pval, unsigned char *px);
 int                        dbx_split_key              (DBXVAL *keys, char * key, int key_len);
+int                        dbx_key_subscript          (DBXVAL *pval, char * key, int key_len, int offset);
+int                        dbx_key_under              (char * key, unsigned int key_len, char * prefix, unsigned int prefix_len);
+int                        dbx_key_compare            (char * key1, unsigned int key1_len, char * key2, unsigned int key2_len, int compare_max, short keytype);
+int                        dbx_key_successor          (DBXSTR *dbx_key, unsigned int key_len);
 int                        dbx_dump_key               (char * key, int key_len);
 int                        dbx_memcpy                 (void * to, void * from, size_t size);
 int                        dbx_memcpy_ex              (DBXSTR * to, void * from, size_t size);
 int                        dbx_memcpy_exx             (DBXSTR * to, void * from, size_t size);
 int                        dbx_cursor_init            (void *pcx);
 int                        dbx_global_reset           (const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pgx, int argc_offset, short context);
+DBXKPFX *                  dbx_key_prefix             (DBXMETH *pmeth, char *global_name, DBXVAL *pkey);
 int                        dbx_cursor_reset           (const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pcx, int argc_offset, short context);
 
 int                        bdb_load_library           (DBXCON *pcon);
 int                        bdb_open                   (DBXMETH *pmeth);
+int                        bdb_db_config              (DBXCON *pcon, DB *pdb);
 int                        bdb_parse_zv               (char *zv, DBXZV * p_bdb_sv);
 int                        bdb_next                   (DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context);
 int                        bdb_previous               (DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context);
 int                        bdb_key_compare            (DBT *key1, DBT *key2, int compare_max, short keytype);
-int                        bdb_get                    (DBXCON *pcon, DBT *key, DBT *data, DBXSTR *dbx_data);
+int                        bdb_get                    (DBXMETH *pmeth, DBT *key, DBT *data, DBXSTR *dbx_data);
 int                        bdb_cursor_get             (DBC *pcursor, DBT *key, DBXSTR *dbx_key, DBT *data, DBXSTR *dbx_data, int context);
 int                        bdb_resize_buffer          (DBT *key, DBXSTR *dbx_key, DBT *data, DBXSTR *dbx_data, int context);
 int                        bdb_error_message          (DBXCON *pcon, int error_code);
 
 int                        lmdb_load_library          (DBXCON *pcon);
+int                        memdb_load_library         (DBXCON *pcon);
 int                        lmdb_open                  (DBXMETH *pmeth);
 int                        lmdb_parse_zv              (char *zv, DBXZV * p_lmdb_sv);
 int                        lmdb_start_ro_transaction  (DBXMETH *pmeth, int context);
@@ -1073,6 +1543,12 @@ int                        lmdb_commit_qro_transaction(DBXMETH *pmeth, MDB_txn *
 int                        lmdb_next                  (DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context);
 int                        lmdb_previous              (DBXMETH *pmeth, DBXKEY *pkey, DBXVAL *pkeyval, DBXVAL *pdataval, int context);
 int                        lmdb_key_compare           (MDB_val *key1, MDB_val *key2, int compare_max, short keytype);
+int                        lmdb_view_snapshot         (DBXMETH *pmeth, DBXSNAP **ppsnap);
+void                       lmdb_view_release          (char *data, void *hint);
+void                       lmdb_view_free             (char *data, void *hint);
+int                        lmdb_view_detach           (v8::Isolate * isolate, DBXCON *pcon);
+int                        lmdb_view_close            (DBXCON *pcon);
+int                        lmdb_map_grow              (DBXMETH *pmeth, int cause, size_t min_size);
 int                        lmdb_error_message         (DBXCON *pcon, int error_code);
 
 int                        dbx_version                (DBXMETH *pmeth);
@@ -1080,22 +1556,116 @@ int                        dbx_open                   (DBXMETH *pmeth);
 int                        dbx_do_nothing             (DBXMETH *pmeth);
 int                        dbx_close                  (DBXMETH *pmeth);
 int                        dbx_global_reference       (DBXMETH *pmeth);
+DBXGDB *                   dbx_global_db_table        (int max_dbs, int **pp_hash, unsigned int *phash_mask);
+unsigned int               dbx_global_db_hash         (char *name, int name_len);
+int                        dbx_global_db              (DBXMETH *pmeth, char *name, int name_len, short create, DBXGDB **ppgdb);
+int                        dbx_global_db_drop         (DBXMETH *pmeth, DBXGDB *pgdb);
+int                        dbx_global_db_order        (DBXMETH *pmeth, DBXQR *pqr_prev, short dir);
+int                        dbx_global_db_close        (DBXCON *pcon);
 
 int                        dbx_get                    (DBXMETH *pmeth);
+int                        dbx_get_view               (DBXMETH *pmeth, MDB_val *pdata, DBXSNAP **ppsnap);
+int                        dbx_get_into               (DBXMETH *pmeth, char *buffer, size_t size, size_t *plen);
+size_t                     dbx_range_number           (DBXVAL *pval);
+int                        dbx_compression_options    (v8::Isolate * isolate, v8::Local<v8::Context> icontext, v8::Local<v8::Value> value, DBXCOMP *pcomp);
+int                        dbx_zpacked                (char *data, size_t len);
+size_t                     dbx_zlength                (char *data, size_t len);
+int                        dbx_zpack                  (DBXMETH *pmeth, char *data, size_t len, char **ppacked, size_t *ppacked_len);
+int                        dbx_zunpack                (char *data, size_t len, char *out, size_t out_size);
+int                        dbx_zunpack_str            (DBXSTR *pstr, char *data, size_t len);
+int                        dbx_zunpack_inplace        (DBXSTR *pstr);
+int                        dbx_zverbatim              (char *data, size_t len);
+int                        dbx_vpack                  (DBXMETH *pmeth, char *data, size_t len, char **ppacked, size_t *ppacked_len);
+unsigned long long         dbx_clock_ms               (void);
+unsigned long long         dbx_clock_ns               (void);
+unsigned long long         dbx_expiry                 (char *data, size_t len);
+int                        dbx_expired                (char *data, size_t len);
+int                        dbx_epack                  (DBXMETH *pmeth, char *data, size_t len, char **ppacked, size_t *ppacked_len);
+int                        dbx_set_options            (v8::Isolate * isolate, v8::Local<v8::Context> icontext, DBXMETH *pmeth, v8::Local<v8::Value> value);
+int                        dbx_index_options          (v8::Isolate * isolate, v8::Local<v8::Context> icontext, v8::Local<v8::Value> global, v8::Local<v8::Value> value, DBXINDEX **ppidx);
+int                        dbx_tvalue_encode          (v8::Isolate * isolate, v8::Local<v8::Context> icontext, v8::Local<v8::Value> value, char *buffer);
+int                        dbx_tvalue_number          (char *buffer, double value);
+int                        dbx_tvalue_decode          (char *data, size_t len, DBXVAL *pval);
+int                        dbx_tvalue_format          (char *data, size_t len, char *buffer);
+int                        dbx_read_range             (DBXMETH *pmeth);
+int                        dbx_write_range            (DBXMETH *pmeth);
+int                        dbx_append                 (DBXMETH *pmeth);
+int                        dbx_write_range_build      (DBXMETH *pmeth, size_t size, size_t offset, char *pdata, size_t dlen);
+int                        dbx_write_range_ex         (DBXMETH *pmeth, short append);
+int                        dbx_chunked                (char *data, size_t len, size_t *psize, unsigned int *pchunk_size);
+int                        dbx_chunk_key              (char *ckey, char *key, unsigned int key_len, int chunk);
+int                        lmdb_chunk_get             (DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, MDB_cursor *pcursor, MDB_val *pkey, unsigned int chunk_size, size_t offset, size_t length, char *out);
+int                        lmdb_chunk_str             (DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, MDB_cursor *pcursor, MDB_val *pkey, MDB_val *pdata, DBXSTR *pstr);
+int                        lmdb_chunk_put             (DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, MDB_val *pkey, size_t size, unsigned int chunk_size, size_t offset, char *pdata, size_t dlen);
+int                        lmdb_chunk_copy            (DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi sdbi, char *skey, unsigned int skey_len, MDB_dbi ddbi, char *dkey, unsigned int dkey_len, size_t size, unsigned int chunk_size);
+int                        lmdb_chunk_drop            (DBXMETH *pmeth, MDB_txn *ptxn, MDB_dbi dbi, char *key, unsigned int key_len, short subtree);
 int                        dbx_set                    (DBXMETH *pmeth);
 int                        dbx_defined                (DBXMETH *pmeth);
 int                        dbx_delete                 (DBXMETH *pmeth);
 int                        dbx_next                   (DBXMETH *pmeth);
 int                        dbx_previous               (DBXMETH *pmeth);
 int                        dbx_increment              (DBXMETH *pmeth);
+int                        dbx_increment_value        (DBXMETH *pmeth);
 int                        dbx_lock                   (DBXMETH *pmeth);
 int                        dbx_unlock                 (DBXMETH *pmeth);
 int                        dbx_merge                  (DBXMETH *pmeth);
+int                        dbx_record_add             (DBXSTR *precs, char *key, unsigned int key_len, char *data, unsigned int data_len, int flags);
+int                        dbx_record_get             (DBXSTR *precs, unsigned int *poffset, char **pkey, unsigned int *pkey_len, char **pdata, unsigned int *pdata_len, int *pflags);
+int                        dbx_set_object             (DBXMETH *pmeth, DBXSTR *precs);
+int                        dbx_get_object             (DBXMETH *pmeth, DBXSTR *precs, int *pcount);
+int                        dbx_index_open             (DBXMETH *pmeth);
+int                        dbx_index_open_ex          (DBXMETH *pmeth, char *global, int global_len);
+int                        dbx_index_key              (DBXMETH *pmeth, DBXINDEX *pidx, char *key, unsigned int key_len, char *data, unsigned int data_len);
+int                        dbx_index_put              (DBXMETH *pmeth, DBXINDEX *pidx, short del);
+int                        dbx_index_write            (DBXMETH *pmeth, char *key, unsigned int key_len, char *data, unsigned int data_len, short del, int *pcount);
+int                        dbx_index_update           (DBXMETH *pmeth, char *key, unsigned int key_len, char *data, unsigned int data_len);
+int                        dbx_index_apply            (DBXMETH *pmeth, char *prefix, unsigned int prefix_len, short del, int *pcount);
+int                        dbx_index_build            (DBXMETH *pmeth);
+int                        dbx_index_free             (DBXINDEX *pidx);
+int                        dbx_ttl_key                (DBXSTR *pkey, unsigned long long deadline, char *key, unsigned int key_len);
+int                        dbx_ttl_node               (char *tkey, unsigned int tkey_len, DBXSTR *pnode, unsigned long long *pdeadline);
+int                        dbx_ttl_put                (DBXMETH *pmeth, DBXGDB *pgdb, DBXSTR *pwork, char *key, unsigned int key_len);
+int                        dbx_ttl_sweep              (DBXMETH *pmeth);
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE     dbx_ttl_thread             (LPVOID pargs);
+#else
+void *                     dbx_ttl_thread             (void *pargs);
+#endif
+int                        dbx_sync                   (DBXMETH *pmeth);
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE     dbx_sync_thread            (LPVOID pargs);
+#else
+void *                     dbx_sync_thread            (void *pargs);
+#endif
+int                        dbx_timer_start            (DBXCON *pcon, DBXTIMER *ptimer, DBXTHREADFUN p_thread);
+int                        dbx_timer_stop             (DBXTIMER *ptimer);
+int                        dbx_benchmark              (DBXMETH *pmeth);
+int                        dbx_bench_key              (DBXMETH *pmeth, DBXKEY *pkey, DBXBENCH *pbench, int index);
+int                        dbx_bench_op               (DBXMETH *pmeth, DBXBENCH *pbench, DBXQR **pqr, int index, int *counter);
+int                        dbx_bench_compare          (const void *p1, const void *p2);
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE     dbx_bench_thread           (LPVOID pargs);
+#else
+void *                     dbx_bench_thread           (void *pargs);
+#endif
+int                        dbx_stats_record           (DBXMETH *pmeth, int cmnd, unsigned long long tstart, int rc);
+int                        dbx_stats_add              (DBXHIST *phist, unsigned long long ns);
+int                        dbx_stats_bucket           (unsigned long long ns);
+unsigned long long         dbx_stats_bucket_value     (int bucket);
+int                        dbx_stats_merge            (DBXSTATS *pstats, int cmnd, int path, DBXHIST *phist);
+unsigned long long         dbx_stats_percentile       (DBXHIST *phist, double q);
+int                        dbx_engine_stats           (DBXMETH *pmeth);
+int                        dbx_engine_stats_append    (DBXMETH *pmeth, char *item, int escape);
+int                        lmdb_engine_stats          (DBXMETH *pmeth);
+int                        lmdb_reader_count          (const char *msg, void *ctx);
+int                        bdb_engine_stats           (DBXMETH *pmeth);
+int                        bdb_tree_stats             (DBXMETH *pmeth, DB *pdb, DB_BTREE_STAT *ptotal, char *item);
 int                        dbx_sql_execute            (DBXMETH *pmeth);
 int                        dbx_sql_row                (DBXMETH *pmeth, int rn, int dir);
 int                        dbx_sql_cleanup            (DBXMETH *pmeth);
 
 int                        dbx_global_directory       (DBXMETH *pmeth, DBXQR *pqr_prev, short dir, int *counter);
+int                        dbx_global_live            (DBXMETH *pmeth, char *name, int name_len);
 int                        dbx_global_order           (DBXMETH *pmeth, DBXQR *pqr_prev, short dir, short getdata, int *counter);
 int                        dbx_global_query           (DBXMETH *pmeth, DBXQR *pqr_next, DBXQR *pqr_prev, short dir, short getdata, int *fixed_key_len, int *counter);
 int                        dbx_display_key            (char *key, int key_size, char *buffer);
@@ -1120,10 +1690,13 @@ unsigned long              dbx_get_size               (unsigned char *str, short
 void *                     dbx_realloc                (void *p, int curr_size, int new_size, short id);
 void *                     dbx_malloc                 (int size, short id);
 int                        dbx_free                   (void *p, short id);
+int                        dbx_mem_alloc              (DBXMEMHDR *phdr);
+int                        dbx_mem_release            (DBXMEMHDR *phdr);
 DBXQR *                    dbx_alloc_dbxqr            (DBXQR *pqr, int dsize, short context);
 int                        dbx_free_dbxqr             (DBXQR *pqr);
 int                        dbx_ucase                  (char *string);
 int                        dbx_lcase                  (char *string);
+size_t                     dbx_parse_size             (char *buffer);
 
 int                        dbx_create_string          (DBXSTR *pstr, void *data, short type);
 
@@ -1133,6 +1706,28 @@ int                        dbx_log_response           (DBXCON *pcon, char *ibuff
 int                        dbx_buffer_dump            (DBXMETH *pmeth, void *buffer, unsigned int len, char *title, unsigned char csize, short mode);
 int                        dbx_log_event              (DBXCON *pcon, char *message, char *title, int level);
 int                        dbx_log_buffer             (DBXCON *pcon, char *buffer, int buffer_len, char *title, int level);
+int                        dbx_log_write              (char *file, char *text, int len, char mode);
+int                        dbx_log_config             (DBXLOG *plog);
+int                        dbx_log_start              (DBXLOG *plog);
+int                        dbx_log_queue              (DBXLOG *plog, char *record);
+int                        dbx_log_drain              (DBXLOG *plog);
+int                        dbx_log_record             (DBXLOG *plog, char *file, char *text, unsigned int len, char mode);
+int                        dbx_log_flush              (DBXLOG *plog);
+int                        dbx_log_file_write         (DBXLOG *plog, char *text, unsigned int len);
+int                        dbx_log_file_close         (DBXLOG *plog);
+int                        dbx_log_rotate             (DBXLOG *plog);
+#if defined(_WIN32)
+LPTHREAD_START_ROUTINE     dbx_log_thread             (LPVOID pargs);
+#else
+void *                     dbx_log_thread             (void *pargs);
+#endif
+int                        dbx_log_stop               (DBXLOG *plog);
+void                       dbx_log_exit               (void);
+int                        dbx_trace_start            (DBXCON *pcon, char *file, double sample_rate);
+int                        dbx_trace_stop             (DBXCON *pcon);
+int                        dbx_trace_sample           (DBXMETH *pmeth);
+int                        dbx_trace_span             (DBXMETH *pmeth, int phase, unsigned long long tstart, unsigned long long tend);
+int                        dbx_trace_event            (DBXCON *pcon, char *event, char mode);
 int                        dbx_test_file_access       (char *file, int mode);
 DBXPLIB                    dbx_dso_load               (char * library);
 DBXPROC                    dbx_dso_sym                (DBXPLIB p_library, char * symbol);
@@ -1147,6 +1742,13 @@ int                        dbx_mutex_unlock           (DBXMUTEX *p_mutex);
 int                        dbx_mutex_destroy          (DBXMUTEX *p_mutex);
 int                        dbx_enter_critical_section (void *p_crit);
 int                        dbx_leave_critical_section (void *p_crit);
+int                        dbx_lock_stats_acquired    (DBXLOCKSTATS *plstats, unsigned long long twait);
+int                        dbx_lock_stats_released    (DBXLOCKSTATS *plstats);
+int                        dbx_lock_stats_reset       (DBXLOCKSTATS *plstats);
+#if !defined(_WIN32)
+int                        dbx_pool_mutex_lock        (pthread_mutex_t *p_mutex, DBXLOCKSTATS *plstats);
+int                        dbx_pool_mutex_unlock      (pthread_mutex_t *p_mutex, DBXLOCKSTATS *plstats);
+#endif
 int                        dbx_sleep                  (unsigned long msecs);
 
 int                        dbx_fopen                  (FILE **pfp, const char *file, const char *mode);
@@ -30,7 +30,7 @@
 using namespace v8;
 using namespace node;
 
-Persistent<Function> mglobal::constructor;
+thread_local Persistent<Function> mglobal::constructor; /* v1.3.32 */
 
 mglobal::mglobal(int value) : dbx_count(value)
 {
@@ -74,6 +74,10 @@ void mglobal::Init(Handle<Object> exports)
 
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get", Get);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get_bx", Get_bx);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get_into", Get_into);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "read_range", Read_range);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "write_range", Write_range);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "append", Append);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "set", Set);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "defined", Defined);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "delete", Delete);
@@ -84,6 +88,9 @@ void mglobal::Init(Handle<Object> exports)
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "unlock", Unlock);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "merge", Merge);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "reset", Reset);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "compression", Compression);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "set_object", Set_object);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "get_object", Get_object);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "_close", Close);
 
 #if DBX_NODE_VERSION >= 120000
@@ -137,6 +144,12 @@ void mglobal::New(const FunctionCallbackInfo<Value>& args)
       int value = args[0]->IsUndefined() ? 0 : DBX_INT32_VALUE(args[0]);
       mglobal * obj = new mglobal(value);
       obj->c = NULL;
+      obj->pkey = NULL;
+      obj->gdbref.index = -1; /* v1.3.15 */
+      obj->gdbref.gen = 0;
+      obj->pkpfx = NULL; /* v1.3.16 */
+      obj->comp.algo = DBX_COMPRESS_DEFAULT; /* v1.3.23 */
+      obj->comp.min_size = 0;
 
       if (c) { /* 1.4.10 */
          if (c->pcon == NULL) {
@@ -235,7 +248,6 @@ void mglobal::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    int rc;
    DBXCON *pcon;
    DBXMETH *pmeth;
-   Local<String> result;
    DBXGREF gref;
    mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
    MG_GLOBAL_CHECK_CLASS(gx);
@@ -252,6 +264,9 @@ void mglobal::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    pmeth->binary = binary;
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp); /* v1.3.23 */
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -263,6 +278,7 @@ void mglobal::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    
    DBX_DBFUN_START(c, pcon, pmeth);
 
+   pmeth->tvalue = DBX_TVALUE_OUT; /* v1.3.24 */
    rc = c->GlobalReference(c, args, pmeth, &gref, async);
 
    if (pcon->log_transmissions) {
@@ -309,13 +325,234 @@ void mglobal::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    }
 
    if (binary) {
-      Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+      Local<Object> bx = node::Buffer::Copy(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+      args.GetReturnValue().Set(bx);
+   }
+   else if (pmeth->tvalue == DBX_TVALUE_OUT) {
+      args.GetReturnValue().Set(dbx_new_value8n(isolate, pcon, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8)); /* v1.3.24 */
+   }
+   else {
+      args.GetReturnValue().Set(dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8)); /* v1.3.27 */
+   }
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
+/* v1.3.21 */
+void mglobal::Get_into(const FunctionCallbackInfo<Value>& args)
+{
+   int rc;
+   size_t offset, size, len;
+   char *buffer;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   DBXGREF gref;
+   mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
+   MG_GLOBAL_CHECK_CLASS(gx);
+   DBX_DBNAME *c = gx->c;
+   DBX_GET_ICONTEXT;
+   gx->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      c->LogFunction(c, args, (void *) gx, (char *) "mglobal::get_into");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   pmeth->binary = 1;
+   pmeth->jsargc = args.Length();
+   pmeth->jsarg0 = 2;
+   gref.global = gx->global_name;
+   gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx;
+   gref.pcomp = &(gx->comp);
+
+   if (pmeth->jsargc >= (DBX_MAXARGS + pmeth->jsarg0)) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Get_into", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (pmeth->jsargc < 2 || !args[0]->IsArrayBufferView()) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid target Buffer on Get_into", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (!args[1]->IsNumber() || DBX_NUMBER_VALUE(args[1]) < 0 || DBX_NUMBER_VALUE(args[1]) > (double) node::Buffer::Length(args[0])) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Invalid offset on Get_into", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+
+   offset = (size_t) DBX_NUMBER_VALUE(args[1]);
+   size = node::Buffer::Length(args[0]) - offset;
+   buffer = node::Buffer::Data(args[0]) + offset;
+
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   rc = c->GlobalReference(c, args, pmeth, &gref, 0);
+
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) "mglobal::get_into");
+   }
+
+   len = 0;
+   rc = dbx_get_into(pmeth, buffer, size, &len);
+
+   if (rc != CACHE_SUCCESS && rc != CACHE_ERUNDEF) {
+      dbx_error_message(pmeth, rc, (char *) "mglobal::Get_into");
+      if (pcon->error_mode == 1) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+   }
+
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   /* the length of the record or, if the space available is too small, minus the length required */
+   if (len > size) {
+      args.GetReturnValue().Set(DBX_NUMBER_NEW(-((double) len)));
+   }
+   else {
+      args.GetReturnValue().Set(DBX_NUMBER_NEW((double) len));
+   }
+
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
+/* v1.3.22 */
+void mglobal::Read_range(const FunctionCallbackInfo<Value>& args)
+{
+   return RangeEx(args, DBX_RANGE_READ);
+}
+
+
+void mglobal::Write_range(const FunctionCallbackInfo<Value>& args)
+{
+   return RangeEx(args, DBX_RANGE_WRITE);
+}
+
+
+void mglobal::Append(const FunctionCallbackInfo<Value>& args)
+{
+   return RangeEx(args, DBX_RANGE_APPEND);
+}
+
+
+void mglobal::RangeEx(const FunctionCallbackInfo<Value>& args, int mode)
+{
+   short async;
+   int rc;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   Local<String> result;
+   int (* p_dbxfun) (struct tagDBXMETH * pmeth);
+   DBXGREF gref;
+   mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
+   MG_GLOBAL_CHECK_CLASS(gx);
+   DBX_DBNAME *c = gx->c;
+   DBX_GET_ISOLATE;
+   gx->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      c->LogFunction(c, args, (void *) gx, (char *) "mglobal::range");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   gref.global = gx->global_name;
+   gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx;
+   gref.pcomp = &(gx->comp);
+
+   pmeth->binary = (mode == DBX_RANGE_READ);
+
+   DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
+
+   if (pmeth->jsargc >= DBX_MAXARGS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on RangeEx", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (pmeth->jsargc < (2 - (mode == DBX_RANGE_APPEND))) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) (mode == DBX_RANGE_READ ? "Missing key, offset or length on Read_range" : (mode == DBX_RANGE_WRITE ? "Missing key, offset or data on Write_range" : "Missing key or data on Append")), 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   rc = c->GlobalReference(c, args, pmeth, &gref, async);
+
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) "mglobal::range");
+   }
+
+   if (mode == DBX_RANGE_READ) {
+      p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_read_range;
+   }
+   else if (mode == DBX_RANGE_WRITE) {
+      p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_write_range;
+   }
+   else {
+      p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_append;
+   }
+
+   if (async) {
+      DBX_DBNAME::dbx_baton_t *baton = c->dbx_make_baton(c, pmeth);
+      baton->gx = (void *) gx;
+      baton->isolate = isolate;
+      baton->pmeth->p_dbxfun = p_dbxfun;
+      Local<Function> cb = Local<Function>::Cast(args[pmeth->jsargc]);
+
+      baton->cb.Reset(isolate, cb);
+
+      gx->Ref();
+
+      if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
+         char error[DBX_ERROR_SIZE];
+
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         c->dbx_destroy_baton(baton, pmeth);
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return;
+      }
+      return;
+   }
+
+   rc = p_dbxfun(pmeth);
+
+   if (rc == CACHE_ERUNDEF) {
+      pmeth->output_val.svalue.len_used = 0;
+   }
+   else if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "mglobal::RangeEx");
+      if (pcon->error_mode == 1) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+   }
+
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   if (pcon->log_transmissions == 2) {
+      dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) "mglobal::range");
+   }
+
+   if (pmeth->binary) {
+      Local<Object> bx = node::Buffer::Copy(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
       args.GetReturnValue().Set(bx);
    }
    else {
       result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
       args.GetReturnValue().Set(result);
    }
+
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
@@ -332,7 +569,7 @@ void mglobal::Set(const FunctionCallbackInfo<Value>& args)
    mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
    MG_GLOBAL_CHECK_CLASS(gx);
    DBX_DBNAME *c = gx->c;
-   DBX_GET_ISOLATE;
+   DBX_GET_ICONTEXT;
    gx->dbx_count ++;
 
    pcon = c->pcon;
@@ -343,6 +580,9 @@ void mglobal::Set(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -351,9 +591,13 @@ void mglobal::Set(const FunctionCallbackInfo<Value>& args)
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
+   if (pmeth->jsargc > 1 && dbx_set_options(isolate, icontext, pmeth, args[pmeth->jsargc - 1])) { /* v1.3.27 */
+      pmeth->jsargc --;
+   }
    
    DBX_DBFUN_START(c, pcon, pmeth);
 
+   pmeth->tvalue = DBX_TVALUE_IN; /* v1.3.24 */
    rc = c->GlobalReference(c, args, pmeth, &gref, async);
 
    if (pcon->log_transmissions) {
@@ -365,7 +609,7 @@ void mglobal::Set(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_set;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->jsargc]);
+      Local<Function> cb = Local<Function>::Cast(args[args.Length() - 1]);
       baton->cb.Reset(isolate, cb);
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
@@ -427,6 +671,9 @@ void mglobal::Defined(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -508,6 +755,9 @@ void mglobal::Delete(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -594,6 +844,9 @@ void mglobal::Next(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -675,6 +928,9 @@ void mglobal::Previous(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -741,7 +997,6 @@ void mglobal::Increment(const FunctionCallbackInfo<Value>& args)
    int rc;
    DBXCON *pcon;
    DBXMETH *pmeth;
-   Local<String> result;
    DBXGREF gref;
    mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
    MG_GLOBAL_CHECK_CLASS(gx);
@@ -757,6 +1012,9 @@ void mglobal::Increment(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -769,6 +1027,7 @@ void mglobal::Increment(const FunctionCallbackInfo<Value>& args)
    DBX_DBFUN_START(c, pcon, pmeth);
 
    pmeth->increment = 1;
+   pmeth->tvalue = DBX_TVALUE_OUT; /* v1.3.24 */
    rc = c->GlobalReference(c, args, pmeth, &gref, async);
 
    if (pcon->log_transmissions) {
@@ -810,8 +1069,7 @@ void mglobal::Increment(const FunctionCallbackInfo<Value>& args)
       dbx_log_response(pcon, (char *) pmeth->output_val.svalue.buf_addr, (int) pmeth->output_val.svalue.len_used, (char *) (char *) "mglobal::increment");
    }
 
-   result = dbx_new_string8n(isolate, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8);
-   args.GetReturnValue().Set(result);
+   args.GetReturnValue().Set(dbx_new_value8n(isolate, pcon, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used, pcon->utf8)); /* v1.3.24 */
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
@@ -839,6 +1097,9 @@ void mglobal::Lock(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -926,6 +1187,9 @@ void mglobal::Unlock(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx; /* v1.3.16 */
+   gref.pcomp = &(gx->comp);
 
    DBX_CALLBACK_FUN(pmeth->jsargc, cb, async);
 
@@ -1206,6 +1470,192 @@ void mglobal::Reset(const FunctionCallbackInfo<Value>& args)
 }
 
 
+/* v1.3.23 Set (or clear) the compression policy for this global: returns the algorithm in effect */
+void mglobal::Compression(const FunctionCallbackInfo<Value>& args)
+{
+   DBXCON *pcon;
+   DBXCOMP *pcomp;
+   mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
+   MG_GLOBAL_CHECK_CLASS(gx);
+   DBX_DBNAME *c = gx->c;
+   DBX_GET_ICONTEXT;
+   gx->dbx_count ++;
+
+   pcon = c->pcon;
+
+   if (args.Length() > 0) {
+      if (args[0]->IsUndefined() || args[0]->IsNull()) {
+         gx->comp.algo = DBX_COMPRESS_DEFAULT;
+      }
+      else if (dbx_compression_options(isolate, icontext, args[0], &(gx->comp)) < 0) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Invalid compression options", 1)));
+         return;
+      }
+   }
+
+   pcomp = (gx->comp.algo == DBX_COMPRESS_DEFAULT ? &(pcon->comp) : &(gx->comp));
+   args.GetReturnValue().Set(dbx_new_string8(isolate, (char *) (pcomp->algo == DBX_COMPRESS_LZ4 ? "lz4" : "none"), 1));
+   return;
+}
+
+
+/* v1.3.25 Write the leaves of a JavaScript object as the subtree under a node: returns the number of records written */
+void mglobal::Set_object(const FunctionCallbackInfo<Value>& args)
+{
+   int rc, otype, count;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   DBXGREF gref;
+   DBXSTR recs;
+   Local<Object> obj;
+   mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
+   MG_GLOBAL_CHECK_CLASS(gx);
+   DBX_DBNAME *c = gx->c;
+   DBX_GET_ICONTEXT;
+   gx->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      c->LogFunction(c, args, (void *) gx, (char *) "mglobal::set_object");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   pmeth->jsargc = args.Length();
+   gref.global = gx->global_name;
+   gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx;
+   gref.pcomp = &(gx->comp);
+
+   if (pmeth->jsargc >= DBX_MAXARGS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Set_object", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   otype = 0;
+   if (pmeth->jsargc > 0) {
+      obj = dbx_is_object(args[pmeth->jsargc - 1], &otype);
+   }
+   if (otype != 1) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Missing or invalid object on Set_object", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   pmeth->jsargc --; /* the object is not part of the node's reference */
+
+   recs.buf_addr = NULL;
+   recs.len_alloc = 0;
+   recs.len_used = 0;
+   count = 0;
+
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   /* v1.3.25 the key and the object are encoded before the connection is locked: dbx_set_object() holds the lock for the writes only */
+   rc = c->GlobalReference(c, args, pmeth, &gref, 1);
+
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) "mglobal::set_object");
+   }
+
+   rc = dbx_object_encode(isolate, icontext, pmeth, obj, pmeth->key.argc, &recs, &count);
+   if (rc == CACHE_SUCCESS && count > 0) {
+      rc = dbx_set_object(pmeth, &recs);
+   }
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "mglobal::Set_object");
+      if (pcon->error_mode == 1) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+      count = 0;
+   }
+
+   DBX_DBFUN_END(c);
+
+   if (recs.buf_addr) {
+      dbx_free((void *) recs.buf_addr, 0);
+   }
+
+   args.GetReturnValue().Set(DBX_NUMBER_NEW((double) count));
+
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
+/* v1.3.25 Read the subtree under a node as a JavaScript object */
+void mglobal::Get_object(const FunctionCallbackInfo<Value>& args)
+{
+   int rc, count;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   DBXGREF gref;
+   DBXSTR recs;
+   Local<Object> obj;
+   mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
+   MG_GLOBAL_CHECK_CLASS(gx);
+   DBX_DBNAME *c = gx->c;
+   DBX_GET_ICONTEXT;
+   gx->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      c->LogFunction(c, args, (void *) gx, (char *) "mglobal::get_object");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   pmeth->jsargc = args.Length();
+   gref.global = gx->global_name;
+   gref.pkey = gx->pkey;
+   gref.pgdbref = &(gx->gdbref); /* v1.3.15 */
+   gref.pkpfx = gx->pkpfx;
+   gref.pcomp = &(gx->comp);
+
+   if (pmeth->jsargc >= DBX_MAXARGS) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Get_object", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+
+   recs.buf_addr = NULL;
+   recs.len_alloc = 0;
+   recs.len_used = 0;
+   count = 0;
+
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   rc = c->GlobalReference(c, args, pmeth, &gref, 0);
+
+   if (pcon->log_transmissions) {
+      dbx_log_transmission(pcon, pmeth, (char *) "mglobal::get_object");
+   }
+
+   rc = dbx_get_object(pmeth, &recs, &count);
+
+   if (rc != CACHE_SUCCESS) {
+      dbx_error_message(pmeth, rc, (char *) "mglobal::Get_object");
+      if (pcon->error_mode == 1) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) pcon->error, 1)));
+      }
+   }
+
+   DBX_DBFUN_END(c);
+   DBX_DB_UNLOCK();
+
+   /* the object is built once the database is released */
+   obj = dbx_object_build(isolate, icontext, pcon, &recs);
+
+   if (recs.buf_addr) {
+      dbx_free((void *) recs.buf_addr, 0);
+   }
+
+   args.GetReturnValue().Set(obj);
+
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
 void mglobal::Close(const FunctionCallbackInfo<Value>& args)
 {
    DBXCON *pcon;
@@ -1243,6 +1693,10 @@ void mglobal::Close(const FunctionCallbackInfo<Value>& args)
       dbx_free((void *) pvalp, 0);
    }
    gx->pkey = NULL;
+   if (gx->pkpfx) { /* v1.3.16 */
+      dbx_free((void *) gx->pkpfx, 0);
+      gx->pkpfx = NULL;
+   }
 /*
    cx->delete_mglobal_template(gx);
 */
@@ -1279,3 +1733,142 @@ int dbx_escape_output(DBXSTR *pdata, char *item, int item_len, short context)
    return pdata->len_used;
 }
 
+
+/* v1.3.25 Encode the leaves of an object as a list of records: properties are subscripts from key.args[nx] on */
+int dbx_object_encode(Isolate * isolate, Local<Context> icontext, DBXMETH *pmeth, Local<Object> obj, int nx, DBXSTR *precs, int *pcount)
+{
+   int rc, n, otype, len, flags;
+   char *p;
+   char buffer[64];
+   Local<Value> value;
+   Local<Object> objn;
+   Local<String> name, str;
+   DBXCON *pcon = pmeth->pcon;
+
+   if (nx >= (DBX_MAXARGS - 2)) {
+      strcpy(pcon->error, "Object nested too deeply");
+      return CACHE_FAILURE;
+   }
+
+#if DBX_NODE_VERSION >= 120000
+   Local<Array> a = obj->GetPropertyNames(icontext).ToLocalChecked();
+#else
+   Local<Array> a = obj->GetPropertyNames();
+#endif
+
+   rc = CACHE_SUCCESS;
+   str = dbx_new_string8(isolate, (char *) "", pcon->utf8);
+   for (n = 0; n < (int) a->Length(); n ++) {
+      name = DBX_TO_STRING(DBX_GET(a, n));
+      value = DBX_GET(obj, name);
+      if (value->IsUndefined() || value->IsFunction() || value->IsSymbol()) {
+         continue;
+      }
+
+      pmeth->key.ibuffer.len_used = pmeth->key.args[nx - 1].csize;
+      pmeth->key.args[nx].cvalue.pstr = 0;
+      pmeth->key.args[nx].type = DBX_DTYPE_STR;
+      dbx_ibuffer_add(pmeth, &(pmeth->key), isolate, nx, name, NULL, 0, 0);
+
+      objn = dbx_is_object(value, &otype);
+      if (otype == 1) {
+         rc = dbx_object_encode(isolate, icontext, pmeth, objn, nx + 1, precs, pcount);
+         if (rc != CACHE_SUCCESS) {
+            break;
+         }
+         continue;
+      }
+
+      pmeth->key.args[nx + 1].cvalue.pstr = 0;
+      pmeth->key.args[nx + 1].type = DBX_DTYPE_STR;
+      flags = 0;
+      if (pcon->typed_values && (len = dbx_tvalue_encode(isolate, icontext, value, buffer)) > 0) {
+         dbx_ibuffer_add(pmeth, &(pmeth->key), isolate, nx + 1, str, buffer, len, 0);
+         flags = DBX_RECORD_TYPED; /* v1.3.27 */
+      }
+      else if (otype == 2) {
+         p = node::Buffer::Data(objn);
+         len = (int) node::Buffer::Length(objn);
+         dbx_ibuffer_add(pmeth, &(pmeth->key), isolate, nx + 1, str, p, len, 0);
+      }
+      else if (value->IsNull()) {
+         dbx_ibuffer_add(pmeth, &(pmeth->key), isolate, nx + 1, str, (char *) "", 0, 0);
+      }
+      else {
+         dbx_ibuffer_add(pmeth, &(pmeth->key), isolate, nx + 1, DBX_TO_STRING(value), NULL, 0, 0);
+      }
+
+      rc = dbx_record_add(precs, pmeth->key.ibuffer.buf_addr, (unsigned int) pmeth->key.args[nx].csize, pmeth->key.args[nx + 1].svalue.buf_addr, (unsigned int) pmeth->key.args[nx + 1].svalue.len_used, flags);
+      if (rc != CACHE_SUCCESS) {
+         strcpy(pcon->error, "No Memory");
+         break;
+      }
+      (*pcount) ++;
+   }
+
+   pmeth->key.ibuffer.len_used = pmeth->key.args[nx - 1].csize;
+   pmeth->key.argc = nx;
+
+   return rc;
+}
+
+
+/* v1.3.25 Build an object from a list of records holding the keys (relative to the node) in collating sequence */
+Local<Object> dbx_object_build(Isolate * isolate, Local<Context> icontext, DBXCON *pcon, DBXSTR *precs)
+{
+   int n, keyn, prevn, common, flags;
+   unsigned int offset, key_len, data_len;
+   unsigned int prev_csize[DBX_MAXARGS];
+   char *key, *data, *prev_key;
+   DBXVAL keys[DBX_MAXARGS];
+   Local<Object> objs[DBX_MAXARGS];
+   Local<Object> objn;
+
+   objs[0] = DBX_OBJECT_NEW();
+   prevn = 0;
+   prev_key = NULL;
+   offset = 0;
+
+   while (dbx_record_get(precs, &offset, &key, &key_len, &data, &data_len, &flags)) {
+      keyn = dbx_split_key(&keys[0], key, (int) key_len);
+      if (keyn < 1 || keyn >= DBX_MAXARGS) {
+         continue;
+      }
+
+      /* intermediate nodes shared with the previous record are already in place */
+      common = 0;
+      while (common < (keyn - 1) && common < (prevn - 1) && prev_csize[common] == keys[common].csize && !memcmp((void *) prev_key, (void *) key, (size_t) keys[common].csize)) {
+         common ++;
+      }
+
+      /* a node with descendants is an object: its own value (if any) is replaced */
+      for (n = common; n < (keyn - 1); n ++) {
+         objn = DBX_OBJECT_NEW();
+         DBX_SET(objs[n], dbx_new_string8n(isolate, keys[n].svalue.buf_addr, keys[n].svalue.len_used, pcon->utf8), objn);
+         objs[n + 1] = objn;
+      }
+      DBX_SET(objs[keyn - 1], dbx_new_string8n(isolate, keys[keyn - 1].svalue.buf_addr, keys[keyn - 1].svalue.len_used, pcon->utf8), (flags & DBX_RECORD_TYPED) ? dbx_new_value8n(isolate, pcon, data, data_len, pcon->utf8) : (Local<Value>) dbx_new_string8n(isolate, data, data_len, pcon->utf8)); /* v1.3.27 */
+
+      for (n = 0; n < keyn; n ++) {
+         prev_csize[n] = keys[n].csize;
+      }
+      prevn = keyn;
+      prev_key = key;
+   }
+
+   return objs[0];
+}
+
+
+/* v1.3.24 typed values are written in text form */
+int dbx_escape_value(DBXCON *pcon, DBXSTR *pdata, char *item, int item_len)
+{
+   int len;
+   char buffer[32];
+
+   if (pcon->typed_values && (len = dbx_tvalue_format(item, (size_t) item_len, buffer)) >= 0) {
+      return dbx_escape_output(pdata, buffer, len, 0);
+   }
+   return dbx_escape_output(pdata, item, item_len, 1);
+}
+
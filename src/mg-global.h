@@ -41,9 +41,12 @@ public:
    int            dbx_count;
    char           global_name[256];
    DBXVAL         *pkey;
+   DBXGDBREF      gdbref; /* v1.3.15 */
+   DBXKPFX        *pkpfx; /* v1.3.16 */
+   DBXCOMP        comp; /* v1.3.23 */
    DBX_DBNAME     *c;
 
-   static v8::Persistent<v8::Function>       constructor;
+   static thread_local v8::Persistent<v8::Function> constructor; /* v1.3.32 */
 
 #if DBX_NODE_VERSION >= 100000
    static void       Init                    (v8::Local<v8::Object> exports);
@@ -60,6 +63,11 @@ public:
    static void       Get         (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Get_bx      (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       GetEx       (const v8::FunctionCallbackInfo<v8::Value>& args, int binary);
+   static void       Get_into    (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       Read_range  (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       Write_range (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       Append      (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       RangeEx     (const v8::FunctionCallbackInfo<v8::Value>& args, int mode);
    static void       Set         (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Defined     (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Delete      (const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -70,6 +78,9 @@ public:
    static void       Unlock      (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Merge       (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Reset       (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       Compression (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       Set_object  (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       Get_object  (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Close       (const v8::FunctionCallbackInfo<v8::Value>& args);
 
 private:
@@ -77,6 +88,9 @@ private:
    static void       New         (const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
+int dbx_object_encode(v8::Isolate * isolate, v8::Local<v8::Context> icontext, DBXMETH *pmeth, v8::Local<v8::Object> obj, int nx, DBXSTR *precs, int *pcount);
+v8::Local<v8::Object> dbx_object_build(v8::Isolate * isolate, v8::Local<v8::Context> icontext, DBXCON *pcon, DBXSTR *precs);
+
 
 #endif
 
@@ -0,0 +1,233 @@
+/*
+   ----------------------------------------------------------------------------
+   | mg-dbx-bdb.node                                                          |
+   | Author: Chris Munt cmunt@mgateway.com                                    |
+   |                    chris.e.munt@gmail.com                                |
+   | Copyright (c) 2019-2025 MGateway Ltd                                     |
+   | Surrey UK.                                                               |
+   | All rights reserved.                                                     |
+   |                                                                          |
+   | http://www.mgateway.com                                                  |
+   |                                                                          |
+   | Licensed under the Apache License, Version 2.0 (the "License"); you may  |
+   | not use this file except in compliance with the License.                 |
+   | You may obtain a copy of the License at                                  |
+   |                                                                          |
+   | http://www.apache.org/licenses/LICENSE-2.0                               |
+   |                                                                          |
+   | Unless required by applicable law or agreed to in writing, software      |
+   | distributed under the License is distributed on an "AS IS" BASIS,        |
+   | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+   | See the License for the specific language governing permissions and      |
+   | limitations under the License.                                           |      
+   |                                                                          |
+   ----------------------------------------------------------------------------
+*/
+
+
+/*
+   Compression codec for record values (v1.3.23)
+*/
+
+#include <string.h>
+
+#include "mg-lz4.h"
+
+
+static unsigned int dbx_lz4_read32(const unsigned char *p)
+{
+   unsigned int v;
+
+   memcpy((void *) &v, (void *) p, sizeof(v));
+   return v;
+}
+
+
+static unsigned int dbx_lz4_hash(unsigned int v)
+{
+   return (v * 2654435761U) >> (32 - DBX_LZ4_HASH_LOG);
+}
+
+
+/* Returns the compressed length, or 0 if the output would not fit in dst_size bytes */
+int dbx_lz4_compress(const unsigned char *src, int src_len, unsigned char *dst, int dst_size)
+{
+   int lit_len, match_len, n;
+   unsigned int h;
+   int table[1 << DBX_LZ4_HASH_LOG];
+   const unsigned char *ip, *anchor, *ref, *iend, *mflimit, *matchlimit;
+   unsigned char *op, *oend, *token;
+
+   ip = src;
+   anchor = src;
+   iend = src + src_len;
+   mflimit = iend - DBX_LZ4_MF_LIMIT;
+   matchlimit = iend - DBX_LZ4_LAST_LITERALS;
+   op = dst;
+   oend = dst + dst_size;
+
+   if (src_len > DBX_LZ4_MF_LIMIT) {
+      memset((void *) table, 0, sizeof(table));
+      ip ++;
+
+      while (ip < mflimit) {
+         h = dbx_lz4_hash(dbx_lz4_read32(ip));
+         ref = src + table[h];
+         table[h] = (int) (ip - src);
+
+         if (ref >= ip || (ip - ref) > DBX_LZ4_MAX_OFFSET || dbx_lz4_read32(ref) != dbx_lz4_read32(ip)) {
+            ip ++;
+            continue;
+         }
+
+         /* extend the match backwards over pending literals */
+         while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+            ip --;
+            ref --;
+         }
+         lit_len = (int) (ip - anchor);
+
+         match_len = DBX_LZ4_MIN_MATCH;
+         while ((ip + match_len) < matchlimit && ip[match_len] == ref[match_len]) {
+            match_len ++;
+         }
+
+         if ((op + 1 + (lit_len / 255) + 1 + lit_len + 2 + (match_len / 255) + 1) > oend) {
+            return 0;
+         }
+
+         token = op ++;
+         if (lit_len >= 15) {
+            *token = (unsigned char) (15 << 4);
+            for (n = lit_len - 15; n >= 255; n -= 255) {
+               *op ++ = 255;
+            }
+            *op ++ = (unsigned char) n;
+         }
+         else {
+            *token = (unsigned char) (lit_len << 4);
+         }
+         memcpy((void *) op, (void *) anchor, (size_t) lit_len);
+         op += lit_len;
+
+         *op ++ = (unsigned char) ((ip - ref) & 0xff);
+         *op ++ = (unsigned char) (((ip - ref) >> 8) & 0xff);
+
+         n = match_len - DBX_LZ4_MIN_MATCH;
+         if (n >= 15) {
+            *token |= 15;
+            for (n -= 15; n >= 255; n -= 255) {
+               *op ++ = 255;
+            }
+            *op ++ = (unsigned char) n;
+         }
+         else {
+            *token |= (unsigned char) n;
+         }
+
+         ip += match_len;
+         anchor = ip;
+         if (ip < mflimit) {
+            table[dbx_lz4_hash(dbx_lz4_read32(ip - 2))] = (int) (ip - 2 - src);
+         }
+      }
+   }
+
+   /* the final sequence is literals only */
+   lit_len = (int) (iend - anchor);
+   if ((op + 1 + (lit_len / 255) + 1 + lit_len) > oend) {
+      return 0;
+   }
+   if (lit_len >= 15) {
+      *op ++ = (unsigned char) (15 << 4);
+      for (n = lit_len - 15; n >= 255; n -= 255) {
+         *op ++ = 255;
+      }
+      *op ++ = (unsigned char) n;
+   }
+   else {
+      *op ++ = (unsigned char) (lit_len << 4);
+   }
+   memcpy((void *) op, (void *) anchor, (size_t) lit_len);
+   op += lit_len;
+
+   return (int) (op - dst);
+}
+
+
+/* Returns the decompressed length, or -1 if the input is malformed or does not fit in dst_size bytes */
+int dbx_lz4_decompress(const unsigned char *src, int src_len, unsigned char *dst, int dst_size)
+{
+   int len, offset;
+   unsigned char token, s;
+   const unsigned char *ip, *iend, *ref;
+   unsigned char *op, *oend;
+
+   ip = src;
+   iend = src + src_len;
+   op = dst;
+   oend = dst + dst_size;
+
+   while (ip < iend) {
+      token = *ip ++;
+
+      len = token >> 4;
+      if (len == 15) {
+         do {
+            if (ip >= iend) {
+               return -1;
+            }
+            s = *ip ++;
+            len += s;
+         } while (s == 255);
+      }
+      if (len > (iend - ip) || len > (oend - op)) {
+         return -1;
+      }
+      memcpy((void *) op, (void *) ip, (size_t) len);
+      ip += len;
+      op += len;
+
+      if (ip >= iend) {
+         break;
+      }
+
+      if ((iend - ip) < 2) {
+         return -1;
+      }
+      offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+      if (offset == 0 || offset > (op - dst)) {
+         return -1;
+      }
+
+      len = token & 15;
+      if (len == 15) {
+         do {
+            if (ip >= iend) {
+               return -1;
+            }
+            s = *ip ++;
+            len += s;
+         } while (s == 255);
+      }
+      len += DBX_LZ4_MIN_MATCH;
+      if (len > (oend - op)) {
+         return -1;
+      }
+
+      ref = op - offset;
+      if (offset >= len) {
+         memcpy((void *) op, (void *) ref, (size_t) len);
+         op += len;
+      }
+      else {
+         while (len --) { /* overlapping copy repeats the pattern */
+            *op ++ = *ref ++;
+         }
+      }
+   }
+
+   return (int) (op - dst);
+}
+
@@ -0,0 +1,52 @@
+/*
+   ----------------------------------------------------------------------------
+   | mg-dbx-bdb.node                                                          |
+   | Author: Chris Munt cmunt@mgateway.com                                    |
+   |                    chris.e.munt@gmail.com                                |
+   | Copyright (c) 2019-2025 MGateway Ltd                                     |
+   | Surrey UK.                                                               |
+   | All rights reserved.                                                     |
+   |                                                                          |
+   | http://www.mgateway.com                                                  |
+   |                                                                          |
+   | Licensed under the Apache License, Version 2.0 (the "License"); you may  |
+   | not use this file except in compliance with the License.                 |
+   | You may obtain a copy of the License at                                  |
+   |                                                                          |
+   | http://www.apache.org/licenses/LICENSE-2.0                               |
+   |                                                                          |
+   | Unless required by applicable law or agreed to in writing, software      |
+   | distributed under the License is distributed on an "AS IS" BASIS,        |
+   | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+   | See the License for the specific language governing permissions and      |
+   | limitations under the License.                                           |      
+   |                                                                          |
+   ----------------------------------------------------------------------------
+*/
+
+
+/*
+   Compression codec for record values (v1.3.23)
+
+   Output is in the LZ4 block format (a token byte, literal run, 16-bit match
+   offset and match length per sequence) so that values can be decoded by any
+   LZ4 block decoder.  The compressor uses a single pass over the input with
+   a small hash table of 4-byte sequences.
+*/
+
+#ifndef MG_LZ4_H
+#define MG_LZ4_H
+
+#define DBX_LZ4_HASH_LOG         12
+#define DBX_LZ4_MIN_MATCH        4
+#define DBX_LZ4_LAST_LITERALS    5
+#define DBX_LZ4_MF_LIMIT         12
+#define DBX_LZ4_MAX_OFFSET       65535
+
+#define DBX_LZ4_BOUND(LEN)       ((LEN) + ((LEN) / 255) + 16)
+
+int                        dbx_lz4_compress           (const unsigned char *src, int src_len, unsigned char *dst, int dst_size);
+int                        dbx_lz4_decompress         (const unsigned char *src, int src_len, unsigned char *dst, int dst_size);
+
+#endif
+
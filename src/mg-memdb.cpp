@@ -0,0 +1,1573 @@
+/*
+   ----------------------------------------------------------------------------
+   | mg-dbx-bdb.node                                                          |
+   | Author: Chris Munt cmunt@mgateway.com                                    |
+   |                    chris.e.munt@gmail.com                                |
+   | Copyright (c) 2019-2025 MGateway Ltd                                     |
+   | Surrey UK.                                                               |
+   | All rights reserved.                                                     |
+   |                                                                          |
+   | http://www.mgateway.com                                                  |
+   |                                                                          |
+   | Licensed under the Apache License, Version 2.0 (the "License"); you may  |
+   | not use this file except in compliance with the License.                 |
+   | You may obtain a copy of the License at                                  |
+   |                                                                          |
+   | http://www.apache.org/licenses/LICENSE-2.0                               |
+   |                                                                          |
+   | Unless required by applicable law or agreed to in writing, software      |
+   | distributed under the License is distributed on an "AS IS" BASIS,        |
+   | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+   | See the License for the specific language governing permissions and      |
+   | limitations under the License.                                           |      
+   |                                                                          |
+   ----------------------------------------------------------------------------
+*/
+
+
+/*
+   In-memory storage engine (v1.3.39)
+*/
+
+#include "mg-dbx-bdb.h"
+#include "mg-memdb.h"
+
+#define MEMDB_KEY(PREC)          ((char *) (PREC) + sizeof(DBXMEMREC))
+#define MEMDB_DATA(PREC)         ((char *) (PREC) + sizeof(DBXMEMREC) + (PREC)->key_len)
+#define MEMDB_RSIZE(PREC)        (sizeof(DBXMEMREC) + (PREC)->key_len + (PREC)->data_len)
+
+static char memdb_version_str[64] = "";
+
+
+static void memdb_lock(DBXMEMENV *penv)
+{
+   dbx_enter_critical_section((void *) &(penv->lock));
+   return;
+}
+
+
+static void memdb_unlock(DBXMEMENV *penv)
+{
+   dbx_leave_critical_section((void *) &(penv->lock));
+   return;
+}
+
+
+static int memdb_compare(char *key1, size_t len1, char *key2, size_t len2)
+{
+   int rc;
+
+   rc = memcmp((void *) key1, (void *) key2, len1 < len2 ? len1 : len2);
+   if (rc) {
+      return rc;
+   }
+   return (len1 < len2) ? -1 : ((len1 > len2) ? 1 : 0);
+}
+
+
+static DBXMEMTREE * memdb_tree(DBXMEMENV *penv, MDB_dbi dbi)
+{
+   if (dbi > penv->max_dbs || !penv->dbs[dbi].used) {
+      return NULL;
+   }
+   return &(penv->dbs[dbi]);
+}
+
+
+static DBXMEMREC * memdb_rec_new(DBXMEMENV *penv, char *key, size_t key_len, char *data, size_t data_len)
+{
+   size_t size;
+   DBXMEMREC *prec;
+
+   size = sizeof(DBXMEMREC) + key_len + data_len;
+   if (size > 0x7fffff00) {
+      return NULL;
+   }
+   prec = (DBXMEMREC *) dbx_malloc((int) size, DBX_MEMID_STORE);
+   if (!prec) {
+      return NULL;
+   }
+   prec->key_len = key_len;
+   prec->data_len = data_len;
+   memcpy((void *) MEMDB_KEY(prec), (void *) key, key_len);
+   if (data && data_len) {
+      memcpy((void *) MEMDB_DATA(prec), (void *) data, data_len);
+   }
+   penv->used += size;
+
+   return prec;
+}
+
+
+static void memdb_rec_free(DBXMEMENV *penv, DBXMEMREC *prec)
+{
+   penv->used -= MEMDB_RSIZE(prec);
+   dbx_free((void *) prec, DBX_MEMID_STORE);
+   return;
+}
+
+
+/* Free a record that has left the tree: data returned to a read-only transaction must remain valid until it ends */
+static void memdb_rec_release(DBXMEMENV *penv, DBXMEMREC *prec)
+{
+   size_t size;
+   DBXMEMREC **pgarbage;
+
+   if (!penv->readers) {
+      memdb_rec_free(penv, prec);
+      return;
+   }
+   if (penv->garbage_count == penv->garbage_size) {
+      size = penv->garbage_size ? (penv->garbage_size * 2) : 256;
+      pgarbage = (DBXMEMREC **) dbx_malloc((int) (size * sizeof(DBXMEMREC *)), DBX_MEMID_STORE);
+      if (!pgarbage) {
+         memdb_rec_free(penv, prec);
+         return;
+      }
+      if (penv->garbage) {
+         memcpy((void *) pgarbage, (void *) penv->garbage, penv->garbage_count * sizeof(DBXMEMREC *));
+         dbx_free((void *) penv->garbage, DBX_MEMID_STORE);
+      }
+      penv->garbage = pgarbage;
+      penv->garbage_size = size;
+   }
+   penv->garbage[penv->garbage_count ++] = prec;
+   return;
+}
+
+
+static void memdb_gc(DBXMEMENV *penv)
+{
+   size_t n;
+
+   for (n = 0; n < penv->garbage_count; n ++) {
+      memdb_rec_free(penv, penv->garbage[n]);
+   }
+   penv->garbage_count = 0;
+   return;
+}
+
+
+/* Ensure that count nodes can be taken without failing, so that a split never has to be abandoned part way through */
+static int memdb_node_reserve(DBXMEMENV *penv, int count)
+{
+   int n;
+   DBXMEMNODE *pnode;
+   DBXMEMARENA *parena;
+
+   for (n = 0, pnode = penv->free_nodes; pnode && n < count; pnode = pnode->next) {
+      n ++;
+   }
+   while (n < count) {
+      parena = (DBXMEMARENA *) dbx_malloc(sizeof(DBXMEMARENA), DBX_MEMID_STORE);
+      if (!parena) {
+         return ENOMEM;
+      }
+      parena->pnext = penv->arenas;
+      penv->arenas = parena;
+      penv->used += sizeof(DBXMEMARENA);
+      for (n = DBX_MEMDB_ARENA - 1; n >= 0; n --) {
+         parena->node[n].next = penv->free_nodes;
+         penv->free_nodes = &(parena->node[n]);
+      }
+      n = count;
+   }
+   return 0;
+}
+
+
+static DBXMEMNODE * memdb_node_new(DBXMEMENV *penv, DBXMEMTREE *ptree, short leaf)
+{
+   DBXMEMNODE *pnode;
+
+   if (memdb_node_reserve(penv, 1)) {
+      return NULL;
+   }
+   pnode = penv->free_nodes;
+   penv->free_nodes = pnode->next;
+   memset((void *) pnode, 0, sizeof(DBXMEMNODE));
+   pnode->leaf = leaf;
+   if (leaf) {
+      ptree->leaf_pages ++;
+   }
+   else {
+      ptree->branch_pages ++;
+   }
+   return pnode;
+}
+
+
+static void memdb_node_free(DBXMEMENV *penv, DBXMEMTREE *ptree, DBXMEMNODE *pnode)
+{
+   if (pnode->leaf) {
+      ptree->leaf_pages --;
+   }
+   else {
+      ptree->branch_pages --;
+   }
+   pnode->next = penv->free_nodes;
+   penv->free_nodes = pnode;
+   return;
+}
+
+
+/* Leaf: the first slot with a key not less than the one given */
+static int memdb_leaf_search(DBXMEMNODE *pnode, char *key, size_t key_len, int *pexact)
+{
+   int lo, hi, mid;
+
+   lo = 0;
+   hi = pnode->count;
+   while (lo < hi) {
+      mid = (lo + hi) / 2;
+      if (memdb_compare(MEMDB_KEY(pnode->rec[mid]), pnode->rec[mid]->key_len, key, key_len) < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   *pexact = (lo < pnode->count && !memdb_compare(MEMDB_KEY(pnode->rec[lo]), pnode->rec[lo]->key_len, key, key_len));
+   return lo;
+}
+
+
+/* Branch: the child under which the key given belongs */
+static int memdb_branch_search(DBXMEMNODE *pnode, char *key, size_t key_len)
+{
+   int lo, hi, mid;
+
+   lo = 1;
+   hi = pnode->count;
+   while (lo < hi) {
+      mid = (lo + hi) / 2;
+      if (memdb_compare(MEMDB_KEY(pnode->rec[mid]), pnode->rec[mid]->key_len, key, key_len) <= 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo - 1;
+}
+
+
+static DBXMEMNODE * memdb_descend(DBXMEMTREE *ptree, char *key, size_t key_len, DBXMEMNODE **path, int *ppos)
+{
+   int n, d;
+   DBXMEMNODE *pnode;
+
+   d = 0;
+   pnode = ptree->root;
+   while (pnode && !pnode->leaf) {
+      n = memdb_branch_search(pnode, key, key_len);
+      if (path) {
+         path[d] = pnode;
+         ppos[d] = n;
+      }
+      d ++;
+      pnode = pnode->child[n];
+   }
+   return pnode;
+}
+
+
+/* Position on the first record with a key not less than the one given (leaf is NULL if there is none) */
+static void memdb_seek(DBXMEMTREE *ptree, char *key, size_t key_len, DBXMEMNODE **pleaf, int *ppos, int *pexact)
+{
+   DBXMEMNODE *pnode;
+
+   *pexact = 0;
+   *ppos = 0;
+   pnode = memdb_descend(ptree, key, key_len, NULL, NULL);
+   if (pnode) {
+      *ppos = memdb_leaf_search(pnode, key, key_len, pexact);
+      if (*ppos >= pnode->count) {
+         pnode = pnode->next;
+         *ppos = 0;
+      }
+   }
+   *pleaf = pnode;
+   return;
+}
+
+
+static void memdb_branch_insert(DBXMEMENV *penv, DBXMEMTREE *ptree, DBXMEMNODE **path, int *ppos, int d, DBXMEMREC *psep, DBXMEMNODE *pchild)
+{
+   int n, h, j;
+   DBXMEMNODE *pnode, *pright;
+   DBXMEMREC *pup;
+
+   for (;;) {
+      if (d < 0) {
+         pnode = memdb_node_new(penv, ptree, 0);
+         pnode->child[0] = ptree->root;
+         pnode->child[1] = pchild;
+         pnode->rec[1] = psep;
+         pnode->count = 2;
+         ptree->root = pnode;
+         ptree->depth ++;
+         return;
+      }
+      pnode = path[d];
+      n = ppos[d] + 1;
+      pright = NULL;
+      pup = NULL;
+      if (pnode->count == DBX_MEMDB_ORDER) {
+         h = DBX_MEMDB_ORDER / 2;
+         pright = memdb_node_new(penv, ptree, 0);
+         pup = pnode->rec[h];
+         for (j = 0; j < DBX_MEMDB_ORDER - h; j ++) {
+            pright->child[j] = pnode->child[h + j];
+            pright->rec[j] = pnode->rec[h + j];
+         }
+         pright->rec[0] = NULL;
+         pright->count = DBX_MEMDB_ORDER - h;
+         pnode->count = h;
+         if (n > h) {
+            pnode = pright;
+            n -= h;
+         }
+      }
+      memmove((void *) &(pnode->child[n + 1]), (void *) &(pnode->child[n]), (pnode->count - n) * sizeof(DBXMEMNODE *));
+      memmove((void *) &(pnode->rec[n + 1]), (void *) &(pnode->rec[n]), (pnode->count - n) * sizeof(DBXMEMREC *));
+      pnode->child[n] = pchild;
+      pnode->rec[n] = psep;
+      pnode->count ++;
+      if (!pright) {
+         return;
+      }
+      psep = pup;
+      pchild = pright;
+      d --;
+   }
+}
+
+
+/* Add a record to a tree: a record already held for the key is replaced and returned in *ppold */
+static int memdb_tree_put(DBXMEMENV *penv, DBXMEMTREE *ptree, DBXMEMREC *prec, DBXMEMREC **ppold)
+{
+   int pos, exact, h;
+   int ppos[DBX_MEMDB_MAX_DEPTH];
+   DBXMEMNODE *path[DBX_MEMDB_MAX_DEPTH];
+   DBXMEMNODE *pleaf, *pright;
+   DBXMEMREC *psep;
+
+   *ppold = NULL;
+   if (!ptree->root) {
+      pleaf = memdb_node_new(penv, ptree, 1);
+      if (!pleaf) {
+         return ENOMEM;
+      }
+      ptree->root = pleaf;
+      ptree->first = pleaf;
+      ptree->last = pleaf;
+      ptree->depth = 1;
+   }
+
+   pleaf = memdb_descend(ptree, MEMDB_KEY(prec), prec->key_len, path, ppos);
+   pos = memdb_leaf_search(pleaf, MEMDB_KEY(prec), prec->key_len, &exact);
+   if (exact) {
+      *ppold = pleaf->rec[pos];
+      pleaf->rec[pos] = prec;
+      return 0;
+   }
+
+   if (pleaf->count == DBX_MEMDB_ORDER) {
+      if (ptree->depth >= DBX_MEMDB_MAX_DEPTH) {
+         return MDB_MAP_FULL;
+      }
+      h = DBX_MEMDB_ORDER / 2;
+      psep = memdb_rec_new(penv, MEMDB_KEY(pleaf->rec[h]), pleaf->rec[h]->key_len, NULL, 0);
+      if (!psep) {
+         return ENOMEM;
+      }
+      pright = memdb_node_new(penv, ptree, 1);
+      if (!pright) {
+         memdb_rec_free(penv, psep);
+         return ENOMEM;
+      }
+      if (memdb_node_reserve(penv, (int) ptree->depth)) {
+         memdb_node_free(penv, ptree, pright);
+         memdb_rec_free(penv, psep);
+         return ENOMEM;
+      }
+      memcpy((void *) pright->rec, (void *) &(pleaf->rec[h]), (DBX_MEMDB_ORDER - h) * sizeof(DBXMEMREC *));
+      pright->count = DBX_MEMDB_ORDER - h;
+      pleaf->count = h;
+      pright->prev = pleaf;
+      pright->next = pleaf->next;
+      if (pleaf->next)
+         pleaf->next->prev = pright;
+      else
+         ptree->last = pright;
+      pleaf->next = pright;
+      memdb_branch_insert(penv, ptree, path, ppos, (int) ptree->depth - 2, psep, pright);
+      if (pos > h) {
+         pleaf = pright;
+         pos -= h;
+      }
+   }
+
+   memmove((void *) &(pleaf->rec[pos + 1]), (void *) &(pleaf->rec[pos]), (pleaf->count - pos) * sizeof(DBXMEMREC *));
+   pleaf->rec[pos] = prec;
+   pleaf->count ++;
+   ptree->entries ++;
+   ptree->mods ++;
+   return 0;
+}
+
+
+/* Remove the child at path[d] (which is now empty) from its parent, removing branches left empty in turn */
+static void memdb_branch_remove(DBXMEMENV *penv, DBXMEMTREE *ptree, DBXMEMNODE **path, int *ppos, int d)
+{
+   int n;
+   DBXMEMNODE *pnode;
+
+   for (;;) {
+      if (d < 0) {
+         ptree->root = NULL;
+         ptree->first = NULL;
+         ptree->last = NULL;
+         ptree->depth = 0;
+         return;
+      }
+      pnode = path[d];
+      n = ppos[d];
+      if (n == 0) {
+         if (pnode->count > 1) {
+            memdb_rec_free(penv, pnode->rec[1]);
+            memmove((void *) &(pnode->child[0]), (void *) &(pnode->child[1]), (pnode->count - 1) * sizeof(DBXMEMNODE *));
+            memmove((void *) &(pnode->rec[1]), (void *) &(pnode->rec[2]), (pnode->count - 2) * sizeof(DBXMEMREC *));
+         }
+      }
+      else {
+         memdb_rec_free(penv, pnode->rec[n]);
+         memmove((void *) &(pnode->child[n]), (void *) &(pnode->child[n + 1]), (pnode->count - n - 1) * sizeof(DBXMEMNODE *));
+         memmove((void *) &(pnode->rec[n]), (void *) &(pnode->rec[n + 1]), (pnode->count - n - 1) * sizeof(DBXMEMREC *));
+      }
+      pnode->count --;
+      if (pnode->count > 0) {
+         break;
+      }
+      memdb_node_free(penv, ptree, pnode);
+      d --;
+   }
+
+   while (ptree->root && !ptree->root->leaf && ptree->root->count == 1) {
+      pnode = ptree->root;
+      ptree->root = pnode->child[0];
+      memdb_node_free(penv, ptree, pnode);
+      ptree->depth --;
+   }
+   return;
+}
+
+
+/* Remove the record for a key from a tree, returning it in *ppold */
+static int memdb_tree_del(DBXMEMENV *penv, DBXMEMTREE *ptree, char *key, size_t key_len, DBXMEMREC **ppold)
+{
+   int pos, exact;
+   int ppos[DBX_MEMDB_MAX_DEPTH];
+   DBXMEMNODE *path[DBX_MEMDB_MAX_DEPTH];
+   DBXMEMNODE *pleaf;
+
+   *ppold = NULL;
+   pleaf = memdb_descend(ptree, key, key_len, path, ppos);
+   if (!pleaf) {
+      return MDB_NOTFOUND;
+   }
+   pos = memdb_leaf_search(pleaf, key, key_len, &exact);
+   if (!exact) {
+      return MDB_NOTFOUND;
+   }
+
+   *ppold = pleaf->rec[pos];
+   memmove((void *) &(pleaf->rec[pos]), (void *) &(pleaf->rec[pos + 1]), (pleaf->count - pos - 1) * sizeof(DBXMEMREC *));
+   pleaf->count --;
+   ptree->entries --;
+   ptree->mods ++;
+
+   if (pleaf->count == 0) {
+      if (pleaf->prev)
+         pleaf->prev->next = pleaf->next;
+      else
+         ptree->first = pleaf->next;
+      if (pleaf->next)
+         pleaf->next->prev = pleaf->prev;
+      else
+         ptree->last = pleaf->prev;
+      memdb_node_free(penv, ptree, pleaf);
+      memdb_branch_remove(penv, ptree, path, ppos, (int) ptree->depth - 2);
+   }
+   return 0;
+}
+
+
+/* Free the nodes under pnode, releasing the records they hold if release is set (otherwise freeing them) */
+static void memdb_tree_free(DBXMEMENV *penv, DBXMEMTREE *ptree, DBXMEMNODE *pnode, short release)
+{
+   int n;
+
+   if (!pnode) {
+      return;
+   }
+   if (pnode->leaf) {
+      for (n = 0; n < pnode->count; n ++) {
+         if (release)
+            memdb_rec_release(penv, pnode->rec[n]);
+         else
+            memdb_rec_free(penv, pnode->rec[n]);
+      }
+   }
+   else {
+      for (n = 0; n < pnode->count; n ++) {
+         if (n > 0) {
+            memdb_rec_free(penv, pnode->rec[n]);
+         }
+         memdb_tree_free(penv, ptree, pnode->child[n], release);
+      }
+   }
+   memdb_node_free(penv, ptree, pnode);
+   return;
+}
+
+
+static void memdb_tree_clear(DBXMEMENV *penv, DBXMEMTREE *ptree, short release)
+{
+   memdb_tree_free(penv, ptree, ptree->root, release);
+   ptree->root = NULL;
+   ptree->first = NULL;
+   ptree->last = NULL;
+   ptree->depth = 0;
+   ptree->entries = 0;
+   ptree->mods ++;
+   return;
+}
+
+
+static DBXMEMUNDO * memdb_undo_new(void)
+{
+   DBXMEMUNDO *pundo;
+
+   pundo = (DBXMEMUNDO *) dbx_malloc(sizeof(DBXMEMUNDO), DBX_MEMID_STORE);
+   if (pundo) {
+      memset((void *) pundo, 0, sizeof(DBXMEMUNDO));
+   }
+   return pundo;
+}
+
+
+static void memdb_undo_link(DBXMEMTXN *ptxn, DBXMEMUNDO *pundo, short type, MDB_dbi dbi, DBXMEMREC *prec)
+{
+   pundo->type = type;
+   pundo->dbi = dbi;
+   pundo->prec = prec;
+   pundo->pnext = ptxn->pundo;
+   ptxn->pundo = pundo;
+   return;
+}
+
+
+static int memdb_write(DBXMEMTXN *ptxn, MDB_dbi dbi, char *key, size_t key_len, char *data, size_t data_len, DBXMEMREC **pprec)
+{
+   int rc;
+   DBXMEMENV *penv;
+   DBXMEMREC *prec, *pold;
+   DBXMEMUNDO *pundo;
+
+   penv = ptxn->penv;
+   pundo = memdb_undo_new();
+   if (!pundo) {
+      return ENOMEM;
+   }
+   prec = memdb_rec_new(penv, key, key_len, data, data_len);
+   if (!prec) {
+      dbx_free((void *) pundo, DBX_MEMID_STORE);
+      return ENOMEM;
+   }
+   rc = memdb_tree_put(penv, &(penv->dbs[dbi]), prec, &pold);
+   if (rc) {
+      memdb_rec_free(penv, prec);
+      dbx_free((void *) pundo, DBX_MEMID_STORE);
+      return rc;
+   }
+   if (pold)
+      memdb_undo_link(ptxn, pundo, DBX_MEMDB_UNDO_REPLACE, dbi, pold);
+   else
+      memdb_undo_link(ptxn, pundo, DBX_MEMDB_UNDO_INSERT, dbi, prec);
+   if (pprec) {
+      *pprec = prec;
+   }
+   return 0;
+}
+
+
+static int memdb_remove(DBXMEMTXN *ptxn, MDB_dbi dbi, char *key, size_t key_len)
+{
+   int rc;
+   DBXMEMENV *penv;
+   DBXMEMREC *pold;
+   DBXMEMUNDO *pundo;
+
+   penv = ptxn->penv;
+   pundo = memdb_undo_new();
+   if (!pundo) {
+      return ENOMEM;
+   }
+   rc = memdb_tree_del(penv, &(penv->dbs[dbi]), key, key_len, &pold);
+   if (rc) {
+      dbx_free((void *) pundo, DBX_MEMID_STORE);
+      return rc;
+   }
+   memdb_undo_link(ptxn, pundo, DBX_MEMDB_UNDO_DELETE, dbi, pold);
+   return 0;
+}
+
+
+/* Reverse the updates made by a transaction, most recent first */
+static void memdb_undo(DBXMEMTXN *ptxn)
+{
+   char *name;
+   unsigned long long mods;
+   DBXMEMENV *penv;
+   DBXMEMTREE *ptree;
+   DBXMEMREC *pold;
+   DBXMEMUNDO *pundo;
+
+   penv = ptxn->penv;
+   while ((pundo = ptxn->pundo)) {
+      ptxn->pundo = pundo->pnext;
+      ptree = &(penv->dbs[pundo->dbi]);
+      switch (pundo->type) {
+         case DBX_MEMDB_UNDO_INSERT:
+            if (!memdb_tree_del(penv, ptree, MEMDB_KEY(pundo->prec), pundo->prec->key_len, &pold)) {
+               memdb_rec_release(penv, pold);
+            }
+            break;
+         case DBX_MEMDB_UNDO_REPLACE:
+         case DBX_MEMDB_UNDO_DELETE:
+            if (!memdb_tree_put(penv, ptree, pundo->prec, &pold)) {
+               if (pold) {
+                  memdb_rec_release(penv, pold);
+               }
+            }
+            else {
+               memdb_rec_release(penv, pundo->prec);
+            }
+            break;
+         case DBX_MEMDB_UNDO_CREATE:
+            memdb_tree_clear(penv, ptree, 1);
+            if (ptree->name) {
+               dbx_free((void *) ptree->name, DBX_MEMID_STORE);
+            }
+            ptree->name = NULL;
+            ptree->used = 0;
+            break;
+         case DBX_MEMDB_UNDO_DROP:
+            memdb_tree_clear(penv, ptree, 1);
+            mods = ptree->mods;
+            name = ptree->name;
+            *ptree = *(pundo->ptree);
+            ptree->mods = mods + 1;
+            if (!ptree->name) {
+               ptree->name = name;
+            }
+            dbx_free((void *) pundo->ptree, DBX_MEMID_STORE);
+            break;
+         default:
+            break;
+      }
+      dbx_free((void *) pundo, DBX_MEMID_STORE);
+   }
+   return;
+}
+
+
+/* Release what the updates made by a committed transaction have replaced */
+static void memdb_commit(DBXMEMTXN *ptxn)
+{
+   DBXMEMENV *penv;
+   DBXMEMUNDO *pundo;
+
+   penv = ptxn->penv;
+   while ((pundo = ptxn->pundo)) {
+      ptxn->pundo = pundo->pnext;
+      switch (pundo->type) {
+         case DBX_MEMDB_UNDO_REPLACE:
+         case DBX_MEMDB_UNDO_DELETE:
+            memdb_rec_release(penv, pundo->prec);
+            break;
+         case DBX_MEMDB_UNDO_DROP:
+            memdb_tree_free(penv, pundo->ptree, pundo->ptree->root, 1);
+            if (pundo->ptree->name) {
+               dbx_free((void *) pundo->ptree->name, DBX_MEMID_STORE);
+            }
+            dbx_free((void *) pundo->ptree, DBX_MEMID_STORE);
+            break;
+         default:
+            break;
+      }
+      dbx_free((void *) pundo, DBX_MEMID_STORE);
+   }
+   return;
+}
+
+
+int memdb_env_create(MDB_env **env)
+{
+   DBXMEMENV *penv;
+
+   *env = NULL;
+   penv = (DBXMEMENV *) dbx_malloc(sizeof(DBXMEMENV), DBX_MEMID_STORE);
+   if (!penv) {
+      return ENOMEM;
+   }
+   memset((void *) penv, 0, sizeof(DBXMEMENV));
+   penv->max_dbs = 0;
+   penv->map_size = (size_t) DBX_DB_SIZE;
+
+#if defined(_WIN32)
+   InitializeCriticalSection(&(penv->lock));
+#else
+   pthread_mutex_init(&(penv->lock), NULL);
+#endif
+   dbx_mutex_create(&(penv->writer));
+
+   *env = (MDB_env *) penv;
+   return 0;
+}
+
+
+int memdb_env_open(MDB_env *env, const char *path, unsigned int flags, mdb_mode_t mode)
+{
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   if (!penv || penv->open) {
+      return EINVAL;
+   }
+   penv->dbs = (DBXMEMTREE *) dbx_malloc((int) ((penv->max_dbs + 1) * sizeof(DBXMEMTREE)), DBX_MEMID_STORE);
+   if (!penv->dbs) {
+      return ENOMEM;
+   }
+   memset((void *) penv->dbs, 0, (penv->max_dbs + 1) * sizeof(DBXMEMTREE));
+   penv->dbs[0].used = 1;
+   penv->open = 1;
+   return 0;
+}
+
+
+void memdb_env_close(MDB_env *env)
+{
+   unsigned int n;
+   DBXMEMARENA *parena;
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   if (!penv) {
+      return;
+   }
+
+   penv->readers = 0;
+   memdb_gc(penv);
+   if (penv->dbs) {
+      for (n = 0; n <= penv->max_dbs; n ++) {
+         memdb_tree_free(penv, &(penv->dbs[n]), penv->dbs[n].root, 0);
+         if (penv->dbs[n].name) {
+            dbx_free((void *) penv->dbs[n].name, DBX_MEMID_STORE);
+         }
+      }
+      dbx_free((void *) penv->dbs, DBX_MEMID_STORE);
+   }
+   while ((parena = penv->arenas)) {
+      penv->arenas = parena->pnext;
+      dbx_free((void *) parena, DBX_MEMID_STORE);
+   }
+   if (penv->garbage) {
+      dbx_free((void *) penv->garbage, DBX_MEMID_STORE);
+   }
+
+#if defined(_WIN32)
+   DeleteCriticalSection(&(penv->lock));
+#else
+   pthread_mutex_destroy(&(penv->lock));
+#endif
+   dbx_mutex_destroy(&(penv->writer));
+
+   dbx_free((void *) penv, DBX_MEMID_STORE);
+   return;
+}
+
+
+int memdb_env_set_maxdbs(MDB_env *env, MDB_dbi dbs)
+{
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   if (!penv || penv->open) {
+      return EINVAL;
+   }
+   penv->max_dbs = (unsigned int) dbs;
+   return 0;
+}
+
+
+int memdb_env_set_mapsize(MDB_env *env, size_t size)
+{
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   if (!penv) {
+      return EINVAL;
+   }
+   memdb_lock(penv);
+   penv->map_size = size;
+   memdb_unlock(penv);
+   return 0;
+}
+
+
+static void memdb_tree_stat(DBXMEMTREE *ptree, MDB_stat *stat)
+{
+   memset((void *) stat, 0, sizeof(MDB_stat));
+   stat->ms_psize = (unsigned int) sizeof(DBXMEMNODE);
+   stat->ms_depth = ptree->depth;
+   stat->ms_branch_pages = ptree->branch_pages;
+   stat->ms_leaf_pages = ptree->leaf_pages;
+   stat->ms_overflow_pages = 0;
+   stat->ms_entries = ptree->entries;
+   return;
+}
+
+
+int memdb_env_stat(MDB_env *env, MDB_stat *stat)
+{
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   if (!penv) {
+      return EINVAL;
+   }
+   if (!penv->open) {
+      memset((void *) stat, 0, sizeof(MDB_stat));
+      stat->ms_psize = (unsigned int) sizeof(DBXMEMNODE);
+      return 0;
+   }
+   memdb_lock(penv);
+   memdb_tree_stat(&(penv->dbs[0]), stat);
+   memdb_unlock(penv);
+   return 0;
+}
+
+
+int memdb_env_info(MDB_env *env, MDB_envinfo *stat)
+{
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   if (!penv) {
+      return EINVAL;
+   }
+   memdb_lock(penv);
+   memset((void *) stat, 0, sizeof(MDB_envinfo));
+   stat->me_mapaddr = NULL;
+   stat->me_mapsize = penv->map_size;
+   stat->me_last_pgno = penv->used / sizeof(DBXMEMNODE);
+   stat->me_last_txnid = (size_t) penv->txnid;
+   stat->me_maxreaders = 0;
+   stat->me_numreaders = penv->readers;
+   memdb_unlock(penv);
+   return 0;
+}
+
+
+int memdb_env_sync(MDB_env *env, int force)
+{
+   return 0;
+}
+
+
+int memdb_stat(MDB_txn *txn, MDB_dbi dbi, MDB_stat *stat)
+{
+   DBXMEMTREE *ptree;
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn) {
+      return EINVAL;
+   }
+   memdb_lock(ptxn->penv);
+   ptree = memdb_tree(ptxn->penv, dbi);
+   if (ptree) {
+      memdb_tree_stat(ptree, stat);
+   }
+   memdb_unlock(ptxn->penv);
+   return ptree ? 0 : MDB_BAD_DBI;
+}
+
+
+/* As for LMDB: a heading and a line for each reader holding a transaction open */
+int memdb_reader_list(MDB_env *env, MDB_msg_func *func, void *ctx)
+{
+   int rc;
+   unsigned int n, readers;
+   unsigned long long txnid;
+   char buffer[128];
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   if (!penv || !func) {
+      return -1;
+   }
+   memdb_lock(penv);
+   readers = penv->readers;
+   txnid = penv->txnid;
+   memdb_unlock(penv);
+
+   if (!readers) {
+      return func("(no active readers)\n", ctx);
+   }
+   rc = func("    pid     thread     txnid\n", ctx);
+   for (n = 0; rc >= 0 && n < readers; n ++) {
+#if defined(_WIN32)
+      sprintf(buffer, "%10d %10s %llu\n", (int) GetCurrentProcessId(), "-", txnid);
+#else
+      sprintf(buffer, "%10d %10s %llu\n", (int) getpid(), "-", txnid);
+#endif
+      rc = func(buffer, ctx);
+   }
+   return rc;
+}
+
+
+int memdb_txn_begin(MDB_env *env, MDB_txn *parent, unsigned int flags, MDB_txn **txn)
+{
+   DBXMEMTXN *ptxn;
+   DBXMEMENV *penv = (DBXMEMENV *) env;
+
+   *txn = NULL;
+   if (!penv || !penv->open || parent) {
+      return EINVAL;
+   }
+   ptxn = (DBXMEMTXN *) dbx_malloc(sizeof(DBXMEMTXN), DBX_MEMID_STORE);
+   if (!ptxn) {
+      return ENOMEM;
+   }
+   memset((void *) ptxn, 0, sizeof(DBXMEMTXN));
+   ptxn->penv = penv;
+   ptxn->flags = flags;
+
+   if (!(flags & MDB_RDONLY)) {
+      dbx_mutex_lock(&(penv->writer), 0);
+   }
+   memdb_lock(penv);
+   if (flags & MDB_RDONLY) {
+      penv->readers ++;
+   }
+   ptxn->txnid = penv->txnid;
+   ptxn->active = 1;
+   memdb_unlock(penv);
+
+   *txn = (MDB_txn *) ptxn;
+   return 0;
+}
+
+
+static void memdb_txn_end(DBXMEMTXN *ptxn, short commit)
+{
+   DBXMEMENV *penv;
+
+   penv = ptxn->penv;
+   memdb_lock(penv);
+   if (ptxn->flags & MDB_RDONLY) {
+      if (ptxn->active) {
+         penv->readers --;
+      }
+   }
+   else if (commit) {
+      if (ptxn->pundo) {
+         penv->txnid ++;
+      }
+      memdb_commit(ptxn);
+   }
+   else {
+      memdb_undo(ptxn);
+   }
+   ptxn->active = 0;
+   if (!penv->readers && penv->garbage_count) {
+      memdb_gc(penv);
+   }
+   memdb_unlock(penv);
+
+   if (!(ptxn->flags & MDB_RDONLY)) {
+      dbx_mutex_unlock(&(penv->writer));
+   }
+   return;
+}
+
+
+int memdb_txn_commit(MDB_txn *txn)
+{
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn) {
+      return EINVAL;
+   }
+   memdb_txn_end(ptxn, 1);
+   dbx_free((void *) ptxn, DBX_MEMID_STORE);
+   return 0;
+}
+
+
+void memdb_txn_abort(MDB_txn *txn)
+{
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn) {
+      return;
+   }
+   memdb_txn_end(ptxn, 0);
+   dbx_free((void *) ptxn, DBX_MEMID_STORE);
+   return;
+}
+
+
+void memdb_txn_reset(MDB_txn *txn)
+{
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn || !(ptxn->flags & MDB_RDONLY) || !ptxn->active) {
+      return;
+   }
+   memdb_txn_end(ptxn, 0);
+   return;
+}
+
+
+void memdb_txn_renew(MDB_txn *txn)
+{
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn || !(ptxn->flags & MDB_RDONLY) || ptxn->active) {
+      return;
+   }
+   memdb_lock(ptxn->penv);
+   ptxn->penv->readers ++;
+   ptxn->txnid = ptxn->penv->txnid;
+   ptxn->active = 1;
+   memdb_unlock(ptxn->penv);
+   return;
+}
+
+
+/* Named databases are listed in the main database, as they are for LMDB */
+int memdb_dbi_open(MDB_txn *txn, const char *name, unsigned int flags, MDB_dbi *dbi)
+{
+   int rc, pos, exact;
+   unsigned int n, slot;
+   size_t len;
+   char data[DBX_MEMDB_NAME_DATA];
+   DBXMEMENV *penv;
+   DBXMEMNODE *pleaf;
+   DBXMEMUNDO *pundo;
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn || !ptxn->active) {
+      return EINVAL;
+   }
+   if (!name) {
+      *dbi = 0;
+      return 0;
+   }
+   penv = ptxn->penv;
+   len = strlen(name);
+
+   memdb_lock(penv);
+   slot = 0;
+   for (n = 1; n <= penv->max_dbs; n ++) {
+      if (penv->dbs[n].used) {
+         if (!strcmp(penv->dbs[n].name, name)) {
+            *dbi = (MDB_dbi) n;
+            rc = 0;
+            goto memdb_dbi_open_exit;
+         }
+      }
+      else if (!slot) {
+         slot = n;
+      }
+   }
+
+   if (!(flags & MDB_CREATE)) {
+      rc = MDB_NOTFOUND;
+      goto memdb_dbi_open_exit;
+   }
+   if (ptxn->flags & MDB_RDONLY) {
+      rc = EACCES;
+      goto memdb_dbi_open_exit;
+   }
+   if (!slot) {
+      rc = MDB_DBS_FULL;
+      goto memdb_dbi_open_exit;
+   }
+   memdb_seek(&(penv->dbs[0]), (char *) name, len, &pleaf, &pos, &exact);
+   if (exact || !len) {
+      rc = MDB_INCOMPATIBLE;
+      goto memdb_dbi_open_exit;
+   }
+
+   pundo = memdb_undo_new();
+   if (!pundo) {
+      rc = ENOMEM;
+      goto memdb_dbi_open_exit;
+   }
+   penv->dbs[slot].name = (char *) dbx_malloc((int) len + 1, DBX_MEMID_STORE);
+   if (!penv->dbs[slot].name) {
+      dbx_free((void *) pundo, DBX_MEMID_STORE);
+      rc = ENOMEM;
+      goto memdb_dbi_open_exit;
+   }
+   strcpy(penv->dbs[slot].name, name);
+   penv->dbs[slot].used = 1;
+   memdb_undo_link(ptxn, pundo, DBX_MEMDB_UNDO_CREATE, (MDB_dbi) slot, NULL);
+
+   memset((void *) data, 0, DBX_MEMDB_NAME_DATA);
+   rc = memdb_write(ptxn, 0, (char *) name, len, data, DBX_MEMDB_NAME_DATA, NULL);
+   if (rc == 0) {
+      *dbi = (MDB_dbi) slot;
+   }
+
+memdb_dbi_open_exit:
+   memdb_unlock(penv);
+   return rc;
+}
+
+
+void memdb_dbi_close(MDB_env *env, MDB_dbi dbi)
+{
+   return;
+}
+
+
+int memdb_drop(MDB_txn *txn, MDB_dbi dbi, int del)
+{
+   int rc;
+   DBXMEMENV *penv;
+   DBXMEMTREE *ptree, *psaved;
+   DBXMEMUNDO *pundo;
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn || !ptxn->active) {
+      return EINVAL;
+   }
+   if (ptxn->flags & MDB_RDONLY) {
+      return EACCES;
+   }
+   penv = ptxn->penv;
+
+   memdb_lock(penv);
+   ptree = memdb_tree(penv, dbi);
+   if (!ptree) {
+      rc = MDB_BAD_DBI;
+      goto memdb_drop_exit;
+   }
+   pundo = memdb_undo_new();
+   psaved = (DBXMEMTREE *) dbx_malloc(sizeof(DBXMEMTREE), DBX_MEMID_STORE);
+   if (!pundo || !psaved) {
+      if (pundo) {
+         dbx_free((void *) pundo, DBX_MEMID_STORE);
+      }
+      if (psaved) {
+         dbx_free((void *) psaved, DBX_MEMID_STORE);
+      }
+      rc = ENOMEM;
+      goto memdb_drop_exit;
+   }
+
+   /* The contents are set aside until the transaction ends: the name stays with the database unless it is deleted */
+   *psaved = *ptree;
+   ptree->root = NULL;
+   ptree->first = NULL;
+   ptree->last = NULL;
+   ptree->depth = 0;
+   ptree->branch_pages = 0;
+   ptree->leaf_pages = 0;
+   ptree->entries = 0;
+   ptree->mods ++;
+   if (del && dbi > 0) {
+      ptree->used = 0;
+      ptree->name = NULL;
+   }
+   else {
+      psaved->name = NULL;
+   }
+   pundo->ptree = psaved;
+   memdb_undo_link(ptxn, pundo, DBX_MEMDB_UNDO_DROP, dbi, NULL);
+
+   rc = 0;
+   if (del && dbi > 0) {
+      rc = memdb_remove(ptxn, 0, psaved->name, strlen(psaved->name));
+      if (rc == MDB_NOTFOUND) {
+         rc = 0;
+      }
+   }
+
+memdb_drop_exit:
+   memdb_unlock(penv);
+   return rc;
+}
+
+
+int memdb_put(MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data, unsigned int flags)
+{
+   int rc, pos, exact;
+   DBXMEMENV *penv;
+   DBXMEMTREE *ptree;
+   DBXMEMNODE *pleaf;
+   DBXMEMREC *prec;
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn || !ptxn->active) {
+      return EINVAL;
+   }
+   if (ptxn->flags & MDB_RDONLY) {
+      return EACCES;
+   }
+   if (!key->mv_size) {
+      return MDB_BAD_VALSIZE;
+   }
+   penv = ptxn->penv;
+
+   memdb_lock(penv);
+   ptree = memdb_tree(penv, dbi);
+   if (!ptree) {
+      rc = MDB_BAD_DBI;
+      goto memdb_put_exit;
+   }
+   if (flags & MDB_NOOVERWRITE) {
+      memdb_seek(ptree, (char *) key->mv_data, key->mv_size, &pleaf, &pos, &exact);
+      if (exact) {
+         data->mv_data = (void *) MEMDB_DATA(pleaf->rec[pos]);
+         data->mv_size = pleaf->rec[pos]->data_len;
+         rc = MDB_KEYEXIST;
+         goto memdb_put_exit;
+      }
+   }
+   if (penv->map_size && (penv->used + sizeof(DBXMEMREC) + key->mv_size + data->mv_size) > penv->map_size) {
+      rc = MDB_MAP_FULL;
+      goto memdb_put_exit;
+   }
+   if ((sizeof(DBXMEMREC) + key->mv_size + data->mv_size) > 0x7fffff00) {
+      rc = MDB_BAD_VALSIZE;
+      goto memdb_put_exit;
+   }
+
+   rc = memdb_write(ptxn, dbi, (char *) key->mv_data, key->mv_size, (flags & MDB_RESERVE) ? NULL : (char *) data->mv_data, data->mv_size, &prec);
+   if (rc == 0 && (flags & MDB_RESERVE)) {
+      data->mv_data = (void *) MEMDB_DATA(prec);
+   }
+
+memdb_put_exit:
+   memdb_unlock(penv);
+   return rc;
+}
+
+
+int memdb_get(MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data)
+{
+   int rc, pos, exact;
+   DBXMEMTREE *ptree;
+   DBXMEMNODE *pleaf;
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn || !ptxn->active) {
+      return EINVAL;
+   }
+
+   memdb_lock(ptxn->penv);
+   ptree = memdb_tree(ptxn->penv, dbi);
+   if (!ptree) {
+      rc = MDB_BAD_DBI;
+   }
+   else {
+      rc = MDB_NOTFOUND;
+      pleaf = memdb_descend(ptree, (char *) key->mv_data, key->mv_size, NULL, NULL);
+      if (pleaf) {
+         pos = memdb_leaf_search(pleaf, (char *) key->mv_data, key->mv_size, &exact);
+         if (exact) {
+            data->mv_data = (void *) MEMDB_DATA(pleaf->rec[pos]);
+            data->mv_size = pleaf->rec[pos]->data_len;
+            rc = 0;
+         }
+      }
+   }
+   memdb_unlock(ptxn->penv);
+   return rc;
+}
+
+
+int memdb_del(MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data)
+{
+   int rc;
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   if (!ptxn || !ptxn->active) {
+      return EINVAL;
+   }
+   if (ptxn->flags & MDB_RDONLY) {
+      return EACCES;
+   }
+
+   memdb_lock(ptxn->penv);
+   if (!memdb_tree(ptxn->penv, dbi)) {
+      rc = MDB_BAD_DBI;
+   }
+   else {
+      rc = memdb_remove(ptxn, dbi, (char *) key->mv_data, key->mv_size);
+   }
+   memdb_unlock(ptxn->penv);
+   return rc;
+}
+
+
+int memdb_cursor_open(MDB_txn *txn, MDB_dbi dbi, MDB_cursor **cursor)
+{
+   DBXMEMCUR *pcur;
+   DBXMEMTXN *ptxn = (DBXMEMTXN *) txn;
+
+   *cursor = NULL;
+   if (!ptxn) {
+      return EINVAL;
+   }
+   pcur = (DBXMEMCUR *) dbx_malloc(sizeof(DBXMEMCUR), DBX_MEMID_STORE);
+   if (!pcur) {
+      return ENOMEM;
+   }
+   memset((void *) pcur, 0, sizeof(DBXMEMCUR));
+   pcur->ptxn = ptxn;
+   pcur->dbi = dbi;
+   pcur->state = DBX_MEMDB_CUR_UNSET;
+
+   *cursor = (MDB_cursor *) pcur;
+   return 0;
+}
+
+
+void memdb_cursor_close(MDB_cursor *cursor)
+{
+   DBXMEMCUR *pcur = (DBXMEMCUR *) cursor;
+
+   if (!pcur) {
+      return;
+   }
+   if (pcur->key) {
+      dbx_free((void *) pcur->key, DBX_MEMID_STORE);
+   }
+   dbx_free((void *) pcur, DBX_MEMID_STORE);
+   return;
+}
+
+
+int memdb_cursor_renew(MDB_txn *txn, MDB_cursor *cursor)
+{
+   DBXMEMCUR *pcur = (DBXMEMCUR *) cursor;
+
+   if (!pcur || !txn) {
+      return EINVAL;
+   }
+   pcur->ptxn = (DBXMEMTXN *) txn;
+   pcur->state = DBX_MEMDB_CUR_UNSET;
+   return 0;
+}
+
+
+/* Position the cursor on the record at pleaf/pos, keeping a copy of its key so that its place can be found again after the tree changes */
+static int memdb_cursor_set(DBXMEMCUR *pcur, DBXMEMTREE *ptree, DBXMEMNODE *pleaf, int pos, MDB_val *key, MDB_val *data)
+{
+   size_t size;
+   char *p;
+   DBXMEMREC *prec;
+
+   prec = pleaf->rec[pos];
+   if (prec->key_len > pcur->key_size) {
+      size = prec->key_len + 64;
+      p = (char *) dbx_malloc((int) size, DBX_MEMID_STORE);
+      if (!p) {
+         return ENOMEM;
+      }
+      if (pcur->key) {
+         dbx_free((void *) pcur->key, DBX_MEMID_STORE);
+      }
+      pcur->key = p;
+      pcur->key_size = size;
+   }
+   memcpy((void *) pcur->key, (void *) MEMDB_KEY(prec), prec->key_len);
+   pcur->key_len = prec->key_len;
+   pcur->state = DBX_MEMDB_CUR_AT;
+   pcur->leaf = pleaf;
+   pcur->pos = pos;
+   pcur->mods = ptree->mods;
+
+   if (key) {
+      key->mv_data = (void *) MEMDB_KEY(prec);
+      key->mv_size = prec->key_len;
+   }
+   if (data) {
+      data->mv_data = (void *) MEMDB_DATA(prec);
+      data->mv_size = prec->data_len;
+   }
+   return 0;
+}
+
+
+int memdb_cursor_get(MDB_cursor *cursor, MDB_val *key, MDB_val *data, MDB_cursor_op op)
+{
+   int rc, pos, exact;
+   DBXMEMTREE *ptree;
+   DBXMEMNODE *pleaf;
+   DBXMEMCUR *pcur = (DBXMEMCUR *) cursor;
+
+   if (!pcur || !pcur->ptxn || !pcur->ptxn->active) {
+      return EINVAL;
+   }
+
+   memdb_lock(pcur->ptxn->penv);
+   ptree = memdb_tree(pcur->ptxn->penv, pcur->dbi);
+   if (!ptree) {
+      rc = MDB_BAD_DBI;
+      goto memdb_cursor_get_exit;
+   }
+
+   pleaf = NULL;
+   pos = 0;
+   switch (op) {
+      case MDB_FIRST:
+         pleaf = ptree->first;
+         break;
+      case MDB_LAST:
+         pleaf = ptree->last;
+         pos = pleaf ? (pleaf->count - 1) : 0;
+         break;
+      case MDB_NEXT:
+         if (pcur->state == DBX_MEMDB_CUR_UNSET) {
+            pleaf = ptree->first;
+         }
+         else if (pcur->state == DBX_MEMDB_CUR_AT) {
+            if (pcur->mods == ptree->mods) {
+               pleaf = pcur->leaf;
+               pos = pcur->pos + 1;
+            }
+            else {
+               memdb_seek(ptree, pcur->key, pcur->key_len, &pleaf, &pos, &exact);
+               if (pleaf && exact) {
+                  pos ++;
+               }
+            }
+            if (pleaf && pos >= pleaf->count) {
+               pleaf = pleaf->next;
+               pos = 0;
+            }
+         }
+         break;
+      case MDB_PREV:
+         if (pcur->state == DBX_MEMDB_CUR_AT) {
+            if (pcur->mods == ptree->mods) {
+               pleaf = pcur->leaf;
+               pos = pcur->pos;
+            }
+            else {
+               memdb_seek(ptree, pcur->key, pcur->key_len, &pleaf, &pos, &exact);
+            }
+            if (!pleaf) {
+               pleaf = ptree->last;
+               pos = pleaf ? pleaf->count : 0;
+            }
+            if (pleaf && --pos < 0) {
+               pleaf = pleaf->prev;
+               pos = pleaf ? (pleaf->count - 1) : 0;
+            }
+         }
+         else {
+            pleaf = ptree->last;
+            pos = pleaf ? (pleaf->count - 1) : 0;
+         }
+         break;
+      case MDB_SET:
+      case MDB_SET_KEY:
+         memdb_seek(ptree, (char *) key->mv_data, key->mv_size, &pleaf, &pos, &exact);
+         if (!exact) {
+            pleaf = NULL;
+            pcur->state = DBX_MEMDB_CUR_UNSET;
+         }
+         break;
+      case MDB_SET_RANGE:
+         memdb_seek(ptree, (char *) key->mv_data, key->mv_size, &pleaf, &pos, &exact);
+         if (!pleaf) {
+            pcur->state = DBX_MEMDB_CUR_END;
+         }
+         break;
+      case MDB_GET_CURRENT:
+         if (pcur->state != DBX_MEMDB_CUR_AT) {
+            rc = EINVAL;
+            goto memdb_cursor_get_exit;
+         }
+         if (pcur->mods == ptree->mods) {
+            pleaf = pcur->leaf;
+            pos = pcur->pos;
+         }
+         else {
+            memdb_seek(ptree, pcur->key, pcur->key_len, &pleaf, &pos, &exact);
+            if (!exact) {
+               pleaf = NULL;
+            }
+         }
+         break;
+      default:
+         rc = EINVAL;
+         goto memdb_cursor_get_exit;
+   }
+
+   if (pleaf) {
+      rc = memdb_cursor_set(pcur, ptree, pleaf, pos, key, data);
+   }
+   else {
+      rc = MDB_NOTFOUND;
+   }
+
+memdb_cursor_get_exit:
+   memdb_unlock(pcur->ptxn->penv);
+   return rc;
+}
+
+
+char * memdb_strerror(int err)
+{
+   switch (err) {
+      case 0:
+         return (char *) "Successful return: 0";
+      case MDB_KEYEXIST:
+         return (char *) "MDB_KEYEXIST: Key/data pair already exists";
+      case MDB_NOTFOUND:
+         return (char *) "MDB_NOTFOUND: No matching key/data pair found";
+      case MDB_MAP_FULL:
+         return (char *) "MDB_MAP_FULL: Environment mapsize limit reached";
+      case MDB_DBS_FULL:
+         return (char *) "MDB_DBS_FULL: Environment maxdbs limit reached";
+      case MDB_INCOMPATIBLE:
+         return (char *) "MDB_INCOMPATIBLE: Operation and DB incompatible, or DB flags changed";
+      case MDB_BAD_DBI:
+         return (char *) "MDB_BAD_DBI: The specified DBI handle was closed/changed unexpectedly";
+      case MDB_BAD_VALSIZE:
+         return (char *) "MDB_BAD_VALSIZE: Unsupported size of key/DB name/data, or wrong DUPFIXED size";
+      default:
+         break;
+   }
+   return strerror(err);
+}
+
+
+char * memdb_version(int *major, int *minor, int *patch)
+{
+   if (major) {
+      *major = (int) strtol(DBX_VERSION_MAJOR, NULL, 10);
+   }
+   if (minor) {
+      *minor = (int) strtol(DBX_VERSION_MINOR, NULL, 10);
+   }
+   if (patch) {
+      *patch = (int) strtol(DBX_VERSION_BUILD, NULL, 10);
+   }
+   if (!memdb_version_str[0]) {
+      sprintf(memdb_version_str, "MEM: in-memory B+tree version %s.%s.%s", DBX_VERSION_MAJOR, DBX_VERSION_MINOR, DBX_VERSION_BUILD);
+   }
+   return memdb_version_str;
+}
+
@@ -0,0 +1,180 @@
+/*
+   ----------------------------------------------------------------------------
+   | mg-dbx-bdb.node                                                          |
+   | Author: Chris Munt cmunt@mgateway.com                                    |
+   |                    chris.e.munt@gmail.com                                |
+   | Copyright (c) 2019-2025 MGateway Ltd                                     |
+   | Surrey UK.                                                               |
+   | All rights reserved.                                                     |
+   |                                                                          |
+   | http://www.mgateway.com                                                  |
+   |                                                                          |
+   | Licensed under the Apache License, Version 2.0 (the "License"); you may  |
+   | not use this file except in compliance with the License.                 |
+   | You may obtain a copy of the License at                                  |
+   |                                                                          |
+   | http://www.apache.org/licenses/LICENSE-2.0                               |
+   |                                                                          |
+   | Unless required by applicable law or agreed to in writing, software      |
+   | distributed under the License is distributed on an "AS IS" BASIS,        |
+   | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+   | See the License for the specific language governing permissions and      |
+   | limitations under the License.                                           |      
+   |                                                                          |
+   ----------------------------------------------------------------------------
+*/
+
+
+/*
+   In-memory storage engine (v1.3.39)
+
+   A B+tree held in process memory and presented through the subset of the
+   LMDB C API used by mg-dbx-bdb, so that connections opened with type "MEM"
+   are served by the LMDB code paths (key encodings, cursors, merge, kill,
+   named databases per global and map growth) without a shared library.
+
+   Leaf slots point to records holding a key and its data.  Records are never
+   changed in place: a write replaces the record, and the record replaced is
+   kept until the transaction is committed (so that it can be restored on
+   abort) and then, if read-only transactions are active, until the last of
+   them ends.  Data returned to the caller therefore remains valid for the
+   life of a read-only transaction, as it does for LMDB.  Tree nodes are taken
+   from arenas that are released when the environment is closed.  Keys are
+   ordered by memcmp() as for LMDB.
+
+   There is one writer at a time; a read-only transaction sees writes as they
+   are made rather than a snapshot.  The map size limits the memory held in
+   records and nodes, beyond which a write fails with MDB_MAP_FULL.
+*/
+
+#ifndef MG_MEMDB_H
+#define MG_MEMDB_H
+
+#define DBX_MEMDB_ORDER          64
+#define DBX_MEMDB_ARENA          64
+#define DBX_MEMDB_MAX_DEPTH      32
+#define DBX_MEMDB_NAME_DATA      48
+
+#define DBX_MEMDB_UNDO_INSERT    1
+#define DBX_MEMDB_UNDO_REPLACE   2
+#define DBX_MEMDB_UNDO_DELETE    3
+#define DBX_MEMDB_UNDO_CREATE    4
+#define DBX_MEMDB_UNDO_DROP      5
+
+#define DBX_MEMDB_CUR_UNSET      0
+#define DBX_MEMDB_CUR_AT         1
+#define DBX_MEMDB_CUR_END        2
+
+#if defined(_WIN32)
+#define DBX_MEMDB_LOCK           CRITICAL_SECTION
+#else
+#define DBX_MEMDB_LOCK           pthread_mutex_t
+#endif
+
+typedef struct tagDBXMEMREC {
+   size_t                  key_len;
+   size_t                  data_len;
+} DBXMEMREC, *PDBXMEMREC; /* followed by the key and the data */
+
+typedef struct tagDBXMEMNODE {
+   short                   leaf;
+   short                   count;
+   struct tagDBXMEMNODE *  prev; /* leaves: adjacent leaves in key order */
+   struct tagDBXMEMNODE *  next; /* leaves: as above; free nodes: next free node */
+   DBXMEMREC *             rec[DBX_MEMDB_ORDER]; /* leaves: records; branches: rec[n] is the lowest key under child[n] (n > 0) */
+   struct tagDBXMEMNODE *  child[DBX_MEMDB_ORDER];
+} DBXMEMNODE, *PDBXMEMNODE;
+
+typedef struct tagDBXMEMARENA {
+   struct tagDBXMEMARENA * pnext;
+   DBXMEMNODE              node[DBX_MEMDB_ARENA];
+} DBXMEMARENA, *PDBXMEMARENA;
+
+typedef struct tagDBXMEMTREE {
+   short                   used;
+   char *                  name;
+   DBXMEMNODE *            root;
+   DBXMEMNODE *            first;
+   DBXMEMNODE *            last;
+   unsigned int            depth;
+   size_t                  branch_pages;
+   size_t                  leaf_pages;
+   size_t                  entries;
+   unsigned long long      mods; /* changed by every update so that cursors know to find their place again */
+} DBXMEMTREE, *PDBXMEMTREE;
+
+typedef struct tagDBXMEMUNDO {
+   short                   type;
+   MDB_dbi                 dbi;
+   DBXMEMREC *             prec;
+   DBXMEMTREE *            ptree; /* dropped database */
+   struct tagDBXMEMUNDO *  pnext;
+} DBXMEMUNDO, *PDBXMEMUNDO;
+
+typedef struct tagDBXMEMENV {
+   short                   open;
+   unsigned int            max_dbs;
+   DBXMEMTREE *            dbs; /* dbs[0] is the main database */
+   size_t                  map_size;
+   size_t                  used; /* bytes held in records and nodes */
+   unsigned long long      txnid;
+   unsigned int            readers;
+   DBXMEMARENA *           arenas;
+   DBXMEMNODE *            free_nodes;
+   DBXMEMREC **            garbage; /* records released while read-only transactions were active */
+   size_t                  garbage_count;
+   size_t                  garbage_size;
+   DBX_MEMDB_LOCK          lock;
+   DBXMUTEX                writer;
+} DBXMEMENV, *PDBXMEMENV;
+
+typedef struct tagDBXMEMTXN {
+   DBXMEMENV *             penv;
+   unsigned int            flags;
+   short                   active;
+   unsigned long long      txnid;
+   DBXMEMUNDO *            pundo;
+} DBXMEMTXN, *PDBXMEMTXN;
+
+typedef struct tagDBXMEMCUR {
+   DBXMEMTXN *             ptxn;
+   MDB_dbi                 dbi;
+   short                   state;
+   DBXMEMNODE *            leaf;
+   int                     pos;
+   unsigned long long      mods;
+   char *                  key; /* copy of the current key */
+   size_t                  key_len;
+   size_t                  key_size;
+} DBXMEMCUR, *PDBXMEMCUR;
+
+int                        memdb_env_create           (MDB_env **env);
+int                        memdb_env_open             (MDB_env *env, const char *path, unsigned int flags, mdb_mode_t mode);
+void                       memdb_env_close            (MDB_env *env);
+int                        memdb_env_set_maxdbs       (MDB_env *env, MDB_dbi dbs);
+int                        memdb_env_set_mapsize      (MDB_env *env, size_t size);
+int                        memdb_env_stat             (MDB_env *env, MDB_stat *stat);
+int                        memdb_env_info             (MDB_env *env, MDB_envinfo *stat);
+int                        memdb_env_sync             (MDB_env *env, int force);
+int                        memdb_stat                 (MDB_txn *txn, MDB_dbi dbi, MDB_stat *stat);
+int                        memdb_reader_list          (MDB_env *env, MDB_msg_func *func, void *ctx);
+int                        memdb_txn_begin            (MDB_env *env, MDB_txn *parent, unsigned int flags, MDB_txn **txn);
+int                        memdb_txn_commit           (MDB_txn *txn);
+void                       memdb_txn_abort            (MDB_txn *txn);
+void                       memdb_txn_reset            (MDB_txn *txn);
+void                       memdb_txn_renew            (MDB_txn *txn);
+int                        memdb_dbi_open             (MDB_txn *txn, const char *name, unsigned int flags, MDB_dbi *dbi);
+void                       memdb_dbi_close            (MDB_env *env, MDB_dbi dbi);
+int                        memdb_drop                 (MDB_txn *txn, MDB_dbi dbi, int del);
+int                        memdb_put                  (MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data, unsigned int flags);
+int                        memdb_get                  (MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data);
+int                        memdb_del                  (MDB_txn *txn, MDB_dbi dbi, MDB_val *key, MDB_val *data);
+int                        memdb_cursor_open          (MDB_txn *txn, MDB_dbi dbi, MDB_cursor **cursor);
+void                       memdb_cursor_close         (MDB_cursor *cursor);
+int                        memdb_cursor_renew         (MDB_txn *txn, MDB_cursor *cursor);
+int                        memdb_cursor_get           (MDB_cursor *cursor, MDB_val *key, MDB_val *data, MDB_cursor_op op);
+char *                     memdb_strerror             (int err);
+char *                     memdb_version              (int *major, int *minor, int *patch);
+
+#endif
+
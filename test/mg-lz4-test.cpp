@@ -0,0 +1,261 @@
+/*
+   ----------------------------------------------------------------------------
+   | mg-dbx-bdb.node                                                          |
+   | Author: Chris Munt cmunt@mgateway.com                                    |
+   |                    chris.e.munt@gmail.com                                |
+   | Copyright (c) 2019-2025 MGateway Ltd                                     |
+   | Surrey UK.                                                               |
+   | All rights reserved.                                                     |
+   |                                                                          |
+   | http://www.mgateway.com                                                  |
+   |                                                                          |
+   | Licensed under the Apache License, Version 2.0 (the "License"); you may  |
+   | not use this file except in compliance with the License.                 |
+   | You may obtain a copy of the License at                                  |
+   |                                                                          |
+   | http://www.apache.org/licenses/LICENSE-2.0                               |
+   |                                                                          |
+   | Unless required by applicable law or agreed to in writing, software      |
+   | distributed under the License is distributed on an "AS IS" BASIS,        |
+   | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+   | See the License for the specific language governing permissions and      |
+   | limitations under the License.                                           |
+   |                                                                          |
+   ----------------------------------------------------------------------------
+*/
+
+
+/*
+   Tests for the compression codec (src/mg-lz4.cpp)
+
+   Built as the mg-lz4-test executable (binding.gyp) and run by npm test.
+   Values are compressed and decompressed again, and the decoder is given
+   truncated, altered and random input: it must either report an error or
+   return a length within the output buffer, and must never write beyond it.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/mg-lz4.h"
+
+#define DBX_TEST_GUARD           64
+#define DBX_TEST_GUARD_BYTE      0xA5
+
+static int failed = 0;
+static int checks = 0;
+static unsigned int seed = 2463534242U;
+
+
+static unsigned int dbx_test_random(void)
+{
+   seed ^= seed << 13;
+   seed ^= seed >> 17;
+   seed ^= seed << 5;
+   return seed;
+}
+
+
+static void dbx_test_check(int ok, const char *name, int n)
+{
+   checks ++;
+   if (!ok) {
+      failed ++;
+      printf("   failed: %s (%d)\n", name, n);
+   }
+}
+
+
+/* Decode into an output buffer of dst_size bytes followed by guard bytes: returns the decoder's result */
+static int dbx_test_decode(const unsigned char *src, int src_len, unsigned char *dst, int dst_size, const char *name, int n)
+{
+   int len, i, guard;
+   unsigned char *in;
+
+   /* the input is copied to a buffer of exactly src_len bytes so that over-reads can be caught by memory checkers */
+   in = (unsigned char *) malloc(src_len > 0 ? src_len : 1);
+   memcpy((void *) in, (void *) src, (size_t) src_len);
+
+   memset((void *) dst, DBX_TEST_GUARD_BYTE, (size_t) (dst_size + DBX_TEST_GUARD));
+   len = dbx_lz4_decompress(in, src_len, dst, dst_size);
+   free((void *) in);
+
+   guard = 1;
+   for (i = dst_size; i < dst_size + DBX_TEST_GUARD; i ++) {
+      if (dst[i] != DBX_TEST_GUARD_BYTE) {
+         guard = 0;
+         break;
+      }
+   }
+   dbx_test_check(guard, name, n);
+   dbx_test_check(len >= -1 && len <= dst_size, name, n);
+   return len;
+}
+
+
+static void dbx_test_fill(unsigned char *data, int len, int pattern)
+{
+   int n;
+   const char *text = "The quick brown fox jumps over the lazy dog. ";
+
+   for (n = 0; n < len; n ++) {
+      if (pattern == 0)
+         data[n] = 0;
+      else if (pattern == 1)
+         data[n] = (unsigned char) text[n % 45];
+      else if (pattern == 2)
+         data[n] = (unsigned char) dbx_test_random();
+      else if (pattern == 3)
+         data[n] = (unsigned char) ("abc"[n % 3]);
+      else if (pattern == 4) /* repeats beyond the largest match offset */
+         data[n] = (n < 70000) ? (unsigned char) dbx_test_random() : data[n - 70000];
+      else /* runs of literals between short matches */
+         data[n] = (unsigned char) ((n % 64) < 40 ? dbx_test_random() : 'x');
+   }
+}
+
+
+static void dbx_test_round_trip(void)
+{
+   int sizes[] = {0, 1, 4, 12, 13, 14, 15, 16, 31, 32, 255, 270, 1000, 4096, 65535, 65536, 65537, 150000};
+   int i, pattern, len, clen, dlen;
+   unsigned char *data, *comp, *out;
+
+   data = (unsigned char *) malloc(150000);
+   comp = (unsigned char *) malloc(DBX_LZ4_BOUND(150000));
+   out = (unsigned char *) malloc(150000 + DBX_TEST_GUARD);
+
+   for (pattern = 0; pattern < 6; pattern ++) {
+      for (i = 0; i < (int) (sizeof(sizes) / sizeof(sizes[0])); i ++) {
+         len = sizes[i];
+         dbx_test_fill(data, len, pattern);
+
+         clen = dbx_lz4_compress(data, len, comp, DBX_LZ4_BOUND(len));
+         dbx_test_check(clen > 0 && clen <= DBX_LZ4_BOUND(len), "compress within bound", len);
+         if (clen <= 0) {
+            continue;
+         }
+
+         dlen = dbx_test_decode(comp, clen, out, len, "round trip", len);
+         dbx_test_check(dlen == len && !memcmp((void *) out, (void *) data, (size_t) len), "round trip", len);
+
+         if (len > 0) {
+            dlen = dbx_test_decode(comp, clen, out, len - 1, "output one byte short", len);
+            dbx_test_check(dlen == -1, "output one byte short", len);
+         }
+
+         if (pattern == 2 && len > 32) {
+            dbx_test_check(dbx_lz4_compress(data, len, comp, len / 2) == 0, "incompressible into a short buffer", len);
+         }
+      }
+   }
+
+   free((void *) data);
+   free((void *) comp);
+   free((void *) out);
+}
+
+
+static void dbx_test_corrupted(void)
+{
+   int len, clen, n, i, bits[] = {0x01, 0x80, 0xFF};
+   unsigned char *data, *comp, *alt, *out;
+
+   len = 20000;
+   data = (unsigned char *) malloc(len);
+   comp = (unsigned char *) malloc(DBX_LZ4_BOUND(len));
+   alt = (unsigned char *) malloc(DBX_LZ4_BOUND(len));
+   out = (unsigned char *) malloc(len + DBX_TEST_GUARD);
+
+   dbx_test_fill(data, len, 5);
+   clen = dbx_lz4_compress(data, len, comp, DBX_LZ4_BOUND(len));
+   dbx_test_check(clen > 0, "compress", len);
+
+   /* every truncation of a valid stream */
+   for (n = 0; n < clen; n ++) {
+      dbx_test_decode(comp, n, out, len, "truncated", n);
+   }
+
+   /* single bytes altered */
+   for (n = 0; n < clen && n < 4000; n ++) {
+      for (i = 0; i < 3; i ++) {
+         memcpy((void *) alt, (void *) comp, (size_t) clen);
+         alt[n] ^= (unsigned char) bits[i];
+         dbx_test_decode(alt, clen, out, len, "altered", n);
+      }
+   }
+
+   /* random input */
+   for (n = 0; n < 20000; n ++) {
+      clen = 1 + (int) (dbx_test_random() % 64);
+      for (i = 0; i < clen; i ++) {
+         alt[i] = (unsigned char) dbx_test_random();
+      }
+      dbx_test_decode(alt, clen, out, 256, "random", n);
+   }
+
+   free((void *) data);
+   free((void *) comp);
+   free((void *) alt);
+   free((void *) out);
+}
+
+
+static void dbx_test_malformed(void)
+{
+   unsigned char out[256 + DBX_TEST_GUARD];
+
+   /* 4 literals then a match with offset 0 */
+   unsigned char offset_zero[] = {0x40, 'a', 'b', 'c', 'd', 0x00, 0x00};
+   /* 4 literals then a match reaching back before the start of the output */
+   unsigned char offset_far[] = {0x40, 'a', 'b', 'c', 'd', 0x05, 0x00};
+   /* 8 literals declared, 4 present */
+   unsigned char literals_short[] = {0x80, 'a', 'b', 'c', 'd'};
+   /* literal length extension with no more input */
+   unsigned char literal_ext[] = {0xF0};
+   /* literal length extension continued (255) with no more input */
+   unsigned char literal_ext_255[] = {0xF0, 0xFF};
+   /* 4 literals then half a match offset */
+   unsigned char offset_short[] = {0x40, 'a', 'b', 'c', 'd', 0x01};
+   /* match length extension with no more input */
+   unsigned char match_ext[] = {0x4F, 'a', 'b', 'c', 'd', 0x01, 0x00};
+   /* a long match (overlapping, offset 1) that does not fit in the output */
+   unsigned char match_long[] = {0x1F, 'a', 0x01, 0x00, 0xFF, 0xFF, 0x10};
+   /* the same match fits a larger output exactly: 1 + 4 + 15 + 255 + 255 + 16 bytes */
+   int match_long_len = 546;
+
+   dbx_test_check(dbx_test_decode(offset_zero, sizeof(offset_zero), out, 256, "offset zero", 0) == -1, "offset zero", 0);
+   dbx_test_check(dbx_test_decode(offset_far, sizeof(offset_far), out, 256, "offset beyond output", 0) == -1, "offset beyond output", 0);
+   dbx_test_check(dbx_test_decode(literals_short, sizeof(literals_short), out, 256, "literals beyond input", 0) == -1, "literals beyond input", 0);
+   dbx_test_check(dbx_test_decode(literals_short, sizeof(literals_short), out, 2, "literals beyond output", 0) == -1, "literals beyond output", 0);
+   dbx_test_check(dbx_test_decode(literal_ext, sizeof(literal_ext), out, 256, "literal length truncated", 0) == -1, "literal length truncated", 0);
+   dbx_test_check(dbx_test_decode(literal_ext_255, sizeof(literal_ext_255), out, 256, "literal length truncated", 1) == -1, "literal length truncated", 1);
+   dbx_test_check(dbx_test_decode(offset_short, sizeof(offset_short), out, 256, "offset truncated", 0) == -1, "offset truncated", 0);
+   dbx_test_check(dbx_test_decode(match_ext, sizeof(match_ext), out, 256, "match length truncated", 0) == -1, "match length truncated", 0);
+   dbx_test_check(dbx_test_decode(match_long, sizeof(match_long), out, 256, "match beyond output", 0) == -1, "match beyond output", 0);
+
+   {
+      unsigned char *big = (unsigned char *) malloc(match_long_len + DBX_TEST_GUARD);
+      int n, ok;
+
+      n = dbx_test_decode(match_long, sizeof(match_long), big, match_long_len, "overlapping match", 0);
+      ok = (n == match_long_len);
+      for (n = 0; ok && n < match_long_len; n ++) {
+         ok = (big[n] == 'a');
+      }
+      dbx_test_check(ok, "overlapping match", 0);
+      free((void *) big);
+   }
+}
+
+
+int main(int argc, char *argv[])
+{
+   dbx_test_round_trip();
+   dbx_test_corrupted();
+   dbx_test_malformed();
+
+   printf("%d checks, %d failed\n", checks, failed);
+   return failed ? 1 : 0;
+}
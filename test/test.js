@@ -0,0 +1,254 @@
+//
+// mg-dbx-bdb.node: Smoke tests
+//
+// Runs the public API against the in-memory (MEM) storage engine, so no database library or directory is needed.
+//
+// Usage: npm test
+//
+
+var assert = require('assert');
+var child_process = require('child_process');
+var path = require('path');
+var dbx = require(path.join(__dirname, '..'));
+
+var tests = [];
+
+// Each test is given a new connection: 'options' are added to the open() parameters
+
+function test(name, fn, options) {
+   tests.push({name: name, fn: fn, options: options || {}});
+}
+
+function openDatabase(options) {
+   var db = new dbx.dbxbdb();
+   var params = {type: "MEM", key_type: "m", ttl_sweep: 0};
+   var result, name;
+
+   for (name in options) {
+      params[name] = options[name];
+   }
+   result = db.open(params);
+
+   if (result) {
+      throw new Error("Cannot open the database: " + result);
+   }
+   return db;
+}
+
+// Block the thread for 'ms' milliseconds (time to live is measured in whole seconds)
+
+function sleep(ms) {
+   Atomics.wait(new Int32Array(new SharedArrayBuffer(4)), 0, 0, ms);
+}
+
+// All the nodes of a global, in order, from a $query (multilevel) cursor
+
+function queryAll(db, name) {
+   var query = db.mglobalquery({global: name, key: []}, {multilevel: true, getdata: true});
+   var list = [];
+   var result;
+
+   while ((result = query.next()) !== null) {
+      list.push(result.key.join(",") + "=" + result.data);
+   }
+   return list;
+}
+
+test("set, get and next", function(db) {
+   var person = db.mglobal("person");
+
+   person.set(1, "name", "Smith");
+   person.set(2, "name", "Jones");
+   person.set(3, "name", "Brown");
+   assert.equal(person.get(2, "name"), "Jones");
+   assert.equal(person.defined(1), 10);
+   assert.equal(person.defined(1, "name"), 1);
+   assert.equal(person.next(""), "1");
+   assert.equal(person.next(1), "2");
+   assert.equal(person.previous(""), "3");
+   assert.deepStrictEqual(queryAll(db, "person"), ["1,name=Smith", "2,name=Jones", "3,name=Brown"]);
+   person.delete(2);
+   assert.equal(person.defined(2, "name"), 0);
+   assert.equal(person.next(1), "3");
+});
+
+test("get_into", function(db) {
+   var doc = db.mglobal("doc");
+   var value = Buffer.from("The quick brown fox");
+   var buf = Buffer.alloc(64, 0x2e);
+   var small = Buffer.alloc(4);
+
+   doc.set(1, value);
+   assert.equal(doc.get_into(buf, 0, 1), value.length);
+   assert.ok(buf.subarray(0, value.length).equals(value));
+   assert.equal(doc.get_into(buf, 10, 1), value.length);
+   assert.ok(buf.subarray(10, 10 + value.length).equals(value));
+   assert.equal(buf[9], value[9]);
+   assert.equal(doc.get_into(small, 0, 1), -value.length);
+   assert.ok(small.equals(Buffer.alloc(4)));
+   assert.equal(doc.get_into(buf, 0, 2), 0);
+});
+
+test("read_range, write_range and append", function(db) {
+   var doc = db.mglobal("document");
+   var expect = Buffer.alloc(0);
+   var piece, n;
+
+   doc.set(1, "");
+   for (n = 0; n < 30; n ++) {
+      piece = Buffer.alloc(5000, 0x41 + (n % 26));
+      expect = Buffer.concat([expect, piece]);
+      assert.equal(doc.append(1, piece), expect.length);
+   }
+
+   // 150000 bytes: beyond 64KB the value is held in chunks
+   assert.ok(doc.read_range(1, 65530, 20).equals(expect.subarray(65530, 65550)));
+   assert.equal(doc.read_range(1, 149990, 100).length, 10);
+   assert.equal(doc.get(1), expect.toString());
+
+   assert.equal(doc.write_range(1, 65530, "0123456789"), expect.length);
+   Buffer.from("0123456789").copy(expect, 65530);
+   assert.equal(doc.read_range(1, 65528, 14).toString(), expect.subarray(65528, 65542).toString());
+
+   // writing beyond the end leaves a gap of zero bytes
+   assert.equal(doc.write_range(1, 160000, "END"), 160003);
+   assert.ok(doc.read_range(1, 149995, 10).subarray(5).equals(Buffer.alloc(5)));
+   assert.equal(doc.read_range(1, 160000, 3).toString(), "END");
+
+   doc.delete(1);
+   assert.equal(doc.defined(1), 0);
+   assert.deepStrictEqual(queryAll(db, "%dbxchunk"), []);
+});
+
+test("time to live", function(db) {
+   var session = db.mglobal("session");
+
+   session.set(1, "a", {ttl: 1});
+   session.set(2, "b");
+   session.set(3, "c", {ttl: 1});
+   session.set(4, "x", "d", {ttl: 60});
+   assert.equal(session.get(1), "a");
+   sleep(1100);
+
+   assert.equal(session.get(1), "");
+   assert.equal(session.defined(1), 0);
+   assert.equal(session.next(""), "2");
+   assert.equal(session.next(2), "4");
+   assert.equal(session.previous(4), "2");
+   assert.deepStrictEqual(queryAll(db, "session"), ["2=b", "4,x=d"]);
+
+   assert.equal(db.sweep(), 2);
+   assert.equal(session.get(4, "x"), "d");
+   assert.deepStrictEqual(queryAll(db, "session"), ["2=b", "4,x=d"]);
+});
+
+test("secondary indexes", function(db) {
+   var patient = db.mglobal("patient");
+   var byName = db.mglobal("patientByName");
+
+   patient.set(1, "name", "Smith");
+   patient.set(2, "name", "Jones");
+   patient.set(2, "town", "Leeds");
+   assert.equal(db.define_index("patient", {key_path: ["*", "name"], index_global: "patientByName"}), 2);
+   assert.deepStrictEqual(queryAll(db, "patientByName"), ["Jones,2=", "Smith,1="]);
+
+   patient.set(3, "name", "Brown");
+   assert.equal(byName.next("Brown", ""), "3");
+   patient.set(1, "name", "White");
+   assert.equal(byName.defined("Smith", 1), 0);
+   assert.equal(byName.next("White", ""), "1");
+   patient.delete(2);
+   assert.deepStrictEqual(queryAll(db, "patientByName"), ["Brown,3=", "White,1="]);
+
+   patient.set_object(4, {name: "Green"});
+   assert.equal(byName.next("Green", ""), "4");
+});
+
+test("set_object and get_object", function(db) {
+   var person = db.mglobal("object");
+   var john = {name: "John Smith", address: {town: "London", postcode: "W1 1AA"}};
+
+   assert.equal(person.set_object(1, john), 3);
+   assert.deepStrictEqual(person.get_object(1), john);
+   assert.equal(person.get(1, "address", "town"), "London");
+   assert.deepStrictEqual(person.get_object(1, "address"), john.address);
+   assert.deepStrictEqual(person.get_object(), {"1": john});
+   assert.deepStrictEqual(person.get_object(2), {});
+});
+
+test("compression", function(db) {
+   var doc = db.mglobal("compressed");
+   var text = "The quick brown fox jumps over the lazy dog. ".repeat(2000);
+   var random = Buffer.alloc(20000);
+   var run = Buffer.alloc(100000, 0x61);
+   var header = Buffer.concat([Buffer.from([0x00, 0xDB, 0x5A, 0x01, 0x10, 0x00, 0x00, 0x00]), Buffer.alloc(200, 0x62)]);
+   var buf = Buffer.alloc(100000);
+   var x, n;
+
+   for (n = 0; n < random.length; n ++) {
+      x = (n * 2654435761) >>> 0;
+      random[n] = (x >>> 13) ^ (x >>> 24);
+   }
+
+   doc.set(1, text);
+   doc.set(2, random);
+   doc.set(3, run);
+   doc.set(4, header);
+   doc.set(5, "short");
+   assert.equal(doc.get(1), text);
+   assert.equal(doc.get(3), run.toString());
+   assert.equal(doc.get(5), "short");
+
+   // binary values, and a value that begins with the header bytes (stored escaped)
+   assert.equal(doc.get_into(buf, 0, 2), random.length);
+   assert.ok(buf.subarray(0, random.length).equals(random));
+   assert.equal(doc.get_into(buf, 0, 4), header.length);
+   assert.ok(buf.subarray(0, header.length).equals(header));
+   assert.equal(doc.get_into(buf, 0, 3), run.length);
+   assert.ok(buf.equals(run));
+
+   assert.ok(doc.read_range(1, 45 * 1000 + 4, 5).equals(Buffer.from("quick")));
+   assert.deepStrictEqual(queryAll(db, "compressed")[0], "1=" + text);
+
+   assert.equal(doc.compression("none"), "none");
+   doc.set(6, text);
+   assert.equal(doc.get(6), text);
+   assert.equal(doc.get(1), text);
+}, {compression: {algo: "lz4", min_size: 64}});
+
+// The codec's own tests (test/mg-lz4-test.cpp): round trips and decoding of truncated, altered and random input
+
+test("lz4 codec", function(db) {
+   var program = path.join(__dirname, "..", "build", "Release", "mg-lz4-test" + (process.platform == 'win32' ? ".exe" : ""));
+   var run = child_process.spawnSync(program, [], {encoding: "utf8"});
+
+   if (run.error) {
+      throw new Error("Cannot run " + program + ": " + run.error.message);
+   }
+   assert.equal(run.status, 0, run.stdout.trim());
+});
+
+function main() {
+   var failed = 0;
+   var n, db;
+
+   for (n = 0; n < tests.length; n ++) {
+      db = openDatabase(tests[n].options);
+      try {
+         tests[n].fn(db);
+         console.log("ok " + (n + 1) + " - " + tests[n].name);
+      }
+      catch (error) {
+         failed ++;
+         console.log("not ok " + (n + 1) + " - " + tests[n].name);
+         console.log("   " + String(error.stack || error).split("\n").join("\n   "));
+      }
+      db.close();
+   }
+   console.log((tests.length - failed) + " of " + tests.length + " tests passed");
+   if (failed) {
+      process.exitCode = 1;
+   }
+}
+
+main();